@@ -10,10 +10,12 @@
 #include <cpu_func.h>
 #include <hang.h>
 #include <log.h>
+#include <spl.h>
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/system.h>
 #include <asm/armv8/mmu.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -163,8 +165,39 @@ static u64 *find_pte(u64 addr, int level)
 }
 
 #ifdef CONFIG_CMO_BY_VA_ONLY
-static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
-			    u64 pte, int level, u64 base)
+/**
+ * struct cmo_batch - A range of RAM waiting for a cache operation
+ *
+ * Adjacent RAM mappings are merged so that the cache operation (and its
+ * barrier) is done once for each contiguous region rather than once for each
+ * block or page
+ *
+ * @cmo_fn: Cache operation to apply
+ * @start: Start of the pending range
+ * @end: End of the pending range (exclusive), or 0 if there is none
+ */
+struct cmo_batch {
+	void (*cmo_fn)(unsigned long, unsigned long);
+	u64 start;
+	u64 end;
+};
+
+static void cmo_batch_add(struct cmo_batch *batch, u64 start, u64 end)
+{
+	if (batch->end && batch->end == start) {
+		batch->end = end;
+		return;
+	}
+	if (batch->end) {
+		debug("Flush %llx-%llx\n", batch->start, batch->end);
+		batch->cmo_fn(batch->start, batch->end);
+	}
+	batch->start = start;
+	batch->end = end;
+}
+
+static void __cmo_on_leaves(struct cmo_batch *batch, u64 pte, int level,
+			    u64 base)
 {
 	u64 *ptep;
 	int i;
@@ -186,7 +219,7 @@ static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
 		/* Not a leaf? Recurse on the next level */
 		if (!(type == PTE_TYPE_BLOCK ||
 		      (level == 3 && type == PTE_TYPE_PAGE))) {
-			__cmo_on_leaves(cmo_fn, pte, level + 1, va);
+			__cmo_on_leaves(batch, pte, level + 1, va);
 			continue;
 		}
 
@@ -199,10 +232,10 @@ static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
 		    attrs != PTE_BLOCK_MEMTYPE(MT_NORMAL_NC))
 			continue;
 
-		end = va + BIT(level2shift(level)) - 1;
+		end = va + BIT(level2shift(level));
 
 		/* No intersection with RAM? */
-		if (end < gd->ram_base ||
+		if (end <= gd->ram_base ||
 		    va >= (gd->ram_base + gd->ram_size))
 			continue;
 
@@ -215,14 +248,15 @@ static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
 		va = max(va, (u64)gd->ram_base);
 		end = min(end, gd->ram_base + gd->ram_size);
 
-		debug("Flush PTE %llx at level %d: %llx-%llx\n",
+		debug("Leaf PTE %llx at level %d: %llx-%llx\n",
 		      pte, level, va, end);
-		cmo_fn(va, end);
+		cmo_batch_add(batch, va, end);
 	}
 }
 
 static void apply_cmo_to_mappings(void (*cmo_fn)(unsigned long, unsigned long))
 {
+	struct cmo_batch batch = { .cmo_fn = cmo_fn };
 	u64 va_bits;
 	int sl = 0;
 
@@ -233,7 +267,10 @@ static void apply_cmo_to_mappings(void (*cmo_fn)(unsigned long, unsigned long))
 	if (va_bits < 39)
 		sl = 1;
 
-	__cmo_on_leaves(cmo_fn, gd->arch.tlb_addr, sl, 0);
+	__cmo_on_leaves(&batch, gd->arch.tlb_addr, sl, 0);
+
+	/* flush out the last range */
+	cmo_batch_add(&batch, 0, 0);
 }
 #else
 static inline void apply_cmo_to_mappings(void *dummy) {}
@@ -720,6 +757,13 @@ static void setup_all_pgtables(void)
 	/* Create normal system page tables */
 	setup_pgtables();
 
+	/*
+	 * SPL never changes attributes after enabling its caches, so save the
+	 * time and memory needed for a second copy of the tables
+	 */
+	if (CONFIG_IS_ENABLED(ENABLE_CACHES))
+		return;
+
 	/* Create emergency page tables */
 	gd->arch.tlb_size -= (uintptr_t)gd->arch.tlb_fillptr -
 			     (uintptr_t)gd->arch.tlb_addr;
@@ -1112,3 +1156,29 @@ void __weak enable_caches(void)
 	icache_enable();
 	dcache_enable();
 }
+
+#if CONFIG_IS_ENABLED(ENABLE_CACHES)
+/* There is no allocator for DRAM this early, so keep the tables in BSS */
+static u64 spl_pgtable[CONFIG_SPL_PAGE_TABLE_SIZE / sizeof(u64)]
+	__aligned(SZ_4K);
+
+void spl_enable_caches(void)
+{
+	/* the board may have done this itself, e.g. in board_init_f() */
+	if (dcache_status())
+		return;
+
+	gd->arch.tlb_addr = (ulong)spl_pgtable;
+	gd->arch.tlb_size = sizeof(spl_pgtable);
+	gd->arch.tlb_fillptr = 0;
+	icache_enable();
+	dcache_enable();
+}
+
+void spl_disable_caches(void)
+{
+	dcache_disable();
+	icache_disable();
+	invalidate_icache_all();
+}
+#endif
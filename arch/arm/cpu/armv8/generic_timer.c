@@ -10,6 +10,8 @@
 #include <asm/global_data.h>
 #include <asm/system.h>
 #include <linux/bitops.h>
+#include <linux/kernel.h>
+#include <linux/log2.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -116,28 +118,43 @@ ulong timer_get_boot_us(void)
 }
 
 #if CONFIG_IS_ENABLED(ARMV8_UDELAY_EVENT_STREAM)
-void __udelay(unsigned long usec)
+/*
+ * Sleep with WFE, using the event stream to wake up each time a chosen bit of
+ * the counter changes. The bit is chosen so that there are a few wake-ups
+ * over the wait, since each may overshoot by up to one period.
+ */
+void arch_timer_sleep(uint64_t target)
 {
-	u64 target = get_ticks() + usec_to_tick(usec);
+	u64 now = get_ticks();
+	u64 ctl, evnt;
+	uint bit;
 
-	/* At EL2 or above, use the event stream to avoid polling CNTPCT_EL0 so often */
-	if (current_el() >= 2) {
-		u32 cnthctl_val;
-		const u8 event_period = 0x7;
+	/* Events come every 2^(bit + 1) ticks; aim for at least four */
+	if (target <= now || (target - now) / 4 < 4)
+		return;
+	bit = min(ilog2((target - now) / 4) - 1, 15);
 
-		asm volatile("mrs %0, cnthctl_el2" : "=r" (cnthctl_val));
+	evnt = CNTHCTL_EL2_EVNT_EN | CNTHCTL_EL2_EVNT_I(bit);
+	if (current_el() >= 2) {
+		asm volatile("mrs %0, cnthctl_el2" : "=r" (ctl));
 		asm volatile("msr cnthctl_el2, %0" : : "r"
-			(cnthctl_val | CNTHCTL_EL2_EVNT_EN | CNTHCTL_EL2_EVNT_I(event_period)));
-
-		while (get_ticks() + (1ULL << event_period) <= target)
-			wfe();
-
-		/* Reset the event stream */
-		asm volatile("msr cnthctl_el2, %0" : : "r" (cnthctl_val));
+			((ctl & ~CNTHCTL_EL2_EVNT_I(0xf)) | evnt));
+	} else {
+		/* CNTKCTL_EL1 has the same event-stream fields */
+		asm volatile("mrs %0, cntkctl_el1" : "=r" (ctl));
+		asm volatile("msr cntkctl_el1, %0" : : "r"
+			((ctl & ~CNTHCTL_EL2_EVNT_I(0xf)) | evnt));
 	}
+	isb();
+
+	while (get_ticks() + (2ULL << bit) <= target)
+		wfe();
 
-	/* Fall back to polling CNTPCT_EL0 */
-	while (get_ticks() <= target)
-		;
+	/* Put the event stream back as it was */
+	if (current_el() >= 2)
+		asm volatile("msr cnthctl_el2, %0" : : "r" (ctl));
+	else
+		asm volatile("msr cntkctl_el1, %0" : : "r" (ctl));
+	isb();
 }
 #endif
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Counters from the Armv8 Performance Monitors Extension
+ *
+ * The cycle counter is always 64 bits. The event counters are only 32 bits
+ * wide before PMUv3p5, so they wrap after a few seconds of a busy CPU.
+ *
+ * Events are counted at every exception level U-Boot may run in, including
+ * non-secure EL2. If EL2 firmware sets MDCR_EL2.TPM, U-Boot at EL1 cannot use
+ * the PMU at all.
+ */
+
+#include <errno.h>
+#include <pmu.h>
+#include <asm/barriers.h>
+#include <linux/bitops.h>
+#include <linux/kernel.h>
+
+enum {
+	/* ID_AA64DFR0_EL1 */
+	DFR0_PMUVER_SHIFT	= 8,
+	DFR0_PMUVER_MASK	= 0xf,
+	PMUVER_IMPDEF		= 0xf,
+	PMUVER_V3P5		= 6,
+
+	/* PMCR_EL0 */
+	PMCR_E			= BIT(0),
+	PMCR_P			= BIT(1),
+	PMCR_C			= BIT(2),
+	PMCR_LC			= BIT(6),
+	PMCR_LP			= BIT(7),
+	PMCR_N_SHIFT		= 11,
+	PMCR_N_MASK		= 0x1f,
+
+	/* PMEVTYPER<n>_EL0 and PMCCFILTR_EL0 */
+	PMEVTYPER_NSH		= BIT(27),
+
+	/* Common events */
+	EVT_L1D_CACHE_REFILL	= 0x03,
+	EVT_L1D_TLB_REFILL	= 0x05,
+	EVT_INST_RETIRED	= 0x08,
+
+	/* Bit for the cycle counter in PMCNTENSET_EL0 */
+	PMCNTEN_CYCLES		= BIT(31),
+};
+
+#define pmu_read_reg(reg)	({					\
+	u64 __val;							\
+	asm volatile("mrs %0, " #reg : "=r" (__val));			\
+	__val;								\
+})
+
+#define pmu_write_reg(reg, val)						\
+	asm volatile("msr " #reg ", %0" : : "r" ((u64)(val)))
+
+static const char *const pmu_event_names[PMU_EVENT_COUNT] = {
+	[PMU_CYCLES]		= "cycles",
+	[PMU_INSNS]		= "insns",
+	[PMU_CACHE_MISSES]	= "cache-miss",
+	[PMU_TLB_MISSES]	= "tlb-miss",
+};
+
+/* Return the PMU version, or 0 if there is no architected PMU */
+static uint pmu_version(void)
+{
+	uint ver;
+
+	ver = (pmu_read_reg(id_aa64dfr0_el1) >> DFR0_PMUVER_SHIFT) &
+		DFR0_PMUVER_MASK;
+
+	return ver == PMUVER_IMPDEF ? 0 : ver;
+}
+
+/* Event counters used, by counter number: PMU_INSNS onwards */
+static u32 pmu_mask(u64 pmcr)
+{
+	uint n = (pmcr >> PMCR_N_SHIFT) & PMCR_N_MASK;
+
+	n = min_t(uint, n, PMU_EVENT_COUNT - PMU_INSNS);
+
+	return PMCNTEN_CYCLES | (BIT(n) - 1);
+}
+
+int pmu_start(void)
+{
+	uint ver = pmu_version();
+	u32 mask;
+	u64 pmcr;
+
+	if (!ver)
+		return -ENOSYS;
+
+	pmcr = pmu_read_reg(pmcr_el0);
+	mask = pmu_mask(pmcr);
+	if ((pmcr & PMCR_E) &&
+	    (pmu_read_reg(pmcntenset_el0) & mask) == mask)
+		return 0;
+
+	pmu_write_reg(pmccfiltr_el0, PMEVTYPER_NSH);
+	if (mask & BIT(0))
+		pmu_write_reg(pmevtyper0_el0, PMEVTYPER_NSH | EVT_INST_RETIRED);
+	if (mask & BIT(1))
+		pmu_write_reg(pmevtyper1_el0,
+			      PMEVTYPER_NSH | EVT_L1D_CACHE_REFILL);
+	if (mask & BIT(2))
+		pmu_write_reg(pmevtyper2_el0,
+			      PMEVTYPER_NSH | EVT_L1D_TLB_REFILL);
+
+	pmcr |= PMCR_E | PMCR_P | PMCR_C | PMCR_LC;
+	if (ver >= PMUVER_V3P5)
+		pmcr |= PMCR_LP;
+	pmu_write_reg(pmcr_el0, pmcr);
+	isb();
+	pmu_write_reg(pmcntenset_el0, mask);
+	isb();
+
+	return 0;
+}
+
+void pmu_reset(void)
+{
+	if (!pmu_version())
+		return;
+	pmu_write_reg(pmcr_el0, pmu_read_reg(pmcr_el0) | PMCR_P | PMCR_C);
+	isb();
+}
+
+void pmu_read(u64 counts[PMU_EVENT_COUNT])
+{
+	u32 enabled = 0;
+
+	if (pmu_version())
+		enabled = pmu_read_reg(pmcntenset_el0);
+	counts[PMU_CYCLES] = enabled & PMCNTEN_CYCLES ?
+		pmu_read_reg(pmccntr_el0) : 0;
+	counts[PMU_INSNS] = enabled & BIT(0) ? pmu_read_reg(pmevcntr0_el0) : 0;
+	counts[PMU_CACHE_MISSES] = enabled & BIT(1) ?
+		pmu_read_reg(pmevcntr1_el0) : 0;
+	counts[PMU_TLB_MISSES] = enabled & BIT(2) ?
+		pmu_read_reg(pmevcntr2_el0) : 0;
+}
+
+const char *pmu_event_name(enum pmu_event event)
+{
+	return pmu_event_names[event];
+}
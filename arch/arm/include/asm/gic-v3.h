@@ -13,6 +13,8 @@
 #define GICR_CTLR_ENABLE_LPIS		BIT(0)
 #define GICR_CTLR_RWP			BIT(3)
 
+#define GICR_TYPER_VLPIS		BIT(1)
+#define GICR_TYPER_LAST			BIT(4)
 #define GICR_TYPER_CPU_NUMBER(r)	(((r) >> 8) & 0xffff)
 
 #define GICR_WAKER_PROCESSORSLEEP	BIT(1)
@@ -143,6 +143,50 @@ lr	.req	x30
 #endif
 .endm
 
+/*
+ * Apply the packed relative relocations in .relr.dyn
+ * @loc_off:	offset to add to each link-time location
+ * @val_off:	offset to add to the value stored there
+ * @ptr, @end, @entry, @val, @where, @word: temporary registers
+ *
+ * An even entry is the link-time address of a word to fix up. An odd entry
+ * is a bitmap: bit n (1 to 63) covers the (n - 1)th word after the last word
+ * handled, and the window then moves on by 63 words.
+ */
+.macro	relr_fixup, loc_off, val_off, ptr, end, entry, val, where, word
+	adrp	\ptr, __relr_dyn_start
+	add	\ptr, \ptr, #:lo12:__relr_dyn_start
+	adrp	\end, __relr_dyn_end
+	add	\end, \end, #:lo12:__relr_dyn_end
+.Lrelr_next\@:
+	cmp	\ptr, \end
+	b.hs	.Lrelr_done\@
+	ldr	\entry, [\ptr], #8
+	tbnz	\entry, #0, .Lrelr_bitmap\@
+	add	\where, \entry, \loc_off	/* address entry: fix one word */
+	ldr	\val, [\where]
+	add	\val, \val, \val_off
+	str	\val, [\where], #8	/* next window starts after it */
+	b	.Lrelr_next\@
+.Lrelr_bitmap\@:
+	mov	\word, \where
+	lsr	\entry, \entry, #1
+.Lrelr_bit\@:
+	cbz	\entry, .Lrelr_window\@
+	tbz	\entry, #0, .Lrelr_skip\@
+	ldr	\val, [\word]
+	add	\val, \val, \val_off
+	str	\val, [\word]
+.Lrelr_skip\@:
+	add	\word, \word, #8
+	lsr	\entry, \entry, #1
+	b	.Lrelr_bit\@
+.Lrelr_window\@:
+	add	\where, \where, #(63 * 8)
+	b	.Lrelr_next\@
+.Lrelr_done\@:
+.endm
+
 /*
  * Switch from EL3 to EL2 for ARMv8
  * @ep:     kernel entry point
@@ -9,11 +9,13 @@
 #include <asm/gic.h>
 #include <asm/gic-v3.h>
 #include <asm/io.h>
+#include <asm/system.h>
 #include <dm/acpi.h>
 #include <dt-bindings/interrupt-controller/arm-gic.h>
 #include <linux/bitops.h>
 #include <linux/printk.h>
 #include <linux/sizes.h>
+#include <linux/stringify.h>
 
 static u32 lpi_id_bits;
 
@@ -223,8 +225,164 @@ static int arm_gic_v3_of_xlate(struct irq *irq, struct ofnode_phandle_args *args
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(IRQ_DISPATCH)
+/* Priority given to interrupts with a handler, and the mask set in ICC_PMR */
+#define GIC_IRQ_PRIORITY	0xa0
+#define GIC_PRIORITY_MASK	0xf0
+
+/* ICC_SRE_ELx: use the system-register interface */
+#define ICC_SRE_SRE		BIT(0)
+
+/* IDs from 1020 upwards are special, e.g. 1023 means none is pending */
+#define GIC_SPECIAL_ID		1020
+
+#define gic_read_sysreg(reg)	({					\
+	u64 __val;							\
+	asm volatile("mrs %0, " __stringify(reg) : "=r" (__val));	\
+	__val;								\
+})
+
+#define gic_write_sysreg(reg, val)					\
+	asm volatile("msr " __stringify(reg) ", %0" : : "r" ((u64)(val)))
+
+/*
+ * gic_v3_priv - details used to dispatch interrupts
+ *
+ * @gicd: Distributor, or NULL if it could not be found
+ * @sgi_base: SGI/PPI frame of this CPU's redistributor
+ */
+struct gic_v3_priv {
+	void __iomem *gicd;
+	void __iomem *sgi_base;
+};
+
+/* Find the redistributor whose affinity matches this CPU */
+static void __iomem *gic_v3_find_redist(struct udevice *dev)
+{
+	fdt_size_t size;
+	fdt_addr_t addr;
+	void __iomem *rd;
+	u64 mpidr, aff, typer;
+
+	addr = dev_read_addr_size_index(dev, 1, &size);
+	if (addr == FDT_ADDR_T_NONE)
+		return NULL;
+
+	/* GICR_TYPER holds Aff3.Aff2.Aff1.Aff0 in its top half */
+	mpidr = read_mpidr();
+	aff = (mpidr >> 32 & 0xff) << 24 | (mpidr & 0xffffff);
+	for (rd = (void __iomem *)(uintptr_t)addr;
+	     rd < (void __iomem *)(uintptr_t)addr + size;
+	     rd += typer & GICR_TYPER_VLPIS ? SZ_256K : SZ_128K) {
+		typer = readq(rd + GICR_TYPER);
+		if (typer >> 32 == aff)
+			return rd + SZ_64K;
+		if (typer & GICR_TYPER_LAST)
+			break;
+	}
+
+	return NULL;
+}
+
+static int arm_gic_v3_probe(struct udevice *dev)
+{
+	struct gic_v3_priv *priv = dev_get_priv(dev);
+	fdt_addr_t addr;
+
+	/* the driver is also used just for ACPI, so keep going on error */
+	addr = dev_read_addr_index(dev, 0);
+	priv->sgi_base = gic_v3_find_redist(dev);
+	if (addr == FDT_ADDR_T_NONE || !priv->sgi_base) {
+		log_debug("Cannot find GIC registers; no interrupts\n");
+		return 0;
+	}
+	priv->gicd = (void __iomem *)(uintptr_t)addr;
+
+	/*
+	 * Firmware has set up the distributor and woken the redistributor,
+	 * so just enable Group 1 interrupts at the CPU interface
+	 */
+	if (current_el() == 2)
+		gic_write_sysreg(ICC_SRE_EL2,
+				 gic_read_sysreg(ICC_SRE_EL2) | ICC_SRE_SRE);
+	else
+		gic_write_sysreg(ICC_SRE_EL1,
+				 gic_read_sysreg(ICC_SRE_EL1) | ICC_SRE_SRE);
+	isb();
+	gic_write_sysreg(ICC_PMR_EL1, GIC_PRIORITY_MASK);
+	gic_write_sysreg(ICC_IGRPEN1_EL1, 1);
+	isb();
+
+	return 0;
+}
+
+static int arm_gic_v3_set_enable(struct irq *irq, bool enable)
+{
+	struct gic_v3_priv *priv = dev_get_priv(irq->dev);
+	void __iomem *base;
+	u32 bit = BIT(irq->id % 32);
+	ulong id = irq->id;
+
+	if (!priv->gicd)
+		return -ENODEV;
+	if (id >= GIC_SPECIAL_ID)
+		return -EINVAL;
+
+	/* SGIs and PPIs are banked in the redistributor, SPIs are shared */
+	base = id < 32 ? priv->sgi_base : priv->gicd;
+	if (!enable) {
+		writel(bit, base + GICD_ICENABLERn + id / 32 * 4);
+		return 0;
+	}
+
+	writeb(GIC_IRQ_PRIORITY, base + GICD_IPRIORITYRn + id);
+	setbits_le32(base + GICD_IGROUPRn + id / 32 * 4, bit);
+	if (id >= 32) {
+		u32 shift = id % 16 * 2 + 1;
+
+		/* route to this CPU, then set edge or level from the DT */
+		writeq(read_mpidr() & 0xff00ffffffULL,
+		       base + GICD_IROUTERn + id * 8);
+		if (irq->flags & IRQ_TYPE_EDGE_BOTH)
+			setbits_le32(base + GICD_ICFGR + id / 16 * 4,
+				     BIT(shift));
+		else
+			clrbits_le32(base + GICD_ICFGR + id / 16 * 4,
+				     BIT(shift));
+	}
+	writel(bit, base + GICD_ISENABLERn + id / 32 * 4);
+
+	return 0;
+}
+
+static int arm_gic_v3_ack(struct udevice *dev, ulong *idp)
+{
+	ulong id;
+
+	id = gic_read_sysreg(ICC_IAR1_EL1) & 0xffffff;
+	if (id >= GIC_SPECIAL_ID && id < 8192)
+		return -ENOENT;
+	*idp = id;
+
+	return 0;
+}
+
+static int arm_gic_v3_eoi(struct udevice *dev, ulong id)
+{
+	gic_write_sysreg(ICC_EOIR1_EL1, id);
+	isb();
+
+	return 0;
+}
+#endif /* IRQ_DISPATCH */
+
 static const struct irq_ops arm_gic_v3_ops = {
 	.of_xlate		=  arm_gic_v3_of_xlate,
+#if CONFIG_IS_ENABLED(IRQ_DISPATCH)
+	.set_enable		= arm_gic_v3_set_enable,
+	.ack			= arm_gic_v3_ack,
+	.eoi			= arm_gic_v3_eoi,
+#endif
 };
 
 U_BOOT_DRIVER(arm_gic_v3) = {
@@ -232,6 +390,10 @@ U_BOOT_DRIVER(arm_gic_v3) = {
 	.id		= UCLASS_IRQ,
 	.of_match	= gic_v3_ids,
 	.ops		= &arm_gic_v3_ops,
+#if CONFIG_IS_ENABLED(IRQ_DISPATCH)
+	.probe		= arm_gic_v3_probe,
+	.priv_auto	= sizeof(struct gic_v3_priv),
+#endif
 	ACPI_OPS_PTR(&gic_v3_acpi_ops)
 };
 
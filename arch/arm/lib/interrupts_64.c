@@ -7,6 +7,8 @@
 #include <asm/esr.h>
 #include <asm/global_data.h>
 #include <asm/ptrace.h>
+#include <asm/system.h>
+#include <irq.h>
 #include <irq_func.h>
 #include <linux/compiler.h>
 #include <efi_loader.h>
@@ -21,6 +23,59 @@ int interrupt_init(void)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(IRQ_DISPATCH)
+/* PSTATE.I, as read from DAIF */
+#define DAIF_IRQ	BIT(7)
+
+void enable_interrupts(void)
+{
+	asm volatile("msr daifclr, #2" : : : "memory");
+}
+
+int disable_interrupts(void)
+{
+	ulong daif;
+
+	asm volatile("mrs %0, daif\n"
+		     "msr daifset, #2" : "=r" (daif) : : "memory");
+
+	return !(daif & DAIF_IRQ);
+}
+
+/*
+ * With interrupts enabled, sleep until one arrives. An interrupt which comes
+ * just before the WFE is taken but does not wake it, so use the event stream
+ * to wake up every 2^8 ticks (about 10us at 24MHz) regardless.
+ */
+void arch_irq_wait(void)
+{
+	ulong daif, ctl, evnt;
+
+	asm volatile("mrs %0, daif" : "=r" (daif));
+	if (daif & DAIF_IRQ) {
+		irq_handle_all();
+		return;
+	}
+
+	evnt = CNTHCTL_EL2_EVNT_EN | CNTHCTL_EL2_EVNT_I(7);
+	if (current_el() >= 2) {
+		asm volatile("mrs %0, cnthctl_el2" : "=r" (ctl));
+		asm volatile("msr cnthctl_el2, %0" : : "r"
+			((ctl & ~CNTHCTL_EL2_EVNT_I(0xf)) | evnt));
+		isb();
+		wfe();
+		asm volatile("msr cnthctl_el2, %0" : : "r" (ctl));
+	} else {
+		asm volatile("mrs %0, cntkctl_el1" : "=r" (ctl));
+		asm volatile("msr cntkctl_el1, %0" : : "r"
+			((ctl & ~CNTHCTL_EL2_EVNT_I(0xf)) | evnt));
+		isb();
+		wfe();
+		asm volatile("msr cntkctl_el1, %0" : : "r" (ctl));
+	}
+	isb();
+}
+#else
 void enable_interrupts(void)
 {
 	return;
@@ -30,6 +85,7 @@ int disable_interrupts(void)
 {
 	return 0;
 }
+#endif
 
 static void show_efi_loaded_images(struct pt_regs *regs)
 {
@@ -212,6 +268,8 @@ void do_sync(struct pt_regs *pt_regs)
 void do_irq(struct pt_regs *pt_regs)
 {
 	efi_restore_gd();
+	if (CONFIG_IS_ENABLED(IRQ_DISPATCH) && irq_handle_all() >= 0)
+		return;
 	printf("\"Irq\" handler, esr 0x%08lx\n", pt_regs->esr);
 	show_regs(pt_regs);
 	show_efi_loaded_images(pt_regs);
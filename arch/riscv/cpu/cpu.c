@@ -43,7 +43,8 @@ u32 available_harts_lock = 1;
 static DECLARE_BITMAP(riscv_isa, RISCV_ISA_EXT_MAX) __section(".data");
 
 static unsigned int riscv_cbom_block_size __section(".data");
-static unsigned int riscv_cboz_block_size __section(".data");
+/* Also read by memset() to zero whole cache blocks */
+unsigned int riscv_cboz_block_size __section(".data");
 /**
  * __riscv_isa_extension_available() - Check whether given extension
  * is available or not
@@ -7,6 +7,7 @@
 #ifndef _ASM_RISCV_SMP_H
 #define _ASM_RISCV_SMP_H
 
+#include <linux/sizes.h>
 #include <linux/types.h>
 
 /**
@@ -60,6 +61,42 @@ void handle_ipi(ulong hart);
  */
 int smp_call_function(ulong addr, ulong arg0, ulong arg1, int wait);
 
+/**
+ * smp_run_job() - Run a job on all harts in parallel
+ *
+ * The job is split into @nparts parts, which the harts take in turn until
+ * all are done. The calling hart takes part too, so the job completes even
+ * if no other hart answers. When this returns, all other harts are back in
+ * their wait loop, as they were before.
+ *
+ * Secondary harts run on small stacks (CONFIG_STACK_SIZE_SHIFT) and must not
+ * use driver model or the console, so @fn should only work on memory, e.g.
+ * filling, copying or checking a region of RAM.
+ *
+ * @fn: Function to call for each part, with @ctx and the part number
+ * @ctx: Context to pass to @fn
+ * @nparts: Number of parts
+ * Return: 0 if OK, -ve if the IPIs could not be sent (the job is still
+ *	completed by the calling hart)
+ */
+int smp_run_job(void (*fn)(void *ctx, uint part), void *ctx, uint nparts);
+
+/* Size of the part of a region which each hart fills in smp_memset() */
+#define SMP_MEMSET_CHUNK	SZ_4M
+
+/**
+ * smp_memset() - Fill a large region of memory using all harts
+ *
+ * This is worthwhile for regions of many MB, e.g. clearing RAM before a
+ * memory test or before booting an OS which expects it to be zeroed.
+ *
+ * @s: Start of region
+ * @c: Byte value to fill with
+ * @n: Number of bytes to fill
+ * Return: @s
+ */
+void *smp_memset(void *s, int c, size_t n);
+
 /**
  * riscv_init_ipi() - Initialize inter-process interrupt (IPI) driver
  *
@@ -12,71 +12,35 @@
 #define CBO_INVAL(base)						\
 	INSN_I(OPCODE_MISC_MEM, FUNC3(2), __RD(0),		\
 	       RS1(base), SIMM12(0))
-#define CBO_CLEAN(base)						\
-	INSN_I(OPCODE_MISC_MEM, FUNC3(2), __RD(0),		\
-	       RS1(base), SIMM12(1))
 #define CBO_FLUSH(base)						\
 	INSN_I(OPCODE_MISC_MEM, FUNC3(2), __RD(0),		\
 	       RS1(base), SIMM12(2))
-enum {
-	CBO_CLEAN,
-	CBO_FLUSH,
-	CBO_INVAL
-} riscv_cbo_ops;
 static int zicbom_block_size;
 extern unsigned int riscv_get_cbom_block_size(void);
-static inline void do_cbo_clean(unsigned long base)
-{
-	asm volatile ("add a0, %0, zero\n" CBO_CLEAN(%0) ::
-		      "r"(base) : "memory");
-}
-
-static inline void do_cbo_flush(unsigned long base)
-{
-	asm volatile ("add a0, %0, zero\n" CBO_FLUSH(%0) ::
-		      "r"(base) : "memory");
-}
-
-static inline void do_cbo_inval(unsigned long base)
-{
-	asm volatile ("add a0, %0, zero\n" CBO_INVAL(%0) ::
-		      "r"(base) : "memory");
-}
-
-static void cbo_op(int op_type, unsigned long start,
-		   unsigned long end)
-{
-	unsigned long op_size = end - start, size = 0;
-	void (*fn)(unsigned long base);
 
-	switch (op_type) {
-	case CBO_CLEAN:
-		fn = do_cbo_clean;
-		break;
-	case CBO_FLUSH:
-		fn = do_cbo_flush;
-		break;
-	case CBO_INVAL:
-		fn = do_cbo_inval;
-		break;
-	}
-	start &= ~(UL(zicbom_block_size - 1));
-	while (size < op_size) {
-		fn(start + size);
-		size += zicbom_block_size;
-	}
-}
+/*
+ * The operation is written out in each loop, rather than called through a
+ * pointer, since this runs once per cache block over buffers of many MB
+ */
+#define CBO_LOOP(insn, start, end)				\
+	do {							\
+		unsigned long __addr;				\
+								\
+		__addr = (start) & ~(UL(zicbom_block_size - 1));	\
+		for (; __addr < (end); __addr += zicbom_block_size)	\
+			asm volatile (insn(%0) :: "r"(__addr) : "memory"); \
+	} while (0)
 
 void cbo_flush(unsigned long start, unsigned long end)
 {
 	if (zicbom_block_size)
-		cbo_op(CBO_FLUSH, start, end);
+		CBO_LOOP(CBO_FLUSH, start, end);
 }
 
 void cbo_inval(unsigned long start, unsigned long end)
 {
 	if (zicbom_block_size)
-		cbo_op(CBO_INVAL, start, end);
+		CBO_LOOP(CBO_INVAL, start, end);
 }
 
 void invalidate_icache_all(void)
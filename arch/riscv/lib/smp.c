@@ -9,6 +9,7 @@
 #include <asm/barrier.h>
 #include <asm/global_data.h>
 #include <asm/smp.h>
+#include <linux/kernel.h>
 #include <linux/printk.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -126,3 +127,106 @@ int smp_call_function(ulong addr, ulong arg0, ulong arg1, int wait)
 
 	return send_ipi_many(&ipi, wait);
 }
+
+/**
+ * struct smp_job - A job being run on all harts
+ *
+ * There is only one of these, so that a hart which is slow to take its IPI
+ * never looks at a job which has gone away: @gen tells it whether the job it
+ * was sent is still running.
+ *
+ * @fn: Function to call for each part
+ * @ctx: Context to pass to @fn
+ * @nparts: Number of parts in the job
+ * @next: Next part for a hart to take
+ * @done: Number of parts completed
+ * @active: Number of harts looking at the job
+ * @gen: Generation number of the job, incremented when it completes
+ */
+static struct smp_job {
+	void (*fn)(void *ctx, uint part);
+	void *ctx;
+	uint nparts;
+	uint next;
+	uint done;
+	uint active;
+	ulong gen;
+} smp_job;
+
+static void smp_job_work(void)
+{
+	uint part;
+
+	for (;;) {
+		part = __atomic_fetch_add(&smp_job.next, 1, __ATOMIC_SEQ_CST);
+		if (part >= smp_job.nparts)
+			break;
+		smp_job.fn(smp_job.ctx, part);
+		__atomic_fetch_add(&smp_job.done, 1, __ATOMIC_SEQ_CST);
+	}
+}
+
+static void smp_job_secondary(ulong hart, ulong gen, ulong unused)
+{
+	__atomic_fetch_add(&smp_job.active, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&smp_job.gen, __ATOMIC_SEQ_CST) == gen)
+		smp_job_work();
+	__atomic_fetch_sub(&smp_job.active, 1, __ATOMIC_SEQ_CST);
+}
+
+int smp_run_job(void (*fn)(void *ctx, uint part), void *ctx, uint nparts)
+{
+	int ret;
+
+	smp_job.fn = fn;
+	smp_job.ctx = ctx;
+	smp_job.nparts = nparts;
+	smp_job.done = 0;
+	__atomic_store_n(&smp_job.next, 0, __ATOMIC_SEQ_CST);
+
+	/* Harts which do not answer just leave more parts for the others */
+	ret = smp_call_function((ulong)smp_job_secondary, smp_job.gen, 0, 0);
+	smp_job_work();
+
+	while (__atomic_load_n(&smp_job.done, __ATOMIC_SEQ_CST) < nparts)
+		;
+
+	/* Stop late harts from starting, then wait for any which have */
+	__atomic_fetch_add(&smp_job.gen, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&smp_job.active, __ATOMIC_SEQ_CST))
+		;
+
+	return ret;
+}
+
+struct smp_memset_ctx {
+	char *s;
+	int c;
+	size_t n;
+	size_t chunk;
+};
+
+static void smp_memset_part(void *ctx, uint part)
+{
+	struct smp_memset_ctx *msc = ctx;
+	size_t ofs = (size_t)part * msc->chunk;
+
+	memset(msc->s + ofs, msc->c, min(msc->chunk, msc->n - ofs));
+}
+
+void *smp_memset(void *s, int c, size_t n)
+{
+	struct smp_memset_ctx msc = {
+		.s = s,
+		.c = c,
+		.n = n,
+		.chunk = SMP_MEMSET_CHUNK,
+	};
+
+	if (n < 2 * SMP_MEMSET_CHUNK)
+		return memset(s, c, n);
+
+	smp_run_job(smp_memset_part, &msc, DIV_ROUND_UP(n, msc.chunk));
+
+	return s;
+}
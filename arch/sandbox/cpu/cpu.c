@@ -10,6 +10,7 @@
 #include <errno.h>
 #include <log.h>
 #include <os.h>
+#include <sprof.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <asm/malloc.h>
@@ -450,3 +451,15 @@ int sandbox_load_other_fdt(void **fdtp, int *sizep)
 
 	return 0;
 }
+
+#if IS_ENABLED(CONFIG_SPROF)
+int arch_sprof_start(uint period_us)
+{
+	return os_prof_timer(period_us, sprof_sample) ? -EIO : 0;
+}
+
+void arch_sprof_stop(void)
+{
+	os_prof_timer(0, NULL);
+}
+#endif
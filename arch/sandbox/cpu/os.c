@@ -21,11 +21,14 @@
 #include <time.h>
 #include <ucontext.h>
 #include <unistd.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <linux/compiler_attributes.h>
+#include <linux/perf_event.h>
 #include <linux/types.h>
 
 #include <asm/fuzzing_engine.h>
@@ -370,6 +373,54 @@ static void os_signal_handler(int sig, siginfo_t *info, void *con)
 	os_signal_action(sig, pc);
 }
 
+static void (*os_prof_handler)(ulong pc, ulong fp, ulong sp);
+
+static void os_sigprof_handler(int sig, siginfo_t *info, void *con)
+{
+	ucontext_t __maybe_unused *context = con;
+	ulong pc = 0, fp = 0, sp = 0;
+
+#if defined(__x86_64__)
+	pc = context->uc_mcontext.gregs[REG_RIP];
+	fp = context->uc_mcontext.gregs[REG_RBP];
+	sp = context->uc_mcontext.gregs[REG_RSP];
+#elif defined(__aarch64__)
+	pc = context->uc_mcontext.pc;
+	fp = context->uc_mcontext.regs[29];
+	sp = context->uc_mcontext.sp;
+#endif
+	if (pc && os_prof_handler)
+		os_prof_handler(pc, fp, sp);
+}
+
+int os_prof_timer(unsigned int period_us,
+		  void (*handler)(ulong pc, ulong fp, ulong sp))
+{
+	struct itimerval it = {};
+	struct sigaction act = {};
+
+	if (handler) {
+		act.sa_sigaction = os_sigprof_handler;
+		sigemptyset(&act.sa_mask);
+		act.sa_flags = SA_SIGINFO | SA_RESTART;
+		if (sigaction(SIGPROF, &act, NULL))
+			return -1;
+		os_prof_handler = handler;
+		it.it_interval.tv_sec = period_us / 1000000;
+		it.it_interval.tv_usec = period_us % 1000000;
+		it.it_value = it.it_interval;
+	}
+
+	if (setitimer(ITIMER_PROF, &it, NULL))
+		return -1;
+	if (!handler) {
+		signal(SIGPROF, SIG_IGN);
+		os_prof_handler = NULL;
+	}
+
+	return 0;
+}
+
 int os_setup_signal_handlers(void)
 {
 	struct sigaction act;
@@ -1195,3 +1246,42 @@ int main(int argc, char *argv[])
 	return sandbox_main(argc, argv);
 }
 #endif
+
+int os_insn_count_start(void)
+{
+	struct perf_event_attr attr;
+	int fd;
+
+	memset(&attr, '\0', sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+	if (fd < 0)
+		return -errno;
+	if (ioctl(fd, PERF_EVENT_IOC_RESET, 0) ||
+	    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0)) {
+		close(fd);
+		return -EIO;
+	}
+
+	return fd;
+}
+
+int os_insn_count_end(int handle, unsigned long long *countp)
+{
+	unsigned long long count;
+	int ret = 0;
+
+	ioctl(handle, PERF_EVENT_IOC_DISABLE, 0);
+	if (read(handle, &count, sizeof(count)) != sizeof(count))
+		ret = -EIO;
+	close(handle);
+	*countp = ret ? 0 : count;
+
+	return ret;
+}
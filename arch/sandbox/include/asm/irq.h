@@ -11,10 +11,16 @@
  *
  * @count: Counts the number calls to the read_and_clear() method
  * @pending: true if an interrupt is pending, else false
+ * @enabled: Bit mask of enabled interrupts, indexed by ID
+ * @raised: Bit mask of raised interrupts, set by tests
+ * @eoi_count: Number of calls to the eoi() method
  */
 struct sandbox_irq_priv {
 	int count;
 	bool pending;
+	ulong enabled;
+	ulong raised;
+	int eoi_count;
 };
 
 #endif /* __SANDBOX_IRQ_H */
@@ -43,6 +43,7 @@ void bootm_announce_and_cleanup(void)
 #if IS_ENABLED(CONFIG_BOOTSTAGE_REPORT)
 	bootstage_report();
 #endif
+	flush();
 
 	/*
 	 * Call remove function of all devices with a removal flag set.
@@ -609,9 +609,49 @@ int bootdev_next_label(struct bootflow_iter *iter, struct udevice **devp,
 	return 0;
 }
 
+static int bootdev_hunt_drv(struct bootdev_hunter *info, uint seq, bool show);
+
+/**
+ * bootdev_hunt_next() - Run the next unused hunter of a particular priority
+ *
+ * @prio: Priority to hunt for
+ * @show: true to show each hunter as it is used
+ * Return: 0 if a hunter was run, -ENOENT if all hunters of this priority have
+ *	been used, other -ve on error
+ */
+static int bootdev_hunt_next(enum bootdev_prio_t prio, bool show)
+{
+	struct bootdev_hunter *start;
+	struct bootstd_priv *std;
+	int n_ent, i;
+	int ret;
+
+	ret = bootstd_get_priv(&std);
+	if (ret)
+		return log_msg_ret("std", ret);
+
+	start = ll_entry_start(struct bootdev_hunter, bootdev_hunter);
+	n_ent = ll_entry_count(struct bootdev_hunter, bootdev_hunter);
+	for (i = 0; i < n_ent; i++) {
+		struct bootdev_hunter *info = start + i;
+
+		if (prio != info->prio || (std->hunters_used & BIT(i)))
+			continue;
+		ret = bootdev_hunt_drv(info, i, show);
+		log_debug("bootdev_hunt_drv() return %d\n", ret);
+		if (ret)
+			return log_msg_ret("hun", ret);
+
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
 int bootdev_next_prio(struct bootflow_iter *iter, struct udevice **devp)
 {
 	struct udevice *dev = *devp;
+	struct udevice *last;
 	bool found;
 	int ret;
 
@@ -625,6 +665,7 @@ int bootdev_next_prio(struct bootflow_iter *iter, struct udevice **devp)
 		 * Don't probe devices here since they may not be of the
 		 * required priority
 		 */
+		last = dev;
 		if (!dev)
 			uclass_find_first_device(UCLASS_BOOTDEV, &dev);
 		else
@@ -640,26 +681,35 @@ int bootdev_next_prio(struct bootflow_iter *iter, struct udevice **devp)
 				  iter->cur_prio);
 			if (plat->prio == iter->cur_prio)
 				break;
+			last = dev;
 			uclass_find_next_device(&dev);
 		}
 
+		if (!dev && (iter->flags & BOOTFLOWIF_HUNT)) {
+			/*
+			 * Run one more hunter of this priority, so that the
+			 * devices from each hunter are scanned before the next
+			 * (possibly slow) hunter runs. New bootdevs are added
+			 * at the end of the uclass, so carry on after the last
+			 * device seen.
+			 */
+			ret = bootdev_hunt_next(iter->cur_prio,
+						iter->flags & BOOTFLOWIF_SHOW);
+			log_debug("- bootdev_hunt_next() ret %d\n", ret);
+			if (!ret) {
+				dev = last;
+				continue;
+			}
+			if (ret != -ENOENT)
+				return log_msg_ret("hun", ret);
+		}
+
 		/* none found for this priority, so move to the next */
 		if (!dev) {
 			log_debug("None found at prio %d, moving to %d\n",
 				  iter->cur_prio, iter->cur_prio + 1);
 			if (++iter->cur_prio == BOOTDEVP_COUNT)
 				return log_msg_ret("fin", -ENODEV);
-
-			if (iter->flags & BOOTFLOWIF_HUNT) {
-				/* hunt to find new bootdevs */
-				ret = bootdev_hunt_prio(iter->cur_prio,
-							iter->flags &
-							BOOTFLOWIF_SHOW);
-				log_debug("- bootdev_hunt_prio() ret %d\n",
-					  ret);
-				if (ret)
-					return log_msg_ret("hun", ret);
-			}
 		} else {
 			ret = device_probe(dev);
 			if (ret)
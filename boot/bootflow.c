@@ -11,11 +11,14 @@
 #include <bootmeth.h>
 #include <bootstd.h>
 #include <dm.h>
+#include <env.h>
 #include <env_internal.h>
 #include <malloc.h>
+#include <part.h>
 #include <serial.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
+#include <u-boot/uuid.h>
 
 /* error codes used to signal running out of things */
 enum {
@@ -567,6 +570,132 @@ int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow)
 	return ret;
 }
 
+/* Environment variable holding the bootflow used by the last boot */
+#define BOOTFLOW_CACHE_VAR	"bootflow_cache"
+
+/**
+ * bootflow_cache_media() - Get the identity of the media holding a bootflow
+ *
+ * @blk: Block device
+ * @part: Partition number
+ * @buf: Returns the partition UUID, or "-" if there is none
+ * @size: Size of @buf
+ */
+static void bootflow_cache_media(struct udevice *blk, int part, char *buf,
+				 int size)
+{
+	struct disk_partition info;
+
+	strlcpy(buf, "-", size);
+	if (!IS_ENABLED(CONFIG_PARTITION_UUIDS) || !blk || !part)
+		return;
+	if (!part_get_info(dev_get_uclass_plat(blk), part, &info) &&
+	    *disk_partition_uuid(&info))
+		strlcpy(buf, disk_partition_uuid(&info), size);
+}
+
+int bootflow_cache_save(const struct bootflow *bflow)
+{
+	char media[UUID_STR_LEN + 1];
+	const char *old;
+	char val[256];
+	int ret;
+
+	if (!bflow->dev || !bflow->blk || !bflow->fname)
+		return -ENOTSUPP;
+
+	bootflow_cache_media(bflow->blk, bflow->part, media, sizeof(media));
+	ret = snprintf(val, sizeof(val), "%s %s %x %s %x %s %s",
+		       dev_get_uclass_name(dev_get_parent(bflow->dev)),
+		       bflow->dev->name, bflow->part, bflow->method->name,
+		       bflow->size, media, bflow->fname);
+	if (ret >= sizeof(val))
+		return log_msg_ret("len", -E2BIG);
+
+	old = env_get(BOOTFLOW_CACHE_VAR);
+	if (old && !strcmp(old, val))
+		return 0;
+
+	ret = env_set(BOOTFLOW_CACHE_VAR, val);
+	if (ret)
+		return log_msg_ret("set", ret);
+	ret = env_save();
+	if (ret)
+		log_debug("Cannot save environment (err=%d)\n", ret);
+
+	return 0;
+}
+
+int bootflow_scan_cached(struct bootflow_iter *iter, int flags,
+			 struct bootflow *bflow)
+{
+	struct udevice *dev, *method;
+	char media[UUID_STR_LEN + 1];
+	char *str, *pos, *tok[6];
+	const char *val;
+	int part, size;
+	int ret, i;
+
+	val = env_get(BOOTFLOW_CACHE_VAR);
+	if (!val)
+		return -ENOENT;
+	str = strdup(val);
+	if (!str)
+		return log_msg_ret("str", -ENOMEM);
+
+	/* uclass, bootdev, part, bootmeth, size, media; the rest is the file */
+	pos = str;
+	for (i = 0; i < ARRAY_SIZE(tok); i++) {
+		tok[i] = strsep(&pos, " ");
+		if (!pos) {
+			ret = log_msg_ret("fmt", -EINVAL);
+			goto out;
+		}
+	}
+	part = hextoul(tok[2], NULL);
+	size = hextoul(tok[4], NULL);
+
+	ret = uclass_find_device_by_name(UCLASS_BOOTDEV, tok[1], &dev);
+	if (ret && (flags & BOOTFLOWIF_HUNT)) {
+		bootdev_hunt(tok[0], false);
+		ret = uclass_find_device_by_name(UCLASS_BOOTDEV, tok[1], &dev);
+	}
+	if (ret)
+		goto out;
+	ret = uclass_find_device_by_name(UCLASS_BOOTMETH, tok[3], &method);
+	if (ret)
+		goto out;
+	ret = device_probe(dev);
+	if (ret)
+		goto out;
+
+	bootflow_iter_init(iter, flags | BOOTFLOWIF_SINGLE_DEV |
+			   BOOTFLOWIF_SINGLE_PARTITION |
+			   BOOTFLOWIF_SKIP_GLOBAL);
+	iter->method = method;
+	iter->part = part;
+	iter->dev = dev;
+	ret = bootdev_get_bootflow(dev, iter, bflow);
+	if (ret) {
+		bootflow_free(bflow);
+		goto out;
+	}
+
+	bootflow_cache_media(bflow->blk, part, media, sizeof(media));
+	if (bflow->size != size || !bflow->fname || strcmp(bflow->fname, pos) ||
+	    strcmp(media, tok[5])) {
+		log_debug("Bootflow '%s' changed since the last boot\n",
+			  bflow->name);
+		bootflow_free(bflow);
+		ret = -ESTALE;
+	}
+
+out:
+	free(str);
+
+	return ret;
+}
+
 int bootflow_iter_check_blk(const struct bootflow_iter *iter)
 {
 	const struct udevice *media = dev_get_parent(iter->dev);
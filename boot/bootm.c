@@ -687,12 +687,19 @@ static int bootm_load_os(struct bootm_headers *images, int boot_progress)
 			printf("Moving Image from 0x%lx to 0x%lx, end=0x%lx\n",
 			       load, relocated_addr,
 			       relocated_addr + image_size);
-			memmove((void *)relocated_addr, load_buf, image_size);
+			image_copy((void *)relocated_addr, load_buf, image_size);
 		}
 
 		images->ep = relocated_addr;
 		images->os.start = relocated_addr;
 		images->os.end = relocated_addr + image_size;
+
+		/*
+		 * image_size includes the BSS, so reserve all of it to stop
+		 * the ramdisk and FDT being placed where the kernel will be
+		 */
+		if (CONFIG_IS_ENABLED(LMB))
+			lmb_reserve(relocated_addr, image_size, LMB_NONE);
 	}
 
 	if (CONFIG_IS_ENABLED(LMB))
@@ -702,6 +709,41 @@ static int bootm_load_os(struct bootm_headers *images, int boot_progress)
 	return 0;
 }
 
+#ifdef CONFIG_SYS_BOOT_RAMDISK_HIGH
+/**
+ * bootm_ramdisk_in_place() - Check whether the ramdisk can be used in place
+ *
+ * Copying the ramdisk high can take a long time for a large ramdisk. It is
+ * not needed if the ramdisk was loaded somewhere the kernel can reach and
+ * does not overlap the kernel, including its BSS.
+ *
+ * Setting initrd_high overrides this, as does having no ramdisk.
+ *
+ * @images: Images being booted
+ * Return: true to use the ramdisk where it is, false to relocate it
+ */
+static bool bootm_ramdisk_in_place(struct bootm_headers *images)
+{
+	ulong rd_start = images->rd_start;
+	ulong rd_end = images->rd_end;
+	phys_addr_t low;
+
+	if (!IS_ENABLED(CONFIG_BOOTM_RAMDISK_IN_PLACE) || !rd_start ||
+	    env_get("initrd_high"))
+		return false;
+	if (!IS_ALIGNED(rd_start, SZ_4K))
+		return false;
+
+	low = env_get_bootm_low();
+	if (rd_start < low || rd_end > low + env_get_bootm_mapsize())
+		return false;
+	if (rd_start < images->os.end && rd_end > images->os.start)
+		return false;
+
+	return true;
+}
+#endif
+
 /**
  * bootm_disable_interrupts() - Disable interrupts in preparation for load/boot
  *
@@ -1012,9 +1054,17 @@ int bootm_run_states(struct bootm_info *bmi, int states)
 	if (!ret && (states & BOOTM_STATE_RAMDISK)) {
 		ulong rd_len = images->rd_end - images->rd_start;
 
-		ret = boot_ramdisk_high(images->rd_start, rd_len,
-					&images->initrd_start,
-					&images->initrd_end);
+		if (bootm_ramdisk_in_place(images)) {
+			printf("   Using Ramdisk in place at %08lx, end %08lx\n",
+			       images->rd_start, images->rd_end);
+			images->initrd_start = images->rd_start;
+			images->initrd_end = images->rd_end;
+			lmb_reserve(images->rd_start, rd_len, LMB_NONE);
+		} else {
+			ret = boot_ramdisk_high(images->rd_start, rd_len,
+						&images->initrd_start,
+						&images->initrd_end);
+		}
 		if (!ret) {
 			env_set_hex("initrd_start", images->initrd_start);
 			env_set_hex("initrd_end", images->initrd_end);
@@ -418,15 +418,61 @@ static int avb_append_commandline(struct bootflow *bflow, char *cmdline)
 	return 0;
 }
 
-static int run_avb_verification(struct bootflow *bflow)
+/**
+ * avb_preloaded() - Check whether a partition was verified in place
+ *
+ * @out_data: Verification results
+ * @name: Partition name, without slot suffix
+ * @slot_suffix: Slot suffix ("_a", "_b" or "")
+ * @size: Number of bytes which are needed
+ * Return: true if at least @size bytes of the partition were loaded into the
+ *	buffer given to avb_set_preload()
+ */
+static bool avb_preloaded(AvbSlotVerifyData *out_data, const char *name,
+			  const char *slot_suffix, ulong size)
+{
+	AvbPartitionData *part;
+	size_t i;
+
+	if (!out_data)
+		return false;
+
+	for (i = 0; i < out_data->num_loaded_partitions; i++) {
+		part = &out_data->loaded_partitions[i];
+		if (!strncmp(part->partition_name, name, strlen(name)) &&
+		    !strcmp(part->partition_name + strlen(name), slot_suffix))
+			return part->preloaded && part->data_size >= size;
+	}
+
+	return false;
+}
+
+/**
+ * run_avb_verification() - Verify the boot partitions
+ *
+ * The boot and vendor_boot partitions are loaded straight to @loadaddr and
+ * @vloadaddr while they are verified, so that the data which is booted is the
+ * data which was verified, and is only read once.
+ *
+ * @bflow: Bootflow to verify
+ * @loadaddr: Address to load the boot partition to
+ * @vloadaddr: Address to load the vendor_boot partition to
+ * @boot_loaded: Returns true if the boot partition was loaded
+ * @vendor_loaded: Returns true if the vendor_boot partition was loaded
+ * Return: 0 if OK, negative errno on failure
+ */
+static int run_avb_verification(struct bootflow *bflow, ulong loadaddr,
+				ulong vloadaddr, bool *boot_loaded,
+				bool *vendor_loaded)
 {
 	struct blk_desc *desc = dev_get_uclass_plat(bflow->blk);
 	struct android_priv *priv = bflow->bootmeth_priv;
 	const char * const requested_partitions[] = {"boot", "vendor_boot", NULL};
 	struct AvbOps *avb_ops;
 	AvbSlotVerifyResult result;
-	AvbSlotVerifyData *out_data;
+	AvbSlotVerifyData *out_data = NULL;
 	enum avb_boot_state boot_state;
+	char partname[PART_NAME_LEN];
 	char *extra_args;
 	char slot_suffix[3] = "";
 	bool unlocked = false;
@@ -439,9 +485,22 @@ static int run_avb_verification(struct bootflow *bflow)
 	if (priv->slot)
 		sprintf(slot_suffix, "_%s", priv->slot);
 
+	/* Failing to preload is not fatal; the partitions are just read later */
+	snprintf(partname, sizeof(partname), "boot%s", slot_suffix);
+	avb_set_preload(avb_ops, partname, map_sysmem(loadaddr, 0),
+			priv->boot_img_size);
+	if (priv->header_version >= 3) {
+		snprintf(partname, sizeof(partname), "vendor_boot%s",
+			 slot_suffix);
+		avb_set_preload(avb_ops, partname, map_sysmem(vloadaddr, 0),
+				priv->vendor_boot_img_size);
+	}
+
 	ret = avb_ops->read_is_device_unlocked(avb_ops, &unlocked);
-	if (ret != AVB_IO_RESULT_OK)
-		return log_msg_ret("avb lock", -EIO);
+	if (ret != AVB_IO_RESULT_OK) {
+		ret = log_msg_ret("avb lock", -EIO);
+		goto free_ops;
+	}
 
 	result = avb_slot_verify(avb_ops,
 				 requested_partitions,
@@ -455,8 +514,8 @@ static int run_avb_verification(struct bootflow *bflow)
 		if (result != AVB_SLOT_VERIFY_RESULT_OK) {
 			printf("Verification failed, reason: %s\n",
 			       str_avb_slot_error(result));
-			avb_slot_verify_data_free(out_data);
-			return log_msg_ret("avb verify", -EIO);
+			ret = log_msg_ret("avb verify", -EIO);
+			goto free_out_data;
 		}
 		boot_state = AVB_GREEN;
 	} else {
@@ -465,8 +524,8 @@ static int run_avb_verification(struct bootflow *bflow)
 		    result != AVB_SLOT_VERIFY_RESULT_ERROR_VERIFICATION) {
 			printf("Unlocked verification failed, reason: %s\n",
 			       str_avb_slot_error(result));
-			avb_slot_verify_data_free(out_data);
-			return log_msg_ret("avb verify unlocked", -EIO);
+			ret = log_msg_ret("avb verify unlocked", -EIO);
+			goto free_out_data;
 		}
 		boot_state = AVB_ORANGE;
 	}
@@ -475,26 +534,39 @@ static int run_avb_verification(struct bootflow *bflow)
 	if (extra_args) {
 		/* extra_args will be modified after this. This is fine */
 		ret = avb_append_commandline_arg(bflow, extra_args);
-		if (ret < 0)
+		if (ret < 0) {
+			ret = log_msg_ret("avb cmdline", ret);
 			goto free_out_data;
+		}
 	}
 
 	if (result == AVB_SLOT_VERIFY_RESULT_OK) {
 		ret = avb_append_commandline(bflow, out_data->cmdline);
-		if (ret < 0)
+		if (ret < 0) {
+			ret = log_msg_ret("avb cmdline", ret);
 			goto free_out_data;
+		}
 	}
 
-	return 0;
+	*boot_loaded = avb_preloaded(out_data, "boot", slot_suffix,
+				     priv->boot_img_size);
+	*vendor_loaded = priv->header_version >= 3 &&
+		avb_preloaded(out_data, "vendor_boot", slot_suffix,
+			      priv->vendor_boot_img_size);
+	ret = 0;
 
  free_out_data:
 	if (out_data)
 		avb_slot_verify_data_free(out_data);
+ free_ops:
+	avb_ops_free(avb_ops);
 
-	return log_msg_ret("avb cmdline", ret);
+	return ret;
 }
 #else
-static int run_avb_verification(struct bootflow *bflow)
+static int run_avb_verification(struct bootflow *bflow, ulong loadaddr,
+				ulong vloadaddr, bool *boot_loaded,
+				bool *vendor_loaded)
 {
 	int ret;
 
@@ -516,8 +588,10 @@ static int boot_android_normal(struct bootflow *bflow)
 	int ret;
 	ulong loadaddr = env_get_hex("loadaddr", 0);
 	ulong vloadaddr = env_get_hex("vendor_boot_comp_addr_r", 0);
+	bool boot_loaded = false, vendor_loaded = false;
 
-	ret = run_avb_verification(bflow);
+	ret = run_avb_verification(bflow, loadaddr, vloadaddr, &boot_loaded,
+				   &vendor_loaded);
 	if (ret < 0)
 		return log_msg_ret("avb", ret);
 
@@ -526,16 +600,22 @@ static int boot_android_normal(struct bootflow *bflow)
 	if (ret < 0)
 		return log_msg_ret("read slot", ret);
 
-	ret = read_slotted_partition(desc, "boot", priv->slot, priv->boot_img_size,
-				     loadaddr);
-	if (ret < 0)
-		return log_msg_ret("read boot", ret);
+	if (!boot_loaded) {
+		ret = read_slotted_partition(desc, "boot", priv->slot,
+					     priv->boot_img_size, loadaddr);
+		if (ret < 0)
+			return log_msg_ret("read boot", ret);
+	}
 
 	if (priv->header_version >= 3) {
-		ret = read_slotted_partition(desc, "vendor_boot", priv->slot,
-					     priv->vendor_boot_img_size, vloadaddr);
-		if (ret < 0)
-			return log_msg_ret("read vendor_boot", ret);
+		if (!vendor_loaded) {
+			ret = read_slotted_partition(desc, "vendor_boot",
+						     priv->slot,
+						     priv->vendor_boot_img_size,
+						     vloadaddr);
+			if (ret < 0)
+				return log_msg_ret("read vendor_boot", ret);
+		}
 		set_avendor_bootimg_addr(vloadaddr);
 	}
 	set_abootimg_addr(loadaddr);
@@ -111,6 +111,7 @@ int expo_set_display(struct expo *exp, struct udevice *dev)
 
 	exp->display = dev;
 	exp->cons = cons;
+	exp->redraw = true;
 
 	return 0;
 }
@@ -139,6 +140,11 @@ int expo_calc_dims(struct expo *exp)
 	return 0;
 }
 
+void expo_redraw(struct expo *exp)
+{
+	exp->redraw = true;
+}
+
 void expo_set_text_mode(struct expo *exp, bool text_mode)
 {
 	exp->text_mode = text_mode;
@@ -196,18 +202,28 @@ int expo_render(struct expo *exp)
 
 	back = CONFIG_IS_ENABLED(SYS_WHITE_ON_BLACK) ? VID_BLACK : VID_WHITE;
 	colour = video_index_to_colour(vid_priv, back);
-	ret = video_fill(dev, colour);
-	if (ret)
-		return log_msg_ret("fill", ret);
-
 	if (exp->scene_id) {
 		scn = expo_lookup_scene_id(exp, exp->scene_id);
 		if (!scn)
 			return log_msg_ret("scn", -ENOENT);
+	}
 
-		ret = scene_render(scn);
+	if (IS_ENABLED(CONFIG_EXPO_PARTIAL_RENDER) && scn && !exp->redraw &&
+	    !exp->text_mode && exp->rendered_id == scn->id) {
+		ret = scene_render_changes(scn, colour);
+		if (ret)
+			return log_msg_ret("chg", ret);
+	} else {
+		ret = video_fill(dev, colour);
 		if (ret)
-			return log_msg_ret("ren", ret);
+			return log_msg_ret("fill", ret);
+		if (scn) {
+			ret = scene_render(scn);
+			if (ret)
+				return log_msg_ret("ren", ret);
+		}
+		exp->redraw = false;
+		exp->rendered_id = scn && !exp->text_mode ? scn->id : 0;
 	}
 
 	video_sync(dev, true);
@@ -267,6 +283,7 @@ int expo_apply_theme(struct expo *exp, ofnode node)
 		if (ret)
 			return log_msg_ret("app", ret);
 	}
+	exp->redraw = true;
 
 	return 0;
 }
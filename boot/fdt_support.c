@@ -10,9 +10,11 @@
 #include <abuf.h>
 #include <env.h>
 #include <log.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <net.h>
 #include <rng.h>
+#include <sort.h>
 #include <stdio_dev.h>
 #include <dm/device_compat.h>
 #include <dm/ofnode.h>
@@ -83,6 +85,437 @@ u32 fdt_getprop_u32_default(const void *fdt, const char *path,
 	return fdt_getprop_u32_default_node(fdt, off, 0, prop, dflt);
 }
 
+/*
+ * Batches of property changes
+ *
+ * Each fdt_setprop() which changes the size of a property moves the rest of
+ * the devicetree, so that a few hundred fixups on a large tree spend most of
+ * their time in memmove(). While a batch is active, the fixup helpers here
+ * record changes instead, then fdt_batch_finish() rewrites the tree once.
+ */
+
+/**
+ * struct fdt_batch_edit - a property change waiting to be written
+ *
+ * @node: Offset of the node, in the tree as it was when the batch started
+ * @nameoff: Offset of the property name in the strings block, which may be
+ *	beyond the end of the block for new names (see &fdt_batch.strings)
+ * @seq: Sequence number, so that later changes override earlier ones
+ * @len: Length of the value
+ * @done: true once written
+ * @data: Value
+ */
+struct fdt_batch_edit {
+	int node;
+	int nameoff;
+	int seq;
+	int len;
+	bool done;
+	u8 data[];
+};
+
+/**
+ * struct fdt_batch - the active batch
+ *
+ * @fdt: Tree being changed, NULL if there is no active batch
+ * @size_struct: Size of the structure block when the batch started
+ * @size_strings: Size of the strings block when the batch started
+ * @edit: Changes recorded so far
+ * @count: Number of changes
+ * @alloced: Number of changes which @edit has space for
+ * @strings: Property names which are not yet in the strings block
+ * @strings_len: Number of bytes used in @strings
+ */
+static struct fdt_batch {
+	void *fdt;
+	int size_struct;
+	int size_strings;
+	struct fdt_batch_edit **edit;
+	int count;
+	int alloced;
+	char *strings;
+	int strings_len;
+} fdt_batch;
+
+/* Drop any changes and take the tree as it is now as the starting point */
+static void fdt_batch_clear(const void *fdt)
+{
+	int i;
+
+	for (i = 0; i < fdt_batch.count; i++)
+		free(fdt_batch.edit[i]);
+	fdt_batch.count = 0;
+	fdt_batch.strings_len = 0;
+	fdt_batch.size_struct = fdt_size_dt_struct(fdt);
+	fdt_batch.size_strings = fdt_size_dt_strings(fdt);
+}
+
+static bool fdt_batch_active(const void *fdt)
+{
+	return fdt_batch.fdt && fdt_batch.fdt == fdt;
+}
+
+static const char *fdt_batch_name(const void *fdt,
+				  const struct fdt_batch_edit *edit)
+{
+	if (edit->nameoff >= fdt_batch.size_strings)
+		return fdt_batch.strings + edit->nameoff -
+			fdt_batch.size_strings;
+
+	return fdt_string(fdt, edit->nameoff);
+}
+
+int fdt_batch_start(void *fdt)
+{
+	int err;
+
+	if (fdt_batch.fdt)
+		return -FDT_ERR_BADSTATE;
+	err = fdt_check_header(fdt);
+	if (err)
+		return err;
+	fdt_batch.fdt = fdt;
+	fdt_batch_clear(fdt);
+
+	return 0;
+}
+
+/* Find or add a property name, returning its offset */
+static int fdt_batch_nameoff(const void *fdt, int node, const char *name)
+{
+	const char *strtab = fdt_string(fdt, 0);
+	int len = strlen(name) + 1;
+	const struct fdt_property *prop;
+	char *new;
+	int i;
+
+	prop = fdt_get_property(fdt, node, name, NULL);
+	if (prop)
+		return fdt32_to_cpu(prop->nameoff);
+	for (i = 0; i + len <= fdt_batch.size_strings; i++) {
+		if (!memcmp(strtab + i, name, len))
+			return i;
+	}
+	for (i = 0; i < fdt_batch.strings_len; i += strlen(new) + 1) {
+		new = fdt_batch.strings + i;
+		if (!strcmp(new, name))
+			return fdt_batch.size_strings + i;
+	}
+
+	new = realloc(fdt_batch.strings, fdt_batch.strings_len + len);
+	if (!new)
+		return -FDT_ERR_NOSPACE;
+	fdt_batch.strings = new;
+	memcpy(new + fdt_batch.strings_len, name, len);
+	fdt_batch.strings_len += len;
+
+	return fdt_batch.size_strings + fdt_batch.strings_len - len;
+}
+
+int fdt_batch_setprop(void *fdt, int nodeoffset, const char *name,
+		      const void *val, int len)
+{
+	struct fdt_batch_edit *edit, **ptr;
+	int nameoff;
+
+	if (!fdt_batch_active(fdt))
+		return fdt_setprop(fdt, nodeoffset, name, val, len);
+	if (!fdt_get_name(fdt, nodeoffset, NULL) || len < 0)
+		return -FDT_ERR_BADOFFSET;
+	nameoff = fdt_batch_nameoff(fdt, nodeoffset, name);
+	if (nameoff < 0)
+		return nameoff;
+
+	if (fdt_batch.count == fdt_batch.alloced) {
+		int alloced = max(fdt_batch.alloced * 2, 32);
+
+		ptr = realloc(fdt_batch.edit, alloced * sizeof(*ptr));
+		if (!ptr)
+			return -FDT_ERR_NOSPACE;
+		fdt_batch.edit = ptr;
+		fdt_batch.alloced = alloced;
+	}
+	edit = malloc(sizeof(*edit) + len);
+	if (!edit)
+		return -FDT_ERR_NOSPACE;
+	edit->node = nodeoffset;
+	edit->nameoff = nameoff;
+	edit->seq = fdt_batch.count;
+	edit->len = len;
+	edit->done = false;
+	memcpy(edit->data, val, len);
+	fdt_batch.edit[fdt_batch.count++] = edit;
+
+	return 0;
+}
+
+/* Check whether a property exists, or will once the batch is written */
+static bool fdt_batch_hasprop(const void *fdt, int nodeoffset,
+			      const char *name)
+{
+	int i;
+
+	if (fdt_get_property(fdt, nodeoffset, name, NULL))
+		return true;
+	if (!fdt_batch_active(fdt))
+		return false;
+	for (i = 0; i < fdt_batch.count; i++) {
+		if (fdt_batch.edit[i]->node == nodeoffset &&
+		    !strcmp(fdt_batch_name(fdt, fdt_batch.edit[i]), name))
+			return true;
+	}
+
+	return false;
+}
+
+static int fdt_batch_cmp(const void *a, const void *b)
+{
+	const struct fdt_batch_edit *ea = *(struct fdt_batch_edit **)a;
+	const struct fdt_batch_edit *eb = *(struct fdt_batch_edit **)b;
+
+	if (ea->node != eb->node)
+		return ea->node - eb->node;
+
+	return ea->seq - eb->seq;
+}
+
+/**
+ * fdt_batch_emit() - Write out the latest change to a property
+ *
+ * @edit: Changes for the current node, sorted by sequence number
+ * @count: Number of changes
+ * @nameoff: Property name to look for
+ * @out: Place to write the property, updated to point after it
+ * @end: End of the space available for writing
+ * Return: 0 if written, -FDT_ERR_NOTFOUND if there is no change for
+ *	@nameoff, -FDT_ERR_NOSPACE if there is no space
+ */
+static int fdt_batch_emit(struct fdt_batch_edit **edit, int count, int nameoff,
+			  char **out, char *end)
+{
+	struct fdt_batch_edit *last = NULL;
+	struct fdt_property *prop;
+	int i, size;
+
+	for (i = 0; i < count; i++) {
+		if (edit[i]->nameoff == nameoff) {
+			edit[i]->done = true;
+			last = edit[i];
+		}
+	}
+	if (!last)
+		return -FDT_ERR_NOTFOUND;
+
+	size = sizeof(*prop) + ALIGN(last->len, FDT_TAGSIZE);
+	if (*out + size > end)
+		return -FDT_ERR_NOSPACE;
+	prop = (struct fdt_property *)*out;
+	prop->tag = cpu_to_fdt32(FDT_PROP);
+	prop->len = cpu_to_fdt32(last->len);
+	prop->nameoff = cpu_to_fdt32(nameoff);
+	memcpy(prop->data, last->data, last->len);
+	memset(prop->data + last->len, '\0', size - sizeof(*prop) - last->len);
+	*out += size;
+
+	return 0;
+}
+
+/* Write out the changes to a node which are not for existing properties */
+static int fdt_batch_emit_new(struct fdt_batch_edit **edit, int count,
+			      char **out, char *end)
+{
+	int i, ret;
+
+	for (i = 0; i < count; i++) {
+		if (edit[i]->done)
+			continue;
+		ret = fdt_batch_emit(edit + i, count - i, edit[i]->nameoff, out,
+				     end);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * fdt_batch_rewrite() - Write the tree with the changes into a buffer
+ *
+ * The header and memory-reservation block are copied as is. The structure
+ * block is copied tag by tag, replacing the properties which are changed and
+ * adding new ones at the end of each node's properties. NOPs are dropped.
+ * The new property names are added to the end of the strings block.
+ *
+ * @fdt: Tree to rewrite, which must have its blocks in the usual order
+ * @buf: Buffer for the new tree
+ * @size: Size of @buf
+ * Return: 0 if OK, -FDT_ERR_NOSPACE if @buf is too small, other -FDT_ERR_...
+ *	on other error
+ */
+static int fdt_batch_rewrite(const void *fdt, char *buf, int size)
+{
+	const char *base = (const char *)fdt + fdt_off_dt_struct(fdt);
+	int strings_size = fdt_size_dt_strings(fdt) + fdt_batch.strings_len;
+	struct fdt_batch_edit **edit = fdt_batch.edit;
+	int count = fdt_batch.count, node = 0, num = 0;
+	char *out, *end = buf + size - strings_size;
+	bool in_props = false;
+	int offset, next, ret;
+	uint32_t tag;
+
+	out = buf + fdt_off_dt_struct(fdt);
+	if (out > end)
+		return -FDT_ERR_NOSPACE;
+	memcpy(buf, fdt, fdt_off_dt_struct(fdt));
+
+	for (offset = 0; ; offset = next) {
+		const struct fdt_property *prop;
+
+		tag = fdt_next_tag(fdt, offset, &next);
+		if (next < 0)
+			return next;
+		if (tag != FDT_PROP && tag != FDT_NOP && in_props) {
+			ret = fdt_batch_emit_new(edit + node, num, &out, end);
+			if (ret)
+				return ret;
+			in_props = false;
+		}
+
+		switch (tag) {
+		case FDT_BEGIN_NODE:
+			node += num;
+			while (node < count && edit[node]->node < offset)
+				node++;
+			for (num = 0; node + num < count &&
+			     edit[node + num]->node == offset; num++)
+				;
+			in_props = true;
+			break;
+		case FDT_PROP:
+			prop = (const void *)(base + offset);
+			if (num) {
+				ret = fdt_batch_emit(edit + node, num,
+						     fdt32_to_cpu(prop->nameoff),
+						     &out, end);
+				if (ret != -FDT_ERR_NOTFOUND) {
+					if (ret)
+						return ret;
+					continue;
+				}
+			}
+			break;
+		case FDT_NOP:
+			continue;
+		}
+
+		if (out + next - offset > end)
+			return -FDT_ERR_NOSPACE;
+		memcpy(out, base + offset, next - offset);
+		out += next - offset;
+		if (tag == FDT_END)
+			break;
+	}
+
+	/* any changes left over are for offsets which are not nodes */
+	for (node = 0; node < count; node++) {
+		if (!edit[node]->done)
+			return -FDT_ERR_BADOFFSET;
+	}
+
+	memcpy(out, fdt_string(fdt, 0), fdt_size_dt_strings(fdt));
+	if (fdt_batch.strings_len)
+		memcpy(out + fdt_size_dt_strings(fdt), fdt_batch.strings,
+		       fdt_batch.strings_len);
+	fdt_set_size_dt_struct(buf, out - buf - fdt_off_dt_struct(fdt));
+	fdt_set_off_dt_strings(buf, out - buf);
+	fdt_set_size_dt_strings(buf, strings_size);
+
+	return 0;
+}
+
+/* Write the changes in the batch to the tree, leaving the batch empty */
+static int fdt_batch_apply(void *fdt)
+{
+	char *buf;
+	int ret;
+
+	if (!fdt_batch.count)
+		return 0;
+	if (fdt_size_dt_struct(fdt) != fdt_batch.size_struct ||
+	    fdt_size_dt_strings(fdt) != fdt_batch.size_strings) {
+		printf("%s: devicetree was changed outside the batch\n",
+		       __func__);
+		fdt_batch_clear(fdt);
+		return -FDT_ERR_BADSTATE;
+	}
+
+	qsort(fdt_batch.edit, fdt_batch.count, sizeof(*fdt_batch.edit),
+	      fdt_batch_cmp);
+
+	buf = NULL;
+	if (fdt_off_mem_rsvmap(fdt) < fdt_off_dt_struct(fdt) &&
+	    fdt_off_dt_struct(fdt) + fdt_size_dt_struct(fdt) <=
+	    fdt_off_dt_strings(fdt))
+		buf = malloc(fdt_totalsize(fdt));
+	if (buf) {
+		ret = fdt_batch_rewrite(fdt, buf, fdt_totalsize(fdt));
+		if (!ret)
+			memcpy(fdt, buf, fdt_off_dt_strings(buf) +
+			       fdt_size_dt_strings(buf));
+		free(buf);
+	} else {
+		struct fdt_batch_edit *edit;
+		int i, j;
+
+		/*
+		 * Fall back to setting the properties one by one. Going
+		 * backwards keeps the offsets valid, since changing a node
+		 * only moves the nodes after it. Skip changes which are
+		 * overridden by a later one.
+		 */
+		ret = 0;
+		for (i = fdt_batch.count - 1; !ret && i >= 0; i--) {
+			edit = fdt_batch.edit[i];
+			for (j = i + 1; j < fdt_batch.count &&
+			     fdt_batch.edit[j]->node == edit->node; j++) {
+				if (fdt_batch.edit[j]->nameoff == edit->nameoff)
+					break;
+			}
+			if (j < fdt_batch.count &&
+			    fdt_batch.edit[j]->node == edit->node)
+				continue;
+			ret = fdt_setprop(fdt, edit->node,
+					  fdt_batch_name(fdt, edit),
+					  edit->data, edit->len);
+		}
+	}
+	fdt_batch_clear(fdt);
+
+	return ret;
+}
+
+int fdt_batch_flush(void *fdt)
+{
+	return fdt_batch_active(fdt) ? fdt_batch_apply(fdt) : 0;
+}
+
+int fdt_batch_finish(void *fdt)
+{
+	int ret;
+
+	if (!fdt_batch_active(fdt))
+		return -FDT_ERR_BADSTATE;
+	ret = fdt_batch_apply(fdt);
+	fdt_batch.fdt = NULL;
+	free(fdt_batch.edit);
+	free(fdt_batch.strings);
+	fdt_batch.edit = NULL;
+	fdt_batch.strings = NULL;
+	fdt_batch.alloced = 0;
+
+	return ret;
+}
+
 /**
  * fdt_find_and_setprop: Find a node and set it's property
  *
@@ -103,10 +536,10 @@ int fdt_find_and_setprop(void *fdt, const char *node, const char *prop,
 	if (nodeoff < 0)
 		return nodeoff;
 
-	if ((!create) && (fdt_get_property(fdt, nodeoff, prop, NULL) == NULL))
+	if (!create && !fdt_batch_hasprop(fdt, nodeoff, prop))
 		return 0; /* create flag not set; so exit quietly */
 
-	return fdt_setprop(fdt, nodeoff, prop, val, len);
+	return fdt_batch_setprop(fdt, nodeoff, prop, val, len);
 }
 
 /**
@@ -125,8 +558,25 @@ int fdt_find_or_add_subnode(void *fdt, int parentoffset, const char *name)
 
 	offset = fdt_subnode_offset(fdt, parentoffset, name);
 
-	if (offset == -FDT_ERR_NOTFOUND)
+	if (offset == -FDT_ERR_NOTFOUND && fdt_batch_active(fdt) &&
+	    fdt_batch.count) {
+		char path[256];
+
+		/* writing the batch moves the parent, so find it again */
+		offset = fdt_get_path(fdt, parentoffset, path, sizeof(path));
+		if (!offset)
+			offset = fdt_batch_apply(fdt);
+		if (!offset) {
+			parentoffset = fdt_path_offset(fdt, path);
+			offset = parentoffset < 0 ? parentoffset :
+				-FDT_ERR_NOTFOUND;
+		}
+	}
+	if (offset == -FDT_ERR_NOTFOUND) {
 		offset = fdt_add_subnode(fdt, parentoffset, name);
+		if (offset >= 0 && fdt_batch_active(fdt))
+			fdt_batch_clear(fdt);
+	}
 
 	if (offset < 0)
 		printf("%s: %s: %s\n", __func__, name, fdt_strerror(offset));
@@ -427,8 +877,8 @@ void do_fixup_by_prop(void *fdt,
 #endif
 	off = fdt_node_offset_by_prop_value(fdt, -1, pname, pval, plen);
 	while (off != -FDT_ERR_NOTFOUND) {
-		if (create || (fdt_get_property(fdt, off, prop, NULL) != NULL))
-			fdt_setprop(fdt, off, prop, val, len);
+		if (create || fdt_batch_hasprop(fdt, off, prop))
+			fdt_batch_setprop(fdt, off, prop, val, len);
 		off = fdt_node_offset_by_prop_value(fdt, off, pname, pval, plen);
 	}
 }
@@ -453,8 +903,8 @@ void do_fixup_by_compat(void *fdt, const char *compat,
 	debug("\n");
 #endif
 	fdt_for_each_node_by_compatible(off, fdt, -1, compat)
-		if (create || (fdt_get_property(fdt, off, prop, NULL) != NULL))
-			fdt_setprop(fdt, off, prop, val, len);
+		if (create || fdt_batch_hasprop(fdt, off, prop))
+			fdt_batch_setprop(fdt, off, prop, val, len);
 }
 
 void do_fixup_by_compat_u32(void *fdt, const char *compat,
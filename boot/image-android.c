@@ -444,6 +444,16 @@ ulong android_image_get_kcomp(const void *hdr,
 		return image_decomp_type(p, sizeof(u32));
 }
 
+/*
+ * Move part of an image to its load address. Nothing is copied if it is
+ * already there, e.g. because it was read straight to that address.
+ */
+static void android_image_move(ulong dst, ulong src, ulong size)
+{
+	if (dst != src && size)
+		memmove((void *)dst, (void *)src, size);
+}
+
 int android_image_get_ramdisk(const void *hdr, const void *vendor_boot_img,
 			      ulong *rd_data, ulong *rd_len)
 {
@@ -474,16 +484,16 @@ int android_image_get_ramdisk(const void *hdr, const void *vendor_boot_img,
 			ramdisk_ptr = img_data.ramdisk_addr;
 		}
 		*rd_data = ramdisk_ptr;
-		memcpy((void *)(ramdisk_ptr), (void *)img_data.vendor_ramdisk_ptr,
-		       img_data.vendor_ramdisk_size);
+		android_image_move(ramdisk_ptr, img_data.vendor_ramdisk_ptr,
+				   img_data.vendor_ramdisk_size);
 		ramdisk_ptr += img_data.vendor_ramdisk_size;
-		memcpy((void *)(ramdisk_ptr), (void *)img_data.ramdisk_ptr,
-		       img_data.boot_ramdisk_size);
+		android_image_move(ramdisk_ptr, img_data.ramdisk_ptr,
+				   img_data.boot_ramdisk_size);
 		ramdisk_ptr += img_data.boot_ramdisk_size;
 		if (img_data.bootconfig_size) {
-			memcpy((void *)
-			       (ramdisk_ptr), (void *)img_data.bootconfig_addr,
-			       img_data.bootconfig_size);
+			android_image_move(ramdisk_ptr,
+					   img_data.bootconfig_addr,
+					   img_data.bootconfig_size);
 		}
 	} else {
 		/* Ramdisk can be used in-place, use current ptr */
@@ -493,8 +503,8 @@ int android_image_get_ramdisk(const void *hdr, const void *vendor_boot_img,
 		} else {
 			ramdisk_ptr = img_data.ramdisk_addr;
 			*rd_data = ramdisk_ptr;
-			memcpy((void *)(ramdisk_ptr), (void *)img_data.ramdisk_ptr,
-			       img_data.ramdisk_size);
+			android_image_move(ramdisk_ptr, img_data.ramdisk_ptr,
+					   img_data.ramdisk_size);
 		}
 	}
 
@@ -12,6 +12,7 @@
 #include <bootstage.h>
 #include <cpu_func.h>
 #include <display_options.h>
+#include <dma.h>
 #include <env.h>
 #include <fpga.h>
 #include <image.h>
@@ -161,9 +162,42 @@ phys_size_t env_get_bootm_mapsize(void)
 #endif
 }
 
+/**
+ * image_copy_dma() - Try to move image data with a DMA engine
+ *
+ * Only large transfers between regions which do not overlap are offered to
+ * the DMA engine, since the cache maintenance costs more than a small copy.
+ *
+ * @to: Destination address
+ * @from: Source address
+ * @len: Number of bytes to copy
+ * Return: true if the data was copied, false if the CPU must copy it
+ */
+static bool image_copy_dma(void *to, const void *from, size_t len)
+{
+#if CONFIG_IS_ENABLED(IMAGE_COPY_DMA)
+	if (len < CONFIG_IMAGE_COPY_DMA_MIN)
+		return false;
+	if (to < from + len && from < to + len)
+		return false;
+
+	return dma_memcpy(to, (void *)from, len) >= 0;
+#else
+	return false;
+#endif
+}
+
+void image_copy(void *to, const void *from, size_t len)
+{
+	if (to == from || image_copy_dma(to, from, len))
+		return;
+
+	memmove(to, from, len);
+}
+
 void memmove_wd(void *to, void *from, size_t len, ulong chunksz)
 {
-	if (to == from)
+	if (to == from || image_copy_dma(to, from, len))
 		return;
 
 	if (IS_ENABLED(CONFIG_HW_WATCHDOG) || IS_ENABLED(CONFIG_WATCHDOG)) {
@@ -17,6 +17,7 @@
 #include <u-boot/crc.h>
 #include <linux/kconfig.h>
 #else
+#include <abuf.h>
 #include <linux/compiler.h>
 #include <linux/sizes.h>
 #include <errno.h>
@@ -26,6 +27,8 @@
 #include <malloc.h>
 #include <memalign.h>
 #include <asm/global_data.h>
+#include <bloblist.h>
+#include <linux/zstd.h>
 #ifdef CONFIG_DM_HASH
 #include <dm.h>
 #include <u-boot/hash.h>
@@ -1249,34 +1252,18 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp)
 int calculate_hash(const void *data, int data_len, const char *name,
 			uint8_t *value, int *value_len)
 {
-#if !defined(USE_HOSTCC) && defined(CONFIG_DM_HASH)
-	int rc;
-	enum HASH_ALGO hash_algo;
-	struct udevice *dev;
-
-	rc = uclass_get_device(UCLASS_HASH, 0, &dev);
-	if (rc) {
-		debug("failed to get hash device, rc=%d\n", rc);
-		return -1;
-	}
-
-	hash_algo = hash_algo_lookup_by_name(name);
-	if (hash_algo == HASH_ALGO_INVALID) {
-		debug("Unsupported hash algorithm\n");
-		return -1;
-	};
-
-	rc = hash_digest_wd(dev, hash_algo, data, data_len, value, CHUNKSZ);
-	if (rc) {
-		debug("failed to get hash value, rc=%d\n", rc);
-		return -1;
-	}
-
-	*value_len = hash_algo_digest_size(hash_algo);
-#else
 	struct hash_algo *algo;
 	int ret;
 
+#if !defined(USE_HOSTCC) && defined(CONFIG_DM_HASH)
+	/* Use a hash device if there is one, else fall back to software */
+	ret = hash_digest_by_name(name, data, data_len, value, CHUNKSZ);
+	if (ret > 0) {
+		*value_len = ret;
+		return 0;
+	}
+	debug("hash device failed (err=%d), using software\n", ret);
+#endif
 	ret = hash_lookup_algo(name, &algo);
 	if (ret < 0) {
 		debug("Unsupported hash alogrithm\n");
@@ -1285,13 +1272,153 @@ int calculate_hash(const void *data, int data_len, const char *name,
 
 	algo->hash_func_ws(data, data_len, value, algo->chunk_size);
 	*value_len = algo->digest_size;
+
+	return 0;
+}
+
+int fit_image_hash_start(const void *fit, int image_noffset,
+			 struct fit_load_hash *lh)
+{
+	__maybe_unused struct udevice *dev;
+	const char *algo;
+	int noffset;
+	int ignore;
+
+	memset(lh, '\0', sizeof(*lh));
+	if (tools_build())
+		return -ENOSYS;
+#if !defined(USE_HOSTCC) && defined(CONFIG_DM_HASH)
+	/* A hash device is faster at hashing the whole image once loaded */
+	if (!uclass_first_device_err(UCLASS_HASH, &dev))
+		return -ENOSYS;
 #endif
 
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		if (strncmp(fit_get_name(fit, noffset, NULL), FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+		if (fit_image_hash_get_algo(fit, noffset, &algo))
+			return -ENOENT;
+		fit_image_hash_get_ignore(fit, noffset, &ignore);
+		if (ignore)
+			continue;
+
+		if (hash_progressive_lookup_algo(algo, &lh->algo) ||
+		    lh->algo->hash_init(lh->algo, &lh->ctx))
+			return -ENOSYS;
+		lh->noffset = noffset;
+
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+int fit_image_hash_update(struct fit_load_hash *lh, const void *data,
+			  size_t size)
+{
+	return lh->algo->hash_update(lh->algo, lh->ctx, data, size, 0);
+}
+
+int fit_image_hash_finish(struct fit_load_hash *lh)
+{
+	int ret;
+
+	ret = lh->algo->hash_finish(lh->algo, lh->ctx, lh->value,
+				    sizeof(lh->value));
+	lh->done = !ret;
+
+	return ret;
+}
+
+#if !defined(USE_HOSTCC) && CONFIG_IS_ENABLED(BLOBLIST)
+int fit_verified_add(const void *data, size_t size, const char *algo,
+		     const uint8_t *value, int value_len)
+{
+	struct fit_verified *rec;
+	int blob_size;
+	void *blob;
+
+	if (!IS_ENABLED(CONFIG_FIT_VERIFIED_HANDOFF))
+		return -ENOSYS;
+	if (value_len > FIT_MAX_HASH_LEN ||
+	    strlen(algo) >= FIT_VERIFIED_ALGO_LEN)
+		return -E2BIG;
+
+	blob = bloblist_get_blob(BLOBLISTT_U_BOOT_FIT_VERIFIED, &blob_size);
+	if (blob) {
+		if (bloblist_resize(BLOBLISTT_U_BOOT_FIT_VERIFIED,
+				    blob_size + sizeof(*rec)))
+			return -ENOSPC;
+	} else {
+		blob_size = 0;
+		blob = bloblist_add(BLOBLISTT_U_BOOT_FIT_VERIFIED, sizeof(*rec),
+				    0);
+		if (!blob)
+			return -ENOSPC;
+	}
+
+	rec = blob + blob_size;
+	memset(rec, '\0', sizeof(*rec));
+	rec->addr = map_to_sysmem(data);
+	rec->size = size;
+	strcpy(rec->algo, algo);
+	rec->value_len = value_len;
+	rec->status = FIT_VERIFIED_OK;
+	memcpy(rec->value, value, value_len);
+
 	return 0;
 }
 
+/*
+ * Look for an earlier record of this image matching this hash value. A record
+ * can only be used once, so loading an image to the same place again does not
+ * escape checking.
+ */
+static bool fit_verified_check(const void *data, size_t size,
+			       const char *algo, const uint8_t *value,
+			       int value_len)
+{
+	struct fit_verified *rec;
+	int blob_size, i;
+
+	if (!IS_ENABLED(CONFIG_FIT_VERIFIED_HANDOFF))
+		return false;
+
+	rec = bloblist_get_blob(BLOBLISTT_U_BOOT_FIT_VERIFIED, &blob_size);
+	if (!rec)
+		return false;
+	for (i = 0; i < blob_size / sizeof(*rec); i++, rec++) {
+		if (rec->status == FIT_VERIFIED_OK &&
+		    rec->addr == map_to_sysmem(data) && rec->size == size &&
+		    rec->value_len == value_len &&
+		    !strncmp(rec->algo, algo, FIT_VERIFIED_ALGO_LEN) &&
+		    !memcmp(rec->value, value, value_len)) {
+			rec->status = FIT_VERIFIED_USED;
+			return true;
+		}
+	}
+
+	return false;
+}
+#else
+int fit_verified_add(const void *data, size_t size, const char *algo,
+		     const uint8_t *value, int value_len)
+{
+	return -ENOSYS;
+}
+
+static bool fit_verified_check(const void *data, size_t size,
+			       const char *algo, const uint8_t *value,
+			       int value_len)
+{
+	return false;
+}
+#endif
+
 static int fit_image_check_hash(const void *fit, int noffset, const void *data,
-				size_t size, char **err_msgp)
+				size_t size, const struct fit_load_hash *lh,
+				char **err_msgp)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, value, FIT_MAX_HASH_LEN);
 	int value_len;
@@ -1322,7 +1449,13 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	if (fit_verified_check(data, size, algo, fit_value, fit_value_len))
+		return 0;
+
+	if (lh && lh->done && lh->noffset == noffset) {
+		value_len = lh->algo->digest_size;
+		memcpy(value, lh->value, value_len);
+	} else if (calculate_hash(data, size, algo, value, &value_len)) {
 		*err_msgp = "Unsupported hash algorithm";
 		return -1;
 	}
@@ -1335,17 +1468,90 @@ static int fit_image_check_hash(const void *fit, int noffset, const void *data,
 		return -1;
 	}
 
+	/* Let the next phase use the image without checking it again */
+	if (IS_ENABLED(CONFIG_XPL_BUILD))
+		fit_verified_add(data, size, algo, fit_value, fit_value_len);
+
+	return 0;
+}
+
+#ifndef USE_HOSTCC
+/*
+ * Hash an image for all of its hash nodes in a single pass, so that an
+ * image with e.g. both a sha256 and a crc32 node is only read once. This
+ * returns the number of hashes calculated, which is 0 if there is only one
+ * node or any of them cannot be handled this way, leaving it to
+ * fit_image_check_hash() to hash the image for each node.
+ */
+static int fit_image_hash_all(const void *fit, int image_noffset,
+			      const void *data, size_t size,
+			      struct fit_load_hash lhs[HASH_MULTI_MAX])
+{
+	struct hash_algo *algos[HASH_MULTI_MAX];
+	uint8_t *outputs[HASH_MULTI_MAX];
+	__maybe_unused struct udevice *dev;
+	int noffset, ignore, i;
+	const char *algo;
+	int count = 0;
+
+#ifdef CONFIG_DM_HASH
+	/* A hash device is used for each node instead */
+	if (!uclass_first_device_err(UCLASS_HASH, &dev))
+		return 0;
+#endif
+	fdt_for_each_subnode(noffset, fit, image_noffset) {
+		if (strncmp(fit_get_name(fit, noffset, NULL), FIT_HASH_NODENAME,
+			    strlen(FIT_HASH_NODENAME)))
+			continue;
+		if (fit_image_hash_get_algo(fit, noffset, &algo))
+			return 0;
+		fit_image_hash_get_ignore(fit, noffset, &ignore);
+		if (ignore)
+			continue;
+		if (count == HASH_MULTI_MAX ||
+		    hash_progressive_lookup_algo(algo, &algos[count]))
+			return 0;
+		memset(&lhs[count], '\0', sizeof(lhs[count]));
+		lhs[count].noffset = noffset;
+		outputs[count] = lhs[count].value;
+		count++;
+	}
+	if (count < 2 || hash_block_multi(algos, count, data, size, outputs))
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		lhs[i].algo = algos[i];
+		lhs[i].done = true;
+	}
+
+	return count;
+}
+#else
+static int fit_image_hash_all(const void *fit, int image_noffset,
+			      const void *data, size_t size,
+			      struct fit_load_hash lhs[HASH_MULTI_MAX])
+{
 	return 0;
 }
+#endif
 
 int fit_image_verify_with_data(const void *fit, int image_noffset,
 			       const void *key_blob, const void *data,
 			       size_t size)
 {
+	return fit_image_verify_loaded(fit, image_noffset, key_blob, data, size,
+				       NULL);
+}
+
+int fit_image_verify_loaded(const void *fit, int image_noffset,
+			    const void *key_blob, const void *data,
+			    size_t size, const struct fit_load_hash *lh)
+{
+	struct fit_load_hash lhs[HASH_MULTI_MAX];
 	int		noffset = 0;
 	char		*err_msg = "";
 	int verify_all = 1;
-	int ret;
+	int ret, count = 0, i;
 
 	/* Verify all required signatures */
 	if (FIT_IMAGE_ENABLE_VERIFY &&
@@ -1355,6 +1561,10 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 		goto error;
 	}
 
+	/* Unless the image was hashed while loading, hash it once for all */
+	if (!lh)
+		count = fit_image_hash_all(fit, image_noffset, data, size, lhs);
+
 	/* Process all hash subnodes of the component image node */
 	fdt_for_each_subnode(noffset, fit, image_noffset) {
 		const char *name = fit_get_name(fit, noffset, NULL);
@@ -1366,7 +1576,10 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 		 */
 		if (!strncmp(name, FIT_HASH_NODENAME,
 			     strlen(FIT_HASH_NODENAME))) {
+			for (i = 0; i < count && lhs[i].noffset != noffset; i++)
+				;
 			if (fit_image_check_hash(fit, noffset, data, size,
+						 i < count ? &lhs[i] : lh,
 						 &err_msg))
 				goto error;
 			puts("+ ");
@@ -2054,6 +2267,53 @@ static const char *fit_get_image_type_property(int ph_type)
 	return "unknown";
 }
 
+#if CONFIG_IS_ENABLED(FIT_ZSTD_DICT)
+/**
+ * fit_image_zstd_dict() - Decompress a zstd image which uses a dictionary
+ *
+ * @fit: FIT to use
+ * @noffset: Offset of the image node, with a 'compression-dictionary'
+ *	property naming the image which holds the dictionary
+ * @dst: Where to put the decompressed data
+ * @dst_len: Space available at @dst
+ * @src: Compressed data
+ * @src_len: Length of @src
+ * Return: size of the decompressed data, or -ve on error
+ */
+static int fit_image_zstd_dict(const void *fit, int noffset, void *dst,
+			       ulong dst_len, const void *src, ulong src_len)
+{
+	struct abuf in, out, dict;
+	const void *dict_data;
+	const char *name;
+	size_t dict_len;
+	int dict_noffset;
+
+	name = fdt_getprop(fit, noffset, FIT_COMP_DICT_PROP, NULL);
+	dict_noffset = fit_image_get_node(fit, name);
+	if (dict_noffset < 0) {
+		printf("Cannot find dictionary '%s'\n", name);
+		return -ENOENT;
+	}
+	if (!fit_image_verify(fit, dict_noffset))
+		return -EPERM;
+	if (fit_image_get_data(fit, dict_noffset, &dict_data, &dict_len))
+		return -EINVAL;
+
+	abuf_init_set(&in, (void *)src, src_len);
+	abuf_init_set(&out, dst, dst_len);
+	abuf_init_set(&dict, (void *)dict_data, dict_len);
+
+	return zstd_decompress_dict(&in, &out, &dict);
+}
+#else
+static int fit_image_zstd_dict(const void *fit, int noffset, void *dst,
+			       ulong dst_len, const void *src, ulong src_len)
+{
+	return -ENOSYS;
+}
+#endif
+
 int fit_image_load(struct bootm_headers *images, ulong addr,
 		   const char **fit_unamep, const char **fit_uname_configp,
 		   int arch, int ph_type, int bootstage_id,
@@ -2122,7 +2382,10 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 		if (image_type == IH_TYPE_KERNEL)
 			images->fit_uname_cfg = fit_base_uname_config;
 
-		if (FIT_IMAGE_ENABLE_VERIFY && images->verify) {
+		if (FIT_IMAGE_ENABLE_VERIFY && images->verify &&
+		    (images->fit_verified != fit ||
+		     images->fit_noffset_verified != cfg_noffset ||
+		     images->fit_size_verified != fdt_totalsize(fit))) {
 			puts("   Verifying Hash Integrity ... ");
 			if (fit_config_verify(fit, cfg_noffset)) {
 				puts("Bad Data Hash\n");
@@ -2131,6 +2394,9 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 				return -EACCES;
 			}
 			puts("OK\n");
+			images->fit_verified = fit;
+			images->fit_noffset_verified = cfg_noffset;
+			images->fit_size_verified = fdt_totalsize(fit);
 		}
 
 		bootstage_mark(BOOTSTAGE_ID_FIT_CONFIG);
@@ -2284,8 +2550,18 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 		} else {
 			loadbuf = map_sysmem(load, max_decomp_len);
 		}
-		if (image_decomp(comp, load, data, image_type,
-				loadbuf, buf, len, max_decomp_len, &load_end)) {
+		if (CONFIG_IS_ENABLED(FIT_ZSTD_DICT) && comp == IH_COMP_ZSTD &&
+		    fdt_getprop(fit, noffset, FIT_COMP_DICT_PROP, NULL)) {
+			ret = fit_image_zstd_dict(fit, noffset, loadbuf,
+						  max_decomp_len, buf, len);
+			if (ret < 0) {
+				printf("Error decompressing %s\n", prop_name);
+				return -ENOEXEC;
+			}
+			load_end = load + ret;
+		} else if (image_decomp(comp, load, data, image_type,
+				       loadbuf, buf, len, max_decomp_len,
+				       &load_end)) {
 			printf("Error decompressing %s\n", prop_name);
 
 			return -ENOEXEC;
@@ -2294,7 +2570,7 @@ int fit_image_load(struct bootm_headers *images, ulong addr,
 	} else if (load != data) {
 		log_debug("copying\n");
 		loadbuf = map_sysmem(load, len);
-		memcpy(loadbuf, buf, len);
+		image_copy(loadbuf, buf, len);
 	}
 
 	if (image_type == IH_TYPE_RAMDISK && comp != IH_COMP_NONE)
@@ -13,6 +13,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <menu.h>
+#include <splash.h>
 #include <video.h>
 #include <video_console.h>
 #include <linux/input.h>
@@ -582,6 +583,170 @@ int scene_render_deps(struct scene *scn, uint id)
 	return 0;
 }
 
+/* add some bytes to an object signature, using FNV-1a */
+static u32 scene_sig_add(u32 sig, const void *buf, int len)
+{
+	const u8 *ptr = buf;
+
+	while (len--)
+		sig = (sig ^ *ptr++) * 16777619;
+
+	return sig;
+}
+
+/**
+ * scene_obj_sig() - Work out a signature for the contents of an object
+ *
+ * This covers everything which affects how the object is drawn, other than
+ * its position and size
+ *
+ * @obj: Object to check
+ * Return: Signature, which is never 0
+ */
+static u32 scene_obj_sig(struct scene_obj *obj)
+{
+	struct expo *exp = obj->scene->expo;
+	u32 sig = 2166136261;
+
+	sig = scene_sig_add(sig, &obj->flags, sizeof(obj->flags));
+	switch (obj->type) {
+	case SCENEOBJT_NONE:
+		break;
+	case SCENEOBJT_IMAGE: {
+		struct scene_obj_img *img = (struct scene_obj_img *)obj;
+
+		sig = scene_sig_add(sig, &img->data, sizeof(img->data));
+		break;
+	}
+	case SCENEOBJT_TEXT: {
+		struct scene_obj_txt *txt = (struct scene_obj_txt *)obj;
+		const char *str = expo_get_str(exp, txt->str_id);
+
+		sig = scene_sig_add(sig, &txt->font_name,
+				    sizeof(txt->font_name));
+		sig = scene_sig_add(sig, &txt->font_size,
+				    sizeof(txt->font_size));
+		if (str)
+			sig = scene_sig_add(sig, str, strlen(str));
+		break;
+	}
+	case SCENEOBJT_MENU: {
+		struct scene_obj_menu *menu = (struct scene_obj_menu *)obj;
+
+		sig = scene_sig_add(sig, &menu->cur_item_id,
+				    sizeof(menu->cur_item_id));
+		break;
+	}
+	case SCENEOBJT_TEXTLINE: {
+		struct scene_obj_textline *tline;
+
+		tline = (struct scene_obj_textline *)obj;
+		sig = scene_sig_add(sig, abuf_data(&tline->buf),
+				    strlen(abuf_data(&tline->buf)));
+		sig = scene_sig_add(sig, &tline->pos, sizeof(tline->pos));
+		break;
+	}
+	}
+
+	return sig ? sig : 1;
+}
+
+/* expand @dim to include the rectangle @x0, @y0, @x1, @y1 */
+static void scene_dim_union(struct scene_dim *dim, int x0, int y0, int x1,
+			    int y1)
+{
+	if (x0 >= x1 || y0 >= y1)
+		return;
+	if (dim->w > 0 && dim->h > 0) {
+		x0 = min(x0, dim->x);
+		y0 = min(y0, dim->y);
+		x1 = max(x1, dim->x + dim->w);
+		y1 = max(y1, dim->y + dim->h);
+	}
+	dim->x = x0;
+	dim->y = y0;
+	dim->w = x1 - x0;
+	dim->h = y1 - y0;
+}
+
+static bool scene_dim_overlap(const struct scene_dim *a,
+			      const struct scene_dim *b)
+{
+	return a->w > 0 && a->h > 0 && b->w > 0 && b->h > 0 &&
+		a->x < b->x + b->w && b->x < a->x + a->w &&
+		a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static bool scene_dim_inside(const struct scene_dim *inner,
+			     const struct scene_dim *outer)
+{
+	return inner->x >= outer->x && inner->y >= outer->y &&
+		inner->x + inner->w <= outer->x + outer->w &&
+		inner->y + inner->h <= outer->y + outer->h;
+}
+
+/**
+ * scene_obj_calc_paint() - Work out the area of the display an object covers
+ *
+ * This is generous, since it only needs to include everything which
+ * scene_obj_render() draws for this object, including highlights and
+ * backgrounds
+ *
+ * @obj: Object to check
+ * @paint: Returns the area, with a zero size if the object is hidden
+ */
+static void scene_obj_calc_paint(struct scene_obj *obj,
+				 struct scene_dim *paint)
+{
+	struct expo *exp = obj->scene->expo;
+	struct vidconsole_bbox bbox, label_bbox;
+	int margin = 2 * exp->theme.menu_inset;
+
+	memset(paint, '\0', sizeof(*paint));
+	if (obj->flags & SCENEOF_HIDE)
+		return;
+
+	/* an aligned image can be anywhere */
+	if (obj->type == SCENEOBJT_IMAGE &&
+	    (obj->dim.x < 0 || obj->dim.y < 0 ||
+	     obj->dim.x == BMP_ALIGN_CENTER ||
+	     obj->dim.y == BMP_ALIGN_CENTER)) {
+		struct video_priv *vid_priv = dev_get_uclass_priv(exp->display);
+
+		paint->w = vid_priv->xsize;
+		paint->h = vid_priv->ysize;
+		return;
+	}
+
+	scene_dim_union(paint, obj->dim.x, obj->dim.y, obj->dim.x + obj->dim.w,
+			obj->dim.y + obj->dim.h);
+	if (!scene_obj_calc_bbox(obj, &bbox, &label_bbox)) {
+		if (bbox.valid)
+			scene_dim_union(paint, bbox.x0, bbox.y0, bbox.x1,
+					bbox.y1);
+		if (label_bbox.valid)
+			scene_dim_union(paint, label_bbox.x0, label_bbox.y0,
+					label_bbox.x1, label_bbox.y1);
+	}
+	if (paint->w > 0 && paint->h > 0) {
+		paint->x -= margin;
+		paint->y -= margin;
+		paint->w += margin * 2;
+		paint->h += margin * 2;
+	}
+}
+
+/* record the state of each object, so changes can be found later */
+static void scene_save_state(struct scene *scn)
+{
+	struct scene_obj *obj;
+
+	list_for_each_entry(obj, &scn->obj_head, sibling) {
+		scene_obj_calc_paint(obj, &obj->paint);
+		obj->sig = scene_obj_sig(obj);
+	}
+}
+
 int scene_render(struct scene *scn)
 {
 	struct expo *exp = scn->expo;
@@ -602,6 +767,85 @@ int scene_render(struct scene *scn)
 		if (ret && ret != -ENOTSUPP)
 			return log_msg_ret("dep", ret);
 	}
+	if (IS_ENABLED(CONFIG_EXPO_PARTIAL_RENDER) && !exp->text_mode)
+		scene_save_state(scn);
+
+	return 0;
+}
+
+int scene_render_changes(struct scene *scn, u32 colour)
+{
+	struct expo *exp = scn->expo;
+	struct udevice *dev = exp->display;
+	struct video_priv *vid_priv = dev_get_uclass_priv(dev);
+	struct scene_dim area, paint;
+	struct scene_obj *obj;
+	bool grown;
+	int ret;
+
+	/* find the area covered by changed objects, before and after */
+	memset(&area, '\0', sizeof(area));
+	list_for_each_entry(obj, &scn->obj_head, sibling) {
+		scene_obj_calc_paint(obj, &paint);
+		if (obj->sig == scene_obj_sig(obj) &&
+		    !memcmp(&paint, &obj->paint, sizeof(paint)))
+			continue;
+		scene_dim_union(&area, obj->paint.x, obj->paint.y,
+				obj->paint.x + obj->paint.w,
+				obj->paint.y + obj->paint.h);
+		scene_dim_union(&area, paint.x, paint.y, paint.x + paint.w,
+				paint.y + paint.h);
+	}
+	if (area.w <= 0 || area.h <= 0)
+		return 0;
+
+	/*
+	 * Anything overlapping the area must be drawn again, so grow it until
+	 * each object is either entirely inside or entirely outside
+	 */
+	do {
+		grown = false;
+		list_for_each_entry(obj, &scn->obj_head, sibling) {
+			scene_obj_calc_paint(obj, &paint);
+			if (scene_dim_overlap(&paint, &area) &&
+			    !scene_dim_inside(&paint, &area)) {
+				scene_dim_union(&area, paint.x, paint.y,
+						paint.x + paint.w,
+						paint.y + paint.h);
+				grown = true;
+			}
+		}
+	} while (grown);
+	log_debug("redraw %d,%d %dx%d\n", area.x, area.y, area.w, area.h);
+
+	ret = video_fill_part(dev, max(area.x, 0), max(area.y, 0),
+			      min(area.x + area.w, (int)vid_priv->xsize),
+			      min(area.y + area.h, (int)vid_priv->ysize),
+			      colour);
+	if (ret)
+		return log_msg_ret("fil", ret);
+
+	list_for_each_entry(obj, &scn->obj_head, sibling) {
+		scene_obj_calc_paint(obj, &paint);
+		if (scene_dim_overlap(&paint, &area)) {
+			ret = scene_obj_render(obj, false);
+			if (ret && ret != -ENOTSUPP)
+				return log_msg_ret("ren", ret);
+		}
+	}
+
+	if (scn->highlight_id) {
+		obj = scene_obj_find(scn, scn->highlight_id, SCENEOBJT_NONE);
+		if (obj) {
+			scene_obj_calc_paint(obj, &paint);
+			if (scene_dim_overlap(&paint, &area)) {
+				ret = scene_render_deps(scn, scn->highlight_id);
+				if (ret && ret != -ENOTSUPP)
+					return log_msg_ret("dep", ret);
+			}
+		}
+	}
+	scene_save_state(scn);
 
 	return 0;
 }
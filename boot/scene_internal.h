@@ -183,6 +183,19 @@ void scene_destroy(struct scene *scn);
  */
 int scene_render(struct scene *scn);
 
+/**
+ * scene_render_changes() - Render the parts of a scene which have changed
+ *
+ * This finds the objects which have changed since the scene was last rendered,
+ * clears the area they covered before and cover now, then draws all the
+ * objects in that area again
+ *
+ * @scn: Scene to render
+ * @colour: Background colour to use
+ * Returns: 0 if OK, -ve on error
+ */
+int scene_render_changes(struct scene *scn, u32 colour);
+
 /**
  * scene_send_key() - set a keypress to a scene
  *
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Commands for measuring the throughput of storage, network and memory
+ *
+ * Each test prints one line giving its name, the number of bytes, the time
+ * taken and the throughput, so that results are easy to collect with a
+ * script and compare between releases.
+ */
+
+#include <blk.h>
+#include <command.h>
+#include <env.h>
+#include <fs.h>
+#include <hash.h>
+#include <mapmem.h>
+#include <part.h>
+#include <rand.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <linux/math64.h>
+
+static void bench_show(const char *name, u64 bytes, ulong us)
+{
+	printf("%s: %llu bytes in %lu us", name, bytes, us);
+	if (us)
+		printf(", %llu KiB/s", div_u64(bytes * 1000000, us) >> 10);
+	printf("\n");
+}
+
+static int do_bench_blk(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	bool random, write;
+	struct blk_desc *desc;
+	ulong addr, cnt, n, us, i;
+	uint seed = 1;
+	lbaint_t blk;
+	void *buf;
+
+	if (argc != 7)
+		return CMD_RET_USAGE;
+	random = !strcmp(argv[1], "rread");
+	write = !strcmp(argv[1], "write");
+	if (!random && !write && strcmp(argv[1], "read"))
+		return CMD_RET_USAGE;
+	if (blk_get_device_by_str(argv[2], argv[3], &desc) < 0)
+		return CMD_RET_FAILURE;
+	addr = hextoul(argv[4], NULL);
+	blk = hextoul(argv[5], NULL);
+	cnt = hextoul(argv[6], NULL);
+	if (!cnt)
+		return CMD_RET_USAGE;
+
+	buf = map_sysmem(addr, cnt * desc->blksz);
+	us = timer_get_us();
+	if (random) {
+		/* single blocks at random within the range, so no read-ahead */
+		for (i = 0, n = 0; i < cnt; i++)
+			n += blk_dread(desc, blk + rand_r(&seed) % cnt, 1,
+				       buf + i * desc->blksz);
+	} else if (write) {
+		n = blk_dwrite(desc, blk, cnt, buf);
+	} else {
+		n = blk_dread(desc, blk, cnt, buf);
+	}
+	us = timer_get_us() - us;
+	unmap_sysmem(buf);
+	if (n != cnt) {
+		printf("Only %lu of %lu blocks transferred\n", n, cnt);
+		return CMD_RET_FAILURE;
+	}
+	bench_show(random ? "blk random read" : write ? "blk write" :
+		   "blk read", (u64)cnt * desc->blksz, us);
+
+	return 0;
+}
+
+static int do_bench_fs(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	char name[32];
+	loff_t actread;
+	ulong addr, us;
+	int ret;
+
+	if (argc != 5)
+		return CMD_RET_USAGE;
+	if (fs_set_blk_dev(argv[1], argv[2], FS_TYPE_ANY))
+		return CMD_RET_FAILURE;
+	snprintf(name, sizeof(name), "fs read %s", fs_get_type_name());
+	addr = hextoul(argv[3], NULL);
+
+	us = timer_get_us();
+	ret = fs_read(argv[4], addr, 0, 0, &actread);
+	us = timer_get_us() - us;
+	if (ret) {
+		printf("Failed to read '%s' (err=%d)\n", argv[4], ret);
+		return CMD_RET_FAILURE;
+	}
+	bench_show(name, actread, us);
+
+	return 0;
+}
+
+static int do_bench_load(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	int repeatable;
+	ulong us;
+	int ret;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	env_set("filesize", NULL);
+	us = timer_get_us();
+	ret = cmd_process(0, argc - 1, argv + 1, &repeatable, NULL);
+	us = timer_get_us() - us;
+	if (ret)
+		return CMD_RET_FAILURE;
+	bench_show(argv[1], env_get_hex("filesize", 0), us);
+
+	return 0;
+}
+
+static int do_bench_memcpy(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	ulong dst, src, len, us;
+	void *to, *from;
+
+	if (argc != 4)
+		return CMD_RET_USAGE;
+	dst = hextoul(argv[1], NULL);
+	src = hextoul(argv[2], NULL);
+	len = hextoul(argv[3], NULL);
+
+	to = map_sysmem(dst, len);
+	from = map_sysmem(src, len);
+	us = timer_get_us();
+	memcpy(to, from, len);
+	us = timer_get_us() - us;
+	unmap_sysmem(from);
+	unmap_sysmem(to);
+	bench_show("memcpy", len, us);
+
+	return 0;
+}
+
+static int do_bench_hash(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	u8 output[HASH_MAX_DIGEST_SIZE];
+	struct hash_algo *algo;
+	ulong addr, len, us;
+	void *buf;
+
+	if (argc != 4)
+		return CMD_RET_USAGE;
+	if (hash_lookup_algo(argv[1], &algo)) {
+		printf("Unknown hash algorithm '%s'\n", argv[1]);
+		return CMD_RET_FAILURE;
+	}
+	addr = hextoul(argv[2], NULL);
+	len = hextoul(argv[3], NULL);
+
+	buf = map_sysmem(addr, len);
+	us = timer_get_us();
+	algo->hash_func_ws(buf, len, output, algo->chunk_size);
+	us = timer_get_us() - us;
+	unmap_sysmem(buf);
+	bench_show(algo->name, len, us);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(bench,
+	"blk <read|rread|write> <interface> <dev[.hwpart]> <addr> <blk#> <cnt>\n"
+	"    - transfer <cnt> blocks; rread reads single blocks at random\n"
+	"bench fs <interface> <dev[:part]> <addr> <filename>\n"
+	"    - read a file\n"
+	"bench load <command...>\n"
+	"    - run a command, e.g. tftp or unzip, which sets $filesize\n"
+	"bench memcpy <dst> <src> <len>\n"
+	"bench hash <algo> <addr> <len>");
+
+U_BOOT_CMD_WITH_SUBCMDS(bench, "Measure throughput", bench_help_text,
+	U_BOOT_SUBCMD_MKENT(blk, 7, 0, do_bench_blk),
+	U_BOOT_SUBCMD_MKENT(fs, 5, 0, do_bench_fs),
+	U_BOOT_SUBCMD_MKENT(load, CONFIG_SYS_MAXARGS, 0, do_bench_load),
+	U_BOOT_SUBCMD_MKENT(memcpy, 4, 0, do_bench_memcpy),
+	U_BOOT_SUBCMD_MKENT(hash, 4, 0, do_bench_hash));
@@ -4,6 +4,7 @@
  * Author: Eric Nelson<eric@nelint.com>
  *
  */
+#include <blk.h>
 #include <command.h>
 #include <config.h>
 #include <malloc.h>
@@ -14,15 +15,26 @@ static int blkc_show(struct cmd_tbl *cmdtp, int flag,
 		     int argc, char *const argv[])
 {
 	struct block_cache_stats stats;
+	int i;
+
 	blkcache_stats(&stats);
 
 	printf("hits: %u\n"
 	       "misses: %u\n"
 	       "entries: %u\n"
 	       "max blocks/entry: %u\n"
-	       "max cache entries: %u\n",
+	       "max cache entries: %u\n"
+	       "sets: %u x %u ways\n",
 	       stats.hits, stats.misses, stats.entries,
-	       stats.max_blocks_per_entry, stats.max_entries);
+	       stats.max_blocks_per_entry, stats.max_entries,
+	       stats.sets, stats.ways);
+	for (i = 0; i < stats.num_devs; i++) {
+		struct block_cache_dev_stats *ds = &stats.dev[i];
+
+		printf("%s %d: hits %u, misses %u\n",
+		       blk_get_uclass_name(ds->iftype), ds->devnum, ds->hits,
+		       ds->misses);
+	}
 	return 0;
 }
 
@@ -61,6 +61,9 @@ U_BOOT_CMD(
 	"Perform RESET of the CPU",
 	"- cold boot without level specifier\n"
 	"reset -w - warm reset if implemented"
+#ifdef CONFIG_REENTER
+	"\nreset -r - restart U-Boot without resetting the SoC"
+#endif
 );
 
 #ifdef CONFIG_CMD_POWEROFF
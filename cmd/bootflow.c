@@ -133,6 +133,7 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 	struct bootflow_iter iter;
 	struct udevice *dev = NULL;
 	struct bootflow bflow;
+	struct bootflow cached = {};
 	bool all = false, boot = false, errors = false, no_global = false;
 	bool list = false, no_hunter = false, menu = false, text_mode = false;
 	int num_valid = 0;
@@ -200,6 +201,21 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		bootstd_clear_bootflows_for_bootdev(dev);
 	else
 		bootstd_clear_glob();
+
+	/* Try the bootflow from the last boot before scanning everything */
+	if (IS_ENABLED(CONFIG_BOOTFLOW_CACHE) && boot && !menu && !all &&
+	    !dev && !label &&
+	    !bootflow_scan_cached(&iter, flags, &bflow)) {
+		cached = bflow;
+		ret = bootstd_add_bootflow(&bflow);
+		if (ret < 0) {
+			printf("Out of memory\n");
+			return CMD_RET_FAILURE;
+		}
+		bootflow_run_boot(NULL, &bflow);
+		bootflow_iter_uninit(&iter);
+	}
+
 	for (i = 0,
 	     ret = bootflow_scan_first(dev, label, &iter, flags, &bflow);
 	     i < 1000 && ret != -ENODEV;
@@ -214,8 +230,16 @@ static int do_bootflow_scan(struct cmd_tbl *cmdtp, int flag, int argc,
 		}
 		if (list)
 			show_bootflow(i, &bflow, errors);
-		if (!menu && boot && !bflow.err)
+		if (!menu && boot && !bflow.err) {
+			/* Don't try the bootflow from the last boot again */
+			if (cached.dev && bflow.dev == cached.dev &&
+			    bflow.part == cached.part &&
+			    bflow.method == cached.method)
+				continue;
+			if (IS_ENABLED(CONFIG_BOOTFLOW_CACHE))
+				bootflow_cache_save(&bflow);
 			bootflow_run_boot(&iter, &bflow);
+		}
 	}
 	bootflow_iter_uninit(&iter);
 	if (list)
@@ -10,6 +10,10 @@
 static int do_bootstage_report(struct cmd_tbl *cmdtp, int flag, int argc,
 			       char *const argv[])
 {
+	if (argc > 1 && !strcmp(argv[1], "-j")) {
+		bootstage_report_json();
+		return 0;
+	}
 	bootstage_report();
 
 	return 0;
@@ -93,7 +97,7 @@ static int do_boostage(struct cmd_tbl *cmdtp, int flag, int argc,
 U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	"Boot stage command",
 	" - check boot progress and timing\n"
-	"report                      - Print a report\n"
+	"report [-j]                 - Print a report (-j for JSON)\n"
 #if IS_ENABLED(CONFIG_BOOTSTAGE_STASH)
 	"stash [<start> [<size>]]    - Stash data into memory\n"
 	"unstash [<start> [<size>]]  - Unstash data from memory\n"
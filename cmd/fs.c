@@ -38,6 +38,11 @@ U_BOOT_CMD(
 	"      If 'bytes' is 0 or omitted, the file is read until the end.\n"
 	"      'pos' gives the file byte position to start reading from.\n"
 	"      If 'pos' is 0 or omitted, the file is read from the start."
+#if CONFIG_IS_ENABLED(FS_LOAD_GUNZIP)
+	"\nload -z <interface> [<dev[:part]> [<addr> [<filename> [bytes]]]]\n"
+	"    - Load gzip or zstd file 'filename' and decompress it to 'addr'\n"
+	"      while reading. 'bytes' limits the decompressed size."
+#endif
 );
 
 static int do_save_wrapper(struct cmd_tbl *cmdtp, int flag, int argc,
@@ -53,4 +53,6 @@ U_BOOT_CMD(
 		"    - verify message digest of memory area to immediate value, \n"
 		"      env var or *address"
 #endif
+	"\nSeveral algorithms may be given as e.g. sha256,crc32, which reads\n"
+		"the memory once. hash_dest / hash then lists one value for each."
 );
@@ -225,6 +225,29 @@ static int do_host_dev(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_host_perf(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	struct host_sb_plat *plat;
+	struct udevice *dev;
+
+	if (argc != 2 && argc != 4)
+		return CMD_RET_USAGE;
+
+	dev = parse_host_label(argv[1]);
+	if (!dev)
+		return CMD_RET_FAILURE;
+	plat = dev_get_plat(dev);
+	if (argc == 4) {
+		plat->latency_us = dectoul(argv[2], NULL);
+		plat->rate_kib = dectoul(argv[3], NULL);
+	}
+	printf("latency %u us, rate %u KiB/s%s\n", plat->latency_us,
+	       plat->rate_kib, plat->map ? ", mapped" : "");
+
+	return 0;
+}
+
 static struct cmd_tbl cmd_host_sub[] = {
 	U_BOOT_CMD_MKENT(load, 7, 0, do_host_load, "", ""),
 	U_BOOT_CMD_MKENT(ls, 3, 0, do_host_ls, "", ""),
@@ -234,6 +257,7 @@ static struct cmd_tbl cmd_host_sub[] = {
 	U_BOOT_CMD_MKENT(unbind, 4, 0, do_host_unbind, "", ""),
 	U_BOOT_CMD_MKENT(info, 3, 0, do_host_info, "", ""),
 	U_BOOT_CMD_MKENT(dev, 0, 1, do_host_dev, "", ""),
+	U_BOOT_CMD_MKENT(perf, 4, 0, do_host_perf, "", ""),
 };
 
 static int do_host(struct cmd_tbl *cmdtp, int flag, int argc,
@@ -268,6 +292,8 @@ U_BOOT_CMD(
 	"host unbind <label>     - unbind file from \"host\" device\n"
 	"host info [<label>]     - show device binding & info\n"
 	"host dev [<label>]      - set or retrieve the current host device\n"
+	"host perf <label> [<latency_us> <KiB/s>] - show or set the delay\n"
+	"     added to each transfer, to emulate a slower device (0 for none)\n"
 	"host commands use the \"hostfs\" device. The \"host\" device is used\n"
 	"with standard IO commands such as fatls or ext2load"
 );
@@ -6,6 +6,34 @@
 #include <command.h>
 #include <iotrace.h>
 #include <vsprintf.h>
+#include <linux/math64.h>
+
+static void do_print_latency(void)
+{
+	static const char *const hist_name[IOTRACE_HIST_BUCKETS] = {
+		"<125n", "<250n", "<500n", "<1u", "<2u", "<4u", "<8u", ">=8u",
+	};
+	const struct iotrace_stats *st;
+	int count, i, j;
+	ulong dropped;
+
+	st = iotrace_get_stats(&count, &dropped);
+	if (!count)
+		return;
+	printf("\nRegion           Count    Polls   Total us   Max ns");
+	for (j = 0; j < IOTRACE_HIST_BUCKETS; j++)
+		printf("%7s", hist_name[j]);
+	printf("\n");
+	for (i = 0; i < count; i++, st++) {
+		printf("%08lx %13lu %8lu %10llu %8u", st->base, st->count,
+		       st->polls, div_u64(st->total_ns, 1000), st->max_ns);
+		for (j = 0; j < IOTRACE_HIST_BUCKETS; j++)
+			printf("%7lu", st->hist[j]);
+		printf("\n");
+	}
+	if (dropped)
+		printf("%lu accesses to other regions not counted\n", dropped);
+}
 
 static void do_print_stats(void)
 {
@@ -23,6 +51,7 @@ static void do_print_stats(void)
 	printf("Output: %08lx\n", start + offset);
 	printf("Count:  %08lx\n", count);
 	printf("CRC32:  %08lx\n", (ulong)iotrace_get_checksum());
+	do_print_latency();
 }
 
 static void do_print_trace(void)
@@ -38,8 +67,7 @@ static void do_print_trace(void)
 
 	printf("Timestamp  Value          Address\n");
 
-	cur_record = (struct iotrace_record *)start;
-	for (int i = 0; i < count; i++) {
+	for (ulong i = 0; (cur_record = iotrace_get_record(i)); i++) {
 		if (cur_record->flags & IOT_WRITE)
 			printf("%08llu: 0x%08lx --> 0x%08llx\n",
 			       cur_record->timestamp,
@@ -50,23 +78,28 @@ static void do_print_trace(void)
 			       cur_record->timestamp,
 					cur_record->value,
 					(unsigned long long)cur_record->addr);
-
-		cur_record++;
 	}
 }
 
 static int do_set_buffer(int argc, char *const argv[])
 {
 	ulong addr = 0, size = 0;
+	bool ring = false;
 
-	if (argc == 2) {
+	if (argc == 3) {
+		if (strcmp(argv[2], "ring"))
+			return CMD_RET_USAGE;
+		ring = true;
+	} else if (argc != 2 && argc != 0) {
+		return CMD_RET_USAGE;
+	}
+	if (argc) {
 		addr = hextoul(*argv++, NULL);
 		size = hextoul(*argv++, NULL);
-	} else if (argc != 0) {
-		return CMD_RET_USAGE;
 	}
 
 	iotrace_set_buffer(addr, size);
+	iotrace_set_ring(ring);
 
 	return 0;
 }
@@ -118,10 +151,11 @@ int do_iotrace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 }
 
 U_BOOT_CMD(
-	iotrace,	4,	1,	do_iotrace,
+	iotrace,	5,	1,	do_iotrace,
 	"iotrace utility commands",
 	"stats                        - display iotrace stats\n"
-	"iotrace buffer <address> <size>      - set iotrace buffer\n"
+	"iotrace buffer <address> <size> [ring] - set iotrace buffer, which\n"
+	"                                       overwrites old records if ring\n"
 	"iotrace limit <address> <size>       - set iotrace region limit\n"
 	"iotrace pause                        - pause tracing\n"
 	"iotrace resume                       - resume tracing\n"
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show information about the memory allocator
+ */
+
+#include <bloblist.h>
+#include <command.h>
+#include <malloc_profile.h>
+#include <stdio.h>
+#include <linux/string.h>
+
+static int do_malloc_profile(struct cmd_tbl *cmdtp, int flag, int argc,
+			     char *const argv[])
+{
+	const struct malloc_profile *prof;
+	int size;
+
+	if (argc < 2) {
+		prof = malloc_profile_get();
+	} else if (!strcmp(argv[1], "spl")) {
+		prof = NULL;
+		if (IS_ENABLED(CONFIG_BLOBLIST)) {
+			prof = bloblist_get_blob(BLOBLISTT_U_BOOT_SPL_MALLOC_PROFILE,
+						 &size);
+			if (prof && (size < sizeof(*prof) ||
+				     prof->version != MALLOC_PROFILE_VERSION ||
+				     size < MALLOC_PROFILE_SIZE(prof->max_sites)))
+				prof = NULL;
+		}
+	} else {
+		return CMD_RET_USAGE;
+	}
+	if (!prof) {
+		printf("No profile\n");
+		return CMD_RET_FAILURE;
+	}
+	malloc_profile_show(prof);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(malloc,
+	"profile [spl] - show heap usage of each allocation site, for U-Boot or SPL");
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "Memory allocator", malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(profile, 2, 1, do_malloc_profile));
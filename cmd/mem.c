@@ -31,6 +31,8 @@
 #include <linux/compiler.h>
 #include <linux/ctype.h>
 #include <linux/delay.h>
+#include <linux/math64.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -710,6 +712,12 @@ static int do_mem_loopw(struct cmd_tbl *cmdtp, int flag, int argc,
 #endif /* CONFIG_LOOPW */
 
 #ifdef CONFIG_CMD_MEMTEST
+/*
+ * Calling schedule() for every word would take longer than the test itself,
+ * so it is called once for each block of this many words
+ */
+#define MTEST_SCHED_MASK	(SZ_64K - 1)
+
 static ulong mem_test_alt(vu_long *buf, ulong start_addr, ulong end_addr,
 			  vu_long *dummy)
 {
@@ -888,7 +896,8 @@ static ulong mem_test_alt(vu_long *buf, ulong start_addr, ulong end_addr,
 	 * Fill memory with a known pattern.
 	 */
 	for (pattern = 1, offset = 0; offset < num_words; pattern++, offset++) {
-		schedule();
+		if (!(offset & MTEST_SCHED_MASK))
+			schedule();
 		addr[offset] = pattern;
 	}
 
@@ -896,7 +905,8 @@ static ulong mem_test_alt(vu_long *buf, ulong start_addr, ulong end_addr,
 	 * Check each location and invert it for the second pass.
 	 */
 	for (pattern = 1, offset = 0; offset < num_words; pattern++, offset++) {
-		schedule();
+		if (!(offset & MTEST_SCHED_MASK))
+			schedule();
 		temp = addr[offset];
 		if (temp != pattern) {
 			printf("\nFAILURE (read/write) @ 0x%.8lx:"
@@ -916,7 +926,8 @@ static ulong mem_test_alt(vu_long *buf, ulong start_addr, ulong end_addr,
 	 * Check each location for the inverted pattern and zero it.
 	 */
 	for (pattern = 1, offset = 0; offset < num_words; pattern++, offset++) {
-		schedule();
+		if (!(offset & MTEST_SCHED_MASK))
+			schedule();
 		anti_pattern = ~pattern;
 		temp = addr[offset];
 		if (temp != anti_pattern) {
@@ -1032,7 +1043,8 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 		plen, pattern, "");
 
 	for (addr = buf, val = pattern; addr < end; addr++) {
-		schedule();
+		if (!((addr - buf) & MTEST_SCHED_MASK))
+			schedule();
 		*addr = val;
 		val += incr;
 	}
@@ -1040,7 +1052,8 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	puts("Reading...");
 
 	for (addr = buf, val = pattern; addr < end; addr++) {
-		schedule();
+		if (!((addr - buf) & MTEST_SCHED_MASK))
+			schedule();
 		readback = *addr;
 		if (readback != val) {
 			ulong offset = addr - buf;
@@ -1073,6 +1086,7 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 	ulong count = 0;
 	ulong errs = 0;	/* number of errors, or -1 if interrupted */
 	ulong pattern = 0;
+	ulong start_time, elapsed;
 	int iteration;
 
 	start = CONFIG_SYS_MEMTEST_START;
@@ -1104,6 +1118,7 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 	      start, end);
 
 	buf = map_sysmem(start, end - start);
+	start_time = get_timer(0);
 	for (iteration = 0;
 			!iteration_limit || iteration < iteration_limit;
 			iteration++) {
@@ -1131,9 +1146,14 @@ static int do_mem_mtest(struct cmd_tbl *cmdtp, int flag, int argc,
 		count += errs;
 	}
 
+	elapsed = get_timer(start_time);
 	unmap_sysmem((void *)buf);
 
 	printf("\nTested %d iteration(s) with %lu errors.\n", iteration, count);
+	if (iteration && elapsed)
+		printf("Throughput: %llu MiB/s\n",
+		       div_u64((u64)iteration * (end - start) * 1000,
+			       elapsed) >> 20);
 
 	return errs != 0;
 }
@@ -389,6 +389,23 @@ static lbaint_t mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+static lbaint_t mmc_sparse_erase(struct sparse_storage *info,
+				 lbaint_t blk, lbaint_t blkcnt)
+{
+	struct blk_desc *dev_desc = info->priv;
+	struct mmc *mmc = find_mmc_device(dev_desc->devnum);
+
+	/* Only erase where it leaves zeroes and spares other blocks */
+	if (!mmc || IS_SD(mmc) || !mmc->erase_zeroes ||
+	    blkcnt < mmc->erase_grp_size)
+		return 0;
+	if (!mmc->can_trim && (blk % mmc->erase_grp_size ||
+			       blkcnt % mmc->erase_grp_size))
+		return 0;
+
+	return blk_derase(dev_desc, blk, blkcnt);
+}
+
 static int do_mmc_sparse_write(struct cmd_tbl *cmdtp, int flag,
 			       int argc, char *const argv[])
 {
@@ -429,6 +446,7 @@ static int do_mmc_sparse_write(struct cmd_tbl *cmdtp, int flag,
 	sparse.size = dev_desc->lba - blk;
 	sparse.write = mmc_sparse_write;
 	sparse.reserve = mmc_sparse_reserve;
+	sparse.erase = mmc_sparse_erase;
 	sparse.mssg = NULL;
 	sprintf(dest, "0x" LBAF, sparse.start * sparse.blksz);
 
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Commands for reading the CPU's performance counters
+ */
+
+#include <command.h>
+#include <pmu.h>
+
+static void perf_show(const u64 counts[PMU_EVENT_COUNT])
+{
+	int i;
+
+	for (i = 0; i < PMU_EVENT_COUNT; i++)
+		printf("%12s: %llu\n", pmu_event_name(i), counts[i]);
+}
+
+static int do_perf_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	if (pmu_start()) {
+		printf("No performance counters\n");
+		return CMD_RET_FAILURE;
+	}
+	pmu_reset();
+
+	return 0;
+}
+
+static int do_perf_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	u64 counts[PMU_EVENT_COUNT];
+
+	pmu_read(counts);
+	perf_show(counts);
+
+	return 0;
+}
+
+static int do_perf_run(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	u64 before[PMU_EVENT_COUNT], after[PMU_EVENT_COUNT];
+	int repeatable;
+	int ret, i;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	if (pmu_start()) {
+		printf("No performance counters\n");
+		return CMD_RET_FAILURE;
+	}
+
+	pmu_read(before);
+	ret = cmd_process(0, argc - 1, argv + 1, &repeatable, NULL);
+	pmu_read(after);
+	for (i = 0; i < PMU_EVENT_COUNT; i++)
+		after[i] -= before[i];
+	perf_show(after);
+
+	return ret ? CMD_RET_FAILURE : 0;
+}
+
+U_BOOT_LONGHELP(perf,
+	"start - start the counters from zero\n"
+	"perf show - show the counters\n"
+	"perf run <command...> - show the counts while running a command");
+
+U_BOOT_CMD_WITH_SUBCMDS(perf, "CPU performance counters", perf_help_text,
+	U_BOOT_SUBCMD_MKENT(start, 1, 0, do_perf_start),
+	U_BOOT_SUBCMD_MKENT(show, 1, 0, do_perf_show),
+	U_BOOT_SUBCMD_MKENT(run, CONFIG_SYS_MAXARGS, 0, do_perf_run));
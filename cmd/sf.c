@@ -17,6 +17,7 @@
 #include <time.h>
 #include <spi_flash.h>
 #include <asm/cache.h>
+#include <u-boot/crc.h>
 #include <jffs2/jffs2.h>
 #include <linux/mtd/mtd.h>
 
@@ -215,14 +216,20 @@ static const char *spi_flash_update_block(struct spi_flash *flash, u32 offset,
  * Update an area of SPI flash by erasing and writing any blocks which need
  * to change. Existing blocks with the correct data are left unchanged.
  *
+ * If a manifest is provided, it holds one little-endian CRC32 for each sector
+ * touched by the update, covering the part of that sector which is being
+ * updated, as it is currently programmed in the flash. Sectors whose new data
+ * matches the manifest are skipped without being read back.
+ *
  * @param flash		flash context pointer
  * @param offset	flash offset to write
  * @param len		number of bytes to write
  * @param buf		buffer to write from
+ * @param manifest	per-sector CRC32 values of the flash contents, or NULL
  * Return: 0 if ok, 1 on error
  */
 static int spi_flash_update(struct spi_flash *flash, u32 offset,
-		size_t len, const char *buf)
+		size_t len, const char *buf, const __le32 *manifest)
 {
 	const char *err_oper = NULL;
 	char *cmp_buf;
@@ -251,6 +258,11 @@ static int spi_flash_update(struct spi_flash *flash, u32 offset,
 							 start_time));
 				last_update = get_timer(0);
 			}
+			if (manifest && crc32(0, (const uchar *)buf, todo) ==
+			    le32_to_cpu(*manifest++)) {
+				skipped += todo;
+				continue;
+			}
 			err_oper = spi_flash_update_block(flash, offset, todo,
 					buf, cmp_buf, &skipped);
 		}
@@ -275,8 +287,9 @@ static int spi_flash_update(struct spi_flash *flash, u32 offset,
 
 static int do_spi_flash_read_write(int argc, char *const argv[])
 {
-	unsigned long addr;
-	void *buf;
+	unsigned long addr, manifest_addr = 0;
+	void *buf, *manifest = NULL;
+	bool use_manifest = false;
 	char *endp;
 	int ret = 1;
 	int dev = 0;
@@ -289,6 +302,16 @@ static int do_spi_flash_read_write(int argc, char *const argv[])
 	if (*argv[1] == 0 || *endp != 0)
 		return CMD_RET_USAGE;
 
+	if (argc == 5) {
+		if (strcmp(argv[0], "update") != 0)
+			return CMD_RET_USAGE;
+		manifest_addr = hextoul(argv[4], &endp);
+		if (*argv[4] == 0 || *endp != 0)
+			return CMD_RET_USAGE;
+		use_manifest = true;
+		argc--;
+	}
+
 	if (mtd_arg_off_size(argc - 2, &argv[2], &dev, &offset, &len,
 			     &maxsize, MTD_DEV_TYPE_NOR, flash->size))
 		return CMD_RET_FAILURE;
@@ -313,7 +336,19 @@ static int do_spi_flash_read_write(int argc, char *const argv[])
 	}
 
 	if (strcmp(argv[0], "update") == 0) {
-		ret = spi_flash_update(flash, offset, len, buf);
+		ulong manifest_len = 0;
+
+		if (use_manifest) {
+			u32 first = offset - offset % flash->sector_size;
+
+			manifest_len = DIV_ROUND_UP((u32)(offset + len - first),
+						    flash->sector_size) *
+				       sizeof(__le32);
+			manifest = map_sysmem(manifest_addr, manifest_len);
+		}
+		ret = spi_flash_update(flash, offset, len, buf, manifest);
+		if (manifest)
+			unmap_sysmem(manifest);
 	} else if (strncmp(argv[0], "read", 4) == 0 ||
 			strncmp(argv[0], "write", 5) == 0) {
 		int read;
@@ -635,9 +670,12 @@ U_BOOT_LONGHELP(sf,
 	"sf erase offset|partition [+]len	- erase `len' bytes from `offset'\n"
 	"					  or from start of mtd `partition'\n"
 	"					 `+len' round up `len' to block size\n"
-	"sf update addr offset|partition len	- erase and write `len' bytes from memory\n"
+	"sf update addr offset|partition len [manifest]\n"
+	"					- erase and write `len' bytes from memory\n"
 	"					  at `addr' to flash at `offset'\n"
 	"					  or to start of mtd `partition'\n"
+	"					  skipping sectors whose CRC32 matches\n"
+	"					  the list at `manifest'\n"
 #ifdef CONFIG_SPI_FLASH_LOCK
 	"sf protect lock/unlock sector len	- protect/unprotect 'len' bytes starting\n"
 	"					  at address 'sector'"
@@ -648,6 +686,6 @@ U_BOOT_LONGHELP(sf,
 	);
 
 U_BOOT_CMD(
-	sf,	5,	1,	do_spi_flash,
+	sf,	6,	1,	do_spi_flash,
 	"SPI flash sub-system", sf_help_text
 );
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Control of the sampling profiler
+ */
+
+#include <command.h>
+#include <env.h>
+#include <mapmem.h>
+#include <sprof.h>
+#include <vsprintf.h>
+
+/* Default time between samples */
+#define SPROF_PERIOD_US		1000
+
+static int do_sprof_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	uint period_us = SPROF_PERIOD_US;
+	int ret;
+
+	if (argc > 1)
+		period_us = dectoul(argv[1], NULL);
+	if (!period_us)
+		return CMD_RET_USAGE;
+
+	ret = sprof_start(period_us);
+	if (ret) {
+		printf("Cannot start sampling (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_sprof_stop(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	sprof_stop();
+
+	return 0;
+}
+
+static int do_sprof_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	sprof_print_stats();
+
+	return 0;
+}
+
+static int do_sprof_samples(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	size_t buff_size, avail, buff_ptr, needed, used;
+	char *buff;
+	int err;
+
+	/* Use the same buffer as the 'trace' command, by default */
+	if (argc < 3) {
+		buff_size = env_get_ulong("profsize", 16, 0);
+		buff = map_sysmem(env_get_ulong("profbase", 16, 0), buff_size);
+		buff_ptr = env_get_ulong("profoffset", 16, 0);
+	} else {
+		buff_size = hextoul(argv[2], NULL);
+		buff = map_sysmem(hextoul(argv[1], NULL), buff_size);
+		buff_ptr = 0;
+	}
+	if (!buff_size || buff_ptr > buff_size)
+		return CMD_RET_USAGE;
+
+	sprof_stop();
+	avail = buff_size - buff_ptr;
+	err = sprof_list_samples(buff + buff_ptr, avail, &needed);
+	if (err)
+		printf("Error: truncated (%#zx bytes needed)\n", needed);
+	used = min(avail, needed);
+	printf("Samples dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
+	env_set_hex("profbase", map_to_sysmem(buff));
+	env_set_hex("profsize", buff_size);
+	env_set_hex("profoffset", buff_ptr + used);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(sprof,
+	"start [<period_us>]      - start sampling (default every 1000us)\n"
+	"sprof stop                     - stop sampling\n"
+	"sprof stats                    - show sampling statistics\n"
+	"sprof samples [<addr> <size>]  - stop sampling and dump the samples into a\n"
+	"                                 buffer, for proftool");
+
+U_BOOT_CMD_WITH_SUBCMDS(sprof, "Sampling profiler", sprof_help_text,
+	U_BOOT_SUBCMD_MKENT(start, 2, 1, do_sprof_start),
+	U_BOOT_SUBCMD_MKENT(stop, 1, 1, do_sprof_stop),
+	U_BOOT_SUBCMD_MKENT(stats, 1, 1, do_sprof_stats),
+	U_BOOT_SUBCMD_MKENT(samples, 3, 1, do_sprof_samples));
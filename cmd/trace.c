@@ -104,6 +104,20 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		if (trace_wipe())
 			return CMD_RET_FAILURE;
 		break;
+	case 'l':
+		if (argc != 3 && argc != 5)
+			return CMD_RET_USAGE;
+		if (trace_set_limits(dectoul(argv[2], NULL),
+				     argc == 5 ? hextoul(argv[3], NULL) : 0,
+				     argc == 5 ? hextoul(argv[4], NULL) : 0))
+			return CMD_RET_FAILURE;
+		break;
+	case 't':
+		if (trace_print_totals(argc > 2 ? dectoul(argv[2], NULL) : 20)) {
+			printf("No totals: enable CONFIG_TRACE_AGGREGATE\n");
+			return CMD_RET_FAILURE;
+		}
+		break;
 	default:
 		return CMD_RET_USAGE;
 	}
@@ -112,12 +126,15 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 }
 
 U_BOOT_CMD(
-	trace,	4,	1,	do_trace,
+	trace,	5,	1,	do_trace,
 	"trace utility commands",
 	"stats                        - display tracing statistics\n"
 	"trace pause                        - pause tracing\n"
 	"trace resume                       - resume tracing\n"
 	"trace wipe                         - wipe traces\n"
+	"trace limit <depth> [<start> <end>] - only trace calls to this depth,\n"
+	"                                     to functions in this range\n"
+	"trace totals [<count>]             - show functions taking most time\n"
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
 		"- dump function call trace into buffer"
@@ -0,0 +1,469 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Extract a tar archive straight to a filesystem
+ *
+ * The archive may be compressed with gzip or zstd. It is decompressed a piece
+ * at a time and each file is written as it comes out, so only the archive
+ * itself has to fit in memory.
+ */
+
+#include <command.h>
+#include <errno.h>
+#include <fs.h>
+#include <gzip.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <vsprintf.h>
+#include <asm/unaligned.h>
+#include <linux/kernel.h>
+#include <linux/sizes.h>
+#include <linux/zstd.h>
+#include <u-boot/crc.h>
+#include <u-boot/zlib.h>
+
+#define TAR_BLOCK		512
+#define TAR_NAME_LEN		100
+#define TAR_PREFIX_LEN		155
+#define UNTAR_PATH_LEN		512
+
+/* Files are written in pieces of this size */
+#define UNTAR_CHUNK		SZ_4M
+
+enum untar_comp {
+	UNTAR_NONE,
+	UNTAR_GZIP,
+	UNTAR_ZSTD,
+};
+
+/**
+ * struct tar_hdr - header of an entry in a ustar archive
+ *
+ * Numbers are held as octal text
+ */
+struct tar_hdr {
+	char name[TAR_NAME_LEN];
+	char mode[8];
+	char uid[8];
+	char gid[8];
+	char size[12];
+	char mtime[12];
+	char chksum[8];
+	char typeflag;
+	char linkname[100];
+	char magic[6];
+	char version[2];
+	char uname[32];
+	char gname[32];
+	char devmajor[8];
+	char devminor[8];
+	char prefix[TAR_PREFIX_LEN];
+	char pad[12];
+};
+
+/**
+ * struct untar_src - source of the uncompressed archive
+ *
+ * @comp: Compression used by the archive
+ * @in: Archive data not yet used, for UNTAR_NONE and UNTAR_ZSTD
+ * @left: Number of bytes at @in
+ * @zs: Decompression state, for UNTAR_GZIP
+ * @crc: CRC32 of the data decompressed so far, for UNTAR_GZIP
+ * @ended: true once the end of the gzip stream has been reached
+ * @zd: Decompression state, for UNTAR_ZSTD
+ * @zwork: Workspace holding @zd
+ */
+struct untar_src {
+	enum untar_comp comp;
+	const u8 *in;
+	ulong left;
+	z_stream zs;
+	u32 crc;
+	bool ended;
+#if CONFIG_IS_ENABLED(ZSTD)
+	zstd_dstream *zd;
+	void *zwork;
+#endif
+};
+
+static int untar_start(struct untar_src *src, const u8 *buf, ulong len)
+{
+	memset(src, '\0', sizeof(*src));
+	src->in = buf;
+	src->left = len;
+
+	if (len >= 10 && buf[0] == 0x1f && buf[1] == 0x8b) {
+		int n = gzip_parse_header(buf, len);
+
+		if (n < 0)
+			return -EINVAL;
+		src->zs.zalloc = gzalloc;
+		src->zs.zfree = gzfree;
+		if (inflateInit2(&src->zs, -MAX_WBITS) != Z_OK)
+			return -ENOMEM;
+		src->zs.next_in = (u8 *)buf + n;
+		src->zs.avail_in = len - n;
+		src->comp = UNTAR_GZIP;
+	} else if (len >= 4 && get_unaligned_le32(buf) == ZSTD_MAGICNUMBER) {
+#if CONFIG_IS_ENABLED(ZSTD)
+		zstd_frame_header hdr;
+		size_t wsize;
+
+		if (zstd_get_frame_header(&hdr, buf, len))
+			return -EINVAL;
+		wsize = zstd_dstream_workspace_bound(hdr.windowSize);
+		src->zwork = malloc(wsize);
+		if (!src->zwork)
+			return -ENOMEM;
+		src->zd = zstd_init_dstream(hdr.windowSize, src->zwork, wsize);
+		if (!src->zd) {
+			free(src->zwork);
+			return -EINVAL;
+		}
+		src->comp = UNTAR_ZSTD;
+#else
+		return -EPROTONOSUPPORT;
+#endif
+	}
+
+	return 0;
+}
+
+/* Check the gzip trailer, if any, and free the decompression state */
+static int untar_finish(struct untar_src *src)
+{
+	int ret = 0;
+
+	switch (src->comp) {
+	case UNTAR_GZIP:
+		/* the archive ends before the gzip stream, so finish it */
+		while (!src->ended) {
+			u8 buf[TAR_BLOCK];
+			int r;
+
+			src->zs.next_out = buf;
+			src->zs.avail_out = sizeof(buf);
+			r = inflate(&src->zs, Z_SYNC_FLUSH);
+			src->crc = crc32(src->crc, buf,
+					 sizeof(buf) - src->zs.avail_out);
+			if (r == Z_STREAM_END)
+				src->ended = true;
+			else if (r != Z_OK)
+				break;
+		}
+		if (!src->ended || src->zs.avail_in < 8 ||
+		    get_unaligned_le32(src->zs.next_in) != src->crc)
+			ret = -EIO;
+		inflateEnd(&src->zs);
+		break;
+	case UNTAR_ZSTD:
+#if CONFIG_IS_ENABLED(ZSTD)
+		free(src->zwork);
+#endif
+		break;
+	case UNTAR_NONE:
+		break;
+	}
+
+	return ret;
+}
+
+/**
+ * untar_read() - Read the next part of the uncompressed archive
+ *
+ * @src: Source to read from
+ * @buf: Returns the data
+ * @len: Number of bytes to read
+ * Return: number of bytes read, which is less than @len only at the end of
+ *	the archive, or -EIO if the compressed data is corrupt
+ */
+static long untar_read(struct untar_src *src, void *buf, ulong len)
+{
+	switch (src->comp) {
+	case UNTAR_NONE:
+		len = min(len, src->left);
+		memcpy(buf, src->in, len);
+		src->in += len;
+		src->left -= len;
+		return len;
+	case UNTAR_GZIP:
+		src->zs.next_out = buf;
+		src->zs.avail_out = len;
+		while (src->zs.avail_out && !src->ended) {
+			int r = inflate(&src->zs, Z_SYNC_FLUSH);
+
+			if (r == Z_STREAM_END)
+				src->ended = true;
+			else if (r == Z_BUF_ERROR)
+				break;
+			else if (r != Z_OK)
+				return -EIO;
+		}
+		len -= src->zs.avail_out;
+		src->crc = crc32(src->crc, buf, len);
+		return len;
+	case UNTAR_ZSTD: {
+#if CONFIG_IS_ENABLED(ZSTD)
+		zstd_out_buffer out = { .dst = buf, .size = len };
+		zstd_in_buffer in = { .src = src->in, .size = src->left };
+
+		while (out.pos < out.size) {
+			size_t in_pos = in.pos, out_pos = out.pos;
+			size_t ret;
+
+			ret = zstd_decompress_stream(src->zd, &out, &in);
+			if (zstd_is_error(ret))
+				return -EIO;
+			if (in.pos == in_pos && out.pos == out_pos)
+				break;
+		}
+		src->in += in.pos;
+		src->left -= in.pos;
+		return out.pos;
+#endif
+	}
+	}
+
+	return -EIO;
+}
+
+static int untar_skip(struct untar_src *src, ulong len)
+{
+	u8 buf[TAR_BLOCK];
+
+	while (len) {
+		ulong n = min_t(ulong, len, sizeof(buf));
+
+		if (untar_read(src, buf, n) != n)
+			return -EIO;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/* Read an octal number from a header field, which may lack a terminator */
+static u64 tar_num(const char *field, int len)
+{
+	char str[16];
+
+	memcpy(str, field, len);
+	str[len] = '\0';
+
+	return simple_strtoull(str, NULL, 8);
+}
+
+/* Return true if the header's checksum is right */
+static bool tar_hdr_valid(const struct tar_hdr *hdr)
+{
+	const u8 *p = (const u8 *)hdr;
+	ulong sum = 0;
+	int i;
+
+	for (i = 0; i < TAR_BLOCK; i++) {
+		if (i >= offsetof(struct tar_hdr, chksum) &&
+		    i < offsetof(struct tar_hdr, typeflag))
+			sum += ' ';
+		else
+			sum += p[i];
+	}
+
+	return sum == tar_num(hdr->chksum, sizeof(hdr->chksum));
+}
+
+/*
+ * Work out where an entry goes, rejecting names which would escape @dir.
+ * Return: 0 if OK, -EINVAL if the name is not allowed
+ */
+static int untar_path(char *path, const char *dir, const char *prefix,
+		      const char *name)
+{
+	int len = strlen(dir);
+	const char *p;
+
+	while (*name == '/' || !strncmp(name, "./", 2))
+		name += *name == '/' ? 1 : 2;
+	snprintf(path, UNTAR_PATH_LEN, "%s%s%s%s%s", dir,
+		 len && dir[len - 1] == '/' ? "" : "/", prefix,
+		 *prefix ? "/" : "", name);
+
+	for (p = path; (p = strstr(p, "..")); p += 2) {
+		if ((p == path || p[-1] == '/') && (!p[2] || p[2] == '/'))
+			return -EINVAL;
+	}
+
+	/* drop any trailing slash, which directory entries have */
+	p = path + strlen(path) - 1;
+	if (p > path && *p == '/')
+		path[p - path] = '\0';
+
+	return 0;
+}
+
+/* Write the next @size bytes of the archive to a file, a chunk at a time */
+static int untar_file(struct untar_src *src, const char *ifname,
+		      const char *dev_part, const char *path, loff_t size,
+		      void *buf)
+{
+	loff_t pos = 0, actwrite;
+
+	do {
+		ulong n = min_t(loff_t, size - pos, UNTAR_CHUNK);
+
+		if (untar_read(src, buf, n) != n)
+			return -EIO;
+		if (fs_set_blk_dev(ifname, dev_part, FS_TYPE_ANY))
+			return -ENODEV;
+		if (fs_write(path, map_to_sysmem(buf), pos, n, &actwrite) ||
+		    actwrite != n) {
+			printf("Failed to write '%s' at %llx\n", path, pos);
+			return -EIO;
+		}
+		pos += n;
+	} while (pos < size);
+
+	/* entries are padded to a whole number of blocks */
+	return untar_skip(src, ALIGN(size, TAR_BLOCK) - size);
+}
+
+static int untar(const u8 *archive, ulong len, const char *ifname,
+		 const char *dev_part, const char *dir)
+{
+	char path[UNTAR_PATH_LEN], name[UNTAR_PATH_LEN];
+	char prefix[TAR_PREFIX_LEN + 1];
+	struct untar_src src;
+	struct tar_hdr hdr;
+	bool long_name = false;
+	int files = 0;
+	void *buf;
+	int ret;
+
+	ret = untar_start(&src, archive, len);
+	if (ret) {
+		printf("Cannot decompress archive (err=%dE)\n", ret);
+		return ret;
+	}
+	buf = malloc(UNTAR_CHUNK);
+	if (!buf) {
+		untar_finish(&src);
+		return -ENOMEM;
+	}
+
+	while (1) {
+		loff_t size;
+
+		if (untar_read(&src, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+			ret = -EIO;
+			break;
+		}
+		/* the archive ends with zero blocks */
+		if (!hdr.name[0]) {
+			ret = 0;
+			break;
+		}
+		if (!tar_hdr_valid(&hdr)) {
+			printf("Bad tar header\n");
+			ret = -EINVAL;
+			break;
+		}
+		size = tar_num(hdr.size, sizeof(hdr.size));
+
+		if (!long_name) {
+			memcpy(name, hdr.name, TAR_NAME_LEN);
+			name[TAR_NAME_LEN] = '\0';
+			memcpy(prefix, hdr.prefix, TAR_PREFIX_LEN);
+			prefix[TAR_PREFIX_LEN] = '\0';
+		}
+		long_name = false;
+
+		switch (hdr.typeflag) {
+		case 'L':	/* GNU long name for the next entry */
+			if (size >= sizeof(name) ||
+			    untar_read(&src, name, ALIGN(size, TAR_BLOCK)) !=
+			    ALIGN(size, TAR_BLOCK)) {
+				ret = -EIO;
+				break;
+			}
+			name[size] = '\0';
+			*prefix = '\0';
+			long_name = true;
+			continue;
+		case '5':
+			if (untar_path(path, dir, prefix, name))
+				goto bad_name;
+			if (fs_set_blk_dev(ifname, dev_part, FS_TYPE_ANY)) {
+				ret = -ENODEV;
+				break;
+			}
+			/* it does not matter if the directory exists already */
+			fs_mkdir(path);
+			ret = untar_skip(&src, ALIGN(size, TAR_BLOCK));
+			break;
+		case '0':
+		case '\0':
+		case '7':
+			if (untar_path(path, dir, prefix, name))
+				goto bad_name;
+			printf("%s\n", path);
+			ret = untar_file(&src, ifname, dev_part, path, size,
+					 buf);
+			files++;
+			break;
+		default:
+			debug("Skipping '%s', type %c\n", name, hdr.typeflag);
+			ret = untar_skip(&src, ALIGN(size, TAR_BLOCK));
+			break;
+		}
+		if (ret)
+			break;
+		continue;
+bad_name:
+		printf("Refusing to write '%s'\n", name);
+		ret = -EINVAL;
+		break;
+	}
+
+	free(buf);
+	if (untar_finish(&src) && !ret)
+		ret = -EIO;
+	if (ret == -EIO)
+		printf("Archive is truncated or corrupt\n");
+	else if (!ret)
+		printf("%d file(s) extracted\n", files);
+
+	return ret;
+}
+
+static int do_untar(struct cmd_tbl *cmdtp, int flag, int argc,
+		    char *const argv[])
+{
+	const char *dir = "";
+	ulong addr, len;
+	void *archive;
+	int ret;
+
+	if (argc < 5)
+		return CMD_RET_USAGE;
+	addr = hextoul(argv[3], NULL);
+	len = hextoul(argv[4], NULL);
+	if (argc > 5)
+		dir = argv[5];
+
+	/* check the target filesystem before starting */
+	if (fs_set_blk_dev(argv[1], argv[2], FS_TYPE_ANY))
+		return CMD_RET_FAILURE;
+
+	archive = map_sysmem(addr, len);
+	ret = untar(archive, len, argv[1], argv[2], dir);
+	unmap_sysmem(archive);
+
+	return ret ? CMD_RET_FAILURE : 0;
+}
+
+U_BOOT_CMD(
+	untar, 6, 0, do_untar,
+	"extract a tar archive to a filesystem",
+	"<interface> <dev[:part]> <addr> <len> [<dir>]\n"
+	"    - extract the tar archive of <len> bytes (hex) at <addr> into\n"
+	"      <dir> on the filesystem. The archive may be compressed with\n"
+	"      gzip or zstd"
+);
@@ -385,15 +385,23 @@ static unsigned long mmc_write(struct mmc_part *part, lbaint_t start,
 
 static struct mmc_part *get_partition(AvbOps *ops, const char *partition)
 {
+	struct AvbOpsData *data = ops->user_data;
 	int ret;
 	u8 dev_num;
 	int part_num = 0;
 	struct mmc_part *part;
 	struct blk_desc *mmc_blk;
 
-	part = malloc(sizeof(struct mmc_part));
-	if (!part)
-		return NULL;
+	/* Partitions are looked up once, rather than on every access */
+	for (part = data->parts; part; part = part->next) {
+		if (!strcmp((char *)part->info.name, partition))
+			break;
+	}
+	if (!part) {
+		part = calloc(1, sizeof(struct mmc_part));
+		if (!part)
+			return NULL;
+	}
 
 	dev_num = get_boot_device(ops);
 	part->mmc = find_mmc_device(dev_num);
@@ -424,6 +432,9 @@ static struct mmc_part *get_partition(AvbOps *ops, const char *partition)
 		goto err;
 	}
 
+	if (part->mmc_blk)
+		return part;
+
 	ret = part_get_info_by_name(mmc_blk, partition, &part->info);
 	if (ret < 0) {
 		printf("%s: can't find partition '%s'\n", __func__, partition);
@@ -432,10 +443,13 @@ static struct mmc_part *get_partition(AvbOps *ops, const char *partition)
 
 	part->dev_num = dev_num;
 	part->mmc_blk = mmc_blk;
+	part->next = data->parts;
+	data->parts = part;
 
 	return part;
 err:
-	free(part);
+	if (!part->mmc_blk)
+		free(part);
 	return NULL;
 }
 
@@ -876,6 +890,50 @@ static AvbIOResult get_unique_guid_for_partition(AvbOps *ops,
 	return AVB_IO_RESULT_OK;
 }
 
+/**
+ * get_preloaded_partition() - loads a partition into a buffer set up with
+ * avb_set_preload()
+ *
+ * @ops: contains AVB ops handlers
+ * @partition: partition name (NUL-terminated UTF-8 string)
+ * @num_bytes: number of bytes to load
+ * @out_pointer: returns the buffer, or NULL to load the partition as usual
+ * @out_num_bytes_preloaded: returns the number of bytes loaded
+ *
+ * @return:
+ *      AVB_IO_RESULT_OK, on success (even if no buffer was set up)
+ *      AVB_IO_RESULT_ERROR_IO, if an I/O error occurred
+ *      AVB_IO_RESULT_ERROR_NO_SUCH_PARTITION, if partition was not found
+ */
+static AvbIOResult get_preloaded_partition(AvbOps *ops,
+					   const char *partition,
+					   size_t num_bytes,
+					   u8 **out_pointer,
+					   size_t *out_num_bytes_preloaded)
+{
+	struct AvbOpsData *data = ops->user_data;
+	struct avb_preload *pre;
+	AvbIOResult ret;
+	int i;
+
+	*out_pointer = NULL;
+	for (i = 0; i < AVB_MAX_PRELOAD; i++) {
+		pre = &data->preload[i];
+		if (pre->buf && !strcmp(pre->name, partition))
+			break;
+	}
+	if (i == AVB_MAX_PRELOAD || num_bytes > pre->size)
+		return AVB_IO_RESULT_OK;
+
+	ret = read_from_partition(ops, partition, 0, num_bytes, pre->buf,
+				  out_num_bytes_preloaded);
+	if (ret != AVB_IO_RESULT_OK)
+		return ret;
+	*out_pointer = pre->buf;
+
+	return AVB_IO_RESULT_OK;
+}
+
 /**
  * get_size_of_partition() - gets the size of a partition identified
  * by a string name
@@ -1055,6 +1113,7 @@ AvbOps *avb_ops_alloc(int boot_device)
 	ops_data->ops.read_persistent_value = read_persistent_value;
 #endif
 	ops_data->ops.get_size_of_partition = get_size_of_partition;
+	ops_data->ops.get_preloaded_partition = get_preloaded_partition;
 	ops_data->mmc_dev = boot_device;
 
 	return &ops_data->ops;
@@ -1063,6 +1122,7 @@ AvbOps *avb_ops_alloc(int boot_device)
 void avb_ops_free(AvbOps *ops)
 {
 	struct AvbOpsData *ops_data;
+	struct mmc_part *part;
 
 	if (!ops)
 		return;
@@ -1074,6 +1134,33 @@ void avb_ops_free(AvbOps *ops)
 		if (ops_data->tee)
 			tee_close_session(ops_data->tee, ops_data->session);
 #endif
+		while (ops_data->parts) {
+			part = ops_data->parts;
+			ops_data->parts = part->next;
+			free(part);
+		}
 		avb_free(ops_data);
 	}
 }
+
+int avb_set_preload(AvbOps *ops, const char *partition, void *buf,
+		    size_t size)
+{
+	struct AvbOpsData *ops_data = ops->user_data;
+	struct avb_preload *pre;
+	int i;
+
+	if (strlen(partition) >= PART_NAME_LEN)
+		return -EINVAL;
+	for (i = 0; i < AVB_MAX_PRELOAD; i++) {
+		pre = &ops_data->preload[i];
+		if (!pre->buf || !strcmp(pre->name, partition)) {
+			strcpy(pre->name, partition);
+			pre->buf = buf;
+			pre->size = size;
+			return 0;
+		}
+	}
+
+	return -ENOSPC;
+}
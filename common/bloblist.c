@@ -61,6 +61,11 @@ static struct tag_name {
 	{ BLOBLISTT_U_BOOT_SPL_HANDOFF, "SPL hand-off" },
 	{ BLOBLISTT_VBE, "VBE" },
 	{ BLOBLISTT_U_BOOT_VIDEO, "SPL video handoff" },
+	{ BLOBLISTT_U_BOOT_LIVE_TREE, "SPL live tree" },
+	{ BLOBLISTT_U_BOOT_MALLOC_PROFILE, "U-Boot malloc profile" },
+	{ BLOBLISTT_U_BOOT_SPL_MALLOC_PROFILE, "SPL malloc profile" },
+	{ BLOBLISTT_U_BOOT_LOG, "U-Boot binary log" },
+	{ BLOBLISTT_U_BOOT_DM_HANDOFF, "SPL driver-model handoff" },
 
 	/* BLOBLISTT_VENDOR_AREA */
 };
@@ -474,9 +474,45 @@ static int reserve_trace(void)
 	return 0;
 }
 
+static int reserve_reenter(void)
+{
+#if CONFIG_IS_ENABLED(REENTER)
+	ulong size = ALIGN(__image_copy_end - __image_copy_start, 0x1000);
+
+	gd->relocaddr -= size;
+	gd->reenter_copy = map_sysmem(gd->relocaddr, size);
+	debug("Reserving %luk for re-entry at: %08lx\n", size >> 10,
+	      gd->relocaddr);
+#endif
+
+	return 0;
+}
+
+/*
+ * Leave U-Boot where it is if it already lies between the address it would
+ * be copied to and everything reserved above that, so that the remaining
+ * reservations have at least as much room as usual. relocate_code() then
+ * sees a zero offset and skips the copy and the relocation fixups.
+ */
+static void reloc_in_place(ulong top)
+{
+#ifdef CONFIG_RELOC_IN_PLACE
+	ulong start = (ulong)__image_copy_start;
+
+	if (start & (4096 - 1) || start < gd->relocaddr ||
+	    start + gd->mon_len > top)
+		return;
+
+	debug("U-Boot already in place at %08lx\n", start);
+	gd->relocaddr = start;
+#endif
+}
+
 static int reserve_uboot(void)
 {
 	if (!(gd->flags & GD_FLG_SKIP_RELOC)) {
+		ulong top = gd->relocaddr;
+
 		/*
 		 * reserve memory for U-Boot code, data & bss
 		 * round down to next 4 kB limit
@@ -488,6 +524,7 @@ static int reserve_uboot(void)
 		gd->relocaddr &= ~(65536 - 1);
 	#endif
 
+		reloc_in_place(top);
 		debug("Reserving %dk for U-Boot at: %08lx\n",
 		      gd->mon_len >> 10, gd->relocaddr);
 	}
@@ -974,6 +1011,7 @@ static const init_fnc_t init_sequence_f[] = {
 	arch_reserve_mmu,
 	reserve_video,
 	reserve_trace,
+	reserve_reenter,
 	reserve_uboot,
 	reserve_malloc,
 	reserve_board,
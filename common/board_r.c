@@ -150,7 +150,8 @@ static int initr_reloc_global_data(void)
 	 * Relocate the early env_addr pointer unless we know it is not inside
 	 * the binary. Some systems need this and for the rest, it doesn't hurt.
 	 */
-	gd->env_addr += gd->reloc_off;
+	if (!(gd->flags & GD_FLG_REENTER))
+		gd->env_addr += gd->reloc_off;
 #endif
 
 	/*
@@ -241,6 +242,7 @@ static int initr_dm(void)
 
 	/* Drop the pre-reloc driver model and start a new one */
 	gd->dm_root = NULL;
+	gd_set_dm_bind_index(NULL);
 #ifdef CONFIG_TIMER
 	gd->timer = NULL;
 #endif
@@ -763,6 +765,8 @@ static init_fnc_t init_sequence_r[] = {
 	initr_post,
 #endif
 	INIT_FUNC_WATCHDOG_RESET
+	/* Finish any hardware bring-up that was left running in the background */
+	INITCALL_SYNC,
 	INITCALL_EVENT(EVT_LAST_STAGE_INIT),
 #if defined(CFG_PRAM)
 	initr_mem,
@@ -771,6 +775,46 @@ static init_fnc_t init_sequence_r[] = {
 	run_main_loop,
 };
 
+#if CONFIG_IS_ENABLED(REENTER)
+/* Save U-Boot before anything changes it, so board_reenter() can restore it */
+static void reenter_save(void)
+{
+	if (!(gd->flags & GD_FLG_REENTER))
+		memcpy(gd->reenter_copy, __image_copy_start,
+		       __image_copy_end - __image_copy_start);
+}
+
+int board_reenter(void)
+{
+	printf("Re-entering U-Boot ...\n\n");
+	flush();
+
+	cyclic_unregister_all();
+	dm_uninit();
+
+	/*
+	 * Nothing may use global or static variables from here on, since
+	 * they go back to how they were when board_init_r() first started
+	 */
+	memcpy(__image_copy_start, gd->reenter_copy,
+	       __image_copy_end - __image_copy_start);
+	memset(__bss_start, '\0', __bss_end - __bss_start);
+	gd->flags &= ~(GD_FLG_DEVINIT | GD_FLG_ENV_READY);
+	gd->flags |= GD_FLG_REENTER;
+
+	arch_reenter_r();
+}
+#else
+static inline void reenter_save(void)
+{
+}
+
+int board_reenter(void)
+{
+	return -ENOSYS;
+}
+#endif
+
 void board_init_r(gd_t *new_gd, ulong dest_addr)
 {
 	/*
@@ -795,6 +839,7 @@ void board_init_r(gd_t *new_gd, ulong dest_addr)
 	gd = new_gd;
 #endif
 	gd->flags &= ~GD_FLG_LOG_READY;
+	reenter_save();
 
 	if (initcall_run_list(init_sequence_r))
 		hang();
@@ -14,6 +14,7 @@
 #include <hang.h>
 #include <log.h>
 #include <malloc.h>
+#include <pmu.h>
 #include <sort.h>
 #include <spl.h>
 #include <asm/global_data.h>
@@ -32,12 +33,37 @@ struct bootstage_record {
 	const char *name;
 	int flags;		/* see enum bootstage_flags */
 	enum bootstage_id id;
+#ifdef CONFIG_BOOTSTAGE_PMU
+	u64 pmu[PMU_EVENT_COUNT];	/* counts at mark, or accumulated */
+#endif
+};
+
+/**
+ * struct bootstage_prof - totals for one profiled device, driver or function
+ *
+ * @time_us: Total time spent, in microseconds
+ * @bytes: Total number of bytes transferred
+ * @count: Number of calls
+ * @kind: Kind of activity (enum bootstage_prof_kind)
+ * @name: Name of the device, driver or function
+ */
+struct bootstage_prof {
+	ulong time_us;
+	u64 bytes;
+	uint count;
+	u8 kind;
+	char name[BOOTSTAGE_PROF_NAME_LEN];
 };
 
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
 	struct bootstage_record record[RECORD_COUNT];
+#if CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE)
+	uint prof_count;
+	uint prof_dropped;
+	struct bootstage_prof prof[CONFIG_BOOTSTAGE_PROFILE_ENTRIES];
+#endif
 };
 
 enum {
@@ -113,6 +139,28 @@ struct bootstage_record *ensure_id(struct bootstage_data *data,
 	return rec;
 }
 
+#ifdef CONFIG_BOOTSTAGE_PMU
+/* Add the current counts to a record, or subtract them at the start */
+static void bootstage_pmu_update(struct bootstage_record *rec, bool add)
+{
+	u64 counts[PMU_EVENT_COUNT];
+	int i;
+
+	pmu_read(counts);
+	for (i = 0; i < PMU_EVENT_COUNT; i++) {
+		if (add)
+			rec->pmu[i] += counts[i];
+		else
+			rec->pmu[i] -= counts[i];
+	}
+}
+#else
+static inline void bootstage_pmu_update(struct bootstage_record *rec,
+					bool add)
+{
+}
+#endif
+
 ulong bootstage_add_record(enum bootstage_id id, const char *name,
 			   int flags, ulong mark)
 {
@@ -138,6 +186,7 @@ ulong bootstage_add_record(enum bootstage_id id, const char *name,
 			rec->name = name;
 			rec->flags = flags;
 			rec->id = id;
+			bootstage_pmu_update(rec, true);
 		} else {
 			log_warning("Bootstage space exhausted\n");
 		}
@@ -201,6 +250,7 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name)
 	if (rec) {
 		rec->start_us = start_us;
 		rec->name = name;
+		bootstage_pmu_update(rec, false);
 	}
 
 	return start_us;
@@ -216,10 +266,98 @@ uint32_t bootstage_accum(enum bootstage_id id)
 		return 0;
 	duration = (uint32_t)timer_get_boot_us() - rec->start_us;
 	rec->time_us += duration;
+	bootstage_pmu_update(rec, true);
 
 	return duration;
 }
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE)
+static const char *const prof_kind_name[BOOTSTAGE_PROF_COUNT] = {
+	[BOOTSTAGE_PROF_PROBE]		= "probe",
+	[BOOTSTAGE_PROF_BLK_READ]	= "blk_read",
+	[BOOTSTAGE_PROF_FS_READ]	= "fs_read",
+	[BOOTSTAGE_PROF_INITCALL]	= "initcall",
+};
+
+ulong bootstage_prof_start(void)
+{
+	/*
+	 * Reading a driver-model timer before it is set up would probe it
+	 * from inside device_probe(), so wait until it is ready
+	 */
+	if (!gd->bootstage || (CONFIG_IS_ENABLED(TIMER) && !gd->timer))
+		return 0;
+
+	return timer_get_boot_us();
+}
+
+void bootstage_prof_add(enum bootstage_prof_kind kind, const char *name,
+			ulong start_us, u64 bytes)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_prof *prof;
+	uint i;
+
+	if (!data || !start_us)
+		return;
+
+	for (i = 0, prof = data->prof; i < data->prof_count; i++, prof++) {
+		if (prof->kind == kind &&
+		    !strncmp(prof->name, name, sizeof(prof->name) - 1))
+			break;
+	}
+	if (i == data->prof_count) {
+		if (i == CONFIG_BOOTSTAGE_PROFILE_ENTRIES) {
+			data->prof_dropped++;
+			return;
+		}
+		data->prof_count++;
+		prof->kind = kind;
+		strlcpy(prof->name, name, sizeof(prof->name));
+	}
+	prof->time_us += timer_get_boot_us() - start_us;
+	prof->bytes += bytes;
+	prof->count++;
+}
+
+static int h_compare_prof(const void *v1, const void *v2)
+{
+	const struct bootstage_prof *p1 = v1, *p2 = v2;
+
+	/* Longest time first */
+	if (p1->time_us != p2->time_us)
+		return p1->time_us < p2->time_us ? 1 : -1;
+
+	return 0;
+}
+
+static void bootstage_prof_sort(struct bootstage_data *data)
+{
+	qsort(data->prof, data->prof_count, sizeof(data->prof[0]),
+	      h_compare_prof);
+}
+
+static void bootstage_prof_report(struct bootstage_data *data)
+{
+	struct bootstage_prof *prof;
+	uint i;
+
+	bootstage_prof_sort(data);
+	puts("\nProfile (microseconds, time includes nested activities):\n");
+	printf("%11s%11s%13s  %-9s %s\n", "Time", "Count", "Bytes", "Kind",
+	       "Name");
+	for (i = 0, prof = data->prof; i < data->prof_count; i++, prof++) {
+		print_grouped_ull(prof->time_us, BOOTSTAGE_DIGITS);
+		printf("%11u%13llu  %-9s %s\n", prof->count,
+		       (unsigned long long)prof->bytes,
+		       prof_kind_name[prof->kind], prof->name);
+	}
+	if (data->prof_dropped)
+		printf("Dropped %u profile samples, please increase CONFIG_BOOTSTAGE_PROFILE_ENTRIES\n",
+		       data->prof_dropped);
+}
+#endif
+
 /**
  * Get a record name as a printable string
  *
@@ -259,6 +397,36 @@ static uint32_t print_time_record(struct bootstage_record *rec, uint32_t prev)
 	return rec->time_us;
 }
 
+#ifdef CONFIG_BOOTSTAGE_PMU
+static void bootstage_pmu_report(struct bootstage_data *data)
+{
+	const struct bootstage_record *rec, *prev = NULL;
+	char buf[20];
+	int i, j;
+
+	puts("\nPerformance counters (since previous mark, or accumulated):\n");
+	for (j = 0; j < PMU_EVENT_COUNT; j++)
+		printf("%15s", pmu_event_name(j));
+	printf("  %s\n", "Stage");
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (i && !rec->id)
+			continue;
+		for (j = 0; j < PMU_EVENT_COUNT; j++) {
+			u64 val = rec->pmu[j];
+
+			/* counters may have been reset, e.g. by firmware */
+			if (!rec->start_us && prev)
+				val = val >= prev->pmu[j] ?
+					val - prev->pmu[j] : 0;
+			print_grouped_ull(val, 12);
+		}
+		printf("  %s\n", get_record_name(buf, sizeof(buf), rec));
+		if (!rec->start_us)
+			prev = rec;
+	}
+}
+#endif
+
 #ifdef CONFIG_OF_LIBFDT
 /**
  * Add all bootstage timings to a device tree.
@@ -312,6 +480,32 @@ static int add_bootstages_devicetree(struct fdt_header *blob)
 			return -EINVAL;
 	}
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE)
+	/*
+	 * The profile goes in a separate node, so that code which walks the
+	 * bootstage records only sees records.
+	 */
+	bootstage = fdt_add_subnode(blob, 0, "bootstage-profile");
+	if (bootstage < 0)
+		return -EINVAL;
+	bootstage_prof_sort(data);
+	for (i = 0; i < data->prof_count; i++) {
+		struct bootstage_prof *prof = &data->prof[i];
+		int node;
+
+		node = fdt_add_subnode(blob, bootstage, simple_itoa(i));
+		if (node < 0)
+			break;
+		if (fdt_setprop_string(blob, node, "name", prof->name) ||
+		    fdt_setprop_string(blob, node, "kind",
+				       prof_kind_name[prof->kind]) ||
+		    fdt_setprop_u32(blob, node, "count", prof->count) ||
+		    fdt_setprop_u32(blob, node, "time-us", prof->time_us) ||
+		    fdt_setprop_u64(blob, node, "bytes", prof->bytes))
+			return -EINVAL;
+	}
+#endif
+
 	return 0;
 }
 
@@ -351,6 +545,49 @@ void bootstage_report(void)
 		if (rec->start_us)
 			prev = print_time_record(rec, -1);
 	}
+
+#ifdef CONFIG_BOOTSTAGE_PMU
+	bootstage_pmu_report(data);
+#endif
+
+#if CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE)
+	bootstage_prof_report(data);
+#endif
+}
+
+void bootstage_report_json(void)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec;
+	const char *sep = "";
+	char buf[20];
+	int i;
+
+	printf("{\"records\": [");
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (i && !rec->id)
+			continue;
+		printf("%s\n  {\"name\": \"%s\", \"%s\": %lu}", sep,
+		       get_record_name(buf, sizeof(buf), rec),
+		       rec->start_us ? "accum" : "mark", rec->time_us);
+		sep = ",";
+	}
+	printf("\n ]");
+#if CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE)
+	bootstage_prof_sort(data);
+	printf(",\n \"profile\": [");
+	for (i = 0, sep = ""; i < data->prof_count; i++) {
+		struct bootstage_prof *prof = &data->prof[i];
+
+		printf("%s\n  {\"kind\": \"%s\", \"name\": \"%s\", \"count\": %u, \"time_us\": %lu, \"bytes\": %llu}",
+		       sep, prof_kind_name[prof->kind], prof->name,
+		       prof->count, prof->time_us,
+		       (unsigned long long)prof->bytes);
+		sep = ",";
+	}
+	printf("\n ],\n \"profile_dropped\": %u", data->prof_dropped);
+#endif
+	printf("\n}\n");
 }
 
 /**
@@ -539,6 +776,8 @@ int bootstage_init(bool first)
 		return -ENOMEM;
 	data = gd->bootstage;
 	memset(data, '\0', size);
+	if (IS_ENABLED(CONFIG_BOOTSTAGE_PMU))
+		pmu_start();
 	if (first) {
 		data->next_id = BOOTSTAGE_ID_USER;
 		bootstage_add_record(BOOTSTAGE_ID_AWAKE, "reset", 0, 0);
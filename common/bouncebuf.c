@@ -11,8 +11,79 @@
 #include <errno.h>
 #include <bouncebuf.h>
 #include <asm/cache.h>
+#include <asm/global_data.h>
 #include <linux/dma-mapping.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct bb_pool_slot - A bounce buffer kept for reuse
+ *
+ * @buf: Buffer, or NULL if the slot is empty
+ * @size: Size of @buf in bytes
+ */
+struct bb_pool_slot {
+	void *buf;
+	size_t size;
+};
+
+static struct bb_pool_slot bb_pool[CONFIG_BOUNCE_BUFFER_POOL];
+
+static bool bb_pool_ready(void)
+{
+	/* BSS is not usable before the full malloc() is set up */
+	return ARRAY_SIZE(bb_pool) && (gd->flags & GD_FLG_FULL_MALLOC_INIT);
+}
+
+static void *bb_alloc(size_t size, size_t alignment, size_t *sizep)
+{
+	int i;
+
+	if (bb_pool_ready()) {
+		for (i = 0; i < ARRAY_SIZE(bb_pool); i++) {
+			struct bb_pool_slot *slot = &bb_pool[i];
+			void *buf = slot->buf;
+
+			if (buf && slot->size >= size &&
+			    IS_ALIGNED((ulong)buf, alignment)) {
+				*sizep = slot->size;
+				slot->buf = NULL;
+				return buf;
+			}
+		}
+	}
+	*sizep = size;
+
+	return memalign(alignment, size);
+}
+
+static void bb_free(void *buf, size_t size)
+{
+	struct bb_pool_slot *victim = NULL;
+	int i;
+
+	if (bb_pool_ready() && size <= CONFIG_BOUNCE_BUFFER_POOL_MAX) {
+		/* Use an empty slot, else replace the smallest buffer */
+		for (i = 0; i < ARRAY_SIZE(bb_pool); i++) {
+			struct bb_pool_slot *slot = &bb_pool[i];
+
+			if (!slot->buf) {
+				victim = slot;
+				break;
+			}
+			if (!victim || slot->size < victim->size)
+				victim = slot;
+		}
+		if (victim && (!victim->buf || victim->size < size)) {
+			free(victim->buf);
+			victim->buf = buf;
+			victim->size = size;
+			return;
+		}
+	}
+	free(buf);
+}
+
 static int addr_aligned(struct bounce_buffer *state)
 {
 	const ulong align_mask = ARCH_DMA_MINALIGN - 1;
@@ -38,30 +109,40 @@ int bounce_buffer_start_extalign(struct bounce_buffer *state, void *data,
 				 size_t alignment,
 				 int (*addr_is_aligned)(struct bounce_buffer *state))
 {
+	enum dma_data_direction dir = DMA_BIDIRECTIONAL;
+
 	state->user_buffer = data;
 	state->bounce_buffer = data;
 	state->len = len;
 	state->len_aligned = roundup(len, alignment);
+	state->bounce_size = 0;
 	state->flags = flags;
 
 	if (!addr_is_aligned(state)) {
-		state->bounce_buffer = memalign(alignment,
-						state->len_aligned);
+		state->bounce_buffer = bb_alloc(state->len_aligned, alignment,
+						&state->bounce_size);
 		if (!state->bounce_buffer)
 			return -ENOMEM;
 
+		/*
+		 * Nothing else shares the cache lines of our own buffer, so
+		 * they can be invalidated rather than flushed before the
+		 * device writes to it
+		 */
 		if (state->flags & GEN_BB_READ)
 			memcpy(state->bounce_buffer, state->user_buffer,
 				state->len);
+		else
+			dir = DMA_FROM_DEVICE;
 	}
+	if (!(state->flags & GEN_BB_WRITE))
+		dir = DMA_TO_DEVICE;
 
 	/*
 	 * Flush data to RAM so DMA reads can pick it up,
 	 * and any CPU writebacks don't race with DMA writes
 	 */
-	dma_map_single(state->bounce_buffer,
-		       state->len_aligned,
-		       DMA_BIDIRECTIONAL);
+	dma_map_single(state->bounce_buffer, state->len_aligned, dir);
 
 	return 0;
 }
@@ -89,7 +170,7 @@ int bounce_buffer_stop(struct bounce_buffer *state)
 	if (state->flags & GEN_BB_WRITE)
 		memcpy(state->user_buffer, state->bounce_buffer, state->len);
 
-	free(state->bounce_buffer);
+	bb_free(state->bounce_buffer, state->bounce_size);
 
 	return 0;
 }
@@ -1535,6 +1535,7 @@ static int run_pipe_real(struct pipe *pi)
 	struct child_prog *child;
 	struct built_in_command *x;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1547,6 +1548,7 @@ static int run_pipe_real(struct pipe *pi)
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1613,6 +1615,8 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/* keep the pipe unchanged, so that it can be run again */
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1621,11 +1625,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -1757,7 +1761,7 @@ static int run_list_real(struct pipe *pi)
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
-	struct pipe *rpipe;
+	struct pipe *rpipe, *for_pipe = NULL;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
 	int save_num_progs;
@@ -1796,7 +1800,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
-					return 1;
+					rcode = 1;
+					goto out;
 				}
 #endif
 				flag_restore = 0;
@@ -1825,6 +1830,7 @@ static int run_list_real(struct pipe *pi)
 				list = make_list_in(pi->next->progs->argv,
 					pi->progs->argv[0]);
 				save_list = list;
+				for_pipe = pi;
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
@@ -1895,7 +1901,8 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
-			return -2;	/* exit */
+			rcode = -2;	/* exit */
+			goto out;
 		}
 		last_return_code = rcode;
 #endif
@@ -1915,6 +1922,15 @@ static int run_list_real(struct pipe *pi)
 		checkjobs(NULL);
 #endif
 	}
+out:
+	if (list) {
+		/* left in the middle of a "for" loop: put the pipe back */
+		free(for_pipe->progs->argv[0]);
+		while (*list)
+			free(*list++);
+		free(save_list);
+		for_pipe->progs->argv[0] = save_name;
+	}
 	return rcode;
 }
 
@@ -3251,6 +3267,176 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #endif /* __U_BOOT__ */
 }
 
+#ifdef CONFIG_HUSH_SCRIPT_CACHE
+#define SCRIPT_CACHE_SIZE	8
+
+/**
+ * struct script_cache - A parsed script kept so that it can be run again
+ *
+ * Parsing does not depend on any variable values, since substitution is done
+ * when each pipe is run, so the parsed list for a given text can be reused.
+ *
+ * @text: Script text, NULL if this entry is unused
+ * @hash: Hash of @text
+ * @list: Parsed pipe list
+ * @busy: Number of runs of @list in progress
+ * @last_used: Value of script_cache_tick when last run
+ */
+struct script_cache {
+	char *text;
+	uint hash;
+	struct pipe *list;
+	int busy;
+	ulong last_used;
+};
+
+static struct script_cache script_cache[SCRIPT_CACHE_SIZE];
+static ulong script_cache_tick;
+
+static uint script_hash(const char *s)
+{
+	uint hash = 2166136261u;
+
+	while (*s)
+		hash = (hash ^ (uchar)*s++) * 16777619u;
+
+	return hash;
+}
+
+/*
+ * Parse a whole script into a pipe list, without running it. On error this
+ * reports the same as parse_stream_outer() and returns NULL.
+ */
+static struct pipe *parse_script(const char *s, int flag)
+{
+	struct in_str input;
+	struct p_context ctx;
+	o_string temp = NULL_O_STRING;
+	char *p = NULL;
+	int rcode;
+
+	/* see parse_string_outer() */
+	if (!(p = strchr(s, '\n')) || *++p) {
+		p = xmalloc(strlen(s) + 2);
+		strcpy(p, s);
+		strcat(p, "\n");
+		s = p;
+	} else {
+		p = NULL;
+	}
+
+	setup_string_in_str(&input, s);
+	ctx.type = flag;
+	initialize_context(&ctx);
+	update_ifs_map();
+	if (!(flag & FLAG_PARSE_SEMICOLON) || (flag & FLAG_REPARSING))
+		mapset((uchar *)";$&|", 0);
+	input.promptmode = 1;
+	rcode = parse_stream(&temp, &ctx, &input, -1);
+	if (rcode == 1)
+		flag_repeat = 0;
+	if (rcode != 1 && ctx.old_flag != 0) {
+		syntax();
+		flag_repeat = 0;
+	}
+	if (rcode != 1 && ctx.old_flag == 0) {
+		done_word(&temp, &ctx);
+		done_pipe(&ctx, PIPE_SEQ);
+		b_free(&temp);
+		free(p);
+		return ctx.list_head;
+	}
+
+	if (ctx.old_flag != 0) {
+		free(ctx.stack);
+		b_reset(&temp);
+	}
+	if (input.__promptme == 0)
+		printf("<INTERRUPT>\n");
+	free_pipe_list(ctx.list_head, 0);
+	b_free(&temp);
+	free(p);
+
+	return NULL;
+}
+
+/*
+ * Run a script, reusing the parsed pipe list from an earlier run of the same
+ * text if there is one. This is equivalent to parse_string_outer() with
+ * FLAG_CONT_ON_NEWLINE | FLAG_EXIT_FROM_LOOP, which parses the whole script
+ * before running any of it.
+ */
+static int run_script_cached(const char *s, int flag)
+{
+	struct script_cache *sc = NULL, *victim = NULL;
+	struct pipe *list = NULL;
+	uint hash = script_hash(s);
+	bool nested = false;
+	int i, code;
+
+	for (i = 0; i < SCRIPT_CACHE_SIZE; i++) {
+		struct script_cache *ent = &script_cache[i];
+
+		if (ent->text && ent->hash == hash && !strcmp(ent->text, s)) {
+			/* a script running itself needs its own copy */
+			if (ent->busy)
+				nested = true;
+			else
+				sc = ent;
+			break;
+		}
+	}
+
+	if (!sc) {
+		list = parse_script(s, flag);
+		if (!list)
+			return 1;
+
+		for (i = 0; !nested && i < SCRIPT_CACHE_SIZE; i++) {
+			struct script_cache *ent = &script_cache[i];
+
+			if (ent->busy)
+				continue;
+			if (!victim || !ent->text ||
+			    (victim->text && ent->last_used < victim->last_used))
+				victim = ent;
+			if (!ent->text)
+				break;
+		}
+		if (victim) {
+			char *text = strdup(s);
+
+			if (text) {
+				if (victim->text) {
+					free_pipe_list(victim->list, 0);
+					free(victim->text);
+				}
+				victim->text = text;
+				victim->hash = hash;
+				victim->list = list;
+				sc = victim;
+			}
+		}
+	}
+
+	if (sc) {
+		sc->busy++;
+		sc->last_used = ++script_cache_tick;
+		code = run_list_real(sc->list);
+		sc->busy--;
+	} else {
+		code = run_list(list);
+	}
+
+	if (code == -2)	/* exit */
+		return last_return_code;
+	if (code == -1)
+		flag_repeat = 0;
+
+	return code != 0 ? 1 : 0;
+}
+#endif /* CONFIG_HUSH_SCRIPT_CACHE */
+
 #ifndef __U_BOOT__
 static int parse_string_outer(const char *s, int flag)
 #else
@@ -3265,6 +3451,10 @@ int parse_string_outer(const char *s, int flag)
 		return 1;
 	if (!*s)
 		return 0;
+#ifdef CONFIG_HUSH_SCRIPT_CACHE
+	if ((flag & FLAG_CONT_ON_NEWLINE) && (flag & FLAG_EXIT_FROM_LOOP))
+		return run_script_cached(s, flag);
+#endif
 	if (!(p = strchr(s, '\n')) || *++p) {
 		p = xmalloc(strlen(s) + 2);
 		strcpy(p, s);
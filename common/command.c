@@ -15,7 +15,9 @@
 #include <env.h>
 #include <image.h>
 #include <log.h>
+#include <malloc.h>
 #include <mapmem.h>
+#include <sort.h>
 #include <time.h>
 #include <asm/global_data.h>
 #include <linux/ctype.h>
@@ -126,10 +128,87 @@ struct cmd_tbl *find_cmd_tbl(const char *cmd, struct cmd_tbl *table,
 	return NULL;	/* not found or ambiguous command */
 }
 
+#ifdef CONFIG_CMDLINE
+/*
+ * The command linker list is sorted by the symbol used to declare each entry,
+ * which is not always the command name (e.g. "?"). So find_cmd() searches a
+ * separate index sorted by name, built on first use after relocation.
+ */
+static struct cmd_tbl **cmd_index;
+static int cmd_index_count;
+static bool cmd_index_failed;
+
+static int cmd_index_cmp(const void *a, const void *b)
+{
+	const struct cmd_tbl *c1 = *(const struct cmd_tbl **)a;
+	const struct cmd_tbl *c2 = *(const struct cmd_tbl **)b;
+
+	return strcmp(c1->name, c2->name);
+}
+
+static int cmd_index_build(void)
+{
+	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
+	const int count = ll_entry_count(struct cmd_tbl, cmd);
+	int i;
+
+	cmd_index = malloc(count * sizeof(*cmd_index));
+	if (!cmd_index) {
+		cmd_index_failed = true;
+		return -ENOMEM;
+	}
+	for (i = 0; i < count; i++)
+		cmd_index[i] = start + i;
+	qsort(cmd_index, count, sizeof(*cmd_index), cmd_index_cmp);
+	cmd_index_count = count;
+
+	return 0;
+}
+
+/* Same as find_cmd_tbl(), using a binary search of the index */
+static struct cmd_tbl *find_cmd_index(const char *cmd)
+{
+	const char *p;
+	int lo, hi, len;
+
+	len = ((p = strchr(cmd, '.')) == NULL) ? strlen(cmd) : (p - cmd);
+
+	/* find the first name which does not sort before @cmd */
+	lo = 0;
+	hi = cmd_index_count;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+
+		if (strncmp(cmd_index[mid]->name, cmd, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == cmd_index_count || strncmp(cmd_index[lo]->name, cmd, len))
+		return NULL;
+
+	/* a full match sorts before any longer name it abbreviates */
+	if (strlen(cmd_index[lo]->name) == len)
+		return cmd_index[lo];
+	if (lo + 1 < cmd_index_count &&
+	    !strncmp(cmd_index[lo + 1]->name, cmd, len))
+		return NULL;	/* ambiguous */
+
+	return cmd_index[lo];
+}
+#endif /* CONFIG_CMDLINE */
+
 struct cmd_tbl *find_cmd(const char *cmd)
 {
 	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
 	const int len = ll_entry_count(struct cmd_tbl, cmd);
+
+#ifdef CONFIG_CMDLINE
+	if (cmd && (gd->flags & GD_FLG_RELOC) && !cmd_index_failed &&
+	    (cmd_index || !cmd_index_build()))
+		return find_cmd_index(cmd);
+#endif
+
 	return find_cmd_tbl(cmd, start, len);
 }
 
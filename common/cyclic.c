@@ -27,6 +27,25 @@ struct hlist_head *cyclic_get_list(void)
 	return (struct hlist_head *)&gd->cyclic_list;
 }
 
+/*
+ * The list is kept in order of next_call, so that schedule() only needs to
+ * look at the first entry to know that nothing is due
+ */
+static void cyclic_insert(struct cyclic_info *cyclic)
+{
+	struct cyclic_info *pos, *prev = NULL;
+
+	hlist_for_each_entry(pos, cyclic_get_list(), list) {
+		if (time_before64(cyclic->next_call, pos->next_call))
+			break;
+		prev = pos;
+	}
+	if (prev)
+		hlist_add_after(&prev->list, &cyclic->list);
+	else
+		hlist_add_head(&cyclic->list, cyclic_get_list());
+}
+
 void cyclic_register(struct cyclic_info *cyclic, cyclic_func_t func,
 		     uint64_t delay_us, const char *name)
 {
@@ -37,7 +56,15 @@ void cyclic_register(struct cyclic_info *cyclic, cyclic_func_t func,
 	cyclic->name = name;
 	cyclic->delay_us = delay_us;
 	cyclic->start_time_us = get_timer_us(0);
-	hlist_add_head(&cyclic->list, cyclic_get_list());
+	cyclic->next_call = cyclic->start_time_us;
+	cyclic_insert(cyclic);
+}
+
+void cyclic_defer(struct cyclic_info *cyclic, uint64_t delay_us)
+{
+	hlist_del(&cyclic->list);
+	cyclic->next_call = get_timer_us(0) + delay_us;
+	cyclic_insert(cyclic);
 }
 
 void cyclic_unregister(struct cyclic_info *cyclic)
@@ -45,46 +72,75 @@ void cyclic_unregister(struct cyclic_info *cyclic)
 	hlist_del(&cyclic->list);
 }
 
+/* Put the functions which have just run back in order of next_call */
+static void cyclic_sort(void)
+{
+	struct hlist_head *head = cyclic_get_list();
+	struct cyclic_info *cyclic;
+	struct hlist_node *node;
+
+	node = head->first;
+	INIT_HLIST_HEAD(head);
+	while (node) {
+		cyclic = hlist_entry(node, struct cyclic_info, list);
+		node = node->next;
+		cyclic_insert(cyclic);
+	}
+}
+
 static void cyclic_run(void)
 {
+	struct hlist_head *head = cyclic_get_list();
 	struct cyclic_info *cyclic;
 	struct hlist_node *tmp;
 	uint64_t now, cpu_time;
 
 	/* Prevent recursion */
-	if (gd->flags & GD_FLG_CYCLIC_RUNNING)
+	if (gd->flags & GD_FLG_CYCLIC_RUNNING || hlist_empty(head))
+		return;
+
+	/* The list is in order, so nothing is due if the first is not */
+	cyclic = hlist_entry(head->first, struct cyclic_info, list);
+	now = get_timer_us(0);
+	if (time_before64(now, cyclic->next_call))
 		return;
 
 	gd->flags |= GD_FLG_CYCLIC_RUNNING;
-	hlist_for_each_entry_safe(cyclic, tmp, cyclic_get_list(), list) {
+	hlist_for_each_entry_safe(cyclic, tmp, head, list) {
 		/*
 		 * Check if this cyclic function needs to get called, e.g.
 		 * do not call the cyclic func too often
 		 */
 		now = get_timer_us(0);
-		if (time_after_eq64(now, cyclic->next_call)) {
-			/* Call cyclic function and account it's cpu-time */
-			cyclic->next_call = now + cyclic->delay_us;
-			cyclic->func(cyclic);
-			cyclic->run_cnt++;
-			cpu_time = get_timer_us(0) - now;
-			cyclic->cpu_time_us += cpu_time;
-
-			/* Check if cpu-time exceeds max allowed time */
-			if ((cpu_time > CONFIG_CYCLIC_MAX_CPU_TIME_US) &&
-			    (!cyclic->already_warned)) {
-				pr_err("cyclic function %s took too long: %lldus vs %dus max\n",
-				       cyclic->name, cpu_time,
-				       CONFIG_CYCLIC_MAX_CPU_TIME_US);
-
-				/*
-				 * Don't disable this function, just warn once
-				 * about this exceeding CPU time usage
-				 */
-				cyclic->already_warned = true;
-			}
+		if (time_before64(now, cyclic->next_call))
+			continue;
+
+		/* Call cyclic function and account it's cpu-time */
+		cyclic->max_latency_us = max(cyclic->max_latency_us,
+					     now - cyclic->next_call);
+		cyclic->next_call = now + cyclic->delay_us;
+		cyclic->func(cyclic);
+		cyclic->run_cnt++;
+		cpu_time = get_timer_us(0) - now;
+		cyclic->cpu_time_us += cpu_time;
+		cyclic->max_cpu_time_us = max(cyclic->max_cpu_time_us,
+					      cpu_time);
+
+		/* Check if cpu-time exceeds max allowed time */
+		if ((cpu_time > CONFIG_CYCLIC_MAX_CPU_TIME_US) &&
+		    (!cyclic->already_warned)) {
+			pr_err("cyclic function %s took too long: %lldus vs %dus max\n",
+			       cyclic->name, cpu_time,
+			       CONFIG_CYCLIC_MAX_CPU_TIME_US);
+
+			/*
+			 * Don't disable this function, just warn once
+			 * about this exceeding CPU time usage
+			 */
+			cyclic->already_warned = true;
 		}
 	}
+	cyclic_sort();
 	gd->flags &= ~GD_FLG_CYCLIC_RUNNING;
 }
 
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Slow jobs which complete in the background, polled by the cyclic
+ * infrastructure
+ *
+ * A driver which must wait for its hardware can start a job instead of
+ * spinning in a delay loop, then carry on with other work. The job's step
+ * function is called from schedule(), which also runs during delays, so
+ * several jobs can wait at the same time.
+ */
+
+#include <cyclic.h>
+#include <time.h>
+#include <linux/delay.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+
+static void cyclic_work_cyclic(struct cyclic_info *c)
+{
+	struct cyclic_work *work = container_of(c, struct cyclic_work, cyclic);
+
+	cyclic_work_poll(work);
+}
+
+int cyclic_work_poll(struct cyclic_work *work)
+{
+	int ret;
+
+	if (!cyclic_work_busy(work))
+		return work->result;
+
+	ret = work->step(work);
+	if (ret == -EINPROGRESS && work->deadline_us &&
+	    get_timer_us(0) >= work->deadline_us)
+		ret = -ETIMEDOUT;
+	if (ret != -EINPROGRESS) {
+		work->result = ret;
+		cyclic_unregister(&work->cyclic);
+	}
+
+	return ret;
+}
+
+int cyclic_work_start(struct cyclic_work *work, cyclic_work_func_t step,
+		      uint64_t delay_us, uint64_t timeout_us, const char *name)
+{
+	int ret;
+
+	/* Register first, since a completed job unregisters itself */
+	cyclic_register(&work->cyclic, cyclic_work_cyclic, delay_us, name);
+	work->step = step;
+	work->result = -EINPROGRESS;
+	work->delay_us = delay_us;
+	work->deadline_us = timeout_us ? get_timer_us(0) + timeout_us : 0;
+
+	ret = cyclic_work_poll(work);
+	/* The step function was just called, so wait before the next one */
+	if (ret == -EINPROGRESS)
+		cyclic_defer(&work->cyclic, delay_us);
+
+	return ret;
+}
+
+int cyclic_work_wait(struct cyclic_work *work)
+{
+	/*
+	 * udelay() calls schedule(), which runs the other jobs. This job is
+	 * polled directly, since it may be waited for from within a cyclic
+	 * function, where schedule() does nothing
+	 */
+	while (cyclic_work_poll(work) == -EINPROGRESS)
+		udelay(work->delay_us);
+
+	return work->result;
+}
+
+void cyclic_work_cancel(struct cyclic_work *work)
+{
+	if (!cyclic_work_busy(work))
+		return;
+	work->result = -ECANCELED;
+	cyclic_unregister(&work->cyclic);
+}
@@ -67,6 +67,15 @@ int run_usb_dnl_gadget(int usbctrl_index, char *usb_dnl_gadget)
 		if (ctrlc())
 			goto exit;
 
+		if (dfu_get_defer_drain()) {
+			ret = dfu_write_drain(dfu_get_defer_drain());
+			dfu_set_defer_drain(NULL);
+			if (ret) {
+				pr_err("Deferred dfu_write_drain() failed!");
+				goto exit;
+			}
+		}
+
 		if (dfu_get_defer_flush()) {
 			/*
 			 * Call to dm_usb_gadget_handle_interrupts() is necessary
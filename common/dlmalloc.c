@@ -16,6 +16,7 @@
 #include <asm/global_data.h>
 
 #include <malloc.h>
+#include <malloc_profile.h>
 #include <mapmem.h>
 #include <string.h>
 #include <asm/io.h>
@@ -39,6 +40,8 @@ DECLARE_GLOBAL_DATA_PTR;
  #undef MALLOC_ZERO
 static inline void MALLOC_ZERO(void *p, size_t sz) { memset(p, 0, sz); }
 static inline void MALLOC_COPY(void *dest, const void *src, size_t sz) { memcpy(dest, src, sz); }
+#elif CONFIG_IS_ENABLED(MALLOC_PROFILE)
+ #define STATIC_IF_MCHECK static
 #else
  #define STATIC_IF_MCHECK
  #define mALLOc_impl mALLOc
@@ -598,11 +601,157 @@ void *sbrk(ptrdiff_t increment)
 	return (void *)old;
 }
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+/*
+ * Small requests are served from 4KB pages at the start of the heap, each
+ * holding objects of one size class. Freed objects go on a list for their
+ * class, so neither malloc() nor free() needs to search, and the objects
+ * have no chunk header. Pages are never given back to the main heap.
+ */
+#define SLAB_PAGE_SHIFT		12
+#define SLAB_PAGE_SIZE		(1UL << SLAB_PAGE_SHIFT)
+#define SLAB_PAGES		(CONFIG_VAL(SYS_MALLOC_SLAB_LEN) >> SLAB_PAGE_SHIFT)
+#define SLAB_GRAIN		16
+#define SLAB_MAX_SIZE		256
+
+/* Make sure that a request is served by the main heap */
+#define SLAB_AVOID(bytes)	max_t(size_t, bytes, SLAB_MAX_SIZE + 1)
+
+static const ushort slab_sizes[] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+#define SLAB_CLASSES		ARRAY_SIZE(slab_sizes)
+
+/* Size class for each multiple of SLAB_GRAIN, up to SLAB_MAX_SIZE */
+static const u8 slab_index[SLAB_MAX_SIZE / SLAB_GRAIN + 1] = {
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7
+};
+
+/**
+ * struct slab_class - state of one size class
+ *
+ * @free: Freed objects, linked through their first word
+ * @next: Next object in the current page which has never been used
+ * @end: End of the objects in the current page
+ * @inuse: Number of objects allocated
+ * @peak: Largest number of objects allocated at once
+ * @pages: Number of pages used by this class
+ */
+struct slab_class {
+	void *free;
+	char *next;
+	char *end;
+	uint inuse;
+	uint peak;
+	uint pages;
+};
+
+static struct slab_class slab_class[SLAB_CLASSES];
+static u8 slab_page_class[SLAB_PAGES];
+static ulong slab_start, slab_end;
+static uint slab_pages_used;
+
+/* Set up the pages at @start, returning the start of the main heap */
+static ulong slab_init(ulong start, ulong size)
+{
+	memset(slab_class, '\0', sizeof(slab_class));
+	slab_pages_used = 0;
+	slab_start = ALIGN(start, SLAB_PAGE_SIZE);
+	slab_end = slab_start + (SLAB_PAGES << SLAB_PAGE_SHIFT);
+
+	/* Leave most of a small heap to the main allocator */
+	if (slab_end - start > size / 4) {
+		slab_start = 0;
+		slab_end = 0;
+		return start;
+	}
+
+	return slab_end;
+}
+
+static bool slab_owns(void *mem)
+{
+	return (ulong)mem - slab_start < slab_end - slab_start;
+}
+
+static size_t slab_usable_size(void *mem)
+{
+	uint page = ((ulong)mem - slab_start) >> SLAB_PAGE_SHIFT;
+
+	return slab_sizes[slab_page_class[page]];
+}
+
+/* Allocate a small object, returning NULL to use the main heap instead */
+static void *slab_alloc(size_t bytes)
+{
+	struct slab_class *sc;
+	char *page;
+	void *mem;
+	int idx;
+
+	if (!slab_start || bytes > SLAB_MAX_SIZE)
+		return NULL;
+	idx = slab_index[(bytes + SLAB_GRAIN - 1) / SLAB_GRAIN];
+	sc = &slab_class[idx];
+	if (sc->free) {
+		mem = sc->free;
+		VALGRIND_MAKE_MEM_DEFINED(mem, sizeof(void *));
+		sc->free = *(void **)mem;
+	} else {
+		if (sc->next == sc->end) {
+			if (slab_pages_used == SLAB_PAGES)
+				return NULL;
+			page = (char *)slab_start +
+				(slab_pages_used << SLAB_PAGE_SHIFT);
+			slab_page_class[slab_pages_used++] = idx;
+			sc->next = page;
+			sc->end = page + SLAB_PAGE_SIZE -
+				SLAB_PAGE_SIZE % slab_sizes[idx];
+			sc->pages++;
+		}
+		mem = sc->next;
+		sc->next += slab_sizes[idx];
+	}
+	if (++sc->inuse > sc->peak)
+		sc->peak = sc->inuse;
+	VALGRIND_MALLOCLIKE_BLOCK(mem, bytes, 0, false);
+
+	return mem;
+}
+
+static void slab_free(void *mem)
+{
+	uint page = ((ulong)mem - slab_start) >> SLAB_PAGE_SHIFT;
+	struct slab_class *sc = &slab_class[slab_page_class[page]];
+
+	*(void **)mem = sc->free;
+	sc->free = mem;
+	sc->inuse--;
+	VALGRIND_FREELIKE_BLOCK(mem, 0);
+}
+
+/* Number of bytes in objects which are allocated */
+static ulong slab_inuse_bytes(void)
+{
+	ulong total = 0;
+	int i;
+
+	for (i = 0; i < SLAB_CLASSES; i++)
+		total += (ulong)slab_class[i].inuse * slab_sizes[i];
+
+	return total;
+}
+#else
+#define SLAB_AVOID(bytes)	(bytes)
+#endif
+
 void mem_malloc_init(ulong start, ulong size)
 {
 	mem_malloc_start = (ulong)map_sysmem(start, size);
 	mem_malloc_end = mem_malloc_start + size;
 	mem_malloc_brk = mem_malloc_start;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+	mem_malloc_brk = slab_init(mem_malloc_start, size);
+#endif
 
 #ifdef CONFIG_SYS_MALLOC_DEFAULT_TO_INIT
 	malloc_init();
@@ -691,6 +840,11 @@ static unsigned long max_total_mem = 0;
 /* internal working copy of mallinfo */
 static struct mallinfo current_mallinfo = {  0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
+#ifdef DEBUG
+/* Largest free chunk below the top, set by malloc_update_mallinfo() */
+static INTERNAL_SIZE_T largest_free;
+#endif
+
 /* The total memory obtained from system via sbrk */
 #define sbrked_mem  (current_mallinfo.arena)
 
@@ -1276,6 +1430,15 @@ Void_t* mALLOc_impl(bytes) size_t bytes;
     return NULL;
   }
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  if (bytes <= SLAB_MAX_SIZE) {
+    Void_t *mem = slab_alloc(bytes);
+
+    if (mem)
+      return mem;
+  }
+#endif
+
   if (bytes > CONFIG_SYS_MALLOC_LEN || (long)bytes < 0)
      return NULL;
 
@@ -1549,6 +1712,13 @@ void fREe_impl(mem) Void_t* mem;
   if (mem == NULL)                              /* free(0) has no effect */
     return;
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  if (slab_owns(mem)) {
+    slab_free(mem);
+    return;
+  }
+#endif
+
   p = mem2chunk(mem);
   hd = p->size;
 
@@ -1707,6 +1877,20 @@ Void_t* rEALLOc_impl(oldmem, bytes) Void_t* oldmem; size_t bytes;
       return NULL;
   }
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  if (slab_owns(oldmem)) {
+    oldsize = slab_usable_size(oldmem);
+    if (bytes <= oldsize)
+      return oldmem;
+    newmem = mALLOc_impl(bytes);
+    if (newmem) {
+      memcpy(newmem, oldmem, oldsize);
+      slab_free(oldmem);
+    }
+    return newmem;
+  }
+#endif
+
   newp    = oldp    = mem2chunk(oldmem);
   newsize = oldsize = chunksize(oldp);
 
@@ -1935,7 +2119,7 @@ Void_t* mEMALIGn_impl(alignment, bytes) size_t alignment; size_t bytes;
   /* Call malloc with worst case padding to hit alignment. */
 
   nb = request2size(bytes);
-  m  = (char*)(mALLOc_impl(nb + alignment + MINSIZE));
+  m  = (char*)(mALLOc_impl(SLAB_AVOID(nb + alignment + MINSIZE)));
 
   /*
   * The attempt to over-allocate (with a size large enough to guarantee the
@@ -1951,7 +2135,7 @@ Void_t* mEMALIGn_impl(alignment, bytes) size_t alignment; size_t bytes;
      * Use bytes not nb, since mALLOc internally calls request2size too, and
      * each call increases the size to allocate, to account for the header.
      */
-    m  = (char*)(mALLOc_impl(bytes));
+    m  = (char*)(mALLOc_impl(SLAB_AVOID(bytes)));
     /* Aligned -> return it */
     if ((((unsigned long)(m)) % alignment) == 0)
       return m;
@@ -1962,7 +2146,7 @@ Void_t* mEMALIGn_impl(alignment, bytes) size_t alignment; size_t bytes;
     fREe_impl(m);
     /* Add in extra bytes to match misalignment of unexpanded allocation */
     extra = alignment - (((unsigned long)(m)) % alignment);
-    m  = (char*)(mALLOc_impl(bytes + extra));
+    m  = (char*)(mALLOc_impl(SLAB_AVOID(bytes + extra)));
     /*
      * m might not be the same as before. Validate that the previous value of
      * extra still works for the current value of m.
@@ -2115,6 +2299,12 @@ Void_t* cALLOc_impl(n, elem_size) size_t n; size_t elem_size;
 		memset(mem, 0, sz);
 		return mem;
 	}
+#endif
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+    if (slab_owns(mem)) {
+      memset(mem, 0, sz);
+      return mem;
+    }
 #endif
     p = mem2chunk(mem);
 
@@ -2242,6 +2432,55 @@ void mcheck_check_all(void) { mcheck_pedantic_check(); }
 
 enum mcheck_status mprobe(void *__ptr) { return mcheck_mprobe(__ptr); }
 // mcheck API }
+#elif CONFIG_IS_ENABLED(MALLOC_PROFILE)
+
+/* Record each request against its caller, see malloc_profile.c */
+
+Void_t *mALLOc(size_t bytes)
+{
+	void *p = mALLOc_impl(bytes);
+
+	malloc_profile_alloc(p, bytes, __builtin_return_address(0));
+
+	return p;
+}
+
+void fREe(Void_t *mem)
+{
+	malloc_profile_free(mem);
+	fREe_impl(mem);
+}
+
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes)
+{
+	void *p = rEALLOc_impl(oldmem, bytes);
+
+	/* On failure the old memory is left as it was */
+	if (p || !bytes)
+		malloc_profile_free(oldmem);
+	if (bytes)
+		malloc_profile_alloc(p, bytes, __builtin_return_address(0));
+
+	return p;
+}
+
+Void_t *mEMALIGn(size_t alignment, size_t bytes)
+{
+	void *p = mEMALIGn_impl(alignment, bytes);
+
+	malloc_profile_alloc(p, bytes, __builtin_return_address(0));
+
+	return p;
+}
+
+Void_t *cALLOc(size_t n, size_t elem_size)
+{
+	void *p = cALLOc_impl(n, elem_size);
+
+	malloc_profile_alloc(p, n * elem_size, __builtin_return_address(0));
+
+	return p;
+}
 #endif
 
 /*
@@ -2343,6 +2582,10 @@ size_t malloc_usable_size(mem) Void_t* mem;
   mchunkptr p;
   if (mem == NULL)
     return 0;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  else if (slab_owns(mem))
+    return slab_usable_size(mem);
+#endif
   else
   {
     p = mem2chunk(mem);
@@ -2371,6 +2614,8 @@ static void malloc_update_mallinfo(void)
   INTERNAL_SIZE_T avail = chunksize(top);
   int   navail = ((long)(avail) >= (long)MINSIZE)? 1 : 0;
 
+  largest_free = 0;
+
   for (i = 1; i < NAV; ++i)
   {
     b = bin_at(i);
@@ -2385,11 +2630,16 @@ static void malloc_update_mallinfo(void)
 #endif
       avail += chunksize(p);
       navail++;
+      if (chunksize(p) > largest_free)
+        largest_free = chunksize(p);
     }
   }
 
   current_mallinfo.ordblks = navail;
   current_mallinfo.uordblks = sbrked_mem - avail;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  current_mallinfo.uordblks += slab_inuse_bytes();
+#endif
   current_mallinfo.fordblks = avail;
   current_mallinfo.hblks = n_mmaps;
   current_mallinfo.hblkhd = mmapped_mem;
@@ -2416,6 +2666,16 @@ static void malloc_update_mallinfo(void)
 #ifdef DEBUG
 void malloc_stats(void)
 {
+  INTERNAL_SIZE_T free_mem;
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_F)
+  if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
+    /* The simple allocator never frees, so this is also the high-water mark */
+    printf("pre-reloc bytes  = %10u of %u\n", (unsigned int)gd->malloc_ptr,
+	   (unsigned int)gd->malloc_limit);
+    return;
+  }
+#endif
   malloc_update_mallinfo();
   printf("max system bytes = %10u\n",
 	  (unsigned int)(max_total_mem));
@@ -2427,6 +2687,29 @@ void malloc_stats(void)
   printf("max mmap regions = %10u\n",
 	  (unsigned int)max_n_mmaps);
 #endif
+
+  /* Free space below the top chunk cannot be used for large requests */
+  free_mem = current_mallinfo.fordblks - chunksize(top);
+  printf("free below top   = %10u\n", (unsigned int)free_mem);
+  printf("largest free     = %10u\n", (unsigned int)largest_free);
+  printf("fragmentation    = %9u%%\n", free_mem ?
+	 (unsigned int)(100 - (u64)largest_free * 100 / free_mem) : 0);
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+  {
+    int i;
+
+    printf("slab pages       = %10u of %u\n", slab_pages_used,
+	   (uint)SLAB_PAGES);
+    for (i = 0; i < SLAB_CLASSES; i++) {
+      struct slab_class *sc = &slab_class[i];
+
+      if (!sc->pages)
+	continue;
+      printf("slab %3u bytes   = %10u in use, %u peak, %u pages\n",
+	     slab_sizes[i], sc->inuse, sc->peak, sc->pages);
+    }
+  }
+#endif
 }
 #endif	/* DEBUG */
 
@@ -11,11 +11,13 @@
 
 #ifndef USE_HOSTCC
 #include <command.h>
+#include <cyclic.h>
 #include <env.h>
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
 #include <hw_sha.h>
+#include <u-boot/hash.h>
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -34,6 +36,8 @@
 #include <u-boot/sha256.h>
 #include <u-boot/sha512.h>
 #include <u-boot/md5.h>
+#include <u-boot/blake2.h>
+#include <linux/xxhash.h>
 
 static int __maybe_unused hash_init_sha1(struct hash_algo *algo, void **ctxp)
 {
@@ -200,6 +204,133 @@ static int __maybe_unused hash_finish_crc32(struct hash_algo *algo, void *ctx,
 	return 0;
 }
 
+/*
+ * xxh64 and BLAKE2b are much faster than SHA-2 in software, for images which
+ * need an integrity check but not authentication. Both digests are stored
+ * big-endian, as printed by the reference tools.
+ */
+static void __maybe_unused xxh64_wd_buf(const unsigned char *input,
+					unsigned int ilen,
+					unsigned char *output,
+					unsigned int chunk_sz)
+{
+	struct xxh64_state state;
+	uint64_t digest;
+	unsigned int len;
+
+	xxh64_reset(&state, 0);
+	while (ilen) {
+		len = ilen;
+		if (len > chunk_sz)
+			len = chunk_sz;
+		xxh64_update(&state, input, len);
+		input += len;
+		ilen -= len;
+#ifndef USE_HOSTCC
+		schedule();
+#endif
+	}
+	digest = cpu_to_be64(xxh64_digest(&state));
+	memcpy(output, &digest, sizeof(digest));
+}
+
+static int __maybe_unused hash_init_xxh64(struct hash_algo *algo, void **ctxp)
+{
+	struct xxh64_state *ctx = malloc(sizeof(struct xxh64_state));
+
+	if (!ctx)
+		return -ENOMEM;
+	xxh64_reset(ctx, 0);
+	*ctxp = ctx;
+
+	return 0;
+}
+
+static int __maybe_unused hash_update_xxh64(struct hash_algo *algo, void *ctx,
+					    const void *buf, unsigned int size,
+					    int is_last)
+{
+	xxh64_update(ctx, buf, size);
+
+	return 0;
+}
+
+static int __maybe_unused hash_finish_xxh64(struct hash_algo *algo, void *ctx,
+					    void *dest_buf, int size)
+{
+	uint64_t digest;
+
+	if (size < algo->digest_size)
+		return -1;
+
+	digest = cpu_to_be64(xxh64_digest(ctx));
+	memcpy(dest_buf, &digest, sizeof(digest));
+	free(ctx);
+
+	return 0;
+}
+
+#define BLAKE2B_256_SUM_LEN	32
+
+static void __maybe_unused blake2b_256_wd_buf(const unsigned char *input,
+					      unsigned int ilen,
+					      unsigned char *output,
+					      unsigned int chunk_sz)
+{
+	blake2b_state state;
+	unsigned int len;
+
+	blake2b_init(&state, BLAKE2B_256_SUM_LEN);
+	while (ilen) {
+		len = ilen;
+		if (len > chunk_sz)
+			len = chunk_sz;
+		blake2b_update(&state, input, len);
+		input += len;
+		ilen -= len;
+#ifndef USE_HOSTCC
+		schedule();
+#endif
+	}
+	blake2b_final(&state, output, BLAKE2B_256_SUM_LEN);
+}
+
+static int __maybe_unused hash_init_blake2b_256(struct hash_algo *algo,
+						void **ctxp)
+{
+	blake2b_state *ctx = malloc(sizeof(blake2b_state));
+
+	if (!ctx)
+		return -ENOMEM;
+	blake2b_init(ctx, BLAKE2B_256_SUM_LEN);
+	*ctxp = ctx;
+
+	return 0;
+}
+
+static int __maybe_unused hash_update_blake2b_256(struct hash_algo *algo,
+						  void *ctx, const void *buf,
+						  unsigned int size,
+						  int is_last)
+{
+	blake2b_update(ctx, buf, size);
+
+	return 0;
+}
+
+static int __maybe_unused hash_finish_blake2b_256(struct hash_algo *algo,
+						  void *ctx, void *dest_buf,
+						  int size)
+{
+	if (size < algo->digest_size)
+		return -1;
+
+	blake2b_final(ctx, dest_buf, BLAKE2B_256_SUM_LEN);
+	free(ctx);
+
+	return 0;
+}
+
 /*
  * These are the hash algorithms we support.  If we have hardware acceleration
  * is enable we will use that, otherwise a software version of the algorithm.
@@ -328,6 +459,28 @@ static struct hash_algo hash_algo[] = {
 		.hash_finish	= hash_finish_crc32,
 	},
 #endif
+#if CONFIG_IS_ENABLED(XXHASH)
+	{
+		.name		= "xxh64",
+		.digest_size	= 8,
+		.chunk_size	= CHUNKSZ,
+		.hash_func_ws	= xxh64_wd_buf,
+		.hash_init	= hash_init_xxh64,
+		.hash_update	= hash_update_xxh64,
+		.hash_finish	= hash_finish_xxh64,
+	},
+#endif
+#if CONFIG_IS_ENABLED(BLAKE2)
+	{
+		.name		= "blake2b-256",
+		.digest_size	= BLAKE2B_256_SUM_LEN,
+		.chunk_size	= CHUNKSZ,
+		.hash_func_ws	= blake2b_256_wd_buf,
+		.hash_init	= hash_init_blake2b_256,
+		.hash_update	= hash_update_blake2b_256,
+		.hash_finish	= hash_finish_blake2b_256,
+	},
+#endif
 };
 
 /* Try to minimize code size for boards that don't want much hashing */
@@ -394,6 +547,27 @@ int hash_parse_string(const char *algo_name, const char *str, uint8_t *result)
 	return 0;
 }
 
+/**
+ * hash_run() - Hash a buffer, using a hash device if there is one
+ *
+ * CRCs are left to software since they are cheap and hash devices do not
+ * produce them with the same byte order.
+ *
+ * @algo: Algorithm to use
+ * @data: Data to hash
+ * @len: Length of data in bytes
+ * @output: Returns the digest, which should be cache-aligned for DMA
+ */
+static void hash_run(struct hash_algo *algo, const void *data, uint len,
+		     uint8_t *output)
+{
+	if (IS_ENABLED(CONFIG_DM_HASH) && strncmp(algo->name, "crc", 3) &&
+	    hash_digest_by_name(algo->name, data, len, output,
+				algo->chunk_size) > 0)
+		return;
+	algo->hash_func_ws(data, len, output, algo->chunk_size);
+}
+
 int hash_block(const char *algo_name, const void *data, unsigned int len,
 	       uint8_t *output, int *output_size)
 {
@@ -411,11 +585,53 @@ int hash_block(const char *algo_name, const void *data, unsigned int len,
 	}
 	if (output_size)
 		*output_size = algo->digest_size;
-	algo->hash_func_ws(data, len, output, algo->chunk_size);
+	hash_run(algo, data, len, output);
 
 	return 0;
 }
 
+int hash_block_multi(struct hash_algo *const algos[], int count,
+		     const void *data, unsigned int len,
+		     uint8_t *const outputs[])
+{
+	void *ctx[HASH_MULTI_MAX];
+	unsigned int pos, size;
+	int ret = 0;
+	int i;
+
+	if (count < 1 || count > HASH_MULTI_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		ctx[i] = NULL;
+		if (!ret && algos[i]->hash_init(algos[i], &ctx[i]))
+			ret = -EIO;
+	}
+
+	for (pos = 0; !ret && pos < len; pos += size) {
+		size = min(len - pos, (unsigned int)HASH_MULTI_CHUNK);
+		for (i = 0; i < count; i++) {
+			/* A failed update frees its context */
+			if (algos[i]->hash_update(algos[i], ctx[i], data + pos,
+						  size, pos + size == len)) {
+				ctx[i] = NULL;
+				ret = -EIO;
+				break;
+			}
+		}
+		schedule();
+	}
+
+	for (i = 0; i < count; i++) {
+		if (ctx[i] && algos[i]->hash_finish(algos[i], ctx[i],
+						    outputs[i],
+						    algos[i]->digest_size))
+			ret = -EIO;
+	}
+
+	return ret;
+}
+
 #if !defined(CONFIG_XPL_BUILD) && (defined(CONFIG_CMD_HASH) || \
 	defined(CONFIG_CMD_SHA1SUM) || defined(CONFIG_CMD_CRC32)) || \
 	defined(CONFIG_CMD_MD5SUM)
@@ -531,7 +747,8 @@ static int parse_verify_sum(struct hash_algo *algo, char *verify_str,
 	return 0;
 }
 
-static void hash_show(struct hash_algo *algo, ulong addr, ulong len, uint8_t *output)
+static void hash_show(struct hash_algo *algo, ulong addr, ulong len,
+		      const uint8_t *output)
 {
 	int i;
 
@@ -540,6 +757,50 @@ static void hash_show(struct hash_algo *algo, ulong addr, ulong len, uint8_t *ou
 		printf("%02x", output[i]);
 }
 
+/**
+ * hash_split() - Split a comma-separated list in place
+ *
+ * @str:	List to split, which is modified
+ * @parts:	Returns a pointer to each part
+ * Return: number of parts, or -E2BIG if there are more than HASH_MULTI_MAX
+ */
+static int hash_split(char *str, char *parts[HASH_MULTI_MAX])
+{
+	int count = 0;
+	char *part;
+
+	while ((part = strsep(&str, ","))) {
+		if (count == HASH_MULTI_MAX)
+			return -E2BIG;
+		parts[count++] = part;
+	}
+
+	return count;
+}
+
+static int hash_verify(struct hash_algo *algo, ulong addr, ulong len,
+		       const uint8_t *output, char *verify_str, int flags)
+{
+	uint8_t vsum[HASH_MAX_DIGEST_SIZE];
+	int i;
+
+	if (parse_verify_sum(algo, verify_str, vsum, flags & HASH_FLAG_ENV)) {
+		printf("ERROR: %s does not contain a valid %s sum\n",
+		       verify_str, algo->name);
+		return 1;
+	}
+	if (memcmp(output, vsum, algo->digest_size) != 0) {
+		hash_show(algo, addr, len, output);
+		printf(" != ");
+		for (i = 0; i < algo->digest_size; i++)
+			printf("%02x", vsum[i]);
+		puts(" ** ERROR **\n");
+		return 1;
+	}
+
+	return 0;
+}
+
 int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 		 int flag, int argc, char *const argv[])
 {
@@ -552,67 +813,91 @@ int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 	len = hextoul(*argv++, NULL);
 
 	if (multi_hash()) {
-		struct hash_algo *algo;
+		struct hash_algo *algos[HASH_MULTI_MAX];
+		uint8_t *outputs[HASH_MULTI_MAX];
+		char *names[HASH_MULTI_MAX], *dests[HASH_MULTI_MAX];
+		char name_buf[64], dest_buf[256];
+		int count, i, ret = 0;
 		u8 *output;
-		uint8_t vsum[HASH_MAX_DIGEST_SIZE];
 		void *buf;
 
-		if (hash_lookup_algo(algo_name, &algo)) {
-			printf("Unknown hash algorithm '%s'\n", algo_name);
+		argc -= 2;
+
+		/* Several algorithms may be given, e.g. "sha256,crc32" */
+		strlcpy(name_buf, algo_name, sizeof(name_buf));
+		count = hash_split(name_buf, names);
+		if (count < 0) {
+			printf("At most %d hash algorithms at once\n",
+			       HASH_MULTI_MAX);
 			return CMD_RET_USAGE;
 		}
-		argc -= 2;
+		for (i = 0; i < count; i++) {
+			if (count > 1 ?
+			    hash_progressive_lookup_algo(names[i], &algos[i]) :
+			    hash_lookup_algo(names[i], &algos[i])) {
+				printf("Unknown hash algorithm '%s'\n",
+				       names[i]);
+				return CMD_RET_USAGE;
+			}
+			if (algos[i]->digest_size > HASH_MAX_DIGEST_SIZE) {
+				puts("HASH_MAX_DIGEST_SIZE exceeded\n");
+				return 1;
+			}
+		}
 
-		if (algo->digest_size > HASH_MAX_DIGEST_SIZE) {
-			puts("HASH_MAX_DIGEST_SIZE exceeded\n");
-			return 1;
+		/* ...along with one destination or sum for each */
+		dests[0] = argc ? *argv : NULL;
+		if (argc && count > 1) {
+			strlcpy(dest_buf, *argv, sizeof(dest_buf));
+			if (hash_split(dest_buf, dests) != count) {
+				printf("Expected %d comma-separated values\n",
+				       count);
+				return CMD_RET_USAGE;
+			}
 		}
 
 		output = memalign(ARCH_DMA_MINALIGN,
-				  sizeof(uint32_t) * HASH_MAX_DIGEST_SIZE);
+				  count * HASH_MAX_DIGEST_SIZE);
 		if (!output)
 			return CMD_RET_FAILURE;
+		for (i = 0; i < count; i++)
+			outputs[i] = output + i * HASH_MAX_DIGEST_SIZE;
 
 		buf = map_sysmem(addr, len);
-		algo->hash_func_ws(buf, len, output, algo->chunk_size);
+		if (count > 1 && hash_block_multi(algos, count, buf, len,
+						  outputs)) {
+			printf("Hashing failed\n");
+			ret = 1;
+		} else if (count == 1) {
+			hash_run(algos[0], buf, len, output);
+		}
 		unmap_sysmem(buf);
 
+		for (i = 0; !ret && i < count; i++) {
 		/* Try to avoid code bloat when verify is not needed */
 #if defined(CONFIG_CRC32_VERIFY) || defined(CONFIG_SHA1SUM_VERIFY) || \
 	defined(CONFIG_MD5SUM_VERIFY) || defined(CONFIG_HASH_VERIFY)
-		if (flags & HASH_FLAG_VERIFY) {
+			if (flags & HASH_FLAG_VERIFY) {
 #else
-		if (0) {
+			if (0) {
 #endif
-			if (parse_verify_sum(algo, *argv, vsum,
-					flags & HASH_FLAG_ENV)) {
-				printf("ERROR: %s does not contain a valid "
-					"%s sum\n", *argv, algo->name);
-				free(output);
-				return 1;
-			}
-			if (memcmp(output, vsum, algo->digest_size) != 0) {
-				int i;
-
-				hash_show(algo, addr, len, output);
-				printf(" != ");
-				for (i = 0; i < algo->digest_size; i++)
-					printf("%02x", vsum[i]);
-				puts(" ** ERROR **\n");
-				free(output);
-				return 1;
-			}
-		} else {
-			hash_show(algo, addr, len, output);
-			printf("\n");
-
-			if (argc) {
-				store_result(algo, output, *argv,
-					flags & HASH_FLAG_ENV);
+				ret = hash_verify(algos[i], addr, len,
+						  outputs[i], dests[i], flags);
+			} else {
+				hash_show(algos[i], addr, len, outputs[i]);
+				printf("\n");
+
+				if (argc) {
+					store_result(algos[i], outputs[i],
+						     dests[i],
+						     flags & HASH_FLAG_ENV);
+				}
 			}
 		}
 
 		free(output);
+		if (ret)
+			return ret;
 
 	/* Horrible code size hack for boards that just want crc32 */
 	} else {
@@ -6,10 +6,12 @@
 #define IOTRACE_IMPL
 
 #include <mapmem.h>
+#include <sort.h>
 #include <time.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <linux/bug.h>
+#include <linux/math64.h>
 #include <u-boot/crc.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -25,6 +27,13 @@ DECLARE_GLOBAL_DATA_PTR;
  * @region_size: Size of region to trace. if 0 will trace all address space
  * @crc32:	Current value of CRC chceksum of trace records
  * @enabled:	true if enabled, false if disabled
+ * @ring:	true to overwrite the oldest records when the buffer is full
+ * @wrapped:	true if the ring has wrapped, so @offset is the oldest record
+ * @busy:	true while adding a record, to ignore accesses by the timer
+ * @last_addr:	Address of the previous access, to spot polling loops
+ * @stats:	Access counts and latencies for each region
+ * @stats_count: Number of regions in @stats
+ * @stats_dropped: Number of accesses to regions which did not fit in @stats
  */
 static struct iotrace {
 	ulong start;
@@ -35,19 +44,67 @@ static struct iotrace {
 	ulong region_size;
 	u32 crc32;
 	bool enabled;
+	bool ring;
+	bool wrapped;
+	bool busy;
+	ulong last_addr;
+	struct iotrace_stats stats[IOTRACE_STATS_REGIONS];
+	int stats_count;
+	ulong stats_dropped;
 } iotrace;
 
-static void add_record(int flags, const void *ptr, ulong value)
+/*
+ * We don't support iotrace before relocation. Since the trace buffer is set
+ * up by a command, it can't be enabled at present. To change this we would
+ * need to set the iotrace buffer at build-time. See lib/trace.c for how this
+ * might be done if you are interested.
+ */
+static bool iotrace_active(void)
+{
+	return (gd->flags & GD_FLG_RELOC) && iotrace.enabled && !iotrace.busy;
+}
+
+/* Get the time before an access, so its latency can be worked out */
+static u64 iotrace_start(void)
+{
+	return iotrace_active() ? get_ticks() : 0;
+}
+
+static void add_stats(int flags, ulong addr, u32 ns)
+{
+	ulong base = addr & ~((1UL << IOTRACE_STATS_SHIFT) - 1);
+	struct iotrace_stats *st;
+	int i;
+
+	for (i = 0, st = iotrace.stats; i < iotrace.stats_count; i++, st++) {
+		if (st->base == base)
+			break;
+	}
+	if (i == iotrace.stats_count) {
+		if (i == IOTRACE_STATS_REGIONS) {
+			iotrace.stats_dropped++;
+			return;
+		}
+		memset(st, '\0', sizeof(*st));
+		st->base = base;
+		iotrace.stats_count++;
+	}
+
+	st->count++;
+	if (!(flags & IOT_WRITE) && addr == iotrace.last_addr)
+		st->polls++;
+	st->total_ns += ns;
+	st->max_ns = max(st->max_ns, ns);
+	st->hist[min(fls(ns / 125), IOTRACE_HIST_BUCKETS - 1)]++;
+}
+
+static void add_record(int flags, const void *ptr, ulong value, u64 start)
 {
 	struct iotrace_record srec, *rec = &srec;
+	ulong addr;
+	u32 ns;
 
-	/*
-	 * We don't support iotrace before relocation. Since the trace buffer
-	 * is set up by a command, it can't be enabled at present. To change
-	 * this we would need to set the iotrace buffer at build-time. See
-	 * lib/trace.c for how this might be done if you are interested.
-	 */
-	if (!(gd->flags & GD_FLG_RELOC) || !iotrace.enabled)
+	if (!start || !iotrace_active())
 		return;
 
 	if (iotrace.region_size)
@@ -55,14 +112,28 @@ static void add_record(int flags, const void *ptr, ulong value)
 		    (ulong)ptr > iotrace.region_start + iotrace.region_size)
 			return;
 
-	/* Store it if there is room */
-	if (iotrace.offset + sizeof(*rec) < iotrace.size) {
+	/* Reading the timer may itself access I/O, so ignore that */
+	iotrace.busy = true;
+	ns = min_t(u64, div_u64((get_ticks() - start) * 1000000000ULL,
+				get_tbclk()), U32_MAX);
+	addr = map_to_sysmem(ptr);
+	add_stats(flags, addr, ns);
+	iotrace.last_addr = addr;
+
+	/* Store it if there is room, going back to the start in a ring */
+	if (iotrace.ring && iotrace.offset + sizeof(*rec) > iotrace.size &&
+	    iotrace.size >= sizeof(*rec)) {
+		iotrace.offset = 0;
+		iotrace.wrapped = true;
+	}
+	if (iotrace.offset + sizeof(*rec) <= iotrace.size) {
 		rec = (struct iotrace_record *)map_sysmem(
 					iotrace.start + iotrace.offset,
 					sizeof(value));
 	} else {
 		WARN_ONCE(1, "WARNING: iotrace buffer exhausted, please check needed length using \"iotrace stats\"\n");
 		iotrace.needed_size += sizeof(struct iotrace_record);
+		iotrace.busy = false;
 		return;
 	}
 
@@ -77,54 +148,64 @@ static void add_record(int flags, const void *ptr, ulong value)
 
 	iotrace.needed_size += sizeof(struct iotrace_record);
 	iotrace.offset += sizeof(struct iotrace_record);
+	iotrace.busy = false;
 }
 
 u32 iotrace_readl(const void *ptr)
 {
+	u64 start = iotrace_start();
 	u32 v;
 
 	v = readl(ptr);
-	add_record(IOT_32 | IOT_READ, ptr, v);
+	add_record(IOT_32 | IOT_READ, ptr, v, start);
 
 	return v;
 }
 
 void iotrace_writel(ulong value, void *ptr)
 {
-	add_record(IOT_32 | IOT_WRITE, ptr, value);
+	u64 start = iotrace_start();
+
 	writel(value, ptr);
+	add_record(IOT_32 | IOT_WRITE, ptr, value, start);
 }
 
 u16 iotrace_readw(const void *ptr)
 {
+	u64 start = iotrace_start();
 	u32 v;
 
 	v = readw(ptr);
-	add_record(IOT_16 | IOT_READ, ptr, v);
+	add_record(IOT_16 | IOT_READ, ptr, v, start);
 
 	return v;
 }
 
 void iotrace_writew(ulong value, void *ptr)
 {
-	add_record(IOT_16 | IOT_WRITE, ptr, value);
+	u64 start = iotrace_start();
+
 	writew(value, ptr);
+	add_record(IOT_16 | IOT_WRITE, ptr, value, start);
 }
 
 u8 iotrace_readb(const void *ptr)
 {
+	u64 start = iotrace_start();
 	u32 v;
 
 	v = readb(ptr);
-	add_record(IOT_8 | IOT_READ, ptr, v);
+	add_record(IOT_8 | IOT_READ, ptr, v, start);
 
 	return v;
 }
 
 void iotrace_writeb(ulong value, void *ptr)
 {
-	add_record(IOT_8 | IOT_WRITE, ptr, value);
+	u64 start = iotrace_start();
+
 	writeb(value, ptr);
+	add_record(IOT_8 | IOT_WRITE, ptr, value, start);
 }
 
 void iotrace_reset_checksum(void)
@@ -171,6 +252,53 @@ void iotrace_set_buffer(ulong start, ulong size)
 	iotrace.size = size;
 	iotrace.offset = 0;
 	iotrace.crc32 = 0;
+	iotrace.wrapped = false;
+	iotrace.stats_count = 0;
+	iotrace.stats_dropped = 0;
+}
+
+void iotrace_set_ring(bool ring)
+{
+	iotrace.ring = ring;
+}
+
+struct iotrace_record *iotrace_get_record(ulong n)
+{
+	ulong count = iotrace.size / sizeof(struct iotrace_record);
+	ulong first = 0;
+
+	if (iotrace.wrapped)
+		first = iotrace.offset / sizeof(struct iotrace_record);
+	else
+		count = iotrace.offset / sizeof(struct iotrace_record);
+	if (n >= count)
+		return NULL;
+
+	return map_sysmem(iotrace.start +
+			  (first + n) % count * sizeof(struct iotrace_record),
+			  sizeof(struct iotrace_record));
+}
+
+static int h_cmp_stats(const void *v1, const void *v2)
+{
+	const struct iotrace_stats *s1 = v1, *s2 = v2;
+
+	/* Most total time first */
+	if (s1->total_ns != s2->total_ns)
+		return s1->total_ns < s2->total_ns ? 1 : -1;
+
+	return 0;
+}
+
+const struct iotrace_stats *iotrace_get_stats(int *countp, ulong *droppedp)
+{
+	/* The regions are searched linearly, so the order does not matter */
+	qsort(iotrace.stats, iotrace.stats_count, sizeof(iotrace.stats[0]),
+	      h_cmp_stats);
+	*countp = iotrace.stats_count;
+	*droppedp = iotrace.stats_dropped;
+
+	return iotrace.stats;
 }
 
 void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *offset, ulong *count)
@@ -179,5 +307,6 @@ void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *of
 	*size = iotrace.size;
 	*needed_size = iotrace.needed_size;
 	*offset = iotrace.offset;
-	*count = iotrace.offset / sizeof(struct iotrace_record);
+	*count = (iotrace.wrapped ? iotrace.size : iotrace.offset) /
+		sizeof(struct iotrace_record);
 }
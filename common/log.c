@@ -232,17 +232,31 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 	/* Emit message */
 	gd->processing_msg = true;
 	list_for_each_entry(ldev, &gd->log_head, sibling_node) {
-		if ((ldev->flags & LOGDF_ENABLE) &&
-		    log_passes_filters(ldev, rec)) {
+		va_list cp;
+
+		if (!(ldev->flags & LOGDF_ENABLE) ||
+		    !log_passes_filters(ldev, rec))
+			continue;
+
+		/* each driver may consume the arguments */
+		va_copy(cp, args);
+		if (ldev->drv->emit_fmt) {
+			const char *msg = rec->msg;
+
+			rec->msg = NULL;
+			ldev->drv->emit_fmt(ldev, rec, fmt, cp);
+			rec->msg = msg;
+		} else {
 			if (!rec->msg) {
 				int len;
 
-				len = vsnprintf(buf, sizeof(buf), fmt, args);
+				len = vsnprintf(buf, sizeof(buf), fmt, cp);
 				rec->msg = buf;
 				gd->log_cont = len && buf[len - 1] != '\n';
 			}
 			ldev->drv->emit(ldev, rec);
 		}
+		va_end(cp);
 	}
 	gd->processing_msg = false;
 	return 0;
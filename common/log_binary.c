@@ -0,0 +1,546 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Log driver which stores records in binary form, formatting them only when
+ * they are read
+ *
+ * Each record holds the address of its format string and a copy of its
+ * arguments, so logging a message costs little more than a memcpy(). The
+ * records are kept in a ring buffer, in a bloblist if available so that the
+ * log survives relocation and can be passed on to the OS.
+ */
+
+#include <bloblist.h>
+#include <bootstage.h>
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <asm/unaligned.h>
+#include <linux/ctype.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define LOG_BIN_MAGIC		0x4c424e55	/* UNBL */
+
+enum {
+	/* Maximum size of the arguments of a record, in bytes */
+	LOG_BIN_MAX_ARGS	= 256,
+
+	/* Maximum length of a string argument which is stored */
+	LOG_BIN_MAX_STR		= 200,
+
+	/* Maximum length of a single conversion specification */
+	LOG_BIN_MAX_SPEC	= 32,
+};
+
+/**
+ * struct log_bin_hdr - Header of the binary log
+ *
+ * The records follow this header. They are stored one after another from
+ * @tail to @head, wrapping back to the start of the data area when there is
+ * not enough room at the end. A record with a @size of 0 marks the wrap point.
+ *
+ * @magic: LOG_BIN_MAGIC
+ * @size: Size of the data area in bytes
+ * @head: Offset where the next record is written
+ * @tail: Offset of the oldest record
+ * @count: Number of records in the log
+ * @dropped: Number of records dropped to make room for newer ones
+ * @reloc_off: Relocation offset of U-Boot, to allow a host tool to find the
+ *	strings in the ELF file
+ */
+struct log_bin_hdr {
+	u32 magic;
+	u32 size;
+	u32 head;
+	u32 tail;
+	u32 count;
+	u32 dropped;
+	u64 reloc_off;
+};
+
+enum log_bin_rec_flags {
+	LOGBF_PRE_RELOC		= BIT(0),	/* logged before relocation */
+	LOGBF_TEXT		= BIT(1),	/* @args is formatted text */
+};
+
+/**
+ * struct log_bin_rec - A record in the binary log
+ *
+ * @size: Size of the record including its arguments, 0 for the wrap marker
+ * @cat: Category (enum log_category_t)
+ * @level: Level (enum log_level_t)
+ * @line: Line number
+ * @flags: Flags from struct log_rec
+ * @bflags: Flags for this record (enum log_bin_rec_flags)
+ * @time_us: Time since boot when the record was logged
+ * @fmt: Address of the format string
+ * @file: Address of the file name
+ * @func: Address of the function name
+ * @args: Arguments: a u64 for each integer or pointer and a nul-terminated
+ *	copy of each string, in order. With LOGBF_TEXT this is the formatted
+ *	message instead
+ */
+struct log_bin_rec {
+	u16 size;
+	u8 cat;
+	u8 level;
+	u16 line;
+	u8 flags;
+	u8 bflags;
+	u64 time_us;
+	u64 fmt;
+	u64 file;
+	u64 func;
+	u8 args[];
+};
+
+enum log_bin_arg_t {
+	LOGBA_NONE,	/* no argument, e.g. %% */
+	LOGBA_INT,
+	LOGBA_LONG,
+	LOGBA_LLONG,
+	LOGBA_PTR,
+	LOGBA_STR,
+	LOGBA_BAD,	/* not supported, e.g. %pM which needs its data */
+};
+
+/**
+ * struct log_bin_spec - A conversion specification within a format string
+ *
+ * @start: Pointer to the '%'
+ * @len: Length of the specification
+ * @stars: Number of '*' width / precision arguments (0 to 2)
+ * @type: Type of argument to the conversion
+ */
+struct log_bin_spec {
+	const char *start;
+	int len;
+	int stars;
+	enum log_bin_arg_t type;
+};
+
+/**
+ * log_bin_parse() - Find the next conversion in a format string
+ *
+ * @fmt: Format string to search
+ * @spec: Returns information about the conversion
+ * Return: pointer to the character after the conversion, or NULL if there
+ *	are no more
+ */
+static const char *log_bin_parse(const char *fmt, struct log_bin_spec *spec)
+{
+	const char *p = strchr(fmt, '%');
+	int longs = 0;
+	char conv;
+
+	if (!p)
+		return NULL;
+	spec->start = p++;
+	spec->stars = 0;
+	spec->type = LOGBA_NONE;
+	if (*p == '%') {
+		spec->len = 2;
+		return p + 1;
+	}
+
+	while (*p && strchr("-+ #0", *p))
+		p++;
+	if (*p == '*') {
+		spec->stars++;
+		p++;
+	}
+	while (isdigit(*p))
+		p++;
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->stars++;
+			p++;
+		}
+		while (isdigit(*p))
+			p++;
+	}
+	for (;; p++) {
+		if (*p == 'l' || *p == 'z' || *p == 't')
+			longs++;
+		else if (*p == 'L' || *p == 'q' || *p == 'j')
+			longs = 2;
+		else if (*p != 'h')
+			break;
+	}
+
+	conv = *p;
+	if (conv)
+		p++;
+	switch (conv) {
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'x':
+	case 'X':
+	case 'o':
+	case 'c':
+		spec->type = longs > 1 ? LOGBA_LLONG :
+			longs ? LOGBA_LONG : LOGBA_INT;
+		break;
+	case 's':
+		spec->type = longs ? LOGBA_BAD : LOGBA_STR;
+		break;
+	case 'p':
+		/* extensions such as %pM print the data pointed to */
+		spec->type = isalnum(*p) ? LOGBA_BAD : LOGBA_PTR;
+		break;
+	default:
+		spec->type = LOGBA_BAD;
+		break;
+	}
+	spec->len = p - spec->start;
+	if (spec->len >= LOG_BIN_MAX_SPEC)
+		spec->type = LOGBA_BAD;
+
+	return p;
+}
+
+/**
+ * log_bin_pack() - Copy the arguments of a log message
+ *
+ * @fmt: Format string
+ * @args: Arguments
+ * @buf: Buffer to hold the arguments
+ * Return: number of bytes used, or -ENOSPC if there is not enough space, or
+ *	-ENOTSUPP if the format string uses conversions which cannot be stored
+ */
+static int log_bin_pack(const char *fmt, va_list args,
+			u8 buf[LOG_BIN_MAX_ARGS])
+{
+	struct log_bin_spec spec;
+	u8 *ptr = buf, *end = buf + LOG_BIN_MAX_ARGS;
+	u64 val;
+	int i;
+
+	while ((fmt = log_bin_parse(fmt, &spec))) {
+		const char *str;
+		int len;
+
+		if (spec.type == LOGBA_BAD)
+			return -ENOTSUPP;
+		for (i = 0; i < spec.stars; i++) {
+			if (ptr + sizeof(val) > end)
+				return -ENOSPC;
+			val = va_arg(args, int);
+			put_unaligned(val, (u64 *)ptr);
+			ptr += sizeof(val);
+		}
+
+		switch (spec.type) {
+		case LOGBA_NONE:
+		case LOGBA_BAD:
+			continue;
+		case LOGBA_INT:
+			val = va_arg(args, int);
+			break;
+		case LOGBA_LONG:
+			val = va_arg(args, long);
+			break;
+		case LOGBA_LLONG:
+			val = va_arg(args, long long);
+			break;
+		case LOGBA_PTR:
+			val = (ulong)va_arg(args, void *);
+			break;
+		case LOGBA_STR:
+			str = va_arg(args, const char *);
+			if (!str)
+				str = "<NULL>";
+			len = strnlen(str, LOG_BIN_MAX_STR);
+			if (ptr + len + 1 > end)
+				return -ENOSPC;
+			memcpy(ptr, str, len);
+			ptr[len] = '\0';
+			ptr += len + 1;
+			continue;
+		}
+		if (ptr + sizeof(val) > end)
+			return -ENOSPC;
+		put_unaligned(val, (u64 *)ptr);
+		ptr += sizeof(val);
+	}
+
+	return ptr - buf;
+}
+
+/**
+ * log_bin_unpack() - Format a message from its stored arguments
+ *
+ * @fmt: Format string
+ * @args: Arguments as stored by log_bin_pack()
+ * @buf: Buffer for the message
+ * @size: Size of @buf
+ */
+static void log_bin_unpack(const char *fmt, const u8 *args, char *buf,
+			   int size)
+{
+	struct log_bin_spec spec;
+	char *ptr = buf, *end = buf + size;
+	const char *next;
+
+	while (ptr < end - 1) {
+		char conv[LOG_BIN_MAX_SPEC * 2];
+		const char *in, *in_end;
+		char *out = conv;
+		u64 val = 0;
+
+		next = log_bin_parse(fmt, &spec);
+		if (!next) {
+			strlcpy(ptr, fmt, end - ptr);
+			return;
+		}
+
+		/* copy the text before the conversion */
+		while (fmt < spec.start && ptr < end - 1)
+			*ptr++ = *fmt++;
+		fmt = next;
+		if (spec.type == LOGBA_NONE) {
+			if (ptr < end - 1)
+				*ptr++ = '%';
+			continue;
+		}
+
+		/* build the conversion with any '*' replaced by its value */
+		in_end = spec.start + spec.len;
+		for (in = spec.start; in < in_end; in++) {
+			if (*in == '*') {
+				val = get_unaligned((u64 *)args);
+				args += sizeof(val);
+				out += snprintf(out, conv + sizeof(conv) - out,
+						"%d", (int)val);
+			} else {
+				*out++ = *in;
+			}
+		}
+		*out = '\0';
+
+		if (spec.type == LOGBA_STR) {
+			ptr += snprintf(ptr, end - ptr, conv, args);
+			args += strlen((const char *)args) + 1;
+		} else {
+			val = get_unaligned((u64 *)args);
+			args += sizeof(val);
+			switch (spec.type) {
+			case LOGBA_INT:
+				ptr += snprintf(ptr, end - ptr, conv, (int)val);
+				break;
+			case LOGBA_LONG:
+				ptr += snprintf(ptr, end - ptr, conv,
+						(long)val);
+				break;
+			case LOGBA_LLONG:
+				ptr += snprintf(ptr, end - ptr, conv,
+						(long long)val);
+				break;
+			default:
+				ptr += snprintf(ptr, end - ptr, conv,
+						(void *)(ulong)val);
+				break;
+			}
+		}
+		if (ptr > end - 1)
+			ptr = end - 1;
+	}
+	*ptr = '\0';
+}
+
+/**
+ * log_bin_get() - Get the binary log, setting it up if needed
+ *
+ * Return: log header, or NULL if it is not available
+ */
+static struct log_bin_hdr *log_bin_get(void)
+{
+	static struct log_bin_hdr *hdr;
+	struct log_bin_hdr *ptr;
+	int size = CONFIG_LOG_BINARY_SIZE;
+
+	if (IS_ENABLED(CONFIG_BLOBLIST)) {
+		/* look this up each time, since the bloblist can move */
+		if (bloblist_ensure_size(BLOBLISTT_U_BOOT_LOG, size, 3,
+					 (void **)&ptr))
+			return NULL;
+	} else {
+		/* static data is only writable after relocation */
+		if (!(gd->flags & GD_FLG_RELOC))
+			return NULL;
+		if (!hdr)
+			hdr = malloc(size);
+		ptr = hdr;
+		if (!ptr)
+			return NULL;
+	}
+	if (ptr->magic != LOG_BIN_MAGIC) {
+		memset(ptr, '\0', sizeof(*ptr));
+		ptr->magic = LOG_BIN_MAGIC;
+		ptr->size = size - sizeof(*ptr);
+	}
+	ptr->reloc_off = gd->reloc_off;
+
+	return ptr;
+}
+
+static struct log_bin_rec *log_bin_rec_at(struct log_bin_hdr *hdr, uint off)
+{
+	return (void *)(hdr + 1) + off;
+}
+
+/* drop the oldest record */
+static void log_bin_drop(struct log_bin_hdr *hdr)
+{
+	struct log_bin_rec *rec = log_bin_rec_at(hdr, hdr->tail);
+
+	if (!rec->size) {
+		hdr->tail = 0;
+		return;
+	}
+	hdr->tail += rec->size;
+	hdr->dropped++;
+	if (!--hdr->count)
+		hdr->head = hdr->tail = 0;
+}
+
+/**
+ * log_bin_reserve() - Make room for a new record
+ *
+ * This drops the oldest records as needed
+ *
+ * @hdr: Log header
+ * @size: Size of the record in bytes
+ * Return: new record, or NULL if it is too large for the log
+ */
+static struct log_bin_rec *log_bin_reserve(struct log_bin_hdr *hdr,
+					   uint size)
+{
+	uint off;
+
+	/* leave room at the end for the wrap marker */
+	if (size + sizeof(u16) > hdr->size)
+		return NULL;
+	if (hdr->head + size + sizeof(u16) > hdr->size) {
+		while (hdr->count && hdr->tail >= hdr->head)
+			log_bin_drop(hdr);
+		if (hdr->head + size + sizeof(u16) > hdr->size) {
+			log_bin_rec_at(hdr, hdr->head)->size = 0;
+			hdr->head = 0;
+		}
+	}
+	while (hdr->count && hdr->tail >= hdr->head &&
+	       hdr->tail < hdr->head + size)
+		log_bin_drop(hdr);
+
+	off = hdr->head;
+	hdr->head += size;
+	hdr->count++;
+
+	return log_bin_rec_at(hdr, off);
+}
+
+static int log_binary_emit_fmt(struct log_device *ldev, struct log_rec *rec,
+			       const char *fmt, va_list args)
+{
+	u8 buf[LOG_BIN_MAX_ARGS];
+	struct log_bin_rec *brec;
+	struct log_bin_hdr *hdr;
+	u8 bflags = 0;
+	va_list cp;
+	int len;
+
+	hdr = log_bin_get();
+	if (!hdr)
+		return -ENOENT;
+
+	va_copy(cp, args);
+	len = log_bin_pack(fmt, cp, buf);
+	va_end(cp);
+	if (len < 0) {
+		/* format it now instead */
+		len = vsnprintf((char *)buf, sizeof(buf), fmt, args) + 1;
+		len = min(len, (int)sizeof(buf));
+		bflags |= LOGBF_TEXT;
+	}
+	if (!(gd->flags & GD_FLG_RELOC))
+		bflags |= LOGBF_PRE_RELOC;
+
+	brec = log_bin_reserve(hdr, ALIGN(sizeof(*brec) + len, 8));
+	if (!brec)
+		return -E2BIG;
+	brec->size = ALIGN(sizeof(*brec) + len, 8);
+	brec->cat = rec->cat;
+	brec->level = rec->level;
+	brec->line = rec->line;
+	brec->flags = rec->flags;
+	brec->bflags = bflags;
+	brec->time_us = timer_get_boot_us();
+	brec->fmt = (ulong)fmt;
+	brec->file = (ulong)rec->file;
+	brec->func = (ulong)rec->func;
+	memcpy(brec->args, buf, len);
+
+	return 0;
+}
+
+/* emit() is required, but only used if a record is already formatted */
+static int log_binary_emit(struct log_device *ldev, struct log_rec *rec)
+{
+	return -ENOSYS;
+}
+
+int log_binary_show(void)
+{
+	char msg[CONFIG_SYS_CBSIZE];
+	struct log_bin_hdr *hdr;
+	uint off, i;
+
+	hdr = log_bin_get();
+	if (!hdr)
+		return -ENOENT;
+
+	off = hdr->tail;
+	for (i = 0; i < hdr->count; i++) {
+		struct log_bin_rec *rec = log_bin_rec_at(hdr, off);
+		ulong adj = 0;
+
+		if (!rec->size) {
+			off = 0;
+			i--;
+			continue;
+		}
+		if ((rec->bflags & LOGBF_PRE_RELOC) &&
+		    (gd->flags & GD_FLG_RELOC))
+			adj = gd->reloc_off;
+		if (rec->bflags & LOGBF_TEXT)
+			strlcpy(msg, (char *)rec->args, sizeof(msg));
+		else
+			log_bin_unpack((char *)(ulong)rec->fmt + adj,
+				       rec->args, msg, sizeof(msg));
+		if (!(rec->flags & LOGRECF_CONT)) {
+			printf("%10llu %s.%s,%s:%d-%s() ",
+			       (unsigned long long)rec->time_us,
+			       log_get_level_name(rec->level),
+			       log_get_cat_name(rec->cat),
+			       (char *)(ulong)rec->file + adj, rec->line,
+			       (char *)(ulong)rec->func + adj);
+		}
+		puts(msg);
+		off += rec->size;
+	}
+	if (hdr->dropped)
+		printf("(%u older records dropped)\n", hdr->dropped);
+
+	return 0;
+}
+
+LOG_DRIVER(binary) = {
+	.name		= "binary",
+	.emit		= log_binary_emit,
+	.emit_fmt	= log_binary_emit_fmt,
+	.flags		= LOGDF_ENABLE,
+};
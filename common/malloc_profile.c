@@ -0,0 +1,319 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Heap usage for each allocation site
+ *
+ * The table of sites is kept in the bloblist when there is one, so that it
+ * can be written before relocation, survives relocation and can be read by
+ * the next phase. Otherwise it is kept in BSS, which means that recording
+ * starts once the full malloc() is ready.
+ *
+ * To charge a free() to the site which made the allocation, each allocation
+ * made by the full malloc() is remembered in a hash table until it is freed.
+ * Memory from the simple allocator is never freed, so needs no tracking.
+ */
+
+#define LOG_CATEGORY	LOGC_ALLOC
+
+#include <bloblist.h>
+#include <errno.h>
+#include <malloc_profile.h>
+#include <spl.h>
+#include <stdio.h>
+#include <asm/global_data.h>
+#include <asm/sections.h>
+#include <linux/kernel.h>
+#include <linux/string.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define PROF_SITES	CONFIG_MALLOC_PROFILE_SITES
+#define PROF_LIVE	CONFIG_MALLOC_PROFILE_LIVE
+#define PROF_SIZE	MALLOC_PROFILE_SIZE(PROF_SITES)
+
+/**
+ * struct malloc_profile_live - an allocation which has not been freed
+ *
+ * @ptr: Address of the allocation, 0 if this entry is empty
+ * @size: Number of bytes requested
+ * @seq: Value of the profile's @seq when this was allocated
+ * @site: Index of the site which made the allocation
+ */
+struct malloc_profile_live {
+	ulong ptr;
+	u32 size;
+	u32 seq;
+	u16 site;
+};
+
+static u64 prof_bss[DIV_ROUND_UP(PROF_SIZE, sizeof(u64))];
+static struct malloc_profile_live prof_live[PROF_LIVE];
+static uint prof_live_count;
+
+/* Get the bloblist tag for this phase, 0 if it has none */
+static uint malloc_profile_tag(void)
+{
+	switch (xpl_phase()) {
+	case PHASE_SPL:
+		return BLOBLISTT_U_BOOT_SPL_MALLOC_PROFILE;
+	case PHASE_BOARD_F:
+	case PHASE_BOARD_R:
+		return BLOBLISTT_U_BOOT_MALLOC_PROFILE;
+	default:
+		return 0;
+	}
+}
+
+static void malloc_profile_init(struct malloc_profile *prof)
+{
+	memset(prof, '\0', PROF_SIZE);
+	prof->version = MALLOC_PROFILE_VERSION;
+	prof->max_sites = PROF_SITES;
+}
+
+/* Check that a table found earlier has not since been moved */
+static bool malloc_profile_valid(struct malloc_profile *prof)
+{
+	if (prof == (void *)prof_bss)
+		return true;
+#if CONFIG_IS_ENABLED(BLOBLIST)
+	if (gd->bloblist &&
+	    (ulong)prof - (ulong)gd->bloblist < gd->bloblist->total_size)
+		return true;
+#endif
+
+	return false;
+}
+
+/* Find the table in the bloblist, adding it if needed */
+static struct malloc_profile *malloc_profile_bloblist(void)
+{
+#if CONFIG_IS_ENABLED(BLOBLIST)
+	uint tag = malloc_profile_tag();
+	struct malloc_profile *prof;
+
+	if (!gd->bloblist || !tag)
+		return NULL;
+	prof = bloblist_find(tag, PROF_SIZE);
+	if (!prof) {
+		prof = bloblist_add(tag, PROF_SIZE, 3);
+		if (prof)
+			malloc_profile_init(prof);
+	}
+
+	return prof;
+#else
+	return NULL;
+#endif
+}
+
+struct malloc_profile *malloc_profile_get(void)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+
+	if (prof && malloc_profile_valid(prof))
+		return prof;
+
+	prof = malloc_profile_bloblist();
+
+	/* BSS can only be written once the full malloc() is ready */
+	if (!prof && (gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
+		prof = (void *)prof_bss;
+		if (!prof->version)
+			malloc_profile_init(prof);
+	}
+	gd->malloc_profile = prof;
+
+	return prof;
+}
+
+/* Convert a return address to the link address which System.map shows */
+static u32 malloc_profile_caller(void *caller)
+{
+	ulong addr = (ulong)caller;
+
+#ifdef CONFIG_SANDBOX
+	addr -= (ulong)_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		addr -= gd->reloc_off;
+#endif
+
+	return addr;
+}
+
+static int malloc_profile_site(struct malloc_profile *prof, u32 caller)
+{
+	uint size = prof->max_sites * 2;
+	u16 *index = malloc_profile_index(prof);
+	uint i, idx;
+
+	for (i = caller * 2654435761U % size; index[i]; i = (i + 1) % size) {
+		idx = index[i] - 1;
+		if (prof->site[idx].caller == caller)
+			return idx;
+	}
+	if (prof->num_sites == prof->max_sites)
+		return -ENOSPC;
+	idx = prof->num_sites++;
+	prof->site[idx].caller = caller;
+	index[i] = idx + 1;
+
+	return idx;
+}
+
+static uint malloc_profile_hash(ulong ptr)
+{
+	return (ptr >> 4) * 2654435761U % PROF_LIVE;
+}
+
+/* Only the full malloc() frees memory, and only then can BSS be written */
+static bool malloc_profile_tracking(void)
+{
+	return !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE) &&
+		(gd->flags & GD_FLG_FULL_MALLOC_INIT);
+}
+
+static int malloc_profile_track(void *ptr, u32 size, u32 seq, int site)
+{
+	struct malloc_profile_live *ent;
+	uint i;
+
+	/* Keep an empty entry, so that searches end */
+	if (prof_live_count == PROF_LIVE - 1)
+		return -ENOSPC;
+	for (i = malloc_profile_hash((ulong)ptr); prof_live[i].ptr;
+	     i = (i + 1) % PROF_LIVE)
+		;
+	ent = &prof_live[i];
+	ent->ptr = (ulong)ptr;
+	ent->size = size;
+	ent->seq = seq;
+	ent->site = site;
+	prof_live_count++;
+
+	return 0;
+}
+
+/*
+ * Remove an entry, moving up any later entries in the same run which would
+ * otherwise no longer be found from their hash position
+ */
+static void malloc_profile_untrack(uint i)
+{
+	uint j = i, k;
+
+	while (true) {
+		j = (j + 1) % PROF_LIVE;
+		if (!prof_live[j].ptr)
+			break;
+		k = malloc_profile_hash(prof_live[j].ptr);
+		if (i < j ? k <= i || k > j : k <= i && k > j) {
+			prof_live[i] = prof_live[j];
+			i = j;
+		}
+	}
+	prof_live[i].ptr = 0;
+	prof_live_count--;
+}
+
+void malloc_profile_alloc(void *ptr, size_t size, void *caller)
+{
+	struct malloc_profile_site *site;
+	struct malloc_profile *prof;
+	int idx;
+
+	prof = malloc_profile_get();
+	if (!prof)
+		return;
+	idx = malloc_profile_site(prof, malloc_profile_caller(caller));
+	if (idx < 0) {
+		prof->dropped++;
+		return;
+	}
+	site = &prof->site[idx];
+	if (!ptr) {
+		site->failed++;
+		return;
+	}
+
+	prof->seq++;
+	site->count++;
+	site->total += size;
+	site->live += size;
+	if (site->live > site->peak)
+		site->peak = site->live;
+	if (malloc_profile_tracking() &&
+	    malloc_profile_track(ptr, size, prof->seq, idx))
+		prof->untracked++;
+}
+
+void malloc_profile_free(void *ptr)
+{
+	struct malloc_profile_live *ent;
+	struct malloc_profile_site *site;
+	struct malloc_profile *prof;
+	uint i;
+
+	if (!ptr || !malloc_profile_tracking() || !prof_live_count)
+		return;
+	for (i = malloc_profile_hash((ulong)ptr); prof_live[i].ptr;
+	     i = (i + 1) % PROF_LIVE) {
+		if (prof_live[i].ptr == (ulong)ptr)
+			break;
+	}
+	ent = &prof_live[i];
+	if (!ent->ptr)
+		return;
+
+	prof = malloc_profile_get();
+	if (prof && ent->site < prof->num_sites) {
+		site = &prof->site[ent->site];
+		site->frees++;
+		site->live -= ent->size;
+		site->lifetime += prof->seq - ent->seq;
+	}
+	malloc_profile_untrack(i);
+}
+
+int malloc_profile_stash(void)
+{
+	struct malloc_profile *prof = malloc_profile_get();
+	void *blob;
+
+	if (!prof)
+		return -ENOENT;
+	if (!CONFIG_IS_ENABLED(BLOBLIST) || !malloc_profile_tag())
+		return -ENOSYS;
+	if (prof != (void *)prof_bss)
+		return 0;
+	blob = bloblist_add(malloc_profile_tag(), PROF_SIZE, 3);
+	if (!blob)
+		return -ENOSPC;
+	memcpy(blob, prof, PROF_SIZE);
+	gd->malloc_profile = blob;
+
+	return 0;
+}
+
+void malloc_profile_show(const struct malloc_profile *prof)
+{
+	const struct malloc_profile_site *site;
+	ulong live = 0, peak = 0;
+	int i;
+
+	printf("%10s %7s %6s %7s %8s %8s %9s %8s\n", "Caller", "Allocs",
+	       "Failed", "Freed", "Live", "Peak", "Total", "Lifetime");
+	for (i = 0, site = prof->site; i < prof->num_sites; i++, site++) {
+		printf("%10x %7u %6u %7u %8u %8u %9u %8u\n", site->caller,
+		       site->count, site->failed, site->frees, site->live,
+		       site->peak, site->total,
+		       site->frees ? site->lifetime / site->frees : 0);
+		live += site->live;
+		peak += site->peak;
+	}
+	printf("%d sites, %u allocations, %lu bytes live, %lu sum of peaks\n",
+	       prof->num_sites, prof->seq, live, peak);
+	if (prof->dropped || prof->untracked)
+		printf("%u allocations not recorded, %u not tracked until freed\n",
+		       prof->dropped, prof->untracked);
+}
@@ -9,6 +9,7 @@
 
 #include <log.h>
 #include <malloc.h>
+#include <malloc_profile.h>
 #include <mapmem.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -42,6 +43,8 @@ void *malloc_simple(size_t bytes)
 	void *ptr;
 
 	ptr = alloc_simple(bytes, 1);
+	if (CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE))
+		malloc_profile_alloc(ptr, bytes, __builtin_return_address(0));
 	if (!ptr)
 		return ptr;
 
@@ -56,6 +59,8 @@ void *memalign_simple(size_t align, size_t bytes)
 	void *ptr;
 
 	ptr = alloc_simple(bytes, align);
+	if (CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE))
+		malloc_profile_alloc(ptr, bytes, __builtin_return_address(0));
 	if (!ptr)
 		return ptr;
 	log_debug("aligned to %lx\n", (ulong)ptr);
@@ -70,9 +75,11 @@ void *calloc(size_t nmemb, size_t elem_size)
 	size_t size = nmemb * elem_size;
 	void *ptr;
 
-	ptr = malloc(size);
+	ptr = alloc_simple(size, 1);
+	malloc_profile_alloc(ptr, size, __builtin_return_address(0));
 	if (!ptr)
 		return ptr;
+	VALGRIND_MALLOCLIKE_BLOCK(ptr, size, 0, false);
 	memset(ptr, '\0', size);
 
 	return ptr;
@@ -17,6 +17,7 @@
 #include <irq_func.h>
 #include <log.h>
 #include <mapmem.h>
+#include <of_live.h>
 #include <serial.h>
 #include <spl.h>
 #include <spl_load.h>
@@ -32,6 +33,7 @@
 #include <version.h>
 #include <image.h>
 #include <malloc.h>
+#include <malloc_profile.h>
 #include <mapmem.h>
 #include <dm/root.h>
 #include <dm/util.h>
@@ -125,6 +127,54 @@ void __weak spl_perform_fixups(struct spl_image_info *spl_image)
 {
 }
 
+#if CONFIG_IS_ENABLED(FALCON_FDT_CACHE)
+/* Property in /chosen recording the inputs the blob was fixed up for */
+#define SPL_FDT_FINGERPRINT_PROP	"u-boot,spl-fixup-fingerprint"
+
+__weak u32 board_spl_fdt_fingerprint(u32 crc)
+{
+	return crc;
+}
+
+static u32 spl_fdt_fingerprint(void)
+{
+	u32 crc;
+
+	crc = crc32(0, (const uchar *)&gd->ram_size, sizeof(gd->ram_size));
+	crc = crc32(crc, (const uchar *)gd->bd->bi_dram,
+		    sizeof(gd->bd->bi_dram));
+
+	return board_spl_fdt_fingerprint(crc);
+}
+
+bool spl_fdt_prepared(const void *fdt_blob)
+{
+	const fdt32_t *val;
+	int len, node;
+
+	if (fdt_check_header(fdt_blob))
+		return false;
+	node = fdt_path_offset(fdt_blob, "/chosen");
+	if (node < 0)
+		return false;
+	val = fdt_getprop(fdt_blob, node, SPL_FDT_FINGERPRINT_PROP, &len);
+
+	return val && len == sizeof(*val) &&
+		fdt32_to_cpu(*val) == spl_fdt_fingerprint();
+}
+
+static void spl_fdt_set_prepared(void *fdt_blob)
+{
+	int node;
+
+	node = fdt_find_or_add_subnode(fdt_blob, 0, "chosen");
+	if (node < 0 ||
+	    fdt_setprop_u32(fdt_blob, node, SPL_FDT_FINGERPRINT_PROP,
+			    spl_fdt_fingerprint()))
+		debug("Cannot record FDT fingerprint\n");
+}
+#endif
+
 void spl_fixup_fdt(void *fdt_blob)
 {
 #if defined(CONFIG_SPL_OF_LIBFDT)
@@ -139,6 +189,13 @@ void spl_fixup_fdt(void *fdt_blob)
 		return;
 	}
 
+#if CONFIG_IS_ENABLED(FALCON_FDT_CACHE)
+	if (spl_fdt_prepared(fdt_blob)) {
+		debug("FDT already fixed up for this board\n");
+		return;
+	}
+#endif
+
 	/* fixup the memory dt node */
 	err = fdt_shrink_to_minimum(fdt_blob, 0);
 	if (err == 0) {
@@ -151,6 +208,10 @@ void spl_fixup_fdt(void *fdt_blob)
 		printf(PHASE_PROMPT "arch_fixup_fdt err - %d\n", err);
 		return;
 	}
+
+#if CONFIG_IS_ENABLED(FALCON_FDT_CACHE)
+	spl_fdt_set_prepared(fdt_blob);
+#endif
 #endif
 }
 
@@ -750,6 +811,9 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 
 	bootcount_inc();
 
+	if (CONFIG_IS_ENABLED(ENABLE_CACHES))
+		spl_enable_caches();
+
 	/* Dump driver model states to aid analysis */
 	if (CONFIG_IS_ENABLED(DM_STATS)) {
 		struct dm_stats mem;
@@ -828,6 +892,25 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 			printf(PHASE_PROMPT
 			       "SPL hand-off write failed (err=%d)\n", ret);
 	}
+	if (CONFIG_IS_ENABLED(DM_HANDOFF)) {
+		ret = dm_handoff_write();
+		if (ret)
+			debug(PHASE_PROMPT "DM hand-off write failed (err=%d)\n",
+			      ret);
+	}
+	if (CONFIG_IS_ENABLED(OF_LIVE_HANDOFF) && os == IH_OS_U_BOOT &&
+	    spl_image_fdt_addr(&spl_image)) {
+		ret = of_live_handoff_write(spl_image_fdt_addr(&spl_image));
+		if (ret)
+			debug(PHASE_PROMPT "Live tree hand-off failed (err=%d)\n",
+			      ret);
+	}
+	if (CONFIG_IS_ENABLED(MALLOC_PROFILE)) {
+		ret = malloc_profile_stash();
+		if (ret)
+			debug(PHASE_PROMPT "Malloc profile stash failed (err=%d)\n",
+			      ret);
+	}
 	if (CONFIG_IS_ENABLED(UPL_OUT) && (gd->flags & GD_FLG_UPL)) {
 		ret = spl_write_upl_handoff(&spl_image);
 		if (ret) {
@@ -844,6 +927,8 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 	}
 
 	spl_board_prepare_for_boot();
+	if (CONFIG_IS_ENABLED(ENABLE_CACHES))
+		spl_disable_caches();
 
 	if (CONFIG_IS_ENABLED(RELOC_LOADER)) {
 		int ret;
@@ -6,7 +6,6 @@
 
 #include <errno.h>
 #include <fpga.h>
-#include <gzip.h>
 #include <image.h>
 #include <log.h>
 #include <memalign.h>
@@ -18,6 +17,7 @@
 #include <asm/io.h>
 #include <linux/libfdt.h>
 #include <linux/printk.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -203,6 +203,75 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
  * (for CONFIG_BOOTMETH_VBE_SIMPLE_FW), or another negative error number on
  * other error.
  */
+#if CONFIG_IS_ENABLED(FIT_HASH_ON_LOAD)
+/*
+ * Read an image a chunk at a time and hash each chunk straight away, so that
+ * the data does not have to be brought back into the cache to be checked
+ */
+static int spl_fit_read_hashed(struct spl_load_info *info, ulong offset,
+			       ulong size, void *buf, ulong overhead,
+			       ulong length, struct fit_load_hash *lh)
+{
+	ulong chunk = roundup(CONFIG_SPL_FIT_HASH_CHUNK, spl_get_bl_len(info));
+	ulong end = overhead + length;
+	ulong pos, len, got, from, to;
+	int ret = 0;
+
+	for (pos = 0; pos < end; pos += got) {
+		len = min(chunk, size - pos);
+		got = info->read(info, offset + pos, len, buf + pos);
+		from = max(pos, overhead);
+		to = min(pos + got, end);
+		if (from < to && fit_image_hash_update(lh, buf + from, to - from))
+			ret = -EIO;
+		if (ret || (got < len && pos + got < end)) {
+			ret = -EIO;
+			break;
+		}
+	}
+	if (fit_image_hash_finish(lh))
+		ret = -EIO;
+
+	return ret;
+}
+#else
+static int spl_fit_read_hashed(struct spl_load_info *info, ulong offset,
+			       ulong size, void *buf, ulong overhead,
+			       ulong length, struct fit_load_hash *lh)
+{
+	return -ENOSYS;
+}
+#endif
+
+/*
+ * Space left above the output when decompressing in place. The output may
+ * run up to one block (128KB for zstd) ahead of the input that has been read
+ * so far, plus a few bytes for each block of data which does not compress.
+ */
+#define SPL_FIT_DECOMP_MARGIN	(SZ_128K + (CONFIG_SYS_BOOTM_LEN >> 8))
+
+/**
+ * spl_fit_comp_supported() - Check whether SPL can decompress an image
+ *
+ * @comp: Compression type (IH_COMP_...)
+ * Return: true if @comp is a compression type enabled for SPL
+ */
+static bool spl_fit_comp_supported(u8 comp)
+{
+	switch (comp) {
+	case IH_COMP_GZIP:
+		return IS_ENABLED(CONFIG_SPL_GZIP);
+	case IH_COMP_LZMA:
+		return IS_ENABLED(CONFIG_SPL_LZMA);
+	case IH_COMP_LZ4:
+		return IS_ENABLED(CONFIG_SPL_LZ4);
+	case IH_COMP_ZSTD:
+		return IS_ENABLED(CONFIG_SPL_ZSTD);
+	default:
+		return false;
+	}
+}
+
 static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 			   const struct spl_fit_info *ctx, int node,
 			   struct spl_image_info *image_info)
@@ -219,6 +288,8 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 	const void *data;
 	const void *fit = ctx->fit;
 	bool external_data = false;
+	bool mapped = false;
+	struct fit_load_hash lh = {};
 
 	log_debug("starting\n");
 	if (CONFIG_IS_ENABLED(BOOTMETH_VBE) &&
@@ -285,22 +356,49 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 			return 0;
 		}
 
-		if (spl_decompression_enabled() &&
-		    (image_comp == IH_COMP_GZIP || image_comp == IH_COMP_LZMA))
-			src_ptr = map_sysmem(ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN), len);
-		else
-			src_ptr = map_sysmem(ALIGN(load_addr, ARCH_DMA_MINALIGN), len);
 		length = len;
 
+		/* On memory-mapped media, use the data where it is */
+		src = spl_load_map(info, fit_offset + offset, length);
+		if (src) {
+			debug("External data: mapped at %p, size=%lx\n", src,
+			      (unsigned long)length);
+			mapped = true;
+			goto got_data;
+		}
+
 		overhead = get_aligned_image_overhead(info, offset);
 		size = get_aligned_image_size(info, length, offset);
+
+		/*
+		 * When decompressing in place, put the compressed data at the
+		 * top of the area it decompresses into
+		 */
+		if (!spl_fit_comp_supported(image_comp))
+			src_ptr = map_sysmem(ALIGN(load_addr, ARCH_DMA_MINALIGN), len);
+		else if (CONFIG_IS_ENABLED(FIT_DECOMP_IN_PLACE))
+			src_ptr = map_sysmem(ALIGN_DOWN(load_addr +
+							CONFIG_SYS_BOOTM_LEN -
+							size,
+							ARCH_DMA_MINALIGN),
+					     size);
+		else
+			src_ptr = map_sysmem(ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN), len);
 		read_offset = fit_offset + get_aligned_image_offset(info,
 							    offset);
 		log_debug("reading from offset %x / %lx size %lx to %p: ",
 			  offset, read_offset, size, src_ptr);
-
-		if (info->read(info, read_offset, size, src_ptr) < length)
+		if (overhead)
+			log_debug("data not block-aligned (see mkimage -B), ");
+
+		if (CONFIG_IS_ENABLED(FIT_HASH_ON_LOAD) &&
+		    !fit_image_hash_start(fit, node, &lh)) {
+			if (spl_fit_read_hashed(info, read_offset, size, src_ptr,
+						overhead, length, &lh))
+				return -EIO;
+		} else if (info->read(info, read_offset, size, src_ptr) < length) {
 			return -EIO;
+		}
 
 		debug("External data: dst=%p, offset=%x, size=%lx\n",
 		      src_ptr, offset, (unsigned long)length);
@@ -316,11 +414,12 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		src = (void *)data;	/* cast away const */
 	}
 
+got_data:
 	if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
 		printf("## Checking hash(es) for Image %s ... ",
 		       fit_get_name(fit, node, NULL));
-		if (!fit_image_verify_with_data(fit, node, gd_fdt_blob(), src,
-						length))
+		if (!fit_image_verify_loaded(fit, node, gd_fdt_blob(), src,
+					     length, &lh))
 			return -EPERM;
 		puts("OK\n");
 	}
@@ -329,25 +428,26 @@ static int load_simple_fit(struct spl_load_info *info, ulong fit_offset,
 		board_fit_image_post_process(fit, node, &src, &length);
 
 	load_ptr = map_sysmem(load_addr, length);
-	if (IS_ENABLED(CONFIG_SPL_GZIP) && image_comp == IH_COMP_GZIP) {
-		size = length;
-		if (gunzip(load_ptr, CONFIG_SYS_BOOTM_LEN, src, &size)) {
-			puts("Uncompressing error\n");
-			return -EIO;
-		}
-		length = size;
-	} else if (IS_ENABLED(CONFIG_SPL_LZMA) && image_comp == IH_COMP_LZMA) {
-		size = CONFIG_SYS_BOOTM_LEN;
-		ulong loadEnd;
+	if (spl_fit_comp_supported(image_comp)) {
+		ulong load_end;
 
-		if (image_decomp(IH_COMP_LZMA, CONFIG_SYS_LOAD_ADDR, 0, 0,
-				 load_ptr, src, length, size, &loadEnd)) {
+		/* Stop the output from catching up with in-place input */
+		size = CONFIG_SYS_BOOTM_LEN;
+		if (CONFIG_IS_ENABLED(FIT_DECOMP_IN_PLACE) && external_data &&
+		    !mapped)
+			size -= SPL_FIT_DECOMP_MARGIN;
+		if (image_decomp(image_comp, load_addr, 0, type, load_ptr, src,
+				 length, size, &load_end)) {
 			puts("Uncompressing error\n");
 			return -EIO;
 		}
-		length = loadEnd - CONFIG_SYS_LOAD_ADDR;
-	} else {
-		memcpy(load_ptr, src, length);
+		length = load_end - load_addr;
+	} else if (src != load_ptr) {
+		/*
+		 * External data that is not aligned to the block size is read
+		 * a little below where it belongs, so the areas may overlap
+		 */
+		image_copy(load_ptr, src, length);
 	}
 
 	if (image_info) {
@@ -701,6 +801,12 @@ static int spl_simple_fit_read(struct spl_fit_info *ctx,
 	 * For FIT with external data, data is not loaded in this step.
 	 */
 	size = get_aligned_image_size(info, size, 0);
+	buf = spl_load_map(info, offset, size);
+	if (buf) {
+		ctx->fit = buf;
+		debug("fit mapped at %p, size=%lu\n", buf, size);
+		return 0;
+	}
 	buf = board_spl_fit_buffer_addr(size, size, 1);
 
 	count = info->read(info, offset, size, buf);
@@ -737,6 +843,76 @@ static int spl_simple_fit_parse(struct spl_fit_info *ctx)
 	return 0;
 }
 
+/**
+ * spl_fit_image_pos() - get the position of an image's data in the FIT
+ *
+ * @ctx:	FIT context
+ * @node:	Image node
+ * Return: offset of the external data from the start of the FIT, or 0 if
+ *	the data is embedded in the FIT
+ */
+static ulong spl_fit_image_pos(const struct spl_fit_info *ctx, int node)
+{
+	int offset;
+
+	if (!fit_image_get_data_position(ctx->fit, node, &offset))
+		return offset;
+	if (!fit_image_get_data_offset(ctx->fit, node, &offset))
+		return offset + ctx->ext_data_offset;
+
+	return 0;
+}
+
+/**
+ * spl_fit_next_loadable() - find the next loadable to load
+ *
+ * Loadables are normally loaded in the order they are listed. With
+ * CONFIG_SPL_FIT_SORT_LOADABLES they are loaded in the order their data
+ * appears in the FIT instead, so that storage is read in a single forward
+ * sweep. Loadables with the same position keep their listed order.
+ *
+ * @ctx:	FIT context
+ * @start:	Index of the first loadable to consider
+ * @prev:	Index of the loadable loaded last, or -1 to get the first one
+ * Return: index of the next loadable, or -ENOENT if there are no more
+ */
+static int spl_fit_next_loadable(const struct spl_fit_info *ctx, int start,
+				 int prev)
+{
+	ulong pos, prev_pos = 0, best_pos = 0;
+	int best = -ENOENT;
+	int index, node;
+
+	if (!CONFIG_IS_ENABLED(FIT_SORT_LOADABLES)) {
+		index = prev < 0 ? start : prev + 1;
+		node = spl_fit_get_image_node(ctx, "loadables", index);
+
+		return node < 0 ? -ENOENT : index;
+	}
+
+	if (prev >= 0) {
+		node = spl_fit_get_image_node(ctx, "loadables", prev);
+		prev_pos = spl_fit_image_pos(ctx, node);
+	}
+
+	for (index = start; ; index++) {
+		node = spl_fit_get_image_node(ctx, "loadables", index);
+		if (node < 0)
+			break;
+
+		pos = spl_fit_image_pos(ctx, node);
+		if (prev >= 0 &&
+		    (pos < prev_pos || (pos == prev_pos && index <= prev)))
+			continue;
+		if (best < 0 || pos < best_pos) {
+			best = index;
+			best_pos = pos;
+		}
+	}
+
+	return best;
+}
+
 int spl_load_simple_fit(struct spl_image_info *spl_image,
 			struct spl_load_info *info, ulong offset, void *fit)
 {
@@ -746,6 +922,8 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	int ret;
 	int index = 0;
 	int firmware_node;
+	int entry_index = -1;
+	int start;
 
 	ret = spl_simple_fit_read(&ctx, info, offset, fit);
 	if (ret < 0)
@@ -817,12 +995,12 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 
 	firmware_node = node;
 	/* Now check if there are more images for us to load */
-	for (; ; index++) {
+	start = index;
+	for (index = spl_fit_next_loadable(&ctx, start, -1); index >= 0;
+	     index = spl_fit_next_loadable(&ctx, start, index)) {
 		uint8_t os_type = IH_OS_INVALID;
 
 		node = spl_fit_get_image_node(&ctx, "loadables", index);
-		if (node < 0)
-			break;
 
 		/*
 		 * if the firmware is also a loadable, skip it because
@@ -853,11 +1031,15 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 
 		/*
 		 * If the "firmware" image did not provide an entry point,
-		 * use the first valid entry point from the loadables.
+		 * use the first valid entry point from the loadables, in the
+		 * order they are listed.
 		 */
-		if (spl_image->entry_point == FDT_ERROR &&
-		    image_info.entry_point != FDT_ERROR)
+		if (image_info.entry_point != FDT_ERROR &&
+		    (spl_image->entry_point == FDT_ERROR ||
+		     (entry_index >= 0 && index < entry_index))) {
 			spl_image->entry_point = image_info.entry_point;
+			entry_index = index;
+		}
 
 		/* Record our loadables into the FDT */
 		if (!CONFIG_IS_ENABLED(FIT_IMAGE_TINY) &&
@@ -886,7 +1068,7 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 int spl_load_fit_image(struct spl_image_info *spl_image,
 		       const struct legacy_img_hdr *header)
 {
-	struct bootm_headers images;
+	struct bootm_headers images = {};
 	const char *fit_uname_config = NULL;
 	ulong fdt_hack;
 	const char *uname;
@@ -145,6 +145,37 @@ static int mmc_load_image_raw_partition(struct spl_image_info *spl_image,
 }
 #endif
 
+#if CONFIG_IS_ENABLED(FALCON_FDT_CACHE)
+/*
+ * Fix up the 'args' devicetree now and write it back, so that later boots
+ * find it already prepared and skip the fixups. It is only written when
+ * the fixups were actually redone, e.g. after a new 'spl export' or when
+ * the DRAM layout changed.
+ */
+static void mmc_falcon_fdt_cache(struct mmc *mmc)
+{
+	void *fdt = (void *)CONFIG_SPL_PAYLOAD_ARGS_ADDR;
+	struct blk_desc *desc = mmc_get_blk_desc(mmc);
+	unsigned long count;
+
+	if (spl_fdt_prepared(fdt))
+		return;
+
+	spl_fixup_fdt(fdt);
+	if (!spl_fdt_prepared(fdt))
+		return;
+
+	count = DIV_ROUND_UP(fdt_totalsize(fdt), desc->blksz);
+	if (count > CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTORS) {
+		debug("Prepared FDT too large for the args sectors\n");
+		return;
+	}
+	if (blk_dwrite(desc, CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR, count,
+		       fdt) != count)
+		puts("mmc_load_image_raw_os: cannot save prepared FDT\n");
+}
+#endif
+
 #if CONFIG_IS_ENABLED(FALCON_BOOT_MMCSD)
 static int mmc_load_image_raw_os(struct spl_image_info *spl_image,
 				 struct spl_boot_device *bootdev,
@@ -163,6 +194,9 @@ static int mmc_load_image_raw_os(struct spl_image_info *spl_image,
 		puts("mmc_load_image_raw_os: mmc block read error\n");
 		return -EIO;
 	}
+#if CONFIG_IS_ENABLED(FALCON_FDT_CACHE)
+	mmc_falcon_fdt_cache(mmc);
+#endif
 #endif	/* CONFIG_SYS_MMCSD_RAW_MODE_ARGS_SECTOR */
 
 	ret = mmc_load_image_raw_sector(spl_image, bootdev, mmc,
@@ -20,6 +20,12 @@ static ulong spl_nor_load_read(struct spl_load_info *load, ulong sector,
 	return count;
 }
 
+static void *spl_nor_load_map(struct spl_load_info *load, ulong offset,
+			      ulong count)
+{
+	return map_sysmem(offset, count);
+}
+
 unsigned long __weak spl_nor_get_uboot_base(void)
 {
 	return CFG_SYS_UBOOT_BASE;
@@ -50,6 +56,7 @@ static int spl_nor_load_image(struct spl_image_info *spl_image,
 
 			debug("Found FIT\n");
 			spl_load_init(&load, spl_nor_load_read, NULL, 1);
+			spl_set_map(&load, spl_nor_load_map);
 
 			ret = spl_load_simple_fit(spl_image, &load,
 						  CONFIG_SYS_OS_BASE,
@@ -93,6 +100,7 @@ static int spl_nor_load_image(struct spl_image_info *spl_image,
 	 * defined location in SDRAM
 	 */
 	spl_load_init(&load, spl_nor_load_read, NULL, 1);
+	spl_set_map(&load, spl_nor_load_map);
 	return spl_load(spl_image, bootdev, &load, 0, spl_nor_get_uboot_base());
 }
 SPL_LOAD_IMAGE_METHOD("NOR", 0, BOOT_DEVICE_NOR, spl_nor_load_image);
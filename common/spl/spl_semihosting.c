@@ -9,17 +9,36 @@
 #include <spl.h>
 #include <spl_load.h>
 
+/**
+ * struct smh_file - An open file and the position within it
+ *
+ * @fd: File descriptor returned by smh_open()
+ * @pos: Current position in the file
+ */
+struct smh_file {
+	long fd;
+	ulong pos;
+};
+
 static ulong smh_fit_read(struct spl_load_info *load, ulong file_offset,
 			  ulong size, void *buf)
 {
-	long fd = *(long *)load->priv;
-	ulong ret;
+	struct smh_file *file = load->priv;
+	long ret;
 
-	if (smh_seek(fd, file_offset))
+	/* Reads are often sequential, so only seek if needed */
+	if (file_offset != file->pos) {
+		if (smh_seek(file->fd, file_offset))
+			return 0;
+		file->pos = file_offset;
+	}
+
+	ret = smh_read(file->fd, buf, size);
+	if (ret < 0)
 		return 0;
+	file->pos += ret;
 
-	ret = smh_read(fd, buf, size);
-	return ret < 0 ? 0 : ret;
+	return ret;
 }
 
 static int spl_smh_load_image(struct spl_image_info *spl_image,
@@ -29,6 +48,7 @@ static int spl_smh_load_image(struct spl_image_info *spl_image,
 	int ret;
 	long fd, len;
 	struct spl_load_info load;
+	struct smh_file file;
 
 	fd = smh_open(filename, MODE_READ | MODE_BINARY);
 	if (fd < 0) {
@@ -43,7 +63,9 @@ static int spl_smh_load_image(struct spl_image_info *spl_image,
 	}
 	len = ret;
 
-	spl_load_init(&load, smh_fit_read, &fd, 1);
+	file.fd = fd;
+	file.pos = 0;
+	spl_load_init(&load, smh_fit_read, &file, 1);
 	ret = spl_load(spl_image, bootdev, &load, len, 0);
 	if (ret)
 		log_debug("could not read %s: %d\n", filename, ret);
@@ -7,8 +7,23 @@
 #include <config.h>
 #include <image.h>
 #include <log.h>
+#include <mapmem.h>
 #include <spl.h>
 
+static ulong spl_xip_load_read(struct spl_load_info *load, ulong sector,
+			       ulong count, void *buf)
+{
+	memcpy(buf, map_sysmem(sector, count), count);
+
+	return count;
+}
+
+static void *spl_xip_load_map(struct spl_load_info *load, ulong offset,
+			      ulong count)
+{
+	return map_sysmem(offset, count);
+}
+
 static int spl_xip(struct spl_image_info *spl_image,
 		   struct spl_boot_device *bootdev)
 {
@@ -24,6 +39,20 @@ static int spl_xip(struct spl_image_info *spl_image,
 		return 0;
 	}
 #endif
+	if (CONFIG_IS_ENABLED(LOAD_MAPPED)) {
+		void *header = map_sysmem(CFG_SYS_UBOOT_BASE, 0);
+
+		/* Use a FIT in place, along with any images linked to run there */
+		if (image_get_magic(header) == FDT_MAGIC) {
+			struct spl_load_info load;
+
+			spl_load_init(&load, spl_xip_load_read, NULL, 1);
+			spl_set_map(&load, spl_xip_load_map);
+
+			return spl_load_simple_fit(spl_image, &load,
+						   CFG_SYS_UBOOT_BASE, header);
+		}
+	}
 	return(spl_parse_image_header(spl_image, bootdev,
 	       (const struct legacy_img_hdr *)CFG_SYS_UBOOT_BASE));
 }
@@ -372,25 +372,32 @@ static int usb_kbd_irq(struct usb_device *dev)
 /* Interrupt polling */
 static inline void usb_kbd_poll_for_event(struct usb_device *dev)
 {
-#if defined(CONFIG_SYS_USB_EVENT_POLL)
 	struct usb_kbd_pdata *data = dev->privptr;
-
-	/* Submit an interrupt transfer request */
-	if (usb_int_msg(dev, data->intpipe, &data->new[0],
-			data->intpktsize, data->intinterval, true) >= 0)
-		usb_kbd_irq_worker(dev);
-#elif defined(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP) || \
-      defined(CONFIG_SYS_USB_EVENT_POLL_VIA_INT_QUEUE)
 #if defined(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP)
 	struct usb_interface *iface;
-	struct usb_kbd_pdata *data = dev->privptr;
+#endif
+
+	/*
+	 * Submit an interrupt transfer request. This is also used if the
+	 * controller cannot queue interrupt transfers.
+	 */
+	if (!IS_ENABLED(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP) &&
+	    !data->intq) {
+		if (usb_int_msg(dev, data->intpipe, &data->new[0],
+				data->intpktsize, data->intinterval, true) >= 0)
+			usb_kbd_irq_worker(dev);
+		return;
+	}
+
+#if defined(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP) || \
+    defined(CONFIG_SYS_USB_EVENT_POLL_VIA_INT_QUEUE)
+#if defined(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP)
 	iface = &dev->config.if_desc[data->ifnum];
 	usb_get_report(dev, iface->desc.bInterfaceNumber,
 		       1, 0, data->new, USB_KBD_BOOT_REPORT_SIZE);
 	if (memcmp(data->old, data->new, USB_KBD_BOOT_REPORT_SIZE)) {
 		usb_kbd_irq_worker(dev);
 #else
-	struct usb_kbd_pdata *data = dev->privptr;
 	if (poll_int_queue(dev, data->intq)) {
 		usb_kbd_irq_worker(dev);
 		/* We've consumed all queued int packets, create new */
@@ -445,6 +452,10 @@ static int usb_kbd_testc(struct stdio_dev *sdev)
 	usb_kbd_dev = (struct usb_device *)dev->priv;
 	data = usb_kbd_dev->privptr;
 
+	/* Checking an interrupt queue does not wait for the keyboard */
+	if (data->intq)
+		poll_delay = 0;
+
 	if (get_timer(kbd_testc_tms) >= poll_delay) {
 		usb_kbd_poll_for_event(usb_kbd_dev);
 		kbd_testc_tms = get_timer(0);
@@ -556,15 +567,25 @@ static int usb_kbd_probe_dev(struct usb_device *dev, unsigned int ifnum)
 	debug("USB KBD: set boot protocol\n");
 	usb_set_protocol(dev, iface->desc.bInterfaceNumber, 0);
 
-#if !defined(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP) && \
-    !defined(CONFIG_SYS_USB_EVENT_POLL_VIA_INT_QUEUE)
-	debug("USB KBD: set idle interval...\n");
-	usb_set_idle(dev, iface->desc.bInterfaceNumber, REPEAT_RATE / 4, 0);
-#else
-	debug("USB KBD: set idle interval=0...\n");
-	usb_set_idle(dev, iface->desc.bInterfaceNumber, 0, 0);
+#ifdef CONFIG_SYS_USB_EVENT_POLL_VIA_INT_QUEUE
+	/* Not all controllers support this, so fall back to polling */
+	data->intq = create_int_queue(dev, data->intpipe, 1,
+				      USB_KBD_BOOT_REPORT_SIZE, data->new,
+				      data->intinterval);
+	if (!data->intq)
+		debug("USB KBD: no interrupt queue, polling instead\n");
 #endif
 
+	if (IS_ENABLED(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP) ||
+	    data->intq) {
+		debug("USB KBD: set idle interval=0...\n");
+		usb_set_idle(dev, iface->desc.bInterfaceNumber, 0, 0);
+	} else {
+		debug("USB KBD: set idle interval...\n");
+		usb_set_idle(dev, iface->desc.bInterfaceNumber,
+			     REPEAT_RATE / 4, 0);
+	}
+
 	/*
 	 * Apple and Keychron keyboards do not report the device state. Reports
 	 * are only returned during key presses.
@@ -574,16 +595,12 @@ static int usb_kbd_probe_dev(struct usb_device *dev, unsigned int ifnum)
 		return 1;
 	}
 	debug("USB KBD: enable interrupt pipe...\n");
-#ifdef CONFIG_SYS_USB_EVENT_POLL_VIA_INT_QUEUE
-	data->intq = create_int_queue(dev, data->intpipe, 1,
-				      USB_KBD_BOOT_REPORT_SIZE, data->new,
-				      data->intinterval);
-	if (!data->intq) {
-#elif defined(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP)
+#if defined(CONFIG_SYS_USB_EVENT_POLL_VIA_CONTROL_EP)
 	if (usb_get_report(dev, iface->desc.bInterfaceNumber,
 			   1, 0, data->new, USB_KBD_BOOT_REPORT_SIZE) < 0) {
 #else
-	if (usb_int_msg(dev, data->intpipe, data->new, data->intpktsize,
+	if (!data->intq &&
+	    usb_int_msg(dev, data->intpipe, data->new, data->intpktsize,
 			data->intinterval, false) < 0) {
 #endif
 		printf("Failed to get keyboard state from device %04x:%04x\n",
@@ -679,7 +696,8 @@ static int usb_kbd_remove(struct udevice *dev)
 		goto err;
 	}
 #ifdef CONFIG_SYS_USB_EVENT_POLL_VIA_INT_QUEUE
-	destroy_int_queue(udev, data->intq);
+	if (data->intq)
+		destroy_int_queue(udev, data->intq);
 #endif
 	free(data->new);
 	free(data);
@@ -228,6 +228,7 @@ static int usb_stor_probe_device(struct usb_device *udev)
 		blkdev = dev_get_uclass_plat(dev);
 		blkdev->target = 0xff;
 		blkdev->lun = lun;
+		blkdev->max_blocks = data->max_xfer_blk;
 
 		ret = usb_stor_get_info(udev, data, blkdev);
 		if (ret == 1) {
@@ -971,8 +972,12 @@ static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 	 * Windows 7 limiting transfers to 128 sectors for both USB2 and USB3
 	 * and Apple Mac OS X 10.11 limiting transfers to 256 sectors for USB2
 	 * and 2048 for USB3 devices.
+	 *
+	 * SuperSpeed devices are recent enough not to have this problem, and
+	 * Linux also allows 2048 sectors for them. Each transfer costs a
+	 * CBW/CSW round-trip, so use the larger limit there.
 	 */
-	unsigned short blk = 240;
+	unsigned short blk = udev->speed >= USB_SPEED_SUPER ? 2048 : 240;
 
 #if CONFIG_IS_ENABLED(DM_USB)
 	size_t size;
@@ -63,6 +63,10 @@ ifdef FTRACE
 PLATFORM_CPPFLAGS += -finstrument-functions -DFTRACE
 endif
 
+ifdef CONFIG_SPROF_BACKTRACE
+PLATFORM_CPPFLAGS += -fno-omit-frame-pointer
+endif
+
 #########################################################################
 
 RELFLAGS := $(PLATFORM_RELFLAGS)
@@ -284,6 +284,8 @@ void part_init(struct blk_desc *desc)
 	struct part_driver *entry;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	blk_readahead_invalidate(desc);
+	gpt_cache_invalidate(desc);
 
 	if (desc->part_type != PART_TYPE_UNKNOWN) {
 		for (entry = drv; entry != drv + n_ents; entry++) {
@@ -680,6 +682,9 @@ int part_get_info_by_name(struct blk_desc *desc, const char *name,
 		return -ENOSYS;
 	}
 
+	if (part_drv->get_info_by_name)
+		return part_drv->get_info_by_name(desc, name, info);
+
 	for (i = 1; i < part_drv->max_entries; i++) {
 		ret = part_drv->get_info(desc, i, info);
 		if (ret != 0) {
@@ -194,25 +194,155 @@ static void prepare_backup_gpt_header(gpt_header *gpt_h)
  * Public Functions (include/part.h)
  */
 
-/*
- * UUID is displayed as 32 hexadecimal digits, in 5 groups,
- * separated by hyphens, in the form 8-4-4-4-12 for a total of 36 characters
+/**
+ * struct gpt_cache - A validated GPT kept in memory
+ *
+ * Reading and validating the GPT means reading the header and the whole
+ * partition-entry array and checking their CRCs. Callers such as
+ * part_get_info_by_name() end up doing that once per partition, so keep the
+ * last few tables around, keyed on the device and its write count.
+ *
+ * @desc: Block device, or NULL if this entry is unused
+ * @write_count: Value of @desc->write_count when the GPT was read
+ * @lba: Size of @desc when the GPT was read
+ * @head: GPT header
+ * @pte: Partition-table entries, as returned by find_valid_gpt()
+ * @num_names: Number of entries in @by_name, -1 if the index is not built
+ * @by_name: Indices into @pte of the valid entries, sorted by name and then
+ *	by index
+ * @names: Printable name of each entry in @pte
  */
-int get_disk_guid(struct blk_desc *desc, char *guid)
+struct gpt_cache {
+	struct blk_desc *desc;
+	uint write_count;
+	lbaint_t lba;
+	gpt_header head;
+	gpt_entry *pte;
+	int num_names;
+	int *by_name;
+	char (*names)[PART_NAME_LEN];
+};
+
+#define GPT_CACHE_SIZE	4
+
+static struct gpt_cache gpt_cache[GPT_CACHE_SIZE];
+static int gpt_cache_next;
+
+static void gpt_cache_drop(struct gpt_cache *gc)
+{
+	free(gc->pte);
+	free(gc->by_name);
+	free(gc->names);
+	memset(gc, '\0', sizeof(*gc));
+}
+
+void gpt_cache_invalidate(struct blk_desc *desc)
+{
+	int i;
+
+	for (i = 0; i < GPT_CACHE_SIZE; i++) {
+		if (gpt_cache[i].desc == desc)
+			gpt_cache_drop(&gpt_cache[i]);
+	}
+}
+
+/**
+ * gpt_cache_get() - Get the validated GPT for a device
+ *
+ * The returned entry stays owned by the cache and must not be freed.
+ *
+ * @desc: Block device
+ * Return: cache entry, or NULL if the device has no valid GPT
+ */
+static struct gpt_cache *gpt_cache_get(struct blk_desc *desc)
 {
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, desc->blksz);
+	struct gpt_cache *gc;
 	gpt_entry *gpt_pte = NULL;
-	unsigned char *guid_bin;
+	int i;
+
+	for (i = 0; i < GPT_CACHE_SIZE; i++) {
+		gc = &gpt_cache[i];
+		if (gc->desc != desc)
+			continue;
+		if (gc->write_count == desc->write_count &&
+		    gc->lba == desc->lba)
+			return gc;
+		gpt_cache_drop(gc);
+	}
 
 	/* This function validates AND fills in the GPT header and PTE */
 	if (find_valid_gpt(desc, gpt_head, &gpt_pte) != 1)
+		return NULL;
+
+	gc = &gpt_cache[gpt_cache_next];
+	gpt_cache_next = (gpt_cache_next + 1) % GPT_CACHE_SIZE;
+	gpt_cache_drop(gc);
+	gc->desc = desc;
+	gc->write_count = desc->write_count;
+	gc->lba = desc->lba;
+	memcpy(&gc->head, gpt_head, sizeof(gc->head));
+	gc->pte = gpt_pte;
+	gc->num_names = -1;
+
+	return gc;
+}
+
+/**
+ * gpt_cache_index() - Build the sorted name index for a cached GPT
+ *
+ * @gc: Cache entry
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+static int gpt_cache_index(struct gpt_cache *gc)
+{
+	int count = le32_to_cpu(gc->head.num_partition_entries);
+	int i, j, n;
+
+	gc->names = calloc(count, sizeof(*gc->names));
+	gc->by_name = calloc(count, sizeof(*gc->by_name));
+	if (!gc->names || !gc->by_name) {
+		free(gc->names);
+		free(gc->by_name);
+		gc->names = NULL;
+		gc->by_name = NULL;
+		return -ENOMEM;
+	}
+
+	/* Insertion sort, keeping equal names in index order */
+	for (i = 0, n = 0; i < count; i++) {
+		if (!is_pte_valid(&gc->pte[i]))
+			continue;
+		snprintf(gc->names[i], PART_NAME_LEN, "%s",
+			 print_efiname(&gc->pte[i]));
+		for (j = n; j > 0; j--) {
+			if (strcmp(gc->names[gc->by_name[j - 1]],
+				   gc->names[i]) <= 0)
+				break;
+			gc->by_name[j] = gc->by_name[j - 1];
+		}
+		gc->by_name[j] = i;
+		n++;
+	}
+	gc->num_names = n;
+
+	return 0;
+}
+
+/*
+ * UUID is displayed as 32 hexadecimal digits, in 5 groups,
+ * separated by hyphens, in the form 8-4-4-4-12 for a total of 36 characters
+ */
+int get_disk_guid(struct blk_desc *desc, char *guid)
+{
+	struct gpt_cache *gc;
+
+	gc = gpt_cache_get(desc);
+	if (!gc)
 		return -EINVAL;
 
-	guid_bin = gpt_head->disk_guid.b;
-	uuid_bin_to_str(guid_bin, guid, UUID_STR_FORMAT_GUID);
+	uuid_bin_to_str(gc->head.disk_guid.b, guid, UUID_STR_FORMAT_GUID);
 
-	/* Remember to free pte */
-	free(gpt_pte);
 	return 0;
 }
 
@@ -258,60 +388,96 @@ static void __maybe_unused part_print_efi(struct blk_desc *desc)
 	return;
 }
 
-static int __maybe_unused part_get_info_efi(struct blk_desc *desc, int part,
-					    struct disk_partition *info)
+static void gpt_fill_info(struct blk_desc *desc, gpt_entry *pte,
+			  struct disk_partition *info)
 {
-	ALLOC_CACHE_ALIGN_BUFFER_PAD(gpt_header, gpt_head, 1, desc->blksz);
-	gpt_entry *gpt_pte = NULL;
-
-	/* "part" argument must be at least 1 */
-	if (part < 1) {
-		log_debug("Invalid Argument(s)\n");
-		return -EINVAL;
-	}
-
-	/* This function validates AND fills in the GPT header and PTE */
-	if (find_valid_gpt(desc, gpt_head, &gpt_pte) != 1)
-		return -EINVAL;
-
-	if (part > le32_to_cpu(gpt_head->num_partition_entries) ||
-	    !is_pte_valid(&gpt_pte[part - 1])) {
-		log_debug("Invalid partition number %d\n", part);
-		free(gpt_pte);
-		return -EPERM;
-	}
-
 	/* The 'lbaint_t' casting may limit the maximum disk size to 2 TB */
-	info->start = (lbaint_t)le64_to_cpu(gpt_pte[part - 1].starting_lba);
+	info->start = (lbaint_t)le64_to_cpu(pte->starting_lba);
 	/* The ending LBA is inclusive, to calculate size, add 1 to it */
-	info->size = (lbaint_t)le64_to_cpu(gpt_pte[part - 1].ending_lba) + 1
+	info->size = (lbaint_t)le64_to_cpu(pte->ending_lba) + 1
 		     - info->start;
 	info->blksz = desc->blksz;
 
 	snprintf((char *)info->name, sizeof(info->name), "%s",
-		 print_efiname(&gpt_pte[part - 1]));
+		 print_efiname(pte));
 	strcpy((char *)info->type, "U-Boot");
-	info->bootable = get_bootable(&gpt_pte[part - 1]);
-	info->type_flags = gpt_pte[part - 1].attributes.fields.type_guid_specific;
+	info->bootable = get_bootable(pte);
+	info->type_flags = pte->attributes.fields.type_guid_specific;
 	if (CONFIG_IS_ENABLED(PARTITION_UUIDS)) {
-		uuid_bin_to_str(gpt_pte[part - 1].unique_partition_guid.b,
+		uuid_bin_to_str(pte->unique_partition_guid.b,
 				(char *)disk_partition_uuid(info),
 				UUID_STR_FORMAT_GUID);
 	}
 	if (IS_ENABLED(CONFIG_PARTITION_TYPE_GUID)) {
-		uuid_bin_to_str(gpt_pte[part - 1].partition_type_guid.b,
+		uuid_bin_to_str(pte->partition_type_guid.b,
 				(char *)disk_partition_type_guid(info),
 				UUID_STR_FORMAT_GUID);
 	}
 
 	log_debug("start 0x" LBAF ", size 0x" LBAF ", name %s\n", info->start,
 		  info->size, info->name);
+}
+
+static int __maybe_unused part_get_info_efi(struct blk_desc *desc, int part,
+					    struct disk_partition *info)
+{
+	struct gpt_cache *gc;
+
+	/* "part" argument must be at least 1 */
+	if (part < 1) {
+		log_debug("Invalid Argument(s)\n");
+		return -EINVAL;
+	}
+
+	gc = gpt_cache_get(desc);
+	if (!gc)
+		return -EINVAL;
+
+	if (part > le32_to_cpu(gc->head.num_partition_entries) ||
+	    !is_pte_valid(&gc->pte[part - 1])) {
+		log_debug("Invalid partition number %d\n", part);
+		return -EPERM;
+	}
+
+	gpt_fill_info(desc, &gc->pte[part - 1], info);
 
-	/* Remember to free pte */
-	free(gpt_pte);
 	return 0;
 }
 
+static int __maybe_unused part_get_info_by_name_efi(struct blk_desc *desc,
+						    const char *name,
+						    struct disk_partition *info)
+{
+	struct gpt_cache *gc;
+	int lo, hi, mid, idx;
+
+	gc = gpt_cache_get(desc);
+	if (!gc)
+		return -EINVAL;
+	if (gc->num_names < 0 && gpt_cache_index(gc))
+		return -ENOMEM;
+
+	/* Find the first entry which is not less than @name */
+	lo = 0;
+	hi = gc->num_names;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strcmp(gc->names[gc->by_name[mid]], name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == gc->num_names)
+		return -ENOENT;
+	idx = gc->by_name[lo];
+	if (strcmp(gc->names[idx], name))
+		return -ENOENT;
+
+	gpt_fill_info(desc, &gc->pte[idx], info);
+
+	return idx + 1;
+}
+
 static int part_test_efi(struct blk_desc *desc)
 {
 	ALLOC_CACHE_ALIGN_BUFFER_PAD(legacy_mbr, legacymbr, 1, desc->blksz);
@@ -1211,6 +1377,7 @@ U_BOOT_PART_TYPE(a_efi) = {
 	.part_type	= PART_TYPE_EFI,
 	.max_entries	= GPT_ENTRY_NUMBERS,
 	.get_info	= part_get_info_ptr(part_get_info_efi),
+	.get_info_by_name = part_get_info_ptr(part_get_info_by_name_efi),
 	.print		= part_print_ptr(part_print_efi),
 	.test		= part_test_efi,
 };
@@ -52,6 +52,16 @@ static int ata_io_flush(struct ahci_uc_priv *uc_priv, u8 port);
 #define WAIT_MS_LINKUP	200
 
 #define AHCI_CAP_S64A BIT(31)
+#define AHCI_CAP_SNCQ BIT(30)
+
+/*
+ * Number of command slots used on each port. Only NCQ reads use more than the
+ * first one. Each slot has its own command table, after the received-FIS area.
+ */
+#define AHCI_NCQ_SLOTS	8
+#define AHCI_PORT_DMA_SZ	(AHCI_CMD_SLOT_SZ * AHCI_NCQ_SLOTS + \
+				 AHCI_RX_FIS_SZ + \
+				 (AHCI_CMD_TBL_SZ) * AHCI_NCQ_SLOTS)
 
 __weak void __iomem *ahci_port_base(void __iomem *base, u32 port)
 {
@@ -83,14 +93,21 @@ static void ahci_dcache_invalidate_range(unsigned long begin, unsigned long len)
 	invalidate_dcache_range(start, end);
 }
 
+/* Get the address of the command table for a slot */
+static ulong ahci_cmd_tbl(struct ahci_ioports *pp, int slot)
+{
+	return pp->cmd_tbl + slot * (AHCI_CMD_TBL_SZ);
+}
+
 /*
  * Ensure data for SATA controller is flushed out of dcache and
  * written to physical memory.
  */
-static void ahci_dcache_flush_sata_cmd(struct ahci_ioports *pp)
+static void ahci_dcache_flush_sata_cmd(struct ahci_ioports *pp, int slot)
 {
 	ahci_dcache_flush_range((unsigned long)pp->cmd_slot,
-				AHCI_PORT_PRIV_DMA_SZ);
+				AHCI_CMD_SLOT_SZ * AHCI_NCQ_SLOTS);
+	ahci_dcache_flush_range(ahci_cmd_tbl(pp, slot), AHCI_CMD_TBL_SZ);
 }
 
 static int waiting_for_cmd_completed(void __iomem *offset,
@@ -384,11 +401,11 @@ static int ahci_init_one(struct ahci_uc_priv *uc_priv, struct udevice *dev)
 
 #define MAX_DATA_BYTE_COUNT  (4*1024*1024)
 
-static int ahci_fill_sg(struct ahci_uc_priv *uc_priv, u8 port,
+static int ahci_fill_sg(struct ahci_uc_priv *uc_priv, u8 port, int slot,
 			unsigned char *buf, int buf_len)
 {
 	struct ahci_ioports *pp = &(uc_priv->port[port]);
-	struct ahci_sg *ahci_sg = pp->cmd_tbl_sg;
+	struct ahci_sg *ahci_sg;
 	phys_addr_t pa = virt_to_phys(buf);
 	u32 sg_count;
 	int i;
@@ -399,6 +416,8 @@ static int ahci_fill_sg(struct ahci_uc_priv *uc_priv, u8 port,
 		return -1;
 	}
 
+	ahci_sg = (struct ahci_sg *)(ahci_cmd_tbl(pp, slot) + AHCI_CMD_TBL_HDR);
+
 	for (i = 0; i < sg_count; i++) {
 		ahci_sg->addr = cpu_to_le32(lower_32_bits(pa));
 		ahci_sg->addr_hi = cpu_to_le32(upper_32_bits(pa));
@@ -418,15 +437,16 @@ static int ahci_fill_sg(struct ahci_uc_priv *uc_priv, u8 port,
 	return sg_count;
 }
 
-static void ahci_fill_cmd_slot(struct ahci_ioports *pp, u32 opts)
+static void ahci_fill_cmd_slot(struct ahci_ioports *pp, int slot, u32 opts)
 {
-	phys_addr_t pa = virt_to_phys((void *)pp->cmd_tbl);
+	struct ahci_cmd_hdr *hdr = &pp->cmd_slot[slot];
+	phys_addr_t pa = virt_to_phys((void *)ahci_cmd_tbl(pp, slot));
 
-	pp->cmd_slot->opts = cpu_to_le32(opts);
-	pp->cmd_slot->status = 0;
-	pp->cmd_slot->tbl_addr = cpu_to_le32(lower_32_bits(pa));
+	hdr->opts = cpu_to_le32(opts);
+	hdr->status = 0;
+	hdr->tbl_addr = cpu_to_le32(lower_32_bits(pa));
 #ifdef CONFIG_PHYS_64BIT
-	pp->cmd_slot->tbl_addr_hi = cpu_to_le32(upper_32_bits(pa));
+	hdr->tbl_addr_hi = cpu_to_le32(upper_32_bits(pa));
 #endif
 }
 
@@ -461,22 +481,22 @@ static int ahci_port_start(struct ahci_uc_priv *uc_priv, u8 port)
 		return -1;
 	}
 
-	mem = memalign(2048, AHCI_PORT_PRIV_DMA_SZ);
+	mem = memalign(2048, AHCI_PORT_DMA_SZ);
 	if (!mem) {
 		free(pp);
 		printf("%s: No mem for table!\n", __func__);
 		return -ENOMEM;
 	}
-	memset(mem, 0, AHCI_PORT_PRIV_DMA_SZ);
+	memset(mem, 0, AHCI_PORT_DMA_SZ);
 
 	/*
-	 * First item in chunk of DMA memory: 32-slot command table,
-	 * 32 bytes each in size
+	 * First item in chunk of DMA memory: command list with
+	 * AHCI_NCQ_SLOTS slots, 32 bytes each in size
 	 */
 	pp->cmd_slot =
 		(struct ahci_cmd_hdr *)(uintptr_t)virt_to_phys((void *)mem);
 	debug("cmd_slot = %p\n", pp->cmd_slot);
-	mem += (AHCI_CMD_SLOT_SZ + 224);
+	mem += AHCI_CMD_SLOT_SZ * AHCI_NCQ_SLOTS;
 
 	/*
 	 * Second item: Received-FIS area
@@ -485,8 +505,8 @@ static int ahci_port_start(struct ahci_uc_priv *uc_priv, u8 port)
 	mem += AHCI_RX_FIS_SZ;
 
 	/*
-	 * Third item: data area for storing a single command
-	 * and its scatter-gather table
+	 * Third item: data area for storing a command and its
+	 * scatter-gather table, for each slot
 	 */
 	pp->cmd_tbl = virt_to_phys((void *)mem);
 	debug("cmd_tbl_dma = %lx\n", pp->cmd_tbl);
@@ -544,11 +564,11 @@ static int ahci_device_data_io(struct ahci_uc_priv *uc_priv, u8 port, u8 *fis,
 
 	memcpy((unsigned char *)pp->cmd_tbl, fis, fis_len);
 
-	sg_count = ahci_fill_sg(uc_priv, port, buf, buf_len);
+	sg_count = ahci_fill_sg(uc_priv, port, 0, buf, buf_len);
 	opts = (fis_len >> 2) | (sg_count << 16) | (is_write << 6);
-	ahci_fill_cmd_slot(pp, opts);
+	ahci_fill_cmd_slot(pp, 0, opts);
 
-	ahci_dcache_flush_sata_cmd(pp);
+	ahci_dcache_flush_sata_cmd(pp, 0);
 	ahci_dcache_flush_range((unsigned long)buf, (unsigned long)buf_len);
 
 	writel_with_flush(1, port_mmio + PORT_CMD_ISSUE);
@@ -567,6 +587,150 @@ static int ahci_device_data_io(struct ahci_uc_priv *uc_priv, u8 port, u8 *fis,
 	return 0;
 }
 
+/* Issue a READ FPDMA QUEUED command on a slot, using the slot as the tag */
+static int ahci_ncq_issue(struct ahci_uc_priv *uc_priv, u8 port, int slot,
+			  lbaint_t lba, u8 *buf, u16 blocks)
+{
+	struct ahci_ioports *pp = &uc_priv->port[port];
+	void __iomem *port_mmio = pp->port_mmio;
+	u8 fis[20];
+	int sg_count;
+
+	memset(fis, 0, sizeof(fis));
+	fis[0] = 0x27;		/* Host to device FIS. */
+	fis[1] = 1 << 7;	/* Command FIS. */
+	fis[2] = ATA_CMD_FPDMA_READ;
+	fis[3] = blocks & 0xff;	/* the count goes in the features fields */
+	fis[4] = (lba >> 0) & 0xff;
+	fis[5] = (lba >> 8) & 0xff;
+	fis[6] = (lba >> 16) & 0xff;
+	fis[7] = 1 << 6;	/* device reg: set LBA mode */
+	fis[8] = (lba >> 24) & 0xff;
+#ifdef CONFIG_SYS_64BIT_LBA
+	fis[9] = (lba >> 32) & 0xff;
+	fis[10] = (lba >> 40) & 0xff;
+#endif
+	fis[11] = blocks >> 8;
+	fis[12] = slot << 3;	/* tag */
+
+	memcpy((void *)ahci_cmd_tbl(pp, slot), fis, sizeof(fis));
+	sg_count = ahci_fill_sg(uc_priv, port, slot, buf,
+				blocks * ATA_SECT_SIZE);
+	if (sg_count < 0)
+		return -EINVAL;
+	ahci_fill_cmd_slot(pp, slot, (sizeof(fis) >> 2) | (sg_count << 16));
+	ahci_dcache_flush_sata_cmd(pp, slot);
+
+	writel(BIT(slot), port_mmio + PORT_SCR_ACT);
+	writel_with_flush(BIT(slot), port_mmio + PORT_CMD_ISSUE);
+
+	return 0;
+}
+
+/*
+ * After an NCQ error the drive aborts all queued commands and rejects new
+ * ones until its NCQ error log has been read. Restart the port, read the log
+ * and stop using NCQ on this port.
+ */
+static void ahci_ncq_recover(struct ahci_uc_priv *uc_priv, u8 port)
+{
+	struct ahci_ioports *pp = &uc_priv->port[port];
+	void __iomem *port_mmio = pp->port_mmio;
+	ALLOC_CACHE_ALIGN_BUFFER(u8, log, ATA_SECT_SIZE);
+	u8 fis[20];
+
+	printf("Port %d: NCQ read failed, using one command at a time\n",
+	       port);
+	pp->ncq_depth = 0;
+
+	/* Stopping the port clears the commands which are still queued */
+	clrbits_le32(port_mmio + PORT_CMD, PORT_CMD_START);
+	if (waiting_for_cmd_completed(port_mmio + PORT_CMD, 500,
+				      PORT_CMD_LIST_ON))
+		debug("%s: port %d did not stop\n", __func__, port);
+	writel(readl(port_mmio + PORT_SCR_ERR), port_mmio + PORT_SCR_ERR);
+	writel(readl(port_mmio + PORT_IRQ_STAT), port_mmio + PORT_IRQ_STAT);
+	setbits_le32(port_mmio + PORT_CMD, PORT_CMD_START);
+
+	memset(fis, 0, sizeof(fis));
+	fis[0] = 0x27;		/* Host to device FIS. */
+	fis[1] = 1 << 7;	/* Command FIS. */
+	fis[2] = ATA_CMD_READ_LOG_EXT;
+	fis[4] = ATA_LOG_SATA_NCQ;
+	fis[12] = 1;		/* one sector */
+	if (ahci_device_data_io(uc_priv, port, fis, sizeof(fis), log,
+				ATA_SECT_SIZE, 0))
+		debug("%s: cannot read NCQ log on port %d\n", __func__, port);
+}
+
+/*
+ * Read using native command queuing, keeping up to ncq_depth commands of
+ * MAX_SATA_BLOCKS_READ_WRITE blocks each in flight. The drive can then work
+ * on the next command while the last one is being transferred, and reorder
+ * them to suit itself.
+ */
+static int ahci_ncq_read(struct ahci_uc_priv *uc_priv, u8 port, lbaint_t lba,
+			 u8 *buf, u16 blocks)
+{
+	struct ahci_ioports *pp = &uc_priv->port[port];
+	void __iomem *port_mmio = pp->port_mmio;
+	ulong len = blocks * ATA_SECT_SIZE;
+	u32 busy = 0, done;
+	u8 *ptr = buf;
+	ulong start;
+	int slot;
+
+	debug("%s: port %d, %u blocks from lba 0x" LBAFU "\n", __func__, port,
+	      blocks, lba);
+	writel(readl(port_mmio + PORT_IRQ_STAT), port_mmio + PORT_IRQ_STAT);
+	ahci_dcache_flush_range((unsigned long)buf, len);
+
+	start = get_timer(0);
+	while (blocks || busy) {
+		for (slot = 0; blocks && slot < pp->ncq_depth; slot++) {
+			u16 now_blocks;
+
+			if (busy & BIT(slot))
+				continue;
+			now_blocks = min((u16)MAX_SATA_BLOCKS_READ_WRITE,
+					 blocks);
+			if (ahci_ncq_issue(uc_priv, port, slot, lba, ptr,
+					   now_blocks))
+				goto err;
+			busy |= BIT(slot);
+			ptr += now_blocks * ATA_SECT_SIZE;
+			blocks -= now_blocks;
+			lba += now_blocks;
+		}
+
+		if (readl(port_mmio + PORT_IRQ_STAT) & (PORT_IRQ_FATAL)) {
+			debug("%s: error %x, tfdata %x\n", __func__,
+			      readl(port_mmio + PORT_IRQ_STAT),
+			      readl(port_mmio + PORT_TFDATA));
+			goto err;
+		}
+
+		/* the drive clears a slot's SActive bit when it is done */
+		done = busy & ~readl(port_mmio + PORT_SCR_ACT);
+		if (done) {
+			busy &= ~done;
+			start = get_timer(0);
+		} else if (get_timer(start) > WAIT_MS_DATAIO) {
+			printf("timeout exit!\n");
+			goto err;
+		}
+	}
+
+	ahci_dcache_invalidate_range((unsigned long)buf, len);
+
+	return 0;
+
+err:
+	ahci_ncq_recover(uc_priv, port);
+
+	return -EIO;
+}
+
 static char *ata_id_strcpy(u16 *target, u16 *src, int len)
 {
 	int i;
@@ -635,6 +799,18 @@ static int ata_scsiop_inquiry(struct ahci_uc_priv *uc_priv,
 	memcpy(idbuf, tmpid, ATA_ID_WORDS * 2);
 	ata_swap_buf_le16(idbuf, ATA_ID_WORDS);
 
+	uc_priv->port[port].ncq_depth = 0;
+	if (IS_ENABLED(CONFIG_AHCI_NCQ) && (uc_priv->cap & AHCI_CAP_SNCQ) &&
+	    ata_id_has_ncq(idbuf)) {
+		int depth = min3(ata_id_queue_depth(idbuf),
+				 (int)((uc_priv->cap >> 8) & 0x1f) + 1,
+				 AHCI_NCQ_SLOTS);
+
+		/* a depth of one gains nothing over normal commands */
+		if (depth > 1)
+			uc_priv->port[port].ncq_depth = depth;
+	}
+
 	memcpy(&pccb->pdata[8], "ATA     ", 8);
 	ata_id_strcpy((u16 *)&pccb->pdata[16], &idbuf[ATA_ID_PROD], 16);
 	ata_id_strcpy((u16 *)&pccb->pdata[32], &idbuf[ATA_ID_FW_REV], 4);
@@ -686,6 +862,18 @@ static int ata_scsiop_read_write(struct ahci_uc_priv *uc_priv,
 	debug("scsi_ahci: %s %u blocks starting from lba 0x" LBAFU "\n",
 	      is_write ?  "write" : "read", blocks, lba);
 
+	if (!is_write && uc_priv->port[pccb->target].ncq_depth) {
+		if (blocks * ATA_SECT_SIZE > user_buffer_size) {
+			printf("scsi_ahci: Error: buffer too small.\n");
+			return -EIO;
+		}
+
+		/* On failure NCQ is turned off, so try again without it */
+		if (!ahci_ncq_read(uc_priv, pccb->target, lba, user_buffer,
+				   blocks))
+			return 0;
+	}
+
 	/* Preset the FIS */
 	memset(fis, 0, sizeof(fis));
 	fis[0] = 0x27;		 /* Host to device FIS. */
@@ -915,8 +1103,8 @@ static int ata_io_flush(struct ahci_uc_priv *uc_priv, u8 port)
 	fis[2] = ATA_CMD_FLUSH_EXT;
 
 	memcpy((unsigned char *)pp->cmd_tbl, fis, 20);
-	ahci_fill_cmd_slot(pp, cmd_fis_len);
-	ahci_dcache_flush_sata_cmd(pp);
+	ahci_fill_cmd_slot(pp, 0, cmd_fis_len);
+	ahci_dcache_flush_sata_cmd(pp, 0);
 	writel_with_flush(1, port_mmio + PORT_CMD_ISSUE);
 
 	if (waiting_for_cmd_completed(port_mmio + PORT_CMD_ISSUE,
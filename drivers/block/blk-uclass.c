@@ -6,15 +6,18 @@
 
 #define LOG_CATEGORY UCLASS_BLK
 
+#include <bootstage.h>
 #include <blk.h>
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
+#include <memalign.h>
 #include <part.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
 #include <linux/err.h>
+#include <u-boot/schedule.h>
 
 #define blk_get_ops(dev)	((struct blk_ops *)(dev)->driver->ops)
 
@@ -322,12 +325,17 @@ int blk_show_device(enum uclass_id uclass_id, int devnum)
 int blk_select_hwpart(struct udevice *dev, int hwpart)
 {
 	const struct blk_ops *ops = blk_get_ops(dev);
+	struct blk_desc *desc;
 
 	if (!ops)
 		return -ENOSYS;
 	if (!ops->select_hwpart)
 		return 0;
 
+	desc = dev_get_uclass_plat(dev);
+	if (desc->hwpart != hwpart)
+		blk_readahead_invalidate(desc);
+
 	return ops->select_hwpart(dev, hwpart);
 }
 
@@ -429,19 +437,13 @@ static int blk_buffer_aligned(struct bounce_buffer *state)
 	return 1;	/* Default, any buffer is OK */
 }
 
-long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
+static long blk_read_dev(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
+			 void *buf)
 {
 	struct blk_desc *desc = dev_get_uclass_plat(dev);
 	const struct blk_ops *ops = blk_get_ops(dev);
 	ulong blks_read;
 
-	if (!ops->read)
-		return -ENOSYS;
-
-	if (blkcache_read(desc->uclass_id, desc->devnum,
-			  start, blkcnt, desc->blksz, buf))
-		return blkcnt;
-
 	if (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb) {
 		struct blk_bounce_buffer bbstate = { .dev = dev };
 		int ret;
@@ -460,13 +462,418 @@ long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
 		blks_read = ops->read(dev, start, blkcnt, buf);
 	}
 
+	return blks_read;
+}
+
+/**
+ * blk_submit_dev() - pass an asynchronous read to the driver
+ *
+ * @dev: Device to read from
+ * @req: Request to fill in and start
+ * @start: Start block for the read
+ * @blkcnt: Number of blocks to read
+ * @buf: Place to put the data
+ * Return: 0 if started, -ENOSYS if the driver cannot handle it, other -ve on
+ * error
+ */
+static int blk_submit_dev(struct udevice *dev, struct blk_request *req,
+			  lbaint_t start, lbaint_t blkcnt, void *buf, bool write)
+{
+	struct blk_desc *desc = dev_get_uclass_plat(dev);
+	const struct blk_ops *ops = blk_get_ops(dev);
+
+	memset(req, '\0', sizeof(*req));
+	req->dev = dev;
+	req->start = start;
+	req->blkcnt = blkcnt;
+	req->buf = buf;
+	req->write = write;
+
+	/* unaligned buffers need a bounce buffer, so transfer those directly */
+	if (!CONFIG_IS_ENABLED(BLK_ASYNC) || !ops->submit ||
+	    (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb))
+		return -ENOSYS;
+
+	if (write) {
+		blkcache_invalidate(desc->uclass_id, desc->devnum);
+		blk_readahead_invalidate(desc);
+		desc->write_count++;
+	}
+
+	return ops->submit(dev, req);
+}
+
+int blk_submit(struct udevice *dev, struct blk_request *req, lbaint_t start,
+	       lbaint_t blkcnt, void *buf)
+{
+	long blks_read;
+	int ret;
+
+	ret = blk_submit_dev(dev, req, start, blkcnt, buf, false);
+	if (ret != -ENOSYS)
+		return ret;
+
+	blks_read = blk_read(dev, start, blkcnt, buf);
+	req->complete = true;
+	if (blks_read < 0)
+		req->ret = blks_read;
+	else
+		req->done = blks_read;
+
+	return 0;
+}
+
+int blk_submit_write(struct udevice *dev, struct blk_request *req,
+		     lbaint_t start, lbaint_t blkcnt, const void *buf)
+{
+	long blks_written;
+	int ret;
+
+	ret = blk_submit_dev(dev, req, start, blkcnt, (void *)buf, true);
+	if (ret != -ENOSYS)
+		return ret;
+
+	blks_written = blk_write(dev, start, blkcnt, buf);
+	req->complete = true;
+	if (blks_written < 0)
+		req->ret = blks_written;
+	else
+		req->done = blks_written;
+
+	return 0;
+}
+
+int blk_poll(struct blk_request *req)
+{
+	const struct blk_ops *ops;
+	int ret;
+
+	if (req->complete)
+		return req->ret;
+
+	ops = blk_get_ops(req->dev);
+	ret = ops->poll(req->dev, req);
+	if (ret == -EBUSY)
+		return ret;
+	req->complete = true;
+	req->ret = ret;
+
+	return ret;
+}
+
+long blk_wait(struct blk_request *req)
+{
+	int ret;
+
+	while ((ret = blk_poll(req)) == -EBUSY)
+		schedule();
+	if (ret)
+		return ret;
+
+	return req->done;
+}
+
+#if CONFIG_IS_ENABLED(BLK_READAHEAD)
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+/**
+ * blk_readahead_settle() - finish any read of the following window
+ *
+ * @ra: Read-ahead state
+ * Return: true if a following window was in flight and read successfully
+ */
+static bool blk_readahead_settle(struct blk_readahead *ra)
+{
+	if (!ra->pending)
+		return false;
+	ra->pending = false;
+
+	return blk_wait(&ra->req) > 0;
+}
+
+/**
+ * blk_readahead_next() - start reading the window after the current one
+ *
+ * When the device can read asynchronously, the following window is read into
+ * a second buffer while the caller works on the data already returned, so
+ * that the next sequential read usually finds its data already in memory.
+ *
+ * @dev: Block device
+ * @ra: Read-ahead state
+ */
+static void blk_readahead_next(struct udevice *dev, struct blk_readahead *ra)
+{
+	struct blk_desc *desc = dev_get_uclass_plat(dev);
+	lbaint_t start = ra->start + ra->count;
+	lbaint_t win = ra->window;
+
+	if (!blk_get_ops(dev)->submit)
+		return;
+	if (desc->lba && start + win > desc->lba)
+		win = desc->lba > start ? desc->lba - start : 0;
+	if (!win)
+		return;
+	if (!ra->next_buf) {
+		ra->next_buf = memalign(ARCH_DMA_MINALIGN, ra->size);
+		if (!ra->next_buf)
+			return;
+	}
+	if (blk_submit_dev(dev, &ra->req, start, win, ra->next_buf, false))
+		return;
+	ra->pending = true;
+}
+
+/**
+ * blk_readahead_swap() - make the following window the current one
+ *
+ * @ra: Read-ahead state, with @ra->req complete
+ */
+static void blk_readahead_swap(struct blk_readahead *ra)
+{
+	void *buf = ra->buf;
+
+	ra->buf = ra->next_buf;
+	ra->next_buf = buf;
+	ra->start = ra->req.start;
+	ra->count = ra->req.done;
+}
+#else
+static bool blk_readahead_settle(struct blk_readahead *ra)
+{
+	return false;
+}
+
+static void blk_readahead_next(struct udevice *dev, struct blk_readahead *ra)
+{
+}
+
+static void blk_readahead_swap(struct blk_readahead *ra)
+{
+}
+#endif
+
+void blk_readahead_invalidate(struct blk_desc *desc)
+{
+	if (desc->ra) {
+		blk_readahead_settle(desc->ra);
+		desc->ra->count = 0;
+		desc->ra->window = 0;
+	}
+}
+
+static bool blk_readahead_hit(struct blk_desc *desc, struct blk_readahead *ra,
+			      lbaint_t start, lbaint_t blkcnt, void *buf)
+{
+	if (!ra->count || start < ra->start ||
+	    start + blkcnt > ra->start + ra->count)
+		return false;
+
+	memcpy(buf, ra->buf + (start - ra->start) * desc->blksz,
+	       blkcnt * desc->blksz);
+	ra->next = start + blkcnt;
+
+	return true;
+}
+
+/**
+ * blk_readahead_read() - read blocks through the read-ahead window
+ *
+ * Small reads which follow on from the previous one are treated as a
+ * sequential stream: the device is asked for a window of blocks which starts
+ * at the requested block and doubles in size with each sequential miss, up
+ * to the smaller of CONFIG_BLK_READAHEAD_BLOCKS and the driver's max_blocks.
+ * Later reads inside the window are copied from it without touching the
+ * device.
+ *
+ * @dev: Block device to read from
+ * @start: First block to read
+ * @blkcnt: Number of blocks to read
+ * @buf: Buffer to hold the data
+ * Return: number of blocks read, or -EAGAIN if the read should be passed to
+ * the driver directly
+ */
+static long blk_readahead_read(struct udevice *dev, lbaint_t start,
+			       lbaint_t blkcnt, void *buf)
+{
+	struct blk_desc *desc = dev_get_uclass_plat(dev);
+	struct blk_readahead *ra = desc->ra;
+	lbaint_t max, win;
+	long blks_read;
+
+	if (!ra) {
+		ra = calloc(1, sizeof(*ra));
+		if (!ra)
+			return -EAGAIN;
+		desc->ra = ra;
+	}
+
+	if (blk_readahead_hit(desc, ra, start, blkcnt, buf))
+		return blkcnt;
+
+	/* the device is idle from here on */
+	if (blk_readahead_settle(ra)) {
+		blk_readahead_swap(ra);
+		if (blk_readahead_hit(desc, ra, start, blkcnt, buf)) {
+			blk_readahead_next(dev, ra);
+			return blkcnt;
+		}
+		ra->count = 0;
+	}
+
+	max = CONFIG_BLK_READAHEAD_BLOCKS;
+	if (desc->max_blocks)
+		max = min(max, desc->max_blocks);
+
+	/* random access, or big enough to gain nothing from read-ahead */
+	if (start != ra->next || blkcnt * 2 > max) {
+		ra->window = 0;
+		ra->next = start + blkcnt;
+		return -EAGAIN;
+	}
+
+	win = ra->window ? ra->window * 2 : blkcnt * 4;
+	win = clamp(win, blkcnt, max);
+	if (desc->lba && start + win > desc->lba)
+		win = desc->lba > start ? desc->lba - start : 0;
+	if (win <= blkcnt) {
+		ra->next = start + blkcnt;
+		return -EAGAIN;
+	}
+
+	if (!ra->buf || ra->size < max * desc->blksz) {
+		free(ra->buf);
+		ra->count = 0;
+		ra->size = max * desc->blksz;
+		ra->buf = memalign(ARCH_DMA_MINALIGN, ra->size);
+		if (!ra->buf) {
+			ra->size = 0;
+			return -EAGAIN;
+		}
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+		free(ra->next_buf);
+		ra->next_buf = NULL;
+#endif
+	}
+
+	blks_read = blk_read_dev(dev, start, win, ra->buf);
+	if (blks_read < (long)blkcnt) {
+		ra->count = 0;
+		ra->window = 0;
+		return -EAGAIN;
+	}
+	log_debug("read-ahead: start " LBAF ", count " LBAFU "\n", start, win);
+
+	ra->start = start;
+	ra->count = blks_read;
+	ra->window = win;
+	ra->next = start + blkcnt;
+	memcpy(buf, ra->buf, blkcnt * desc->blksz);
+	blk_readahead_next(dev, ra);
+
+	return blkcnt;
+}
+
+static void blk_readahead_free(struct blk_desc *desc)
+{
+	if (desc->ra) {
+		blk_readahead_settle(desc->ra);
+		free(desc->ra->buf);
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+		free(desc->ra->next_buf);
+#endif
+		free(desc->ra);
+		desc->ra = NULL;
+	}
+}
+#else
+static long blk_readahead_read(struct udevice *dev, lbaint_t start,
+			       lbaint_t blkcnt, void *buf)
+{
+	return -EAGAIN;
+}
+
+static void blk_readahead_free(struct blk_desc *desc) {}
+#endif
+
+long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void *buf)
+{
+	struct blk_desc *desc = dev_get_uclass_plat(dev);
+	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong start_us = bootstage_prof_start();
+	long blks_read;
+
+	if (!ops->read)
+		return -ENOSYS;
+
+	if (blkcache_read(desc->uclass_id, desc->devnum,
+			  start, blkcnt, desc->blksz, buf)) {
+		blks_read = blkcnt;
+		goto done;
+	}
+
+	blks_read = blk_readahead_read(dev, start, blkcnt, buf);
+	if (blks_read == -EAGAIN)
+		blks_read = blk_read_dev(dev, start, blkcnt, buf);
+
 	if (blks_read == blkcnt)
 		blkcache_fill(desc->uclass_id, desc->devnum, start, blkcnt,
 			      desc->blksz, buf);
 
+done:
+	if (blks_read > 0)
+		bootstage_prof_add(BOOTSTAGE_PROF_BLK_READ, dev->name, start_us,
+				   (u64)blks_read * desc->blksz);
+
 	return blks_read;
 }
 
+long blk_read_sg(struct udevice *dev, lbaint_t start, const struct blk_sg *sg,
+		 uint count)
+{
+	struct blk_desc *desc = dev_get_uclass_plat(dev);
+	const struct blk_ops *ops = blk_get_ops(dev);
+	lbaint_t total = 0;
+	long ret;
+	uint i;
+
+	for (i = 0; i < count; i++) {
+		if (!sg[i].len || sg[i].len % desc->blksz)
+			return -EINVAL;
+	}
+
+	if (ops->read_sg && count > 1 &&
+	    !(IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb)) {
+		ret = ops->read_sg(dev, start, sg, count);
+		if (ret != -ENOSYS && ret != -E2BIG)
+			return ret;
+	}
+
+	for (i = 0; i < count; i++) {
+		lbaint_t blkcnt = sg[i].len / desc->blksz;
+
+		ret = blk_read(dev, start + total, blkcnt, sg[i].buf);
+		if (ret < 0)
+			return total ? total : ret;
+		total += ret;
+		if (ret != blkcnt)
+			break;
+	}
+
+	return total;
+}
+
+int blk_map(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void **bufp)
+{
+	struct blk_desc *desc = dev_get_uclass_plat(dev);
+	const struct blk_ops *ops = blk_get_ops(dev);
+
+	if (!ops->map)
+		return -ENOSYS;
+	if (!blkcnt || start + blkcnt > desc->lba)
+		return -ERANGE;
+
+	return ops->map(dev, start, blkcnt, bufp);
+}
+
 long blk_write(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 	       const void *buf)
 {
@@ -478,6 +885,8 @@ long blk_write(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		return -ENOSYS;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	blk_readahead_invalidate(desc);
+	desc->write_count++;
 
 	if (IS_ENABLED(CONFIG_BOUNCE_BUFFER) && desc->bb) {
 		struct blk_bounce_buffer bbstate = { .dev = dev };
@@ -510,6 +919,8 @@ long blk_erase(struct udevice *dev, lbaint_t start, lbaint_t blkcnt)
 		return -ENOSYS;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	blk_readahead_invalidate(desc);
+	desc->write_count++;
 
 	return ops->erase(dev, start, blkcnt);
 }
@@ -531,6 +942,12 @@ ulong blk_derase(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt)
 	return blk_erase(desc->bdev, start, blkcnt);
 }
 
+int blk_dmap(struct blk_desc *desc, lbaint_t start, lbaint_t blkcnt,
+	     void **bufp)
+{
+	return blk_map(desc->bdev, start, blkcnt, bufp);
+}
+
 int blk_find_from_parent(struct udevice *parent, struct udevice **devp)
 {
 	struct udevice *dev;
@@ -865,9 +1282,17 @@ static int blk_post_probe(struct udevice *dev)
 	return 0;
 }
 
+static int blk_pre_remove(struct udevice *dev)
+{
+	blk_readahead_free(dev_get_uclass_plat(dev));
+
+	return 0;
+}
+
 UCLASS_DRIVER(blk) = {
 	.id		= UCLASS_BLK,
 	.name		= "blk",
 	.post_probe	= blk_post_probe,
+	.pre_remove	= blk_pre_remove,
 	.per_device_plat_auto	= sizeof(struct blk_desc),
 };
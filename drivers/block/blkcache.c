@@ -10,7 +10,12 @@
 #include <part.h>
 #include <asm/global_data.h>
 #include <linux/ctype.h>
+#include <linux/kernel.h>
 #include <linux/list.h>
+#include <linux/log2.h>
+
+/* Number of entries in each set of the cache */
+#define BLKCACHE_WAYS		4
 
 struct block_cache_node {
 	struct list_head lh;
@@ -22,29 +27,111 @@ struct block_cache_node {
 	char *cache;
 };
 
-static LIST_HEAD(block_cache);
+/**
+ * struct block_cache_set - one set of the set-associative cache
+ *
+ * @lru: Entries in this set, most-recently used first
+ * @count: Number of entries in @lru
+ */
+struct block_cache_set {
+	struct list_head lru;
+	unsigned int count;
+};
+
+static struct block_cache_set *sets;
+static unsigned int num_sets;
+static unsigned int num_ways;
 
 static struct block_cache_stats _stats = {
 	.max_blocks_per_entry = 8,
 	.max_entries = 32
 };
 
+static struct block_cache_dev_stats *dev_stats(int iftype, int devnum)
+{
+	struct block_cache_dev_stats *ds;
+	int i;
+
+	for (i = 0; i < _stats.num_devs; i++) {
+		ds = &_stats.dev[i];
+		if (ds->iftype == iftype && ds->devnum == devnum)
+			return ds;
+	}
+	if (_stats.num_devs == BLKCACHE_MAX_DEVS)
+		return NULL;
+
+	ds = &_stats.dev[_stats.num_devs++];
+	ds->iftype = iftype;
+	ds->devnum = devnum;
+	ds->hits = 0;
+	ds->misses = 0;
+
+	return ds;
+}
+
+static uint cache_hash(int iftype, int devnum, lbaint_t start,
+		       lbaint_t blkcnt)
+{
+	u64 key;
+
+	key = (u64)start * 0x9e3779b97f4a7c15ULL;
+	key ^= ((u64)iftype << 40) ^ ((u64)devnum << 32) ^ blkcnt;
+	key *= 0xff51afd7ed558ccdULL;
+
+	return (uint)(key >> 32) & (num_sets - 1);
+}
+
+/**
+ * cache_setup() - allocate the sets of the cache
+ *
+ * The number of sets is a power of two so that hashing needs only a mask;
+ * the ways are sized so that all sets together can hold at least
+ * max_entries entries.
+ *
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+static int cache_setup(void)
+{
+	uint i;
+
+	if (sets)
+		return 0;
+
+	num_sets = roundup_pow_of_two(DIV_ROUND_UP(_stats.max_entries,
+						   BLKCACHE_WAYS));
+	num_ways = DIV_ROUND_UP(_stats.max_entries, num_sets);
+	sets = malloc(num_sets * sizeof(*sets));
+	if (!sets)
+		return -ENOMEM;
+	for (i = 0; i < num_sets; i++) {
+		INIT_LIST_HEAD(&sets[i].lru);
+		sets[i].count = 0;
+	}
+
+	return 0;
+}
+
 static struct block_cache_node *cache_find(int iftype, int devnum,
 					   lbaint_t start, lbaint_t blkcnt,
 					   unsigned long blksz)
 {
 	struct block_cache_node *node;
+	struct block_cache_set *set;
+
+	if (!sets)
+		return NULL;
 
-	list_for_each_entry(node, &block_cache, lh)
+	set = &sets[cache_hash(iftype, devnum, start, blkcnt)];
+	list_for_each_entry(node, &set->lru, lh)
 		if ((node->iftype == iftype) &&
 		    (node->devnum == devnum) &&
 		    (node->blksz == blksz) &&
-		    (node->start <= start) &&
-		    (node->start + node->blkcnt >= start + blkcnt)) {
-			if (block_cache.next != &node->lh) {
+		    (node->start == start) &&
+		    (node->blkcnt == blkcnt)) {
+			if (set->lru.next != &node->lh) {
 				/* maintain MRU ordering */
 				list_del(&node->lh);
-				list_add(&node->lh, &block_cache);
+				list_add(&node->lh, &set->lru);
 			}
 			return node;
 		}
@@ -57,18 +144,23 @@ int blkcache_read(int iftype, int devnum,
 {
 	struct block_cache_node *node = cache_find(iftype, devnum, start,
 						   blkcnt, blksz);
+	struct block_cache_dev_stats *ds = dev_stats(iftype, devnum);
+
 	if (node) {
-		const char *src = node->cache + (start - node->start) * blksz;
-		memcpy(buffer, src, blksz * blkcnt);
+		memcpy(buffer, node->cache, blksz * blkcnt);
 		debug("hit: start " LBAF ", count " LBAFU "\n",
 		      start, blkcnt);
 		++_stats.hits;
+		if (ds)
+			++ds->hits;
 		return 1;
 	}
 
 	debug("miss: start " LBAF ", count " LBAFU "\n",
 	      start, blkcnt);
 	++_stats.misses;
+	if (ds)
+		++ds->misses;
 	return 0;
 }
 
@@ -78,6 +170,7 @@ void blkcache_fill(int iftype, int devnum,
 {
 	lbaint_t bytes;
 	struct block_cache_node *node;
+	struct block_cache_set *set;
 
 	/* don't cache big stuff */
 	if (blkcnt > _stats.max_blocks_per_entry)
@@ -86,11 +179,20 @@ void blkcache_fill(int iftype, int devnum,
 	if (_stats.max_entries == 0)
 		return;
 
+	if (cache_setup())
+		return;
+
 	bytes = blksz * blkcnt;
-	if (_stats.max_entries <= _stats.entries) {
-		/* pop LRU */
-		node = (struct block_cache_node *)block_cache.prev;
+	set = &sets[cache_hash(iftype, devnum, start, blkcnt)];
+	if (set->count >= num_ways || _stats.max_entries <= _stats.entries) {
+		/* the cache is full but there is nothing in this set to drop */
+		if (!set->count)
+			return;
+
+		/* pop LRU of this set */
+		node = list_last_entry(&set->lru, struct block_cache_node, lh);
 		list_del(&node->lh);
+		set->count--;
 		_stats.entries--;
 		debug("drop: start " LBAF ", count " LBAFU "\n",
 		      node->start, node->blkcnt);
@@ -122,23 +224,30 @@ void blkcache_fill(int iftype, int devnum,
 	node->blkcnt = blkcnt;
 	node->blksz = blksz;
 	memcpy(node->cache, buffer, bytes);
-	list_add(&node->lh, &block_cache);
+	list_add(&node->lh, &set->lru);
+	set->count++;
 	_stats.entries++;
 }
 
 void blkcache_invalidate(int iftype, int devnum)
 {
-	struct list_head *entry, *n;
-	struct block_cache_node *node;
+	struct block_cache_node *node, *n;
+	uint i;
 
-	list_for_each_safe(entry, n, &block_cache) {
-		node = (struct block_cache_node *)entry;
-		if (iftype == -1 ||
-		    (node->iftype == iftype && node->devnum == devnum)) {
-			list_del(entry);
-			free(node->cache);
-			free(node);
-			--_stats.entries;
+	if (!sets)
+		return;
+
+	for (i = 0; i < num_sets; i++) {
+		list_for_each_entry_safe(node, n, &sets[i].lru, lh) {
+			if (iftype == -1 ||
+			    (node->iftype == iftype &&
+			     node->devnum == devnum)) {
+				list_del(&node->lh);
+				free(node->cache);
+				free(node);
+				sets[i].count--;
+				--_stats.entries;
+			}
 		}
 	}
 }
@@ -148,23 +257,31 @@ void blkcache_configure(unsigned blocks, unsigned entries)
 	/* invalidate cache if there is a change */
 	if ((blocks != _stats.max_blocks_per_entry) ||
 	    (entries != _stats.max_entries))
-		blkcache_invalidate(-1, 0);
+		blkcache_free();
 
 	_stats.max_blocks_per_entry = blocks;
 	_stats.max_entries = entries;
 
 	_stats.hits = 0;
 	_stats.misses = 0;
+	_stats.num_devs = 0;
 }
 
 void blkcache_stats(struct block_cache_stats *stats)
 {
 	memcpy(stats, &_stats, sizeof(*stats));
+	stats->sets = num_sets;
+	stats->ways = num_ways;
 	_stats.hits = 0;
 	_stats.misses = 0;
+	_stats.num_devs = 0;
 }
 
 void blkcache_free(void)
 {
 	blkcache_invalidate(-1, 0);
+	free(sets);
+	sets = NULL;
+	num_sets = 0;
+	num_ways = 0;
 }
@@ -56,6 +56,17 @@ struct blkmap_slice {
 	ulong (*write)(struct blkmap *bm, struct blkmap_slice *bms,
 		       lbaint_t blknr, lbaint_t blkcnt, const void *buffer);
 
+	/**
+	 * @map: - Get a pointer to the data of a slice, if it is in memory
+	 *
+	 * @map.bm: Blkmap to which this slice belongs
+	 * @map.bms: This slice
+	 * @map.blknr: Start block number within the slice
+	 * @map.bufp: Returns a pointer to the data of @map.blknr
+	 */
+	int (*map)(struct blkmap *bm, struct blkmap_slice *bms,
+		   lbaint_t blknr, void **bufp);
+
 	/**
 	 * @destroy: - Tear down slice
 	 *
@@ -212,6 +223,16 @@ static ulong blkmap_mem_read(struct blkmap *bm, struct blkmap_slice *bms,
 	return blkcnt;
 }
 
+static int blkmap_mem_map(struct blkmap *bm, struct blkmap_slice *bms,
+			  lbaint_t blknr, void **bufp)
+{
+	struct blkmap_mem *bmm = container_of(bms, struct blkmap_mem, slice);
+	struct blk_desc *bd = dev_get_uclass_plat(bm->blk);
+
+	*bufp = bmm->addr + (blknr << bd->log2blksz);
+	return 0;
+}
+
 static ulong blkmap_mem_write(struct blkmap *bm, struct blkmap_slice *bms,
 			      lbaint_t blknr, lbaint_t blkcnt,
 			      const void *buffer)
@@ -251,6 +272,7 @@ int __blkmap_map_mem(struct udevice *dev, lbaint_t blknr, lbaint_t blkcnt,
 
 			.read = blkmap_mem_read,
 			.write = blkmap_mem_write,
+			.map = blkmap_mem_map,
 			.destroy = blkmap_mem_destroy,
 		},
 
@@ -323,6 +345,26 @@ static ulong blkmap_blk_read(struct udevice *dev, lbaint_t blknr,
 	return total;
 }
 
+static int blkmap_blk_map(struct udevice *dev, lbaint_t blknr,
+			  lbaint_t blkcnt, void **bufp)
+{
+	struct blkmap *bm = dev_get_plat(dev->parent);
+	struct blkmap_slice *bms;
+
+	list_for_each_entry(bms, &bm->slices, node) {
+		if (!blkmap_slice_contains(bms, blknr))
+			continue;
+
+		/* Only a single memory slice is contiguous */
+		if (!bms->map || !blkmap_slice_contains(bms, blknr + blkcnt - 1))
+			return -ERANGE;
+
+		return bms->map(bm, bms, blknr - bms->blknr, bufp);
+	}
+
+	return -ERANGE;
+}
+
 static ulong blkmap_blk_write_slice(struct blkmap *bm, struct blkmap_slice *bms,
 				    lbaint_t blknr, lbaint_t blkcnt,
 				    const void *buffer)
@@ -359,6 +401,7 @@ static ulong blkmap_blk_write(struct udevice *dev, lbaint_t blknr,
 static const struct blk_ops blkmap_blk_ops = {
 	.read	= blkmap_blk_read,
 	.write	= blkmap_blk_write,
+	.map	= blkmap_blk_map,
 };
 
 U_BOOT_DRIVER(blkmap_blk) = {
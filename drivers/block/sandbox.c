@@ -13,10 +13,40 @@
 #include <asm/global_data.h>
 #include <dm/device_compat.h>
 #include <dm/device-internal.h>
+#include <linux/delay.h>
 #include <linux/errno.h>
+#include <linux/math64.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Take as long as the device is set up to, see 'host perf' */
+static void host_block_delay(struct host_sb_plat *plat, ulong bytes)
+{
+	ulong us = plat->latency_us;
+
+	if (plat->rate_kib)
+		us += div_u64((u64)bytes * 1000000, plat->rate_kib * 1024);
+	if (us)
+		udelay(us);
+}
+
+/*
+ * Work out the part of a mapped file which is accessed, returning the number
+ * of blocks, which is fewer than @blkcnt at the end of the file
+ */
+static lbaint_t host_block_map(struct blk_desc *desc,
+			       struct host_sb_plat *plat, unsigned long start,
+			       lbaint_t blkcnt, void **ptrp)
+{
+	lbaint_t avail = plat->map_size / desc->blksz;
+
+	if (start >= avail)
+		return 0;
+	*ptrp = plat->map + start * desc->blksz;
+
+	return min(blkcnt, avail - start);
+}
+
 static unsigned long host_block_read(struct udevice *dev,
 				     unsigned long start, lbaint_t blkcnt,
 				     void *buffer)
@@ -24,6 +54,14 @@ static unsigned long host_block_read(struct udevice *dev,
 	struct blk_desc *desc = dev_get_uclass_plat(dev);
 	struct udevice *host_dev = dev_get_parent(dev);
 	struct host_sb_plat *plat = dev_get_plat(host_dev);
+	void *ptr;
+
+	host_block_delay(plat, blkcnt * desc->blksz);
+	if (plat->map) {
+		blkcnt = host_block_map(desc, plat, start, blkcnt, &ptr);
+		memcpy(buffer, ptr, blkcnt * desc->blksz);
+		return blkcnt;
+	}
 
 	if (os_lseek(plat->fd, start * desc->blksz, OS_SEEK_SET) < 0) {
 		printf("ERROR: Invalid block %lx\n", start);
@@ -43,6 +81,14 @@ static unsigned long host_block_write(struct udevice *dev,
 	struct blk_desc *desc = dev_get_uclass_plat(dev);
 	struct udevice *host_dev = dev_get_parent(dev);
 	struct host_sb_plat *plat = dev_get_plat(host_dev);
+	void *ptr;
+
+	host_block_delay(plat, blkcnt * desc->blksz);
+	if (plat->map) {
+		blkcnt = host_block_map(desc, plat, start, blkcnt, &ptr);
+		memcpy(ptr, buffer, blkcnt * desc->blksz);
+		return blkcnt;
+	}
 
 	if (os_lseek(plat->fd, start * desc->blksz, OS_SEEK_SET) < 0) {
 		printf("ERROR: Invalid block %lx\n", start);
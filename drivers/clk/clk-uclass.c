@@ -351,6 +351,10 @@ static int clk_set_default_rates(struct udevice *dev,
 		if (IS_ERR(c))
 			return PTR_ERR(c);
 
+		/* Reprogramming a PLL to its current rate can mean a relock */
+		if (clk_get_rate(c) == rates[index])
+			continue;
+
 		ret = clk_set_rate(c, rates[index]);
 
 		if (ret < 0) {
@@ -460,6 +464,8 @@ int clk_request(struct udevice *dev, struct clk *clk)
 ulong clk_get_rate(struct clk *clk)
 {
 	const struct clk_ops *ops;
+	bool cache;
+	ulong rate;
 
 	debug("%s(clk=%p)\n", __func__, clk);
 	if (!clk_valid(clk))
@@ -469,7 +475,20 @@ ulong clk_get_rate(struct clk *clk)
 	if (!ops->get_rate)
 		return -ENOSYS;
 
-	return ops->get_rate(clk);
+	/*
+	 * A CCF clock's own struct is the one whose cache is cleaned when the
+	 * rate or parent of it or an ancestor changes, so it can hold the rate
+	 */
+	cache = CONFIG_IS_ENABLED(CLK_CCF) && clk == dev_get_clk_ptr(clk->dev) &&
+		!(clk->flags & CLK_GET_RATE_NOCACHE);
+	if (cache && clk->rate)
+		return clk->rate;
+
+	rate = ops->get_rate(clk);
+	if (cache && !IS_ERR_VALUE(rate))
+		clk->rate = rate;
+
+	return rate;
 }
 
 struct clk *clk_get_parent(struct clk *clk)
@@ -609,8 +628,14 @@ int clk_set_parent(struct clk *clk, struct clk *parent)
 	if (ret)
 		return ret;
 
-	if (CONFIG_IS_ENABLED(CLK_CCF))
+	if (CONFIG_IS_ENABLED(CLK_CCF)) {
+		struct clk *clkp;
+
+		/* the rates of this clock and its children may have changed */
+		clk_get_priv(clk, &clkp);
+		clk_clean_rate_cache(clkp);
 		ret = device_reparent(clk->dev, parent->dev);
+	}
 
 	return ret;
 }
@@ -802,9 +827,10 @@ int clk_uclass_post_probe(struct udevice *dev)
 	 * when a clock provider is probed. Call clk_set_defaults()
 	 * also after the device is probed. This takes care of cases
 	 * where the DT is used to setup default parents and rates
-	 * using assigned-clocks
+	 * using assigned-clocks, unless an earlier phase already did so
 	 */
-	clk_set_defaults(dev, CLK_DEFAULTS_POST);
+	if (!(dev_get_flags(dev) & DM_FLAG_HANDED_OFF))
+		clk_set_defaults(dev, CLK_DEFAULTS_POST);
 
 	return 0;
 }
@@ -133,6 +133,16 @@ void device_free(struct udevice *dev)
 {
 	int size;
 
+#if CONFIG_IS_ENABLED(DM_PRIV_ARENA)
+	/* The priv blocks are all in the arena, so are not freed below */
+	if (dev->priv_arena_) {
+		free(dev->priv_arena_);
+		dev->priv_arena_ = NULL;
+		dev_set_priv(dev, NULL);
+		dev_set_uclass_priv(dev, NULL);
+		dev_set_parent_priv(dev, NULL);
+	}
+#endif
 	if (dev->driver->priv_auto) {
 		free(dev_get_priv(dev));
 		dev_set_priv(dev, NULL);
@@ -257,7 +267,8 @@ int device_remove(struct udevice *dev, uint flags)
 
 	device_free(dev);
 
-	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
+	dev_bic_flags(dev, DM_FLAG_ACTIVATED | DM_FLAG_PROBE_PENDING |
+		      DM_FLAG_PINCTRL_DONE | DM_FLAG_HANDED_OFF);
 
 	ret = device_notify(dev, EVT_DM_POST_REMOVE);
 	if (ret)
@@ -8,6 +8,7 @@
  * Pavel Herrmann <morpheus.ibis@gmail.com>
  */
 
+#include <bootstage.h>
 #include <cpu_func.h>
 #include <errno.h>
 #include <event.h>
@@ -37,6 +38,50 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Alignment of each block in an arena, the same as malloc() provides */
+#define DM_ARENA_ALIGN		(2 * sizeof(size_t))
+
+/* Work out the size of the device and the plat blocks allocated with it */
+static int device_plat_arena_size(const struct driver *drv, struct uclass *uc,
+				  struct udevice *parent, void *plat,
+				  uint of_plat_size)
+{
+	int size = ALIGN(sizeof(struct udevice), DM_ARENA_ALIGN);
+
+	if (drv->plat_auto && (!plat || (CONFIG_IS_ENABLED(OF_PLATDATA) &&
+					 of_plat_size < drv->plat_auto)))
+		size += ALIGN(drv->plat_auto, DM_ARENA_ALIGN);
+	size += ALIGN(uc->uc_drv->per_device_plat_auto, DM_ARENA_ALIGN);
+	if (parent) {
+		int child = parent->driver->per_child_plat_auto;
+
+		if (!child)
+			child = parent->uclass->uc_drv->per_child_plat_auto;
+		size += ALIGN(child, DM_ARENA_ALIGN);
+	}
+
+	return size;
+}
+
+/*
+ * Allocate a plat block, from the arena if there is one. Only blocks which
+ * are allocated separately are marked with @flag, so that they are freed on
+ * their own.
+ */
+static void *device_alloc_plat(struct udevice *dev, void **arenap, int size,
+			       uint flag)
+{
+	void *ptr = *arenap;
+
+	if (!ptr) {
+		dev_or_flags(dev, flag);
+		return calloc(1, size);
+	}
+	*arenap += ALIGN(size, DM_ARENA_ALIGN);
+
+	return ptr;
+}
+
 static int device_bind_common(struct udevice *parent, const struct driver *drv,
 			      const char *name, void *plat,
 			      ulong driver_data, ofnode node,
@@ -46,7 +91,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	struct uclass *uc;
 	int size, ret = 0;
 	bool auto_seq = true;
-	void *ptr;
+	void *ptr, *arena = NULL;
 
 	if (CONFIG_IS_ENABLED(OF_PLATDATA_NO_BIND))
 		return -ENOSYS;
@@ -62,9 +107,23 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		return ret;
 	}
 
-	dev = calloc(1, sizeof(struct udevice));
-	if (!dev)
-		return -ENOMEM;
+	/*
+	 * The plat blocks are freed when the device is, so they can be
+	 * allocated along with it
+	 */
+	if (CONFIG_IS_ENABLED(DM_PRIV_ARENA)) {
+		size = device_plat_arena_size(drv, uc, parent, plat,
+					      of_plat_size);
+		dev = calloc(1, size);
+		if (!dev)
+			return -ENOMEM;
+		arena = (void *)dev + ALIGN(sizeof(struct udevice),
+					    DM_ARENA_ALIGN);
+	} else {
+		dev = calloc(1, sizeof(struct udevice));
+		if (!dev)
+			return -ENOMEM;
+	}
 
 	INIT_LIST_HEAD(&dev->sibling_node);
 	INIT_LIST_HEAD(&dev->child_head);
@@ -115,8 +174,8 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 				alloc = true;
 		}
 		if (alloc) {
-			dev_or_flags(dev, DM_FLAG_ALLOC_PDATA);
-			ptr = calloc(1, drv->plat_auto);
+			ptr = device_alloc_plat(dev, &arena, drv->plat_auto,
+						DM_FLAG_ALLOC_PDATA);
 			if (!ptr) {
 				ret = -ENOMEM;
 				goto fail_alloc1;
@@ -134,8 +193,8 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 
 	size = uc->uc_drv->per_device_plat_auto;
 	if (size) {
-		dev_or_flags(dev, DM_FLAG_ALLOC_UCLASS_PDATA);
-		ptr = calloc(1, size);
+		ptr = device_alloc_plat(dev, &arena, size,
+					DM_FLAG_ALLOC_UCLASS_PDATA);
 		if (!ptr) {
 			ret = -ENOMEM;
 			goto fail_alloc2;
@@ -148,8 +207,8 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		if (!size)
 			size = parent->uclass->uc_drv->per_child_plat_auto;
 		if (size) {
-			dev_or_flags(dev, DM_FLAG_ALLOC_PARENT_PDATA);
-			ptr = calloc(1, size);
+			ptr = device_alloc_plat(dev, &arena, size,
+						DM_FLAG_ALLOC_PARENT_PDATA);
 			if (!ptr) {
 				ret = -ENOMEM;
 				goto fail_alloc3;
@@ -186,6 +245,13 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 	if (devp)
 		*devp = dev;
 
+	if (CONFIG_IS_ENABLED(DM_PROBE_EARLY) && ofnode_valid(node) &&
+	    ofnode_read_bool(node, "u-boot,probe-early"))
+		dev_or_flags(dev, DM_FLAG_PROBE_AFTER_BIND);
+
+	if (CONFIG_IS_ENABLED(DM_HANDOFF))
+		dm_handoff_apply(dev);
+
 	dev_or_flags(dev, DM_FLAG_BOUND);
 
 	return 0;
@@ -292,6 +358,7 @@ int device_reparent(struct udevice *dev, struct udevice *new_parent)
 		list_del(&dev->sibling_node);
 		list_add_tail(&dev->sibling_node, &new_parent->child_head);
 		dev->parent = new_parent;
+		uclass_index_invalidate(dev->uclass);
 
 		break;
 	}
@@ -338,6 +405,68 @@ static void *alloc_priv(int size, uint flags)
 	return priv;
 }
 
+#if CONFIG_IS_ENABLED(DM_PRIV_ARENA)
+/**
+ * device_alloc_priv_arena() - Allocate all the priv data in one block
+ *
+ * This is only done if there are at least two blocks and none is set up
+ * already, since a driver may provide its own. The block is freed by
+ * device_free().
+ *
+ * @dev: Device to process
+ * @priv_size: Size of the driver's private data
+ * @uc_size: Size of the uclass's private data
+ * @parent_size: Size of the parent's private data
+ * Return: 0 if OK, -ENOMEM if out of memory, -ENOENT if not done
+ */
+static int device_alloc_priv_arena(struct udevice *dev, int priv_size,
+				   int uc_size, int parent_size)
+{
+	uint flags = dev->driver->flags | dev->uclass->uc_drv->flags;
+	int align, size;
+	void *arena;
+
+	if (!!priv_size + !!uc_size + !!parent_size < 2 || dev_get_priv(dev) ||
+	    dev_get_uclass_priv(dev) || dev_get_parent_priv(dev))
+		return -ENOENT;
+
+	align = flags & DM_FLAG_ALLOC_PRIV_DMA ? ARCH_DMA_MINALIGN :
+		DM_ARENA_ALIGN;
+	size = ALIGN(priv_size, align) + ALIGN(uc_size, align) +
+		ALIGN(parent_size, align);
+	arena = alloc_priv(size, flags & DM_FLAG_ALLOC_PRIV_DMA);
+	if (!arena)
+		return -ENOMEM;
+	dev->priv_arena_ = arena;
+	if (priv_size) {
+		dev_set_priv(dev, arena);
+		arena += ALIGN(priv_size, align);
+	}
+	if (uc_size) {
+		dev_set_uclass_priv(dev, arena);
+		arena += ALIGN(uc_size, align);
+	}
+	if (parent_size)
+		dev_set_parent_priv(dev, arena);
+
+	return 0;
+}
+#endif
+
+/* Get the size of the parent's private data for a device */
+static int device_parent_priv_size(struct udevice *dev)
+{
+	int size;
+
+	if (!dev->parent)
+		return 0;
+	size = dev->parent->driver->per_child_auto;
+	if (!size)
+		size = dev->parent->uclass->uc_drv->per_child_auto;
+
+	return size;
+}
+
 /**
  * device_alloc_priv() - Allocate priv/plat data required by the device
  *
@@ -353,6 +482,16 @@ static int device_alloc_priv(struct udevice *dev)
 	drv = dev->driver;
 	assert(drv);
 
+#if CONFIG_IS_ENABLED(DM_PRIV_ARENA)
+	int ret;
+
+	ret = device_alloc_priv_arena(dev, drv->priv_auto,
+				      dev->uclass->uc_drv->per_device_auto,
+				      device_parent_priv_size(dev));
+	if (ret != -ENOENT)
+		return ret;
+#endif
+
 	/* Allocate private data if requested and not reentered */
 	if (drv->priv_auto && !dev_get_priv(dev)) {
 		ptr = alloc_priv(drv->priv_auto, drv->flags);
@@ -371,16 +510,12 @@ static int device_alloc_priv(struct udevice *dev)
 	}
 
 	/* Allocate parent data for this child */
-	if (dev->parent) {
-		size = dev->parent->driver->per_child_auto;
-		if (!size)
-			size = dev->parent->uclass->uc_drv->per_child_auto;
-		if (size && !dev_get_parent_priv(dev)) {
-			ptr = alloc_priv(size, drv->flags);
-			if (!ptr)
-				return -ENOMEM;
-			dev_set_parent_priv(dev, ptr);
-		}
+	size = device_parent_priv_size(dev);
+	if (size && !dev_get_parent_priv(dev)) {
+		ptr = alloc_priv(size, drv->flags);
+		if (!ptr)
+			return -ENOMEM;
+		dev_set_parent_priv(dev, ptr);
 	}
 
 	return 0;
@@ -478,16 +613,41 @@ static int device_get_dma_constraints(struct udevice *dev)
 	return 0;
 }
 
-int device_probe(struct udevice *dev)
+/**
+ * device_select_default_pinctrl() - Set up a device's default pinctrl state
+ *
+ * This does nothing if the state is already set up, e.g. by an earlier phase.
+ * Errors are ignored, since many devices work without pinctrl.
+ *
+ * @dev: Device being probed
+ */
+static void device_select_default_pinctrl(struct udevice *dev)
 {
-	const struct driver *drv;
 	int ret;
 
-	if (!dev)
-		return -EINVAL;
+	if (dev_get_flags(dev) & DM_FLAG_PINCTRL_DONE)
+		return;
 
-	if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
-		return 0;
+	/* -ENOSYS means that there is nothing to set up */
+	ret = pinctrl_select_state(dev, "default");
+	if (!ret || ret == -ENOSYS)
+		dev_or_flags(dev, DM_FLAG_PINCTRL_DONE);
+	else
+		log_debug("Device '%s' failed to configure default pinctrl: %d (%s)\n",
+			  dev->name, ret, errno_str(ret));
+}
+
+/**
+ * device_probe_start() - Probe a device up to its driver's probe() method
+ *
+ * @dev: Device to probe, which must not be activated
+ * Return: 0 if the driver's probe() method was called, 1 if the device was
+ * probed as a side-effect of probing its parent, -ve on error
+ */
+static int device_probe_start(struct udevice *dev)
+{
+	const struct driver *drv;
+	int ret;
 
 	ret = device_notify(dev, EVT_DM_PRE_PROBE);
 	if (ret)
@@ -513,7 +673,7 @@ int device_probe(struct udevice *dev)
 		 * so that we don't mess up the device.
 		 */
 		if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
-			return 0;
+			return 1;
 	}
 
 	dev_or_flags(dev, DM_FLAG_ACTIVATED);
@@ -541,12 +701,8 @@ int device_probe(struct udevice *dev)
 	 * is set just above. However, the PCI bus' probe() method and
 	 * associated uclass methods have not yet been called.
 	 */
-	if (dev->parent && device_get_uclass_id(dev) != UCLASS_PINCTRL) {
-		ret = pinctrl_select_state(dev, "default");
-		if (ret && ret != -ENOSYS)
-			log_debug("Device '%s' failed to configure default pinctrl: %d (%s)\n",
-				  dev->name, ret, errno_str(ret));
-	}
+	if (dev->parent && device_get_uclass_id(dev) != UCLASS_PINCTRL)
+		device_select_default_pinctrl(dev);
 
 	if (CONFIG_IS_ENABLED(IOMMU) && dev->parent &&
 	    (device_get_uclass_id(dev) != UCLASS_IOMMU)) {
@@ -569,8 +725,11 @@ int device_probe(struct udevice *dev)
 			goto fail;
 	}
 
-	/* Only handle devices that have a valid ofnode */
-	if (dev_has_ofnode(dev)) {
+	/*
+	 * Only handle devices that have a valid ofnode, which an earlier phase
+	 * has not already set up
+	 */
+	if (dev_has_ofnode(dev) && !(dev_get_flags(dev) & DM_FLAG_HANDED_OFF)) {
 		/*
 		 * Process 'assigned-{clocks/clock-parents/clock-rates}'
 		 * properties
@@ -586,16 +745,41 @@ int device_probe(struct udevice *dev)
 			goto fail;
 	}
 
+	return 0;
+fail:
+	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
+
+	device_free(dev);
+
+	return ret;
+}
+
+/**
+ * device_probe_done() - Complete probing a device after its probe() method
+ *
+ * This calls the driver's probe_finish() method, if any, then lets the
+ * uclass and any event spies know that the device is ready.
+ *
+ * @dev: Device whose driver's probe() method has been called
+ * Return: 0 if OK, -ve on error, in which case the device is removed
+ */
+static int device_probe_done(struct udevice *dev)
+{
+	const struct driver *drv = dev->driver;
+	int ret;
+
+	if (drv->probe_finish) {
+		ret = drv->probe_finish(dev);
+		if (ret)
+			goto fail_finish;
+	}
+
 	ret = uclass_post_probe_device(dev);
 	if (ret)
 		goto fail_uclass;
 
-	if (dev->parent && device_get_uclass_id(dev) == UCLASS_PINCTRL) {
-		ret = pinctrl_select_state(dev, "default");
-		if (ret && ret != -ENOSYS)
-			log_debug("Device '%s' failed to configure default pinctrl: %d (%s)\n",
-				  dev->name, ret, errno_str(ret));
-	}
+	if (dev->parent && device_get_uclass_id(dev) == UCLASS_PINCTRL)
+		device_select_default_pinctrl(dev);
 
 	ret = device_notify(dev, EVT_DM_POST_PROBE);
 	if (ret)
@@ -604,11 +788,11 @@ int device_probe(struct udevice *dev)
 	return 0;
 fail_event:
 fail_uclass:
+fail_finish:
 	if (device_remove(dev, DM_REMOVE_NORMAL)) {
 		dm_warn("%s: Device '%s' failed to remove on error path\n",
 			__func__, dev->name);
 	}
-fail:
 	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
 
 	device_free(dev);
@@ -616,6 +800,66 @@ fail:
 	return ret;
 }
 
+int device_probe(struct udevice *dev)
+{
+	ulong start_us;
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
+		return device_probe_finish(dev);
+
+	start_us = bootstage_prof_start();
+
+	ret = device_probe_start(dev);
+	if (ret)
+		return ret < 0 ? ret : 0;
+
+	ret = device_probe_done(dev);
+	if (ret)
+		return ret;
+
+	bootstage_prof_add(BOOTSTAGE_PROF_PROBE, dev->name, start_us, 0);
+
+	return 0;
+}
+
+int device_probe_begin(struct udevice *dev)
+{
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
+		return 0;
+
+	ret = device_probe_start(dev);
+	if (ret)
+		return ret < 0 ? ret : 0;
+
+	if (dev->driver->probe_finish) {
+		dev_or_flags(dev, DM_FLAG_PROBE_PENDING);
+		return 0;
+	}
+
+	return device_probe_done(dev);
+}
+
+int device_probe_finish(struct udevice *dev)
+{
+	if (!dev)
+		return -EINVAL;
+
+	if (!(dev_get_flags(dev) & DM_FLAG_PROBE_PENDING))
+		return 0;
+	dev_bic_flags(dev, DM_FLAG_PROBE_PENDING);
+
+	return device_probe_done(dev);
+}
+
 void *dev_get_plat(const struct udevice *dev)
 {
 	if (!dev) {
@@ -1145,6 +1389,7 @@ int device_set_name(struct udevice *dev, const char *name)
 		return -ENOMEM;
 	dev->name = name;
 	device_set_name_alloced(dev);
+	uclass_index_invalidate(dev->uclass);
 
 	return 0;
 }
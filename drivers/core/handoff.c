@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Passing the set-up state of devices from one phase to the next
+ *
+ * SPL probes the devices it needs to load the next phase, applying their
+ * default pinctrl state and 'assigned-clocks' settings. U-Boot then probes
+ * many of the same devices and does all of this again. Here SPL records each
+ * device it has set up in the bloblist, so that U-Boot can skip that work.
+ *
+ * Devices are identified by a hash of the names of the device and its
+ * parents, which are the devicetree node names for devices bound from the
+ * devicetree.
+ */
+
+#define LOG_CATEGORY	LOGC_DM
+
+#include <bloblist.h>
+#include <errno.h>
+#include <log.h>
+#include <dm/device.h>
+#include <dm/device-internal.h>
+#include <dm/root.h>
+#include <asm/global_data.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Device flags which are passed on to the next phase */
+#define DM_HANDOFF_FLAGS	DM_FLAG_PINCTRL_DONE
+
+/**
+ * struct dm_handoff_dev - a device set up by an earlier phase
+ *
+ * @hash: Hash of the names of the device and its parents
+ * @flags: DM_FLAG_... values from DM_HANDOFF_FLAGS
+ */
+struct dm_handoff_dev {
+	u32 hash;
+	u32 flags;
+};
+
+/**
+ * struct dm_handoff - devices set up by an earlier phase
+ *
+ * @count: Number of entries in @dev
+ * @dev: Devices
+ */
+struct dm_handoff {
+	u32 count;
+	struct dm_handoff_dev dev[];
+};
+
+static u32 dm_handoff_hash(struct udevice *dev)
+{
+	u32 hash = 2166136261U;
+	const char *name;
+
+	for (; dev && dev != gd->dm_root; dev = dev->parent) {
+		for (name = dev->name; *name; name++)
+			hash = (hash ^ (u8)*name) * 16777619;
+		hash = (hash ^ '/') * 16777619;
+	}
+
+	return hash;
+}
+
+void dm_handoff_apply(struct udevice *dev)
+{
+	struct dm_handoff *ho;
+	int size;
+	u32 hash, i;
+
+	if (!dev_has_ofnode(dev))
+		return;
+	ho = bloblist_get_blob(BLOBLISTT_U_BOOT_DM_HANDOFF, &size);
+	if (!ho)
+		return;
+
+	hash = dm_handoff_hash(dev);
+	for (i = 0; i < ho->count; i++) {
+		if (ho->dev[i].hash == hash) {
+			log_debug("%s: set up by earlier phase\n", dev->name);
+			dev_or_flags(dev, DM_FLAG_HANDED_OFF |
+				     (ho->dev[i].flags & DM_HANDOFF_FLAGS));
+			return;
+		}
+	}
+}
+
+static bool dm_handoff_wanted(struct udevice *dev)
+{
+	return dev != gd->dm_root && dev_has_ofnode(dev) &&
+		(dev_get_flags(dev) & (DM_FLAG_ACTIVATED | DM_FLAG_HANDED_OFF));
+}
+
+/* Walk the devices below @parent, filling in @ho if it is not NULL */
+static u32 dm_handoff_scan(struct udevice *parent, struct dm_handoff *ho,
+			   u32 count)
+{
+	struct udevice *dev;
+
+	if (dm_handoff_wanted(parent)) {
+		if (ho) {
+			ho->dev[count].hash = dm_handoff_hash(parent);
+			ho->dev[count].flags = dev_get_flags(parent) &
+				DM_HANDOFF_FLAGS;
+		}
+		count++;
+	}
+	device_foreach_child(dev, parent)
+		count = dm_handoff_scan(dev, ho, count);
+
+	return count;
+}
+
+int dm_handoff_write(void)
+{
+	struct dm_handoff *ho;
+	int size, ret;
+	u32 count;
+
+	count = dm_handoff_scan(gd->dm_root, NULL, 0);
+	size = sizeof(*ho) + count * sizeof(ho->dev[0]);
+
+	/* Replace any record from an earlier phase */
+	if (bloblist_get_blob(BLOBLISTT_U_BOOT_DM_HANDOFF, &ret)) {
+		ret = bloblist_resize(BLOBLISTT_U_BOOT_DM_HANDOFF, size);
+		if (ret)
+			return log_msg_ret("res", ret);
+		ho = bloblist_find(BLOBLISTT_U_BOOT_DM_HANDOFF, size);
+	} else {
+		ho = bloblist_add(BLOBLISTT_U_BOOT_DM_HANDOFF, size, 0);
+	}
+	if (!ho)
+		return log_msg_ret("add", -ENOSPC);
+
+	ho->count = dm_handoff_scan(gd->dm_root, ho, 0);
+	log_debug("recorded %u devices\n", ho->count);
+
+	return 0;
+}
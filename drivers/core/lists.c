@@ -18,7 +18,12 @@
 #include <dm/uclass.h>
 #include <dm/util.h>
 #include <fdtdec.h>
+#include <malloc.h>
+#include <asm/global_data.h>
 #include <linux/compiler.h>
+#include <linux/log2.h>
+
+DECLARE_GLOBAL_DATA_PTR;
 
 struct driver *lists_driver_lookup_name(const char *name)
 {
@@ -196,6 +201,137 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
+#if CONFIG_IS_ENABLED(DM_BIND_INDEX)
+/**
+ * struct lists_bind_index - hash table of the compatible strings of drivers
+ *
+ * Each compatible string is recorded once, for the first driver which lists
+ * it, since that is the driver which a linear scan would find.
+ *
+ * @mask: Number of slots minus one, the number being a power of two
+ * @slot: Slots, 0 if empty, else the driver index and of_match index, each
+ *	plus one
+ */
+struct lists_bind_index {
+	uint mask;
+	struct {
+		u16 drv;
+		u16 match;
+	} slot[];
+};
+
+static uint lists_compat_hash(const char *compat)
+{
+	uint hash = 2166136261U;
+
+	while (*compat)
+		hash = (hash ^ (u8)*compat++) * 16777619;
+
+	return hash;
+}
+
+static const char *lists_index_compat(struct driver *driver,
+				      struct lists_bind_index *index, uint i)
+{
+	return driver[index->slot[i].drv - 1].of_match[index->slot[i].match -
+						       1].compatible;
+}
+
+/* Find the slot holding @compat, or the empty slot where it would go */
+static uint lists_index_slot(struct driver *driver,
+			     struct lists_bind_index *index, const char *compat)
+{
+	uint i = lists_compat_hash(compat) & index->mask;
+
+	while (index->slot[i].drv &&
+	       strcmp(lists_index_compat(driver, index, i), compat))
+		i = (i + 1) & index->mask;
+
+	return i;
+}
+
+static struct lists_bind_index *lists_index_build(struct driver *driver,
+						  int n_ents)
+{
+	struct lists_bind_index *index;
+	const struct udevice_id *id;
+	uint count = 0, size;
+	int d, m;
+
+	for (d = 0; d < n_ents; d++) {
+		for (id = driver[d].of_match; id && id->compatible; id++)
+			count++;
+	}
+	if (n_ents >= U16_MAX || count >= U16_MAX)
+		return NULL;
+
+	/* Keep the table at most half full so that lookups are short */
+	size = roundup_pow_of_two(max(count * 2, 2U));
+	index = calloc(1, sizeof(*index) + size * sizeof(index->slot[0]));
+	if (!index)
+		return NULL;
+	index->mask = size - 1;
+
+	for (d = 0; d < n_ents; d++) {
+		id = driver[d].of_match;
+		for (m = 0; id && id[m].compatible; m++) {
+			uint i = lists_index_slot(driver, index,
+						  id[m].compatible);
+
+			if (!index->slot[i].drv) {
+				index->slot[i].drv = d + 1;
+				index->slot[i].match = m + 1;
+			}
+		}
+	}
+	log_debug("indexed %u compatible strings in %u slots\n", count, size);
+
+	return index;
+}
+
+/**
+ * lists_index_lookup() - Look up a compatible string in the index
+ *
+ * The index is built on first use. If there is not enough memory for it,
+ * this returns -ENOSYS and the caller must search the drivers itself.
+ *
+ * @compat: Compatible string to look up
+ * @drvp: Returns the driver which matches @compat
+ * @idp: Returns the of_match entry which matches @compat
+ * Return: 0 if found, -ENOENT if no driver matches, -ENOSYS if there is no
+ * index
+ */
+static int lists_index_lookup(const char *compat, struct driver **drvp,
+			      const struct udevice_id **idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct lists_bind_index *index = gd_dm_bind_index();
+	uint i;
+
+	if (!index) {
+		index = lists_index_build(driver, n_ents);
+		if (!index)
+			return -ENOSYS;
+		gd_set_dm_bind_index(index);
+	}
+
+	i = lists_index_slot(driver, index, compat);
+	if (!index->slot[i].drv)
+		return -ENOENT;
+	*drvp = &driver[index->slot[i].drv - 1];
+	*idp = &(*drvp)->of_match[index->slot[i].match - 1];
+
+	return 0;
+}
+#else
+static int lists_index_lookup(const char *compat, struct driver **drvp,
+			      const struct udevice_id **idp)
+{
+	return -ENOSYS;
+}
+#endif
+
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		   struct driver *drv, bool pre_reloc_only)
 {
@@ -238,20 +374,26 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 			  compat);
 
 		id = NULL;
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			if (drv) {
-				if (drv != entry)
-					continue;
-				if (!entry->of_match)
+		ret = drv ? -ENOSYS : lists_index_lookup(compat, &entry, &id);
+		if (ret == -ENOENT)
+			continue;
+		if (ret) {
+			for (entry = driver; entry != driver + n_ents;
+			     entry++) {
+				if (drv) {
+					if (drv != entry)
+						continue;
+					if (!entry->of_match)
+						break;
+				}
+				ret = driver_check_compatible(entry->of_match,
+							      &id, compat);
+				if (!ret)
 					break;
 			}
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
+			if (entry == driver + n_ents)
+				continue;
 		}
-		if (entry == driver + n_ents)
-			continue;
 
 		if (pre_reloc_only) {
 			if (!ofnode_pre_reloc(node) &&
@@ -25,6 +25,7 @@
 #include <linux/bug.h>
 #include <linux/libfdt.h>
 #include <dm/of_access.h>
+#include <dm/phandle-cache.h>
 #include <dm/util.h>
 #include <linux/ctype.h>
 #include <linux/err.h>
@@ -127,12 +128,15 @@ struct property *of_find_property(const struct device_node *np,
 				  const char *name, int *lenp)
 {
 	struct property *pp;
+	u32 hash;
 
 	if (!np)
 		return NULL;
 
+	hash = of_prop_hash(name);
 	for (pp = np->properties; pp; pp = pp->next) {
-		if (strcmp(pp->name, name) == 0) {
+		if (pp->hash == hash &&
+		    (pp->name == name || !strcmp(pp->name, name))) {
 			if (lenp)
 				*lenp = pp->length;
 			break;
@@ -453,6 +457,10 @@ struct device_node *of_find_node_by_phandle(struct device_node *root,
 	if (!handle)
 		return NULL;
 
+	np = phandle_cache_find_np(root, handle);
+	if (np)
+		return np;
+
 	for_each_of_allnodes_from(root, np)
 		if (np->phandle == handle)
 			break;
@@ -968,12 +976,14 @@ int of_write_prop(struct device_node *np, const char *propname, int len,
 	struct property *pp;
 	struct property *pp_last = NULL;
 	struct property *new;
+	u32 hash;
 
 	if (!np)
 		return -EINVAL;
 
+	hash = of_prop_hash(propname);
 	for (pp = np->properties; pp; pp = pp->next) {
-		if (strcmp(pp->name, propname) == 0) {
+		if (pp->hash == hash && !strcmp(pp->name, propname)) {
 			/* Property exists -> change value */
 			pp->value = (void *)value;
 			pp->length = len;
@@ -995,6 +1005,7 @@ int of_write_prop(struct device_node *np, const char *propname, int len,
 
 	new->value = (void *)value;
 	new->length = len;
+	new->hash = hash;
 	new->next = NULL;
 
 	if (pp_last)
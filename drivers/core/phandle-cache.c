@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Cache of phandle-to-node lookups for the control devicetree
+ *
+ * Resolving a phandle otherwise means walking the whole tree, which happens
+ * for every clock, reset, pinctrl and GPIO reference a driver looks up. The
+ * cache is a hash table of every phandle in the control tree, built once.
+ * It only uses the full malloc(), so that it never points into the
+ * pre-relocation heap.
+ */
+
+#define LOG_CATEGORY	LOGC_DT
+
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <dm/of.h>
+#include <dm/of_access.h>
+#include <dm/ofnode.h>
+#include <dm/phandle-cache.h>
+#include <linux/libfdt.h>
+#include <linux/log2.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct phandle_cache - hash table of the phandles in a tree
+ *
+ * @tree: Root node or flat tree which the table covers
+ * @mask: Number of slots minus one, the number being a power of two
+ * @slot: Slots, with @phandle 0 if empty
+ */
+struct phandle_cache {
+	const void *tree;
+	uint mask;
+	struct {
+		u32 phandle;
+		ofnode node;
+	} slot[];
+};
+
+/* Caches for the live and flat control trees */
+static struct phandle_cache *live_cache, *flat_cache;
+
+static uint phandle_cache_slot(struct phandle_cache *cache, uint phandle)
+{
+	uint i = (phandle * 2654435761U) & cache->mask;
+
+	while (cache->slot[i].phandle && cache->slot[i].phandle != phandle)
+		i = (i + 1) & cache->mask;
+
+	return i;
+}
+
+static struct phandle_cache *phandle_cache_alloc(const void *tree, uint count)
+{
+	struct phandle_cache *cache;
+	uint size;
+
+	/* Keep the table at most half full so that lookups are short */
+	size = roundup_pow_of_two(max(count * 2, 2U));
+	cache = calloc(1, sizeof(*cache) + size * sizeof(cache->slot[0]));
+	if (!cache)
+		return NULL;
+	cache->tree = tree;
+	cache->mask = size - 1;
+	log_debug("%u phandles in %u slots\n", count, size);
+
+	return cache;
+}
+
+/* Record a node, keeping the first one if a phandle is used twice */
+static void phandle_cache_add(struct phandle_cache *cache, uint phandle,
+			      ofnode node)
+{
+	uint i;
+
+	if (!phandle || phandle == (u32)-1)
+		return;
+	i = phandle_cache_slot(cache, phandle);
+	if (!cache->slot[i].phandle) {
+		cache->slot[i].phandle = phandle;
+		cache->slot[i].node = node;
+	}
+}
+
+static bool phandle_cache_usable(void)
+{
+	return gd->flags & GD_FLG_FULL_MALLOC_INIT;
+}
+
+void phandle_cache_drop(const void *tree)
+{
+	if (live_cache && live_cache->tree == tree) {
+		free(live_cache);
+		live_cache = NULL;
+	}
+	if (flat_cache && flat_cache->tree == tree) {
+		free(flat_cache);
+		flat_cache = NULL;
+	}
+}
+
+#if CONFIG_IS_ENABLED(OF_LIVE)
+static struct phandle_cache *phandle_cache_build_live(struct device_node *root)
+{
+	struct phandle_cache *cache;
+	struct device_node *np;
+	uint count = root->phandle ? 1 : 0;
+
+	for_each_of_allnodes_from(root, np) {
+		if (np->phandle)
+			count++;
+	}
+	cache = phandle_cache_alloc(root, count);
+	if (!cache)
+		return NULL;
+
+	phandle_cache_add(cache, root->phandle, np_to_ofnode(root));
+	for_each_of_allnodes_from(root, np)
+		phandle_cache_add(cache, np->phandle, np_to_ofnode(np));
+
+	return cache;
+}
+
+struct device_node *phandle_cache_find_np(struct device_node *root,
+					  uint phandle)
+{
+	struct device_node *np;
+	uint i;
+
+	if (!root)
+		root = gd_of_root();
+	if (!root || root != gd_of_root() || !phandle_cache_usable())
+		return NULL;
+
+	if (!live_cache || live_cache->tree != root) {
+		free(live_cache);
+		live_cache = phandle_cache_build_live(root);
+		if (!live_cache)
+			return NULL;
+	}
+
+	i = phandle_cache_slot(live_cache, phandle);
+	if (!live_cache->slot[i].phandle)
+		return NULL;
+	np = (struct device_node *)ofnode_to_np(live_cache->slot[i].node);
+
+	return np->phandle == phandle ? np : NULL;
+}
+#endif
+
+static struct phandle_cache *phandle_cache_build_fdt(const void *blob)
+{
+	struct phandle_cache *cache;
+	uint count = 0;
+	int offset;
+
+	for (offset = 0; offset >= 0; offset = fdt_next_node(blob, offset, NULL)) {
+		if (fdt_get_phandle(blob, offset))
+			count++;
+	}
+	cache = phandle_cache_alloc(blob, count);
+	if (!cache)
+		return NULL;
+
+	for (offset = 0; offset >= 0; offset = fdt_next_node(blob, offset, NULL))
+		phandle_cache_add(cache, fdt_get_phandle(blob, offset),
+				  offset_to_ofnode(offset));
+
+	return cache;
+}
+
+int phandle_cache_find_offset(const void *blob, uint phandle)
+{
+	int offset;
+	uint i;
+
+	if (blob != gd->fdt_blob || !phandle_cache_usable())
+		return -ENOENT;
+
+	if (!flat_cache || flat_cache->tree != blob) {
+		free(flat_cache);
+		flat_cache = phandle_cache_build_fdt(blob);
+		if (!flat_cache)
+			return -ENOENT;
+	}
+
+	i = phandle_cache_slot(flat_cache, phandle);
+	if (!flat_cache->slot[i].phandle)
+		return -ENOENT;
+	offset = ofnode_to_offset(flat_cache->slot[i].node);
+
+	/* The blob may have been changed since, so check the entry */
+	if (fdt_get_phandle(blob, offset) != phandle)
+		return -ENOENT;
+
+	return offset;
+}
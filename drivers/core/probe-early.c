@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Early probing of devices, ordered by their dependencies
+ *
+ * Devices are normally probed one at a time, when first used, so a device
+ * which spends a long time waiting for its hardware (link training, hub
+ * enumeration, card power-up) holds up everything after it. This pass probes
+ * the devices marked for probe-after-bind in dependency order, starting each
+ * one as soon as the devices it needs are ready. Drivers which split their
+ * probe into probe() and probe_finish() are left pending while other devices
+ * are started, so their waits overlap without needing threads.
+ */
+
+#define LOG_CATEGORY	LOGC_DM
+
+#include <bootstage.h>
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <dm/device.h>
+#include <dm/device-internal.h>
+#include <dm/ofnode.h>
+#include <dm/root.h>
+#include <linux/list.h>
+#include <linux/string.h>
+
+/* Most devices that one device is recorded as depending on */
+#define PROBE_EARLY_MAX_DEPS	8
+
+enum probe_early_state {
+	PROBE_EARLY_WAITING,
+	PROBE_EARLY_PENDING,
+	PROBE_EARLY_DONE,
+};
+
+/**
+ * struct probe_early_dev - a device to be probed by the early pass
+ *
+ * @dev: Device to probe
+ * @state: Progress of the probe
+ * @order: Position of this device in the order in which probes were started
+ * @start_us: Time when the probe was started, for bootstage
+ * @dep_count: Number of valid entries in @dep
+ * @dep: Devices which must be probed before this one is started
+ */
+struct probe_early_dev {
+	struct udevice *dev;
+	enum probe_early_state state;
+	int order;
+	ulong start_us;
+	int dep_count;
+	struct udevice *dep[PROBE_EARLY_MAX_DEPS];
+};
+
+/* Properties holding phandles of devices which a device uses */
+static const struct {
+	const char *name;
+	const char *cells;
+} probe_early_props[] = {
+	{ "clocks", "#clock-cells" },
+	{ "resets", "#reset-cells" },
+	{ "power-domains", "#power-domain-cells" },
+	{ "phys", "#phy-cells" },
+	{ "pinctrl-0", NULL },
+};
+
+static void probe_early_add_dep(struct probe_early_dev *ped, ofnode node)
+{
+	struct udevice *dep;
+	int i;
+
+	if (device_find_global_by_ofnode(node, &dep) || dep == ped->dev)
+		return;
+	for (i = 0; i < ped->dep_count; i++) {
+		if (ped->dep[i] == dep)
+			return;
+	}
+	if (ped->dep_count == PROBE_EARLY_MAX_DEPS) {
+		log_debug("%s: too many dependencies\n", ped->dev->name);
+		return;
+	}
+	ped->dep[ped->dep_count++] = dep;
+}
+
+/* Record the parent and the devices referred to by phandles */
+static void probe_early_find_deps(struct probe_early_dev *ped)
+{
+	ofnode node = dev_ofnode(ped->dev);
+	struct ofprop prop;
+	int i, j;
+
+	if (ped->dev->parent)
+		ped->dep[ped->dep_count++] = ped->dev->parent;
+	if (!ofnode_valid(node))
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(probe_early_props); i++) {
+		const char *name = probe_early_props[i].name;
+		const char *cells = probe_early_props[i].cells;
+		struct ofnode_phandle_args args;
+
+		for (j = 0; ; j++) {
+			if (ofnode_parse_phandle_with_args(node, name, cells, 0,
+							   j, &args))
+				break;
+			probe_early_add_dep(ped, args.node);
+		}
+	}
+
+	/* Regulators are referred to by '<name>-supply' properties */
+	ofnode_for_each_prop(prop, node) {
+		const char *name;
+		int len;
+
+		if (!ofprop_get_property(&prop, &name, &len))
+			continue;
+		len = strlen(name);
+		if (len > 7 && !strcmp(name + len - 7, "-supply"))
+			probe_early_add_dep(ped,
+					    ofnode_parse_phandle(node, name, 0));
+	}
+}
+
+/*
+ * A dependency blocks a device if it is pending, or if it is still waiting
+ * to be started by this pass
+ */
+static bool probe_early_blocked(struct probe_early_dev *ped)
+{
+	int i;
+
+	for (i = 0; i < ped->dep_count; i++) {
+		u32 flags = dev_get_flags(ped->dep[i]);
+
+		if (flags & DM_FLAG_PROBE_PENDING)
+			return true;
+		if ((flags & DM_FLAG_PROBE_AFTER_BIND) &&
+		    !(flags & DM_FLAG_ACTIVATED))
+			return true;
+	}
+
+	return false;
+}
+
+static int probe_early_count(struct udevice *dev)
+{
+	struct udevice *child;
+	int count = 0;
+
+	if (dev_get_flags(dev) & DM_FLAG_PROBE_AFTER_BIND)
+		count++;
+	list_for_each_entry(child, &dev->child_head, sibling_node)
+		count += probe_early_count(child);
+
+	return count;
+}
+
+static void probe_early_collect(struct udevice *dev,
+				struct probe_early_dev **pedp)
+{
+	struct udevice *child;
+
+	if (dev_get_flags(dev) & DM_FLAG_PROBE_AFTER_BIND) {
+		(*pedp)->dev = dev;
+		probe_early_find_deps(*pedp);
+		(*pedp)++;
+	}
+	list_for_each_entry(child, &dev->child_head, sibling_node)
+		probe_early_collect(child, pedp);
+}
+
+static void probe_early_begin(struct probe_early_dev *ped, int order)
+{
+	int ret;
+
+	log_debug("begin %s\n", ped->dev->name);
+	ped->order = order;
+	ped->start_us = bootstage_prof_start();
+	ret = device_probe_begin(ped->dev);
+	if (ret) {
+		log_debug("%s: probe failed (err=%d)\n", ped->dev->name, ret);
+		ped->state = PROBE_EARLY_DONE;
+	} else if (dev_get_flags(ped->dev) & DM_FLAG_PROBE_PENDING) {
+		ped->state = PROBE_EARLY_PENDING;
+	} else {
+		ped->state = PROBE_EARLY_DONE;
+		bootstage_prof_add(BOOTSTAGE_PROF_PROBE, ped->dev->name,
+				   ped->start_us, 0);
+	}
+}
+
+static void probe_early_finish(struct probe_early_dev *ped)
+{
+	int ret;
+
+	log_debug("finish %s\n", ped->dev->name);
+	ret = device_probe_finish(ped->dev);
+	if (ret)
+		log_debug("%s: probe failed (err=%d)\n", ped->dev->name, ret);
+	else
+		bootstage_prof_add(BOOTSTAGE_PROF_PROBE, ped->dev->name,
+				   ped->start_us, 0);
+	ped->state = PROBE_EARLY_DONE;
+}
+
+int dm_probe_early(struct udevice *parent)
+{
+	struct probe_early_dev *list, *ped, *end;
+	int count, order = 0;
+
+	count = probe_early_count(parent);
+	if (!count)
+		return 0;
+	list = calloc(count, sizeof(*list));
+	if (!list)
+		return log_msg_ret("pea", -ENOMEM);
+	ped = list;
+	probe_early_collect(parent, &ped);
+	end = list + count;
+
+	while (true) {
+		struct probe_early_dev *pending = NULL, *waiting = NULL;
+		bool started = false;
+
+		/* Start everything whose dependencies are ready */
+		for (ped = list; ped < end; ped++) {
+			if (ped->state != PROBE_EARLY_WAITING)
+				continue;
+			if (!probe_early_blocked(ped)) {
+				probe_early_begin(ped, order++);
+				started = true;
+			} else if (!waiting) {
+				waiting = ped;
+			}
+		}
+		if (started)
+			continue;
+
+		/*
+		 * Nothing could be started, so wait for the device pending
+		 * longest, being the one most likely to be ready by now
+		 */
+		for (ped = list; ped < end; ped++) {
+			if (ped->state == PROBE_EARLY_PENDING &&
+			    (!pending || ped->order < pending->order))
+				pending = ped;
+		}
+		if (pending) {
+			probe_early_finish(pending);
+			continue;
+		}
+
+		/*
+		 * Anything left waits on a device outside this pass or is part
+		 * of a loop. Start it anyway and let its probe() method sort
+		 * out the order, as happens when probing lazily.
+		 */
+		if (!waiting)
+			break;
+		probe_early_begin(waiting, order++);
+	}
+	free(list);
+
+	return 0;
+}
@@ -319,7 +319,10 @@ int dm_autoprobe(void)
 {
 	int ret;
 
-	ret = dm_probe_devices(gd->dm_root);
+	if (CONFIG_IS_ENABLED(DM_PROBE_EARLY))
+		ret = dm_probe_early(gd->dm_root);
+	else
+		ret = dm_probe_devices(gd->dm_root);
 	if (ret)
 		return log_msg_ret("pro", ret);
 
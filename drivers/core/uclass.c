@@ -19,9 +19,148 @@
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
+#include <linux/log2.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+/* Uclasses with fewer devices than this are searched linearly */
+#define UCLASS_INDEX_MIN	8
+
+/**
+ * struct uclass_index - lookup tables for the devices in a uclass
+ *
+ * Each table is an open-addressing hash table of devices, keyed by sequence
+ * number, name or ofnode. Devices are added in uclass order and removed only
+ * by rebuilding, so where several devices share a key the first one found is
+ * the first in the uclass, as with a linear search.
+ *
+ * @valid: true if the tables match the devices in the uclass
+ * @mask: Number of slots in each table minus one, a power of two minus one
+ * @seq: Table keyed by sequence number
+ * @name: Table keyed by name
+ * @node: Table keyed by ofnode
+ */
+struct uclass_index {
+	bool valid;
+	uint mask;
+	struct udevice **seq;
+	struct udevice **name;
+	struct udevice **node;
+};
+
+static uint uclass_index_hash_int(ulong val)
+{
+	return val * 2654435761U;
+}
+
+static uint uclass_index_hash_str(const char *str, int len)
+{
+	uint hash = 2166136261U;
+
+	while (len--)
+		hash = (hash ^ (u8)*str++) * 16777619;
+
+	return hash;
+}
+
+static void uclass_index_add(struct uclass_index *idx,
+			     struct udevice **table, uint hash,
+			     struct udevice *dev)
+{
+	uint i = hash & idx->mask;
+
+	while (table[i])
+		i = (i + 1) & idx->mask;
+	table[i] = dev;
+}
+
+void uclass_index_invalidate(struct uclass *uc)
+{
+	if (uc && uc->index)
+		uc->index->valid = false;
+}
+
+/**
+ * uclass_index_get() - Get the lookup tables for a uclass
+ *
+ * The tables are built, or rebuilt if the devices have changed since, when
+ * needed.
+ *
+ * @uc: uclass to look up devices in
+ * Return: tables, or NULL to search the uclass linearly
+ */
+static struct uclass_index *uclass_index_get(struct uclass *uc)
+{
+	struct uclass_index *idx = uc->index;
+	struct udevice *dev;
+	uint count = 0, size;
+
+	if (idx && idx->valid)
+		return idx;
+
+	list_for_each_entry(dev, &uc->dev_head, uclass_node)
+		count++;
+	if (count < UCLASS_INDEX_MIN)
+		return NULL;
+
+	/*
+	 * Keep the tables at most half full. Memory is only allocated again
+	 * when the uclass has grown, since it is not freed before relocation
+	 */
+	size = roundup_pow_of_two(count * 2);
+	if (!idx || size > idx->mask + 1) {
+		struct uclass_index *new;
+
+		new = malloc(sizeof(*new) + 3 * size * sizeof(dev));
+		if (!new)
+			return NULL;
+		free(idx);
+		idx = new;
+		idx->mask = size - 1;
+		idx->seq = (struct udevice **)(idx + 1);
+		idx->name = idx->seq + size;
+		idx->node = idx->name + size;
+		uc->index = idx;
+	}
+	size = idx->mask + 1;
+	memset(idx->seq, '\0', 3 * size * sizeof(dev));
+
+	list_for_each_entry(dev, &uc->dev_head, uclass_node) {
+		if (dev->seq_ != -1)
+			uclass_index_add(idx, idx->seq,
+					 uclass_index_hash_int(dev->seq_), dev);
+		uclass_index_add(idx, idx->name,
+				 uclass_index_hash_str(dev->name,
+						       strlen(dev->name)),
+				 dev);
+		if (dev_has_ofnode(dev))
+			uclass_index_add(idx, idx->node,
+					 uclass_index_hash_int(
+						dev_ofnode(dev).of_offset),
+					 dev);
+	}
+	idx->valid = true;
+
+	return idx;
+}
+
+static void uclass_index_free(struct uclass *uc)
+{
+	free(uc->index);
+	uc->index = NULL;
+}
+#else
+static struct uclass_index *uclass_index_get(struct uclass *uc)
+{
+	return NULL;
+}
+
+static void uclass_index_free(struct uclass *uc)
+{
+}
+#endif
+
 struct uclass *uclass_find(enum uclass_id key)
 {
 	struct uclass *uc;
@@ -136,6 +275,7 @@ int uclass_destroy(struct uclass *uc)
 	list_del(&uc->sibling_node);
 	if (uc_drv->priv_auto)
 		free(uclass_get_priv(uc));
+	uclass_index_free(uc);
 	free(uc);
 
 	return 0;
@@ -276,6 +416,7 @@ int uclass_find_next_device(struct udevice **devp)
 int uclass_find_device_by_namelen(enum uclass_id id, const char *name, int len,
 				  struct udevice **devp)
 {
+	struct uclass_index *idx;
 	struct uclass *uc;
 	struct udevice *dev;
 	int ret;
@@ -287,6 +428,21 @@ int uclass_find_device_by_namelen(enum uclass_id id, const char *name, int len,
 	if (ret)
 		return ret;
 
+	idx = uclass_index_get(uc);
+	if (idx) {
+		uint i = uclass_index_hash_str(name, len) & idx->mask;
+
+		for (; (dev = idx->name[i]); i = (i + 1) & idx->mask) {
+			if (!strncmp(dev->name, name, len) &&
+			    strlen(dev->name) == len) {
+				*devp = dev;
+				return 0;
+			}
+		}
+
+		return -ENODEV;
+	}
+
 	uclass_foreach_dev(dev, uc) {
 		if (!strncmp(dev->name, name, len) &&
 		    strlen(dev->name) == len) {
@@ -340,6 +496,7 @@ int uclass_find_next_free_seq(struct uclass *uc)
 
 int uclass_find_device_by_seq(enum uclass_id id, int seq, struct udevice **devp)
 {
+	struct uclass_index *idx;
 	struct uclass *uc;
 	struct udevice *dev;
 	int ret;
@@ -352,6 +509,20 @@ int uclass_find_device_by_seq(enum uclass_id id, int seq, struct udevice **devp)
 	if (ret)
 		return ret;
 
+	idx = uclass_index_get(uc);
+	if (idx) {
+		uint i = uclass_index_hash_int(seq) & idx->mask;
+
+		for (; (dev = idx->seq[i]); i = (i + 1) & idx->mask) {
+			if (dev->seq_ == seq) {
+				*devp = dev;
+				return 0;
+			}
+		}
+
+		return -ENODEV;
+	}
+
 	uclass_foreach_dev(dev, uc) {
 		log_debug("   - %d '%s'\n", dev->seq_, dev->name);
 		if (dev->seq_ == seq) {
@@ -392,6 +563,7 @@ int uclass_find_device_by_of_offset(enum uclass_id id, int node,
 int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 				 struct udevice **devp)
 {
+	struct uclass_index *idx;
 	struct uclass *uc;
 	struct udevice *dev;
 	int ret;
@@ -404,6 +576,20 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	if (ret)
 		return ret;
 
+	idx = uclass_index_get(uc);
+	if (idx) {
+		uint i = uclass_index_hash_int(node.of_offset) & idx->mask;
+
+		for (; (dev = idx->node[i]); i = (i + 1) & idx->mask) {
+			if (ofnode_equal(dev_ofnode(dev), node)) {
+				*devp = dev;
+				goto done;
+			}
+		}
+		ret = -ENODEV;
+		goto done;
+	}
+
 	uclass_foreach_dev(dev, uc) {
 		log(LOGC_DM, LOGL_DEBUG_CONTENT, "      - checking %s\n",
 		    dev->name);
@@ -704,6 +890,7 @@ int uclass_bind_device(struct udevice *dev)
 
 	uc = dev->uclass;
 	list_add_tail(&dev->uclass_node, &uc->dev_head);
+	uclass_index_invalidate(uc);
 
 	if (dev->parent) {
 		struct uclass_driver *uc_drv = dev->parent->uclass->uc_drv;
@@ -719,6 +906,7 @@ int uclass_bind_device(struct udevice *dev)
 err:
 	/* There is no need to undo the parent's post_bind call */
 	list_del(&dev->uclass_node);
+	uclass_index_invalidate(uc);
 
 	return ret;
 }
@@ -742,6 +930,7 @@ int uclass_pre_unbind_device(struct udevice *dev)
 int uclass_unbind_device(struct udevice *dev)
 {
 	list_del(&dev->uclass_node);
+	uclass_index_invalidate(dev->uclass);
 
 	return 0;
 }
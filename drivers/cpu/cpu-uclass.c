@@ -114,6 +114,48 @@ int cpu_release_core(const struct udevice *dev, phys_addr_t addr)
 	return ops->release_core(dev, addr);
 }
 
+int cpu_run_jobs(struct cpu_job *jobs, int count)
+{
+	struct udevice *cur = cpu_get_current_dev();
+	struct udevice *cpu;
+	int ret = 0;
+	int done, i;
+
+	for (done = 0; done < count; ) {
+		i = done;
+
+		/* Hand a job to each parked core, keeping the last for us */
+		uclass_foreach_dev_probe(UCLASS_CPU, cpu) {
+			struct cpu_ops *ops = cpu_get_ops(cpu);
+
+			if (i == count - 1)
+				break;
+			if (cpu == cur || !ops->start_job || !ops->wait_job)
+				continue;
+			if (ops->start_job(cpu, jobs[i].func, jobs[i].arg))
+				continue;
+			jobs[i++].dev = cpu;
+		}
+
+		jobs[i].dev = NULL;
+		jobs[i].func(jobs[i].arg);
+
+		for (; done < i; done++) {
+			int err = cpu_get_ops(jobs[done].dev)->wait_job(jobs[done].dev);
+
+			if (err) {
+				log_err("CPU %s failed its job (err=%dE)\n",
+					jobs[done].dev->name, err);
+				if (!ret)
+					ret = err;
+			}
+		}
+		done++;
+	}
+
+	return ret;
+}
+
 U_BOOT_DRIVER(cpu_bus) = {
 	.name	= "cpu_bus",
 	.id	= UCLASS_SIMPLE_BUS,
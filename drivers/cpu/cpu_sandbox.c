@@ -49,6 +49,20 @@ static int cpu_sandbox_release_core(const struct udevice *dev, phys_addr_t addr)
 	return 0;
 }
 
+/* Sandbox has a single thread, so run the job straight away */
+static int cpu_sandbox_start_job(struct udevice *dev, void (*func)(void *arg),
+				 void *arg)
+{
+	func(arg);
+
+	return 0;
+}
+
+static int cpu_sandbox_wait_job(struct udevice *dev)
+{
+	return 0;
+}
+
 static int cpu_sandbox_is_current(struct udevice *dev)
 {
 	if (!strcmp(dev->name, cpu_current))
@@ -64,6 +78,8 @@ static const struct cpu_ops cpu_sandbox_ops = {
 	.get_vendor = cpu_sandbox_get_vendor,
 	.is_current = cpu_sandbox_is_current,
 	.release_core = cpu_sandbox_release_core,
+	.start_job = cpu_sandbox_start_job,
+	.wait_job = cpu_sandbox_wait_job,
 };
 
 static int cpu_sandbox_bind(struct udevice *dev)
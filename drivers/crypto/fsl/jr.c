@@ -831,7 +831,7 @@ int sec_init(void)
 static int jr_power_on(ofnode node)
 {
 #if CONFIG_IS_ENABLED(POWER_DOMAIN)
-	struct udevice __maybe_unused jr_dev;
+	struct udevice __maybe_unused jr_dev = { };
 	struct power_domain pd;
 
 	dev_set_ofnode(&jr_dev, node);
@@ -11,6 +11,7 @@
 #include <u-boot/hash.h>
 #include <errno.h>
 #include <fdtdec.h>
+#include <log.h>
 #include <malloc.h>
 #include <asm/io.h>
 #include <linux/list.h>
@@ -84,6 +85,26 @@ int hash_digest_wd(struct udevice *dev, enum HASH_ALGO algo,
 	return ops->hash_digest_wd(dev, algo, ibuf, ilen, obuf, chunk_sz);
 }
 
+int hash_digest_by_name(const char *name, const void *ibuf,
+			const uint32_t ilen, void *obuf, uint32_t chunk_sz)
+{
+	enum HASH_ALGO algo;
+	struct udevice *dev;
+	int ret;
+
+	algo = hash_algo_lookup_by_name(name);
+	if (algo == HASH_ALGO_INVALID)
+		return log_msg_ret("alg", -EPROTONOSUPPORT);
+	ret = uclass_first_device_err(UCLASS_HASH, &dev);
+	if (ret)
+		return log_msg_ret("dev", ret);
+	ret = hash_digest_wd(dev, algo, ibuf, ilen, obuf, chunk_sz);
+	if (ret)
+		return log_msg_ret("dig", ret);
+
+	return hash_info[algo].digest_size;
+}
+
 int hash_init(struct udevice *dev, enum HASH_ALGO algo, void **ctxp)
 {
 	struct hash_ops *ops = (struct hash_ops *)device_get_ops(dev);
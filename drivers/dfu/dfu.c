@@ -14,6 +14,7 @@
 #include <fat.h>
 #include <dfu.h>
 #include <hash.h>
+#include <time.h>
 #include <linux/list.h>
 #include <linux/compiler.h>
 #include <linux/printk.h>
@@ -260,14 +261,19 @@ static char *dfu_get_hash_algo(void)
 
 static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 {
+	ulong start;
 	long w_size;
 	int ret;
 
+	dfu->drain_pending = 0;
+
 	/* flush size? */
 	w_size = dfu->i_buf - dfu->i_buf_start;
 	if (w_size == 0)
 		return 0;
 
+	start = get_timer(0);
+
 	if (dfu_hash_algo)
 		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc,
 					   dfu->i_buf_start, w_size, 0);
@@ -282,6 +288,8 @@ static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 	/* update offset */
 	dfu->offset += w_size;
 
+	dfu->drain_time = get_timer(start);
+
 	puts("#");
 
 	return ret;
@@ -300,6 +308,7 @@ void dfu_transaction_cleanup(struct dfu_entity *dfu)
 	dfu->b_left = 0;
 	dfu->bad_skip = 0;
 
+	dfu->drain_pending = 0;
 	dfu->inited = 0;
 }
 
@@ -412,6 +421,12 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 
 	/* if end or if buffer full flush */
 	if (size == 0 || (dfu->i_buf + size) > dfu->i_buf_end) {
+		if (size && dfu->defer_drain) {
+			/* left to the caller, see dfu_write_drain() */
+			dfu->drain_pending = 1;
+			return 0;
+		}
+
 		ret = dfu_write_buffer_drain(dfu);
 		if (ret) {
 			dfu_transaction_cleanup(dfu);
@@ -423,6 +438,22 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	return 0;
 }
 
+int dfu_write_drain(struct dfu_entity *dfu)
+{
+	int ret;
+
+	if (!dfu->drain_pending)
+		return 0;
+
+	ret = dfu_write_buffer_drain(dfu);
+	if (ret) {
+		dfu_transaction_cleanup(dfu);
+		dfu_error_callback(dfu, "DFU write error");
+	}
+
+	return ret;
+}
+
 static int dfu_read_buffer_fill(struct dfu_entity *dfu, void *buf, int size)
 {
 	long chunk;
@@ -742,7 +773,8 @@ int dfu_get_alt(char *name)
 	return -ENODEV;
 }
 
-int dfu_write_from_mem_addr(struct dfu_entity *dfu, void *buf, int size)
+int dfu_write_from_mem_addr_hash(struct dfu_entity *dfu, void *buf, int size,
+				 struct hash_algo *algo, void *ctx)
 {
 	unsigned long dfu_buf_size, write, left = size;
 	int i, ret = 0;
@@ -762,6 +794,11 @@ int dfu_write_from_mem_addr(struct dfu_entity *dfu, void *buf, int size)
 
 		debug("%s: dp: 0x%p left: %lu write: %lu\n", __func__,
 		      dp, left, write);
+		if (algo) {
+			ret = algo->hash_update(algo, ctx, dp, write, 0);
+			if (ret)
+				return ret;
+		}
 		ret = dfu_write(dfu, dp, write, i);
 		if (ret) {
 			pr_err("DFU write failed\n");
@@ -779,3 +816,8 @@ int dfu_write_from_mem_addr(struct dfu_entity *dfu, void *buf, int size)
 
 	return ret;
 }
+
+int dfu_write_from_mem_addr(struct dfu_entity *dfu, void *buf, int size)
+{
+	return dfu_write_from_mem_addr_hash(dfu, buf, size, NULL, NULL);
+}
@@ -77,20 +77,23 @@ done:
 }
 
 /**
- * dfu_write_by_alt() - write data to DFU medium
+ * dfu_write_by_alt_hash() - write data to DFU medium and hash it
  * @dfu_alt_num:        DFU alt setting number
  * @addr:               Address of data buffer to write
  * @len:                Number of bytes
  * @interface:          Destination DFU medium (e.g. "mmc")
  * @devstring:          Instance number of destination DFU medium (e.g. "1")
+ * @algo:               Hash algorithm to update with the data, or NULL
+ * @ctx:                Context for @algo
  *
  * This function is storing data received on DFU supported medium which
  * is specified by @dfu_alt_name.
  *
  * Return:              0 - on success, error code - otherwise
  */
-int dfu_write_by_alt(int dfu_alt_num, void *addr, unsigned int len,
-		     char *interface, char *devstring)
+int dfu_write_by_alt_hash(int dfu_alt_num, void *addr, unsigned int len,
+			  char *interface, char *devstring,
+			  struct hash_algo *algo, void *ctx)
 {
 	struct dfu_entity *dfu;
 	int ret;
@@ -115,10 +118,31 @@ int dfu_write_by_alt(int dfu_alt_num, void *addr, unsigned int len,
 		goto done;
 	}
 
-	ret = dfu_write_from_mem_addr(dfu, (void *)(uintptr_t)addr, len);
+	ret = dfu_write_from_mem_addr_hash(dfu, (void *)(uintptr_t)addr, len,
+					   algo, ctx);
 
 done:
 	dfu_free_entities();
 
 	return ret;
 }
+
+/**
+ * dfu_write_by_alt() - write data to DFU medium
+ * @dfu_alt_num:        DFU alt setting number
+ * @addr:               Address of data buffer to write
+ * @len:                Number of bytes
+ * @interface:          Destination DFU medium (e.g. "mmc")
+ * @devstring:          Instance number of destination DFU medium (e.g. "1")
+ *
+ * This function is storing data received on DFU supported medium which
+ * is specified by @dfu_alt_name.
+ *
+ * Return:              0 - on success, error code - otherwise
+ */
+int dfu_write_by_alt(int dfu_alt_num, void *addr, unsigned int len,
+		     char *interface, char *devstring)
+{
+	return dfu_write_by_alt_hash(dfu_alt_num, addr, len, interface,
+				     devstring, NULL, NULL);
+}
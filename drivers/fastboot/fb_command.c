@@ -10,6 +10,7 @@
 #include <fastboot-internal.h>
 #include <fb_mmc.h>
 #include <fb_nand.h>
+#include <image-sparse.h>
 #include <part.h>
 #include <stdlib.h>
 #include <vsprintf.h>
@@ -30,6 +31,27 @@ static u32 fastboot_bytes_received;
  */
 static u32 fastboot_bytes_expected;
 
+/**
+ * struct fastboot_stream - state of 'oem stream'
+ *
+ * @storage: Storage of the partition to write to
+ * @stream: Image being written
+ * @part: Name of the partition
+ * @response: Failure to report at the end of the download
+ * @armed: The next download is to be written to @part
+ * @active: The current download is being written to @part
+ * @done: The last download was written to @part
+ */
+static struct fastboot_stream {
+	struct sparse_storage storage;
+	struct sparse_stream stream;
+	char part[FASTBOOT_COMMAND_LEN];
+	char response[FASTBOOT_RESPONSE_LEN];
+	bool armed;
+	bool active;
+	bool done;
+} fastboot_stream;
+
 static void okay(char *, char *);
 static void getvar(char *, char *);
 static void download(char *, char *);
@@ -43,6 +65,7 @@ static void oem_partconf(char *, char *);
 static void oem_bootbus(char *, char *);
 static void oem_console(char *, char *);
 static void oem_board(char *, char *);
+static void oem_stream(char *, char *);
 static void run_ucmd(char *, char *);
 static void run_acmd(char *, char *);
 
@@ -118,6 +141,10 @@ static const struct {
 		.command = "oem board",
 		.dispatch = CONFIG_IS_ENABLED(FASTBOOT_OEM_BOARD, (oem_board), (NULL))
 	},
+	[FASTBOOT_COMMAND_OEM_STREAM] = {
+		.command = "oem stream",
+		.dispatch = CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM, (oem_stream), (NULL))
+	},
 	[FASTBOOT_COMMAND_UCMD] = {
 		.command = "UCmd",
 		.dispatch = CONFIG_IS_ENABLED(FASTBOOT_UUU_SUPPORT, (run_ucmd), (NULL))
@@ -244,7 +271,19 @@ static void download(char *cmd_parameter, char *response)
 	 *
 	 * where cmd_parameter is an 8 digit hexadecimal number
 	 */
-	if (fastboot_bytes_expected > fastboot_buf_size) {
+	fastboot_stream.done = false;
+	if (CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM) && fastboot_stream.armed) {
+		fastboot_stream.armed = false;
+		if (sparse_stream_init(&fastboot_stream.stream,
+				       &fastboot_stream.storage,
+				       fastboot_stream.part, response))
+			return;
+		fastboot_stream.response[0] = '\0';
+		fastboot_stream.active = true;
+		printf("Starting download of %d bytes to '%s'\n",
+		       fastboot_bytes_expected, fastboot_stream.part);
+		fastboot_response("DATA", response, "%s", cmd_parameter);
+	} else if (fastboot_bytes_expected > fastboot_buf_size) {
 		fastboot_fail(cmd_parameter, response);
 	} else {
 		printf("Starting download of %d bytes\n",
@@ -263,6 +302,21 @@ u32 fastboot_data_remaining(void)
 	return fastboot_bytes_expected - fastboot_bytes_received;
 }
 
+/**
+ * fastboot_data_buf() - return where the next downloaded data goes
+ *
+ * Return: Pointer into fastboot_buf_addr for the next byte of the current
+ * download, or NULL if the download is streamed to a partition
+ */
+void *fastboot_data_buf(void)
+{
+	if (CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM) &&
+	    fastboot_stream.active)
+		return NULL;
+
+	return fastboot_buf_addr + fastboot_bytes_received;
+}
+
 /**
  * fastboot_data_download() - Copy image data to fastboot_buf_addr.
  *
@@ -272,7 +326,8 @@ u32 fastboot_data_remaining(void)
  *
  * Copies image data from fastboot_data to fastboot_buf_addr. Writes to
  * response. fastboot_bytes_received is updated to indicate the number
- * of bytes that have been transferred.
+ * of bytes that have been transferred. Nothing is copied if the data has been
+ * received in place, at fastboot_data_buf().
  *
  * On completion sets image_size and ${filesize} to the total size of the
  * downloaded image.
@@ -291,9 +346,25 @@ void fastboot_data_download(const void *fastboot_data,
 			      response);
 		return;
 	}
-	/* Download data to fastboot_buf_addr */
-	memcpy(fastboot_buf_addr + fastboot_bytes_received,
-	       fastboot_data, fastboot_data_len);
+	if (CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM) &&
+	    fastboot_stream.active) {
+		/* Write data to the partition as it arrives */
+		if (sparse_stream_write(&fastboot_stream.stream, fastboot_data,
+					fastboot_data_len, response) &&
+		    *response) {
+			/*
+			 * The client only reads a response once it has sent
+			 * everything, so report the failure then
+			 */
+			strlcpy(fastboot_stream.response, response,
+				sizeof(fastboot_stream.response));
+		}
+	} else if (fastboot_data !=
+		   fastboot_buf_addr + fastboot_bytes_received) {
+		/* Download data to fastboot_buf_addr */
+		memcpy(fastboot_buf_addr + fastboot_bytes_received,
+		       fastboot_data, fastboot_data_len);
+	}
 
 	pre_dot_num = fastboot_bytes_received / BYTES_PER_DOT;
 	fastboot_bytes_received += fastboot_data_len;
@@ -316,10 +387,26 @@ void fastboot_data_download(const void *fastboot_data,
  */
 void fastboot_data_complete(char *response)
 {
+	image_size = fastboot_bytes_received;
+	if (CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM) &&
+	    fastboot_stream.active) {
+		fastboot_stream.active = false;
+		if (sparse_stream_finish(&fastboot_stream.stream, response)) {
+			if (fastboot_stream.response[0])
+				strlcpy(response, fastboot_stream.response,
+					FASTBOOT_RESPONSE_LEN);
+			fastboot_bytes_expected = 0;
+			fastboot_bytes_received = 0;
+			return;
+		}
+		/* Nothing is left in the buffer for a flash command */
+		fastboot_stream.done = true;
+		image_size = 0;
+	}
+
 	/* Download complete. Respond with "OKAY" */
 	fastboot_okay(NULL, response);
 	printf("\ndownloading of %d bytes finished\n", fastboot_bytes_received);
-	image_size = fastboot_bytes_received;
 	env_set_hex("filesize", image_size);
 	fastboot_bytes_expected = 0;
 	fastboot_bytes_received = 0;
@@ -336,6 +423,17 @@ void fastboot_data_complete(char *response)
  */
 static void __maybe_unused flash(char *cmd_parameter, char *response)
 {
+	if (CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM) && fastboot_stream.done) {
+		/* The image was written while it was downloaded */
+		fastboot_stream.done = false;
+		if (strcmp(cmd_parameter, fastboot_stream.part))
+			fastboot_fail("image was streamed to another partition",
+				      response);
+		else
+			fastboot_okay(NULL, response);
+		return;
+	}
+
 	if (IS_ENABLED(CONFIG_FASTBOOT_FLASH_MMC))
 		fastboot_mmc_flash_write(cmd_parameter, fastboot_buf_addr,
 					 image_size, response);
@@ -572,3 +670,29 @@ static void __maybe_unused oem_board(char *cmd_parameter, char *response)
 {
 	fastboot_oem_board(cmd_parameter, (void *)fastboot_buf_addr, image_size, response);
 }
+
+/**
+ * oem_stream() - Execute the OEM stream command
+ *
+ * @cmd_parameter: Pointer to command parameter
+ * @response: Pointer to fastboot response buffer
+ *
+ * Arranges for the next download to be written to the partition named by
+ * cmd_parameter as it arrives. A following flash command for the same
+ * partition then just reports success.
+ */
+static void __maybe_unused oem_stream(char *cmd_parameter, char *response)
+{
+	if (!cmd_parameter || !*cmd_parameter) {
+		fastboot_fail("Expected partition name", response);
+		return;
+	}
+	if (fastboot_mmc_stream_open(cmd_parameter, &fastboot_stream.storage,
+				     response))
+		return;
+
+	strlcpy(fastboot_stream.part, cmd_parameter,
+		sizeof(fastboot_stream.part));
+	fastboot_stream.armed = true;
+	fastboot_okay(NULL, response);
+}
@@ -164,6 +164,32 @@ static lbaint_t fb_mmc_sparse_reserve(struct sparse_storage *info,
 	return blkcnt;
 }
 
+/*
+ * Erase blocks which are to be zero, rather than writing them, where that
+ * leaves them reading as zero and is possible without touching other blocks
+ */
+static lbaint_t fb_mmc_sparse_erase(struct sparse_storage *info,
+		lbaint_t blk, lbaint_t blkcnt)
+{
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	struct fb_mmc_sparse *sparse = info->priv;
+	struct blk_desc *dev_desc = sparse->dev_desc;
+	struct mmc *mmc = find_mmc_device(dev_desc->devnum);
+
+	if (!mmc || IS_SD(mmc) || !mmc->erase_zeroes ||
+	    blkcnt < mmc->erase_grp_size)
+		return 0;
+	/* Without trim, erase works on whole erase groups */
+	if (!mmc->can_trim && (blk % mmc->erase_grp_size ||
+			       blkcnt % mmc->erase_grp_size))
+		return 0;
+
+	return fb_mmc_blk_write(dev_desc, blk, blkcnt, NULL);
+#else
+	return 0;
+#endif
+}
+
 static void write_raw_image(struct blk_desc *dev_desc,
 			    struct disk_partition *info, const char *part_name,
 			    void *buffer, u32 download_bytes, char *response)
@@ -620,6 +646,7 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 		sparse.size = info.size;
 		sparse.write = fb_mmc_sparse_write;
 		sparse.reserve = fb_mmc_sparse_reserve;
+		sparse.erase = fb_mmc_sparse_erase;
 		sparse.mssg = fastboot_fail;
 
 		printf("Flashing sparse image at offset " LBAFU "\n",
@@ -636,6 +663,42 @@ void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 	}
 }
 
+#if CONFIG_IS_ENABLED(FASTBOOT_CMD_OEM_STREAM)
+static struct fb_mmc_sparse fb_mmc_stream_priv;
+
+/**
+ * fastboot_mmc_stream_open() - Set up storage for an image written as it
+ * arrives
+ *
+ * @cmd: Named partition to write image to
+ * @sparse: Returns the storage to pass to sparse_stream_init()
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve if the partition cannot be used
+ */
+int fastboot_mmc_stream_open(const char *cmd, struct sparse_storage *sparse,
+			     char *response)
+{
+	struct disk_partition info = {0};
+	struct blk_desc *dev_desc;
+
+	if (fastboot_mmc_get_part_info(cmd, &dev_desc, &info, response) < 0)
+		return -ENOENT;
+
+	fb_mmc_stream_priv.dev_desc = dev_desc;
+
+	sparse->blksz = info.blksz;
+	sparse->start = info.start;
+	sparse->size = info.size;
+	sparse->write = fb_mmc_sparse_write;
+	sparse->reserve = fb_mmc_sparse_reserve;
+	sparse->erase = fb_mmc_sparse_erase;
+	sparse->mssg = fastboot_fail;
+	sparse->priv = &fb_mmc_stream_priv;
+
+	return 0;
+}
+#endif
+
 /**
  * fastboot_mmc_flash_erase() - Erase eMMC for fastboot
  *
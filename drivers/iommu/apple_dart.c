@@ -56,6 +56,14 @@
 	((priv)->ttbr_base + 4 * (priv)->nttbr * (sid) + 4 * (idx))
 #define  DART_TTBR_SHIFT	12
 
+/*
+ * Mappings are made a window at a time and kept after they are unmapped, so
+ * that a run of transfers to the same buffer only programs the page tables
+ * and flushes the TLB once
+ */
+#define DART_MAP_WINDOW		SZ_2M
+#define DART_MAP_CACHE		8
+
 #define DART_ALL_STREAMS(priv)	((1U << (priv)->nsid) - 1)
 
 #define DART_PAGE_SIZE		SZ_16K
@@ -68,11 +76,28 @@
 #define DART_L2_START(addr)	((((addr) & DART_PAGE_MASK) >> 2) << 52)
 #define DART_L2_END(addr)	((((addr) & DART_PAGE_MASK) >> 2) << 40)
 
+/**
+ * struct apple_dart_map - A mapping kept for reuse
+ *
+ * @paddr: Physical address of the start of the mapping
+ * @psize: Size of the mapping, or 0 if this entry is not in use
+ * @dva: Device address of the start of the mapping
+ * @refcnt: Number of users of the mapping which have not unmapped it
+ */
+struct apple_dart_map {
+	phys_addr_t paddr;
+	phys_size_t psize;
+	dma_addr_t dva;
+	int refcnt;
+};
+
 struct apple_dart_priv {
 	void *base;
 	u64 *l1, *l2;
 	int bypass, shift;
 
+	struct apple_dart_map maps[DART_MAP_CACHE];
+
 	struct lmb io_lmb;
 
 	dma_addr_t dvabase;
@@ -111,21 +136,15 @@ static void apple_dart_t8110_flush_tlb(struct apple_dart_priv *priv)
 		continue;
 }
 
-static dma_addr_t apple_dart_map(struct udevice *dev, void *addr, size_t size)
+static dma_addr_t apple_dart_map_pages(struct apple_dart_priv *priv,
+					phys_addr_t paddr, phys_size_t psize)
 {
-	struct apple_dart_priv *priv = dev_get_priv(dev);
-	phys_addr_t paddr, dva;
-	phys_size_t psize, off;
+	dma_addr_t dva;
 	int i, idx;
 
-	if (priv->bypass)
-		return (phys_addr_t)addr;
-
-	paddr = ALIGN_DOWN((phys_addr_t)addr, DART_PAGE_SIZE);
-	off = (phys_addr_t)addr - paddr;
-	psize = ALIGN(size + off, DART_PAGE_SIZE);
-
 	dva = io_lmb_alloc(&priv->io_lmb, psize, DART_PAGE_SIZE);
+	if (!dva)
+		return 0;
 
 	idx = dva / DART_PAGE_SIZE;
 	for (i = 0; i < psize / DART_PAGE_SIZE; i++) {
@@ -137,31 +156,122 @@ static dma_addr_t apple_dart_map(struct udevice *dev, void *addr, size_t size)
 			   (unsigned long)&priv->l2[idx + i]);
 	priv->flush_tlb(priv);
 
-	return dva + off;
+	return dva;
+}
+
+static void apple_dart_unmap_pages(struct apple_dart_priv *priv,
+				   dma_addr_t dva, phys_size_t psize)
+{
+	int i, idx;
+
+	idx = dva / DART_PAGE_SIZE;
+	for (i = 0; i < psize / DART_PAGE_SIZE; i++)
+		priv->l2[idx + i] = DART_L2_INVAL;
+	flush_dcache_range((unsigned long)&priv->l2[idx],
+			   (unsigned long)&priv->l2[idx + i]);
+	priv->flush_tlb(priv);
+
+	io_lmb_free(&priv->io_lmb, dva, psize);
+}
+
+/* Drop cached mappings which nothing is using, to free up address space */
+static void apple_dart_drop_unused(struct apple_dart_priv *priv)
+{
+	struct apple_dart_map *map;
+
+	for (map = priv->maps; map < priv->maps + DART_MAP_CACHE; map++) {
+		if (map->psize && !map->refcnt) {
+			apple_dart_unmap_pages(priv, map->dva, map->psize);
+			map->psize = 0;
+		}
+	}
+}
+
+static dma_addr_t apple_dart_map(struct udevice *dev, void *addr, size_t size)
+{
+	struct apple_dart_priv *priv = dev_get_priv(dev);
+	struct apple_dart_map *map, *slot = NULL;
+	phys_addr_t start = (phys_addr_t)addr;
+	phys_addr_t paddr;
+	phys_size_t psize;
+	dma_addr_t dva;
+
+	if (priv->bypass)
+		return (phys_addr_t)addr;
+
+	for (map = priv->maps; map < priv->maps + DART_MAP_CACHE; map++) {
+		if (!map->psize) {
+			if (!slot)
+				slot = map;
+			continue;
+		}
+		if (start >= map->paddr &&
+		    start + size <= map->paddr + map->psize) {
+			map->refcnt++;
+			return map->dva + (start - map->paddr);
+		}
+	}
+
+	/* Evict an unused mapping if there is no free slot */
+	for (map = priv->maps; !slot && map < priv->maps + DART_MAP_CACHE;
+	     map++) {
+		if (!map->refcnt) {
+			apple_dart_unmap_pages(priv, map->dva, map->psize);
+			map->psize = 0;
+			slot = map;
+		}
+	}
+
+	if (slot) {
+		paddr = ALIGN_DOWN(start, DART_MAP_WINDOW);
+		psize = ALIGN(start + size, DART_MAP_WINDOW) - paddr;
+	} else {
+		paddr = ALIGN_DOWN(start, DART_PAGE_SIZE);
+		psize = ALIGN(start + size, DART_PAGE_SIZE) - paddr;
+	}
+
+	dva = apple_dart_map_pages(priv, paddr, psize);
+	if (!dva) {
+		apple_dart_drop_unused(priv);
+		dva = apple_dart_map_pages(priv, paddr, psize);
+		if (!dva)
+			return 0;
+	}
+
+	if (slot) {
+		slot->paddr = paddr;
+		slot->psize = psize;
+		slot->dva = dva;
+		slot->refcnt = 1;
+	}
+
+	return dva + (start - paddr);
 }
 
 static void apple_dart_unmap(struct udevice *dev, dma_addr_t addr, size_t size)
 {
 	struct apple_dart_priv *priv = dev_get_priv(dev);
+	struct apple_dart_map *map;
 	phys_addr_t dva;
 	phys_size_t psize;
-	int i, idx;
 
 	if (priv->bypass)
 		return;
 
+	/* Cached mappings stay in place for the next user */
+	for (map = priv->maps; map < priv->maps + DART_MAP_CACHE; map++) {
+		if (map->psize && addr >= map->dva &&
+		    addr < map->dva + map->psize) {
+			map->refcnt--;
+			return;
+		}
+	}
+
 	dva = ALIGN_DOWN(addr, DART_PAGE_SIZE);
 	psize = size + (addr - dva);
 	psize = ALIGN(psize, DART_PAGE_SIZE);
 
-	idx = dva / DART_PAGE_SIZE;
-	for (i = 0; i < psize / DART_PAGE_SIZE; i++)
-		priv->l2[idx + i] = DART_L2_INVAL;
-	flush_dcache_range((unsigned long)&priv->l2[idx],
-			   (unsigned long)&priv->l2[idx + i]);
-	priv->flush_tlb(priv);
-
-	io_lmb_free(&priv->io_lmb, dva, psize);
+	apple_dart_unmap_pages(priv, dva, psize);
 }
 
 static struct iommu_ops apple_dart_ops = {
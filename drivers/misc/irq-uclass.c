@@ -10,7 +10,10 @@
 #include <dt-structs.h>
 #include <irq.h>
 #include <log.h>
+#include <time.h>
 #include <dm/device-internal.h>
+#include <linux/compiler.h>
+#include <u-boot/schedule.h>
 
 int irq_route_pmc_gpio_gpe(struct udevice *dev, uint pmc_gpe_num)
 {
@@ -258,7 +261,152 @@ int irq_get_acpi(const struct irq *irq, struct acpi_irq *acpi_irq)
 }
 #endif
 
+#if CONFIG_IS_ENABLED(IRQ_DISPATCH)
+static struct irq_handler_entry *irq_find_handler(struct udevice *dev,
+						  ulong id)
+{
+	struct irq_uc_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct irq_handler_entry *entry;
+
+	for (entry = uc_priv->handlers;
+	     entry < uc_priv->handlers + IRQ_MAX_HANDLERS; entry++) {
+		if (entry->handler && entry->irq.id == id)
+			return entry;
+	}
+
+	return NULL;
+}
+
+int irq_set_handler(struct irq *irq, irq_handler_t handler, void *ctx)
+{
+	const struct irq_ops *ops = irq_get_ops(irq->dev);
+	struct irq_uc_priv *uc_priv = dev_get_uclass_priv(irq->dev);
+	struct irq_handler_entry *entry;
+	int ret, i;
+
+	if (!ops->set_enable || !ops->ack)
+		return -ENOSYS;
+	entry = irq_find_handler(irq->dev, irq->id);
+	for (i = 0; !entry && i < IRQ_MAX_HANDLERS; i++) {
+		if (!uc_priv->handlers[i].handler)
+			entry = &uc_priv->handlers[i];
+	}
+	if (!entry)
+		return log_msg_ret("set", -ENOSPC);
+
+	/* an interrupt may arrive as soon as it is enabled */
+	entry->irq = *irq;
+	entry->ctx = ctx;
+	WRITE_ONCE(entry->handler, handler);
+	ret = ops->set_enable(irq, true);
+	if (ret) {
+		entry->handler = NULL;
+		return log_msg_ret("ena", ret);
+	}
+
+	return 0;
+}
+
+int irq_clear_handler(struct irq *irq)
+{
+	const struct irq_ops *ops = irq_get_ops(irq->dev);
+	struct irq_handler_entry *entry;
+	int ret;
+
+	entry = irq_find_handler(irq->dev, irq->id);
+	if (!entry)
+		return -ENOENT;
+	ret = ops->set_enable(irq, false);
+	if (ret)
+		return log_msg_ret("dis", ret);
+	entry->handler = NULL;
+
+	return 0;
+}
+
+int irq_handle(struct udevice *dev)
+{
+	const struct irq_ops *ops = irq_get_ops(dev);
+	struct irq_uc_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct irq_handler_entry *entry;
+	int count = 0;
+	ulong id;
+
+	if (!ops->ack)
+		return -ENOSYS;
+	while (!ops->ack(dev, &id)) {
+		entry = irq_find_handler(dev, id);
+		if (entry) {
+			entry->handler(&entry->irq, entry->ctx);
+		} else {
+			struct irq irq = { .dev = dev, .id = id };
+
+			/* stop it being raised again */
+			if (ops->set_enable)
+				ops->set_enable(&irq, false);
+			uc_priv->unhandled++;
+		}
+		if (ops->eoi)
+			ops->eoi(dev, id);
+		uc_priv->count++;
+		count++;
+	}
+
+	return count;
+}
+
+int irq_handle_all(void)
+{
+	struct udevice *dev;
+	struct uclass *uc;
+	int count = 0;
+	bool found = false;
+	int ret;
+
+	uclass_id_foreach_dev(UCLASS_IRQ, dev, uc) {
+		if (!device_active(dev))
+			continue;
+		ret = irq_handle(dev);
+		if (ret >= 0) {
+			found = true;
+			count += ret;
+		}
+	}
+
+	return found ? count : -ENODEV;
+}
+
+void irq_complete(struct irq *irq, void *ctx)
+{
+	struct irq_completion *comp = ctx;
+
+	WRITE_ONCE(comp->done, true);
+}
+
+__weak void arch_irq_wait(void)
+{
+	irq_handle_all();
+}
+
+int irq_wait_completion(struct irq_completion *comp, ulong timeout_ms)
+{
+	ulong start = get_timer(0);
+
+	while (!READ_ONCE(comp->done)) {
+		if (get_timer(start) >= timeout_ms)
+			return -ETIMEDOUT;
+		arch_irq_wait();
+		schedule();
+	}
+
+	return 0;
+}
+#endif /* IRQ_DISPATCH */
+
 UCLASS_DRIVER(irq) = {
 	.id		= UCLASS_IRQ,
 	.name		= "irq",
+#if CONFIG_IS_ENABLED(IRQ_DISPATCH)
+	.per_device_auto	= sizeof(struct irq_uc_priv),
+#endif
 };
@@ -10,6 +10,7 @@
 #include <acpi/acpi_device.h>
 #include <asm/irq.h>
 #include <asm/test.h>
+#include <linux/bitops.h>
 
 static int sandbox_set_polarity(struct udevice *dev, uint irq, bool active_low)
 {
@@ -63,6 +64,42 @@ static int sandbox_irq_of_xlate(struct irq *irq,
 	return 0;
 }
 
+static int sandbox_irq_set_enable(struct irq *irq, bool enable)
+{
+	struct sandbox_irq_priv *priv = dev_get_priv(irq->dev);
+
+	if (irq->id >= BITS_PER_LONG)
+		return -EINVAL;
+	if (enable)
+		priv->enabled |= BIT(irq->id);
+	else
+		priv->enabled &= ~BIT(irq->id);
+
+	return 0;
+}
+
+static int sandbox_irq_ack(struct udevice *dev, ulong *idp)
+{
+	struct sandbox_irq_priv *priv = dev_get_priv(dev);
+	ulong pending = priv->raised & priv->enabled;
+
+	if (!pending)
+		return -ENOENT;
+	*idp = __ffs(pending);
+	priv->raised &= ~BIT(*idp);
+
+	return 0;
+}
+
+static int sandbox_irq_eoi(struct udevice *dev, ulong id)
+{
+	struct sandbox_irq_priv *priv = dev_get_priv(dev);
+
+	priv->eoi_count++;
+
+	return 0;
+}
+
 static __maybe_unused int sandbox_get_acpi(const struct irq *irq,
 					   struct acpi_irq *acpi_irq)
 {
@@ -82,6 +119,9 @@ static const struct irq_ops sandbox_irq_ops = {
 	.restore_polarities	= sandbox_restore_polarities,
 	.read_and_clear		= sandbox_irq_read_and_clear,
 	.of_xlate		= sandbox_irq_of_xlate,
+	.set_enable		= sandbox_irq_set_enable,
+	.ack			= sandbox_irq_ack,
+	.eoi			= sandbox_irq_eoi,
 #if CONFIG_IS_ENABLED(ACPIGEN)
 	.get_acpi		= sandbox_get_acpi,
 #endif
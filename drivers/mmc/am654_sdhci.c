@@ -520,10 +520,40 @@ static int am654_sdhci_execute_tuning(struct mmc *mmc, u8 opcode)
 
 	return 0;
 }
+
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+static int am654_sdhci_get_tuning(struct mmc *mmc, u32 *valp)
+{
+	struct am654_sdhci_plat *plat = dev_get_plat(mmc->dev);
+
+	*valp = plat->itap_del_sel[mmc->selected_mode];
+
+	return 0;
+}
+
+static int am654_sdhci_set_tuning(struct mmc *mmc, u32 val)
+{
+	struct am654_sdhci_plat *plat = dev_get_plat(mmc->dev);
+	int mode = mmc->selected_mode;
+
+	if (val > ITAPDLY_LAST_INDEX)
+		return -EINVAL;
+
+	plat->itap_del_ena[mode] = ENABLE;
+	plat->itap_del_sel[mode] = val;
+	am654_sdhci_write_itapdly(plat, val, plat->itap_del_ena[mode]);
+
+	return 0;
+}
+#endif
 #endif
 const struct sdhci_ops am654_sdhci_ops = {
 #if CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING)
 	.platform_execute_tuning = am654_sdhci_execute_tuning,
+#endif
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+	.platform_get_tuning	= am654_sdhci_get_tuning,
+	.platform_set_tuning	= am654_sdhci_set_tuning,
 #endif
 	.deferred_probe		= am654_sdhci_deferred_probe,
 	.set_ios_post		= &am654_sdhci_set_ios_post,
@@ -584,6 +614,10 @@ static int j721e_4bit_sdhci_set_ios_post(struct sdhci_host *host)
 const struct sdhci_ops j721e_4bit_sdhci_ops = {
 #if CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING)
 	.platform_execute_tuning = am654_sdhci_execute_tuning,
+#endif
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+	.platform_get_tuning	= am654_sdhci_get_tuning,
+	.platform_set_tuning	= am654_sdhci_set_tuning,
 #endif
 	.deferred_probe		= am654_sdhci_deferred_probe,
 	.set_ios_post		= &j721e_4bit_sdhci_set_ios_post,
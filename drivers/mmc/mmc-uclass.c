@@ -7,6 +7,7 @@
 
 #define LOG_CATEGORY UCLASS_MMC
 
+#include <bloblist.h>
 #include <bootdev.h>
 #include <log.h>
 #include <mmc.h>
@@ -40,6 +41,7 @@ static int dm_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 	struct dm_mmc_ops *ops = mmc_get_ops(dev);
 	int ret;
 
+	mmc_async_wait(mmc);
 	mmmc_trace_before_send(mmc, cmd);
 	if (ops->send_cmd)
 		ret = ops->send_cmd(dev, cmd, data);
@@ -55,6 +57,33 @@ int mmc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 	return dm_mmc_send_cmd(mmc->dev, cmd, data);
 }
 
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+int mmc_send_cmd_async(struct mmc *mmc, struct mmc_cmd *cmd,
+		       struct mmc_data *data)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(mmc->dev);
+	int ret;
+
+	if (!ops->send_cmd_async)
+		return -ENOSYS;
+	mmmc_trace_before_send(mmc, cmd);
+	ret = ops->send_cmd_async(mmc->dev, cmd, data);
+	mmmc_trace_after_send(mmc, cmd, ret);
+
+	return ret;
+}
+
+int mmc_poll_data(struct mmc *mmc, struct mmc_data *data)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(mmc->dev);
+
+	if (!ops->poll_data)
+		return -ENOSYS;
+
+	return ops->poll_data(mmc->dev, data);
+}
+#endif
+
 static int dm_mmc_set_ios(struct udevice *dev)
 {
 	struct dm_mmc_ops *ops = mmc_get_ops(dev);
@@ -121,12 +150,97 @@ static int dm_mmc_execute_tuning(struct udevice *dev, uint opcode)
 	return ops->execute_tuning(dev, opcode);
 }
 
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+/* Find the cached tuning result for the current mode, -ENOENT if none */
+static int mmc_tuning_find(struct mmc *mmc, struct mmc_tuning_cache *cache)
+{
+	int seq = dev_seq(mmc->dev);
+	int i;
+
+	for (i = 0; i < cache->count; i++) {
+		if (cache->ent[i].seq == seq &&
+		    cache->ent[i].mode == mmc->selected_mode)
+			return i;
+	}
+
+	return -ENOENT;
+}
+
+/* Apply a cached tuning result and check it with one tuning command */
+static int mmc_tuning_restore(struct mmc *mmc, uint opcode)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(mmc->dev);
+	struct mmc_tuning_cache *cache;
+	int ret, i;
+
+	if (!ops->set_tuning)
+		return -ENOSYS;
+	cache = bloblist_find(BLOBLISTT_U_BOOT_MMC_TUNING, sizeof(*cache));
+	if (!cache)
+		return -ENOENT;
+	i = mmc_tuning_find(mmc, cache);
+	if (i < 0)
+		return i;
+
+	ret = ops->set_tuning(mmc->dev, cache->ent[i].val);
+	if (!ret)
+		ret = mmc_send_tuning(mmc, opcode);
+	if (ret)
+		log_debug("Cached tuning %#x failed (err=%d)\n",
+			  cache->ent[i].val, ret);
+
+	return ret;
+}
+
+/* Record the result of a successful tuning sequence */
+static void mmc_tuning_save(struct mmc *mmc)
+{
+	struct dm_mmc_ops *ops = mmc_get_ops(mmc->dev);
+	struct mmc_tuning_cache *cache;
+	u32 val;
+	int i;
+
+	if (!ops->get_tuning || ops->get_tuning(mmc->dev, &val))
+		return;
+	cache = bloblist_ensure(BLOBLISTT_U_BOOT_MMC_TUNING, sizeof(*cache));
+	if (!cache)
+		return;
+
+	i = mmc_tuning_find(mmc, cache);
+	if (i < 0) {
+		/* drop the oldest entry when full */
+		if (cache->count == MMC_TUNING_CACHE_SIZE) {
+			memmove(cache->ent, cache->ent + 1,
+				sizeof(cache->ent[0]) * --cache->count);
+		}
+		i = cache->count++;
+		cache->ent[i].seq = dev_seq(mmc->dev);
+		cache->ent[i].mode = mmc->selected_mode;
+	}
+	cache->ent[i].val = val;
+}
+#else
+static int mmc_tuning_restore(struct mmc *mmc, uint opcode)
+{
+	return -ENOSYS;
+}
+
+static void mmc_tuning_save(struct mmc *mmc)
+{
+}
+#endif
+
 int mmc_execute_tuning(struct mmc *mmc, uint opcode)
 {
 	int ret;
 
 	mmc->tuning = true;
-	ret = dm_mmc_execute_tuning(mmc->dev, opcode);
+	ret = mmc_tuning_restore(mmc, opcode);
+	if (ret) {
+		ret = dm_mmc_execute_tuning(mmc->dev, opcode);
+		if (!ret)
+			mmc_tuning_save(mmc);
+	}
 	mmc->tuning = false;
 
 	return ret;
@@ -479,8 +593,10 @@ static int mmc_select_hwpart(struct udevice *bdev, int hwpart)
 		return -EMEDIUMTYPE;
 
 	ret = mmc_switch_part(mmc, hwpart);
-	if (!ret)
+	if (!ret) {
 		blkcache_invalidate(desc->uclass_id, desc->devnum);
+		blk_readahead_invalidate(desc);
+	}
 
 	return ret;
 }
@@ -497,6 +613,7 @@ static int mmc_blk_probe(struct udevice *dev)
 		debug("%s: mmc_init() failed (err=%d)\n", __func__, ret);
 		return ret;
 	}
+	mmc_get_blk_desc(mmc)->max_blocks = mmc->cfg->b_max;
 
 	ret = device_probe(dev);
 	if (ret) {
@@ -521,6 +638,11 @@ static int mmc_blk_remove(struct udevice *dev)
 
 static const struct blk_ops mmc_blk_ops = {
 	.read	= mmc_bread,
+	.read_sg	= mmc_bread_sg,
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	.submit	= mmc_bread_submit,
+	.poll	= mmc_bread_poll,
+#endif
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 	.write	= mmc_bwrite,
 	.erase	= mmc_berase,
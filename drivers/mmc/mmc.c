@@ -9,6 +9,7 @@
 
 #include <config.h>
 #include <blk.h>
+#include <bloblist.h>
 #include <command.h>
 #include <dm.h>
 #include <log.h>
@@ -26,6 +27,7 @@
 #include <linux/list.h>
 #include <linux/printk.h>
 #include <div64.h>
+#include <u-boot/schedule.h>
 #include "mmc_private.h"
 
 #define DEFAULT_CMD6_TIMEOUT_MS  500
@@ -455,11 +457,46 @@ int mmc_send_stop_transmission(struct mmc *mmc, bool write)
 	return mmc_send_cmd(mmc, &cmd, NULL);
 }
 
-static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
-			   lbaint_t blkcnt)
+/**
+ * mmc_set_block_count() - announce the length of a multi-block transfer
+ *
+ * With SET_BLOCK_COUNT (CMD23) the card knows how many blocks the following
+ * READ/WRITE_MULTIPLE_BLOCK command transfers, so STOP_TRANSMISSION (CMD12)
+ * is not needed afterwards. If the card rejects the command it is not used
+ * again until the card is re-initialised.
+ *
+ * @mmc:	MMC device
+ * @blkcnt:	Number of blocks in the transfer
+ * Return: true if the transfer is pre-defined, false if it must be stopped
+ * with CMD12
+ */
+static bool mmc_set_block_count(struct mmc *mmc, lbaint_t blkcnt)
 {
 	struct mmc_cmd cmd;
-	struct mmc_data data;
+
+	if (!CONFIG_IS_ENABLED(MMC_CMD23) || !mmc->cmd23 || blkcnt < 2 ||
+	    blkcnt > 0xffff || (mmc->cfg->host_caps & MMC_CAP_NO_CMD23))
+		return false;
+
+	cmd.cmdidx = MMC_CMD_SET_BLOCK_COUNT;
+	cmd.cmdarg = blkcnt;
+	cmd.resp_type = MMC_RSP_R1;
+	if (mmc_send_cmd(mmc, &cmd, NULL)) {
+		pr_debug("%s: CMD23 failed, using CMD12\n", __func__);
+		mmc->cmd23 = false;
+		return false;
+	}
+
+	return true;
+}
+
+/* Read data->blocks blocks from @start, returning the number read */
+static int mmc_read_data(struct mmc *mmc, struct mmc_data *data,
+			 lbaint_t start)
+{
+	lbaint_t blkcnt = data->blocks;
+	struct mmc_cmd cmd;
+	bool predefined;
 
 	if (blkcnt > 1)
 		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
@@ -473,15 +510,11 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 
 	cmd.resp_type = MMC_RSP_R1;
 
-	data.dest = dst;
-	data.blocks = blkcnt;
-	data.blocksize = mmc->read_bl_len;
-	data.flags = MMC_DATA_READ;
-
-	if (mmc_send_cmd(mmc, &cmd, &data))
+	predefined = mmc_set_block_count(mmc, blkcnt);
+	if (mmc_send_cmd(mmc, &cmd, data))
 		return 0;
 
-	if (blkcnt > 1) {
+	if (blkcnt > 1 && !predefined) {
 		if (mmc_send_stop_transmission(mmc, false)) {
 #if !defined(CONFIG_XPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
 			log_err("mmc fail to send stop cmd\n");
@@ -493,6 +526,19 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 	return blkcnt;
 }
 
+static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
+			   lbaint_t blkcnt)
+{
+	struct mmc_data data;
+
+	data.dest = dst;
+	data.blocks = blkcnt;
+	data.blocksize = mmc->read_bl_len;
+	data.flags = MMC_DATA_READ;
+
+	return mmc_read_data(mmc, &data, start);
+}
+
 #if !CONFIG_IS_ENABLED(DM_MMC)
 static int mmc_get_b_max(struct mmc *mmc, void *dst, lbaint_t blkcnt)
 {
@@ -562,6 +608,172 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 	return blkcnt;
 }
 
+#if CONFIG_IS_ENABLED(BLK) && CONFIG_IS_ENABLED(DM_MMC)
+long mmc_bread_sg(struct udevice *dev, lbaint_t start,
+		  const struct blk_sg *sg, uint count)
+{
+	struct blk_desc *block_dev = dev_get_uclass_plat(dev);
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
+	struct mmc_data data;
+	lbaint_t blkcnt = 0;
+	uint i;
+
+	if (!mmc || !(mmc->cfg->host_caps & MMC_CAP_SG) ||
+	    CONFIG_IS_ENABLED(MMC_TINY))
+		return -ENOSYS;
+	if (count > MMC_MAX_SG)
+		return -E2BIG;
+
+	for (i = 0; i < count; i++) {
+		if (!IS_ALIGNED((ulong)sg[i].buf, ARCH_DMA_MINALIGN) ||
+		    !IS_ALIGNED(sg[i].len, ARCH_DMA_MINALIGN))
+			return -ENOSYS;
+		blkcnt += sg[i].len / mmc->read_bl_len;
+	}
+	if (blkcnt > mmc->cfg->b_max)
+		return -E2BIG;
+
+	if (blk_dselect_hwpart(block_dev, block_dev->hwpart) < 0)
+		return -EIO;
+	if (start + blkcnt > block_dev->lba)
+		return -EINVAL;
+	if (mmc_set_blocklen(mmc, mmc->read_bl_len))
+		return -EIO;
+
+	data.blocks = blkcnt;
+	data.blocksize = mmc->read_bl_len;
+	data.flags = MMC_DATA_READ | MMC_DATA_SG;
+	data.sg = sg;
+	data.sg_count = count;
+	if (mmc_read_data(mmc, &data, start) != blkcnt)
+		return -EIO;
+
+	return blkcnt;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+/* Start reading the next piece of the asynchronous read */
+static int mmc_async_issue(struct mmc *mmc)
+{
+	struct mmc_async *async = &mmc->async;
+	struct mmc_cmd cmd;
+	uint cur;
+
+	cur = min_t(lbaint_t, async->left, async->b_max);
+	cmd.cmdidx = cur > 1 ? MMC_CMD_READ_MULTIPLE_BLOCK :
+		MMC_CMD_READ_SINGLE_BLOCK;
+	cmd.cmdarg = mmc->high_capacity ? async->start :
+		async->start * mmc->read_bl_len;
+	cmd.resp_type = MMC_RSP_R1;
+
+	async->data.dest = async->dst;
+	async->data.blocks = cur;
+	async->data.blocksize = mmc->read_bl_len;
+	async->data.flags = MMC_DATA_READ;
+
+	async->stepping = true;
+	async->predefined = mmc_set_block_count(mmc, cur);
+	async->stepping = false;
+
+	return mmc_send_cmd_async(mmc, &cmd, &async->data);
+}
+
+/**
+ * mmc_async_step() - move the asynchronous read on, if possible
+ *
+ * @mmc:	MMC device with an asynchronous read in progress
+ * Return: 0 if the read is finished, -EBUSY if not, other -ve on error
+ */
+static int mmc_async_step(struct mmc *mmc)
+{
+	struct mmc_async *async = &mmc->async;
+	struct blk_request *req = async->req;
+	uint cur = async->data.blocks;
+	int ret;
+
+	ret = mmc_poll_data(mmc, &async->data);
+	if (ret == -EBUSY)
+		return ret;
+
+	async->stepping = true;
+	if (!ret && cur > 1 && !async->predefined)
+		ret = mmc_send_stop_transmission(mmc, false);
+	if (!ret) {
+		async->left -= cur;
+		async->start += cur;
+		async->dst += cur * mmc->read_bl_len;
+		if (async->left)
+			ret = mmc_async_issue(mmc);
+		if (!ret && async->left) {
+			async->stepping = false;
+			return -EBUSY;
+		}
+	}
+	async->stepping = false;
+
+	req->done = req->blkcnt - async->left;
+	req->ret = ret ? -EIO : 0;
+	async->req = NULL;
+
+	return req->ret;
+}
+
+void mmc_async_wait(struct mmc *mmc)
+{
+	if (mmc->async.stepping)
+		return;
+	while (mmc->async.req && mmc_async_step(mmc) == -EBUSY)
+		schedule();
+}
+
+int mmc_bread_submit(struct udevice *dev, struct blk_request *req)
+{
+	struct blk_desc *block_dev = dev_get_uclass_plat(dev);
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
+	struct mmc_async *async;
+	int ret;
+
+	if (!mmc)
+		return -ENODEV;
+	if (req->write || !mmc_get_ops(mmc->dev)->send_cmd_async)
+		return -ENOSYS;
+	async = &mmc->async;
+	mmc_async_wait(mmc);
+
+	ret = blk_dselect_hwpart(block_dev, block_dev->hwpart);
+	if (ret < 0)
+		return ret;
+	if (!req->blkcnt || req->start + req->blkcnt > block_dev->lba)
+		return -EINVAL;
+	if (mmc_set_blocklen(mmc, mmc->read_bl_len))
+		return -EIO;
+
+	async->start = req->start;
+	async->left = req->blkcnt;
+	async->dst = req->buf;
+	async->b_max = mmc_get_b_max(mmc, req->buf, req->blkcnt);
+	ret = mmc_async_issue(mmc);
+	if (ret)
+		return ret;
+	async->req = req;
+
+	return 0;
+}
+
+int mmc_bread_poll(struct udevice *dev, struct blk_request *req)
+{
+	struct blk_desc *block_dev = dev_get_uclass_plat(dev);
+	struct mmc *mmc = find_mmc_device(block_dev->devnum);
+
+	/* finished already, because another command needed the device */
+	if (!mmc || mmc->async.req != req)
+		return req->ret;
+
+	return mmc_async_step(mmc);
+}
+#endif
+
 static int mmc_go_idle(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
@@ -1425,6 +1637,8 @@ static int sd_get_capabilities(struct mmc *mmc)
 	if (mmc->scr[0] & SD_DATA_4BIT)
 		mmc->card_caps |= MMC_MODE_4BIT;
 
+	mmc->cmd23 = !!(mmc->scr[0] & SD_SCR_CMD23_SUPPORT);
+
 	/* Version 1.0 doesn't support switching */
 	if (mmc->version == SD_VERSION_1_0)
 		return 0;
@@ -2505,6 +2719,10 @@ static int mmc_startup_v4(struct mmc *mmc)
 
 	mmc->can_trim =
 		!!(ext_csd[EXT_CSD_SEC_FEATURE] & EXT_CSD_SEC_FEATURE_TRIM_EN);
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	/* Both erase and trim leave blocks in this state */
+	mmc->erase_zeroes = !ext_csd[EXT_CSD_ERASED_MEM_CONT];
+#endif
 
 	return 0;
 error:
@@ -2517,73 +2735,15 @@ error:
 	return err;
 }
 
-static int mmc_startup(struct mmc *mmc)
+/* Work out the card parameters from the Card-Specific Data in mmc->csd */
+static void mmc_decode_csd(struct mmc *mmc)
 {
-	int err, i;
 	uint mult, freq;
 	u64 cmult, csize;
-	struct mmc_cmd cmd;
-	struct blk_desc *bdesc;
-
-#ifdef CONFIG_MMC_SPI_CRC_ON
-	if (mmc_host_is_spi(mmc)) { /* enable CRC check for spi */
-		cmd.cmdidx = MMC_CMD_SPI_CRC_ON_OFF;
-		cmd.resp_type = MMC_RSP_R1;
-		cmd.cmdarg = 1;
-		err = mmc_send_cmd(mmc, &cmd, NULL);
-		if (err)
-			return err;
-	}
-#endif
-
-	/* Put the Card in Identify Mode */
-	cmd.cmdidx = mmc_host_is_spi(mmc) ? MMC_CMD_SEND_CID :
-		MMC_CMD_ALL_SEND_CID; /* cmd not supported in spi */
-	cmd.resp_type = MMC_RSP_R2;
-	cmd.cmdarg = 0;
-
-	err = mmc_send_cmd_quirks(mmc, &cmd, NULL, MMC_QUIRK_RETRY_SEND_CID, 4);
-	if (err)
-		return err;
-
-	memcpy(mmc->cid, cmd.response, 16);
-
-	/*
-	 * For MMC cards, set the Relative Address.
-	 * For SD cards, get the Relatvie Address.
-	 * This also puts the cards into Standby State
-	 */
-	if (!mmc_host_is_spi(mmc)) { /* cmd not supported in spi */
-		cmd.cmdidx = SD_CMD_SEND_RELATIVE_ADDR;
-		cmd.cmdarg = mmc->rca << 16;
-		cmd.resp_type = MMC_RSP_R6;
-
-		err = mmc_send_cmd(mmc, &cmd, NULL);
-
-		if (err)
-			return err;
-
-		if (IS_SD(mmc))
-			mmc->rca = (cmd.response[0] >> 16) & 0xffff;
-	}
-
-	/* Get the Card-Specific Data */
-	cmd.cmdidx = MMC_CMD_SEND_CSD;
-	cmd.resp_type = MMC_RSP_R2;
-	cmd.cmdarg = mmc->rca << 16;
-
-	err = mmc_send_cmd(mmc, &cmd, NULL);
-
-	if (err)
-		return err;
-
-	mmc->csd[0] = cmd.response[0];
-	mmc->csd[1] = cmd.response[1];
-	mmc->csd[2] = cmd.response[2];
-	mmc->csd[3] = cmd.response[3];
+	int i;
 
 	if (mmc->version == MMC_VERSION_UNKNOWN) {
-		int version = (cmd.response[0] >> 26) & 0xf;
+		int version = (mmc->csd[0] >> 26) & 0xf;
 
 		switch (version) {
 		case 0:
@@ -2607,23 +2767,26 @@ static int mmc_startup(struct mmc *mmc)
 		}
 	}
 
+	/* CMD23 is mandatory from MMC 3.1; SD cards report it in the SCR */
+	mmc->cmd23 = !IS_SD(mmc) && mmc->version >= MMC_VERSION_3;
+
 	/* divide frequency by 10, since the mults are 10x bigger */
-	freq = fbase[(cmd.response[0] & 0x7)];
-	mult = multipliers[((cmd.response[0] >> 3) & 0xf)];
+	freq = fbase[(mmc->csd[0] & 0x7)];
+	mult = multipliers[((mmc->csd[0] >> 3) & 0xf)];
 
 	mmc->legacy_speed = freq * mult;
 	if (!mmc->legacy_speed)
 		log_debug("TRAN_SPEED: reserved value");
 	mmc_select_mode(mmc, MMC_LEGACY);
 
-	mmc->dsr_imp = ((cmd.response[1] >> 12) & 0x1);
-	mmc->read_bl_len = 1 << ((cmd.response[1] >> 16) & 0xf);
+	mmc->dsr_imp = ((mmc->csd[1] >> 12) & 0x1);
+	mmc->read_bl_len = 1 << ((mmc->csd[1] >> 16) & 0xf);
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 
 	if (IS_SD(mmc))
 		mmc->write_bl_len = mmc->read_bl_len;
 	else
-		mmc->write_bl_len = 1 << ((cmd.response[3] >> 22) & 0xf);
+		mmc->write_bl_len = 1 << ((mmc->csd[3] >> 22) & 0xf);
 #endif
 
 	if (mmc->high_capacity) {
@@ -2650,6 +2813,119 @@ static int mmc_startup(struct mmc *mmc)
 	if (mmc->write_bl_len > MMC_MAX_BLOCK_LEN)
 		mmc->write_bl_len = MMC_MAX_BLOCK_LEN;
 #endif
+}
+
+/* Fill in the block device once the bus mode has been selected */
+static int mmc_startup_finish(struct mmc *mmc)
+{
+	struct blk_desc *bdesc;
+
+	mmc->best_mode = mmc->selected_mode;
+
+	/* Fix the block length for DDR mode */
+	if (mmc->ddr_mode) {
+		mmc->read_bl_len = MMC_MAX_BLOCK_LEN;
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+		mmc->write_bl_len = MMC_MAX_BLOCK_LEN;
+#endif
+	}
+
+	/* fill in device description */
+	bdesc = mmc_get_blk_desc(mmc);
+	bdesc->lun = 0;
+	bdesc->hwpart = 0;
+	bdesc->type = 0;
+	bdesc->blksz = mmc->read_bl_len;
+	bdesc->log2blksz = LOG2(bdesc->blksz);
+	bdesc->lba = lldiv(mmc->capacity, mmc->read_bl_len);
+#if !defined(CONFIG_XPL_BUILD) || \
+		(defined(CONFIG_SPL_LIBCOMMON_SUPPORT) && \
+		!CONFIG_IS_ENABLED(USE_TINY_PRINTF))
+	sprintf(bdesc->vendor, "Man %06x Snr %04x%04x",
+		mmc->cid[0] >> 24, (mmc->cid[2] & 0xffff),
+		(mmc->cid[3] >> 16) & 0xffff);
+	sprintf(bdesc->product, "%c%c%c%c%c%c", mmc->cid[0] & 0xff,
+		(mmc->cid[1] >> 24), (mmc->cid[1] >> 16) & 0xff,
+		(mmc->cid[1] >> 8) & 0xff, mmc->cid[1] & 0xff,
+		(mmc->cid[2] >> 24) & 0xff);
+	sprintf(bdesc->revision, "%d.%d", (mmc->cid[2] >> 20) & 0xf,
+		(mmc->cid[2] >> 16) & 0xf);
+#else
+	bdesc->vendor[0] = 0;
+	bdesc->product[0] = 0;
+	bdesc->revision[0] = 0;
+#endif
+
+#if !defined(CONFIG_DM_MMC) && (!defined(CONFIG_XPL_BUILD) || defined(CONFIG_SPL_LIBDISK_SUPPORT))
+	part_init(bdesc);
+#endif
+
+	return 0;
+}
+
+static int mmc_startup(struct mmc *mmc)
+{
+	int err;
+	struct mmc_cmd cmd;
+
+#ifdef CONFIG_MMC_SPI_CRC_ON
+	if (mmc_host_is_spi(mmc)) { /* enable CRC check for spi */
+		cmd.cmdidx = MMC_CMD_SPI_CRC_ON_OFF;
+		cmd.resp_type = MMC_RSP_R1;
+		cmd.cmdarg = 1;
+		err = mmc_send_cmd(mmc, &cmd, NULL);
+		if (err)
+			return err;
+	}
+#endif
+
+	/* Put the Card in Identify Mode */
+	cmd.cmdidx = mmc_host_is_spi(mmc) ? MMC_CMD_SEND_CID :
+		MMC_CMD_ALL_SEND_CID; /* cmd not supported in spi */
+	cmd.resp_type = MMC_RSP_R2;
+	cmd.cmdarg = 0;
+
+	err = mmc_send_cmd_quirks(mmc, &cmd, NULL, MMC_QUIRK_RETRY_SEND_CID, 4);
+	if (err)
+		return err;
+
+	memcpy(mmc->cid, cmd.response, 16);
+
+	/*
+	 * For MMC cards, set the Relative Address.
+	 * For SD cards, get the Relatvie Address.
+	 * This also puts the cards into Standby State
+	 */
+	if (!mmc_host_is_spi(mmc)) { /* cmd not supported in spi */
+		cmd.cmdidx = SD_CMD_SEND_RELATIVE_ADDR;
+		cmd.cmdarg = mmc->rca << 16;
+		cmd.resp_type = MMC_RSP_R6;
+
+		err = mmc_send_cmd(mmc, &cmd, NULL);
+
+		if (err)
+			return err;
+
+		if (IS_SD(mmc))
+			mmc->rca = (cmd.response[0] >> 16) & 0xffff;
+	}
+
+	/* Get the Card-Specific Data */
+	cmd.cmdidx = MMC_CMD_SEND_CSD;
+	cmd.resp_type = MMC_RSP_R2;
+	cmd.cmdarg = mmc->rca << 16;
+
+	err = mmc_send_cmd(mmc, &cmd, NULL);
+
+	if (err)
+		return err;
+
+	mmc->csd[0] = cmd.response[0];
+	mmc->csd[1] = cmd.response[1];
+	mmc->csd[2] = cmd.response[2];
+	mmc->csd[3] = cmd.response[3];
+
+	mmc_decode_csd(mmc);
 
 	if ((mmc->dsr_imp) && (0xffffffff != mmc->dsr)) {
 		cmd.cmdidx = MMC_CMD_SET_DSR;
@@ -2706,47 +2982,7 @@ static int mmc_startup(struct mmc *mmc)
 	if (err)
 		return err;
 
-	mmc->best_mode = mmc->selected_mode;
-
-	/* Fix the block length for DDR mode */
-	if (mmc->ddr_mode) {
-		mmc->read_bl_len = MMC_MAX_BLOCK_LEN;
-#if CONFIG_IS_ENABLED(MMC_WRITE)
-		mmc->write_bl_len = MMC_MAX_BLOCK_LEN;
-#endif
-	}
-
-	/* fill in device description */
-	bdesc = mmc_get_blk_desc(mmc);
-	bdesc->lun = 0;
-	bdesc->hwpart = 0;
-	bdesc->type = 0;
-	bdesc->blksz = mmc->read_bl_len;
-	bdesc->log2blksz = LOG2(bdesc->blksz);
-	bdesc->lba = lldiv(mmc->capacity, mmc->read_bl_len);
-#if !defined(CONFIG_XPL_BUILD) || \
-		(defined(CONFIG_SPL_LIBCOMMON_SUPPORT) && \
-		!CONFIG_IS_ENABLED(USE_TINY_PRINTF))
-	sprintf(bdesc->vendor, "Man %06x Snr %04x%04x",
-		mmc->cid[0] >> 24, (mmc->cid[2] & 0xffff),
-		(mmc->cid[3] >> 16) & 0xffff);
-	sprintf(bdesc->product, "%c%c%c%c%c%c", mmc->cid[0] & 0xff,
-		(mmc->cid[1] >> 24), (mmc->cid[1] >> 16) & 0xff,
-		(mmc->cid[1] >> 8) & 0xff, mmc->cid[1] & 0xff,
-		(mmc->cid[2] >> 24) & 0xff);
-	sprintf(bdesc->revision, "%d.%d", (mmc->cid[2] >> 20) & 0xf,
-		(mmc->cid[2] >> 16) & 0xf);
-#else
-	bdesc->vendor[0] = 0;
-	bdesc->product[0] = 0;
-	bdesc->revision[0] = 0;
-#endif
-
-#if !defined(CONFIG_DM_MMC) && (!defined(CONFIG_XPL_BUILD) || defined(CONFIG_SPL_LIBDISK_SUPPORT))
-	part_init(bdesc);
-#endif
-
-	return 0;
+	return mmc_startup_finish(mmc);
 }
 
 static int mmc_send_if_cond(struct mmc *mmc)
@@ -2879,6 +3115,179 @@ static int mmc_power_cycle(struct mmc *mmc)
 	return mmc_power_on(mmc);
 }
 
+#if CONFIG_IS_ENABLED(MMC_HANDOFF)
+/* Record the state of an initialised card for the next phase */
+static void mmc_handoff_save(struct mmc *mmc)
+{
+	struct mmc_handoff *ho;
+	int seq = dev_seq(mmc->dev);
+	uint i;
+
+	if (!IS_ENABLED(CONFIG_XPL_BUILD) || mmc_host_is_spi(mmc))
+		return;
+
+	/* HS400 needs more host set-up than U-Boot proper can redo here */
+	if (mmc->selected_mode == MMC_HS_400 ||
+	    mmc->selected_mode == MMC_HS_400_ES)
+		return;
+
+	ho = bloblist_ensure(BLOBLISTT_U_BOOT_MMC_HANDOFF, sizeof(*ho));
+	if (!ho)
+		return;
+	for (i = 0; i < ho->count; i++) {
+		if (ho->card[i].seq == seq)
+			break;
+	}
+	if (i == ho->count) {
+		if (i == MMC_HANDOFF_CARDS)
+			return;
+		ho->count++;
+	}
+
+	ho->card[i].seq = seq;
+	ho->card[i].version = mmc->version;
+	ho->card[i].ocr = mmc->ocr;
+	ho->card[i].rca = mmc->rca;
+	ho->card[i].high_capacity = mmc->high_capacity;
+	ho->card[i].cmd23 = mmc->cmd23;
+	memcpy(ho->card[i].cid, mmc->cid, sizeof(ho->card[i].cid));
+	memcpy(ho->card[i].csd, mmc->csd, sizeof(ho->card[i].csd));
+	memcpy(ho->card[i].scr, mmc->scr, sizeof(ho->card[i].scr));
+	ho->card[i].card_caps = mmc->card_caps;
+	ho->card[i].mode = mmc->selected_mode;
+	ho->card[i].bus_width = mmc->bus_width;
+	ho->card[i].voltage = mmc->signal_voltage;
+}
+
+/*
+ * Take over a card left in transfer mode by SPL: set up the host to match the
+ * recorded state and check that the card still responds as expected
+ */
+static int mmc_handoff_resume(struct mmc *mmc)
+{
+	struct mmc_handoff *ho;
+	int seq = dev_seq(mmc->dev);
+	uint opcode = 0, status, i;
+	int err;
+
+	if (IS_ENABLED(CONFIG_XPL_BUILD) || mmc_host_is_spi(mmc))
+		return -ENOSYS;
+
+	ho = bloblist_find(BLOBLISTT_U_BOOT_MMC_HANDOFF, sizeof(*ho));
+	if (!ho)
+		return -ENOENT;
+	for (i = 0; i < ho->count; i++) {
+		if (ho->card[i].seq == seq)
+			break;
+	}
+	if (i == ho->count)
+		return -ENOENT;
+
+	/* the record only describes the card as SPL left it, so use it once */
+	ho->card[i].seq = -1;
+	if (!(mmc->host_caps & MMC_CAP(ho->card[i].mode)))
+		return -ENOTSUPP;
+	if (ho->card[i].mode == MMC_HS_200)
+		opcode = MMC_CMD_SEND_TUNING_BLOCK_HS200;
+	else if (ho->card[i].mode == UHS_SDR104)
+		opcode = MMC_CMD_SEND_TUNING_BLOCK;
+	if (opcode && !CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING))
+		return -ENOTSUPP;
+
+	err = mmc_power_on(mmc);
+	if (err)
+		return err;
+	err = mmc_reinit(mmc);
+	if (err)
+		return err;
+
+	mmc->version = ho->card[i].version;
+	mmc->ocr = ho->card[i].ocr;
+	mmc->rca = ho->card[i].rca;
+	mmc->high_capacity = ho->card[i].high_capacity;
+	memcpy(mmc->cid, ho->card[i].cid, sizeof(mmc->cid));
+	memcpy(mmc->csd, ho->card[i].csd, sizeof(mmc->csd));
+	memcpy(mmc->scr, ho->card[i].scr, sizeof(mmc->scr));
+	mmc->card_caps = ho->card[i].card_caps;
+	mmc->op_cond_pending = 0;
+	mmc_decode_csd(mmc);
+	mmc->cmd23 = ho->card[i].cmd23;
+
+	err = mmc_set_signal_voltage(mmc, ho->card[i].voltage);
+	if (err)
+		goto err;
+	mmc_select_mode(mmc, ho->card[i].mode);
+	mmc_set_bus_width(mmc, ho->card[i].bus_width);
+	mmc_set_clock(mmc, mmc->tran_speed, MMC_CLK_ENABLE);
+#if CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING)
+	if (opcode) {
+		err = mmc_execute_tuning(mmc, opcode);
+		if (err)
+			goto err;
+	}
+#endif
+
+	err = mmc_send_status(mmc, &status);
+	if (err)
+		goto err;
+	if ((status & MMC_STATUS_CURR_STATE) != MMC_STATE_TRANS) {
+		err = -EIO;
+		goto err;
+	}
+	mmc->handoff = true;
+
+	return 0;
+err:
+	log_debug("Cannot take over card from SPL (err=%d)\n", err);
+	mmc->version = MMC_VERSION_UNKNOWN;
+
+	return err;
+}
+
+/* Finish taking over a card from SPL, in place of mmc_startup() */
+static int mmc_handoff_startup(struct mmc *mmc)
+{
+	int err;
+
+	mmc->handoff = false;
+#if CONFIG_IS_ENABLED(MMC_WRITE)
+	mmc->erase_grp_size = 1;
+#endif
+	mmc->part_config = MMCPART_NOAVAILABLE;
+
+	err = mmc_startup_v4(mmc);
+	if (err)
+		return err;
+
+	/* SPL may have left a boot partition selected */
+	if (mmc->part_config != MMCPART_NOAVAILABLE &&
+	    (mmc->part_config & PART_ACCESS_MASK)) {
+		err = mmc_switch_part(mmc, 0);
+		if (err)
+			return err;
+	}
+	err = mmc_set_capacity(mmc, 0);
+	if (err)
+		return err;
+
+	return mmc_startup_finish(mmc);
+}
+#else
+static void mmc_handoff_save(struct mmc *mmc)
+{
+}
+
+static int mmc_handoff_resume(struct mmc *mmc)
+{
+	return -ENOSYS;
+}
+
+static int mmc_handoff_startup(struct mmc *mmc)
+{
+	return -ENOSYS;
+}
+#endif
+
 int mmc_get_op_cond(struct mmc *mmc, bool quiet)
 {
 	bool uhs_en = supports_uhs(mmc->cfg->host_caps);
@@ -2897,6 +3306,9 @@ int mmc_get_op_cond(struct mmc *mmc, bool quiet)
 		      MMC_QUIRK_RETRY_APP_CMD;
 #endif
 
+	if (!mmc_handoff_resume(mmc))
+		return 0;
+
 	err = mmc_power_cycle(mmc);
 	if (err) {
 		/*
@@ -3031,12 +3443,16 @@ static int mmc_complete_init(struct mmc *mmc)
 	if (mmc->op_cond_pending)
 		err = mmc_complete_op_cond(mmc);
 
-	if (!err)
+	if (!err && mmc->handoff)
+		err = mmc_handoff_startup(mmc);
+	else if (!err)
 		err = mmc_startup(mmc);
-	if (err)
+	if (err) {
 		mmc->has_init = 0;
-	else
+	} else {
 		mmc->has_init = 1;
+		mmc_handoff_save(mmc);
+	}
 	return err;
 }
 
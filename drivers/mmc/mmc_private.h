@@ -25,6 +25,38 @@ ulong mmc_bread(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
 #endif
 
+#if CONFIG_IS_ENABLED(BLK) && CONFIG_IS_ENABLED(DM_MMC)
+/**
+ * mmc_bread_sg() - read blocks into a scatter-gather list in one transfer
+ *
+ * This needs a host with MMC_CAP_SG and at most MMC_MAX_SG segments, each
+ * aligned for DMA.
+ *
+ * @dev:	MMC block device
+ * @start:	Start block number
+ * @sg:		Segments to fill
+ * @count:	Number of segments in @sg
+ * Return: number of blocks read, -ENOSYS or -E2BIG if the list cannot be
+ * read in one transfer, other -ve on error
+ */
+long mmc_bread_sg(struct udevice *dev, lbaint_t start,
+		  const struct blk_sg *sg, uint count);
+#endif
+
+#if CONFIG_IS_ENABLED(BLK_ASYNC) && CONFIG_IS_ENABLED(DM_MMC)
+int mmc_bread_submit(struct udevice *dev, struct blk_request *req);
+int mmc_bread_poll(struct udevice *dev, struct blk_request *req);
+
+/**
+ * mmc_async_wait() - finish any asynchronous read before using the device
+ *
+ * @mmc:	MMC device
+ */
+void mmc_async_wait(struct mmc *mmc);
+#else
+static inline void mmc_async_wait(struct mmc *mmc) {}
+#endif
+
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 
 #if CONFIG_IS_ENABLED(BLK)
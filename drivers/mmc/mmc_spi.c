@@ -464,7 +464,7 @@ static int mmc_spi_probe(struct udevice *dev)
 	sprintf(name, "%s:%s", dev->parent->name, dev->name);
 
 	plat->cfg.name = name;
-	plat->cfg.host_caps = MMC_MODE_SPI;
+	plat->cfg.host_caps = MMC_MODE_SPI | MMC_CAP_NO_CMD23;
 	plat->cfg.voltages = MMC_SPI_VOLTAGE;
 	plat->cfg.f_min = MMC_SPI_MIN_CLOCK;
 	plat->cfg.f_max = priv->spi->max_hz;
@@ -75,6 +75,44 @@ void sdhci_prepare_adma_table(struct sdhci_host *host,
 			  ARCH_DMA_MINALIGN));
 }
 
+/**
+ * sdhci_prepare_adma_table_sg() - Populate the ADMA table from a list
+ *
+ * @host:	Pointer to the sdhci_host
+ * @table:	Pointer to the ADMA table
+ * @data:	Pointer to MMC data, with MMC_DATA_SG set
+ * @addr:	DMA address of each segment in @data->sg
+ *
+ * Fill the ADMA table with one or more descriptors per segment, so that a
+ * single command can transfer into several discontiguous buffers. The caller
+ * must limit the list to MMC_MAX_SG segments, which the table is sized for.
+ */
+void sdhci_prepare_adma_table_sg(struct sdhci_host *host,
+				 struct sdhci_adma_desc *table,
+				 struct mmc_data *data, const dma_addr_t *addr)
+{
+	void *next_desc = table;
+	uint i;
+
+	for (i = 0; i < data->sg_count; i++) {
+		dma_addr_t seg = addr[i];
+		ulong left = data->sg[i].len;
+
+		while (left > ADMA_MAX_LEN) {
+			__sdhci_adma_write_desc(host, &next_desc, seg,
+						ADMA_MAX_LEN, false);
+			seg += ADMA_MAX_LEN;
+			left -= ADMA_MAX_LEN;
+		}
+		__sdhci_adma_write_desc(host, &next_desc, seg, left,
+					i == data->sg_count - 1);
+	}
+
+	flush_cache((phys_addr_t)table,
+		    ROUND(next_desc - (void *)table,
+			  ARCH_DMA_MINALIGN));
+}
+
 /**
  * sdhci_adma_init() - initialize the ADMA descriptor table
  *
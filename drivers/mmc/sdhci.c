@@ -63,7 +63,7 @@ static void sdhci_transfer_pio(struct sdhci_host *host, struct mmc_data *data)
 	char *offs;
 	for (i = 0; i < data->blocksize; i += 4) {
 		offs = data->dest + i;
-		if (data->flags == MMC_DATA_READ)
+		if (data->flags & MMC_DATA_READ)
 			*(u32 *)offs = sdhci_readl(host, SDHCI_BUFFER);
 		else
 			sdhci_writel(host, *(u32 *)offs, SDHCI_BUFFER);
@@ -71,6 +71,20 @@ static void sdhci_transfer_pio(struct sdhci_host *host, struct mmc_data *data)
 }
 
 #if (CONFIG_IS_ENABLED(MMC_SDHCI_SDMA) || CONFIG_IS_ENABLED(MMC_SDHCI_ADMA))
+static void sdhci_dma_unmap(struct sdhci_host *host, struct mmc_data *data)
+{
+	uint i;
+
+	if (data->flags & MMC_DATA_SG) {
+		for (i = 0; i < data->sg_count; i++)
+			dma_unmap_single(host->sg_addr[i], data->sg[i].len,
+					 mmc_get_dma_dir(data));
+		return;
+	}
+	dma_unmap_single(host->start_addr, data->blocks * data->blocksize,
+			 mmc_get_dma_dir(data));
+}
+
 static void sdhci_prepare_dma(struct sdhci_host *host, struct mmc_data *data,
 			      int *is_aligned, int trans_bytes)
 {
@@ -78,7 +92,7 @@ static void sdhci_prepare_dma(struct sdhci_host *host, struct mmc_data *data,
 	unsigned char ctrl;
 	void *buf;
 
-	if (data->flags == MMC_DATA_READ)
+	if (data->flags & MMC_DATA_READ)
 		buf = data->dest;
 	else
 		buf = (void *)data->src;
@@ -96,11 +110,30 @@ static void sdhci_prepare_dma(struct sdhci_host *host, struct mmc_data *data,
 	     (host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR &&
 	      ((unsigned long)buf & 0x7) != 0x0))) {
 		*is_aligned = 0;
-		if (data->flags != MMC_DATA_READ)
+		if (!(data->flags & MMC_DATA_READ))
 			memcpy(host->align_buffer, buf, trans_bytes);
 		buf = host->align_buffer;
 	}
 
+#if CONFIG_IS_ENABLED(MMC_SDHCI_ADMA)
+	if (data->flags & MMC_DATA_SG) {
+		uint i;
+
+		for (i = 0; i < data->sg_count; i++)
+			host->sg_addr[i] = dma_map_single(data->sg[i].buf,
+							  data->sg[i].len,
+							  mmc_get_dma_dir(data));
+		sdhci_prepare_adma_table_sg(host, host->adma_desc_table, data,
+					    host->sg_addr);
+		sdhci_writel(host, lower_32_bits(host->adma_addr),
+			     SDHCI_ADMA_ADDRESS);
+		if (host->flags & USE_ADMA64)
+			sdhci_writel(host, upper_32_bits(host->adma_addr),
+				     SDHCI_ADMA_ADDRESS_HI);
+		return;
+	}
+#endif
+
 	host->start_addr = dma_map_single(buf, trans_bytes,
 					  mmc_get_dma_dir(data));
 
@@ -177,8 +210,7 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data)
 	} while (!(stat & SDHCI_INT_DATA_END));
 
 #if (CONFIG_IS_ENABLED(MMC_SDHCI_SDMA) || CONFIG_IS_ENABLED(MMC_SDHCI_ADMA))
-	dma_unmap_single(host->start_addr, data->blocks * data->blocksize,
-			 mmc_get_dma_dir(data));
+	sdhci_dma_unmap(host, data);
 #endif
 
 	return 0;
@@ -195,17 +227,14 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data)
 #define SDHCI_CMD_DEFAULT_TIMEOUT		100
 #define SDHCI_READ_STATUS_TIMEOUT		1000
 
-#ifdef CONFIG_DM_MMC
-static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
-{
-	struct mmc *mmc = mmc_get_mmc_dev(dev);
-
-#else
-static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
-			      struct mmc_data *data)
+/*
+ * Send a command and, unless @async is true, wait for its data transfer. With
+ * @async the function returns once the command response has been received,
+ * leaving the DMA transfer running for sdhci_poll_data() to complete.
+ */
+static int __sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
+				struct mmc_data *data, bool async)
 {
-#endif
 	struct sdhci_host *host = mmc->priv;
 	unsigned int stat = 0;
 	int ret = 0;
@@ -279,7 +308,7 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		if (data->blocks > 1)
 			mode |= SDHCI_TRNS_MULTI | SDHCI_TRNS_BLK_CNT_EN;
 
-		if (data->flags == MMC_DATA_READ)
+		if (data->flags & MMC_DATA_READ)
 			mode |= SDHCI_TRNS_READ;
 
 		if (host->flags & USE_DMA) {
@@ -326,8 +355,13 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	} else
 		ret = -1;
 
-	if (!ret && data)
+	if (!ret && data) {
+		if (async) {
+			host->data_start = get_timer(0);
+			return 0;
+		}
 		ret = sdhci_transfer_data(host, data);
+	}
 
 	if (host->quirks & SDHCI_QUIRK_WAIT_SEND_CMD)
 		udelay(1000);
@@ -336,7 +370,7 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
 	if (!ret) {
 		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				!is_aligned && (data->flags == MMC_DATA_READ))
+				!is_aligned && (data->flags & MMC_DATA_READ))
 			memcpy(data->dest, host->align_buffer, trans_bytes);
 		return 0;
 	}
@@ -349,6 +383,68 @@ static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		return -ECOMM;
 }
 
+#ifdef CONFIG_DM_MMC
+static int sdhci_send_command(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+
+	return __sdhci_send_command(mmc, cmd, data, false);
+}
+
+#if CONFIG_IS_ENABLED(MMC_SDHCI_ADMA) && CONFIG_IS_ENABLED(BLK_ASYNC)
+/* Data transfers time out after 10 seconds, as in sdhci_transfer_data() */
+#define SDHCI_DATA_TIMEOUT_MS	10000
+
+static int sdhci_send_cmd_async(struct udevice *dev, struct mmc_cmd *cmd,
+				struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	/* only ADMA runs to completion without help from the CPU */
+	if (!data || !(host->flags & (USE_ADMA | USE_ADMA64)))
+		return -ENOSYS;
+
+	return __sdhci_send_command(mmc, cmd, data, true);
+}
+
+static int sdhci_poll_data(struct udevice *dev, struct mmc_data *data)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+	unsigned int stat;
+	int ret = 0;
+
+	stat = sdhci_readl(host, SDHCI_INT_STATUS);
+	if (stat & SDHCI_INT_ERROR) {
+		log_debug("Error detected in status(%#x)!\n", stat);
+		ret = -EIO;
+	} else if (!(stat & SDHCI_INT_DATA_END)) {
+		if (get_timer(host->data_start) < SDHCI_DATA_TIMEOUT_MS)
+			return -EBUSY;
+		log_err("Transfer data timeout\n");
+		ret = -ETIMEDOUT;
+	}
+
+	sdhci_dma_unmap(host, data);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	if (ret) {
+		sdhci_reset(host, SDHCI_RESET_CMD);
+		sdhci_reset(host, SDHCI_RESET_DATA);
+	}
+
+	return ret;
+}
+#endif
+#else
+static int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
+			      struct mmc_data *data)
+{
+	return __sdhci_send_command(mmc, cmd, data, false);
+}
+#endif
+
 #if defined(CONFIG_DM_MMC) && CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING)
 static int sdhci_execute_tuning(struct udevice *dev, uint opcode)
 {
@@ -366,6 +462,30 @@ static int sdhci_execute_tuning(struct udevice *dev, uint opcode)
 	}
 	return 0;
 }
+
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+static int sdhci_get_tuning(struct udevice *dev, u32 *valp)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	if (!host->ops || !host->ops->platform_get_tuning)
+		return -ENOSYS;
+
+	return host->ops->platform_get_tuning(mmc, valp);
+}
+
+static int sdhci_set_tuning(struct udevice *dev, u32 val)
+{
+	struct mmc *mmc = mmc_get_mmc_dev(dev);
+	struct sdhci_host *host = mmc->priv;
+
+	if (!host->ops || !host->ops->platform_set_tuning)
+		return -ENOSYS;
+
+	return host->ops->platform_set_tuning(mmc, val);
+}
+#endif
 #endif
 int sdhci_set_clock(struct mmc *mmc, unsigned int clock)
 {
@@ -840,11 +960,19 @@ static int sdhci_set_enhanced_strobe(struct udevice *dev)
 
 const struct dm_mmc_ops sdhci_ops = {
 	.send_cmd	= sdhci_send_command,
+#if CONFIG_IS_ENABLED(MMC_SDHCI_ADMA) && CONFIG_IS_ENABLED(BLK_ASYNC)
+	.send_cmd_async	= sdhci_send_cmd_async,
+	.poll_data	= sdhci_poll_data,
+#endif
 	.set_ios	= sdhci_set_ios,
 	.get_cd		= sdhci_get_cd,
 	.deferred_probe	= sdhci_deferred_probe,
 #if CONFIG_IS_ENABLED(MMC_SUPPORTS_TUNING)
 	.execute_tuning	= sdhci_execute_tuning,
+#endif
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+	.get_tuning	= sdhci_get_tuning,
+	.set_tuning	= sdhci_set_tuning,
 #endif
 	.wait_dat0	= sdhci_wait_dat0,
 #if CONFIG_IS_ENABLED(MMC_HS400_ES_SUPPORT)
@@ -899,6 +1027,7 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 		host->flags |= USE_ADMA64;
 	else
 		host->flags |= USE_ADMA;
+	cfg->host_caps |= MMC_CAP_SG;
 #endif
 	if (host->quirks & SDHCI_QUIRK_REG32_RW)
 		host->version =
@@ -537,7 +537,8 @@ struct mmc *sunxi_mmc_init(int sdc_no)
 	    IS_ENABLED(CONFIG_SUN50I_GEN_H6)) && (sdc_no == 2))
 		cfg->host_caps = MMC_MODE_8BIT;
 
-	cfg->host_caps |= MMC_MODE_HS_52MHz | MMC_MODE_HS;
+	/* the controller sends CMD12 itself after multi-block transfers */
+	cfg->host_caps |= MMC_MODE_HS_52MHz | MMC_MODE_HS | MMC_CAP_NO_CMD23;
 	cfg->b_max = CONFIG_SYS_MMC_MAX_BLK_COUNT;
 
 	cfg->f_min = 400000;
@@ -644,7 +645,7 @@ static int sunxi_mmc_probe(struct udevice *dev)
 	cfg->name = dev->name;
 
 	cfg->voltages = MMC_VDD_32_33 | MMC_VDD_33_34;
-	cfg->host_caps = MMC_MODE_HS_52MHz | MMC_MODE_HS;
+	cfg->host_caps = MMC_MODE_HS_52MHz | MMC_MODE_HS | MMC_CAP_NO_CMD23;
 	cfg->b_max = CONFIG_SYS_MMC_MAX_BLK_COUNT;
 
 	cfg->f_min = 400000;
@@ -2282,6 +2282,72 @@ static int nand_setup_read_retry(struct mtd_info *mtd, int retry_mode)
 	return chip->setup_read_retry(mtd, retry_mode);
 }
 
+/**
+ * nand_cache_read_pages - [INTERN] Pages to read in one cache read sequence
+ * @mtd: MTD device structure
+ * @ops: oob ops structure
+ * @page: first page to read
+ * @col: column address within @page
+ * @readlen: number of bytes left to read
+ *
+ * READ CACHE SEQUENTIAL lets the chip load the next page into its data
+ * register while the previous one is transferred from the cache register, so
+ * tR is hidden behind the bus transfer. A sequence is kept within an erase
+ * block, so it never crosses a LUN or chip boundary, and is only used with
+ * page read methods that do not issue commands of their own.
+ *
+ * Return: number of pages to read in one sequence, or 0 to read page by page
+ */
+static int nand_cache_read_pages(struct mtd_info *mtd,
+				 struct mtd_oob_ops *ops, int page, int col,
+				 uint32_t readlen)
+{
+	struct nand_chip *chip = mtd_to_nand(mtd);
+	int ppb = 1 << (chip->phys_erase_shift - chip->page_shift);
+	int pages;
+
+	if (!IS_ENABLED(CONFIG_SYS_NAND_CACHE_READ) ||
+	    !(chip->options & NAND_CACHE_READ))
+		return 0;
+
+	/* Retries and OOB transfers need to re-address the page */
+	if (ops->oobbuf || ops->mode == MTD_OPS_RAW || chip->read_retries > 1)
+		return 0;
+
+	if (!nand_standard_page_accessors(&chip->ecc) ||
+	    (chip->ecc.read_page != nand_read_page_hwecc &&
+	     chip->ecc.read_page != nand_read_page_swecc &&
+	     chip->ecc.read_page != nand_read_page_raw))
+		return 0;
+
+	pages = DIV_ROUND_UP(col + readlen, mtd->writesize);
+	pages = min(pages, ppb - (page & (ppb - 1)));
+
+	return pages > 1 ? pages : 0;
+}
+
+/**
+ * nand_read_cache_op - [INTERN] Make the next page of a sequence readable
+ * @chip: NAND chip
+ * @page: page to read
+ * @start: this is the first page of the sequence
+ * @end: this is the last page of the sequence
+ *
+ * Issues READ PAGE followed by READ CACHE SEQUENTIAL for the first page,
+ * READ CACHE SEQUENTIAL for the following pages and READ CACHE END for the
+ * last one. Afterwards the data of @page can be read from column 0.
+ */
+static void nand_read_cache_op(struct nand_chip *chip, int page, bool start,
+			       bool end)
+{
+	struct mtd_info *mtd = nand_to_mtd(chip);
+
+	if (start)
+		chip->cmdfunc(mtd, NAND_CMD_READ0, 0, page);
+	chip->cmdfunc(mtd, end ? NAND_CMD_READCACHEEND : NAND_CMD_READCACHESEQ,
+		      -1, -1);
+}
+
 /**
  * nand_do_read_ops - [INTERN] Read data with ECC
  * @mtd: MTD device structure
@@ -2304,6 +2370,7 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	int use_bufpoi;
 	unsigned int max_bitflips = 0;
 	int retry_mode = 0;
+	int seq_len = 0, seq_left = 0;
 	bool ecc_fail = false;
 
 	chipnr = (int)(from >> chip->chip_shift);
@@ -2334,15 +2401,25 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 			use_bufpoi = 0;
 
 		/* Is the current page in the buffer? */
-		if (realpage != chip->pagebuf || oob) {
+		if (realpage != chip->pagebuf || oob || seq_left) {
 			bufpoi = use_bufpoi ? chip->buffers->databuf : buf;
 
 			if (use_bufpoi && aligned)
 				pr_debug("%s: using read bounce buffer for buf@%p\n",
 						 __func__, buf);
 
+			if (!seq_left) {
+				seq_len = nand_cache_read_pages(mtd, ops, page,
+								col, readlen);
+				seq_left = seq_len;
+			}
+
 read_retry:
-			if (nand_standard_page_accessors(&chip->ecc)) {
+			if (seq_left) {
+				nand_read_cache_op(chip, page,
+						   seq_left == seq_len,
+						   seq_left == 1);
+			} else if (nand_standard_page_accessors(&chip->ecc)) {
 				ret = nand_read_page_op(chip, page, 0, NULL, 0);
 				if (ret)
 					break;
@@ -2357,7 +2434,7 @@ read_retry:
 							      oob_required,
 							      page);
 			else if (!aligned && NAND_HAS_SUBPAGE_READ(chip) &&
-				 !oob)
+				 !oob && !seq_left)
 				ret = chip->ecc.read_subpage(mtd, chip,
 							col, bytes, bufpoi,
 							page);
@@ -2371,6 +2448,9 @@ read_retry:
 				break;
 			}
 
+			if (seq_left)
+				seq_left--;
+
 			max_bitflips = max_t(unsigned int, max_bitflips, ret);
 
 			/* Transfer not aligned data */
@@ -2456,6 +2536,11 @@ read_retry:
 			chip->select_chip(mtd, chipnr);
 		}
 	}
+
+	/* Leave cache read mode if a sequence was cut short */
+	if (seq_left > 1)
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+
 	chip->select_chip(mtd, -1);
 
 	ops->retlen = ops->len - (size_t) readlen;
@@ -3927,6 +4012,12 @@ static int nand_flash_detect_onfi(struct mtd_info *mtd, struct nand_chip *chip)
 	if (onfi_feature(chip) & ONFI_FEATURE_16_BIT_BUS)
 		chip->options |= NAND_BUSWIDTH_16;
 
+	/* Only the default command functions know the cache read opcodes */
+	if ((le16_to_cpu(p->opt_cmd) & ONFI_OPT_CMD_READ_CACHE) &&
+	    (chip->cmdfunc == nand_command ||
+	     chip->cmdfunc == nand_command_lp))
+		chip->options |= NAND_CACHE_READ;
+
 	if (p->ecc_bits != 0xff) {
 		chip->ecc_strength_ds = p->ecc_bits;
 		chip->ecc_step_ds = 512;
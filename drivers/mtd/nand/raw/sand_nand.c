@@ -64,6 +64,7 @@ static const char *const state_name[] = {
  * @state: Current state of the device
  * @column: Column of the most-recent command
  * @page_addr: Page address of the most-recent command
+ * @cache_page_addr: Page being loaded during a cache read, or -1 if none
  * @fd: File descriptor for the backing data
  * @fd_page_addr: Page address that @fd is seek'd to
  * @selected: Whether this device is selected
@@ -83,7 +84,7 @@ struct sand_nand_chip {
 	u32 err_count, err_step_bits, err_steps, ecc_bits;
 	unsigned int cs;
 	enum sand_nand_state state;
-	int column, page_addr, fd, fd_page_addr;
+	int column, page_addr, cache_page_addr, fd, fd_page_addr;
 	bool selected, tmp_dirty;
 	u8 status;
 	u8 id_len;
@@ -258,6 +259,36 @@ static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 
 		chip->fd_page_addr++;
 		break;
+	case STATE_READ:
+		if (command != NAND_CMD_READCACHESEQ &&
+		    command != NAND_CMD_READCACHEEND)
+			goto other;
+
+		/*
+		 * The first READ CACHE SEQUENTIAL leaves the page read by
+		 * READ0 in the cache register, later ones move on to the page
+		 * which was being loaded.
+		 */
+		if (chip->cache_page_addr < 0) {
+			if (command == NAND_CMD_READCACHESEQ)
+				chip->cache_page_addr = chip->page_addr + 1;
+			chip->column = 0;
+			break;
+		}
+
+		chip->page_addr = chip->cache_page_addr;
+		chip->column = 0;
+		if (chip->page_addr >= chip->pages || sand_nand_read(chip)) {
+			chip->cache_page_addr = -1;
+			new_state = STATE_IDLE;
+			break;
+		}
+
+		if (command == NAND_CMD_READCACHESEQ)
+			chip->cache_page_addr++;
+		else
+			chip->cache_page_addr = -1;
+		break;
 	case STATE_ERASE:
 		new_state = STATE_IDLE;
 		if (command != NAND_CMD_ERASE2) {
@@ -274,8 +305,10 @@ static void sand_nand_command(struct mtd_info *mtd, unsigned int command,
 				     chip->pages_per_erase);
 		break;
 	default:
+other:
 		chip->column = column;
 		chip->page_addr = page_addr;
+		chip->cache_page_addr = -1;
 		switch (command) {
 		case NAND_CMD_READOOB:
 			if (column >= 0)
@@ -570,6 +603,7 @@ static int sand_nand_probe(struct udevice *dev)
 		chip->pagesize = pagesize;
 		chip->pages = pages;
 		chip->pages_per_erase = erasesize / pagesize;
+		chip->cache_page_addr = -1;
 		memset(chip->tmp, 0xff, chip->chunksize);
 
 		chip->err_count = err_count;
@@ -601,7 +635,9 @@ static int sand_nand_probe(struct udevice *dev)
 		}
 
 		nand = &chip->nand;
-		nand->options = not_xpl() ? 0 : NAND_SKIP_BBTSCAN;
+		nand->options = NAND_CACHE_READ;
+		if (!not_xpl())
+			nand->options |= NAND_SKIP_BBTSCAN;
 		nand->flash_node = np;
 		nand->dev_ready = sand_nand_dev_ready;
 		nand->cmdfunc = sand_nand_command;
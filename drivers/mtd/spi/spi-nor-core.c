@@ -719,6 +719,7 @@ static void spi_nor_set_4byte_opcodes(struct spi_nor *nor,
 				      const struct flash_info *info)
 {
 	bool shift = 0;
+	int i;
 
 	if (nor->flags & SNOR_F_HAS_PARALLEL)
 		shift = 1;
@@ -738,6 +739,9 @@ static void spi_nor_set_4byte_opcodes(struct spi_nor *nor,
 	nor->read_opcode = spi_nor_convert_3to4_read(nor->read_opcode);
 	nor->program_opcode = spi_nor_convert_3to4_program(nor->program_opcode);
 	nor->erase_opcode = spi_nor_convert_3to4_erase(nor->erase_opcode);
+	for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++)
+		nor->erase_type[i].opcode =
+			spi_nor_convert_3to4_erase(nor->erase_type[i].opcode);
 }
 #endif /* !CONFIG_SPI_FLASH_BAR */
 
@@ -1067,10 +1071,40 @@ static int spi_nor_erase_chip(struct spi_nor *nor)
 }
 
 /*
- * Initiate the erasure of a single sector. Returns the number of bytes erased
- * on success, a negative error code on error.
+ * Find the largest erase type which starts at @addr and fits into the @len
+ * bytes left to erase. Returns NULL if a single sector should be erased.
  */
-static int spi_nor_erase_sector(struct spi_nor *nor, u32 addr)
+static const struct spi_nor_erase_type *
+spi_nor_find_erase_type(struct spi_nor *nor, u32 addr, u32 len)
+{
+	const struct spi_nor_erase_type *best = NULL;
+	u32 erasesize = nor->mtd.erasesize;
+	int i;
+
+	if (nor->erase || nor->flags & (SNOR_F_HAS_PARALLEL | SNOR_F_HAS_STACKED))
+		return NULL;
+
+	for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+		const struct spi_nor_erase_type *type = &nor->erase_type[i];
+
+		if (type->size <= erasesize || type->size % erasesize ||
+		    !IS_ALIGNED(addr, type->size) || len < type->size)
+			continue;
+
+		if (!best || type->size > best->size)
+			best = type;
+	}
+
+	return best;
+}
+
+/*
+ * Initiate the erasure of a single sector, or of a larger block if @type is
+ * not NULL. Returns the number of bytes erased on success, a negative error
+ * code on error.
+ */
+static int spi_nor_erase_sector(struct spi_nor *nor, u32 addr,
+				const struct spi_nor_erase_type *type)
 {
 	struct spi_mem_op op =
 		SPI_MEM_OP(SPI_MEM_OP_CMD(nor->erase_opcode, 0),
@@ -1079,6 +1113,9 @@ static int spi_nor_erase_sector(struct spi_nor *nor, u32 addr)
 			   SPI_MEM_OP_NO_DATA);
 	int ret;
 
+	if (type)
+		op.cmd.opcode = type->opcode;
+
 	spi_nor_setup_op(nor, &op, nor->write_proto);
 
 	if (nor->erase)
@@ -1092,7 +1129,33 @@ static int spi_nor_erase_sector(struct spi_nor *nor, u32 addr)
 	if (ret)
 		return ret;
 
-	return nor->mtd.erasesize;
+	return type ? type->size : nor->mtd.erasesize;
+}
+
+/*
+ * Check whether @size bytes at @addr are erased already, reading them
+ * through @buf, which holds SZ_4K bytes. Returns 1 if they are, 0 if not
+ * and a negative error code on error.
+ */
+static int spi_nor_is_erased(struct spi_nor *nor, u32 addr, u32 size, u8 *buf)
+{
+	ssize_t ret;
+	u32 chunk;
+
+	while (size) {
+		chunk = min_t(u32, size, SZ_4K);
+		ret = spi_nor_read_data(nor, addr, chunk, buf);
+		if (ret < 0)
+			return ret;
+
+		if (memchr_inv(buf, 0xff, chunk))
+			return 0;
+
+		addr += chunk;
+		size -= chunk;
+	}
+
+	return 1;
 }
 
 /*
@@ -1102,8 +1165,10 @@ static int spi_nor_erase_sector(struct spi_nor *nor, u32 addr)
 static int spi_nor_erase(struct mtd_info *mtd, struct erase_info *instr)
 {
 	struct spi_nor *nor = mtd_to_spi_nor(mtd);
-	u32 addr, len, rem, offset, max_size;
+	const struct spi_nor_erase_type *type;
+	u32 addr, len, rem, offset, max_size, size;
 	bool addr_known = false;
+	u8 *blank_buf = NULL;
 	int ret, err;
 
 	dev_dbg(nor->dev, "at 0x%llx, len %lld\n", (long long)instr->addr,
@@ -1115,6 +1180,10 @@ static int spi_nor_erase(struct mtd_info *mtd, struct erase_info *instr)
 		goto err;
 	}
 
+	if (IS_ENABLED(CONFIG_SPI_FLASH_ERASE_SKIP_BLANK) &&
+	    !(nor->flags & (SNOR_F_HAS_PARALLEL | SNOR_F_HAS_STACKED)))
+		blank_buf = kmalloc(SZ_4K, GFP_KERNEL);
+
 	addr = instr->addr;
 	len = instr->len;
 	max_size = instr->len;
@@ -1146,15 +1215,35 @@ static int spi_nor_erase(struct mtd_info *mtd, struct erase_info *instr)
 		if (ret < 0)
 			goto erase_err;
 #endif
-		ret = write_enable(nor);
-		if (ret < 0)
-			goto erase_err;
-
 		if (len == mtd->size &&
 		    !(nor->flags & SNOR_F_NO_OP_CHIP_ERASE)) {
+			ret = write_enable(nor);
+			if (ret < 0)
+				goto erase_err;
+
 			ret = spi_nor_erase_chip(nor);
 		} else {
-			ret = spi_nor_erase_sector(nor, offset);
+			type = spi_nor_find_erase_type(nor, offset, len);
+			size = type ? type->size : mtd->erasesize;
+
+			/* Reading is much quicker than erasing */
+			if (blank_buf) {
+				ret = spi_nor_is_erased(nor, offset, size,
+							blank_buf);
+				if (ret < 0)
+					goto erase_err;
+				if (ret) {
+					addr += size;
+					len -= size;
+					continue;
+				}
+			}
+
+			ret = write_enable(nor);
+			if (ret < 0)
+				goto erase_err;
+
+			ret = spi_nor_erase_sector(nor, offset, type);
 		}
 		if (ret < 0)
 			goto erase_err;
@@ -1184,6 +1273,7 @@ erase_err:
 	if (!ret)
 		ret = err;
 
+	kfree(blank_buf);
 err:
 	if (ret) {
 		instr->fail_addr = addr_known ? addr : MTD_FAIL_ADDR_UNKNOWN;
@@ -2577,6 +2667,7 @@ static int spi_nor_parse_bfpt(struct spi_nor *nor,
 {
 	struct mtd_info *mtd = &nor->mtd;
 	struct sfdp_bfpt bfpt;
+	bool small_sectors = false;
 	size_t len;
 	int i, cmd, err;
 	u32 addr;
@@ -2653,6 +2744,7 @@ static int spi_nor_parse_bfpt(struct spi_nor *nor,
 	}
 
 	/* Sector Erase settings. */
+	memset(nor->erase_type, 0, sizeof(nor->erase_type));
 	for (i = 0; i < ARRAY_SIZE(sfdp_bfpt_erases); i++) {
 		const struct sfdp_bfpt_erase *er = &sfdp_bfpt_erases[i];
 		u32 erasesize;
@@ -2667,13 +2759,18 @@ static int spi_nor_parse_bfpt(struct spi_nor *nor,
 
 		erasesize = 1U << erasesize;
 		opcode = (half >> 8) & 0xff;
+		nor->erase_type[i].size = erasesize;
+		nor->erase_type[i].opcode = opcode;
 #ifdef CONFIG_SPI_FLASH_USE_4K_SECTORS
 		if (erasesize == SZ_4K) {
 			nor->erase_opcode = opcode;
 			mtd->erasesize = erasesize;
-			break;
+			small_sectors = true;
 		}
 #endif
+		if (small_sectors)
+			continue;
+
 		if (!mtd->erasesize || mtd->erasesize < erasesize) {
 			nor->erase_opcode = opcode;
 			mtd->erasesize = erasesize;
@@ -2989,6 +3086,8 @@ static int spi_nor_parse_sfdp(struct spi_nor *nor,
 		case SFDP_SECTOR_MAP_ID:
 			dev_info(nor->dev,
 				 "non-uniform erase sector maps are not supported yet.\n");
+			/* Erase types may not apply everywhere */
+			memset(nor->erase_type, 0, sizeof(nor->erase_type));
 			break;
 
 		case SFDP_SST_ID:
@@ -3172,6 +3271,7 @@ static int spi_nor_init_params(struct spi_nor *nor,
 		if (spi_nor_parse_sfdp(nor, &sfdp_params)) {
 			nor->addr_width = 0;
 			nor->mtd.erasesize = 0;
+			memset(nor->erase_type, 0, sizeof(nor->erase_type));
 		} else {
 			memcpy(params, &sfdp_params, sizeof(*params));
 		}
@@ -3554,6 +3654,12 @@ static int spi_nor_select_erase(struct spi_nor *nor,
 		return 0;
 
 #ifdef CONFIG_SPI_FLASH_USE_4K_SECTORS
+	/* Sector erase can still be used for aligned runs of small sectors */
+	if (info->flags & (SECT_4K | SECT_4K_PMC)) {
+		nor->erase_type[0].size = info->sector_size;
+		nor->erase_type[0].opcode = SPINOR_OP_SE;
+	}
+
 	/* prefer "small sector" erase if possible */
 	if (info->flags & SECT_4K) {
 		nor->erase_opcode = SPINOR_OP_BE_4K;
@@ -78,6 +78,7 @@
 #include <linux/random.h>
 #include <u-boot/crc.h>
 #else
+#include <bootstage.h>
 #include <div64.h>
 #include <linux/bug.h>
 #include <linux/err.h>
@@ -1242,6 +1243,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	if (!vidh)
 		goto out_ech;
 
+	ubi_io_hdr_cache_start(ubi);
 	for (pnum = start; pnum < ubi->peb_count; pnum++) {
 		cond_resched();
 
@@ -1250,6 +1252,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		if (err < 0)
 			goto out_vidh;
 	}
+	ubi_io_hdr_cache_stop(ubi);
 
 	ubi_msg(ubi, "scanning is finished");
 
@@ -1294,6 +1297,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	return 0;
 
 out_vidh:
+	ubi_io_hdr_cache_stop(ubi);
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
@@ -1407,6 +1411,8 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 	if (!ai)
 		return -ENOMEM;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_UBI_ATTACH, "ubi_attach");
+
 #ifdef CONFIG_MTD_UBI_FASTMAP
 	/* On small flash devices we disable fastmap in any case. */
 	if ((int)mtd_div_by_eb(ubi->mtd->size, ubi->mtd) <= UBI_FM_MAX_START) {
@@ -1481,6 +1487,7 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 #endif
 
 	destroy_ai(ai);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_UBI_ATTACH);
 	return 0;
 
 out_wl:
@@ -1490,6 +1497,7 @@ out_vtbl:
 	vfree(ubi->vtbl);
 out_ai:
 	destroy_ai(ai);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_UBI_ATTACH);
 	return err;
 }
 
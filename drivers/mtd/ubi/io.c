@@ -256,6 +256,9 @@ int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 	if (err)
 		return err;
 
+	if (ubi->hdr_buf_pnum == pnum)
+		ubi->hdr_buf_pnum = -1;
+
 	if (offset >= ubi->leb_start) {
 		/*
 		 * We write to the data area of the physical eraseblock. Make
@@ -327,6 +330,9 @@ static int do_sync_erase(struct ubi_device *ubi, int pnum)
 		return -EROFS;
 	}
 
+	if (ubi->hdr_buf_pnum == pnum)
+		ubi->hdr_buf_pnum = -1;
+
 retry:
 	init_waitqueue_head(&wq);
 	memset(&ei, 0, sizeof(struct erase_info));
@@ -697,6 +703,71 @@ bad:
 	return 1;
 }
 
+/**
+ * ubi_io_hdr_cache_start - read the EC and VID headers of a PEB together.
+ * @ubi: UBI device description object
+ *
+ * Attaching by scanning reads the EC header and then the VID header of every
+ * PEB. Between this call and 'ubi_io_hdr_cache_stop()' both headers are read
+ * with a single flash read, which halves the number of flash transactions of
+ * a full scan on flashes without a page cache of their own (e.g. SPI NAND).
+ * This is only done when both headers sit in the same min. I/O unit (or on
+ * NOR flash, which has no ECC), so that an ECC error is reported exactly as
+ * with separate reads.
+ */
+void ubi_io_hdr_cache_start(struct ubi_device *ubi)
+{
+	int len = ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize;
+
+	if (ubi->hdr_buf || (len > ubi->min_io_size && !ubi->nor_flash))
+		return;
+
+	/* Without the buffer, headers are simply read one by one */
+	ubi->hdr_buf = kmalloc(len, GFP_KERNEL);
+	ubi->hdr_buf_len = len;
+	ubi->hdr_buf_pnum = -1;
+}
+
+/**
+ * ubi_io_hdr_cache_stop - stop reading the headers of a PEB together.
+ * @ubi: UBI device description object
+ */
+void ubi_io_hdr_cache_stop(struct ubi_device *ubi)
+{
+	kfree(ubi->hdr_buf);
+	ubi->hdr_buf = NULL;
+	ubi->hdr_buf_pnum = -1;
+}
+
+/**
+ * ubi_io_read_hdr - read a header, going through the header cache.
+ * @ubi: UBI device description object
+ * @buf: buffer where to store the read data
+ * @pnum: physical eraseblock number to read from
+ * @offset: offset within the physical eraseblock from where to read
+ * @len: how many bytes to read
+ *
+ * Same as 'ubi_io_read()', except that while the header cache is enabled the
+ * data comes from the single read covering both headers of @pnum.
+ */
+static int ubi_io_read_hdr(struct ubi_device *ubi, void *buf, int pnum,
+			   int offset, int len)
+{
+	if (!ubi->hdr_buf)
+		return ubi_io_read(ubi, buf, pnum, offset, len);
+
+	ubi_assert(offset + len <= ubi->hdr_buf_len);
+
+	if (ubi->hdr_buf_pnum != pnum) {
+		ubi->hdr_buf_err = ubi_io_read(ubi, ubi->hdr_buf, pnum, 0,
+					       ubi->hdr_buf_len);
+		ubi->hdr_buf_pnum = pnum;
+	}
+
+	memcpy(buf, ubi->hdr_buf + offset, len);
+	return ubi->hdr_buf_err;
+}
+
 /**
  * ubi_io_read_ec_hdr - read and check an erase counter header.
  * @ubi: UBI device description object
@@ -728,7 +799,7 @@ int ubi_io_read_ec_hdr(struct ubi_device *ubi, int pnum,
 	dbg_io("read EC header from PEB %d", pnum);
 	ubi_assert(pnum >= 0 && pnum < ubi->peb_count);
 
-	read_err = ubi_io_read(ubi, ec_hdr, pnum, 0, UBI_EC_HDR_SIZE);
+	read_err = ubi_io_read_hdr(ubi, ec_hdr, pnum, 0, UBI_EC_HDR_SIZE);
 	if (read_err) {
 		if (read_err != UBI_IO_BITFLIPS && !mtd_is_eccerr(read_err))
 			return read_err;
@@ -1003,8 +1074,8 @@ int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 	ubi_assert(pnum >= 0 &&  pnum < ubi->peb_count);
 
 	p = (char *)vid_hdr - ubi->vid_hdr_shift;
-	read_err = ubi_io_read(ubi, p, pnum, ubi->vid_hdr_aloffset,
-			  ubi->vid_hdr_alsize);
+	read_err = ubi_io_read_hdr(ubi, p, pnum, ubi->vid_hdr_aloffset,
+				   ubi->vid_hdr_alsize);
 	if (read_err && read_err != UBI_IO_BITFLIPS && !mtd_is_eccerr(read_err))
 		return read_err;
 
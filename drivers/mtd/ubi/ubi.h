@@ -527,6 +527,11 @@ struct ubi_debug_info {
  *
  * @peb_buf: a buffer of PEB size used for different purposes
  * @buf_mutex: protects @peb_buf
+ * @hdr_buf: while scanning, the EC and VID headers of PEB @hdr_buf_pnum read
+ *           with a single flash read (%NULL when not scanning)
+ * @hdr_buf_len: size of @hdr_buf
+ * @hdr_buf_pnum: PEB whose headers are in @hdr_buf, or %-1
+ * @hdr_buf_err: return value of the read which filled @hdr_buf
  * @ckvol_mutex: serializes static volume checking when opening
  *
  * @dbg: debugging information for this UBI device
@@ -626,6 +631,10 @@ struct ubi_device {
 
 	void *peb_buf;
 	struct mutex buf_mutex;
+	void *hdr_buf;
+	int hdr_buf_len;
+	int hdr_buf_pnum;
+	int hdr_buf_err;
 	struct mutex ckvol_mutex;
 
 	struct ubi_debug_info dbg;
@@ -891,6 +900,8 @@ int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 int ubi_io_sync_erase(struct ubi_device *ubi, int pnum, int torture);
 int ubi_io_is_bad(const struct ubi_device *ubi, int pnum);
 int ubi_io_mark_bad(const struct ubi_device *ubi, int pnum);
+void ubi_io_hdr_cache_start(struct ubi_device *ubi);
+void ubi_io_hdr_cache_stop(struct ubi_device *ubi);
 int ubi_io_read_ec_hdr(struct ubi_device *ubi, int pnum,
 		       struct ubi_ec_hdr *ec_hdr, int verbose);
 int ubi_io_write_ec_hdr(struct ubi_device *ubi, int pnum,
@@ -680,6 +680,7 @@ static int eqos_get_phy_addr(struct eqos_priv *priv, struct udevice *dev)
 static int eqos_start(struct udevice *dev)
 {
 	struct eqos_priv *eqos = dev_get_priv(dev);
+	struct eth_pdata *pdata = dev_get_plat(dev);
 	int ret, i;
 	ulong rate;
 	u32 val, tx_fifo_sz, rx_fifo_sz, tqs, rqs, pbl;
@@ -923,6 +924,21 @@ static int eqos_start(struct udevice *dev)
 			EQOS_MAC_CONFIGURATION_CST |
 			EQOS_MAC_CONFIGURATION_ACS);
 
+	/*
+	 * Use the checksum engines if present. Since the MTL receive queue
+	 * is in store-and-forward mode, packets with bad checksums are then
+	 * dropped.
+	 */
+	val = readl(&eqos->mac_regs->hw_feature0);
+	pdata->offload = 0;
+	if (val & EQOS_MAC_HW_FEATURE0_RXCOESEL) {
+		setbits_le32(&eqos->mac_regs->configuration,
+			     EQOS_MAC_CONFIGURATION_IPC);
+		pdata->offload |= ETH_OFFLOAD_RX_CSUM;
+	}
+	if (val & EQOS_MAC_HW_FEATURE0_TXCOESEL)
+		pdata->offload |= ETH_OFFLOAD_TX_CSUM;
+
 	eqos_write_hwaddr(dev);
 
 	/* Configure DMA */
@@ -1032,6 +1048,7 @@ err_shutdown_phy:
 err_stop_resets:
 	eqos->config->ops->eqos_stop_resets(dev);
 err:
+	pdata->offload = 0;
 	pr_err("FAILED: %d\n", ret);
 	return ret;
 }
@@ -1039,10 +1056,13 @@ err:
 static void eqos_stop(struct udevice *dev)
 {
 	struct eqos_priv *eqos = dev_get_priv(dev);
+	struct eth_pdata *pdata = dev_get_plat(dev);
 	int i;
 
 	debug("%s(dev=%p):\n", __func__, dev);
 
+	pdata->offload = 0;
+
 	if (!eqos->started)
 		return;
 	eqos->started = false;
@@ -1092,7 +1112,9 @@ static void eqos_stop(struct udevice *dev)
 static int eqos_send(struct udevice *dev, void *packet, int length)
 {
 	struct eqos_priv *eqos = dev_get_priv(dev);
+	struct eth_pdata *pdata = dev_get_plat(dev);
 	struct eqos_desc *tx_desc;
+	u32 cic = 0;
 	int i;
 
 	debug("%s(dev=%p, packet=%p, length=%d):\n", __func__, dev, packet,
@@ -1113,7 +1135,10 @@ static int eqos_send(struct udevice *dev, void *packet, int length)
 	 * writes to the rest of the descriptor too.
 	 */
 	mb();
-	tx_desc->des3 = EQOS_DESC3_OWN | EQOS_DESC3_FD | EQOS_DESC3_LD | length;
+	if (pdata->offload & ETH_OFFLOAD_TX_CSUM)
+		cic = EQOS_DESC3_CIC_FULL;
+	tx_desc->des3 = EQOS_DESC3_OWN | EQOS_DESC3_FD | EQOS_DESC3_LD | cic |
+			length;
 	eqos->config->ops->eqos_flush_desc(tx_desc);
 
 	writel((ulong)eqos_get_desc(eqos, eqos->tx_desc_idx, false),
@@ -38,6 +38,7 @@ struct eqos_mac_regs {
 	u32 address0_low;				/* 0x304 */
 };
 
+#define EQOS_MAC_CONFIGURATION_IPC			BIT(27)
 #define EQOS_MAC_CONFIGURATION_GPSLCE			BIT(23)
 #define EQOS_MAC_CONFIGURATION_CST			BIT(21)
 #define EQOS_MAC_CONFIGURATION_ACS			BIT(20)
@@ -69,6 +70,8 @@ struct eqos_mac_regs {
 #define EQOS_MAC_RXQ_CTRL2_PSRQ0_SHIFT			0
 #define EQOS_MAC_RXQ_CTRL2_PSRQ0_MASK			0xff
 
+#define EQOS_MAC_HW_FEATURE0_RXCOESEL			BIT(16)
+#define EQOS_MAC_HW_FEATURE0_TXCOESEL			BIT(14)
 #define EQOS_MAC_HW_FEATURE0_MMCSEL_SHIFT		8
 #define EQOS_MAC_HW_FEATURE0_HDSEL_SHIFT		2
 #define EQOS_MAC_HW_FEATURE0_GMIISEL_SHIFT		1
@@ -216,6 +219,7 @@ struct eqos_desc {
 #define EQOS_DESC3_FD		BIT(29)
 #define EQOS_DESC3_LD		BIT(28)
 #define EQOS_DESC3_BUF1V	BIT(24)
+#define EQOS_DESC3_CIC_FULL	(3 << 16)
 
 #define EQOS_AXI_WIDTH_32	4
 #define EQOS_AXI_WIDTH_64	8
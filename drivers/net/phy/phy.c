@@ -8,6 +8,7 @@
  * Based loosely off of Linux's PHY Lib
  */
 #include <console.h>
+#include <cyclic.h>
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
@@ -215,6 +216,30 @@ int genphy_config_aneg(struct phy_device *phydev)
 	return result;
 }
 
+/**
+ * struct genphy_aneg_wait - job which waits for autonegotiation
+ *
+ * @work: Cyclic job
+ * @phydev: PHY which is autonegotiating
+ */
+struct genphy_aneg_wait {
+	struct cyclic_work work;
+	struct phy_device *phydev;
+};
+
+static int genphy_aneg_step(struct cyclic_work *work)
+{
+	struct genphy_aneg_wait *wait;
+	int mii_reg;
+
+	wait = container_of(work, struct genphy_aneg_wait, work);
+	mii_reg = phy_read(wait->phydev, MDIO_DEVAD_NONE, MII_BMSR);
+	if (mii_reg < 0)
+		return mii_reg;
+
+	return mii_reg & BMSR_ANEGCOMPLETE ? 0 : -EINPROGRESS;
+}
+
 /**
  * genphy_update_link - update link status in @phydev
  * @phydev: target phy_device struct
@@ -242,21 +267,24 @@ int genphy_update_link(struct phy_device *phydev)
 
 	if ((phydev->autoneg == AUTONEG_ENABLE) &&
 	    !(mii_reg & BMSR_ANEGCOMPLETE)) {
+		struct genphy_aneg_wait wait = { .phydev = phydev };
 		int i = 0;
+		int ret;
 
 		printf("%s Waiting for PHY auto negotiation to complete",
 		       phydev->dev->name);
-		while (!(mii_reg & BMSR_ANEGCOMPLETE)) {
-			/*
-			 * Timeout reached ?
-			 */
-			if (i > (CONFIG_PHY_ANEG_TIMEOUT / 50)) {
-				printf(" TIMEOUT !\n");
-				phydev->link = 0;
-				return -ETIMEDOUT;
-			}
 
+		/*
+		 * Poll through a cyclic job rather than a delay loop, so that
+		 * other jobs, e.g. another PHY's autonegotiation, make progress
+		 * while this one waits
+		 */
+		cyclic_work_start(&wait.work, genphy_aneg_step, 50000,
+				  CONFIG_PHY_ANEG_TIMEOUT * 1000ULL,
+				  phydev->dev->name);
+		while (cyclic_work_busy(&wait.work)) {
 			if (ctrlc()) {
+				cyclic_work_cancel(&wait.work);
 				puts("user interrupt!\n");
 				phydev->link = 0;
 				return -EINTR;
@@ -265,8 +293,15 @@ int genphy_update_link(struct phy_device *phydev)
 			if ((i++ % 10) == 0)
 				printf(".");
 
-			mii_reg = phy_read(phydev, MDIO_DEVAD_NONE, MII_BMSR);
 			mdelay(50);	/* 50 ms */
+			cyclic_work_poll(&wait.work);
+		}
+
+		ret = wait.work.result;
+		if (ret) {
+			printf(ret == -ETIMEDOUT ? " TIMEOUT !\n" : " failed\n");
+			phydev->link = 0;
+			return ret;
 		}
 		printf(" done\n");
 		phydev->link = 1;
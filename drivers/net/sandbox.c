@@ -386,6 +386,61 @@ static int sb_eth_free_pkt(struct udevice *dev, uchar *packet, int length)
 	return 0;
 }
 
+static int sb_eth_recv_burst(struct udevice *dev, int flags, uchar **packets,
+			     int *lengths, int max)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	int i, count;
+
+	if (skip_timeout) {
+		timer_test_add_offset(11000UL);
+		skip_timeout = false;
+	}
+
+	/* Copy the first packet straight to where its payload is going */
+	if (priv->recv_packets) {
+		packets[0] = net_rx_direct_buf(priv->recv_packet_length[0]);
+		if (packets[0]) {
+			lengths[0] = priv->recv_packet_length[0];
+			memcpy(packets[0], priv->recv_packet_buffer[0],
+			       lengths[0]);
+			return 1;
+		}
+	}
+
+	count = min(priv->recv_packets, max);
+	for (i = 0; i < count; i++) {
+		packets[i] = priv->recv_packet_buffer[i];
+		lengths[i] = priv->recv_packet_length[i];
+	}
+	debug("eth_sandbox: received %d packets, %d waiting\n", count,
+	      priv->recv_packets - count);
+
+	return count;
+}
+
+static int sb_eth_free_pkts(struct udevice *dev, uchar **packets, int *lengths,
+			    int count)
+{
+	struct eth_sandbox_priv *priv = dev_get_priv(dev);
+	int i;
+
+	count = min(count, priv->recv_packets);
+	priv->recv_packets -= count;
+
+	/* Move up any replies queued while the burst was being processed */
+	for (i = 0; i < priv->recv_packets; i++) {
+		priv->recv_packet_length[i] = priv->recv_packet_length[i + count];
+		memcpy(priv->recv_packet_buffer[i],
+		       priv->recv_packet_buffer[i + count],
+		       priv->recv_packet_length[i + count]);
+	}
+	for (i = priv->recv_packets; i < priv->recv_packets + count; i++)
+		priv->recv_packet_length[i] = 0;
+
+	return 0;
+}
+
 static void sb_eth_stop(struct udevice *dev)
 {
 	debug("eth_sandbox: Stop\n");
@@ -407,6 +462,8 @@ static const struct eth_ops sb_eth_ops = {
 	.send			= sb_eth_send,
 	.recv			= sb_eth_recv,
 	.free_pkt		= sb_eth_free_pkt,
+	.recv_burst		= sb_eth_recv_burst,
+	.free_pkts		= sb_eth_free_pkts,
 	.stop			= sb_eth_stop,
 	.write_hwaddr		= sb_eth_write_hwaddr,
 };
@@ -17,7 +17,8 @@
 #include <linux/compat.h>
 #include "nvme.h"
 
-#define NVME_Q_DEPTH		2
+/* a queue holds one entry fewer than its size */
+#define NVME_Q_DEPTH		(CONFIG_NVME_IO_DEPTH + 1)
 #define NVME_AQ_DEPTH		2
 #define NVME_SQ_SIZE(depth)	(depth * sizeof(struct nvme_command))
 #define NVME_CQ_SIZE(depth)	(depth * sizeof(struct nvme_completion))
@@ -25,7 +26,6 @@
 				      ARCH_DMA_MINALIGN)
 #define ADMIN_TIMEOUT		60
 #define IO_TIMEOUT		30
-#define MAX_PRP_POOL		512
 
 static int nvme_wait_csts(struct nvme_dev *dev, u32 mask, u32 val)
 {
@@ -44,12 +44,22 @@ static int nvme_wait_csts(struct nvme_dev *dev, u32 mask, u32 val)
 	return -ETIME;
 }
 
-static int nvme_setup_prps(struct nvme_dev *dev, u64 *prp2,
+/**
+ * nvme_setup_prps() - set up the PRP entries for a transfer
+ *
+ * @dev:	NVMe device
+ * @slot:	I/O slot whose PRP list is used, below @dev->io_depth
+ * @prp2:	Returns the value for the PRP2 field of the command
+ * @total_len:	Length of the transfer in bytes
+ * @dma_addr:	Address of the buffer
+ * Return: 0 if OK, -EINVAL if the transfer is too large for a PRP list
+ */
+static int nvme_setup_prps(struct nvme_dev *dev, int slot, u64 *prp2,
 			   int total_len, u64 dma_addr)
 {
 	u32 page_size = dev->page_size;
 	int offset = dma_addr & (page_size - 1);
-	u64 *prp_pool;
+	u64 *prp_list, *prp_pool;
 	int length = total_len;
 	int i, nprps;
 	u32 prps_per_page = page_size >> 3;
@@ -72,42 +82,59 @@ static int nvme_setup_prps(struct nvme_dev *dev, u64 *prp2,
 
 	nprps = DIV_ROUND_UP(length, page_size);
 	num_pages = DIV_ROUND_UP(nprps - 1, prps_per_page - 1);
+	if (nprps > dev->prp_entry_num)
+		return -EINVAL;
 
-	if (nprps > dev->prp_entry_num) {
-		free(dev->prp_pool);
-		/*
-		 * Always increase in increments of pages.  It doesn't waste
-		 * much memory and reduces the number of allocations.
-		 */
-		dev->prp_pool = memalign(page_size, num_pages * page_size);
-		if (!dev->prp_pool) {
-			printf("Error: malloc prp_pool fail\n");
-			return -ENOMEM;
-		}
-		dev->prp_entry_num = num_pages * (prps_per_page - 1) + 1;
-	}
-
-	prp_pool = dev->prp_pool;
+	prp_list = (void *)dev->prp_pool + slot * dev->prp_slot_size;
+	prp_pool = prp_list;
 	i = 0;
 	while (nprps) {
 		if ((i == (prps_per_page - 1)) && nprps > 1) {
 			*(prp_pool + i) = cpu_to_le64((ulong)prp_pool +
 					page_size);
 			i = 0;
-			prp_pool += page_size;
+			prp_pool += prps_per_page;
 		}
 		*(prp_pool + i++) = cpu_to_le64(dma_addr);
 		dma_addr += page_size;
 		nprps--;
 	}
-	*prp2 = (ulong)dev->prp_pool;
+	*prp2 = (ulong)prp_list;
 
-	flush_dcache_range((ulong)dev->prp_pool, (ulong)dev->prp_pool +
+	flush_dcache_range((ulong)prp_list, (ulong)prp_list +
 			   num_pages * page_size);
 
 	return 0;
 }
 
+/**
+ * nvme_alloc_prp_pool() - allocate a PRP list for each I/O slot
+ *
+ * Each list is large enough for the maximum transfer size, so no allocation
+ * is needed when submitting commands.
+ *
+ * @dev:	NVMe device, with max_transfer_shift and io_depth set up
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+static int nvme_alloc_prp_pool(struct nvme_dev *dev)
+{
+	u32 page_size = dev->page_size;
+	u32 prps_per_page = page_size >> 3;
+	u32 nprps, num_pages;
+
+	nprps = (1ULL << dev->max_transfer_shift) / page_size + 1;
+	num_pages = DIV_ROUND_UP(nprps - 1, prps_per_page - 1);
+
+	free(dev->prp_pool);
+	dev->prp_slot_size = num_pages * page_size;
+	dev->prp_entry_num = num_pages * (prps_per_page - 1) + 1;
+	dev->prp_pool = memalign(page_size, dev->io_depth * dev->prp_slot_size);
+	if (!dev->prp_pool)
+		return -ENOMEM;
+
+	return 0;
+}
+
 static __le16 nvme_get_cmd_id(void)
 {
 	static unsigned short cmdid;
@@ -158,54 +185,59 @@ static void nvme_submit_cmd(struct nvme_queue *nvmeq, struct nvme_command *cmd)
 	nvmeq->sq_tail = tail;
 }
 
-static int nvme_submit_sync_cmd(struct nvme_queue *nvmeq,
-				struct nvme_command *cmd,
-				u32 *result, unsigned timeout)
+/**
+ * nvme_next_completion() - look at the next completion queue entry
+ *
+ * The entry is not consumed; use nvme_pop_completion() for that.
+ *
+ * @nvmeq:	The queue to check
+ * @cidp:	Returns the ID of the command which completed
+ * @result:	Returns the command-specific result, if not NULL
+ * Return: 0 if a command completed OK, -EBUSY if there is no new entry, -EIO
+ * if a command completed with an error
+ */
+static int nvme_next_completion(struct nvme_queue *nvmeq, u16 *cidp,
+				u32 *result)
 {
-	struct nvme_ops *ops;
 	u16 head = nvmeq->cq_head;
 	u16 phase = nvmeq->cq_phase;
 	u16 status;
-	ulong start_time;
-	ulong timeout_us = timeout * 100000;
 
-	cmd->common.command_id = nvme_get_cmd_id();
-	nvme_submit_cmd(nvmeq, cmd);
-
-	start_time = timer_get_us();
-
-	for (;;) {
-		status = nvme_read_completion_status(nvmeq, head);
-		if ((status & 0x01) == phase)
-			break;
-		if (timeout_us > 0 && (timer_get_us() - start_time)
-		    >= timeout_us)
-			return -ETIMEDOUT;
-	}
-
-	ops = (struct nvme_ops *)nvmeq->dev->udev->driver->ops;
-	if (ops && ops->complete_cmd)
-		ops->complete_cmd(nvmeq, cmd);
+	status = nvme_read_completion_status(nvmeq, head);
+	if ((status & 0x01) != phase)
+		return -EBUSY;
 
+	*cidp = readw(&nvmeq->cqes[head].command_id);
 	status >>= 1;
 	if (status) {
 		printf("ERROR: status = %x, phase = %d, head = %d\n",
 		       status, phase, head);
-		status = 0;
-		if (++head == nvmeq->q_depth) {
-			head = 0;
-			phase = !phase;
-		}
-		writel(head, nvmeq->q_db + nvmeq->dev->db_stride);
-		nvmeq->cq_head = head;
-		nvmeq->cq_phase = phase;
-
 		return -EIO;
 	}
 
 	if (result)
 		*result = readl(&(nvmeq->cqes[head].result));
 
+	return 0;
+}
+
+/**
+ * nvme_pop_completion() - consume the next completion queue entry
+ *
+ * @nvmeq:	The queue the command was sent to
+ * @cmd:	The command which completed
+ */
+static void nvme_pop_completion(struct nvme_queue *nvmeq,
+				struct nvme_command *cmd)
+{
+	struct nvme_ops *ops;
+	u16 head = nvmeq->cq_head;
+	u16 phase = nvmeq->cq_phase;
+
+	ops = (struct nvme_ops *)nvmeq->dev->udev->driver->ops;
+	if (ops && ops->complete_cmd)
+		ops->complete_cmd(nvmeq, cmd);
+
 	if (++head == nvmeq->q_depth) {
 		head = 0;
 		phase = !phase;
@@ -213,8 +245,53 @@ static int nvme_submit_sync_cmd(struct nvme_queue *nvmeq,
 	writel(head, nvmeq->q_db + nvmeq->dev->db_stride);
 	nvmeq->cq_head = head;
 	nvmeq->cq_phase = phase;
+}
+
+/**
+ * nvme_check_completion() - check whether a command has completed
+ *
+ * If the command has completed, this consumes its completion queue entry.
+ * Only one command may be in flight on the queue.
+ *
+ * @nvmeq:	The queue the command was sent to
+ * @cmd:	The command which was sent
+ * @result:	Returns the command-specific result, if not NULL
+ * Return: 0 if completed OK, -EBUSY if not completed yet, -EIO on error
+ */
+static int nvme_check_completion(struct nvme_queue *nvmeq,
+				 struct nvme_command *cmd, u32 *result)
+{
+	u16 cid;
+	int ret;
+
+	ret = nvme_next_completion(nvmeq, &cid, result);
+	if (ret != -EBUSY)
+		nvme_pop_completion(nvmeq, cmd);
+
+	return ret;
+}
+
+static int nvme_submit_sync_cmd(struct nvme_queue *nvmeq,
+				struct nvme_command *cmd,
+				u32 *result, unsigned timeout)
+{
+	ulong start_time;
+	ulong timeout_us = timeout * 100000;
+	int ret;
+
+	cmd->common.command_id = nvme_get_cmd_id();
+	nvme_submit_cmd(nvmeq, cmd);
 
-	return status;
+	start_time = timer_get_us();
+
+	for (;;) {
+		ret = nvme_check_completion(nvmeq, cmd, result);
+		if (ret != -EBUSY)
+			return ret;
+		if (timeout_us > 0 && (timer_get_us() - start_time)
+		    >= timeout_us)
+			return -ETIMEDOUT;
+	}
 }
 
 static int nvme_submit_admin_cmd(struct nvme_dev *dev, struct nvme_command *cmd,
@@ -732,6 +809,7 @@ static int nvme_blk_probe(struct udevice *udev)
 	desc->lba = le64_to_cpu(id->nsze);
 	desc->log2blksz = ns->lba_shift;
 	desc->blksz = 1 << ns->lba_shift;
+	desc->max_blocks = 1 << (ndev->max_transfer_shift - ns->lba_shift);
 	desc->bdev = udev;
 	memcpy(desc->vendor, ndev->vendor, sizeof(ndev->vendor));
 	memcpy(desc->product, ndev->serial, sizeof(ndev->serial));
@@ -741,65 +819,247 @@ static int nvme_blk_probe(struct udevice *udev)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+/**
+ * nvme_async_issue() - submit the next command of an asynchronous read
+ *
+ * @dev:	NVMe device with an asynchronous read in progress
+ * Return: 0 if OK, -ve on error
+ */
+static int nvme_async_issue(struct nvme_dev *dev)
+{
+	struct nvme_async *async = &dev->async;
+	struct nvme_ns *ns = async->ns;
+	struct nvme_command *c = &async->cmd;
+	u16 lbas = 1 << (dev->max_transfer_shift - ns->lba_shift);
+	u64 prp2;
+
+	if (async->left < lbas)
+		lbas = async->left;
+	if (nvme_setup_prps(dev, 0, &prp2, lbas << ns->lba_shift, async->buf))
+		return -EIO;
+
+	memset(c, '\0', sizeof(*c));
+	c->rw.opcode = async->req->write ? nvme_cmd_write : nvme_cmd_read;
+	c->rw.nsid = cpu_to_le32(ns->ns_id);
+	c->rw.slba = cpu_to_le64(async->slba);
+	c->rw.length = cpu_to_le16(lbas - 1);
+	c->rw.prp1 = cpu_to_le64(async->buf);
+	c->rw.prp2 = cpu_to_le64(prp2);
+	c->common.command_id = nvme_get_cmd_id();
+	async->lbas = lbas;
+	async->start_us = timer_get_us();
+	nvme_submit_cmd(dev->queues[NVME_IO_Q], c);
+
+	return 0;
+}
+
+/**
+ * nvme_async_finish() - finish the asynchronous read on a device
+ *
+ * @dev:	NVMe device with an asynchronous read in progress
+ * @ret:	Result of the read, 0 if OK
+ */
+static void nvme_async_finish(struct nvme_dev *dev, int ret)
+{
+	struct nvme_async *async = &dev->async;
+	struct blk_request *req = async->req;
+
+	req->done = (async->buf - (uintptr_t)req->buf) >>
+		async->ns->lba_shift;
+	req->ret = ret;
+	if (!req->write)
+		invalidate_dcache_range((ulong)req->buf, (ulong)req->buf +
+					(req->blkcnt << async->ns->lba_shift));
+	async->req = NULL;
+}
+
+/**
+ * nvme_async_step() - check progress of the asynchronous read on a device
+ *
+ * @dev:	NVMe device with an asynchronous read in progress
+ * Return: 0 if the read is finished, -EBUSY if not, other -ve on error
+ */
+static int nvme_async_step(struct nvme_dev *dev)
+{
+	struct nvme_async *async = &dev->async;
+	int ret;
+
+	ret = nvme_check_completion(dev->queues[NVME_IO_Q], &async->cmd, NULL);
+	if (ret == -EBUSY) {
+		if (timer_get_us() - async->start_us < IO_TIMEOUT * 100000)
+			return -EBUSY;
+		ret = -ETIMEDOUT;
+	}
+	if (!ret) {
+		async->slba += async->lbas;
+		async->left -= async->lbas;
+		async->buf += (ulong)async->lbas << async->ns->lba_shift;
+		if (async->left) {
+			ret = nvme_async_issue(dev);
+			if (!ret)
+				return -EBUSY;
+		}
+	}
+	nvme_async_finish(dev, ret);
+
+	return ret;
+}
+
+/* Wait for any asynchronous read, so that the I/O queue can be used */
+static void nvme_async_wait(struct nvme_dev *dev)
+{
+	while (dev->async.req && nvme_async_step(dev) == -EBUSY)
+		;
+}
+
+static int nvme_blk_submit(struct udevice *udev, struct blk_request *req)
+{
+	struct nvme_ns *ns = dev_get_priv(udev);
+	struct nvme_dev *dev = ns->dev;
+	struct nvme_async *async = &dev->async;
+	struct blk_desc *desc = dev_get_uclass_plat(udev);
+	int ret;
+
+	nvme_async_wait(dev);
+
+	flush_dcache_range((ulong)req->buf,
+			   (ulong)req->buf + (req->blkcnt << desc->log2blksz));
+	async->req = req;
+	async->ns = ns;
+	async->slba = req->start;
+	async->left = req->blkcnt;
+	async->buf = (uintptr_t)req->buf;
+	ret = nvme_async_issue(dev);
+	if (ret)
+		async->req = NULL;
+
+	return ret;
+}
+
+static int nvme_blk_poll(struct udevice *udev, struct blk_request *req)
+{
+	struct nvme_ns *ns = dev_get_priv(udev);
+
+	/* finished already, because another operation needed the queue */
+	if (ns->dev->async.req != req)
+		return req->ret;
+
+	return nvme_async_step(ns->dev);
+}
+#else
+static inline void nvme_async_wait(struct nvme_dev *dev) {}
+#endif
+
+/**
+ * nvme_blk_rw() - read or write blocks using the I/O queue
+ *
+ * The transfer is split into commands of at most the maximum transfer size.
+ * Up to io_depth of these are kept in flight, each with its own PRP list, and
+ * a new one is submitted as each completes.
+ *
+ * @udev:	Block device to access
+ * @blknr:	First block to access
+ * @blkcnt:	Number of blocks to access
+ * @buffer:	Buffer to read into or write from
+ * @read:	true to read, false to write
+ * Return: number of blocks transferred before the first error
+ */
 static ulong nvme_blk_rw(struct udevice *udev, lbaint_t blknr,
 			 lbaint_t blkcnt, void *buffer, bool read)
 {
 	struct nvme_ns *ns = dev_get_priv(udev);
 	struct nvme_dev *dev = ns->dev;
-	struct nvme_command c;
+	struct nvme_queue *nvmeq = dev->queues[NVME_IO_Q];
+	struct nvme_command cmds[CONFIG_NVME_IO_DEPTH];
 	struct blk_desc *desc = dev_get_uclass_plat(udev);
-	int status;
-	u64 prp2;
 	u64 total_len = blkcnt << desc->log2blksz;
-	u64 temp_len = total_len;
 	uintptr_t temp_buffer = (uintptr_t)buffer;
-
 	u64 slba = blknr;
+	u64 end = blknr + blkcnt;
+	u64 failed = end;
 	u16 lbas = 1 << (dev->max_transfer_shift - ns->lba_shift);
-	u64 total_lbas = blkcnt;
+	ulong start_us = 0;
+	u32 busy = 0;
+	u16 cid;
+	int ret, i;
+
+	nvme_async_wait(dev);
 
 	flush_dcache_range((unsigned long)buffer,
 			   (unsigned long)buffer + total_len);
 
-	c.rw.opcode = read ? nvme_cmd_read : nvme_cmd_write;
-	c.rw.flags = 0;
-	c.rw.nsid = cpu_to_le32(ns->ns_id);
-	c.rw.control = 0;
-	c.rw.dsmgmt = 0;
-	c.rw.reftag = 0;
-	c.rw.apptag = 0;
-	c.rw.appmask = 0;
-	c.rw.metadata = 0;
-
-	while (total_lbas) {
-		if (total_lbas < lbas) {
-			lbas = (u16)total_lbas;
-			total_lbas = 0;
-		} else {
-			total_lbas -= lbas;
+	for (;;) {
+		/* keep every slot busy until the end, or an error */
+		while (slba < end && failed == end) {
+			struct nvme_command *c;
+			u16 n = min_t(u64, lbas, end - slba);
+			u64 prp2;
+
+			for (i = 0; i < dev->io_depth && (busy & BIT(i)); i++)
+				;
+			if (i == dev->io_depth)
+				break;
+			if (nvme_setup_prps(dev, i, &prp2, n << ns->lba_shift,
+					    temp_buffer)) {
+				failed = slba;
+				break;
+			}
+
+			c = &cmds[i];
+			memset(c, '\0', sizeof(*c));
+			c->rw.opcode = read ? nvme_cmd_read : nvme_cmd_write;
+			c->rw.nsid = cpu_to_le32(ns->ns_id);
+			c->rw.slba = cpu_to_le64(slba);
+			c->rw.length = cpu_to_le16(n - 1);
+			c->rw.prp1 = cpu_to_le64(temp_buffer);
+			c->rw.prp2 = cpu_to_le64(prp2);
+			c->common.command_id = nvme_get_cmd_id();
+			nvme_submit_cmd(nvmeq, c);
+			busy |= BIT(i);
+			start_us = timer_get_us();
+
+			slba += n;
+			temp_buffer += (ulong)n << ns->lba_shift;
 		}
+		if (!busy)
+			break;
 
-		if (nvme_setup_prps(dev, &prp2,
-				    lbas << ns->lba_shift, temp_buffer))
-			return -EIO;
-		c.rw.slba = cpu_to_le64(slba);
-		slba += lbas;
-		c.rw.length = cpu_to_le16(lbas - 1);
-		c.rw.prp1 = cpu_to_le64(temp_buffer);
-		c.rw.prp2 = cpu_to_le64(prp2);
-		status = nvme_submit_sync_cmd(dev->queues[NVME_IO_Q],
-				&c, NULL, IO_TIMEOUT);
-		if (status)
+		ret = nvme_next_completion(nvmeq, &cid, NULL);
+		if (ret == -EBUSY) {
+			if (timer_get_us() - start_us < IO_TIMEOUT * 100000)
+				continue;
+			/* give up on everything still in flight */
+			for (i = 0; i < dev->io_depth; i++) {
+				if (busy & BIT(i))
+					failed = min_t(u64, failed,
+						le64_to_cpu(cmds[i].rw.slba));
+			}
 			break;
-		temp_len -= (u32)lbas << ns->lba_shift;
-		temp_buffer += lbas << ns->lba_shift;
+		}
+
+		for (i = 0; i < dev->io_depth; i++) {
+			if ((busy & BIT(i)) && cmds[i].common.command_id == cid)
+				break;
+		}
+		if (i == dev->io_depth) {
+			/* stale entry from an earlier, abandoned command */
+			nvme_pop_completion(nvmeq, NULL);
+			continue;
+		}
+		nvme_pop_completion(nvmeq, &cmds[i]);
+		busy &= ~BIT(i);
+		start_us = timer_get_us();
+		if (ret)
+			failed = min_t(u64, failed,
+				       le64_to_cpu(cmds[i].rw.slba));
 	}
 
 	if (read)
 		invalidate_dcache_range((unsigned long)buffer,
 					(unsigned long)buffer + total_len);
 
-	return (total_len - temp_len) >> desc->log2blksz;
+	return failed - blknr;
 }
 
 static ulong nvme_blk_read(struct udevice *udev, lbaint_t blknr,
@@ -817,6 +1077,10 @@ static ulong nvme_blk_write(struct udevice *udev, lbaint_t blknr,
 static const struct blk_ops nvme_blk_ops = {
 	.read	= nvme_blk_read,
 	.write	= nvme_blk_write,
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	.submit	= nvme_blk_submit,
+	.poll	= nvme_blk_poll,
+#endif
 };
 
 U_BOOT_DRIVER(nvme_blk) = {
@@ -830,6 +1094,7 @@ U_BOOT_DRIVER(nvme_blk) = {
 int nvme_init(struct udevice *udev)
 {
 	struct nvme_dev *ndev = dev_get_priv(udev);
+	struct nvme_ops *ops;
 	struct nvme_id_ns *id;
 	int ret;
 
@@ -860,15 +1125,6 @@ int nvme_init(struct udevice *udev)
 		goto free_queue;
 	}
 
-	/* Allocate after the page size is known */
-	ndev->prp_pool = memalign(ndev->page_size, MAX_PRP_POOL);
-	if (!ndev->prp_pool) {
-		ret = -ENOMEM;
-		printf("Error: %s: Out of memory!\n", udev->name);
-		goto free_nvme;
-	}
-	ndev->prp_entry_num = MAX_PRP_POOL >> 3;
-
 	ret = nvme_setup_io_queues(ndev);
 	if (ret) {
 		log_debug("Unable to setup I/O queues(err=%dE)\n", ret);
@@ -877,6 +1133,17 @@ int nvme_init(struct udevice *udev)
 
 	nvme_get_info_from_identify(ndev);
 
+	/* The Apple controller handles one command per queue at a time */
+	ops = (struct nvme_ops *)udev->driver->ops;
+	ndev->io_depth = ops && ops->submit_cmd ? 1 : ndev->q_depth - 1;
+
+	/* Allocate after the page and transfer sizes are known */
+	ret = nvme_alloc_prp_pool(ndev);
+	if (ret) {
+		printf("Error: %s: Out of memory!\n", udev->name);
+		goto free_queue;
+	}
+
 	/* Create a blk device for each namespace */
 
 	id = memalign(ndev->page_size, sizeof(struct nvme_id_ns));
@@ -594,6 +594,31 @@ enum {
 	NVME_CSTS_SHST_MASK	= 3 << 2,
 };
 
+struct blk_request;
+
+/**
+ * struct nvme_async - an asynchronous read or write in progress on the I/O queue
+ *
+ * @req:	Block request being handled, NULL if none
+ * @ns:		Namespace being accessed
+ * @cmd:	Command currently in flight
+ * @slba:	First LBA of the next command
+ * @left:	Number of LBAs not yet submitted
+ * @buf:	Buffer position of the next command
+ * @lbas:	Number of LBAs in the command in flight
+ * @start_us:	Time at which the command in flight was submitted
+ */
+struct nvme_async {
+	struct blk_request *req;
+	struct nvme_ns *ns;
+	struct nvme_command cmd;
+	u64 slba;
+	u64 left;
+	uintptr_t buf;
+	u16 lbas;
+	ulong start_us;
+};
+
 /* Represents an NVM Express device. Each nvme_dev is a PCI function. */
 struct nvme_dev {
 	struct udevice *udev;
@@ -618,9 +643,12 @@ struct nvme_dev {
 	u32 stripe_size;
 	u32 page_size;
 	u8 vwc;
-	u64 *prp_pool;
-	u32 prp_entry_num;
+	u64 *prp_pool;		/* one PRP list per I/O slot */
+	u32 prp_entry_num;	/* PRP entries in each list */
+	u32 prp_slot_size;	/* bytes used by each list */
+	int io_depth;		/* I/O commands which may be in flight */
 	u32 nn;
+	struct nvme_async async;
 };
 
 /* Admin queue and a single I/O queue. */
@@ -858,6 +858,43 @@ __weak extern void board_pci_fixup_dev(struct udevice *bus, struct udevice *dev)
 {
 }
 
+/**
+ * pci_bus_only_dev0() - Check if a bus can only have a device 0
+ *
+ * The link below a PCIe Root Port or Downstream Port leads to a single
+ * device, so there is no need to probe devices 1-31, which can be slow on
+ * some controllers. ARI forwarding lifts this, since the extra functions
+ * then use the device bits too.
+ *
+ * @bus: Bus to check
+ * Return: true if only device 0 needs to be scanned
+ */
+static bool pci_bus_only_dev0(struct udevice *bus)
+{
+	u16 flags, ctl2;
+	int pos, type;
+
+	if (!device_is_on_pci_bus(bus))
+		return false;
+
+	pos = dm_pci_find_capability(bus, PCI_CAP_ID_EXP);
+	if (!pos)
+		return false;
+
+	dm_pci_read_config16(bus, pos + PCI_EXP_FLAGS, &flags);
+	type = (flags & PCI_EXP_FLAGS_TYPE) >> 4;
+	if (type != PCI_EXP_TYPE_ROOT_PORT && type != PCI_EXP_TYPE_DOWNSTREAM)
+		return false;
+
+	if (IS_ENABLED(CONFIG_PCI_ARID)) {
+		dm_pci_read_config16(bus, pos + PCI_EXP_DEVCTL2, &ctl2);
+		if (ctl2 & PCI_EXP_DEVCTL2_ARI)
+			return false;
+	}
+
+	return true;
+}
+
 int pci_bind_bus_devices(struct udevice *bus)
 {
 	ulong vendor, device;
@@ -870,6 +907,8 @@ int pci_bind_bus_devices(struct udevice *bus)
 	found_multi = false;
 	end = PCI_BDF(dev_seq(bus), PCI_MAX_PCI_DEVICES - 1,
 		      PCI_MAX_PCI_FUNCTIONS - 1);
+	if (pci_bus_only_dev0(bus))
+		end = PCI_BDF(dev_seq(bus), 0, PCI_MAX_PCI_FUNCTIONS - 1);
 	for (bdf = PCI_BDF(dev_seq(bus), 0, 0); bdf <= end;
 	     bdf += PCI_BDF(0, 0, 1)) {
 		struct pci_child_plat *pplat;
@@ -1113,6 +1152,7 @@ static int pci_uclass_pre_probe(struct udevice *bus)
 		if (ret)
 			return ret;
 		bus->seq_ = uclass_find_next_free_seq(uc);
+		uclass_index_invalidate(uc);
 	}
 
 	/* For bridges, use the top-level PCI controller */
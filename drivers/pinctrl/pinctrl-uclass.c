@@ -45,6 +45,102 @@ static int pinctrl_config_one(struct udevice *config)
 	return ops->set_state(pctldev, config);
 }
 
+#if CONFIG_IS_ENABLED(PINCTRL_STATE_CACHE)
+/**
+ * struct pinctrl_state_entry - pin configurations making up a resolved state
+ *
+ * @sibling: node in the list of cached states
+ * @node: device-tree node of the peripheral
+ * @state: state number (N in "pinctrl-N")
+ * @count: number of entries in @configs
+ * @configs: pin-configuration devices to apply, in order
+ */
+struct pinctrl_state_entry {
+	struct list_head sibling;
+	ofnode node;
+	int state;
+	int count;
+	struct udevice *configs[];
+};
+
+/**
+ * struct pinconfig_uc_priv - uclass-private data for PINCONFIG
+ *
+ * @states: list of struct pinctrl_state_entry
+ */
+struct pinconfig_uc_priv {
+	struct list_head states;
+};
+
+static struct list_head *pinctrl_state_list(void)
+{
+	struct pinconfig_uc_priv *priv;
+	struct uclass *uc;
+
+	if (uclass_get(UCLASS_PINCONFIG, &uc))
+		return NULL;
+	priv = uclass_get_priv(uc);
+
+	return &priv->states;
+}
+
+static struct pinctrl_state_entry *pinctrl_state_find(struct udevice *dev,
+						      int state)
+{
+	struct pinctrl_state_entry *entry;
+	struct list_head *states;
+
+	states = pinctrl_state_list();
+	if (!states)
+		return NULL;
+	list_for_each_entry(entry, states, sibling) {
+		if (entry->state == state &&
+		    ofnode_equal(entry->node, dev_ofnode(dev)))
+			return entry;
+	}
+
+	return NULL;
+}
+
+static void pinctrl_state_flush(struct list_head *states)
+{
+	struct pinctrl_state_entry *entry, *next;
+
+	list_for_each_entry_safe(entry, next, states, sibling) {
+		list_del(&entry->sibling);
+		free(entry);
+	}
+}
+
+static int pinconfig_uc_init(struct uclass *uc)
+{
+	struct pinconfig_uc_priv *priv = uclass_get_priv(uc);
+
+	INIT_LIST_HEAD(&priv->states);
+
+	return 0;
+}
+
+static int pinconfig_uc_destroy(struct uclass *uc)
+{
+	struct pinconfig_uc_priv *priv = uclass_get_priv(uc);
+
+	pinctrl_state_flush(&priv->states);
+
+	return 0;
+}
+
+/* cached states may point to this device, so drop them all */
+static int pinconfig_pre_unbind(struct udevice *dev)
+{
+	struct pinconfig_uc_priv *priv = uclass_get_priv(dev->uclass);
+
+	pinctrl_state_flush(&priv->states);
+
+	return 0;
+}
+#endif
+
 /**
  * pinctrl_select_state_full() - full implementation of pinctrl_select_state
  *
@@ -59,6 +155,10 @@ static int pinctrl_select_state_full(struct udevice *dev, const char *statename)
 	uint32_t phandle;
 	struct udevice *config;
 	int state, size, i, ret;
+#if CONFIG_IS_ENABLED(PINCTRL_STATE_CACHE)
+	struct pinctrl_state_entry *entry;
+	struct list_head *states;
+#endif
 
 	state = dev_read_stringlist_search(dev, "pinctrl-names", statename);
 	if (state < 0) {
@@ -72,12 +172,35 @@ static int pinctrl_select_state_full(struct udevice *dev, const char *statename)
 			return -ENOSYS;
 	}
 
+#if CONFIG_IS_ENABLED(PINCTRL_STATE_CACHE)
+	/* skip the phandle lookups if this state was resolved before */
+	entry = pinctrl_state_find(dev, state);
+	if (entry) {
+		for (i = 0; i < entry->count; i++) {
+			ret = pinctrl_config_one(entry->configs[i]);
+			if (ret)
+				dev_warn(dev, "%s: pinctrl_config_one: err=%d\n",
+					 __func__, ret);
+		}
+
+		return 0;
+	}
+#endif
+
 	snprintf(propname, sizeof(propname), "pinctrl-%d", state);
 	list = dev_read_prop(dev, propname, &size);
 	if (!list)
 		return -ENOSYS;
 
 	size /= sizeof(*list);
+#if CONFIG_IS_ENABLED(PINCTRL_STATE_CACHE)
+	entry = malloc(sizeof(*entry) + size * sizeof(entry->configs[0]));
+	if (entry) {
+		entry->node = dev_ofnode(dev);
+		entry->state = state;
+		entry->count = 0;
+	}
+#endif
 	for (i = 0; i < size; i++) {
 		phandle = fdt32_to_cpu(*list++);
 		ret = uclass_get_device_by_phandle_id(UCLASS_PINCONFIG, phandle,
@@ -87,6 +210,10 @@ static int pinctrl_select_state_full(struct udevice *dev, const char *statename)
 				__func__, ret);
 			continue;
 		}
+#if CONFIG_IS_ENABLED(PINCTRL_STATE_CACHE)
+		if (entry)
+			entry->configs[entry->count++] = config;
+#endif
 
 		ret = pinctrl_config_one(config);
 		if (ret) {
@@ -96,6 +223,15 @@ static int pinctrl_select_state_full(struct udevice *dev, const char *statename)
 		}
 	}
 
+#if CONFIG_IS_ENABLED(PINCTRL_STATE_CACHE)
+	/* only remember states whose configs could all be found */
+	states = pinctrl_state_list();
+	if (entry && entry->count == size && states)
+		list_add(&entry->sibling, states);
+	else
+		free(entry);
+#endif
+
 	return 0;
 }
 
@@ -167,6 +303,12 @@ UCLASS_DRIVER(pinconfig) = {
 	.id = UCLASS_PINCONFIG,
 #if CONFIG_IS_ENABLED(PINCONF_RECURSIVE)
 	.post_bind = pinconfig_post_bind,
+#endif
+#if CONFIG_IS_ENABLED(PINCTRL_STATE_CACHE)
+	.init = pinconfig_uc_init,
+	.destroy = pinconfig_uc_destroy,
+	.pre_unbind = pinconfig_pre_unbind,
+	.priv_auto = sizeof(struct pinconfig_uc_priv),
 #endif
 	.name = "pinconfig",
 };
@@ -10,11 +10,14 @@
 #include <errno.h>
 #include <dm.h>
 #include <log.h>
+#include <malloc.h>
 #include <vsprintf.h>
 #include <dm/lists.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 #include <power/pmic.h>
+#include <asm/bitops.h>
+#include <linux/bitmap.h>
 #include <linux/ctype.h>
 
 #if CONFIG_IS_ENABLED(PMIC_CHILDREN)
@@ -108,6 +111,47 @@ int pmic_reg_count(struct udevice *dev)
 	return ops->reg_count(dev);
 }
 
+/**
+ * pmic_cache_get() - Look up a register in the cache
+ *
+ * @dev: PMIC device
+ * @reg: Register to look up
+ * @valp: Returns the cached value
+ * Return: true if the value was cached
+ */
+static bool pmic_cache_get(struct udevice *dev, uint reg, u32 *valp)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	if (!priv->cache || reg >= priv->cache_count ||
+	    !test_bit(reg, priv->cache_valid))
+		return false;
+	*valp = priv->cache[reg];
+
+	return true;
+}
+
+/**
+ * pmic_cache_set() - Record the value of a register, if it can be cached
+ *
+ * @dev: PMIC device
+ * @reg: Register that was read or written
+ * @val: Value it now holds
+ */
+static void pmic_cache_set(struct udevice *dev, uint reg, u32 val)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+
+	if (!priv->cache || reg >= priv->cache_count ||
+	    ops->reg_volatile(dev, reg))
+		return;
+	if (priv->trans_len < sizeof(val))
+		val &= (1U << (priv->trans_len * 8)) - 1;
+	priv->cache[reg] = val;
+	generic_set_bit(reg, priv->cache_valid);
+}
+
 int pmic_read(struct udevice *dev, uint reg, uint8_t *buffer, int len)
 {
 	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
@@ -131,6 +175,16 @@ int pmic_write(struct udevice *dev, uint reg, const uint8_t *buffer, int len)
 	if (!ops || !ops->write)
 		return -ENOSYS;
 
+	/* raw writes may cover several registers, so just forget them */
+	if (IS_ENABLED(CONFIG_PMIC_REG_CACHE)) {
+		struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+		uint i;
+
+		for (i = reg; priv->cache && i < reg + len &&
+		     i < priv->cache_count; i++)
+			generic_clear_bit(i, priv->cache_valid);
+	}
+
 	return ops->write(dev, reg, buffer, len);
 }
 
@@ -145,11 +199,18 @@ int pmic_reg_read(struct udevice *dev, uint reg)
 		return -EINVAL;
 	}
 
+	if (IS_ENABLED(CONFIG_PMIC_REG_CACHE) && pmic_cache_get(dev, reg, &val))
+		return val;
+
 	debug("%s: reg=%x priv->trans_len:%d", __func__, reg, priv->trans_len);
 	ret = pmic_read(dev, reg, (uint8_t *)&val, priv->trans_len);
 	debug(", value=%x, ret=%d\n", val, ret);
+	if (ret)
+		return ret;
+	if (IS_ENABLED(CONFIG_PMIC_REG_CACHE))
+		pmic_cache_set(dev, reg, val);
 
-	return ret ? ret : val;
+	return val;
 }
 
 int pmic_reg_write(struct udevice *dev, uint reg, uint value)
@@ -166,6 +227,8 @@ int pmic_reg_write(struct udevice *dev, uint reg, uint value)
 	      priv->trans_len);
 	ret = pmic_write(dev, reg, (uint8_t *)&value, priv->trans_len);
 	debug(", ret=%d\n", ret);
+	if (!ret && IS_ENABLED(CONFIG_PMIC_REG_CACHE))
+		pmic_cache_set(dev, reg, value);
 
 	return ret;
 }
@@ -173,7 +236,7 @@ int pmic_reg_write(struct udevice *dev, uint reg, uint value)
 int pmic_clrsetbits(struct udevice *dev, uint reg, uint clr, uint set)
 {
 	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
-	u32 val = 0;
+	u32 val = 0, old;
 	int ret;
 
 	if (priv->trans_len < 1 || priv->trans_len > sizeof(val)) {
@@ -181,12 +244,26 @@ int pmic_clrsetbits(struct udevice *dev, uint reg, uint clr, uint set)
 		return -EINVAL;
 	}
 
+	if (IS_ENABLED(CONFIG_PMIC_REG_CACHE) &&
+	    pmic_cache_get(dev, reg, &val)) {
+		old = val;
+		val = (val & ~clr) | set;
+		if (val == old)
+			return 0;
+
+		return pmic_reg_write(dev, reg, val);
+	}
+
 	ret = pmic_read(dev, reg, (uint8_t *)&val, priv->trans_len);
 	if (ret < 0)
 		return ret;
 
 	val = (val & ~clr) | set;
-	return pmic_write(dev, reg, (uint8_t *)&val, priv->trans_len);
+	ret = pmic_write(dev, reg, (uint8_t *)&val, priv->trans_len);
+	if (!ret && IS_ENABLED(CONFIG_PMIC_REG_CACHE))
+		pmic_cache_set(dev, reg, val);
+
+	return ret;
 }
 
 static int pmic_pre_probe(struct udevice *dev)
@@ -197,9 +274,50 @@ static int pmic_pre_probe(struct udevice *dev)
 	return 0;
 }
 
+static int pmic_post_probe(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+	const struct dm_pmic_ops *ops = dev_get_driver_ops(dev);
+	int count;
+
+	if (!IS_ENABLED(CONFIG_PMIC_REG_CACHE) || !ops || !ops->reg_volatile)
+		return 0;
+
+	count = pmic_reg_count(dev);
+	if (count <= 0)
+		return 0;
+
+	priv->cache = calloc(count, sizeof(*priv->cache));
+	priv->cache_valid = calloc(BITS_TO_LONGS(count), sizeof(ulong));
+	if (!priv->cache || !priv->cache_valid) {
+		free(priv->cache);
+		free(priv->cache_valid);
+		priv->cache = NULL;
+		priv->cache_valid = NULL;
+		return -ENOMEM;
+	}
+	priv->cache_count = count;
+
+	return 0;
+}
+
+static int pmic_pre_remove(struct udevice *dev)
+{
+	struct uc_pmic_priv *priv = dev_get_uclass_priv(dev);
+
+	free(priv->cache);
+	free(priv->cache_valid);
+	priv->cache = NULL;
+	priv->cache_valid = NULL;
+
+	return 0;
+}
+
 UCLASS_DRIVER(pmic) = {
 	.id		= UCLASS_PMIC,
 	.name		= "pmic",
 	.pre_probe	= pmic_pre_probe,
+	.post_probe	= pmic_post_probe,
+	.pre_remove	= pmic_pre_remove,
 	.per_device_auto	= sizeof(struct uc_pmic_priv),
 };
@@ -49,6 +49,12 @@ static int sandbox_pmic_read(struct udevice *dev, uint reg,
 	return 0;
 }
 
+static bool sandbox_pmic_reg_volatile(struct udevice *dev, uint reg)
+{
+	/* the emulated registers only change when written */
+	return false;
+}
+
 static int sandbox_pmic_bind(struct udevice *dev)
 {
 	if (!pmic_bind_children(dev, dev_ofnode(dev), pmic_children_info))
@@ -62,6 +68,7 @@ static struct dm_pmic_ops sandbox_pmic_ops = {
 	.reg_count = sandbox_pmic_reg_count,
 	.read = sandbox_pmic_read,
 	.write = sandbox_pmic_write,
+	.reg_volatile = sandbox_pmic_reg_volatile,
 };
 
 static const struct udevice_id sandbox_pmic_ids[] = {
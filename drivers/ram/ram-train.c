@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Cache of DRAM-training results
+ *
+ * The results are stored as a header followed by the data. The data is
+ * written before the header, so a save which is interrupted leaves nothing
+ * that looks valid.
+ */
+
+#define LOG_CATEGORY UCLASS_RAM
+
+#include <dm.h>
+#include <errno.h>
+#include <log.h>
+#include <mapmem.h>
+#include <ram_train.h>
+#include <spi_flash.h>
+#include <u-boot/crc.h>
+#include <linux/bitops.h>
+
+#define RAM_TRAIN_MAGIC		0x4e525444	/* "DTRN" */
+
+/**
+ * struct ram_train_hdr - Header of saved training results
+ *
+ * @magic: RAM_TRAIN_MAGIC
+ * @fingerprint: Fingerprint of the setup the results are for
+ * @size: Size of the data which follows the header
+ * @crc: CRC32 of the data
+ */
+struct ram_train_hdr {
+	u32 magic;
+	u32 fingerprint;
+	u32 size;
+	u32 crc;
+};
+
+__weak int ram_train_store_read(uint offset, void *buf, uint size)
+{
+	struct udevice *dev;
+	int ret;
+
+	ret = uclass_first_device_err(UCLASS_SPI_FLASH, &dev);
+	if (ret)
+		return ret;
+
+	return spi_flash_read_dm(dev, CONFIG_RAM_TRAIN_CACHE_OFFSET + offset,
+				 size, buf);
+}
+
+__weak int ram_train_store_erase(void)
+{
+	struct udevice *dev;
+	int ret;
+
+	ret = uclass_first_device_err(UCLASS_SPI_FLASH, &dev);
+	if (ret)
+		return ret;
+
+	return spi_flash_erase_dm(dev, CONFIG_RAM_TRAIN_CACHE_OFFSET,
+				  CONFIG_RAM_TRAIN_CACHE_SIZE);
+}
+
+__weak int ram_train_store_write(uint offset, const void *buf, uint size)
+{
+	struct udevice *dev;
+	int ret;
+
+	ret = uclass_first_device_err(UCLASS_SPI_FLASH, &dev);
+	if (ret)
+		return ret;
+
+	return spi_flash_write_dm(dev, CONFIG_RAM_TRAIN_CACHE_OFFSET + offset,
+				  size, buf);
+}
+
+int ram_train_restore(u32 fingerprint, void *data, uint size)
+{
+	struct ram_train_hdr hdr;
+	int ret;
+
+	ret = ram_train_store_read(0, &hdr, sizeof(hdr));
+	if (ret)
+		return log_msg_ret("hdr", ret);
+	if (hdr.magic != RAM_TRAIN_MAGIC)
+		return -ENOENT;
+	if (hdr.fingerprint != fingerprint || hdr.size != size) {
+		log_debug("Saved results are for %08x size %x\n",
+			  hdr.fingerprint, hdr.size);
+		return -ESTALE;
+	}
+
+	ret = ram_train_store_read(sizeof(hdr), data, size);
+	if (ret)
+		return log_msg_ret("dat", ret);
+	if (crc32(0, data, size) != hdr.crc)
+		return log_msg_ret("crc", -EBADMSG);
+
+	return 0;
+}
+
+int ram_train_save(u32 fingerprint, const void *data, uint size)
+{
+	struct ram_train_hdr hdr, old;
+	int ret;
+
+	if (sizeof(hdr) + size > CONFIG_RAM_TRAIN_CACHE_SIZE)
+		return log_msg_ret("size", -E2BIG);
+
+	hdr.magic = RAM_TRAIN_MAGIC;
+	hdr.fingerprint = fingerprint;
+	hdr.size = size;
+	hdr.crc = crc32(0, data, size);
+
+	/* Avoid wearing out the flash when nothing has changed */
+	if (!ram_train_store_read(0, &old, sizeof(old)) &&
+	    !memcmp(&old, &hdr, sizeof(hdr)))
+		return 0;
+
+	ret = ram_train_store_erase();
+	if (ret)
+		return log_msg_ret("era", ret);
+	ret = ram_train_store_write(sizeof(hdr), data, size);
+	if (ret)
+		return log_msg_ret("dat", ret);
+	ret = ram_train_store_write(0, &hdr, sizeof(hdr));
+	if (ret)
+		return log_msg_ret("hdr", ret);
+	log_debug("Saved %x bytes of training results\n", size);
+
+	return 0;
+}
+
+int ram_train_verify(phys_addr_t base, phys_size_t size)
+{
+	volatile u32 *ptr;
+	phys_size_t ofs;
+	int ret = 0;
+	int i;
+
+	ptr = map_sysmem(base, size);
+
+	/* Walking ones, with the inverse in between to drive the bus */
+	for (i = 0; i < 32; i++) {
+		ptr[0] = BIT(i);
+		ptr[1] = ~BIT(i);
+		if (ptr[0] != BIT(i)) {
+			ret = -EIO;
+			goto out;
+		}
+	}
+
+	/* A shorted or open address line aliases two of these offsets */
+	for (ofs = sizeof(u32); ofs < size; ofs <<= 1)
+		ptr[ofs / sizeof(u32)] = ~(u32)ofs;
+	ptr[0] = ~0;
+	for (ofs = sizeof(u32); ofs < size; ofs <<= 1) {
+		if (ptr[ofs / sizeof(u32)] != ~(u32)ofs) {
+			log_debug("Memory at %llx is wrong\n",
+				  (unsigned long long)(base + ofs));
+			ret = -EIO;
+			break;
+		}
+	}
+
+out:
+	unmap_sysmem((void *)ptr);
+
+	return ret;
+}
@@ -17,6 +17,7 @@
 #include <part.h>
 #include <pci.h>
 #include <scsi.h>
+#include <asm/unaligned.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 
@@ -28,6 +29,9 @@ DEFINE_CACHE_ALIGN_BUFFER(u8, tempbuff, 512);	/* temporary data buffer */
 #define SCSI_MAX_BLK 0xFFFF
 #define SCSI_LBA48_READ	0xFFFFFFF
 
+/* Number of LUNs which a REPORT LUNS response fits in tempbuff */
+#define SCSI_MAX_REPORT_LUNS	((512 - 8) / 8)
+
 static void scsi_print_error(struct scsi_cmd *pccb)
 {
 	/* Dummy function that could print an error for debugging */
@@ -481,8 +485,9 @@ static int do_scsi_scan_one(struct udevice *dev, int id, int lun, bool verbose)
 	 * size, number of blocks) and other parameters (ids, type, ...)
 	 */
 	scsi_init_dev_desc_priv(&bd);
-	if (scsi_detect_dev(dev, id, lun, &bd))
-		return -ENODEV;
+	ret = scsi_detect_dev(dev, id, lun, &bd);
+	if (ret)
+		return ret;
 
 	/*
 	* Create only one block device and do detection
@@ -532,12 +537,99 @@ static int do_scsi_scan_one(struct udevice *dev, int id, int lun, bool verbose)
 	return 0;
 }
 
+/**
+ * scsi_report_luns() - Ask a target which LUNs it has
+ *
+ * @dev: SCSI controller
+ * @id: Target ID
+ * @luns: Returns the LUNs which are reported, other than LUN 0
+ * @max_lun: Ignore LUNs at or above this number
+ * Return: number of LUNs written to @luns, -ve if the target does not support
+ *	REPORT LUNS
+ */
+static int scsi_report_luns(struct udevice *dev, int id, int *luns,
+			    int max_lun)
+{
+	struct scsi_cmd *pccb = (struct scsi_cmd *)&tempccb;
+	int count, i, num;
+	u8 *entry;
+
+	pccb->target = id;
+	pccb->lun = 0;
+	pccb->pdata = tempbuff;
+	pccb->datalen = 512;
+	pccb->dma_dir = DMA_FROM_DEVICE;
+	memset(pccb->cmd, '\0', sizeof(pccb->cmd));
+	pccb->cmd[0] = SCSI_REPORT_LUNS;
+	put_unaligned_be32(pccb->datalen, &pccb->cmd[6]);
+	pccb->cmdlen = 12;
+	pccb->msgout[0] = SCSI_IDENTIFY; /* NOT USED */
+	if (scsi_exec(dev, pccb))
+		return -EIO;
+
+	count = min_t(uint, get_unaligned_be32(pccb->pdata) / 8,
+		      SCSI_MAX_REPORT_LUNS);
+	for (i = 0, num = 0; i < count; i++) {
+		int lun;
+
+		/* accept the peripheral and flat address methods */
+		entry = pccb->pdata + 8 + i * 8;
+		if ((entry[0] & 0xc0) == 0x00)
+			lun = entry[0] ? -1 : entry[1];
+		else if ((entry[0] & 0xc0) == 0x40)
+			lun = (entry[0] & 0x3f) << 8 | entry[1];
+		else
+			lun = -1;
+		if (lun > 0 && lun < max_lun)
+			luns[num++] = lun;
+		else if (lun)
+			log_debug("id %d: ignoring LUN %02x%02x\n", id,
+				  entry[0], entry[1]);
+	}
+
+	return num;
+}
+
+/**
+ * scsi_scan_target() - Scan the LUNs of a target
+ *
+ * A target which does not answer on LUN 0 is taken to be absent. Otherwise it
+ * is asked which LUNs it has, so that only those are probed, avoiding a
+ * timeout for each missing one. Targets which do not support REPORT LUNS have
+ * each LUN probed in turn.
+ *
+ * @dev: SCSI controller
+ * @id: Target ID
+ * @max_lun: Number of LUNs supported by the controller
+ * @verbose: true to show information about each device found
+ */
+static void scsi_scan_target(struct udevice *dev, int id, int max_lun,
+			     bool verbose)
+{
+	int luns[SCSI_MAX_REPORT_LUNS];
+	int count, i, lun;
+
+	if (do_scsi_scan_one(dev, id, 0, verbose) == -ETIMEDOUT ||
+	    max_lun <= 1)
+		return;
+
+	count = scsi_report_luns(dev, id, luns, max_lun);
+	if (count >= 0) {
+		for (i = 0; i < count; i++)
+			do_scsi_scan_one(dev, id, luns[i], verbose);
+		return;
+	}
+
+	log_debug("id %d: no REPORT LUNS, trying each LUN\n", id);
+	for (lun = 1; lun < max_lun; lun++)
+		do_scsi_scan_one(dev, id, lun, verbose);
+}
+
 int scsi_scan_dev(struct udevice *dev, bool verbose)
 {
 	struct scsi_plat *uc_plat; /* scsi controller plat */
 	int ret;
 	int i;
-	int lun;
 
 	/* probe SCSI controller driver */
 	ret = device_probe(dev);
@@ -548,8 +640,7 @@ int scsi_scan_dev(struct udevice *dev, bool verbose)
 	uc_plat = dev_get_uclass_plat(dev);
 
 	for (i = 0; i < uc_plat->max_id; i++)
-		for (lun = 0; lun < uc_plat->max_lun; lun++)
-			do_scsi_scan_one(dev, i, lun, verbose);
+		scsi_scan_target(dev, i, uc_plat->max_lun, verbose);
 
 	return 0;
 }
@@ -15,6 +15,7 @@
 #include <log.h>
 #include <scsi.h>
 #include <scsi_emul.h>
+#include <asm/unaligned.h>
 
 int sb_scsi_emul_command(struct scsi_emul_info *info,
 			 const struct scsi_cmd *req, int len)
@@ -39,6 +40,13 @@ int sb_scsi_emul_command(struct scsi_emul_info *info,
 	}
 	case SCSI_TST_U_RDY:
 		break;
+	case SCSI_REPORT_LUNS:
+		/* just LUN 0, which is the only one */
+		info->alloc_len = get_unaligned_be32(&req->cmd[6]);
+		memset(info->buff, '\0', 16);
+		put_unaligned_be32(8, info->buff);
+		info->buff_used = 16;
+		break;
 	case SCSI_RD_CAPAC: {
 		struct scsi_read_capacity_resp *resp = (void *)info->buff;
 		uint blocks;
@@ -232,10 +232,120 @@ int serial_initialize(void)
 	return serial_init();
 }
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/* Send buffered characters until the UART is busy, or all of them if @wait */
+static void serial_tx_drain(struct udevice *dev, bool wait)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+	uint rd;
+	int err;
+
+	while (upriv->tx_rd != upriv->tx_wr) {
+		rd = upriv->tx_rd % CONFIG_SERIAL_TX_BUFFER_SIZE;
+		err = ops->putc(dev, upriv->tx_buf[rd]);
+		if (err == -EAGAIN) {
+			if (!wait)
+				break;
+			continue;
+		}
+		upriv->tx_rd++;
+	}
+}
+
+/* Add a character to the TX buffer, returning false if there is none */
+static bool serial_tx_putc(struct udevice *dev, char ch)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	uint wr;
+
+	BUILD_BUG_ON_NOT_POWER_OF_2(CONFIG_SERIAL_TX_BUFFER_SIZE);
+
+	if (!upriv->tx_buf)
+		return false;
+
+	/* Wait for room if the buffer is full */
+	while (upriv->tx_wr - upriv->tx_rd == CONFIG_SERIAL_TX_BUFFER_SIZE)
+		serial_tx_drain(dev, false);
+	wr = upriv->tx_wr++ % CONFIG_SERIAL_TX_BUFFER_SIZE;
+	upriv->tx_buf[wr] = ch;
+	serial_tx_drain(dev, false);
+
+	return true;
+}
+
+static void serial_tx_cyclic(struct cyclic_info *c)
+{
+	struct serial_dev_priv *upriv;
+
+	upriv = container_of(c, struct serial_dev_priv, tx_cyclic);
+	serial_tx_drain(upriv->sdev->priv, false);
+}
+
+static void serial_tx_init(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	/*
+	 * The buffer is too large for the pre-relocation malloc() area. The
+	 * cyclic function finds the device through its stdio device.
+	 */
+	if (!(gd->flags & GD_FLG_RELOC) || !upriv->sdev)
+		return;
+	upriv->tx_buf = malloc(CONFIG_SERIAL_TX_BUFFER_SIZE);
+	if (upriv->tx_buf)
+		cyclic_register(&upriv->tx_cyclic, serial_tx_cyclic, 1000,
+				dev->name);
+}
+
+static void serial_tx_uninit(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (!upriv->tx_buf)
+		return;
+	serial_tx_drain(dev, true);
+	cyclic_unregister(&upriv->tx_cyclic);
+	free(upriv->tx_buf);
+	upriv->tx_buf = NULL;
+}
+
+static bool serial_tx_buffered(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	return upriv->tx_buf;
+}
+#else /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
+static inline void serial_tx_drain(struct udevice *dev, bool wait)
+{
+}
+
+static inline bool serial_tx_putc(struct udevice *dev, char ch)
+{
+	return false;
+}
+
+static inline void serial_tx_init(struct udevice *dev)
+{
+}
+
+static inline void serial_tx_uninit(struct udevice *dev)
+{
+}
+
+static inline bool serial_tx_buffered(struct udevice *dev)
+{
+	return false;
+}
+#endif /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
 static void _serial_flush(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	serial_tx_drain(dev, true);
 	if (!ops->pending)
 		return;
 	while (ops->pending(dev, false) > 0)
@@ -250,9 +360,11 @@ static void _serial_putc(struct udevice *dev, char ch)
 	if (ch == '\n')
 		_serial_putc(dev, '\r');
 
-	do {
-		err = ops->putc(dev, ch);
-	} while (err == -EAGAIN);
+	if (!serial_tx_putc(dev, ch)) {
+		do {
+			err = ops->putc(dev, ch);
+		} while (err == -EAGAIN);
+	}
 
 	if (IS_ENABLED(CONFIG_CONSOLE_FLUSH_ON_NEWLINE) && ch == '\n')
 		_serial_flush(dev);
@@ -278,7 +390,8 @@ static void _serial_puts(struct udevice *dev, const char *str)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
-	if (!CONFIG_IS_ENABLED(SERIAL_PUTS) || !ops->puts) {
+	if (!CONFIG_IS_ENABLED(SERIAL_PUTS) || !ops->puts ||
+	    serial_tx_buffered(dev)) {
 		while (*str)
 			_serial_putc(dev, *str++);
 		return;
@@ -589,12 +702,14 @@ static int serial_post_probe(struct udevice *dev)
 	sdev.tstc = serial_stub_tstc;
 
 	stdio_register_dev(&sdev, &upriv->sdev);
+	serial_tx_init(dev);
 #endif
 	return 0;
 }
 
 static int serial_pre_remove(struct udevice *dev)
 {
+	serial_tx_uninit(dev);
 #if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER)
 	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
 
@@ -831,6 +831,54 @@ static int nxp_fspi_adjust_op_size(struct spi_slave *slave,
 	return 0;
 }
 
+static int nxp_fspi_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	struct nxp_fspi *f = dev_get_priv(desc->slave->dev->parent);
+
+	/*
+	 * Only reads can go through the AHB window, and only if the whole
+	 * mapping fits into it. Anything else is left to the spi-mem core,
+	 * which falls back to ->exec_op().
+	 */
+	if (desc->info.op_tmpl.data.dir != SPI_MEM_DATA_IN || needs_ip_only(f))
+		return -EOPNOTSUPP;
+
+	if (desc->info.offset + desc->info.length > f->memmap_phy_size)
+		return -EOPNOTSUPP;
+
+	if (!nxp_fspi_supports_op(desc->slave, &desc->info.op_tmpl))
+		return -EOPNOTSUPP;
+
+	return 0;
+}
+
+static ssize_t nxp_fspi_dirmap_read(struct spi_mem_dirmap_desc *desc,
+				    u64 offs, size_t len, void *buf)
+{
+	struct nxp_fspi *f = dev_get_priv(desc->slave->dev->parent);
+	struct spi_mem_op op = desc->info.op_tmpl;
+	int err;
+
+	err = fspi_readl_poll_tout(f, f->iobase + FSPI_STS0,
+				   FSPI_STS0_ARB_IDLE, 1, POLL_TOUT, true);
+	WARN_ON(err);
+
+	/*
+	 * Unlike ->exec_op(), which goes through one AHB buffer per call, the
+	 * whole range is copied out of the window in one go and the
+	 * controller prefetches ahead of the copy.
+	 */
+	op.addr.val = desc->info.offset + offs;
+	op.data.nbytes = len;
+	nxp_fspi_prepare_lut(f, &op);
+	memcpy_fromio(buf, f->ahb_addr + op.addr.val, len);
+
+	/* Invalidate the data in the AHB buffer. */
+	nxp_fspi_invalid(f);
+
+	return len;
+}
+
 #ifdef CONFIG_FSL_LAYERSCAPE
 static void erratum_err050568(struct nxp_fspi *f)
 {
@@ -1044,6 +1092,8 @@ static const struct spi_controller_mem_ops nxp_fspi_mem_ops = {
 	.adjust_op_size = nxp_fspi_adjust_op_size,
 	.supports_op = nxp_fspi_supports_op,
 	.exec_op = nxp_fspi_exec_op,
+	.dirmap_create = nxp_fspi_dirmap_create,
+	.dirmap_read = nxp_fspi_dirmap_read,
 };
 
 static const struct dm_spi_ops nxp_fspi_ops = {
@@ -11,6 +11,7 @@
 #include <dm.h>
 #include <errno.h>
 #include <hang.h>
+#include <init.h>
 #include <log.h>
 #include <regmap.h>
 #include <spl.h>
@@ -129,6 +130,12 @@ int do_reset(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 		reset_type = SYSRESET_WARM;
 	}
 
+	if (IS_ENABLED(CONFIG_REENTER) && argc == 2 && argv[1][0] == '-' &&
+	    argv[1][1] == 'r') {
+		board_reenter();
+		/* NOTREACHED */
+	}
+
 	printf("resetting ...\n");
 	mdelay(100);
 
@@ -48,9 +48,14 @@
 /* Timeout after 30 msecs if NOP OUT hangs without response */
 #define NOP_OUT_TIMEOUT    30 /* msecs */
 
-/* Only use one Task Tag for all requests */
+/* Device management requests always use the first slot */
 #define TASK_TAG	0
 
+/* Maximum number of transfer request slots used for SCSI commands */
+#define UFS_MAX_SLOTS	8
+/* Smallest chunk worth issuing in a slot of its own */
+#define UFS_MIN_SLOT_BYTES	(256 * 1024)
+
 /* Expose the flag value from utp_upiu_query.value */
 #define MASK_QUERY_UPIU_FLAG_LOC 0xFF
 
@@ -607,21 +612,26 @@ static void ufshcd_host_memory_configure(struct ufs_hba *hba)
 	dma_addr_t cmd_desc_dma_addr;
 	u16 response_offset;
 	u16 prdt_offset;
+	int i;
 
-	utrdlp = hba->utrdl;
-	cmd_desc_dma_addr = (dma_addr_t)hba->ucdl;
+	response_offset = offsetof(struct utp_transfer_cmd_desc, response_upiu);
+	prdt_offset = offsetof(struct utp_transfer_cmd_desc, prd_table);
 
-	utrdlp->command_desc_base_addr_lo =
+	for (i = 0; i < hba->nutrs; i++) {
+		utrdlp = &hba->utrdl[i];
+		cmd_desc_dma_addr = (dma_addr_t)&hba->ucdl[i];
+
+		utrdlp->command_desc_base_addr_lo =
 				cpu_to_le32(lower_32_bits(cmd_desc_dma_addr));
-	utrdlp->command_desc_base_addr_hi =
+		utrdlp->command_desc_base_addr_hi =
 				cpu_to_le32(upper_32_bits(cmd_desc_dma_addr));
 
-	response_offset = offsetof(struct utp_transfer_cmd_desc, response_upiu);
-	prdt_offset = offsetof(struct utp_transfer_cmd_desc, prd_table);
-
-	utrdlp->response_upiu_offset = cpu_to_le16(response_offset >> 2);
-	utrdlp->prd_table_offset = cpu_to_le16(prdt_offset >> 2);
-	utrdlp->response_upiu_length = cpu_to_le16(ALIGNED_UPIU_SIZE >> 2);
+		utrdlp->response_upiu_offset =
+				cpu_to_le16(response_offset >> 2);
+		utrdlp->prd_table_offset = cpu_to_le16(prdt_offset >> 2);
+		utrdlp->response_upiu_length =
+				cpu_to_le16(ALIGNED_UPIU_SIZE >> 2);
+	}
 
 	hba->ucd_req_ptr = (struct utp_upiu_req *)hba->ucdl;
 	hba->ucd_rsp_ptr =
@@ -635,23 +645,23 @@ static void ufshcd_host_memory_configure(struct ufs_hba *hba)
  */
 static int ufshcd_memory_alloc(struct ufs_hba *hba)
 {
-	/* Allocate one Transfer Request Descriptor
+	/* Allocate one Transfer Request Descriptor per slot
 	 * Should be aligned to 1k boundary.
 	 */
 	hba->utrdl = memalign(1024,
-			      ALIGN(sizeof(struct utp_transfer_req_desc),
-				    ARCH_DMA_MINALIGN));
+			      ALIGN(sizeof(struct utp_transfer_req_desc) *
+				    hba->nutrs, ARCH_DMA_MINALIGN));
 	if (!hba->utrdl) {
 		dev_err(hba->dev, "Transfer Descriptor memory allocation failed\n");
 		return -ENOMEM;
 	}
 
-	/* Allocate one Command Descriptor
+	/* Allocate one Command Descriptor per slot
 	 * Should be aligned to 1k boundary.
 	 */
 	hba->ucdl = memalign(1024,
-			     ALIGN(sizeof(struct utp_transfer_cmd_desc),
-				   ARCH_DMA_MINALIGN));
+			     ALIGN(sizeof(struct utp_transfer_cmd_desc) *
+				   hba->nutrs, ARCH_DMA_MINALIGN));
 	if (!hba->ucdl) {
 		dev_err(hba->dev, "Command descriptor memory allocation failed\n");
 		return -ENOMEM;
@@ -730,11 +740,11 @@ static void ufshcd_cache_invalidate(void *addr, unsigned long size)
  * ufshcd_prepare_req_desc_hdr() - Fills the requests header
  * descriptor according to request
  */
-static void ufshcd_prepare_req_desc_hdr(struct ufs_hba *hba,
+static void ufshcd_prepare_req_desc_hdr(struct ufs_hba *hba, int slot,
 					u32 *upiu_flags,
 					enum dma_data_direction cmd_dir)
 {
-	struct utp_transfer_req_desc *req_desc = hba->utrdl;
+	struct utp_transfer_req_desc *req_desc = &hba->utrdl[slot];
 	u32 data_direction;
 	u32 dword_0;
 
@@ -841,7 +851,7 @@ static int ufshcd_comp_devman_upiu(struct ufs_hba *hba,
 
 	hba->dev_cmd.type = cmd_type;
 
-	ufshcd_prepare_req_desc_hdr(hba, &upiu_flags, DMA_NONE);
+	ufshcd_prepare_req_desc_hdr(hba, TASK_TAG, &upiu_flags, DMA_NONE);
 	switch (cmd_type) {
 	case DEV_CMD_TYPE_QUERY:
 		ufshcd_prepare_utp_query_req_upiu(hba, upiu_flags);
@@ -891,6 +901,53 @@ static int ufshcd_send_command(struct ufs_hba *hba, unsigned int task_tag)
 	return 0;
 }
 
+/**
+ * ufshcd_send_commands() - Ring the doorbell for several slots at once
+ *
+ * Wait until the controller has completed all of them, i.e. cleared their
+ * doorbell bits.
+ *
+ * @hba: per adapter instance
+ * @slots: bit mask of the slots to start
+ * Return: 0 if OK, -ve on error
+ */
+static int ufshcd_send_commands(struct ufs_hba *hba, u32 slots)
+{
+	unsigned long start;
+	u32 intr_status;
+
+	ufshcd_writel(hba, slots, REG_UTP_TRANSFER_REQ_DOOR_BELL);
+
+	/* Make sure doorbell reg is updated before reading its status */
+	wmb();
+
+	start = get_timer(0);
+	while (ufshcd_readl(hba, REG_UTP_TRANSFER_REQ_DOOR_BELL) & slots) {
+		intr_status = ufshcd_readl(hba, REG_INTERRUPT_STATUS);
+		ufshcd_writel(hba, intr_status, REG_INTERRUPT_STATUS);
+
+		if (intr_status & hba->intr_mask & UFSHCD_ERROR_MASK) {
+			dev_err(hba->dev, "Error in status:%08x\n",
+				intr_status);
+
+			return -EIO;
+		}
+
+		if (get_timer(start) > QUERY_REQ_TIMEOUT) {
+			dev_err(hba->dev,
+				"Timedout waiting for UTP response\n");
+
+			return -ETIMEDOUT;
+		}
+	}
+
+	/* Drop the completion status left behind by the requests */
+	ufshcd_writel(hba, ufshcd_readl(hba, REG_INTERRUPT_STATUS),
+		      REG_INTERRUPT_STATUS);
+
+	return 0;
+}
+
 /**
  * ufshcd_get_req_rsp - returns the TR response transaction type
  */
@@ -905,9 +962,9 @@ static inline int ufshcd_get_req_rsp(struct utp_upiu_rsp *ucd_rsp_ptr)
  * ufshcd_get_tr_ocs - Get the UTRD Overall Command Status
  *
  */
-static inline int ufshcd_get_tr_ocs(struct ufs_hba *hba)
+static inline int ufshcd_get_tr_ocs(struct ufs_hba *hba, int slot)
 {
-	struct utp_transfer_req_desc *req_desc = hba->utrdl;
+	struct utp_transfer_req_desc *req_desc = &hba->utrdl[slot];
 
 	ufshcd_cache_invalidate(req_desc, sizeof(*req_desc));
 
@@ -982,7 +1039,7 @@ static int ufshcd_exec_dev_cmd(struct ufs_hba *hba, enum dev_cmd_type cmd_type,
 	if (err)
 		return err;
 
-	err = ufshcd_get_tr_ocs(hba);
+	err = ufshcd_get_tr_ocs(hba, TASK_TAG);
 	if (err) {
 		dev_err(hba->dev, "Error in OCS:%d\n", err);
 		return -EINVAL;
@@ -1436,17 +1493,25 @@ static int ufshcd_uic_change_pwr_mode(struct ufs_hba *hba, u8 mode)
 	return ret;
 }
 
+static inline struct utp_upiu_rsp *ufshcd_slot_rsp(struct ufs_hba *hba,
+						  int slot)
+{
+	return (struct utp_upiu_rsp *)&hba->ucdl[slot].response_upiu;
+}
+
 static
-void ufshcd_prepare_utp_scsi_cmd_upiu(struct ufs_hba *hba,
+void ufshcd_prepare_utp_scsi_cmd_upiu(struct ufs_hba *hba, int slot,
 				      struct scsi_cmd *pccb, u32 upiu_flags)
 {
-	struct utp_upiu_req *ucd_req_ptr = hba->ucd_req_ptr;
+	struct utp_upiu_req *ucd_req_ptr =
+		(struct utp_upiu_req *)&hba->ucdl[slot].command_upiu;
+	struct utp_upiu_rsp *ucd_rsp_ptr = ufshcd_slot_rsp(hba, slot);
 	unsigned int cdb_len;
 
 	/* command descriptor fields */
 	ucd_req_ptr->header.dword_0 =
 			UPIU_HEADER_DWORD(UPIU_TRANSACTION_COMMAND, upiu_flags,
-					  pccb->lun, TASK_TAG);
+					  pccb->lun, slot);
 	ucd_req_ptr->header.dword_1 =
 			UPIU_HEADER_DWORD(UPIU_COMMAND_SET_TYPE_SCSI, 0, 0, 0);
 
@@ -1459,9 +1524,9 @@ void ufshcd_prepare_utp_scsi_cmd_upiu(struct ufs_hba *hba,
 	memset(ucd_req_ptr->sc.cdb, 0, UFS_CDB_SIZE);
 	memcpy(ucd_req_ptr->sc.cdb, pccb->cmd, cdb_len);
 
-	memset(hba->ucd_rsp_ptr, 0, sizeof(struct utp_upiu_rsp));
+	memset(ucd_rsp_ptr, 0, sizeof(struct utp_upiu_rsp));
 	ufshcd_cache_flush(ucd_req_ptr, sizeof(*ucd_req_ptr));
-	ufshcd_cache_flush(hba->ucd_rsp_ptr, sizeof(*hba->ucd_rsp_ptr));
+	ufshcd_cache_flush(ucd_rsp_ptr, sizeof(*ucd_rsp_ptr));
 }
 
 static inline void prepare_prdt_desc(struct ufshcd_sg_entry *entry,
@@ -1472,10 +1537,11 @@ static inline void prepare_prdt_desc(struct ufshcd_sg_entry *entry,
 	entry->upper_addr = cpu_to_le32(upper_32_bits((unsigned long)buf));
 }
 
-static void prepare_prdt_table(struct ufs_hba *hba, struct scsi_cmd *pccb)
+static void prepare_prdt_table(struct ufs_hba *hba, int slot,
+			       struct scsi_cmd *pccb)
 {
-	struct utp_transfer_req_desc *req_desc = hba->utrdl;
-	struct ufshcd_sg_entry *prd_table = hba->ucd_prdt_ptr;
+	struct utp_transfer_req_desc *req_desc = &hba->utrdl[slot];
+	struct ufshcd_sg_entry *prd_table = hba->ucdl[slot].prd_table;
 	ulong datalen = pccb->datalen;
 	int table_length;
 	u8 *buf;
@@ -1504,30 +1570,19 @@ static void prepare_prdt_table(struct ufs_hba *hba, struct scsi_cmd *pccb)
 	ufshcd_cache_flush(req_desc, sizeof(*req_desc));
 }
 
-static int ufs_scsi_exec(struct udevice *scsi_dev, struct scsi_cmd *pccb)
+static int ufshcd_check_scsi_result(struct ufs_hba *hba, int slot)
 {
-	struct ufs_hba *hba = dev_get_uclass_priv(scsi_dev->parent);
-	u32 upiu_flags;
-	int ocs, result = 0;
+	struct utp_upiu_rsp *ucd_rsp_ptr = ufshcd_slot_rsp(hba, slot);
+	int ocs, result;
 	u8 scsi_status;
 
-	ufshcd_prepare_req_desc_hdr(hba, &upiu_flags, pccb->dma_dir);
-	ufshcd_prepare_utp_scsi_cmd_upiu(hba, pccb, upiu_flags);
-	prepare_prdt_table(hba, pccb);
-
-	ufshcd_cache_flush(pccb->pdata, pccb->datalen);
-
-	ufshcd_send_command(hba, TASK_TAG);
-
-	ufshcd_cache_invalidate(pccb->pdata, pccb->datalen);
-
-	ocs = ufshcd_get_tr_ocs(hba);
+	ocs = ufshcd_get_tr_ocs(hba, slot);
 	switch (ocs) {
 	case OCS_SUCCESS:
-		result = ufshcd_get_req_rsp(hba->ucd_rsp_ptr);
+		result = ufshcd_get_req_rsp(ucd_rsp_ptr);
 		switch (result) {
 		case UPIU_TRANSACTION_RESPONSE:
-			result = ufshcd_get_rsp_upiu_result(hba->ucd_rsp_ptr);
+			result = ufshcd_get_rsp_upiu_result(ucd_rsp_ptr);
 
 			scsi_status = result & MASK_SCSI_STATUS;
 			if (scsi_status)
@@ -1554,6 +1609,118 @@ static int ufs_scsi_exec(struct udevice *scsi_dev, struct scsi_cmd *pccb)
 	return 0;
 }
 
+/**
+ * ufshcd_split_scsi_cmd() - Split a large READ/WRITE across several slots
+ *
+ * The device can work on queued commands in parallel, so a large transfer
+ * completes sooner as a few smaller commands issued together than as one.
+ *
+ * @hba: per adapter instance
+ * @pccb: command to split
+ * @sub: array of UFS_MAX_SLOTS commands to fill in
+ * Return: number of commands in @sub, or 0 if @pccb is to be sent as it is
+ */
+static int ufshcd_split_scsi_cmd(struct ufs_hba *hba, struct scsi_cmd *pccb,
+				 struct scsi_cmd *sub)
+{
+	u64 lba, blocks, per_slot;
+	unsigned long blksz;
+	int lba_len, len_off, len_len;
+	int count, i, j;
+
+	switch (pccb->cmd[0]) {
+	case SCSI_READ10:
+	case SCSI_WRITE10:
+		lba_len = 4;
+		len_off = 7;
+		len_len = 2;
+		break;
+	case SCSI_READ16:
+		lba_len = 8;
+		len_off = 10;
+		len_len = 4;
+		break;
+	default:
+		return 0;
+	}
+
+	lba = 0;
+	for (i = 0; i < lba_len; i++)
+		lba = lba << 8 | pccb->cmd[2 + i];
+	blocks = 0;
+	for (i = 0; i < len_len; i++)
+		blocks = blocks << 8 | pccb->cmd[len_off + i];
+	if (!blocks || pccb->datalen % blocks)
+		return 0;
+	blksz = pccb->datalen / blocks;
+
+	count = min_t(u64, hba->nutrs, pccb->datalen / UFS_MIN_SLOT_BYTES);
+	if (count < 2)
+		return 0;
+	per_slot = DIV_ROUND_UP(blocks, count);
+	count = DIV_ROUND_UP(blocks, per_slot);
+
+	for (i = 0; i < count; i++) {
+		u64 nblks = min(per_slot, blocks);
+
+		memcpy(&sub[i], pccb, sizeof(*pccb));
+		for (j = lba_len - 1; j >= 0; j--)
+			sub[i].cmd[2 + j] = lba >> (8 * (lba_len - 1 - j));
+		for (j = len_len - 1; j >= 0; j--)
+			sub[i].cmd[len_off + j] =
+				nblks >> (8 * (len_len - 1 - j));
+		sub[i].pdata = pccb->pdata + i * per_slot * blksz;
+		sub[i].datalen = nblks * blksz;
+		lba += nblks;
+		blocks -= nblks;
+	}
+
+	return count;
+}
+
+static int ufs_scsi_exec(struct udevice *scsi_dev, struct scsi_cmd *pccb)
+{
+	struct ufs_hba *hba = dev_get_uclass_priv(scsi_dev->parent);
+	struct scsi_cmd sub[UFS_MAX_SLOTS];
+	struct scsi_cmd *cmds = pccb;
+	u32 upiu_flags;
+	int count, i, ret;
+
+	count = ufshcd_split_scsi_cmd(hba, pccb, sub);
+	if (count)
+		cmds = sub;
+	else
+		count = 1;
+
+	for (i = 0; i < count; i++) {
+		ufshcd_prepare_req_desc_hdr(hba, i, &upiu_flags,
+					    cmds[i].dma_dir);
+		ufshcd_prepare_utp_scsi_cmd_upiu(hba, i, &cmds[i], upiu_flags);
+		prepare_prdt_table(hba, i, &cmds[i]);
+	}
+
+	ufshcd_cache_flush(pccb->pdata, pccb->datalen);
+
+	if (count == 1) {
+		ufshcd_send_command(hba, TASK_TAG);
+		ret = 0;
+	} else {
+		ret = ufshcd_send_commands(hba, GENMASK(count - 1, 0));
+	}
+
+	ufshcd_cache_invalidate(pccb->pdata, pccb->datalen);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		ret = ufshcd_check_scsi_result(hba, i);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
 static inline int ufshcd_read_desc(struct ufs_hba *hba, enum desc_idn desc_id,
 				   int desc_index, u8 *buf, u32 size)
 {
@@ -1966,6 +2133,9 @@ int ufshcd_probe(struct udevice *ufs_dev, struct ufs_hba_ops *hba_ops)
 	hba->capabilities = ufshcd_readl(hba, REG_CONTROLLER_CAPABILITIES);
 	if (hba->quirks & UFSHCD_QUIRK_BROKEN_64BIT_ADDRESS)
 		hba->capabilities &= ~MASK_64_ADDRESSING_SUPPORT;
+	hba->nutrs = min_t(int,
+			   (hba->capabilities & MASK_TRANSFER_REQUESTS_SLOTS) + 1,
+			   UFS_MAX_SLOTS);
 
 	/* Get UFS version supported by the controller */
 	hba->version = ufshcd_get_ufs_version(hba);
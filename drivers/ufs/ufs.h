@@ -878,6 +878,8 @@ struct ufs_hba {
 	u32			version;
 	u32			intr_mask;
 	enum ufshcd_quirks	quirks;
+	/* Number of transfer request slots in use */
+	int			nutrs;
 
 	/* Virtual memory reference */
 	struct utp_transfer_cmd_desc *ucdl;
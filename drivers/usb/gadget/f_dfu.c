@@ -45,6 +45,7 @@ struct f_dfu {
 };
 
 struct dfu_entity *dfu_defer_flush;
+struct dfu_entity *dfu_defer_drain;
 
 typedef int (*dfu_state_fn) (struct f_dfu *,
 			     const struct usb_ctrlrequest *,
@@ -156,10 +157,12 @@ static void dfu_set_poll_timeout(struct dfu_status *dstat, unsigned int ms)
 static void dnload_request_complete(struct usb_ep *ep, struct usb_request *req)
 {
 	struct f_dfu *f_dfu = req->context;
+	struct dfu_entity *dfu = dfu_get_entity(f_dfu->altsetting);
 	int ret;
 
-	ret = dfu_write(dfu_get_entity(f_dfu->altsetting), req->buf,
-			req->actual, f_dfu->blk_seq_num);
+	/* Leave a full buffer to the main loop, see handle_getstatus() */
+	dfu->defer_drain = IS_ENABLED(CONFIG_DFU_DEFER_WRITE);
+	ret = dfu_write(dfu, req->buf, req->actual, f_dfu->blk_seq_num);
 	if (ret) {
 		f_dfu->dfu_status = DFU_STATUS_errUNKNOWN;
 		f_dfu->dfu_state = DFU_STATE_dfuERROR;
@@ -172,6 +175,13 @@ static void dnload_request_flush(struct usb_ep *ep, struct usb_request *req)
 	dfu_set_defer_flush(dfu_get_entity(f_dfu->altsetting));
 }
 
+static void getstatus_request_drain(struct usb_ep *ep, struct usb_request *req)
+{
+	struct f_dfu *f_dfu = req->context;
+
+	dfu_set_defer_drain(dfu_get_entity(f_dfu->altsetting));
+}
+
 static inline int dfu_get_manifest_timeout(struct dfu_entity *dfu)
 {
 	return dfu->poll_timeout ? dfu->poll_timeout(dfu) :
@@ -183,13 +193,28 @@ static int handle_getstatus(struct usb_request *req)
 	struct dfu_status *dstat = (struct dfu_status *)req->buf;
 	struct f_dfu *f_dfu = req->context;
 	struct dfu_entity *dfu = dfu_get_entity(f_dfu->altsetting);
+	unsigned int busy_timeout = 0;
 
 	dfu_set_poll_timeout(dstat, 0);
 
 	switch (f_dfu->dfu_state) {
 	case DFU_STATE_dfuDNLOAD_SYNC:
 	case DFU_STATE_dfuDNBUSY:
-		f_dfu->dfu_state = DFU_STATE_dfuDNLOAD_IDLE;
+		if (!dfu->drain_pending) {
+			f_dfu->dfu_state = DFU_STATE_dfuDNLOAD_IDLE;
+			break;
+		}
+		/*
+		 * The buffer is full: report dfuDNBUSY and write it out from
+		 * the main loop once this status has been sent, so that the
+		 * slow write never stalls a control transfer. The host polls
+		 * again after roughly the time the previous write took.
+		 */
+		f_dfu->dfu_state = DFU_STATE_dfuDNBUSY;
+		busy_timeout = max_t(ulong, dfu->drain_time, 1);
+		dfu_set_poll_timeout(dstat, busy_timeout);
+		if (!dfu_get_defer_drain())
+			req->complete = getstatus_request_drain;
 		break;
 	case DFU_STATE_dfuMANIFEST_SYNC:
 		f_dfu->dfu_state = DFU_STATE_dfuMANIFEST;
@@ -201,7 +226,7 @@ static int handle_getstatus(struct usb_request *req)
 		break;
 	}
 
-	if (f_dfu->poll_timeout)
+	if (f_dfu->poll_timeout && f_dfu->poll_timeout > busy_timeout)
 		if (!(f_dfu->blk_seq_num %
 		      (dfu_get_buf_size() / DFU_USB_BUFSIZ)))
 			dfu_set_poll_timeout(dstat, f_dfu->poll_timeout);
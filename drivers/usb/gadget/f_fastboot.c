@@ -38,12 +38,29 @@
  * that expect bulk OUT requests to be divisible by maxpacket size.
  */
 
+/*
+ * CONFIG_FASTBOOT_USB_RX_BUF_SIZE must be a multiple of maxpacket size too, for
+ * the same reason
+ */
+#define DL_BUFFER_SIZE			CONFIG_FASTBOOT_USB_RX_BUF_SIZE
+#define DL_REQS				CONFIG_FASTBOOT_USB_RX_REQS
+
 struct f_fastboot {
 	struct usb_function usb_function;
 
 	/* IN/OUT EP's and corresponding requests */
 	struct usb_ep *in_ep, *out_ep;
 	struct usb_request *in_req, *out_req;
+
+	/*
+	 * OUT requests receiving a download, queued in turn. dl_next is the
+	 * next one to queue, dl_count the number queued and dl_queued the
+	 * number of bytes they ask for.
+	 */
+	struct usb_request *dl_req[DL_REQS];
+	unsigned int dl_next;
+	unsigned int dl_count;
+	unsigned int dl_queued;
 };
 
 static char fb_ext_prop_name[] = "DeviceInterfaceGUID";
@@ -194,6 +211,7 @@ static struct usb_gadget_strings *fastboot_strings[] = {
 };
 
 static void rx_handler_command(struct usb_ep *ep, struct usb_request *req);
+static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req);
 
 static void fastboot_complete(struct usb_ep *ep, struct usb_request *req)
 {
@@ -278,6 +296,7 @@ static void fastboot_unbind(struct usb_configuration *c, struct usb_function *f)
 static void fastboot_disable(struct usb_function *f)
 {
 	struct f_fastboot *f_fb = func_to_fastboot(f);
+	int i;
 
 	usb_ep_disable(f_fb->out_ep);
 	usb_ep_disable(f_fb->in_ep);
@@ -287,6 +306,13 @@ static void fastboot_disable(struct usb_function *f)
 		usb_ep_free_request(f_fb->out_ep, f_fb->out_req);
 		f_fb->out_req = NULL;
 	}
+	for (i = 0; i < DL_REQS; i++) {
+		if (f_fb->dl_req[i]) {
+			free(f_fb->dl_req[i]->buf);
+			usb_ep_free_request(f_fb->out_ep, f_fb->dl_req[i]);
+			f_fb->dl_req[i] = NULL;
+		}
+	}
 	if (f_fb->in_req) {
 		free(f_fb->in_req->buf);
 		usb_ep_free_request(f_fb->in_ep, f_fb->in_req);
@@ -294,7 +320,8 @@ static void fastboot_disable(struct usb_function *f)
 	}
 }
 
-static struct usb_request *fastboot_start_ep(struct usb_ep *ep)
+static struct usb_request *fastboot_start_ep(struct usb_ep *ep,
+					     unsigned int size)
 {
 	struct usb_request *req;
 
@@ -302,8 +329,8 @@ static struct usb_request *fastboot_start_ep(struct usb_ep *ep)
 	if (!req)
 		return NULL;
 
-	req->length = EP_BUFFER_SIZE;
-	req->buf = memalign(CONFIG_SYS_CACHELINE_SIZE, EP_BUFFER_SIZE);
+	req->length = size;
+	req->buf = memalign(CONFIG_SYS_CACHELINE_SIZE, size);
 	if (!req->buf) {
 		usb_ep_free_request(ep, req);
 		return NULL;
@@ -316,7 +343,7 @@ static struct usb_request *fastboot_start_ep(struct usb_ep *ep)
 static int fastboot_set_alt(struct usb_function *f,
 			    unsigned interface, unsigned alt)
 {
-	int ret;
+	int ret, i;
 	struct usb_composite_dev *cdev = f->config->cdev;
 	struct usb_gadget *gadget = cdev->gadget;
 	struct f_fastboot *f_fb = func_to_fastboot(f);
@@ -332,7 +359,7 @@ static int fastboot_set_alt(struct usb_function *f,
 		return ret;
 	}
 
-	f_fb->out_req = fastboot_start_ep(f_fb->out_ep);
+	f_fb->out_req = fastboot_start_ep(f_fb->out_ep, EP_BUFFER_SIZE);
 	if (!f_fb->out_req) {
 		puts("failed to alloc out req\n");
 		ret = -EINVAL;
@@ -340,6 +367,17 @@ static int fastboot_set_alt(struct usb_function *f,
 	}
 	f_fb->out_req->complete = rx_handler_command;
 
+	for (i = 0; i < DL_REQS; i++) {
+		f_fb->dl_req[i] = fastboot_start_ep(f_fb->out_ep,
+						    DL_BUFFER_SIZE);
+		if (!f_fb->dl_req[i]) {
+			puts("failed to alloc download req\n");
+			ret = -ENOMEM;
+			goto err;
+		}
+		f_fb->dl_req[i]->complete = rx_handler_dl_image;
+	}
+
 	d = fb_ep_desc(gadget, &fs_ep_in, &hs_ep_in, &ss_ep_in);
 	ret = usb_ep_enable(f_fb->in_ep, d);
 	if (ret) {
@@ -347,7 +385,7 @@ static int fastboot_set_alt(struct usb_function *f,
 		goto err;
 	}
 
-	f_fb->in_req = fastboot_start_ep(f_fb->in_ep);
+	f_fb->in_req = fastboot_start_ep(f_fb->in_ep, EP_BUFFER_SIZE);
 	if (!f_fb->in_req) {
 		puts("failed alloc req in\n");
 		ret = -EINVAL;
@@ -425,16 +463,16 @@ static void compl_do_reset(struct usb_ep *ep, struct usb_request *req)
 	do_reset(NULL, 0, 0, NULL);
 }
 
-static unsigned int rx_bytes_expected(struct usb_ep *ep)
+static unsigned int rx_bytes_expected(struct usb_ep *ep, unsigned int queued)
 {
-	int rx_remain = fastboot_data_remaining();
+	int rx_remain = fastboot_data_remaining() - queued;
 	unsigned int rem;
 	unsigned int maxpacket = usb_endpoint_maxp(ep->desc);
 
 	if (rx_remain <= 0)
 		return 0;
-	else if (rx_remain > EP_BUFFER_SIZE)
-		return EP_BUFFER_SIZE;
+	else if (rx_remain > DL_BUFFER_SIZE)
+		return DL_BUFFER_SIZE;
 
 	/*
 	 * Some controllers e.g. DWC3 don't like OUT transfers to be
@@ -449,13 +487,44 @@ static unsigned int rx_bytes_expected(struct usb_ep *ep)
 	return rx_remain;
 }
 
+/*
+ * Queue download requests until they cover the rest of the download, so the
+ * controller has somewhere to put data while earlier data is being handled.
+ * Requests complete in the order they are queued. No more is asked for than
+ * the download needs, so the next command goes to the command request.
+ */
+static void rx_queue_dl_image(struct usb_ep *ep)
+{
+	struct f_fastboot *f_fb = fastboot_func;
+	struct usb_request *req;
+	unsigned int length;
+
+	while (f_fb->dl_count < DL_REQS) {
+		length = rx_bytes_expected(ep, f_fb->dl_queued);
+		if (!length)
+			break;
+
+		req = f_fb->dl_req[f_fb->dl_next];
+		req->length = length;
+		req->actual = 0;
+		if (usb_ep_queue(ep, req, 0))
+			break;
+		f_fb->dl_next = (f_fb->dl_next + 1) % DL_REQS;
+		f_fb->dl_count++;
+		f_fb->dl_queued += length;
+	}
+}
+
 static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 {
 	char response[FASTBOOT_RESPONSE_LEN] = {0};
+	struct f_fastboot *f_fb = fastboot_func;
 	unsigned int transfer_size = fastboot_data_remaining();
 	const unsigned char *buffer = req->buf;
 	unsigned int buffer_size = req->actual;
 
+	f_fb->dl_count--;
+	f_fb->dl_queued -= req->length;
 	if (req->status != 0) {
 		printf("Bad status: %d\n", req->status);
 		return;
@@ -473,16 +542,15 @@ static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 		/*
 		 * Reset global transfer variable
 		 */
-		req->complete = rx_handler_command;
-		req->length = EP_BUFFER_SIZE;
+		f_fb->out_req->length = EP_BUFFER_SIZE;
+		f_fb->out_req->actual = 0;
+		usb_ep_queue(ep, f_fb->out_req, 0);
 
 		fastboot_tx_write_str(response);
-	} else {
-		req->length = rx_bytes_expected(ep);
+		return;
 	}
 
-	req->actual = 0;
-	usb_ep_queue(ep, req, 0);
+	rx_queue_dl_image(ep);
 }
 
 static void do_exit_on_complete(struct usb_ep *ep, struct usb_request *req)
@@ -553,8 +621,14 @@ static void rx_handler_command(struct usb_ep *ep, struct usb_request *req)
 	}
 
 	if (!strncmp("DATA", response, 4)) {
-		req->complete = rx_handler_dl_image;
-		req->length = rx_bytes_expected(ep);
+		/* The download requests take over until it is complete */
+		fastboot_func->dl_next = 0;
+		fastboot_func->dl_count = 0;
+		fastboot_func->dl_queued = 0;
+		rx_queue_dl_image(ep);
+		fastboot_tx_write_str(response);
+		*cmdbuf = '\0';
+		return;
 	}
 
 	if (!strncmp("OKAY", response, 4)) {
@@ -236,12 +236,52 @@ static void usb_scan_bus(struct udevice *bus, bool recurse)
 	ret = usb_scan_device(bus, 0, USB_SPEED_FULL, &dev);
 	if (ret)
 		printf("failed, error %d\n", ret);
+	else if (IS_ENABLED(CONFIG_USB_PARALLEL_SCAN))
+		printf("started\n");
 	else if (priv->next_addr == 0)
 		printf("No USB Device found\n");
 	else
 		printf("%d USB Device(s) found\n", priv->next_addr);
 }
 
+/*
+ * Scan either the primary controllers or their companions. With
+ * CONFIG_USB_PARALLEL_SCAN the ports of all the controllers are scanned
+ * together, so enumeration takes as long as the slowest controller rather
+ * than the sum of them all.
+ */
+static void usb_scan_buses(struct uclass *uc, bool companion)
+{
+	struct usb_bus_priv *priv;
+	struct udevice *bus;
+
+	if (IS_ENABLED(CONFIG_USB_PARALLEL_SCAN))
+		usb_hub_scan_hold();
+
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
+
+		priv = dev_get_uclass_priv(bus);
+		if (priv->companion == companion)
+			usb_scan_bus(bus, true);
+	}
+
+	if (!IS_ENABLED(CONFIG_USB_PARALLEL_SCAN))
+		return;
+
+	usb_hub_scan_release();
+	uclass_foreach_dev(bus, uc) {
+		if (!device_active(bus))
+			continue;
+
+		priv = dev_get_uclass_priv(bus);
+		if (priv->companion == companion)
+			printf("Bus %s: %d USB Device(s) found\n", bus->name,
+			       priv->next_addr);
+	}
+}
+
 static void remove_inactive_children(struct uclass *uc, struct udevice *bus)
 {
 	uclass_foreach_dev(bus, uc) {
@@ -291,7 +331,6 @@ int usb_init(void)
 {
 	int controllers_initialized = 0;
 	struct usb_uclass_priv *uc_priv;
-	struct usb_bus_priv *priv;
 	struct udevice *bus;
 	struct uclass *uc;
 	int ret;
@@ -350,30 +389,15 @@ int usb_init(void)
 	 * lowlevel init done, now scan the bus for devices i.e. search HUBs
 	 * and configure them, first scan primary controllers.
 	 */
-	uclass_foreach_dev(bus, uc) {
-		if (!device_active(bus))
-			continue;
-
-		priv = dev_get_uclass_priv(bus);
-		if (!priv->companion)
-			usb_scan_bus(bus, true);
-	}
+	usb_scan_buses(uc, false);
 
 	/*
 	 * Now that the primary controllers have been scanned and have handed
 	 * over any devices they do not understand to their companions, scan
 	 * the companions if necessary.
 	 */
-	if (uc_priv->companion_device_count) {
-		uclass_foreach_dev(bus, uc) {
-			if (!device_active(bus))
-				continue;
-
-			priv = dev_get_uclass_priv(bus);
-			if (priv->companion)
-				usb_scan_bus(bus, true);
-		}
-	}
+	if (uc_priv->companion_device_count)
+		usb_scan_buses(uc, true);
 
 	debug("scan end\n");
 
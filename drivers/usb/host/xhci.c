@@ -530,15 +530,17 @@ static int xhci_init_ep_contexts_if(struct usb_device *udev,
 		ep_ctx[ep_index] = xhci_get_ep_ctx(ctrl, virt_dev->in_ctx,
 						   ep_index);
 
-		/* Allocate the ep rings */
-		virt_dev->eps[ep_index].ring = xhci_ring_alloc(ctrl, 1, true);
-		if (!virt_dev->eps[ep_index].ring)
-			return -ENOMEM;
-
 		/*NOTE: ep_desc[0] actually represents EP1 and so on */
 		dir = (((endpt_desc->bEndpointAddress) & (0x80)) >> 7);
 		ep_type = (((endpt_desc->bmAttributes) & (0x3)) | (dir << 2));
 
+		/* Allocate the ep rings, with room for large bulk transfers */
+		virt_dev->eps[ep_index].ring =
+			xhci_ring_alloc(ctrl, usb_endpoint_xfer_bulk(endpt_desc) ?
+					XHCI_BULK_RING_SEGS : 1, true);
+		if (!virt_dev->eps[ep_index].ring)
+			return -ENOMEM;
+
 		ep_ctx[ep_index]->ep_info =
 			cpu_to_le32(EP_MAX_ESIT_PAYLOAD_HI(max_esit_payload) |
 			EP_INTERVAL(interval) | EP_MULT(mult));
@@ -1417,13 +1419,16 @@ static int xhci_update_hub_device(struct udevice *dev, struct usb_device *udev)
 static int xhci_get_max_xfer_size(struct udevice *dev, size_t *size)
 {
 	/*
-	 * xHCD allocates one segment which includes 64 TRBs for each endpoint
-	 * and the last TRB in this segment is configured as a link TRB to form
-	 * a TRB ring. Each TRB can transfer up to 64K bytes, however data
-	 * buffers referenced by transfer TRBs shall not span 64KB boundaries.
-	 * Hence the maximum number of TRBs we can use in one transfer is 62.
+	 * xHCD allocates XHCI_BULK_RING_SEGS segments of 64 TRBs for each bulk
+	 * endpoint and the last TRB in each segment is configured as a link
+	 * TRB to form a TRB ring. Each TRB can transfer up to 64K bytes,
+	 * however data buffers referenced by transfer TRBs shall not span 64KB
+	 * boundaries, so an unaligned buffer needs one more TRB. Hence the
+	 * maximum number of TRBs we can use in one transfer is one less than
+	 * the number of non-link TRBs in the ring.
 	 */
-	*size = (TRBS_PER_SEGMENT - 2) * TRB_MAX_BUFF_SIZE;
+	*size = (XHCI_BULK_RING_SEGS * (TRBS_PER_SEGMENT - 1) - 1) *
+		TRB_MAX_BUFF_SIZE;
 
 	return 0;
 }
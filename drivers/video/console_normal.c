@@ -45,18 +45,13 @@ static int console_set_row(struct udevice *dev, uint row, int clr)
 static int console_move_rows(struct udevice *dev, uint rowdst,
 			     uint rowsrc, uint count)
 {
-	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
 	struct console_simple_priv *priv = dev_get_priv(dev);
 	struct video_fontdata *fontdata = priv->fontdata;
-	void *dst;
-	void *src;
-	int size;
 	int ret;
 
-	dst = vid_priv->fb + rowdst * fontdata->height * vid_priv->line_length;
-	src = vid_priv->fb + rowsrc * fontdata->height * vid_priv->line_length;
-	size = fontdata->height * vid_priv->line_length * count;
-	ret = vidconsole_memmove(dev, dst, src, size);
+	ret = video_move_rows(dev->parent, rowdst * fontdata->height,
+			      rowsrc * fontdata->height,
+			      count * fontdata->height);
 	if (ret)
 		return ret;
 
@@ -155,6 +155,35 @@ struct console_tt_metrics {
 	double scale;
 };
 
+/**
+ * struct console_tt_glyph - A rendered glyph kept for reuse
+ *
+ * Rendering a glyph with stb_truetype involves a fair amount of floating-point
+ * work, so the last few glyphs rendered are kept. The image depends on the
+ * sub-pixel position as well as on the font, size and code point.
+ *
+ * @font_data:	Font the glyph was rendered from, NULL if this entry is unused
+ * @font_size:	Font size in pixels
+ * @cp:		Unicode code point
+ * @x_shift:	Sub-pixel horizontal offset the glyph was rendered at
+ * @width:	Width of the image in pixels
+ * @height:	Height of the image in pixels
+ * @xoff:	Horizontal offset of the image from the cursor position
+ * @yoff:	Vertical offset of the image from the baseline
+ * @data:	8-bit-per-pixel image, NULL if the glyph is empty (e.g. ' ')
+ */
+struct console_tt_glyph {
+	const u8 *font_data;
+	int font_size;
+	int cp;
+	double x_shift;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	u8 *data;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -167,6 +196,8 @@ struct console_tt_metrics {
  *		last character. We record enough characters to go back to the
  *		start of the current command line.
  * @pos_ptr:	Current position in the position history
+ * @glyphs:	Cache of rendered glyphs, with
+ *		CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE entries, or NULL if none
  */
 struct console_tt_priv {
 	struct console_tt_metrics *cur_met;
@@ -174,6 +205,7 @@ struct console_tt_priv {
 	int num_metrics;
 	struct pos_info pos[POS_HISTORY_SIZE];
 	int pos_ptr;
+	struct console_tt_glyph *glyphs;
 };
 
 /**
@@ -239,17 +271,12 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 				     uint rowsrc, uint count)
 {
-	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	struct console_tt_metrics *met = priv->cur_met;
-	void *dst;
-	void *src;
 	int i, diff, ret;
 
-	dst = vid_priv->fb + rowdst * met->font_size * vid_priv->line_length;
-	src = vid_priv->fb + rowsrc * met->font_size * vid_priv->line_length;
-	ret = vidconsole_memmove(dev, dst, src, met->font_size *
-				 vid_priv->line_length * count);
+	ret = video_move_rows(dev->parent, rowdst * met->font_size,
+			      rowsrc * met->font_size, count * met->font_size);
 	if (ret)
 		return ret;
 
@@ -261,6 +288,72 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/**
+ * console_truetype_get_glyph() - Get the image of a glyph
+ *
+ * This returns the glyph from the cache if it is there, otherwise renders it
+ * and adds it to the cache, replacing whatever was in its slot.
+ *
+ * @priv:	Private data
+ * @met:	Font metrics to use
+ * @cp:		Unicode code point
+ * @x_shift:	Sub-pixel horizontal offset to render at
+ * @widthp:	Returns the width of the image in pixels
+ * @heightp:	Returns the height of the image in pixels
+ * @xoffp:	Returns the horizontal offset of the image
+ * @yoffp:	Returns the vertical offset of the image
+ * @cachedp:	Returns true if the image belongs to the cache, false if the
+ *		caller must free it
+ * Return: 8-bit-per-pixel image, or NULL if the glyph is empty
+ */
+static u8 *console_truetype_get_glyph(struct console_tt_priv *priv,
+				      struct console_tt_metrics *met, int cp,
+				      double x_shift, int *widthp,
+				      int *heightp, int *xoffp, int *yoffp,
+				      bool *cachedp)
+{
+	struct console_tt_glyph *glyph = NULL;
+	u8 *data;
+
+	*cachedp = false;
+	if (priv->glyphs) {
+		uint hash = cp * 2654435761u ^ met->font_size ^
+			(uint)(x_shift * 65536);
+
+		glyph = &priv->glyphs[hash % CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE];
+		if (glyph->font_data == met->font_data &&
+		    glyph->font_size == met->font_size && glyph->cp == cp &&
+		    glyph->x_shift == x_shift) {
+			*widthp = glyph->width;
+			*heightp = glyph->height;
+			*xoffp = glyph->xoff;
+			*yoffp = glyph->yoff;
+			*cachedp = true;
+
+			return glyph->data;
+		}
+	}
+
+	data = stbtt_GetCodepointBitmapSubpixel(&met->font, met->scale,
+						met->scale, x_shift, 0, cp,
+						widthp, heightp, xoffp, yoffp);
+	if (glyph) {
+		free(glyph->data);
+		glyph->font_data = met->font_data;
+		glyph->font_size = met->font_size;
+		glyph->cp = cp;
+		glyph->x_shift = x_shift;
+		glyph->width = *widthp;
+		glyph->height = *heightp;
+		glyph->xoff = *xoffp;
+		glyph->yoff = *yoffp;
+		glyph->data = data;
+		*cachedp = true;
+	}
+
+	return data;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    int cp)
 {
@@ -278,6 +371,7 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	u8 *bits, *data;
 	int advance;
 	void *start, *end, *line;
+	bool cached;
 	int row, ret;
 
 	/* First get some basic metrics about this character */
@@ -319,9 +413,8 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	 * image of the character. For empty characters, like ' ', data will
 	 * return NULL;
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, met->scale, met->scale,
-						x_shift, 0, cp, &width, &height,
-						&xoff, &yoff);
+	data = console_truetype_get_glyph(priv, met, cp, x_shift, &width,
+					  &height, &xoff, &yoff, &cached);
 	if (!data)
 		return width_frac;
 
@@ -412,16 +505,18 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 			break;
 		}
 		default:
-			free(data);
+			if (!cached)
+				free(data);
 			return -ENOSYS;
 		}
 
 		line += vid_priv->line_length;
 	}
+	if (!cached)
+		free(data);
 	ret = vidconsole_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
-	free(data);
 
 	return width_frac;
 }
@@ -985,11 +1080,31 @@ static int console_truetype_probe(struct udevice *dev)
 
 	select_metrics(dev, &priv->metrics[ret]);
 
+	/* the cache is only an optimisation, so carry on without it */
+	if (CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE)
+		priv->glyphs = calloc(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE,
+				      sizeof(*priv->glyphs));
+
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	if (priv->glyphs) {
+		for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE; i++)
+			free(priv->glyphs[i].data);
+		free(priv->glyphs);
+		priv->glyphs = NULL;
+	}
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -1011,5 +1126,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto	= sizeof(struct console_tt_priv),
 };
@@ -169,13 +169,24 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		    int yend, u32 colour)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
 	void *start, *line;
 	int pixels = xend - xstart;
+	int height = yend - ystart;
 	int row, i, ret;
 
 	start = priv->fb + ystart * priv->line_length;
 	start += xstart * VNBYTES(priv->bpix);
 	line = start;
+	if (ops && ops->fill) {
+		ret = ops->fill(dev, xstart, ystart, xend, yend, colour);
+		if (ret && ret != -ENOSYS)
+			return ret;
+		if (!ret) {
+			line += (yend - ystart) * priv->line_length;
+			ystart = yend;
+		}
+	}
 	for (row = ystart; row < yend; row++) {
 		switch (priv->bpix) {
 		case VIDEO_BPP8: {
@@ -210,6 +221,10 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		}
 		line += priv->line_length;
 	}
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE)) {
+		video_damage(dev, xstart, yend - height, pixels, height);
+		return 0;
+	}
 	ret = video_sync_copy(dev, start, line);
 	if (ret)
 		return ret;
@@ -217,6 +232,26 @@ int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 	return 0;
 }
 
+int video_move_rows(struct udevice *dev, int ydst, int ysrc, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	void *dst = priv->fb + ydst * priv->line_length;
+	void *src = priv->fb + ysrc * priv->line_length;
+	int size = height * priv->line_length;
+	int ret = -ENOSYS;
+
+	if (ops && ops->move_rows) {
+		ret = ops->move_rows(dev, ydst, ysrc, height);
+		if (ret && ret != -ENOSYS)
+			return ret;
+	}
+	if (ret)
+		memmove(dst, src, size);
+
+	return video_sync_copy(dev, dst, dst + size);
+}
+
 int video_reserve_from_bloblist(struct video_handoff *ho)
 {
 	if (!ho->fb || ho->size == 0)
@@ -230,11 +265,9 @@ int video_reserve_from_bloblist(struct video_handoff *ho)
 	return 0;
 }
 
-int video_fill(struct udevice *dev, u32 colour)
+/* fill the whole frame buffer using the CPU */
+static void video_fill_fb(struct video_priv *priv, u32 colour)
 {
-	struct video_priv *priv = dev_get_uclass_priv(dev);
-	int ret;
-
 	switch (priv->bpix) {
 	case VIDEO_BPP16:
 		if (CONFIG_IS_ENABLED(VIDEO_BPP16)) {
@@ -258,6 +291,21 @@ int video_fill(struct udevice *dev, u32 colour)
 		memset(priv->fb, colour, priv->fb_size);
 		break;
 	}
+}
+
+int video_fill(struct udevice *dev, u32 colour)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	int ret = -ENOSYS;
+
+	if (ops && ops->fill) {
+		ret = ops->fill(dev, 0, 0, priv->xsize, priv->ysize, colour);
+		if (ret && ret != -ENOSYS)
+			return ret;
+	}
+	if (ret)
+		video_fill_fb(priv, colour);
 	ret = video_sync_copy(dev, priv->fb, priv->fb + priv->fb_size);
 	if (ret)
 		return ret;
@@ -367,11 +415,109 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = video_index_to_colour(priv, back);
 }
 
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_bbox *damage = &priv->damage;
+	int x1 = x + width, y1 = y + height;
+
+	x = max(x, 0);
+	y = max(y, 0);
+	x1 = min(x1, (int)priv->xsize);
+	y1 = min(y1, (int)priv->ysize);
+	if (x >= x1 || y >= y1)
+		return;
+
+	if (damage->x0 >= damage->x1) {
+		damage->x0 = x;
+		damage->y0 = y;
+		damage->x1 = x1;
+		damage->y1 = y1;
+	} else {
+		damage->x0 = min(damage->x0, x);
+		damage->y0 = min(damage->y0, y);
+		damage->x1 = max(damage->x1, x1);
+		damage->y1 = max(damage->y1, y1);
+	}
+}
+
+/* Record a byte range within the frame buffer as damaged */
+static void video_damage_span(struct udevice *vid, long offset, long size)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int bytes = VNBYTES(priv->bpix);
+	int y0, y1;
+
+	if (!size || !bytes)
+		return;
+	y0 = offset / priv->line_length;
+	y1 = DIV_ROUND_UP(offset + size, priv->line_length);
+
+	/* a span crossing a line affects all the columns in between */
+	if (y1 - y0 == 1) {
+		long start = offset - (long)y0 * priv->line_length;
+
+		video_damage(vid, start / bytes, y0,
+			     DIV_ROUND_UP(start + size, bytes) - start / bytes,
+			     1);
+	} else {
+		video_damage(vid, 0, y0, priv->xsize, y1 - y0);
+	}
+}
+
+/**
+ * video_damage_sync() - Copy and flush the damaged region, then clear it
+ *
+ * Return: true if there was any damage
+ */
+static bool video_damage_sync(struct udevice *vid)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	struct video_bbox *damage = &priv->damage;
+	int bytes = VNBYTES(priv->bpix);
+	long start, len;
+	int y, rows;
+
+	if (damage->x0 >= damage->x1)
+		return false;
+
+	start = (long)damage->y0 * priv->line_length + damage->x0 * bytes;
+	len = (damage->x1 - damage->x0) * bytes;
+	rows = damage->y1 - damage->y0;
+
+	/* full-width regions are contiguous, so handle them in one go */
+	if (!damage->x0 && damage->x1 == priv->xsize) {
+		len = (long)rows * priv->line_length;
+		rows = 1;
+	}
+
+	for (y = 0; y < rows; y++, start += priv->line_length) {
+		if (IS_ENABLED(CONFIG_VIDEO_COPY) && priv->copy_fb)
+			memcpy(priv->copy_fb + start, priv->fb + start, len);
+#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
+		if (priv->flush_dcache) {
+			ulong addr = (ulong)priv->fb + start;
+
+			flush_dcache_range(ALIGN_DOWN(addr,
+						      CONFIG_SYS_CACHELINE_SIZE),
+					   ALIGN(addr + len,
+						 CONFIG_SYS_CACHELINE_SIZE));
+		}
+#endif
+	}
+	damage->x0 = damage->x1 = 0;
+
+	return true;
+}
+#endif /* CONFIG_VIDEO_DAMAGE */
+
 /* Flush video activity to the caches */
 int video_sync(struct udevice *vid, bool force)
 {
 	struct video_priv *priv = dev_get_uclass_priv(vid);
 	struct video_ops *ops = video_get_ops(vid);
+	__maybe_unused bool damaged;
 	int ret;
 
 	if (ops && ops->video_sync) {
@@ -389,7 +535,13 @@ int video_sync(struct udevice *vid, bool force)
 	 * architectures do not actually implement it. Is there a way to find
 	 * out whether it exists? For now, ARM is safe.
 	 */
-#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
+#ifdef CONFIG_VIDEO_DAMAGE
+	damaged = video_damage_sync(vid);
+#if defined(CONFIG_VIDEO_SANDBOX_SDL)
+	if (damaged)
+		sandbox_sdl_sync(priv->fb);
+#endif
+#elif defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
 	if (priv->flush_dcache) {
 		flush_dcache_range((ulong)priv->fb,
 				   ALIGN((ulong)priv->fb + priv->fb_size,
@@ -451,12 +603,12 @@ int video_get_ysize(struct udevice *dev)
 	return priv->ysize;
 }
 
-#ifdef CONFIG_VIDEO_COPY
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 int video_sync_copy(struct udevice *dev, void *from, void *to)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
-	if (priv->copy_fb) {
+	if (IS_ENABLED(CONFIG_VIDEO_DAMAGE) || priv->copy_fb) {
 		long offset, size;
 
 		/* Find the offset of the first byte to copy */
@@ -497,7 +649,12 @@ int video_sync_copy(struct udevice *dev, void *from, void *to)
 			offset = 0;
 		}
 
+#ifdef CONFIG_VIDEO_DAMAGE
+		/* the copy is done for the whole damaged region on sync */
+		video_damage_span(dev, offset, size);
+#else
 		memcpy(priv->copy_fb + offset, priv->fb + offset, size);
+#endif
 	}
 
 	return 0;
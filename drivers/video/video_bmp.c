@@ -93,6 +93,38 @@ static void write_pix8(u8 *fb, uint bpix, enum video_format eformat,
 	}
 }
 
+/**
+ * write_row8_32() - Write a row of 8bpp BMP pixels to a 32bpp frame buffer
+ *
+ * @fb: Place in frame buffer to update
+ * @lut: Frame-buffer value for each palette entry, see write_pix8()
+ * @bmap: BMP pixels, one palette index each
+ * @width: Number of pixels to write
+ */
+static void write_row8_32(u32 *fb, const u32 *lut, const u8 *bmap, int width)
+{
+	while (width--)
+		*fb++ = lut[*bmap++];
+}
+
+/**
+ * write_row24_32() - Write a row of 24bpp BMP pixels to an xRGB frame buffer
+ *
+ * The BMP holds blue, green and red bytes, which end up in the same order in
+ * the frame buffer followed by a zero byte
+ *
+ * @fb: Place in frame buffer to update
+ * @bmap: BMP pixels
+ * @width: Number of pixels to write
+ */
+static void write_row24_32(u32 *fb, const u8 *bmap, int width)
+{
+	while (width--) {
+		*fb++ = cpu_to_le32(bmap[0] | bmap[1] << 8 | bmap[2] << 16);
+		bmap += 3;
+	}
+}
+
 static void draw_unencoded_bitmap(u8 **fbp, uint bpix,
 				  enum video_format eformat, uchar *bmap,
 				  struct bmp_color_table_entry *palette,
@@ -349,6 +381,25 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 		if (!byte_width)
 			byte_width = width;
 
+		if (bmp_bpix == 8 && bpix == 32) {
+			u32 lut[256];
+			u8 idx;
+
+			/* convert the palette once rather than every pixel */
+			for (i = 0; i < colours; i++) {
+				idx = i;
+				write_pix8((u8 *)&lut[i], bpix, eformat, palette,
+					   &idx);
+			}
+			for (i = 0; i < height; ++i) {
+				schedule();
+				write_row8_32((u32 *)fb, lut, bmap, width);
+				bmap += padded_width;
+				fb -= priv->line_length;
+			}
+			break;
+		}
+
 		for (i = 0; i < height; ++i) {
 			schedule();
 			for (j = 0; j < width; j++) {
@@ -374,7 +425,14 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 		}
 		break;
 	case 24:
-		if (CONFIG_IS_ENABLED(BMP_24BPP)) {
+		if (CONFIG_IS_ENABLED(BMP_24BPP) && bpix == 32 &&
+		    eformat != VIDEO_X2R10G10B10 && eformat != VIDEO_RGBA8888) {
+			for (i = 0; i < height; ++i) {
+				write_row24_32((u32 *)fb, bmap, width);
+				fb -= priv->line_length;
+				bmap += width * 3 + padded_width - width;
+			}
+		} else if (CONFIG_IS_ENABLED(BMP_24BPP)) {
 			for (i = 0; i < height; ++i) {
 				for (j = 0; j < width; j++) {
 					if (bpix == 16) {
@@ -419,7 +477,15 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 		}
 		break;
 	case 32:
-		if (CONFIG_IS_ENABLED(BMP_32BPP)) {
+		if (CONFIG_IS_ENABLED(BMP_32BPP) &&
+		    eformat != VIDEO_X2R10G10B10 && eformat != VIDEO_RGBA8888) {
+			/* same layout as the frame buffer */
+			for (i = 0; i < height; ++i) {
+				memcpy(fb, bmap, width * 4);
+				fb -= priv->line_length;
+				bmap += width * 4;
+			}
+		} else if (CONFIG_IS_ENABLED(BMP_32BPP)) {
 			for (i = 0; i < height; ++i) {
 				for (j = 0; j < width; j++) {
 					if (eformat == VIDEO_X2R10G10B10) {
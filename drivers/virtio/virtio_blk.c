@@ -12,6 +12,7 @@
 #include <virtio_types.h>
 #include <virtio.h>
 #include <virtio_ring.h>
+#include <linux/sizes.h>
 #include "virtio_blk.h"
 
 struct virtio_blk_priv {
@@ -59,19 +60,43 @@ static void virtio_blk_init_data_sg(void *buffer, lbaint_t blkcnt, struct virtio
 	sg->length = blkcnt * 512;
 }
 
-static ulong virtio_blk_do_req(struct udevice *dev, u64 sector,
-			       lbaint_t blkcnt, void *buffer, u32 type)
+/*
+ * Large transfers are split into up to this many requests, which are all
+ * queued before the device is notified so that it can work on them in
+ * parallel
+ */
+#define VIRTIO_BLK_MAX_REQS	8
+/* Smallest transfer worth a request of its own, in blocks */
+#define VIRTIO_BLK_MIN_REQ_BLKS	(SZ_128K / 512)
+
+/* Number of requests to split a transfer of @blkcnt blocks into */
+static unsigned int virtio_blk_nr_reqs(struct virtqueue *vq, u32 type,
+				       lbaint_t blkcnt)
+{
+	unsigned int nr;
+
+	if (type != VIRTIO_BLK_T_IN && type != VIRTIO_BLK_T_OUT)
+		return 1;
+
+	/* Each request uses a header, a data and a status descriptor */
+	nr = min_t(lbaint_t, blkcnt / VIRTIO_BLK_MIN_REQ_BLKS,
+		   vq->num_free / 3);
+
+	return clamp_t(unsigned int, nr, 1, VIRTIO_BLK_MAX_REQS);
+}
+
+static int virtio_blk_add_req(struct udevice *dev, u64 sector,
+			      lbaint_t blkcnt, void *buffer, u32 type,
+			      struct virtio_blk_outhdr *out_hdr,
+			      struct virtio_blk_discard_write_zeroes *wz_hdr,
+			      u8 *status)
 {
 	struct virtio_blk_priv *priv = dev_get_priv(dev);
-	struct virtio_blk_outhdr out_hdr;
-	struct virtio_blk_discard_write_zeroes wz_hdr;
 	unsigned int num_out = 0, num_in = 0;
 	struct virtio_sg hdr_sg, wz_sg, data_sg, status_sg;
 	struct virtio_sg *sgs[3];
-	u8 status;
-	int ret;
 
-	virtio_blk_init_header_sg(dev, sector, type, &out_hdr, &hdr_sg);
+	virtio_blk_init_header_sg(dev, sector, type, out_hdr, &hdr_sg);
 	sgs[num_out++] = &hdr_sg;
 
 	switch (type) {
@@ -85,7 +110,7 @@ static ulong virtio_blk_do_req(struct udevice *dev, u64 sector,
 		break;
 
 	case VIRTIO_BLK_T_WRITE_ZEROES:
-		virtio_blk_init_write_zeroes_sg(dev, sector, blkcnt, &wz_hdr, &wz_sg);
+		virtio_blk_init_write_zeroes_sg(dev, sector, blkcnt, wz_hdr, &wz_sg);
 		sgs[num_out++] = &wz_sg;
 		break;
 
@@ -93,23 +118,63 @@ static ulong virtio_blk_do_req(struct udevice *dev, u64 sector,
 		return -EINVAL;
 	}
 
-	virtio_blk_init_status_sg(&status, &status_sg);
+	virtio_blk_init_status_sg(status, &status_sg);
 	sgs[num_out + num_in++] = &status_sg;
 	log_debug("dev=%s, active=%d, priv=%p, priv->vq=%p\n", dev->name,
 		  device_active(dev), priv, priv->vq);
 
-	ret = virtqueue_add(priv->vq, sgs, num_out, num_in);
-	if (ret)
-		return ret;
+	return virtqueue_add(priv->vq, sgs, num_out, num_in);
+}
 
-	virtqueue_kick(priv->vq);
+static ulong virtio_blk_do_req(struct udevice *dev, u64 sector,
+			       lbaint_t blkcnt, void *buffer, u32 type)
+{
+	struct virtio_blk_priv *priv = dev_get_priv(dev);
+	struct virtio_blk_outhdr out_hdr[VIRTIO_BLK_MAX_REQS];
+	struct virtio_blk_discard_write_zeroes wz_hdr;
+	u8 status[VIRTIO_BLK_MAX_REQS];
+	unsigned int nr, added, i;
+	lbaint_t per_req, left = blkcnt;
+	ulong ret = blkcnt;
+	int err = 0;
+
+	nr = virtio_blk_nr_reqs(priv->vq, type, blkcnt);
+	per_req = DIV_ROUND_UP(blkcnt, nr);
+
+	for (added = 0; added < nr && left; added++) {
+		lbaint_t count = min(per_req, left);
+
+		err = virtio_blk_add_req(dev, sector, count, buffer, type,
+					 &out_hdr[added], &wz_hdr,
+					 &status[added]);
+		if (err)
+			break;
+		sector += count;
+		left -= count;
+		if (buffer)
+			buffer += count * 512;
+	}
+
+	if (added) {
+		virtqueue_kick(priv->vq);
+
+		log_debug("wait %u...", added);
+		for (i = 0; i < added; i++) {
+			while (!virtqueue_get_buf(priv->vq, NULL))
+				;
+		}
+		log_debug("done\n");
+	}
+
+	if (err)
+		return err;
 
-	log_debug("wait...");
-	while (!virtqueue_get_buf(priv->vq, NULL))
-		;
-	log_debug("done\n");
+	for (i = 0; i < added; i++) {
+		if (status[i] != VIRTIO_BLK_S_OK)
+			ret = -EIO;
+	}
 
-	return status == VIRTIO_BLK_S_OK ? blkcnt : -EIO;
+	return ret;
 }
 
 static ulong virtio_blk_read(struct udevice *dev, lbaint_t start,
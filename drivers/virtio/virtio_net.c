@@ -12,7 +12,10 @@
 #include "virtio_net.h"
 
 /* Amount of buffers to keep in the RX virtqueue */
-#define VIRTIO_NET_NUM_RX_BUFS	32
+#define VIRTIO_NET_NUM_RX_BUFS	CONFIG_VIRTIO_NET_RX_BUFS
+
+/* Number of returned RX buffers to collect before notifying the device */
+#define VIRTIO_NET_RX_REFILL_BATCH	8
 
 /*
  * This value comes from the VirtIO spec: 1500 for maximum packet size,
@@ -35,16 +38,19 @@ struct virtio_net_priv {
 };
 
 /*
- * For simplicity, the driver only negotiates the VIRTIO_NET_F_MAC feature.
- * For the VIRTIO_NET_F_STATUS feature, we don't negotiate it, hence per spec
- * we should assume the link is always active.
+ * For simplicity, the driver only negotiates the VIRTIO_NET_F_MAC and
+ * VIRTIO_NET_F_MRG_RXBUF features. For the VIRTIO_NET_F_STATUS feature, we
+ * don't negotiate it, hence per spec we should assume the link is always
+ * active.
  */
 static const u32 feature[] = {
-	VIRTIO_NET_F_MAC
+	VIRTIO_NET_F_MAC,
+	VIRTIO_NET_F_MRG_RXBUF,
 };
 
 static const u32 feature_legacy[] = {
-	VIRTIO_NET_F_MAC
+	VIRTIO_NET_F_MAC,
+	VIRTIO_NET_F_MRG_RXBUF,
 };
 
 static int virtio_net_start(struct udevice *dev)
@@ -52,14 +58,17 @@ static int virtio_net_start(struct udevice *dev)
 	struct virtio_net_priv *priv = dev_get_priv(dev);
 	struct virtio_sg sg;
 	struct virtio_sg *sgs[] = { &sg };
-	int i;
+	int i, num;
 
 	if (!priv->rx_running) {
 		/* receive buffer length is always 1526 */
 		sg.length = VIRTIO_NET_RX_BUF_SIZE;
 
+		num = min_t(int, VIRTIO_NET_NUM_RX_BUFS,
+			    virtqueue_get_vring_size(priv->rx_vq));
+
 		/* setup the receive buffer address */
-		for (i = 0; i < VIRTIO_NET_NUM_RX_BUFS; i++) {
+		for (i = 0; i < num; i++) {
 			sg.addr = priv->rx_buff[i];
 			virtqueue_add(priv->rx_vq, sgs, 0, 1);
 		}
@@ -105,15 +114,57 @@ static int virtio_net_send(struct udevice *dev, void *packet, int length)
 	return 0;
 }
 
+static void virtio_net_refill(struct virtio_net_priv *priv, void *buf)
+{
+	struct virtio_sg sg = { buf, VIRTIO_NET_RX_BUF_SIZE };
+	struct virtio_sg *sgs[] = { &sg };
+
+	/*
+	 * Put the buffer back to the rx ring, but only tell the device once
+	 * a batch has been collected, to save a notification per packet
+	 */
+	virtqueue_add(priv->rx_vq, sgs, 0, 1);
+	if (priv->rx_vq->num_added >= VIRTIO_NET_RX_REFILL_BATCH)
+		virtqueue_kick(priv->rx_vq);
+}
+
 static int virtio_net_recv(struct udevice *dev, int flags, uchar **packetp)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
+	struct virtio_net_hdr_v1 *hdr;
 	unsigned int len;
 	void *buf;
+	u16 num_buffers;
 
 	buf = virtqueue_get_buf(priv->rx_vq, &len);
-	if (!buf)
+	if (!buf) {
+		/* Hand over any buffers still held back before going idle */
+		if (priv->rx_vq->num_added)
+			virtqueue_kick(priv->rx_vq);
 		return -EAGAIN;
+	}
+
+	/*
+	 * With mergeable buffers a packet may span several of them. Each of
+	 * ours holds a full-sized frame, so that should not happen, but drop
+	 * the packet rather than pass up a truncated one.
+	 */
+	if (virtio_has_feature(dev, VIRTIO_NET_F_MRG_RXBUF)) {
+		hdr = buf;
+		num_buffers = virtio16_to_cpu(dev, hdr->num_buffers);
+		if (num_buffers > 1) {
+			debug("%s: dropping packet in %u buffers\n", dev->name,
+			      num_buffers);
+			virtio_net_refill(priv, buf);
+			while (--num_buffers) {
+				buf = virtqueue_get_buf(priv->rx_vq, NULL);
+				if (!buf)
+					break;
+				virtio_net_refill(priv, buf);
+			}
+			return -EAGAIN;
+		}
+	}
 
 	*packetp = buf + priv->net_hdr_len;
 	return len - priv->net_hdr_len;
@@ -122,12 +173,8 @@ static int virtio_net_recv(struct udevice *dev, int flags, uchar **packetp)
 static int virtio_net_free_pkt(struct udevice *dev, uchar *packet, int length)
 {
 	struct virtio_net_priv *priv = dev_get_priv(dev);
-	void *buf = packet - priv->net_hdr_len;
-	struct virtio_sg sg = { buf, VIRTIO_NET_RX_BUF_SIZE };
-	struct virtio_sg *sgs[] = { &sg };
 
-	/* Put the buffer back to the rx ring */
-	virtqueue_add(priv->rx_vq, sgs, 0, 1);
+	virtio_net_refill(priv, packet - priv->net_hdr_len);
 
 	return 0;
 }
@@ -207,7 +254,7 @@ static int virtio_net_probe(struct udevice *dev)
 	 * VIRTIO_NET_F_MRG_RXBUF was negotiated. Without that feature
 	 * the structure was 2 bytes shorter.
 	 */
-	if (uc_priv->legacy)
+	if (uc_priv->legacy && !virtio_has_feature(dev, VIRTIO_NET_F_MRG_RXBUF))
 		priv->net_hdr_len = sizeof(struct virtio_net_hdr);
 	else
 		priv->net_hdr_len = sizeof(struct virtio_net_hdr_v1);
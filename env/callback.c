@@ -34,6 +34,106 @@ static struct env_clbk_tbl *find_env_callback(const char *name)
 static int first_call = 1;
 static const char *callback_list;
 
+#ifndef CONFIG_REGEX
+/**
+ * struct env_clbk_map - A parsed callback-association list
+ *
+ * Without regex support every name in an association list is matched
+ * exactly, so the list can be parsed once into an array sorted by name. That
+ * avoids scanning the whole list string for each variable on import.
+ *
+ * @count: Number of entries in @names and @clbks
+ * @names: Variable names, sorted
+ * @clbks: Callback for each name, NULL if the association has none
+ */
+struct env_clbk_map {
+	int count;
+	char **names;
+	struct env_clbk_tbl **clbks;
+};
+
+static struct env_clbk_map static_map, dynamic_map;
+
+static int map_find(struct env_clbk_map *map, const char *name, bool *found)
+{
+	int lo = 0, hi = map->count;
+
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		int cmp = strcmp(map->names[mid], name);
+
+		if (!cmp) {
+			*found = true;
+			return mid;
+		}
+		if (cmp < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*found = false;
+
+	return lo;
+}
+
+static int map_add(const char *name, const char *value, void *priv)
+{
+	struct env_clbk_map *map = priv;
+	struct env_clbk_tbl *clbkp = NULL;
+	char **names;
+	struct env_clbk_tbl **clbks;
+	char *copy;
+	bool found;
+	int i;
+
+	if (value && *value)
+		clbkp = find_env_callback(value);
+
+	/* a later association for the same name replaces an earlier one */
+	i = map_find(map, name, &found);
+	if (found) {
+		map->clbks[i] = clbkp;
+		return 0;
+	}
+
+	names = realloc(map->names, (map->count + 1) * sizeof(*names));
+	if (!names)
+		return -ENOMEM;
+	map->names = names;
+	clbks = realloc(map->clbks, (map->count + 1) * sizeof(*clbks));
+	if (!clbks)
+		return -ENOMEM;
+	map->clbks = clbks;
+	copy = strdup(name);
+	if (!copy)
+		return -ENOMEM;
+
+	memmove(&names[i + 1], &names[i], (map->count - i) * sizeof(*names));
+	memmove(&clbks[i + 1], &clbks[i], (map->count - i) * sizeof(*clbks));
+	names[i] = copy;
+	clbks[i] = clbkp;
+	map->count++;
+
+	return 0;
+}
+
+static bool maps_ok;
+
+static struct env_clbk_tbl *map_lookup(const char *name)
+{
+	bool found;
+	int i;
+
+	/* the ".callbacks" variable takes precedence over the static list */
+	i = map_find(&dynamic_map, name, &found);
+	if (found)
+		return dynamic_map.clbks[i];
+	i = map_find(&static_map, name, &found);
+
+	return found ? static_map.clbks[i] : NULL;
+}
+#endif
+
 /*
  * Look for a possible callback for a newly added variable
  * This is called specifically when the variable did not exist in the hash
@@ -49,10 +149,25 @@ void env_callback_init(struct env_entry *var_entry)
 	if (first_call) {
 		callback_list = env_get(ENV_CALLBACK_VAR);
 		first_call = 0;
+#ifndef CONFIG_REGEX
+		maps_ok = !env_attr_walk(ENV_CALLBACK_LIST_STATIC, map_add,
+					 &static_map) &&
+			  (!callback_list ||
+			   !env_attr_walk(callback_list, map_add, &dynamic_map));
+#endif
 	}
 
 	var_entry->callback = NULL;
 
+#ifndef CONFIG_REGEX
+	if (maps_ok) {
+		clbkp = map_lookup(var_name);
+		if (clbkp)
+			var_entry->callback = clbkp->callback;
+		return;
+	}
+#endif
+
 	/* look in the ".callbacks" var for a reference to this variable */
 	if (callback_list != NULL)
 		ret = env_attr_lookup(callback_list, var_name, callback_name);
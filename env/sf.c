@@ -74,6 +74,246 @@ static int setup_flash_device(struct spi_flash **env_flash)
 	return 0;
 }
 
+#ifdef CONFIG_ENV_SPI_JOURNAL
+#define ENV_JOURNAL_MAGIC	0x4a564e45	/* "ENVJ" */
+#define ENV_JOURNAL_SIZE	CONFIG_ENV_SPI_JOURNAL_SIZE
+
+/**
+ * struct env_journal_rec - Header of a record in the environment journal
+ *
+ * Each record holds one variable in the form written by hexport_r(), i.e.
+ * "name=value", or just "name" if the variable was deleted, followed by a
+ * NUL. The data is padded to a multiple of four bytes. The first record which
+ * does not check out ends the journal.
+ *
+ * @magic: ENV_JOURNAL_MAGIC
+ * @base: CRC of the environment copy which the record applies to
+ * @len: Length of the data, including the NUL
+ * @crc: CRC32 of the data
+ */
+struct env_journal_rec {
+	u32 magic;
+	u32 base;
+	u32 len;
+	u32 crc;
+};
+
+/* Environment data as of the last load or save, NULL if not known */
+static char *journal_snap;
+/* CRC of the environment copy in flash */
+static u32 journal_base;
+/* Offset of the first unused byte in the journal */
+static u32 journal_end = ENV_JOURNAL_SIZE;
+
+static void env_journal_set_snap(const char *data)
+{
+	if (!journal_snap)
+		journal_snap = malloc(ENV_SIZE);
+	if (journal_snap)
+		memcpy(journal_snap, data, ENV_SIZE);
+}
+
+/* Replay the journal on top of the environment which was just imported */
+static void env_journal_load(struct spi_flash *env_flash, const env_t *env)
+{
+	struct env_journal_rec *rec;
+	char *buf, *data;
+	u32 off = 0, len = 0;
+	int ret;
+
+	journal_end = ENV_JOURNAL_SIZE;
+	buf = malloc(ENV_JOURNAL_SIZE);
+	data = malloc(ENV_JOURNAL_SIZE + 1);
+	if (!buf || !data)
+		goto out;
+
+	ret = spi_flash_read(env_flash, CONFIG_ENV_SPI_JOURNAL_OFFSET,
+			     ENV_JOURNAL_SIZE, buf);
+	if (ret)
+		goto out;
+
+	while (off + sizeof(*rec) <= ENV_JOURNAL_SIZE) {
+		const char *rec_data;
+
+		rec = (struct env_journal_rec *)(buf + off);
+		rec_data = (const char *)(rec + 1);
+		if (rec->magic != ENV_JOURNAL_MAGIC || rec->base != env->crc ||
+		    !rec->len ||
+		    rec->len > ENV_JOURNAL_SIZE - off - sizeof(*rec) ||
+		    rec_data[rec->len - 1] ||
+		    crc32(0, rec_data, rec->len) != rec->crc)
+			break;
+		memcpy(data + len, rec_data, rec->len);
+		len += rec->len;
+		off += sizeof(*rec) + ALIGN(rec->len, 4);
+	}
+
+	/*
+	 * Only append where the flash is still erased. Anything else, e.g. a
+	 * record left over from an older environment or cut short by a power
+	 * failure, means the next save must rewrite everything.
+	 */
+	if (off >= ENV_JOURNAL_SIZE ||
+	    !memchr_inv(buf + off, 0xff, ENV_JOURNAL_SIZE - off))
+		journal_end = off;
+
+	if (len) {
+		data[len] = '\0';
+		if (!himport_r(&env_htab, data, len, '\0',
+			       H_NOCLEAR | H_EXTERNAL, 0, 0, NULL))
+			printf("Cannot apply environment journal\n");
+	}
+
+	journal_base = env->crc;
+	if (!journal_snap)
+		journal_snap = malloc(ENV_SIZE);
+	if (journal_snap &&
+	    hexport_r(&env_htab, '\0', 0, &journal_snap, ENV_SIZE, 0, NULL) < 0) {
+		free(journal_snap);
+		journal_snap = NULL;
+	}
+out:
+	free(data);
+	free(buf);
+}
+
+/* Compare two exported entries by name, i.e. up to the '=' */
+static int env_journal_keycmp(const char *a, const char *b)
+{
+	while (*a != '=' && *a && *a == *b) {
+		a++;
+		b++;
+	}
+
+	return (*a == '=' ? 0 : (u8)*a) - (*b == '=' ? 0 : (u8)*b);
+}
+
+/**
+ * env_journal_append() - Append the changes to an environment to the journal
+ *
+ * @env_flash: SPI flash holding the environment
+ * @env_new: Newly exported environment
+ * Return: 0 if the changes were appended, 1 if the journal cannot take them
+ *	and the environment must be written in full, other -ve on error
+ */
+static int env_journal_append(struct spi_flash *env_flash, env_t *env_new)
+{
+	const char *p = journal_snap, *q = (const char *)env_new->data;
+	u32 space = ENV_JOURNAL_SIZE - journal_end, len = 0;
+	char *buf;
+	int ret;
+
+	if (!journal_snap || journal_end >= ENV_JOURNAL_SIZE)
+		return 1;
+
+	buf = malloc(space);
+	if (!buf)
+		return 1;
+
+	/* Both are sorted by name, so walk them together */
+	while (*p || *q) {
+		struct env_journal_rec *rec;
+		const char *from;
+		int cmp, size;
+
+		if (!*p)
+			cmp = 1;
+		else if (!*q)
+			cmp = -1;
+		else
+			cmp = env_journal_keycmp(p, q);
+
+		if (cmp < 0) {
+			/* deleted: record just the name */
+			from = p;
+			size = strchrnul(p, '=') - p + 1;
+		} else if (cmp > 0 || strcmp(p, q)) {
+			/* added or changed */
+			from = q;
+			size = strlen(q) + 1;
+		} else {
+			from = NULL;
+			size = 0;
+		}
+		if (cmp <= 0)
+			p += strlen(p) + 1;
+		if (cmp >= 0)
+			q += strlen(q) + 1;
+		if (!from)
+			continue;
+
+		if (len + sizeof(*rec) + ALIGN(size, 4) > space) {
+			free(buf);
+			return 1;
+		}
+		rec = (struct env_journal_rec *)(buf + len);
+		rec->magic = ENV_JOURNAL_MAGIC;
+		rec->base = journal_base;
+		rec->len = size;
+		memcpy(rec + 1, from, size - 1);
+		memset((char *)(rec + 1) + size - 1, '\0', ALIGN(size, 4) - size + 1);
+		rec->crc = crc32(0, (const uchar *)(rec + 1), size);
+		len += sizeof(*rec) + ALIGN(size, 4);
+	}
+
+	ret = 0;
+	if (len) {
+		puts("Appending to SPI flash journal...");
+		ret = spi_flash_write(env_flash,
+				      CONFIG_ENV_SPI_JOURNAL_OFFSET + journal_end,
+				      len, buf);
+		if (ret) {
+			/* the journal is in an unknown state now */
+			journal_end = ENV_JOURNAL_SIZE;
+		} else {
+			journal_end += len;
+			env_journal_set_snap((const char *)env_new->data);
+			puts("done\n");
+		}
+	}
+	free(buf);
+
+	return ret;
+}
+
+/* Erase the journal, starting an empty one if @env_new was just written */
+static int env_journal_reset(struct spi_flash *env_flash, env_t *env_new)
+{
+	int ret;
+
+	journal_end = ENV_JOURNAL_SIZE;
+	ret = spi_flash_erase(env_flash, CONFIG_ENV_SPI_JOURNAL_OFFSET,
+			      ENV_JOURNAL_SIZE);
+	if (ret)
+		return ret;
+	/* with no environment written, the next save must write it in full */
+	if (env_new) {
+		journal_end = 0;
+		journal_base = env_new->crc;
+		env_journal_set_snap((const char *)env_new->data);
+	}
+
+	return 0;
+}
+#else
+static inline void env_journal_load(struct spi_flash *env_flash,
+				    const env_t *env)
+{
+}
+
+static inline int env_journal_append(struct spi_flash *env_flash,
+				     env_t *env_new)
+{
+	return 1;
+}
+
+static inline int env_journal_reset(struct spi_flash *env_flash,
+				    env_t *env_new)
+{
+	return 0;
+}
+#endif /* CONFIG_ENV_SPI_JOURNAL */
+
 #if defined(CONFIG_ENV_OFFSET_REDUND)
 static int env_sf_save(void)
 {
@@ -214,6 +454,14 @@ static int env_sf_save(void)
 	if (IS_ENABLED(CONFIG_ENV_SECT_SIZE_AUTO))
 		sect_size = env_flash->mtd.erasesize;
 
+	ret = env_export(&env_new);
+	if (ret)
+		goto done;
+
+	ret = env_journal_append(env_flash, &env_new);
+	if (ret <= 0)
+		goto done;
+
 	/* Is the sector larger than the env (i.e. embedded) */
 	if (sect_size > CONFIG_ENV_SIZE) {
 		saved_size = sect_size - CONFIG_ENV_SIZE;
@@ -230,10 +478,6 @@ static int env_sf_save(void)
 			goto done;
 	}
 
-	ret = env_export(&env_new);
-	if (ret)
-		goto done;
-
 	sector = DIV_ROUND_UP(CONFIG_ENV_SIZE, sect_size);
 
 	puts("Erasing SPI flash...");
@@ -255,6 +499,10 @@ static int env_sf_save(void)
 			goto done;
 	}
 
+	ret = env_journal_reset(env_flash, &env_new);
+	if (ret)
+		goto done;
+
 	ret = 0;
 	puts("done\n");
 
@@ -291,8 +539,10 @@ static int env_sf_load(void)
 	}
 
 	ret = env_import(buf, 1, H_EXTERNAL);
-	if (!ret)
+	if (!ret) {
+		env_journal_load(env_flash, (env_t *)buf);
 		gd->env_valid = ENV_VALID;
+	}
 
 err_read:
 	spi_flash_free(env_flash);
@@ -320,6 +570,8 @@ static int env_sf_erase(void)
 
 	if (ENV_OFFSET_REDUND != OFFSET_INVALID)
 		ret = spi_flash_write(env_flash, ENV_OFFSET_REDUND, CONFIG_ENV_SIZE, &env);
+	else
+		ret = env_journal_reset(env_flash, NULL);
 
 done:
 	spi_flash_free(env_flash);
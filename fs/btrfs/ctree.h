@@ -122,6 +122,11 @@ struct btrfs_fs_info {
 	u32 nodesize;
 	u32 sectorsize;
 	u32 stripesize;
+
+	/* Readahead window for compressed extents, see inode.c */
+	char *ra_buf;
+	u64 ra_start;
+	u64 ra_len;
 };
 
 static inline u32 BTRFS_MAX_ITEM_SIZE(const struct btrfs_fs_info *info)
@@ -408,6 +408,53 @@ out:
 	return ret;
 }
 
+/*
+ * Compressed extents hold at most 128KiB of data, so a large file has many of
+ * them, usually one after another on disk. Read a window covering several, so
+ * that each one does not need its own device read.
+ */
+#define BTRFS_READAHEAD_SIZE	SZ_1M
+
+/*
+ * Get the on-disk data of a compressed extent from the readahead window,
+ * filling the window first if needed.
+ *
+ * Return a pointer to the data, or NULL if it cannot be read this way.
+ */
+static const char *read_compressed_ahead(struct btrfs_fs_info *fs_info,
+					 u64 logical, u32 csize)
+{
+	struct btrfs_multi_bio *multi = NULL;
+	u64 len = BTRFS_READAHEAD_SIZE;
+	int ret;
+
+	if (fs_info->ra_buf && logical >= fs_info->ra_start &&
+	    logical + csize <= fs_info->ra_start + fs_info->ra_len)
+		return fs_info->ra_buf + logical - fs_info->ra_start;
+
+	if (csize > BTRFS_READAHEAD_SIZE)
+		return NULL;
+	if (!fs_info->ra_buf) {
+		fs_info->ra_buf = malloc_cache_aligned(BTRFS_READAHEAD_SIZE);
+		if (!fs_info->ra_buf)
+			return NULL;
+	}
+
+	/* Stay within one stripe, so that this is a single device read */
+	ret = btrfs_map_block(fs_info, READ, logical, &len, &multi, 1, NULL);
+	kfree(multi);
+	if (ret || len < csize)
+		return NULL;
+	fs_info->ra_len = 0;
+	ret = read_extent_data(fs_info, fs_info->ra_buf, logical, &len, 1);
+	if (ret < 0)
+		return NULL;
+	fs_info->ra_start = logical;
+	fs_info->ra_len = len;
+
+	return fs_info->ra_buf;
+}
+
 /*
  * Read out regular extent.
  *
@@ -427,11 +474,13 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	u64 extent_num_bytes;
 	u64 disk_bytenr;
 	u64 read;
+	const char *cdata;
 	char *cbuf = NULL;
 	char *dbuf = NULL;
 	u32 csize;
 	u32 dsize;
 	bool finished = false;
+	bool direct;
 	int num_copies;
 	int i;
 	int slot = path->slots[0];
@@ -477,29 +526,43 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	disk_bytenr = btrfs_file_extent_disk_bytenr(leaf, fi);
 	num_copies = btrfs_num_copies(fs_info, disk_bytenr, csize);
 
-	cbuf = malloc_cache_aligned(csize);
-	dbuf = malloc_cache_aligned(dsize);
-	if (!cbuf || !dbuf) {
-		ret = -ENOMEM;
-		goto out;
-	}
-	/* For compressed extent, we must read the whole on-disk extent */
-	for (i = 1; i <= num_copies; i++) {
-		read = csize;
-		ret = read_extent_data(fs_info, cbuf, disk_bytenr,
-				       &read, i);
-		if (ret < 0 || read != csize)
-			continue;
-		finished = true;
-		break;
+	/* Decompress straight into @dest if all of the extent is wanted */
+	direct = btrfs_file_extent_offset(leaf, fi) + offset == key.offset &&
+		 len >= dsize;
+	if (!direct) {
+		dbuf = malloc_cache_aligned(dsize);
+		if (!dbuf) {
+			ret = -ENOMEM;
+			goto out;
+		}
 	}
-	if (!finished) {
-		ret = -EIO;
-		goto out;
+
+	cdata = read_compressed_ahead(fs_info, disk_bytenr, csize);
+	if (!cdata) {
+		cbuf = malloc_cache_aligned(csize);
+		if (!cbuf) {
+			ret = -ENOMEM;
+			goto out;
+		}
+		/* For compressed extent, we must read the whole on-disk extent */
+		for (i = 1; i <= num_copies; i++) {
+			read = csize;
+			ret = read_extent_data(fs_info, cbuf, disk_bytenr,
+					       &read, i);
+			if (ret < 0 || read != csize)
+				continue;
+			finished = true;
+			break;
+		}
+		if (!finished) {
+			ret = -EIO;
+			goto out;
+		}
+		cdata = cbuf;
 	}
 
-	ret = btrfs_decompress(btrfs_file_extent_compression(leaf, fi), cbuf,
-			       csize, dbuf, dsize);
+	ret = btrfs_decompress(btrfs_file_extent_compression(leaf, fi), cdata,
+			       csize, direct ? dest : dbuf, dsize);
 	if (ret < 0) {
 		ret = -EIO;
 		goto out;
@@ -509,11 +572,11 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	 * to be zeroed out.
 	 */
 	if (ret < dsize)
-		memset(dbuf + ret, 0, dsize - ret);
+		memset((direct ? dest : dbuf) + ret, 0, dsize - ret);
 	/* Then copy the needed part */
-	memcpy(dest,
-	       dbuf + btrfs_file_extent_offset(leaf, fi) + offset - key.offset,
-	       len);
+	if (!direct)
+		memcpy(dest, dbuf + btrfs_file_extent_offset(leaf, fi) +
+		       offset - key.offset, len);
 	ret = len;
 out:
 	free(cbuf);
@@ -12,6 +12,9 @@
 /* Offset of master header from the start of a coreboot ROM */
 #define MASTER_HDR_OFFSET	0x38
 
+/* Number of hash buckets used to look up files by name */
+#define CBFS_HASH_SIZE		32
+
 static const u32 good_magic = 0x4f524243;
 static const u8 good_file_magic[] = "LARCHIVE";
 
@@ -22,6 +25,7 @@ static const u8 good_file_magic[] = "LARCHIVE";
  * @start: Start position of CBFS in memory, typically memory-mapped SPI flash
  * @header: Header read from the CBFS, byte-swapped so U-Boot can access it
  * @file_cache: List of file headers read from CBFS
+ * @hash: Files in @file_cache, hashed by name, each list linked by hash_next
  * @result: Success/error result
  */
 struct cbfs_priv {
@@ -29,6 +33,7 @@ struct cbfs_priv {
 	void *start;
 	struct cbfs_header header;
 	struct cbfs_cachenode *file_cache;
+	struct cbfs_cachenode *hash[CBFS_HASH_SIZE];
 	enum cbfs_result result;
 };
 
@@ -57,6 +62,17 @@ enum cbfs_result cbfs_get_result(void)
 	return cbfs_s.result;
 }
 
+/* Hash a filename (FNV-1a) to select the bucket to look in */
+static uint cbfs_name_hash(const char *name)
+{
+	u32 hash = 2166136261U;
+
+	while (*name)
+		hash = (hash ^ (u8)*name++) * 16777619U;
+
+	return hash % CBFS_HASH_SIZE;
+}
+
 /* Do endian conversion on the CBFS header structure. */
 static void swap_header(struct cbfs_header *dest, struct cbfs_header *src)
 {
@@ -98,6 +114,7 @@ static int fill_node(struct cbfs_cachenode *node, void *start,
 		return -EBADF;
 
 	node->next = NULL;
+	node->hash_next = NULL;
 	node->type = header->type;
 	node->data = start + header->offset;
 	node->data_length = header->len;
@@ -188,6 +205,7 @@ static int file_cbfs_fill_cache(struct cbfs_priv *priv, int size, int align)
 	struct cbfs_cachenode *cache_node;
 	struct cbfs_cachenode *node;
 	struct cbfs_cachenode **cache_tail = &priv->file_cache;
+	struct cbfs_cachenode **hash_tail;
 	void *start;
 
 	/* Clear out old information. */
@@ -198,6 +216,7 @@ static int file_cbfs_fill_cache(struct cbfs_priv *priv, int size, int align)
 		free(old_node);
 	}
 	priv->file_cache = NULL;
+	memset(priv->hash, '\0', sizeof(priv->hash));
 
 	start = priv->start;
 	while (size >= align) {
@@ -219,6 +238,12 @@ static int file_cbfs_fill_cache(struct cbfs_priv *priv, int size, int align)
 		*cache_tail = node;
 		cache_tail = &node->next;
 
+		/* Add at the end, so the first file with a name is found */
+		hash_tail = &priv->hash[cbfs_name_hash(node->name)];
+		while (*hash_tail)
+			hash_tail = &(*hash_tail)->hash_next;
+		*hash_tail = node;
+
 		size -= used;
 		start += used;
 	}
@@ -406,17 +431,18 @@ void file_cbfs_get_next(const struct cbfs_cachenode **file)
 const struct cbfs_cachenode *cbfs_find_file(struct cbfs_priv *priv,
 					    const char *name)
 {
-	struct cbfs_cachenode *cache_node = priv->file_cache;
+	struct cbfs_cachenode *cache_node;
 
 	if (!priv->initialized) {
 		priv->result = CBFS_NOT_INITIALIZED;
 		return NULL;
 	}
 
+	cache_node = priv->hash[cbfs_name_hash(name)];
 	while (cache_node) {
 		if (!strcmp(name, cache_node->name))
 			break;
-		cache_node = cache_node->next;
+		cache_node = cache_node->hash_next;
 	}
 	if (!cache_node)
 		priv->result = CBFS_FILE_NOT_FOUND;
@@ -507,6 +533,13 @@ u32 file_cbfs_type(const struct cbfs_cachenode *file)
 	return file->type;
 }
 
+const void *file_cbfs_data(const struct cbfs_cachenode *file)
+{
+	cbfs_s.result = CBFS_SUCCESS;
+
+	return file->data;
+}
+
 long file_cbfs_read(const struct cbfs_cachenode *file, void *buffer,
 		    unsigned long maxsize)
 {
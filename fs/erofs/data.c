@@ -216,11 +216,83 @@ static int erofs_read_raw_data(struct erofs_inode *inode, char *buffer,
 	return 0;
 }
 
+/**
+ * struct z_erofs_cache - compressed data kept between cluster reads
+ *
+ * @raw: Read-ahead window of compressed data
+ * @raw_start: Device offset of @raw
+ * @raw_len: Number of valid bytes in @raw
+ * @out: Last partly read cluster, fully decompressed
+ * @out_pa: Physical address of the cluster in @out
+ * @out_la: Logical address of the cluster in @out
+ * @out_len: Decompressed length of @out, 0 if empty
+ */
+static struct z_erofs_cache {
+	char *raw;
+	erofs_off_t raw_start;
+	unsigned int raw_len;
+	char *out;
+	erofs_off_t out_pa;
+	erofs_off_t out_la;
+	u64 out_len;
+} zcache;
+
+#ifdef CONFIG_FS_EROFS_ZIP_READAHEAD
+#define Z_EROFS_READAHEAD	(CONFIG_FS_EROFS_ZIP_READAHEAD * 1024)
+#else
+#define Z_EROFS_READAHEAD	0
+#endif
+
+void z_erofs_cache_drop(void)
+{
+	free(zcache.raw);
+	free(zcache.out);
+	memset(&zcache, '\0', sizeof(zcache));
+}
+
+/*
+ * Get the compressed data of a cluster. Clusters are visited from the end
+ * of the file backwards, so the read-ahead window ends at the cluster
+ * asked for and also covers those before it.
+ */
+static char *z_erofs_read_raw(char *raw, erofs_off_t pa, u64 plen)
+{
+	erofs_off_t start, end = pa + plen;
+	int ret;
+
+	if (plen < Z_EROFS_READAHEAD) {
+		if (zcache.raw && pa >= zcache.raw_start &&
+		    end <= zcache.raw_start + zcache.raw_len)
+			return zcache.raw + (pa - zcache.raw_start);
+
+		if (!zcache.raw)
+			zcache.raw = malloc(Z_EROFS_READAHEAD);
+		if (zcache.raw) {
+			start = end > Z_EROFS_READAHEAD ?
+				end - Z_EROFS_READAHEAD : 0;
+			ret = erofs_dev_read(0, zcache.raw, start, end - start);
+			if (!ret) {
+				zcache.raw_start = start;
+				zcache.raw_len = end - start;
+				return zcache.raw + (pa - start);
+			}
+			zcache.raw_len = 0;
+		}
+	}
+
+	ret = erofs_dev_read(0, raw, pa, plen);
+	if (ret < 0)
+		return ERR_PTR(ret);
+
+	return raw;
+}
+
 int z_erofs_read_one_data(struct erofs_inode *inode,
 			  struct erofs_map_blocks *map, char *raw, char *buffer,
 			  erofs_off_t skip, erofs_off_t length, bool trimmed)
 {
 	struct erofs_map_dev mdev;
+	char *in;
 	int ret = 0;
 
 	if (map->m_flags & EROFS_MAP_FRAGMENT) {
@@ -248,12 +320,49 @@ int z_erofs_read_one_data(struct erofs_inode *inode,
 		return ret;
 	}
 
-	ret = erofs_dev_read(mdev.m_deviceid, raw, mdev.m_pa, map->m_plen);
-	if (ret < 0)
-		return ret;
+	in = z_erofs_read_raw(raw, mdev.m_pa, map->m_plen);
+	if (IS_ERR(in))
+		return PTR_ERR(in);
+
+	/*
+	 * If only part of the cluster is wanted, it is likely that the rest
+	 * is wanted next, so decompress all of it once and keep it.
+	 */
+	if (IS_ENABLED(CONFIG_FS_EROFS_ZIP_CACHE) && (skip || trimmed)) {
+		if (!zcache.out_len || zcache.out_pa != map->m_pa ||
+		    zcache.out_la != map->m_la || zcache.out_len != map->m_llen) {
+			free(zcache.out);
+			zcache.out_len = 0;
+			zcache.out = malloc(map->m_llen);
+			if (!zcache.out)
+				goto direct;
+			ret = z_erofs_decompress(&(struct z_erofs_decompress_req) {
+					.in = in,
+					.out = zcache.out,
+					.decodedskip = 0,
+					.interlaced_offset =
+						map->m_algorithmformat == Z_EROFS_COMPRESSION_INTERLACED ?
+							erofs_blkoff(map->m_la) : 0,
+					.inputsize = map->m_plen,
+					.decodedlength = map->m_llen,
+					.alg = map->m_algorithmformat,
+					.partial_decoding =
+						!(map->m_flags & EROFS_MAP_FULL_MAPPED) ||
+						(map->m_flags & EROFS_MAP_PARTIAL_REF),
+					 });
+			if (ret < 0)
+				return ret;
+			zcache.out_pa = map->m_pa;
+			zcache.out_la = map->m_la;
+			zcache.out_len = map->m_llen;
+		}
+		memcpy(buffer, zcache.out + skip, length - skip);
+		return 0;
+	}
 
+direct:
 	ret = z_erofs_decompress(&(struct z_erofs_decompress_req) {
-			.in = raw,
+			.in = in,
 			.out = buffer,
 			.decodedskip = skip,
 			.interlaced_offset =
@@ -11,12 +11,25 @@ static struct erofs_ctxt {
 
 int erofs_dev_read(int device_id, void *buf, u64 offset, size_t len)
 {
-	lbaint_t sect = offset >> ctxt.cur_dev->log2blksz;
-	int off = offset & (ctxt.cur_dev->blksz - 1);
+	lbaint_t sect, nr;
+	void *src;
+	int off;
 
 	if (!ctxt.cur_dev)
 		return -EIO;
 
+	sect = offset >> ctxt.cur_dev->log2blksz;
+	off = offset & (ctxt.cur_dev->blksz - 1);
+
+	/* An image held in memory is copied directly, without block reads */
+	nr = DIV_ROUND_UP(off + len, ctxt.cur_dev->blksz);
+	if (sect + nr <= ctxt.cur_part_info.size &&
+	    !blk_dmap(ctxt.cur_dev, ctxt.cur_part_info.start + sect, nr,
+		      &src)) {
+		memcpy(buf, src + off, len);
+		return 0;
+	}
+
 	if (fs_devread(ctxt.cur_dev, &ctxt.cur_part_info, sect,
 		       off, len, buf))
 		return 0;
@@ -255,6 +268,7 @@ int erofs_read(const char *filename, void *buf, loff_t offset, loff_t len,
 
 void erofs_close(void)
 {
+	z_erofs_cache_drop();
 	ctxt.cur_dev = NULL;
 }
 
@@ -21,6 +21,7 @@
 #include <blk.h>
 #include <ext_common.h>
 #include <ext4fs.h>
+#include <fs_dcache.h>
 #include <log.h>
 #include <malloc.h>
 #include <memalign.h>
@@ -29,6 +30,7 @@
 #include <linux/stat.h>
 #include <linux/time.h>
 #include <asm/byteorder.h>
+#include <u-boot/crc.h>
 #include "ext4_common.h"
 
 struct ext2_data *ext4fs_root;
@@ -321,7 +323,6 @@ int ext4fs_set_block_bmap(long int blockno, unsigned char *buffer, int index)
 			return -1;
 
 		*ptr = *ptr | operand;
-		return 0;
 	} else {
 		if (remainder == 0) {
 			ptr = ptr + i - 1;
@@ -335,8 +336,10 @@ int ext4fs_set_block_bmap(long int blockno, unsigned char *buffer, int index)
 			return -1;
 
 		*ptr = *ptr | operand;
-		return 0;
 	}
+	get_fs()->bmaps_dirty[index] |= EXT4_BMAP_BLOCK_DIRTY;
+
+	return 0;
 }
 
 void ext4fs_reset_block_bmap(long int blockno, unsigned char *buffer, int index)
@@ -367,6 +370,7 @@ void ext4fs_reset_block_bmap(long int blockno, unsigned char *buffer, int index)
 		if (status)
 			*ptr = *ptr & ~(operand);
 	}
+	get_fs()->bmaps_dirty[index] |= EXT4_BMAP_BLOCK_DIRTY;
 }
 
 int ext4fs_set_inode_bmap(int inode_no, unsigned char *buffer, int index)
@@ -390,6 +394,7 @@ int ext4fs_set_inode_bmap(int inode_no, unsigned char *buffer, int index)
 		return -1;
 
 	*ptr = *ptr | operand;
+	get_fs()->bmaps_dirty[index] |= EXT4_BMAP_INODE_DIRTY;
 
 	return 0;
 }
@@ -413,6 +418,7 @@ void ext4fs_reset_inode_bmap(int inode_no, unsigned char *buffer, int index)
 	status = *ptr & operand;
 	if (status)
 		*ptr = *ptr & ~(operand);
+	get_fs()->bmaps_dirty[index] |= EXT4_BMAP_INODE_DIRTY;
 }
 
 uint16_t ext4fs_checksum_update(uint32_t i)
@@ -957,19 +963,35 @@ int ext4fs_filename_unlink(char *filename)
 	return -1;
 }
 
+/*
+ * Add the on-disk copy of a bitmap block to the journal. This is only
+ * needed once per block group, so callers avoid it for each block.
+ */
+static int ext4fs_log_bitmap(uint64_t blknr)
+{
+	struct ext_filesystem *fs = get_fs();
+	char *journal_buffer;
+	int ret = -1;
+
+	journal_buffer = zalloc(fs->blksz);
+	if (!journal_buffer)
+		return -1;
+	if (ext4fs_devread(blknr * fs->sect_perblk, 0, fs->blksz,
+			   journal_buffer))
+		ret = ext4fs_log_journal(journal_buffer, blknr);
+	free(journal_buffer);
+
+	return ret;
+}
+
 uint32_t ext4fs_get_new_blk_no(void)
 {
 	short i;
-	short status;
 	int remainder;
 	unsigned int bg_idx;
 	static int prev_bg_bitmap_index = -1;
 	unsigned int blk_per_grp = le32_to_cpu(ext4fs_root->sblock.blocks_per_group);
 	struct ext_filesystem *fs = get_fs();
-	char *journal_buffer = zalloc(fs->blksz);
-	char *zero_buffer = zalloc(fs->blksz);
-	if (!journal_buffer || !zero_buffer)
-		goto fail;
 
 	if (fs->first_pass_bbmap == 0) {
 		for (i = 0; i < fs->no_blkgrp; i++) {
@@ -980,7 +1002,7 @@ uint32_t ext4fs_get_new_blk_no(void)
 				uint64_t b_bitmap_blk =
 					ext4fs_bg_get_block_id(bgd, fs);
 				if (bg_flags & EXT4_BG_BLOCK_UNINIT) {
-					memcpy(fs->blk_bmaps[i], zero_buffer,
+					memset(fs->blk_bmaps[i], '\0',
 					       fs->blksz);
 					put_ext4(b_bitmap_blk * fs->blksz,
 						 fs->blk_bmaps[i], fs->blksz);
@@ -995,95 +1017,78 @@ uint32_t ext4fs_get_new_blk_no(void)
 				fs->curr_blkno = fs->curr_blkno +
 						(i * fs->blksz * 8);
 				fs->first_pass_bbmap++;
+				fs->bmaps_dirty[i] |= EXT4_BMAP_BLOCK_DIRTY;
 				ext4fs_bg_free_blocks_dec(bgd, fs);
 				ext4fs_sb_free_blocks_dec(fs->sb);
-				status = ext4fs_devread(b_bitmap_blk *
-							fs->sect_perblk,
-							0, fs->blksz,
-							journal_buffer);
-				if (status == 0)
-					goto fail;
-				if (ext4fs_log_journal(journal_buffer,
-						       b_bitmap_blk))
-					goto fail;
-				goto success;
+				if (ext4fs_log_bitmap(b_bitmap_blk))
+					return -1;
+				/* a new transaction has started */
+				prev_bg_bitmap_index = i;
+
+				return fs->curr_blkno;
 			} else {
 				debug("no space left on block group %d\n", i);
 			}
 		}
 
-		goto fail;
-	} else {
-		fs->curr_blkno++;
-restart:
-		/* get the blockbitmap index respective to blockno */
-		bg_idx = fs->curr_blkno / blk_per_grp;
-		if (fs->blksz == 1024) {
-			remainder = fs->curr_blkno % blk_per_grp;
-			if (!remainder)
-				bg_idx--;
-		}
+		return -1;
+	}
 
-		/*
-		 * To skip completely filled block group bitmaps
-		 * Optimize the block allocation
-		 */
-		if (bg_idx >= fs->no_blkgrp)
-			goto fail;
+	fs->curr_blkno++;
+restart:
+	/* get the blockbitmap index respective to blockno */
+	bg_idx = fs->curr_blkno / blk_per_grp;
+	if (fs->blksz == 1024) {
+		remainder = fs->curr_blkno % blk_per_grp;
+		if (!remainder)
+			bg_idx--;
+	}
 
-		struct ext2_block_group *bgd = NULL;
-		bgd = ext4fs_get_group_descriptor(fs, bg_idx);
-		if (ext4fs_bg_get_free_blocks(bgd, fs) == 0) {
-			debug("block group %u is full. Skipping\n", bg_idx);
-			fs->curr_blkno = (bg_idx + 1) * blk_per_grp;
-			if (fs->blksz == 1024)
-				fs->curr_blkno += 1;
-			goto restart;
-		}
+	/*
+	 * To skip completely filled block group bitmaps
+	 * Optimize the block allocation
+	 */
+	if (bg_idx >= fs->no_blkgrp)
+		return -1;
 
-		uint16_t bg_flags = ext4fs_bg_get_flags(bgd);
-		uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
-		if (bg_flags & EXT4_BG_BLOCK_UNINIT) {
-			memcpy(fs->blk_bmaps[bg_idx], zero_buffer, fs->blksz);
-			put_ext4(b_bitmap_blk * fs->blksz,
-				 zero_buffer, fs->blksz);
-			bg_flags &= ~EXT4_BG_BLOCK_UNINIT;
-			ext4fs_bg_set_flags(bgd, bg_flags);
-		}
+	struct ext2_block_group *bgd = NULL;
+	bgd = ext4fs_get_group_descriptor(fs, bg_idx);
+	if (ext4fs_bg_get_free_blocks(bgd, fs) == 0) {
+		debug("block group %u is full. Skipping\n", bg_idx);
+		fs->curr_blkno = (bg_idx + 1) * blk_per_grp;
+		if (fs->blksz == 1024)
+			fs->curr_blkno += 1;
+		goto restart;
+	}
 
-		if (ext4fs_set_block_bmap(fs->curr_blkno, fs->blk_bmaps[bg_idx],
-				   bg_idx) != 0) {
-			debug("going for restart for the block no %ld %u\n",
-			      fs->curr_blkno, bg_idx);
-			fs->curr_blkno++;
-			goto restart;
-		}
+	uint16_t bg_flags = ext4fs_bg_get_flags(bgd);
+	uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
+	if (bg_flags & EXT4_BG_BLOCK_UNINIT) {
+		memset(fs->blk_bmaps[bg_idx], '\0', fs->blksz);
+		put_ext4(b_bitmap_blk * fs->blksz,
+			 fs->blk_bmaps[bg_idx], fs->blksz);
+		bg_flags &= ~EXT4_BG_BLOCK_UNINIT;
+		ext4fs_bg_set_flags(bgd, bg_flags);
+	}
 
-		/* journal backup */
-		if (prev_bg_bitmap_index != bg_idx) {
-			status = ext4fs_devread(b_bitmap_blk * fs->sect_perblk,
-						0, fs->blksz, journal_buffer);
-			if (status == 0)
-				goto fail;
-			if (ext4fs_log_journal(journal_buffer, b_bitmap_blk))
-				goto fail;
+	if (ext4fs_set_block_bmap(fs->curr_blkno, fs->blk_bmaps[bg_idx],
+			   bg_idx) != 0) {
+		debug("going for restart for the block no %ld %u\n",
+		      fs->curr_blkno, bg_idx);
+		fs->curr_blkno++;
+		goto restart;
+	}
 
-			prev_bg_bitmap_index = bg_idx;
-		}
-		ext4fs_bg_free_blocks_dec(bgd, fs);
-		ext4fs_sb_free_blocks_dec(fs->sb);
-		goto success;
+	/* journal backup */
+	if (prev_bg_bitmap_index != bg_idx) {
+		if (ext4fs_log_bitmap(b_bitmap_blk))
+			return -1;
+		prev_bg_bitmap_index = bg_idx;
 	}
-success:
-	free(journal_buffer);
-	free(zero_buffer);
+	ext4fs_bg_free_blocks_dec(bgd, fs);
+	ext4fs_sb_free_blocks_dec(fs->sb);
 
 	return fs->curr_blkno;
-fail:
-	free(journal_buffer);
-	free(zero_buffer);
-
-	return -1;
 }
 
 int ext4fs_get_new_inode_no(void)
@@ -1129,6 +1134,7 @@ int ext4fs_get_new_inode_no(void)
 				fs->curr_inode_no = fs->curr_inode_no +
 							(i * inodes_per_grp);
 				fs->first_pass_ibmap++;
+				fs->bmaps_dirty[i] |= EXT4_BMAP_INODE_DIRTY;
 				ext4fs_bg_free_inodes_dec(bgd, fs);
 				if (has_gdt_chksum)
 					ext4fs_bg_itable_unused_dec(bgd, fs);
@@ -1523,14 +1529,20 @@ void ext4fs_allocate_blocks(struct ext2_inode *file_inode,
 
 #endif
 
+/*
+ * Walk the extent tree down to the leaf covering 'fileblock'. Index blocks
+ * are kept in 'cache', one entry per tree level for the first 'levels'
+ * levels, so that consecutive lookups do not re-read the upper levels.
+ */
 static struct ext4_extent_header *ext4fs_get_extent_block
-	(struct ext2_data *data, struct ext_block_cache *cache,
+	(struct ext2_data *data, struct ext_block_cache *cache, int levels,
 		struct ext4_extent_header *ext_block,
 		uint32_t fileblock, int log2_blksz)
 {
 	struct ext4_extent_idx *index;
 	unsigned long long block;
 	int blksz = EXT2_BLOCK_SIZE(data);
+	int level = -1;
 	int i;
 
 	while (1) {
@@ -1558,9 +1570,11 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 		block = le16_to_cpu(index[i].ei_leaf_hi);
 		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
 		block <<= log2_blksz;
-		if (!ext_cache_read(cache, (lbaint_t)block, blksz))
+		if (level < levels - 1)
+			level++;
+		if (!ext_cache_read(&cache[level], (lbaint_t)block, blksz))
 			return NULL;
-		ext_block = (struct ext4_extent_header *)cache->buf;
+		ext_block = (struct ext4_extent_header *)cache[level].buf;
 	}
 }
 
@@ -1670,7 +1684,7 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock,
 			ext_cache_init(c);
 		}
 		ext_block =
-			ext4fs_get_extent_block(ext4fs_root, c,
+			ext4fs_get_extent_block(ext4fs_root, c, 1,
 						(struct ext4_extent_header *)
 						inode->b.blocks.dir_blocks,
 						fileblock, log2_blksz);
@@ -1993,6 +2007,56 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock,
 	return blknr;
 }
 
+long int ext4fs_map_blocks(struct ext2_inode *inode, int fileblock,
+			   struct ext_block_cache *cache, int *count)
+{
+	struct ext4_extent_header *ext_block;
+	struct ext4_extent *extent;
+	long int startblock, endblock;
+	unsigned long long start;
+	int log2_blksz;
+	int i;
+
+	if (!(le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL)) {
+		*count = 1;
+		return read_allocated_block(inode, fileblock, cache);
+	}
+
+	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root) -
+		get_fs()->dev_desc->log2blksz;
+	ext_block = ext4fs_get_extent_block(ext4fs_root, cache,
+					    EXT4_EXT_CACHE_LEVELS,
+					    (struct ext4_extent_header *)
+					    inode->b.blocks.dir_blocks,
+					    fileblock, log2_blksz);
+	if (!ext_block) {
+		printf("invalid extent block\n");
+		return -EINVAL;
+	}
+
+	/* Beyond the last extent of the leaf: one block of hole at a time */
+	*count = 1;
+	extent = (struct ext4_extent *)(ext_block + 1);
+	for (i = 0; i < le16_to_cpu(ext_block->eh_entries); i++) {
+		startblock = le32_to_cpu(extent[i].ee_block);
+		endblock = startblock + le16_to_cpu(extent[i].ee_len);
+
+		if (startblock > fileblock) {
+			/* Sparse file */
+			*count = startblock - fileblock;
+			return 0;
+		} else if (fileblock < endblock) {
+			start = le16_to_cpu(extent[i].ee_start_hi);
+			start = (start << 32) +
+				le32_to_cpu(extent[i].ee_start_lo);
+			*count = endblock - fileblock;
+			return (fileblock - startblock) + start;
+		}
+	}
+
+	return 0;
+}
+
 /**
  * ext4fs_reinit_global() - Reinitialize values of ext4 write implementation's
  *			    global pointers
@@ -2040,17 +2104,60 @@ void ext4fs_close(void)
 	ext4fs_reinit_global();
 }
 
+/**
+ * struct ext4fs_dcache_data - what is kept in the dentry cache for a name
+ *
+ * @ino: Inode number of the entry
+ * @type: FILETYPE_... of the entry
+ */
+struct ext4fs_dcache_data {
+	u32 ino;
+	int type;
+};
+
+/* Build the node for a name found in the dentry cache */
+static int ext4fs_dcache_node(struct ext2fs_node *dir,
+			      struct fs_dcache_ent *ent,
+			      struct ext2fs_node **fnode, int *ftype)
+{
+	struct ext4fs_dcache_data *res = (struct ext4fs_dcache_data *)ent->data;
+	struct ext2fs_node *fdiro;
+
+	if (!ent->found)
+		return 0;
+
+	fdiro = zalloc(sizeof(struct ext2fs_node));
+	if (!fdiro)
+		return 0;
+
+	fdiro->data = dir->data;
+	fdiro->ino = res->ino;
+	fdiro->inode_read = 0;
+	*ftype = res->type;
+	*fnode = fdiro;
+
+	return 1;
+}
+
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 				struct ext2fs_node **fnode, int *ftype)
 {
 	unsigned int fpos = 0;
 	int status;
 	loff_t actread;
+	bool lookup = name && fnode && ftype;
 
 #ifdef DEBUG
 	if (name != NULL)
 		printf("Iterate dir %s\n", name);
 #endif /* of DEBUG */
+	if (lookup) {
+		struct fs_dcache_ent *ent;
+
+		ent = fs_dcache_find(dir->ino, name, strlen(name), false);
+		if (ent)
+			return ext4fs_dcache_node(dir, ent, fnode, ftype);
+	}
 	if (!dir->inode_read) {
 		status = ext4fs_read_inode(dir->data, dir->ino, &dir->inode);
 		if (status == 0)
@@ -2130,9 +2237,16 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 #ifdef DEBUG
 			printf("iterate >%s<\n", filename);
 #endif /* of DEBUG */
-			if ((name != NULL) && (fnode != NULL)
-			    && (ftype != NULL)) {
+			if (lookup) {
 				if (strcmp(filename, name) == 0) {
+					struct ext4fs_dcache_data res = {
+						.ino = fdiro->ino,
+						.type = type,
+					};
+
+					fs_dcache_add(dir->ino, name,
+						      strlen(name), true,
+						      &res, sizeof(res));
 					*ftype = type;
 					*fnode = fdiro;
 					return 1;
@@ -2142,6 +2256,9 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 		}
 		fpos += le16_to_cpu(dirent.direntlen);
 	}
+	if (lookup)
+		fs_dcache_add(dir->ino, name, strlen(name), false, NULL, 0);
+
 	return 0;
 }
 
@@ -2387,6 +2504,11 @@ int ext4fs_mount(void)
 	      le32_to_cpu(data->sblock.revision_level),
 	      fs->inodesz, fs->gdsize);
 
+	if (CONFIG_IS_ENABLED(FS_DCACHE))
+		fs_dcache_bind(fs->dev_desc, part_offset,
+			       crc32(0, (u8 *)&data->sblock,
+				     sizeof(data->sblock)));
+
 	data->diropen.data = data;
 	data->diropen.ino = 2;
 	data->diropen.inode_read = 1;
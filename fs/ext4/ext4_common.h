@@ -59,6 +59,10 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			struct ext2fs_node **fnode, int *ftype);
 
 #if defined(CONFIG_EXT4_WRITE)
+/* Flags in ext_filesystem.bmaps_dirty */
+#define EXT4_BMAP_BLOCK_DIRTY	BIT(0)
+#define EXT4_BMAP_INODE_DIRTY	BIT(1)
+
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n);
 uint16_t ext4fs_checksum_update(unsigned int i);
 int ext4fs_get_parent_inode_num(const char *dirname, char *dname, int flags);
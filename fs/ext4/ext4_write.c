@@ -76,21 +76,23 @@ static void ext4fs_update(void)
 	put_ext4((uint64_t)(SUPERBLOCK_SIZE),
 		 (struct ext2_sblock *)fs->sb, (uint32_t)SUPERBLOCK_SIZE);
 
-	/* update block bitmaps */
+	/* update the bitmaps which changed */
 	for (i = 0; i < fs->no_blkgrp; i++) {
 		bgd = ext4fs_get_group_descriptor(fs, i);
 		bgd->bg_checksum = cpu_to_le16(ext4fs_checksum_update(i));
-		uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
-		put_ext4(b_bitmap_blk * fs->blksz,
-			 fs->blk_bmaps[i], fs->blksz);
-	}
+		if (fs->bmaps_dirty[i] & EXT4_BMAP_BLOCK_DIRTY) {
+			uint64_t b_bitmap_blk = ext4fs_bg_get_block_id(bgd, fs);
 
-	/* update inode bitmaps */
-	for (i = 0; i < fs->no_blkgrp; i++) {
-		bgd = ext4fs_get_group_descriptor(fs, i);
-		uint64_t i_bitmap_blk = ext4fs_bg_get_inode_id(bgd, fs);
-		put_ext4(i_bitmap_blk * fs->blksz,
-			 fs->inode_bmaps[i], fs->blksz);
+			put_ext4(b_bitmap_blk * fs->blksz,
+				 fs->blk_bmaps[i], fs->blksz);
+		}
+		if (fs->bmaps_dirty[i] & EXT4_BMAP_INODE_DIRTY) {
+			uint64_t i_bitmap_blk = ext4fs_bg_get_inode_id(bgd, fs);
+
+			put_ext4(i_bitmap_blk * fs->blksz,
+				 fs->inode_bmaps[i], fs->blksz);
+		}
+		fs->bmaps_dirty[i] = 0;
 	}
 
 	/* update the block group descriptor table */
@@ -628,6 +630,10 @@ int ext4fs_init(void)
 		goto fail;
 	}
 
+	fs->bmaps_dirty = zalloc(fs->no_blkgrp);
+	if (!fs->bmaps_dirty)
+		goto fail;
+
 	/* load all the available bitmap block of the partition */
 	fs->blk_bmaps = zalloc(fs->no_blkgrp * sizeof(char *));
 	if (!fs->blk_bmaps)
@@ -745,6 +751,8 @@ void ext4fs_deinit(void)
 		fs->inode_bmaps = NULL;
 	}
 
+	free(fs->bmaps_dirty);
+	fs->bmaps_dirty = NULL;
 	free(fs->gdtable);
 	fs->gdtable = NULL;
 	/*
@@ -66,139 +66,111 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot)
  * Taken from openmoko-kernel mailing list: By Andy green
  * Optimized read file API : collects and defers contiguous sector
  * reads into one potentially more efficient larger sequential read action
+ *
+ * Files are mapped an extent at a time, so a file made of a few large
+ * extents is read with a few large requests.
  */
 int ext4fs_read_file(struct ext2fs_node *node, loff_t pos,
 		loff_t len, char *buf, loff_t *actread)
 {
 	struct ext_filesystem *fs = get_fs();
-	int i;
-	lbaint_t blockcnt;
+	lbaint_t i, first, blockcnt;
 	int log2blksz = fs->dev_desc->log2blksz;
 	int log2_fs_blocksize = LOG2_BLOCK_SIZE(node->data) - log2blksz;
 	int blocksize = (1 << (log2_fs_blocksize + log2blksz));
 	unsigned int filesize = le32_to_cpu(node->inode.size);
-	lbaint_t previous_block_number = -1;
 	lbaint_t delayed_start = 0;
-	lbaint_t delayed_extent = 0;
-	lbaint_t delayed_skipfirst = 0;
 	lbaint_t delayed_next = 0;
+	loff_t delayed_extent = 0;
+	int delayed_skipfirst = 0;
 	char *delayed_buf = NULL;
-	char *start_buf = buf;
-	short status;
-	struct ext_block_cache cache;
+	bool delayed = false;
+	struct ext_block_cache cache[EXT4_EXT_CACHE_LEVELS];
+	int ret = -1;
+	int n;
 
-	ext_cache_init(&cache);
+	for (n = 0; n < EXT4_EXT_CACHE_LEVELS; n++)
+		ext_cache_init(&cache[n]);
 
 	/* Adjust len so it we can't read past the end of the file. */
 	if (len + pos > filesize)
 		len = (filesize - pos);
 
-	if (blocksize <= 0 || len <= 0) {
-		ext_cache_fini(&cache);
-		return -1;
-	}
+	if (blocksize <= 0 || len <= 0)
+		goto out;
 
+	first = lldiv(pos, blocksize);
 	blockcnt = lldiv(((len + pos) + blocksize - 1), blocksize);
 
-	for (i = lldiv(pos, blocksize); i < blockcnt; i++) {
+	for (i = first; i < blockcnt; i += n) {
 		long int blknr;
-		int blockoff = pos - (blocksize * i);
-		int blockend = blocksize;
-		int skipfirst = 0;
-		blknr = read_allocated_block(&node->inode, i, &cache);
-		if (blknr < 0) {
-			ext_cache_fini(&cache);
-			return -1;
-		}
+		loff_t from, to, bytes;
 
-		blknr = blknr << log2_fs_blocksize;
-
-		/* Last block.  */
-		if (i == blockcnt - 1) {
-			blockend = (len + pos) - (blocksize * i);
+		blknr = ext4fs_map_blocks(&node->inode, i, cache, &n);
+		if (blknr < 0)
+			goto out;
+		if (n > blockcnt - i)
+			n = blockcnt - i;
+		/* ext4fs_devread() takes an int length */
+		if (n > INT_MAX / blocksize)
+			n = INT_MAX / blocksize;
 
-			/* The last portion is exactly blocksize. */
-			if (!blockend)
-				blockend = blocksize;
-		}
+		/* Bytes of the file covered by this run */
+		from = max((loff_t)i * blocksize, pos);
+		to = min((loff_t)(i + n) * blocksize, len + pos);
+		bytes = to - from;
 
-		/* First block. */
-		if (i == lldiv(pos, blocksize)) {
-			skipfirst = blockoff;
-			blockend -= skipfirst;
-		}
 		if (blknr) {
-			int status;
-
-			if (previous_block_number != -1) {
-				if (delayed_next == blknr) {
-					delayed_extent += blockend;
-					delayed_next += blockend >> log2blksz;
-				} else {	/* spill */
-					status = ext4fs_devread(delayed_start,
-							delayed_skipfirst,
-							delayed_extent,
-							delayed_buf);
-					if (status == 0) {
-						ext_cache_fini(&cache);
-						return -1;
-					}
-					previous_block_number = blknr;
-					delayed_start = blknr;
-					delayed_extent = blockend;
-					delayed_skipfirst = skipfirst;
-					delayed_buf = buf;
-					delayed_next = blknr +
-						(blockend >> log2blksz);
-				}
+			lbaint_t sect = (lbaint_t)blknr << log2_fs_blocksize;
+
+			if (delayed && delayed_next == sect &&
+			    delayed_extent + bytes <= INT_MAX) {
+				delayed_extent += bytes;
+				delayed_next += bytes >> log2blksz;
 			} else {
-				previous_block_number = blknr;
-				delayed_start = blknr;
-				delayed_extent = blockend;
-				delayed_skipfirst = skipfirst;
+				/* spill */
+				if (delayed &&
+				    !ext4fs_devread(delayed_start,
+						    delayed_skipfirst,
+						    delayed_extent,
+						    delayed_buf))
+					goto out;
+				delayed = true;
+				delayed_start = sect;
+				delayed_extent = bytes;
+				delayed_skipfirst = from - (loff_t)i * blocksize;
 				delayed_buf = buf;
-				delayed_next = blknr +
-					(blockend >> log2blksz);
+				delayed_next = sect + ((delayed_skipfirst +
+							bytes) >> log2blksz);
 			}
 		} else {
-			int n;
-			int n_left;
-			if (previous_block_number != -1) {
+			if (delayed) {
 				/* spill */
-				status = ext4fs_devread(delayed_start,
-							delayed_skipfirst,
-							delayed_extent,
-							delayed_buf);
-				if (status == 0) {
-					ext_cache_fini(&cache);
-					return -1;
-				}
-				previous_block_number = -1;
+				if (!ext4fs_devread(delayed_start,
+						    delayed_skipfirst,
+						    delayed_extent,
+						    delayed_buf))
+					goto out;
+				delayed = false;
 			}
-			/* Zero no more than `len' bytes. */
-			n = blocksize - skipfirst;
-			n_left = len - ( buf - start_buf );
-			if (n > n_left)
-				n = n_left;
-			memset(buf, 0, n);
+			memset(buf, 0, bytes);
 		}
-		buf += blocksize - skipfirst;
+		buf += bytes;
 	}
-	if (previous_block_number != -1) {
+	if (delayed) {
 		/* spill */
-		status = ext4fs_devread(delayed_start,
-					delayed_skipfirst, delayed_extent,
-					delayed_buf);
-		if (status == 0) {
-			ext_cache_fini(&cache);
-			return -1;
-		}
-		previous_block_number = -1;
+		if (!ext4fs_devread(delayed_start, delayed_skipfirst,
+				    delayed_extent, delayed_buf))
+			goto out;
 	}
 
 	*actread  = len;
-	ext_cache_fini(&cache);
-	return 0;
+	ret = 0;
+out:
+	for (n = 0; n < EXT4_EXT_CACHE_LEVELS; n++)
+		ext_cache_fini(&cache[n]);
+
+	return ret;
 }
 
 int ext4fs_opendir(const char *dirname, struct fs_dir_stream **dirsp)
@@ -15,6 +15,7 @@
 #include <exports.h>
 #include <fat.h>
 #include <fs.h>
+#include <fs_dcache.h>
 #include <log.h>
 #include <asm/byteorder.h>
 #include <asm/unaligned.h>
@@ -25,6 +26,7 @@
 #include <linux/compiler.h>
 #include <linux/ctype.h>
 #include <linux/log2.h>
+#include <u-boot/crc.h>
 
 /* maximum number of clusters for FAT12 */
 #define MAX_FAT12	0xFF4
@@ -84,10 +86,13 @@ int fat_set_blk_dev(struct blk_desc *dev_desc, struct disk_partition *info)
 	}
 
 	/* Check for FAT12/FAT16/FAT32 filesystem */
-	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3))
-		return 0;
-	if (!memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5))
+	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3) ||
+	    !memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5)) {
+		if (CONFIG_IS_ENABLED(FS_DCACHE))
+			fs_dcache_bind(dev_desc, info->start,
+				       crc32(0, buffer, dev_desc->blksz));
 		return 0;
+	}
 
 	cur_dev = NULL;
 	return -1;
@@ -151,6 +156,7 @@ static void get_name(dir_entry *dirent, char *s_name)
 }
 
 static int flush_dirty_fat_buffer(fsdata *mydata);
+static int fat_write_window(fsdata *mydata, int bufnum, __u8 *buf);
 
 #if !CONFIG_IS_ENABLED(FAT_WRITE)
 /* Stub for read only operation */
@@ -159,8 +165,117 @@ int flush_dirty_fat_buffer(fsdata *mydata)
 	(void)(mydata);
 	return 0;
 }
+
+static int fat_write_window(fsdata *mydata, int bufnum, __u8 *buf)
+{
+	return 0;
+}
 #endif
 
+/*
+ * Reset the FAT window cache, e.g. after (re)allocating fatbuf.
+ */
+static void fat_cache_init(fsdata *mydata)
+{
+	int i;
+
+	mydata->fatbufnum = -1;
+	mydata->fat_dirty = 0;
+	mydata->fatcache_next = 0;
+	mydata->fatcache_dirty = 0;
+	for (i = 0; i < FAT_CACHE_WINDOWS; i++)
+		mydata->fatcachenum[i] = -1;
+}
+
+/*
+ * Return the cache slot holding FAT window 'bufnum', or -1 if there is none.
+ */
+static int fat_cache_find(fsdata *mydata, int bufnum)
+{
+	int i;
+
+	for (i = 0; i < FAT_CACHE_WINDOWS; i++) {
+		if (mydata->fatcachenum[i] == bufnum)
+			return i;
+	}
+
+	return -1;
+}
+
+static __u8 *fat_cache_slot(fsdata *mydata, int slot)
+{
+	return mydata->fatbuf + (slot + 1) * FATBUFSIZE;
+}
+
+/*
+ * Make FAT window 'bufnum' the current one in mydata->fatbuf.
+ *
+ * The previous window is parked in one of FAT_CACHE_WINDOWS slots behind
+ * fatbuf, so that a cluster chain hopping between distant parts of the
+ * table does not keep re-reading the same sectors. A dirty window stays
+ * dirty in its slot and is only written back when it is evicted or by
+ * flush_dirty_fat_buffer(), so that allocating clusters does not write the
+ * same FAT sectors over and over. fatbuf is always authoritative for the
+ * current window. Without a cache, a dirty window is written back at once.
+ *
+ * Return 0 on success, -1 otherwise.
+ */
+static int fat_load_window(fsdata *mydata, __u32 bufnum)
+{
+	__u32 getsize = FATBUFBLOCKS;
+	__u32 fatlength = mydata->fatlength;
+	__u32 startblock = bufnum * FATBUFBLOCKS;
+	int slot;
+
+	if (FAT_CACHE_WINDOWS && mydata->fatbufnum != -1) {
+		slot = fat_cache_find(mydata, mydata->fatbufnum);
+		if (slot < 0) {
+			slot = mydata->fatcache_next;
+			if (++mydata->fatcache_next == FAT_CACHE_WINDOWS)
+				mydata->fatcache_next = 0;
+
+			/* Write back the window being evicted */
+			if ((mydata->fatcache_dirty & BIT(slot)) &&
+			    fat_write_window(mydata, mydata->fatcachenum[slot],
+					     fat_cache_slot(mydata, slot)) < 0)
+				return -1;
+			mydata->fatcache_dirty &= ~BIT(slot);
+		}
+		memcpy(fat_cache_slot(mydata, slot), mydata->fatbuf,
+		       FATBUFSIZE);
+		mydata->fatcachenum[slot] = mydata->fatbufnum;
+		if (mydata->fat_dirty)
+			mydata->fatcache_dirty |= BIT(slot);
+		mydata->fat_dirty = 0;
+	} else if (flush_dirty_fat_buffer(mydata) < 0) {
+		/* Write back the fatbuf to the disk */
+		return -1;
+	}
+
+	slot = fat_cache_find(mydata, bufnum);
+	if (slot >= 0) {
+		memcpy(mydata->fatbuf, fat_cache_slot(mydata, slot),
+		       FATBUFSIZE);
+		mydata->fatbufnum = bufnum;
+		return 0;
+	}
+
+	/* Cap length if fatlength is not a multiple of FATBUFBLOCKS */
+	if (startblock + getsize > fatlength)
+		getsize = fatlength - startblock;
+
+	startblock += mydata->fat_sect;	/* Offset from start of disk */
+
+	if (disk_read(startblock, getsize, mydata->fatbuf) < 0) {
+		debug("Error reading FAT blocks\n");
+		mydata->fatbufnum = -1;
+		return -1;
+	}
+	mydata->fatbufnum = bufnum;
+
+	return 0;
+}
+
 /*
  * Get the entry at index 'entry' in a FAT (12/16/32) table.
  * On failure 0x00 is returned.
@@ -199,28 +314,8 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 	       mydata->fatsize, entry, entry, offset, offset);
 
 	/* Read a new block of FAT entries into the cache. */
-	if (bufnum != mydata->fatbufnum) {
-		__u32 getsize = FATBUFBLOCKS;
-		__u8 *bufptr = mydata->fatbuf;
-		__u32 fatlength = mydata->fatlength;
-		__u32 startblock = bufnum * FATBUFBLOCKS;
-
-		/* Cap length if fatlength is not a multiple of FATBUFBLOCKS */
-		if (startblock + getsize > fatlength)
-			getsize = fatlength - startblock;
-
-		startblock += mydata->fat_sect;	/* Offset from start of disk */
-
-		/* Write back the fatbuf to the disk */
-		if (flush_dirty_fat_buffer(mydata) < 0)
-			return -1;
-
-		if (disk_read(startblock, getsize, bufptr) < 0) {
-			debug("Error reading FAT blocks\n");
-			return ret;
-		}
-		mydata->fatbufnum = bufnum;
-	}
+	if (bufnum != mydata->fatbufnum && fat_load_window(mydata, bufnum) < 0)
+		return ret;
 
 	/* Get the actual entry from the table */
 	switch (mydata->fatsize) {
@@ -683,9 +778,8 @@ static int get_fs_info(fsdata *mydata)
 		mydata->root_cluster = 0;
 	}
 
-	mydata->fatbufnum = -1;
-	mydata->fat_dirty = 0;
-	mydata->fatbuf = malloc_cache_aligned(FATBUFSIZE);
+	fat_cache_init(mydata);
+	mydata->fatbuf = malloc_cache_aligned(FATBUFALLOCSIZE);
 	if (mydata->fatbuf == NULL) {
 		debug("Error: allocating memory\n");
 		return -1;
@@ -781,6 +875,10 @@ struct fat_itr {
 	 * @name:		l_name if there is one, else s_name
 	 */
 	char *name;
+	/**
+	 * @use_dcache:		look up and record names in the dentry cache
+	 */
+	bool use_dcache;
 	/**
 	 * @block:		buffer for current cluster
 	 */
@@ -810,6 +908,7 @@ static int fat_itr_root(fat_itr *itr, fsdata *fsdata)
 	itr->remaining = 0;
 	itr->last_cluster = 0;
 	itr->is_root = 1;
+	itr->use_dcache = false;
 
 	return 0;
 }
@@ -839,6 +938,7 @@ static void fat_itr_child(fat_itr *itr, fat_itr *parent)
 	assert(fat_itr_isdir(parent));
 
 	itr->fsdata = parent->fsdata;
+	itr->use_dcache = parent->use_dcache;
 	itr->start_clust = clustnum;
 	if (clustnum > 0) {
 		itr->clust = clustnum;
@@ -1099,6 +1199,59 @@ static int fat_itr_isdir(fat_itr *itr)
 #define TYPE_DIR  0x2
 #define TYPE_ANY  (TYPE_FILE | TYPE_DIR)
 
+/**
+ * fat_itr_find() - find a name in the directory of an iterator
+ *
+ * Both the long and the short name of each entry are compared, ignoring
+ * case. If the iterator uses the dentry cache, the result is looked up
+ * there first and recorded there otherwise. On a cache hit the iterator
+ * is left with only a copy of the entry, which is enough to read the
+ * file or descend into the directory but not to modify the entry.
+ *
+ * @itr: iterator at the start of a directory
+ * @name: name to look for
+ * @len: length of @name
+ * Return: true if found, with the cursor at the entry
+ */
+static bool fat_itr_find(fat_itr *itr, const char *name, int len)
+{
+	struct fs_dcache_ent *ent = NULL;
+	unsigned int dir = itr->start_clust;
+
+	if (itr->use_dcache)
+		ent = fs_dcache_find(dir, name, len, true);
+	if (ent) {
+		if (!ent->found)
+			return false;
+		memcpy(itr->block, ent->data, sizeof(dir_entry));
+		itr->dent = (dir_entry *)itr->block;
+		itr->remaining = 0;
+		itr->last_cluster = 1;
+		get_name(itr->dent, itr->s_name);
+		itr->name = itr->s_name;
+		return true;
+	}
+
+	while (fat_itr_next(itr)) {
+		unsigned int n = max(strlen(itr->name), (size_t)len);
+
+		/* check both long and short name: */
+		if (!strncasecmp(name, itr->name, n) ||
+		    (itr->name != itr->s_name &&
+		     !strncasecmp(name, itr->s_name, n))) {
+			if (itr->use_dcache)
+				fs_dcache_add(dir, name, len, true, itr->dent,
+					      sizeof(dir_entry));
+			return true;
+		}
+	}
+
+	if (itr->use_dcache)
+		fs_dcache_add(dir, name, len, false, NULL, 0);
+
+	return false;
+}
+
 /**
  * fat_itr_resolve() - traverse directory structure to resolve the
  * requested path.
@@ -1157,39 +1310,25 @@ static int fat_itr_resolve(fat_itr *itr, const char *path, unsigned type)
 		}
 	}
 
-	while (fat_itr_next(itr)) {
-		int match = 0;
-		unsigned n = max(strlen(itr->name), (size_t)(next - path));
-
-		/* check both long and short name: */
-		if (!strncasecmp(path, itr->name, n))
-			match = 1;
-		else if (itr->name != itr->s_name &&
-			 !strncasecmp(path, itr->s_name, n))
-			match = 1;
-
-		if (!match)
-			continue;
+	if (!fat_itr_find(itr, path, next - path))
+		return -ENOENT;
 
-		if (fat_itr_isdir(itr)) {
-			/* recurse into directory: */
-			fat_itr_child(itr, itr);
-			return fat_itr_resolve(itr, next, type);
-		} else if (next[0]) {
-			/*
-			 * If next is not empty then we have a case
-			 * like: /path/to/realfile/nonsense
-			 */
-			debug("bad trailing path: %s\n", next);
-			return -ENOENT;
-		} else if (!(type & TYPE_FILE)) {
-			return -ENOTDIR;
-		} else {
-			return 0;
-		}
+	if (fat_itr_isdir(itr)) {
+		/* recurse into directory: */
+		fat_itr_child(itr, itr);
+		return fat_itr_resolve(itr, next, type);
+	} else if (next[0]) {
+		/*
+		 * If next is not empty then we have a case
+		 * like: /path/to/realfile/nonsense
+		 */
+		debug("bad trailing path: %s\n", next);
+		return -ENOENT;
+	} else if (!(type & TYPE_FILE)) {
+		return -ENOTDIR;
 	}
 
-	return -ENOENT;
+	return 0;
 }
 
 int file_fat_detectfs(void)
@@ -1236,6 +1375,7 @@ int fat_exists(const char *filename)
 	if (ret)
 		goto out;
 
+	itr->use_dcache = true;
 	ret = fat_itr_resolve(itr, filename, TYPE_ANY);
 	free(fsdata.fatbuf);
 out:
@@ -1278,6 +1418,7 @@ int fat_size(const char *filename, loff_t *size)
 	if (ret)
 		goto out_free_itr;
 
+	itr->use_dcache = true;
 	ret = fat_itr_resolve(itr, filename, TYPE_FILE);
 	if (ret) {
 		/*
@@ -1288,7 +1429,8 @@ int fat_size(const char *filename, loff_t *size)
 		ret = fat_itr_root(itr, &fsdata);
 		if (ret)
 			goto out_free_itr;
-		ret = fat_itr_resolve(itr, filename, TYPE_DIR);
+		itr->use_dcache = true;
+	ret = fat_itr_resolve(itr, filename, TYPE_DIR);
 		if (!ret)
 			*size = 0;
 		goto out_free_both;
@@ -1316,6 +1458,7 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	if (ret)
 		goto out_free_itr;
 
+	itr->use_dcache = true;
 	ret = fat_itr_resolve(itr, filename, TYPE_FILE);
 	if (ret)
 		goto out_free_both;
@@ -1367,6 +1510,7 @@ int fat_opendir(const char *filename, struct fs_dir_stream **dirsp)
 	if (ret)
 		goto fail_free_dir;
 
+	dir->itr.use_dcache = true;
 	ret = fat_itr_resolve(&dir->itr, filename, TYPE_DIR);
 	if (ret)
 		goto fail_free_both;
@@ -213,20 +213,15 @@ static int disk_write(__u32 block, __u32 nr_blocks, void *buf)
 }
 
 /*
- * Write fat buffer into block device
+ * Write a window of the FAT into both copies on the block device
  */
-static int flush_dirty_fat_buffer(fsdata *mydata)
+static int fat_write_window(fsdata *mydata, int bufnum, __u8 *bufptr)
 {
 	int getsize = FATBUFBLOCKS;
 	__u32 fatlength = mydata->fatlength;
-	__u8 *bufptr = mydata->fatbuf;
-	__u32 startblock = mydata->fatbufnum * FATBUFBLOCKS;
-
-	debug("debug: evicting %d, dirty: %d\n", mydata->fatbufnum,
-	      (int)mydata->fat_dirty);
+	__u32 startblock = bufnum * FATBUFBLOCKS;
 
-	if ((!mydata->fat_dirty) || (mydata->fatbufnum == -1))
-		return 0;
+	debug("debug: writing FAT window %d\n", bufnum);
 
 	/* Cap length if fatlength is not a multiple of FATBUFBLOCKS */
 	if (startblock + getsize > fatlength)
@@ -248,6 +243,38 @@ static int flush_dirty_fat_buffer(fsdata *mydata)
 			return -1;
 		}
 	}
+
+	return 0;
+}
+
+/*
+ * Write fat buffer and any dirty cached windows into block device
+ */
+static int flush_dirty_fat_buffer(fsdata *mydata)
+{
+	int slot;
+
+	debug("debug: evicting %d, dirty: %d\n", mydata->fatbufnum,
+	      (int)mydata->fat_dirty);
+
+	for (slot = 0; slot < FAT_CACHE_WINDOWS; slot++) {
+		if (!(mydata->fatcache_dirty & BIT(slot)))
+			continue;
+
+		/* fatbuf is newer than the cached copy of the current window */
+		if (mydata->fatcachenum[slot] == mydata->fatbufnum)
+			mydata->fat_dirty = 1;
+		else if (fat_write_window(mydata, mydata->fatcachenum[slot],
+					  fat_cache_slot(mydata, slot)) < 0)
+			return -1;
+		mydata->fatcache_dirty &= ~BIT(slot);
+	}
+
+	if ((!mydata->fat_dirty) || (mydata->fatbufnum == -1))
+		return 0;
+
+	if (fat_write_window(mydata, mydata->fatbufnum, mydata->fatbuf) < 0)
+		return -1;
 	mydata->fat_dirty = 0;
 
 	return 0;
@@ -462,27 +489,8 @@ static int set_fatent_value(fsdata *mydata, __u32 entry, __u32 entry_value)
 	}
 
 	/* Read a new block of FAT entries into the cache. */
-	if (bufnum != mydata->fatbufnum) {
-		int getsize = FATBUFBLOCKS;
-		__u8 *bufptr = mydata->fatbuf;
-		__u32 fatlength = mydata->fatlength;
-		__u32 startblock = bufnum * FATBUFBLOCKS;
-
-		/* Cap length if fatlength is not a multiple of FATBUFBLOCKS */
-		if (startblock + getsize > fatlength)
-			getsize = fatlength - startblock;
-
-		if (flush_dirty_fat_buffer(mydata) < 0)
-			return -1;
-
-		startblock += mydata->fat_sect;
-
-		if (disk_read(startblock, getsize, bufptr) < 0) {
-			debug("Error reading FAT blocks\n");
-			return -1;
-		}
-		mydata->fatbufnum = bufnum;
-	}
+	if (bufnum != mydata->fatbufnum && fat_load_window(mydata, bufnum) < 0)
+		return -1;
 
 	/* Mark as dirty */
 	mydata->fat_dirty = 1;
@@ -541,6 +549,38 @@ static int set_fatent_value(fsdata *mydata, __u32 entry, __u32 entry_value)
 	return 0;
 }
 
+/*
+ * Where the last search for a free cluster ended, so that writing many files
+ * does not rescan the allocated start of the FAT each time. This is only a
+ * hint: the search wraps around, so a stale value just costs time.
+ */
+static struct {
+	struct blk_desc *dev;
+	lbaint_t start;
+	__u32 clust;
+} fat_free_hint;
+
+/*
+ * Return the number of the first cluster past the end of the filesystem
+ */
+static __u32 fat_clust_end(fsdata *mydata)
+{
+	__u32 end, fat_end;
+
+	end = (mydata->total_sect - mydata->data_begin) / mydata->clust_size;
+	fat_end = (u64)mydata->fatlength * mydata->sect_size * 8 /
+		  mydata->fatsize;
+
+	return min(end, fat_end);
+}
+
+static void fat_set_free_hint(__u32 clust)
+{
+	fat_free_hint.dev = cur_dev;
+	fat_free_hint.start = cur_part_info.start;
+	fat_free_hint.clust = clust;
+}
+
 /*
  * Determine the next free cluster after 'entry' in a FAT (12/16/32) table
  * and link it to 'entry'. EOC marker is not set on returned entry.
@@ -560,6 +600,7 @@ static __u32 determine_fatent(fsdata *mydata, __u32 entry)
 	}
 	debug("FAT%d: entry: %08x, entry_value: %04x\n",
 	       mydata->fatsize, entry, next_entry);
+	fat_set_free_hint(next_entry + 1);
 
 	return next_entry;
 }
@@ -802,18 +843,32 @@ get_set_cluster(fsdata *mydata, __u32 clustnum, loff_t pos, __u8 *buffer,
 /*
  * Find the first empty cluster
  */
+/*
+ * Find a free cluster, starting where the last search ended. If the
+ * filesystem is full, this returns the end of it, which check_overflow()
+ * rejects.
+ */
 static int find_empty_cluster(fsdata *mydata)
 {
-	__u32 fat_val, entry = 3;
+	__u32 end = fat_clust_end(mydata);
+	__u32 start = 3, entry;
 
-	while (1) {
-		fat_val = get_fatent(mydata, entry);
-		if (fat_val == 0)
-			break;
-		entry++;
-	}
+	if (fat_free_hint.dev == cur_dev &&
+	    fat_free_hint.start == cur_part_info.start &&
+	    fat_free_hint.clust > start && fat_free_hint.clust < end)
+		start = fat_free_hint.clust;
+
+	entry = start;
+	do {
+		if (!get_fatent(mydata, entry)) {
+			fat_set_free_hint(entry + 1);
+			return entry;
+		}
+		if (++entry >= end)
+			entry = 3;
+	} while (entry != start);
 
-	return entry;
+	return end;
 }
 
 /**
@@ -1504,13 +1559,13 @@ static int fat_dir_entries(fat_itr *itr)
 	fsdata = *dirs->fsdata;
 
 	/* allocate local fat buffer */
-	fsdata.fatbuf = malloc_cache_aligned(FATBUFSIZE);
+	fsdata.fatbuf = malloc_cache_aligned(FATBUFALLOCSIZE);
 	if (!fsdata.fatbuf) {
 		debug("Error: allocating memory\n");
 		count = -ENOMEM;
 		goto exit;
 	}
-	fsdata.fatbufnum = -1;
+	fat_cache_init(&fsdata);
 	dirs->fsdata = &fsdata;
 
 	for (count = 0; fat_itr_next(dirs); count++)
@@ -5,15 +5,18 @@
 
 #define LOG_CATEGORY LOGC_CORE
 
+#include <bootstage.h>
 #include <command.h>
 #include <config.h>
 #include <display_options.h>
 #include <errno.h>
 #include <env.h>
+#include <gzip.h>
 #include <lmb.h>
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <memalign.h>
 #include <part.h>
 #include <ext4fs.h>
 #include <fat.h>
@@ -22,13 +25,16 @@
 #include <semihostingfs.h>
 #include <time.h>
 #include <ubifs_uboot.h>
+#include <u-boot/schedule.h>
 #include <btrfs.h>
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 #include <div64.h>
 #include <linux/math64.h>
 #include <linux/sizes.h>
+#include <linux/zstd.h>
 #include <efi_loader.h>
 #include <squashfs.h>
 #include <erofs.h>
@@ -155,6 +161,12 @@ struct fstype_info {
 	 * filesystem.
 	 */
 	bool null_dev_desc_ok;
+	/*
+	 * Does .read() transfer whole sectors of file data straight into the
+	 * caller's buffer? If so, _fs_read() shifts a misaligned buffer so
+	 * that these transfers are DMA-aligned.
+	 */
+	bool direct_read;
 	int (*probe)(struct blk_desc *fs_dev_desc,
 		     struct disk_partition *fs_partition);
 	int (*ls)(const char *dirname);
@@ -191,6 +203,7 @@ static struct fstype_info fstypes[] = {
 		.fstype = FS_TYPE_FAT,
 		.name = "fat",
 		.null_dev_desc_ok = false,
+		.direct_read = true,
 		.probe = fat_set_blk_dev,
 		.close = fat_close,
 		.ls = fs_ls_generic,
@@ -219,6 +232,7 @@ static struct fstype_info fstypes[] = {
 		.fstype = FS_TYPE_EXT,
 		.name = "ext4",
 		.null_dev_desc_ok = false,
+		.direct_read = true,
 		.probe = ext4fs_probe,
 		.close = ext4fs_close,
 		.ls = fs_ls_generic,
@@ -452,18 +466,34 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 /* set current blk device w/ blk_desc + partition # */
 int fs_set_blk_dev_with_part(struct blk_desc *desc, int part)
 {
-	struct fstype_info *info;
-	int ret, i;
+	struct disk_partition info;
+	int ret;
 
 	if (part >= 1)
-		ret = part_get_info(desc, part, &fs_partition);
+		ret = part_get_info(desc, part, &info);
 	else
-		ret = part_get_info_whole_disk(desc, &fs_partition);
+		ret = part_get_info_whole_disk(desc, &info);
 	if (ret)
 		return ret;
+
+	return fs_set_blk_dev_with_part_info(desc, part, &info, FS_TYPE_ANY);
+}
+
+int fs_set_blk_dev_with_part_info(struct blk_desc *desc, int part,
+				  const struct disk_partition *pinfo,
+				  int fstype)
+{
+	struct fstype_info *info;
+	int i;
+
+	fs_partition = *pinfo;
 	fs_dev_desc = desc;
 
 	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
+		if (fstype != FS_TYPE_ANY && info->fstype != FS_TYPE_ANY &&
+		    fstype != info->fstype)
+			continue;
+
 		if (!info->probe(fs_dev_desc, &fs_partition)) {
 			fs_type = info->fstype;
 			fs_dev_part = part;
@@ -566,6 +596,8 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 		    int do_lmb_check, loff_t *actread)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
+	ulong start_us = bootstage_prof_start();
+	ulong shift = 0;
 	void *buf;
 	int ret;
 
@@ -582,12 +614,36 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	 * means read the whole file.
 	 */
 	buf = map_sysmem(addr, len);
-	ret = info->read(filename, buf, offset, len, actread);
+
+	/*
+	 * File data lands at addr - offset plus a multiple of the sector size.
+	 * If that is not DMA-aligned, every transfer would be bounced, or read
+	 * a sector at a time by the filesystem. Instead, read the file a few
+	 * bytes lower, into the DMA granule which the start of the buffer is
+	 * in anyway, move it into place and put back the bytes that were
+	 * overwritten.
+	 */
+	if (info->direct_read && fs_dev_desc)
+		shift = (addr - offset) & (ARCH_DMA_MINALIGN - 1);
+	if (shift && shift <= (addr & (ARCH_DMA_MINALIGN - 1))) {
+		u8 head[ARCH_DMA_MINALIGN];
+
+		memcpy(head, buf - shift, shift);
+		ret = info->read(filename, buf - shift, offset, len, actread);
+		if (!ret)
+			memmove(buf, buf - shift, *actread);
+		memcpy(buf - shift, head, shift);
+	} else {
+		ret = info->read(filename, buf, offset, len, actread);
+	}
 	unmap_sysmem(buf);
 
 	/* If we requested a specific number of bytes, check we got it */
 	if (ret == 0 && len && *actread != len)
 		log_debug("** %s shorter than offset + len **\n", filename);
+	if (!ret)
+		bootstage_prof_add(BOOTSTAGE_PROF_FS_READ, info->name, start_us,
+				   *actread);
 	fs_close();
 
 	return ret;
@@ -599,6 +655,101 @@ int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	return _fs_read(filename, addr, offset, len, 0, actread);
 }
 
+#if CONFIG_IS_ENABLED(FS_LOAD_GUNZIP)
+int fs_read_gunzip(const char *filename, ulong addr, ulong maxlen,
+		   loff_t *actread)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	struct gunzip_stream *gz = NULL;
+	struct zstd_stream *zs = NULL;
+	loff_t pos = 0, got;
+	void *buf, *chunk;
+	ulong len;
+	int ret;
+
+#if CONFIG_IS_ENABLED(LMB)
+	len = lmb_get_free_size(addr);
+	if (!maxlen || maxlen > len)
+		maxlen = len;
+#endif
+	if (!maxlen) {
+		fs_close();
+		return -ENOSPC;
+	}
+
+	buf = map_sysmem(addr, maxlen);
+	chunk = malloc_cache_aligned(CONFIG_FS_LOAD_GUNZIP_CHUNK);
+	if (!chunk) {
+		fs_close();
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	/*
+	 * Each read leaves the filesystem closed, so mount it again for all
+	 * but the first chunk. The chunk is decompressed straight to its
+	 * final place before the next one is read.
+	 */
+	do {
+		if (pos && info->probe(fs_dev_desc, &fs_partition)) {
+			ret = -EIO;
+			break;
+		}
+		ret = info->read(filename, chunk, pos,
+				 CONFIG_FS_LOAD_GUNZIP_CHUNK, &got);
+		fs_close();
+		if (ret)
+			break;
+		if (!got) {
+			log_debug("** %s is truncated **\n", filename);
+			ret = -EIO;
+			break;
+		}
+
+		/* The first chunk shows how the file is compressed */
+		if (!pos) {
+			if (CONFIG_IS_ENABLED(ZSTD) && got >= sizeof(u32) &&
+			    get_unaligned_le32(chunk) == ZSTD_MAGICNUMBER)
+				zs = zstd_stream_start(buf, maxlen);
+			else
+				gz = gunzip_stream_start(buf, maxlen);
+			if (!zs && !gz) {
+				ret = -ENOMEM;
+				break;
+			}
+		}
+		pos += got;
+		if (zs)
+			ret = zstd_stream_feed(zs, chunk, got);
+		else
+			ret = gunzip_stream_feed(gz, chunk, got);
+		schedule();
+	} while (!ret);
+
+out:
+	if (gz || zs) {
+		int err;
+
+		if (zs)
+			err = zstd_stream_finish(zs, &len);
+		else
+			err = gunzip_stream_finish(gz, &len);
+		if (ret >= 0)
+			ret = err;
+		*actread = len;
+	}
+	unmap_sysmem(buf);
+	free(chunk);
+
+#if CONFIG_IS_ENABLED(LMB)
+	if (!ret && lmb_alloc_addr(addr, len, LMB_NONE) != addr)
+		ret = -ENOSPC;
+#endif
+
+	return ret;
+}
+#endif
+
 int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	     loff_t *actwrite)
 {
@@ -743,11 +894,18 @@ int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 	loff_t len_read;
 	int ret;
 	unsigned long time;
+	bool unzip = false;
 	char *ep;
 
+	if (CONFIG_IS_ENABLED(FS_LOAD_GUNZIP) && argc > 1 &&
+	    !strcmp(argv[1], "-z")) {
+		unzip = true;
+		argc--;
+		argv++;
+	}
 	if (argc < 2)
 		return CMD_RET_USAGE;
-	if (argc > 7)
+	if (argc > (unzip ? 6 : 7))
 		return CMD_RET_USAGE;
 
 	if (fs_set_blk_dev(argv[1], cmd_arg2(argc, argv), fstype)) {
@@ -785,7 +943,10 @@ int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 		pos = 0;
 
 	time = get_timer(0);
-	ret = _fs_read(filename, addr, pos, bytes, 1, &len_read);
+	if (unzip)
+		ret = fs_read_gunzip(filename, addr, bytes, &len_read);
+	else
+		ret = _fs_read(filename, addr, pos, bytes, 1, &len_read);
 	time = get_timer(time);
 	if (ret < 0) {
 		log_err("Failed to load '%s'\n", filename);
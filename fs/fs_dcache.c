@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Directory-entry lookup cache shared by the filesystem drivers
+ *
+ * Every fs_*() call mounts the filesystem and resolves its path from the
+ * root, so probing many candidate paths, as bootflow scanning does, walks
+ * the same directories over and over. This remembers the outcome of each
+ * name lookup, including misses, for as long as the same filesystem stays
+ * mounted and the device is not written to.
+ */
+
+#define LOG_CATEGORY	LOGC_FS
+
+#include <blk.h>
+#include <fs_dcache.h>
+#include <log.h>
+#include <malloc.h>
+#include <linux/string.h>
+
+/**
+ * struct fs_dcache - state of the cache
+ *
+ * @desc: Block device of the bound filesystem, NULL if none
+ * @part_start: First block of its partition
+ * @sig: Signature of the filesystem
+ * @write_count: Value of @desc->write_count when the entries were added
+ * @count: Number of valid entries
+ * @next: Entry to replace next once the cache is full
+ * @ent: Entries, CONFIG_FS_DCACHE_ENTRIES of them
+ */
+struct fs_dcache {
+	struct blk_desc *desc;
+	lbaint_t part_start;
+	u32 sig;
+	uint write_count;
+	int count;
+	int next;
+	struct fs_dcache_ent *ent;
+};
+
+static struct fs_dcache dcache;
+
+void fs_dcache_invalidate(void)
+{
+	dcache.desc = NULL;
+	dcache.count = 0;
+	dcache.next = 0;
+}
+
+void fs_dcache_bind(struct blk_desc *desc, lbaint_t part_start, u32 sig)
+{
+	if (dcache.desc == desc && dcache.part_start == part_start &&
+	    dcache.sig == sig && dcache.write_count == desc->write_count)
+		return;
+
+	log_debug("binding to %s %d, part start " LBAFU "\n",
+		  blk_get_uclass_name(desc->uclass_id), desc->devnum,
+		  part_start);
+	fs_dcache_invalidate();
+	dcache.desc = desc;
+	dcache.part_start = part_start;
+	dcache.sig = sig;
+	dcache.write_count = desc->write_count;
+}
+
+/* Check that nothing was written since the entries were added */
+static bool fs_dcache_valid(void)
+{
+	if (dcache.desc && dcache.write_count != dcache.desc->write_count)
+		fs_dcache_invalidate();
+
+	return dcache.desc;
+}
+
+struct fs_dcache_ent *fs_dcache_find(ulong dir, const char *name, int len,
+				     bool nocase)
+{
+	struct fs_dcache_ent *ent;
+	int i;
+
+	if (!fs_dcache_valid() || len > FS_DCACHE_NAME_LEN)
+		return NULL;
+
+	for (i = 0; i < dcache.count; i++) {
+		ent = &dcache.ent[i];
+		if (ent->dir != dir || ent->len != len)
+			continue;
+		if (nocase ? !strncasecmp(ent->name, name, len) :
+		    !memcmp(ent->name, name, len))
+			return ent;
+	}
+
+	return NULL;
+}
+
+void fs_dcache_add(ulong dir, const char *name, int len, bool found,
+		   const void *data, int size)
+{
+	struct fs_dcache_ent *ent;
+
+	if (!fs_dcache_valid() || len > FS_DCACHE_NAME_LEN ||
+	    size > FS_DCACHE_DATA_LEN)
+		return;
+
+	if (!dcache.ent) {
+		dcache.ent = calloc(CONFIG_FS_DCACHE_ENTRIES, sizeof(*ent));
+		if (!dcache.ent)
+			return;
+	}
+
+	if (dcache.count < CONFIG_FS_DCACHE_ENTRIES) {
+		ent = &dcache.ent[dcache.count++];
+	} else {
+		ent = &dcache.ent[dcache.next];
+		if (++dcache.next == CONFIG_FS_DCACHE_ENTRIES)
+			dcache.next = 0;
+	}
+
+	ent->dir = dir;
+	ent->found = found;
+	ent->len = len;
+	memcpy(ent->name, name, len);
+	if (found)
+		memcpy(ent->data, data, size);
+}
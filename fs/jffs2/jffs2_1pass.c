@@ -647,6 +647,7 @@ jffs2_free_cache(struct part_info *part)
 		free_nodes(&pL->dir);
 		free(pL->readbuf);
 		free(pL);
+		part->jffs2_priv = NULL;
 	}
 }
 
@@ -1483,6 +1484,10 @@ jffs2_1pass_build_lists(struct part_info * part)
 	u32 max_totlen = 0;
 	u32 buf_size;
 	char *buf;
+#ifdef CONFIG_JFFS2_SUMMARY
+	void *sumbuf = NULL;
+	u32 sumbuf_len = 0;
+#endif
 
 	nr_sectors = lldiv(part->size, part->sector_size);
 	/* turn off the lcd.  Refreshing the lcd adds 50% overhead to the */
@@ -1527,20 +1532,27 @@ jffs2_1pass_build_lists(struct part_info * part)
 				buf_len, buf_len, buf + buf_size - buf_len);
 
 		sm = (void *)buf + buf_size - sizeof(*sm);
-		if (sm->magic == JFFS2_SUM_MAGIC) {
+		if (sm->magic == JFFS2_SUM_MAGIC &&
+		    sm->offset < part->sector_size) {
 			sumlen = part->sector_size - sm->offset;
 			sumptr = buf + buf_size - sumlen;
 
 			/* Now, make sure the summary itself is available */
 			if (sumlen > buf_size) {
-				/* Need to kmalloc for this. */
-				sumptr = malloc(sumlen);
+				/*
+				 * Summaries are much the same size in each
+				 * sector, so keep one buffer for all of them
+				 */
+				if (sumlen > sumbuf_len) {
+					free(sumbuf);
+					sumbuf = malloc(sumlen);
+					sumbuf_len = sumbuf ? sumlen : 0;
+				}
+				sumptr = sumbuf;
 				if (!sumptr) {
 					putstr("Can't get memory for summary "
 							"node!\n");
-					free(buf);
-					jffs2_free_cache(part);
-					return 0;
+					goto err;
 				}
 				memcpy(sumptr + sumlen - buf_len, buf +
 						buf_size - buf_len, buf_len);
@@ -1558,14 +1570,8 @@ jffs2_1pass_build_lists(struct part_info * part)
 		if (sumptr) {
 			ret = jffs2_sum_scan_sumnode(part, sector_ofs, sumptr,
 					sumlen, pL);
-
-			if (buf_size && sumlen > buf_size)
-				free(sumptr);
-			if (ret < 0) {
-				free(buf);
-				jffs2_free_cache(part);
-				return 0;
-			}
+			if (ret < 0)
+				goto err;
 			if (ret)
 				continue;
 
@@ -1720,11 +1726,8 @@ jffs2_1pass_build_lists(struct part_info * part)
 					break;
 
 				b = insert_node(&pL->frag);
-				if (!b) {
-					free(buf);
-					jffs2_free_cache(part);
-					return 0;
-				}
+				if (!b)
+					goto err;
 				b->offset = (u32)part->offset + ofs;
 				b->version = node->i.version;
 				b->ino = node->i.ino;
@@ -1758,11 +1761,8 @@ jffs2_1pass_build_lists(struct part_info * part)
 				if (! (counterN%100))
 					puts ("\b\b.  ");
 				b = insert_node(&pL->dir);
-				if (!b) {
-					free(buf);
-					jffs2_free_cache(part);
-					return 0;
-				}
+				if (!b)
+					goto err;
 				b->offset = (u32)part->offset + ofs;
 				b->version = node->d.version;
 				b->pino = node->d.pino;
@@ -1808,6 +1808,9 @@ jffs2_1pass_build_lists(struct part_info * part)
 	}
 
 	free(buf);
+#ifdef CONFIG_JFFS2_SUMMARY
+	free(sumbuf);
+#endif
 #if defined(CONFIG_SYS_JFFS2_SORT_FRAGMENTS)
 	/*
 	 * Sort the lists.
@@ -1845,6 +1848,14 @@ jffs2_1pass_build_lists(struct part_info * part)
 	/* give visual feedback that we are done scanning the flash */
 	led_blink(0x0, 0x0, 0x1, 0x1);	/* off, forever, on 100ms, off 100ms */
 	return 1;
+
+err:
+	free(buf);
+#ifdef CONFIG_JFFS2_SUMMARY
+	free(sumbuf);
+#endif
+	jffs2_free_cache(part);
+	return 0;
 }
 
 static u32
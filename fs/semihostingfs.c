@@ -28,19 +28,22 @@ static int smh_fs_read_at(const char *filename, loff_t pos, void *buffer,
 	fd = smh_open(filename, MODE_READ | MODE_BINARY);
 	if (fd < 0)
 		return fd;
-	ret = smh_seek(fd, pos);
-	if (ret < 0) {
-		smh_close(fd);
-		return ret;
+	/* Each call traps to the debugger, so avoid any which are not needed */
+	if (pos) {
+		ret = smh_seek(fd, pos);
+		if (ret < 0) {
+			smh_close(fd);
+			return ret;
+		}
 	}
 	if (!maxsize) {
 		size = smh_flen(fd);
-		if (ret < 0) {
+		if (size < 0) {
 			smh_close(fd);
 			return size;
 		}
 
-		maxsize = size;
+		maxsize = size > pos ? size - pos : 0;
 	}
 
 	size = smh_read(fd, buffer, maxsize);
@@ -19,6 +19,7 @@
 #include <string.h>
 #include <squashfs.h>
 #include <part.h>
+#include <u-boot/crc.h>
 
 #include "sqfs_decompressor.h"
 #include "sqfs_filesystem.h"
@@ -29,6 +30,74 @@
 static struct squashfs_ctxt ctxt;
 static int symlinknest;
 
+/**
+ * struct sqfs_cache - decompressed metadata kept across filesystem calls
+ *
+ * @dev: Block device of the image the cache belongs to, NULL if none
+ * @part_start: First block of its partition
+ * @write_count: Value of @dev->write_count when the cache was filled
+ * @sig: CRC32 of the image's superblock
+ * @inode_table: Decompressed inode table, NULL if not read yet
+ * @inode_size: Size of @inode_table in bytes
+ * @dir_table: Decompressed directory table, NULL if not read yet
+ * @pos_list: Metadata block positions in the directory table
+ * @metablks_count: Number of metadata blocks in the directory table
+ * @frag_entries: Last decompressed block of the fragment table, or NULL
+ * @frag_block: Index of @frag_entries in the fragment table
+ * @frag: Last decompressed fragment block, or NULL
+ * @frag_start: Position of @frag in the image
+ * @frag_len: Decompressed length of @frag
+ */
+struct sqfs_cache {
+	struct blk_desc *dev;
+	lbaint_t part_start;
+	uint write_count;
+	u32 sig;
+	unsigned char *inode_table;
+	size_t inode_size;
+	unsigned char *dir_table;
+	u32 *pos_list;
+	int metablks_count;
+	struct squashfs_fragment_block_entry *frag_entries;
+	int frag_block;
+	char *frag;
+	u64 frag_start;
+	unsigned long frag_len;
+};
+
+static struct sqfs_cache cache;
+
+static void sqfs_cache_free(void)
+{
+	free(cache.inode_table);
+	free(cache.dir_table);
+	free(cache.pos_list);
+	free(cache.frag_entries);
+	free(cache.frag);
+	memset(&cache, '\0', sizeof(cache));
+}
+
+/*
+ * Keep the cache if the same image is mounted again without the device
+ * having been written to, or drop it otherwise.
+ */
+static void sqfs_cache_bind(struct squashfs_super_block *sblk)
+{
+	u32 sig = crc32(0, (u8 *)sblk, sizeof(*sblk));
+
+	if (cache.dev == ctxt.cur_dev &&
+	    cache.part_start == ctxt.cur_part_info.start &&
+	    cache.write_count == ctxt.cur_dev->write_count &&
+	    cache.sig == sig)
+		return;
+
+	sqfs_cache_free();
+	cache.dev = ctxt.cur_dev;
+	cache.part_start = ctxt.cur_part_info.start;
+	cache.write_count = ctxt.cur_dev->write_count;
+	cache.sig = sig;
+}
+
 static int sqfs_readdir_nest(struct fs_dir_stream *fs_dirs, struct fs_dirent **dentp);
 
 static int sqfs_disk_read(__u32 block, __u32 nr_blocks, void *buf)
@@ -47,6 +116,23 @@ static int sqfs_disk_read(__u32 block, __u32 nr_blocks, void *buf)
 	return ret;
 }
 
+/*
+ * Returns a pointer to blocks which the device holds in memory, e.g. an image
+ * in RAM mapped with blkmap, so that they can be used without a copy. Returns
+ * NULL if they must be read with sqfs_disk_read().
+ */
+static void *sqfs_disk_map(__u32 block, __u32 nr_blocks)
+{
+	void *buf;
+
+	if (!ctxt.cur_dev || block + nr_blocks > ctxt.cur_part_info.size ||
+	    blk_dmap(ctxt.cur_dev, ctxt.cur_part_info.start + block,
+		     nr_blocks, &buf))
+		return NULL;
+
+	return buf;
+}
+
 static int sqfs_read_sblk(struct squashfs_super_block **sblk)
 {
 	*sblk = malloc_cache_aligned(ctxt.cur_dev->blksz);
@@ -120,6 +206,14 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 	if (inode_fragment_index >= get_unaligned_le32(&sblk->fragments))
 		return -EINVAL;
 
+	block = SQFS_FRAGMENT_INDEX(inode_fragment_index);
+	offset = SQFS_FRAGMENT_INDEX_OFFSET(inode_fragment_index);
+
+	if (cache.frag_entries && cache.frag_block == block) {
+		*e = cache.frag_entries[offset];
+		return SQFS_COMPRESSED_BLOCK(e->size);
+	}
+
 	start = get_unaligned_le64(&sblk->fragment_table_start);
 	end = get_unaligned_le64(&sblk->id_table_start);
 	exp_tbl = get_unaligned_le64(&sblk->export_table_start);
@@ -144,9 +238,6 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 		goto out;
 	}
 
-	block = SQFS_FRAGMENT_INDEX(inode_fragment_index);
-	offset = SQFS_FRAGMENT_INDEX_OFFSET(inode_fragment_index);
-
 	/*
 	 * Get the start offset of the metadata block that contains the right
 	 * fragment block entry
@@ -200,6 +291,13 @@ static int sqfs_frag_lookup(u32 inode_fragment_index,
 	*e = entries[offset];
 	ret = SQFS_COMPRESSED_BLOCK(e->size);
 
+	if (CONFIG_IS_ENABLED(FS_SQUASHFS_CACHE)) {
+		free(cache.frag_entries);
+		cache.frag_entries = entries;
+		cache.frag_block = block;
+		entries = NULL;
+	}
+
 out:
 	free(entries);
 	free(metadata_buffer);
@@ -721,6 +819,12 @@ static int sqfs_read_inode_table(unsigned char **inode_table)
 	bool compressed;
 	size_t buf_size;
 
+	if (cache.inode_table) {
+		*inode_table = kmemdup(cache.inode_table, cache.inode_size,
+				       GFP_KERNEL);
+		return *inode_table ? 0 : -ENOMEM;
+	}
+
 	table_size = get_unaligned_le64(&sblk->directory_table_start) -
 		get_unaligned_le64(&sblk->inode_table_start);
 	start = get_unaligned_le64(&sblk->inode_table_start) /
@@ -795,6 +899,12 @@ static int sqfs_read_inode_table(unsigned char **inode_table)
 		src_table += src_len + SQFS_HEADER_SIZE;
 	}
 
+	if (CONFIG_IS_ENABLED(FS_SQUASHFS_CACHE)) {
+		cache.inode_size = metablks_count * SQFS_METADATA_BLOCK_SIZE;
+		cache.inode_table = kmemdup(*inode_table, cache.inode_size,
+					    GFP_KERNEL);
+	}
+
 free_itb:
 	free(itb);
 
@@ -814,6 +924,23 @@ static int sqfs_read_directory_table(unsigned char **dir_table, u32 **pos_list)
 
 	*dir_table = NULL;
 	*pos_list = NULL;
+
+	if (cache.dir_table) {
+		metablks_count = cache.metablks_count;
+		*dir_table = kmemdup(cache.dir_table,
+				     metablks_count * SQFS_METADATA_BLOCK_SIZE,
+				     GFP_KERNEL);
+		*pos_list = kmemdup(cache.pos_list,
+				    metablks_count * sizeof(u32), GFP_KERNEL);
+		if (*dir_table && *pos_list)
+			return metablks_count;
+		free(*dir_table);
+		free(*pos_list);
+		*dir_table = NULL;
+		*pos_list = NULL;
+		return -ENOMEM;
+	}
+
 	/* DIRECTORY TABLE */
 	table_size = get_unaligned_le64(&sblk->fragment_table_start) -
 		get_unaligned_le64(&sblk->directory_table_start);
@@ -893,6 +1020,22 @@ static int sqfs_read_directory_table(unsigned char **dir_table, u32 **pos_list)
 		src_table += src_len + SQFS_HEADER_SIZE;
 	}
 
+	if (CONFIG_IS_ENABLED(FS_SQUASHFS_CACHE)) {
+		cache.dir_table = kmemdup(*dir_table, metablks_count *
+					  SQFS_METADATA_BLOCK_SIZE, GFP_KERNEL);
+		cache.pos_list = kmemdup(*pos_list,
+					 metablks_count * sizeof(u32),
+					 GFP_KERNEL);
+		if (cache.dir_table && cache.pos_list) {
+			cache.metablks_count = metablks_count;
+		} else {
+			free(cache.dir_table);
+			free(cache.pos_list);
+			cache.dir_table = NULL;
+			cache.pos_list = NULL;
+		}
+	}
+
 out:
 	if (metablks_count < 1) {
 		free(*dir_table);
@@ -1149,6 +1292,8 @@ int sqfs_probe(struct blk_desc *fs_dev_desc, struct disk_partition *fs_partition
 	}
 
 	ctxt.sblk = sblk;
+	if (CONFIG_IS_ENABLED(FS_SQUASHFS_CACHE))
+		sqfs_cache_bind(sblk);
 
 	ret = sqfs_decompressor_init(&ctxt);
 	if (ret) {
@@ -1510,12 +1655,17 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 				      ctxt.cur_dev->blksz);
 
 		/* Don't load any data for sparse blocks */
+		data_buffer = NULL;
+		data = NULL;
 		if (finfo.blk_sizes[j] == 0) {
 			n_blks = 0;
 			table_offset = 0;
-			data_buffer = NULL;
-			data = NULL;
 		} else {
+			/* An image held in memory is used in place */
+			data = sqfs_disk_map(start, n_blks);
+		}
+
+		if (n_blks && !data) {
 			data_buffer = malloc_cache_aligned(n_blks * ctxt.cur_dev->blksz);
 
 			if (!data_buffer) {
@@ -1534,8 +1684,10 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 				goto out;
 			}
 
-			data = data_buffer + table_offset;
+			data = data_buffer;
 		}
+		if (data)
+			data += table_offset;
 
 		/* Load the data */
 		if (finfo.blk_sizes[j] == 0) {
@@ -1577,6 +1729,19 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 		goto out;
 	}
 
+	/* Fragment blocks are shared by many small files */
+	if (finfo.comp && cache.frag && cache.frag_start == frag_entry.start) {
+		if (finfo.offset + finfo.size - *actread > cache.frag_len) {
+			ret = -EINVAL;
+			goto out;
+		}
+		memcpy(buf + *actread, &cache.frag[finfo.offset],
+		       finfo.size - *actread);
+		*actread = finfo.size;
+		ret = 0;
+		goto out;
+	}
+
 	start = lldiv(frag_entry.start, ctxt.cur_dev->blksz);
 	table_size = SQFS_BLOCK_SIZE(frag_entry.size);
 	table_offset = frag_entry.start - (start * ctxt.cur_dev->blksz);
@@ -1616,7 +1781,14 @@ static int sqfs_read_nest(const char *filename, void *buf, loff_t offset,
 		memcpy(buf + *actread, &fragment_block[finfo.offset], finfo.size - *actread);
 		*actread = finfo.size;
 
-		free(fragment_block);
+		if (CONFIG_IS_ENABLED(FS_SQUASHFS_CACHE)) {
+			free(cache.frag);
+			cache.frag = fragment_block;
+			cache.frag_start = frag_entry.start;
+			cache.frag_len = dest_len;
+		} else {
+			free(fragment_block);
+		}
 
 	} else if (finfo.frag && !finfo.comp) {
 		fragment_block = (void *)fragment + table_offset;
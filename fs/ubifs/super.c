@@ -1402,6 +1402,8 @@ static int mount_ubifs(struct ubifs_info *c)
 		if (!c->ileb_buf)
 			goto out_free;
 	}
+#else
+	c->bulk_read = IS_ENABLED(CONFIG_UBIFS_BULK_READ);
 #endif
 
 	if (c->bulk_read == 1)
@@ -721,23 +721,12 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decode_block(struct ubifs_info *c, struct inode *inode, void *addr,
+			unsigned int block, struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -768,6 +757,82 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decode_block(c, inode, addr, block, dn);
+}
+
+/**
+ * bulk_read() - read several pages of a file with one flash read
+ *
+ * This looks up the data nodes which follow @block and lie next to each other
+ * in the same LEB, reads them all into the bulk-read buffer and decompresses
+ * them into @addr. Holes between the nodes are zeroed.
+ *
+ * @c: UBIFS file-system description object
+ * @inode: inode of the file
+ * @addr: destination for the data
+ * @block: first block to read
+ * @max_pages: maximum number of pages to fill
+ * Return: number of pages read, 0 if there is nothing to gain from a bulk
+ * read here, or a negative error code
+ */
+static int bulk_read(struct ubifs_info *c, struct inode *inode, void *addr,
+		     unsigned int block, int max_pages)
+{
+	struct bu_info *bu = &c->bu;
+	int err, i, nn, pages, blocks;
+
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	bu->buf_len = c->max_bu_buf_len;
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err)
+		return err;
+
+	pages = min(bu->blk_cnt >> UBIFS_BLOCKS_PER_PAGE_SHIFT, max_pages);
+	blocks = pages << UBIFS_BLOCKS_PER_PAGE_SHIFT;
+	while (bu->cnt && key_block(c, &bu->zbranch[bu->cnt - 1].key) >=
+	       block + blocks)
+		bu->cnt--;
+	/* A single node is read just as fast by read_block() */
+	if (bu->cnt < 2)
+		return 0;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		return err == -EAGAIN ? 0 : err;
+
+	for (i = 0, nn = 0; i < blocks; i++, addr += UBIFS_BLOCK_SIZE) {
+		struct ubifs_zbranch *zbr = &bu->zbranch[nn];
+
+		if (nn >= bu->cnt || key_block(c, &zbr->key) != block + i) {
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+			continue;
+		}
+		err = decode_block(c, inode, addr, block + i,
+				   bu->buf + zbr->offs - bu->zbranch[0].offs);
+		if (err)
+			return err;
+		nn++;
+	}
+
+	return pages;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -944,6 +1009,29 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	page.index = offset / PAGE_SIZE;
 	page.inode = inode;
 	for (i = 0; i < count; i++) {
+		/*
+		 * Read whole pages in bulk where the data nodes allow it,
+		 * leaving the last page to do_readpage() so that nothing is
+		 * written beyond the requested size
+		 */
+		if (c->bulk_read && i + 1 < count) {
+			int pages;
+
+			pages = bulk_read(c, inode, page.addr,
+					  page.index << UBIFS_BLOCKS_PER_PAGE_SHIFT,
+					  count - i - 1);
+			if (pages < 0) {
+				err = pages;
+				break;
+			}
+			if (pages) {
+				page.addr += pages * PAGE_SIZE;
+				page.index += pages;
+				i += pages - 1;
+				continue;
+			}
+		}
+
 		/*
 		 * Make sure to not read beyond the requested size
 		 */
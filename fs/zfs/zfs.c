@@ -136,6 +136,16 @@ typedef struct dnode_end {
 	zfs_endian_t endian;
 } dnode_end_t;
 
+/* Number of indirect and dnode blocks kept by zio_read_cached() */
+#define ZFS_BLOCK_CACHE		8
+
+/* A decompressed block kept for reuse, found by its block pointer */
+struct zfs_cached_block {
+	blkptr_t bp;
+	void *buf;
+	uint64_t last_used;
+};
+
 struct zfs_data {
 	/* cache for a file block of the currently zfs_open()-ed file */
 	char *file_buf;
@@ -150,12 +160,9 @@ struct zfs_data {
 	uint64_t label_txg;
 	uint64_t pool_guid;
 
-	/* cache for a dnode block */
-	dnode_phys_t *dnode_buf;
-	dnode_phys_t *dnode_mdn;
-	uint64_t dnode_start;
-	uint64_t dnode_end;
-	zfs_endian_t dnode_endian;
+	/* cache for indirect and dnode blocks, least recently used is evicted */
+	struct zfs_cached_block block_cache[ZFS_BLOCK_CACHE];
+	uint64_t block_cache_clock;
 
 	uberblock_t current_uberblock;
 
@@ -613,14 +620,52 @@ zio_read(blkptr_t *bp, zfs_endian_t endian, void **buf,
 	return ZFS_ERR_NONE;
 }
 
+/*
+ * Read in a block like zio_read(), but keep it for reuse. A block found in
+ * the cache is not read, checksummed or decompressed again. The returned
+ * buffer belongs to the cache and is only valid until the next call.
+ */
+static int
+zio_read_cached(blkptr_t *bp, zfs_endian_t endian, void **buf,
+				struct zfs_data *data)
+{
+	struct zfs_cached_block *blk, *victim = NULL;
+	int err, i;
+
+	for (i = 0; i < ZFS_BLOCK_CACHE; i++) {
+		blk = &data->block_cache[i];
+		if (blk->buf && !memcmp(&blk->bp, bp, sizeof(*bp))) {
+			blk->last_used = ++data->block_cache_clock;
+			*buf = blk->buf;
+			return ZFS_ERR_NONE;
+		}
+		if (!victim || blk->last_used < victim->last_used)
+			victim = blk;
+	}
+
+	err = zio_read(bp, endian, buf, 0, data);
+	if (err)
+		return err;
+
+	free(victim->buf);
+	victim->bp = *bp;
+	victim->buf = *buf;
+	victim->last_used = ++data->block_cache_clock;
+
+	return ZFS_ERR_NONE;
+}
+
 /*
  * Get the block from a block id.
  * push the block onto the stack.
  *
+ * Indirect blocks are read through the block cache. If cached is non-zero, so
+ * is the block itself, which then belongs to the cache; otherwise it must be
+ * freed by the caller.
  */
 static int
-dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
-		 zfs_endian_t *endian_out, struct zfs_data *data)
+dmu_read_block(dnode_end_t *dn, uint64_t blkid, void **buf,
+		 zfs_endian_t *endian_out, struct zfs_data *data, int cached)
 {
 	int idx, level;
 	blkptr_t *bp_array = dn->dn.dn_blkptr;
@@ -638,13 +683,15 @@ dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
 	for (level = dn->dn.dn_nlevels - 1; level >= 0; level--) {
 		idx = (blkid >> (epbs * level)) & ((1 << epbs) - 1);
 		*bp = bp_array[idx];
-		if (bp_array != dn->dn.dn_blkptr) {
-			free(bp_array);
-			bp_array = 0;
-		}
 
 		if (BP_IS_HOLE(bp)) {
-			size_t size = zfs_to_cpu16(dn->dn.dn_datablkszsec,
+			size_t size;
+
+			if (cached) {
+				err = ZFS_ERR_BAD_FS;
+				break;
+			}
+			size = zfs_to_cpu16(dn->dn.dn_datablkszsec,
 											dn->endian)
 				<< SPA_MINBLOCKSHIFT;
 			*buf = malloc(size);
@@ -657,18 +704,19 @@ dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
 			break;
 		}
 		if (level == 0) {
-			err = zio_read(bp, endian, buf, 0, data);
+			if (cached)
+				err = zio_read_cached(bp, endian, buf, data);
+			else
+				err = zio_read(bp, endian, buf, 0, data);
 			endian = (zfs_to_cpu64(bp->blk_prop, endian) >> 63) & 1;
 			break;
 		}
-		err = zio_read(bp, endian, &tmpbuf, 0, data);
+		err = zio_read_cached(bp, endian, &tmpbuf, data);
 		endian = (zfs_to_cpu64(bp->blk_prop, endian) >> 63) & 1;
 		if (err)
 			break;
 		bp_array = tmpbuf;
 	}
-	if (bp_array != dn->dn.dn_blkptr)
-		free(bp_array);
 	if (endian_out)
 		*endian_out = endian;
 
@@ -676,6 +724,13 @@ dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
 	return err;
 }
 
+static int
+dmu_read(dnode_end_t *dn, uint64_t blkid, void **buf,
+		 zfs_endian_t *endian_out, struct zfs_data *data)
+{
+	return dmu_read_block(dn, blkid, buf, endian_out, data, 0);
+}
+
 /*
  * mzap_lookup: Looks up property described by "name" and returns the value
  * in "value".
@@ -1115,35 +1170,10 @@ dnode_get(dnode_end_t *mdn, uint64_t objnum, uint8_t type,
 	blkid = objnum >> epbs;
 	idx = objnum & ((1 << epbs) - 1);
 
-	if (data->dnode_buf != NULL && memcmp(data->dnode_mdn, mdn,
-										  sizeof(*mdn)) == 0
-		&& objnum >= data->dnode_start && objnum < data->dnode_end) {
-		memmove(&(buf->dn), &(data->dnode_buf)[idx], DNODE_SIZE);
-		buf->endian = data->dnode_endian;
-		if (type && buf->dn.dn_type != type)  {
-			printf("incorrect dnode type: %02X != %02x\n", buf->dn.dn_type, type);
-			return ZFS_ERR_BAD_FS;
-		}
-		return ZFS_ERR_NONE;
-	}
-
-	err = dmu_read(mdn, blkid, &dnbuf, &endian, data);
+	err = dmu_read_block(mdn, blkid, &dnbuf, &endian, data, 1);
 	if (err)
 		return err;
 
-	free(data->dnode_buf);
-	free(data->dnode_mdn);
-	data->dnode_mdn = malloc(sizeof(*mdn));
-	if (!data->dnode_mdn) {
-		data->dnode_buf = 0;
-	} else {
-		memcpy(data->dnode_mdn, mdn, sizeof(*mdn));
-		data->dnode_buf = dnbuf;
-		data->dnode_start = blkid << epbs;
-		data->dnode_end = (blkid + 1) << epbs;
-		data->dnode_endian = endian;
-	}
-
 	memmove(&(buf->dn), (dnode_phys_t *) dnbuf + idx, DNODE_SIZE);
 	buf->endian = endian;
 	if (type && buf->dn.dn_type != type) {
@@ -1841,8 +1871,10 @@ static uint64_t vdev_label_start(uint64_t psize, int l)
 void
 zfs_unmount(struct zfs_data *data)
 {
-	free(data->dnode_buf);
-	free(data->dnode_mdn);
+	int i;
+
+	for (i = 0; i < ZFS_BLOCK_CACHE; i++)
+		free(data->block_cache[i].buf);
 	free(data->file_buf);
 	free(data);
 }
@@ -139,6 +139,7 @@ struct ahci_ioports {
 	struct ahci_sg		*cmd_tbl_sg;
 	ulong	cmd_tbl;
 	u32	rx_fis;
+	int	ncq_depth;	/* number of NCQ slots to use, 0 if none */
 };
 
 /**
@@ -256,6 +256,13 @@ struct global_data {
 	 */
 	void *dm_priv_base;
 # endif
+#if CONFIG_IS_ENABLED(DM_BIND_INDEX)
+	/**
+	 * @dm_bind_index: Hash table of the compatible strings of all drivers,
+	 * or NULL if not yet built. See lists_bind_fdt()
+	 */
+	struct lists_bind_index *dm_bind_index;
+#endif
 #endif
 #ifdef CONFIG_TIMER
 	/**
@@ -310,6 +317,13 @@ struct global_data {
 	 */
 	unsigned int malloc_ptr;
 #endif
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE)
+	/**
+	 * @malloc_profile: heap usage of each allocation site, see
+	 * malloc_profile_get()
+	 */
+	struct malloc_profile *malloc_profile;
+#endif
 #ifdef CONFIG_CONSOLE_RECORD
 	/**
 	 * @console_out: output buffer for console recording
@@ -448,6 +462,12 @@ struct global_data {
 	 */
 	struct upl *upl;
 #endif
+#if CONFIG_IS_ENABLED(REENTER)
+	/**
+	 * @reenter_copy: copy of U-Boot as it was when board_init_r() started
+	 */
+	void *reenter_copy;
+#endif
 };
 #ifndef DO_DEPS_ONLY
 static_assert(sizeof(struct global_data) == GD_SIZE);
@@ -495,6 +515,14 @@ static_assert(sizeof(struct global_data) == GD_SIZE);
 #define gd_dm_priv_base()		NULL
 #endif
 
+#if CONFIG_IS_ENABLED(DM_BIND_INDEX)
+#define gd_set_dm_bind_index(idx)	gd->dm_bind_index = idx
+#define gd_dm_bind_index()		gd->dm_bind_index
+#else
+#define gd_set_dm_bind_index(idx)
+#define gd_dm_bind_index()		NULL
+#endif
+
 #ifdef CONFIG_ACPI
 #define gd_acpi_ctx()		gd->acpi_ctx
 #define gd_acpi_start()		gd->acpi_start
@@ -702,6 +730,10 @@ enum gd_flags {
 	 * drivers shall not be called.
 	 */
 	GD_FLG_HAVE_CONSOLE = 0x8000000,
+	/**
+	 * @GD_FLG_REENTER: board_init_r() is running again after board_reenter()
+	 */
+	GD_FLG_REENTER = 0x10000000,
 };
 
 #endif /* __ASSEMBLY__ */
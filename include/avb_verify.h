@@ -14,6 +14,7 @@
 #define VERITY_TABLE_OPT_RESTART	"restart_on_corruption"
 #define VERITY_TABLE_OPT_LOGGING	"ignore_corruption"
 #define ALLOWED_BUF_ALIGN		8
+#define AVB_MAX_PRELOAD			2
 
 enum avb_boot_state {
 	AVB_GREEN,
@@ -22,10 +23,25 @@ enum avb_boot_state {
 	AVB_RED,
 };
 
+/**
+ * struct avb_preload - Memory into which a partition is loaded for verifying
+ *
+ * @name: Partition name, including any slot suffix
+ * @buf: Buffer to load the partition into
+ * @size: Size of @buf in bytes
+ */
+struct avb_preload {
+	char name[PART_NAME_LEN];
+	void *buf;
+	size_t size;
+};
+
 struct AvbOpsData {
 	struct AvbOps ops;
 	int mmc_dev;
 	enum avb_boot_state boot_state;
+	struct mmc_part *parts;
+	struct avb_preload preload[AVB_MAX_PRELOAD];
 #ifdef CONFIG_OPTEE_TA_AVB
 	struct udevice *tee;
 	u32 session;
@@ -37,6 +53,7 @@ struct mmc_part {
 	struct mmc *mmc;
 	struct blk_desc *mmc_blk;
 	struct disk_partition info;
+	struct mmc_part *next;
 };
 
 enum mmc_io_type {
@@ -47,6 +64,27 @@ enum mmc_io_type {
 AvbOps *avb_ops_alloc(int boot_device);
 void avb_ops_free(AvbOps *ops);
 
+/**
+ * avb_set_preload() - Load a partition into a given buffer while verifying it
+ *
+ * Normally libavb loads each partition into a temporary buffer to hash it.
+ * This asks for @partition to be loaded into @buf instead, so that once it is
+ * verified, the caller can use the data without reading it again.
+ *
+ * If the partition's image is larger than @size, it is loaded in the normal
+ * way and @buf is not touched. Check the preloaded flag of the partition in
+ * AvbSlotVerifyData to see whether @buf was used.
+ *
+ * @ops: AVB ops to update
+ * @partition: Partition name, including any slot suffix
+ * @buf: Buffer to load the partition into
+ * @size: Size of @buf in bytes
+ * Return: 0 if OK, -ENOSPC if too many partitions are preloaded, -EINVAL if
+ *	the name is too long
+ */
+int avb_set_preload(AvbOps *ops, const char *partition, void *buf,
+		    size_t size);
+
 char *avb_set_state(AvbOps *ops, enum avb_boot_state boot_state);
 char *avb_set_enforce_verity(const char *cmdline);
 char *avb_set_ignore_corruption(const char *cmdline);
@@ -48,6 +48,69 @@ enum sig_type {
 	SIG_TYPE_COUNT			/* Number of signature types */
 };
 
+/**
+ * struct blk_request - an asynchronous read from or write to a block device
+ *
+ * @dev: Block device the request is submitted to
+ * @start: First block to transfer
+ * @blkcnt: Number of blocks to transfer
+ * @buf: Data buffer, which must be suitably aligned for DMA
+ * @write: true to write @buf to the device, false to read into it
+ * @done: Number of blocks transferred once the request is complete
+ * @ret: Result once the request is complete: 0 if OK, -ve on error
+ * @complete: true once the request has finished, successfully or not
+ * @priv: Driver-private state while the request is in flight
+ */
+struct blk_request {
+	struct udevice *dev;
+	lbaint_t start;
+	lbaint_t blkcnt;
+	void *buf;
+	bool write;
+	lbaint_t done;
+	int ret;
+	bool complete;
+	void *priv;
+};
+
+/**
+ * struct blk_sg - one segment of a scatter-gather read
+ *
+ * @buf: Place to put the data, aligned for DMA
+ * @len: Length of the segment in bytes, a multiple of the block size
+ */
+struct blk_sg {
+	void *buf;
+	ulong len;
+};
+
+/**
+ * struct blk_readahead - sequential read-ahead state of a block device
+ *
+ * @buf: Buffer holding the window, aligned for DMA
+ * @size: Size of @buf in bytes
+ * @start: First block held in @buf
+ * @count: Number of valid blocks in @buf, 0 if none
+ * @next: Block which the next read starts at if access is sequential
+ * @window: Current window size in blocks, 0 if access is not sequential
+ * @next_buf: Buffer for the following window, read asynchronously
+ * @req: Request reading the following window into @next_buf
+ * @pending: true if @req is in flight or its data is not yet used
+ */
+struct blk_readahead {
+	void *buf;
+	ulong size;
+	lbaint_t start;
+	lbaint_t count;
+	lbaint_t next;
+	lbaint_t window;
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	void *next_buf;
+	struct blk_request req;
+	bool pending;
+#endif
+};
+
 /*
  * With driver model (CONFIG_BLK) this is uclass platform data, accessible
  * with dev_get_uclass_plat(dev)
@@ -72,6 +135,8 @@ struct blk_desc {
 	lbaint_t	lba;		/* number of blocks */
 	unsigned long	blksz;		/* block size */
 	int		log2blksz;	/* for convenience: log2(blksz) */
+	lbaint_t	max_blocks;	/* max blocks per request, 0 if unknown */
+	uint		write_count;	/* bumped by each write/erase */
 	char		vendor[BLK_VEN_SIZE + 1]; /* device vendor string */
 	char		product[BLK_PRD_SIZE + 1]; /* device product number */
 	char		revision[BLK_REV_SIZE + 1]; /* firmware revision */
@@ -87,6 +152,9 @@ struct blk_desc {
 	 * device. Once these functions are removed we can drop this field.
 	 */
 	struct udevice *bdev;
+#if CONFIG_IS_ENABLED(BLK_READAHEAD)
+	struct blk_readahead *ra;	/* read-ahead state, NULL if none */
+#endif
 #else
 	unsigned long	(*block_read)(struct blk_desc *block_dev,
 				      lbaint_t start,
@@ -103,6 +171,21 @@ struct blk_desc {
 #endif
 };
 
+#if CONFIG_IS_ENABLED(BLK_READAHEAD)
+/**
+ * blk_readahead_invalidate() - discard read-ahead data of a block device
+ *
+ * This must be called when the contents of the device may have changed
+ * behind the back of blk_read(), e.g. after a hardware-partition switch or
+ * a media change.
+ *
+ * @desc: Block device descriptor
+ */
+void blk_readahead_invalidate(struct blk_desc *desc);
+#else
+static inline void blk_readahead_invalidate(struct blk_desc *desc) {}
+#endif
+
 #define BLOCK_CNT(size, blk_desc) (PAD_COUNT(size, blk_desc->blksz))
 #define PAD_TO_BLOCKSIZE(size, blk_desc) \
 	(PAD_SIZE(size, blk_desc->blksz))
@@ -118,6 +201,8 @@ struct blk_desc {
  * @param blksz - size in bytes of each block
  * @param buffer - buffer to contain cached data
  *
+ * Only an entry filled with exactly the same range of blocks is returned.
+ *
  * Return: - 1 if block returned from cache, 0 otherwise.
  */
 int blkcache_read(int iftype, int dev,
@@ -157,6 +242,19 @@ void blkcache_invalidate(int iftype, int dev);
  */
 void blkcache_configure(unsigned blocks, unsigned entries);
 
+/* maximum number of devices with separate block-cache statistics */
+#define BLKCACHE_MAX_DEVS	8
+
+/*
+ * per-device statistics of the block cache
+ */
+struct block_cache_dev_stats {
+	int iftype;
+	int devnum;
+	unsigned hits;
+	unsigned misses;
+};
+
 /*
  * statistics of the block cache
  */
@@ -166,11 +264,19 @@ struct block_cache_stats {
 	unsigned entries; /* current entry count */
 	unsigned max_blocks_per_entry;
 	unsigned max_entries;
+	unsigned sets; /* number of hash sets, 0 if not allocated yet */
+	unsigned ways; /* maximum entries in each set */
+	unsigned num_devs; /* number of valid entries in @dev */
+	struct block_cache_dev_stats dev[BLKCACHE_MAX_DEVS];
 };
 
 /**
  * get_blkcache_stats() - return statistics and reset
  *
+ * Cached entries are found by hashing (iftype, dev, start, blkcnt) into one
+ * of a number of sets, each of which is kept in least-recently-used order.
+ * Hits and misses are counted overall and for each device.
+ *
  * @param stats - statistics are copied here
  */
 void blkcache_stats(struct block_cache_stats *stats);
@@ -258,6 +364,71 @@ struct blk_ops {
 	 */
 	int (*select_hwpart)(struct udevice *dev, int hwpart);
 
+	/**
+	 * submit() - start an asynchronous transfer on a block device
+	 *
+	 * This starts the transfer described by @req, a read or a write, and
+	 * returns without waiting for it to finish. Completion is checked with poll(). The
+	 * driver may use @req->priv to track its progress. Only one request
+	 * is in flight on a device at a time; the driver must complete it
+	 * before handling any other operation on the device.
+	 *
+	 * @dev:	Device to transfer with
+	 * @req:	Request to start
+	 * @return 0 if started, -ENOSYS if this request cannot be handled
+	 * asynchronously (the caller then uses read() or write()), other -ve
+	 * on error
+	 */
+	int (*submit)(struct udevice *dev, struct blk_request *req);
+
+	/**
+	 * poll() - check progress of an asynchronous transfer
+	 *
+	 * This must not wait for the transfer to finish, but may start the
+	 * next part of it if the request is handled in several pieces. When
+	 * the request is complete the driver updates @req->done.
+	 *
+	 * @dev:	Device the request was submitted to
+	 * @req:	Request to check
+	 * @return 0 if complete, -EBUSY if still in progress, other -ve on
+	 * error
+	 */
+	int (*poll)(struct udevice *dev, struct blk_request *req);
+
+	/**
+	 * read_sg() - read consecutive blocks into a scatter-gather list
+	 *
+	 * This is optional and lets a driver fill several discontiguous
+	 * buffers with a single transfer.
+	 *
+	 * @dev:	Device to read from
+	 * @start:	Start block number
+	 * @sg:		Segments to fill, in order
+	 * @count:	Number of segments in @sg
+	 * @return number of blocks read, -ENOSYS or -E2BIG if the list cannot
+	 * be handled in one transfer (the caller then reads each segment
+	 * separately), other -ve on error
+	 */
+	long (*read_sg)(struct udevice *dev, lbaint_t start,
+			const struct blk_sg *sg, uint count);
+
+	/**
+	 * map() - get a pointer to blocks which are held in memory
+	 *
+	 * This is optional and is provided by devices whose data already sits
+	 * in memory, so that callers can use it in place rather than copying
+	 * it with read().
+	 *
+	 * @dev:	Device to map
+	 * @start:	Start block number
+	 * @blkcnt:	Number of blocks, which must be contiguous in memory
+	 * @bufp:	Returns a pointer to the data of block @start
+	 * @return 0 if OK, -ERANGE if the blocks are not contiguous in
+	 * memory, other -ve on error
+	 */
+	int (*map)(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
+		   void **bufp);
+
 #if IS_ENABLED(CONFIG_BOUNCE_BUFFER)
 	/**
 	 * buffer_aligned() - test memory alignment of block operation buffer
@@ -291,6 +462,8 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt, const void *buffer);
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			 lbaint_t blkcnt);
+int blk_dmap(struct blk_desc *block_dev, lbaint_t start, lbaint_t blkcnt,
+	     void **bufp);
 
 #endif /* BLK */
 
@@ -307,6 +480,88 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 long blk_read(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 	      void *buffer);
 
+/**
+ * blk_read_sg() - Read consecutive blocks into a scatter-gather list
+ *
+ * The blocks starting at @start are read into each segment of @sg in turn.
+ * If the device supports it this is done with a single transfer, otherwise
+ * each segment is read separately.
+ *
+ * @dev: Device to read from
+ * @start: Start block for the read
+ * @sg: Segments to fill, each a multiple of the block size in length
+ * @count: Number of segments in @sg
+ * Return: number of blocks read, or -ve on error
+ */
+long blk_read_sg(struct udevice *dev, lbaint_t start, const struct blk_sg *sg,
+		 uint count);
+
+/**
+ * blk_map() - Get a pointer to blocks which are held in memory
+ *
+ * Some devices, such as a blkmap of an image in RAM, hold their data in
+ * memory. For these the caller can use the data in place rather than reading
+ * a copy. The data must not be written through the pointer, which stays valid
+ * until the device is removed.
+ *
+ * @dev: Device to map
+ * @start: Start block
+ * @blkcnt: Number of blocks
+ * @bufp: Returns a pointer to the data of block @start
+ * Return: 0 if OK, -ENOSYS if the device cannot map blocks, -ERANGE if the
+ * blocks are beyond the device or not contiguous in memory, other -ve on error
+ */
+int blk_map(struct udevice *dev, lbaint_t start, lbaint_t blkcnt, void **bufp);
+
+/**
+ * blk_submit() - Start an asynchronous read from a block device
+ *
+ * Fills in @req and starts reading. If the device cannot read asynchronously
+ * the read is done synchronously and the request is complete on return. In
+ * either case blk_poll() or blk_wait() is used to collect the result.
+ *
+ * @dev: Device to read from
+ * @req: Request to fill in and start
+ * @start: Start block for the read
+ * @blkcnt: Number of blocks to read
+ * @buf: Place to put the data, aligned for DMA
+ * Return: 0 if OK, -ve on error
+ */
+int blk_submit(struct udevice *dev, struct blk_request *req, lbaint_t start,
+	       lbaint_t blkcnt, void *buf);
+
+/**
+ * blk_submit_write() - Start an asynchronous write to a block device
+ *
+ * This is the write counterpart of blk_submit(). @buf must not be changed
+ * until the request is complete.
+ *
+ * @dev: Device to write to
+ * @req: Request to fill in and start
+ * @start: Start block for the write
+ * @blkcnt: Number of blocks to write
+ * @buf: Data to write, aligned for DMA
+ * Return: 0 if OK, -ve on error
+ */
+int blk_submit_write(struct udevice *dev, struct blk_request *req,
+		     lbaint_t start, lbaint_t blkcnt, const void *buf);
+
+/**
+ * blk_poll() - Check whether an asynchronous transfer has finished
+ *
+ * @req: Request started with blk_submit() or blk_submit_write()
+ * Return: 0 if complete, -EBUSY if still in progress, other -ve on error
+ */
+int blk_poll(struct blk_request *req);
+
+/**
+ * blk_wait() - Wait for an asynchronous transfer to finish
+ *
+ * @req: Request started with blk_submit() or blk_submit_write()
+ * Return: number of blocks transferred, or -ve on error
+ */
+long blk_wait(struct blk_request *req);
+
 /**
  * blk_write() - Write to a block device
  *
@@ -549,13 +804,21 @@ static inline ulong blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt, const void *buffer)
 {
 	blkcache_invalidate(block_dev->uclass_id, block_dev->devnum);
+	block_dev->write_count++;
 	return block_dev->block_write(block_dev, start, blkcnt, buffer);
 }
 
+static inline int blk_dmap(struct blk_desc *block_dev, lbaint_t start,
+			   lbaint_t blkcnt, void **bufp)
+{
+	return -ENOSYS;
+}
+
 static inline ulong blk_derase(struct blk_desc *block_dev, lbaint_t start,
 			       lbaint_t blkcnt)
 {
 	blkcache_invalidate(block_dev->uclass_id, block_dev->devnum);
+	block_dev->write_count++;
 	return block_dev->block_erase(block_dev, start, blkcnt);
 }
 
@@ -153,6 +153,15 @@ enum bloblist_tag_t {
 	BLOBLISTT_U_BOOT_SPL_HANDOFF	= 0xfff000, /* Hand-off info from SPL */
 	BLOBLISTT_VBE			= 0xfff001, /* VBE per-phase state */
 	BLOBLISTT_U_BOOT_VIDEO		= 0xfff002, /* Video info from SPL */
+	BLOBLISTT_U_BOOT_MMC_TUNING	= 0xfff003, /* struct mmc_tuning_cache */
+	BLOBLISTT_U_BOOT_MMC_HANDOFF	= 0xfff004, /* struct mmc_handoff */
+	BLOBLISTT_U_BOOT_LIVE_TREE	= 0xfff005, /* struct of_live_hdr */
+	/* struct malloc_profile for U-Boot proper and for SPL */
+	BLOBLISTT_U_BOOT_MALLOC_PROFILE	= 0xfff006,
+	BLOBLISTT_U_BOOT_SPL_MALLOC_PROFILE = 0xfff007,
+	BLOBLISTT_U_BOOT_LOG		= 0xfff008, /* binary log records */
+	BLOBLISTT_U_BOOT_DM_HANDOFF	= 0xfff009, /* struct dm_handoff */
+	BLOBLISTT_U_BOOT_FIT_VERIFIED	= 0xfff00a, /* struct fit_verified[] */
 };
 
 /**
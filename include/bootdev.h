@@ -340,7 +340,10 @@ int bootdev_next_label(struct bootflow_iter *iter, struct udevice **devp,
  * bootdev_next_prio() - Find the next bootdev in priority order
  *
  * This moves @devp to the next bootdev with the current priority. If there is
- * none, then it moves to the next priority and scans for new bootdevs there.
+ * none and hunting is enabled, the next unused hunter for this priority is run
+ * and any new bootdevs are considered, so that the bootdevs found by each
+ * hunter are scanned before the next hunter is run. Once no hunters are left,
+ * it moves to the next priority.
  *
  * @iter: Interation info, containing iter->cur_prio
  * @devp: On entry this is the previous bootdev that was considered. On exit
@@ -416,6 +416,36 @@ int bootflow_read_all(struct bootflow *bflow);
  */
 int bootflow_run_boot(struct bootflow_iter *iter, struct bootflow *bflow);
 
+/**
+ * bootflow_cache_save() - Remember a bootflow for the next boot
+ *
+ * This records the bootdev, partition, bootmeth, filename, size and partition
+ * UUID of a bootflow in the "bootflow_cache" environment variable, saving the
+ * environment if the value changed. Only bootflows on block devices can be
+ * remembered.
+ *
+ * @bflow: Bootflow which is about to be booted
+ * Return: 0 if OK, -ENOTSUPP if the bootflow cannot be remembered, other -ve
+ *	on error
+ */
+int bootflow_cache_save(const struct bootflow *bflow);
+
+/**
+ * bootflow_scan_cached() - Read the bootflow remembered from the last boot
+ *
+ * This reads the bootflow recorded by bootflow_cache_save(), checking only the
+ * one bootdev, partition and bootmeth. The bootflow is only returned if its
+ * filename, size and partition UUID still match.
+ *
+ * @iter: Iterator to use, which is set up for the single bootflow
+ * @flags: Flags for iterator (enum bootflow_iter_flags_t)
+ * @bflow: Returns the bootflow if found
+ * Return: 0 if found, -ENOENT if nothing is remembered, -ESTALE if the
+ *	bootflow no longer matches, other -ve on error
+ */
+int bootflow_scan_cached(struct bootflow_iter *iter, int flags,
+			 struct bootflow *bflow);
+
 /**
  * bootflow_state_get_name() - Get the name of a bootflow state
  *
@@ -213,6 +213,7 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_UBI_ATTACH,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -338,6 +339,14 @@ uint32_t bootstage_accum(enum bootstage_id id);
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * bootstage_report_json() - print the boot-time report as JSON
+ *
+ * This has the same information as bootstage_report(), plus the profile
+ * collected with CONFIG_BOOTSTAGE_PROFILE, in a form tools can parse.
+ */
+void bootstage_report_json(void);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -457,6 +466,63 @@ static inline int bootstage_init(bool first)
 
 #endif /* ENABLE_BOOTSTAGE */
 
+/* Longest device, driver or function name kept in a profile entry */
+#define BOOTSTAGE_PROF_NAME_LEN	24
+
+/**
+ * enum bootstage_prof_kind - activities that are profiled automatically
+ *
+ * @BOOTSTAGE_PROF_PROBE: device_probe(), per device. Times include probing
+ *	the device's parents.
+ * @BOOTSTAGE_PROF_BLK_READ: blk_read(), per block device
+ * @BOOTSTAGE_PROF_FS_READ: fs_read() and friends, per filesystem type
+ * @BOOTSTAGE_PROF_INITCALL: each initcall, per function address or event
+ * @BOOTSTAGE_PROF_COUNT: number of kinds
+ */
+enum bootstage_prof_kind {
+	BOOTSTAGE_PROF_PROBE,
+	BOOTSTAGE_PROF_BLK_READ,
+	BOOTSTAGE_PROF_FS_READ,
+	BOOTSTAGE_PROF_INITCALL,
+
+	BOOTSTAGE_PROF_COUNT,
+};
+
+#if !defined(USE_HOSTCC) && CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE)
+/**
+ * bootstage_prof_start() - get the start time of a profiled activity
+ *
+ * Return: current time in microseconds, or 0 if profiling is not possible
+ *	yet, e.g. because the timer is not set up
+ */
+ulong bootstage_prof_start(void);
+
+/**
+ * bootstage_prof_add() - account for a profiled activity
+ *
+ * Time, byte count and number of calls are added up per @kind and @name.
+ * Names are truncated to BOOTSTAGE_PROF_NAME_LEN - 1 characters.
+ *
+ * @kind: Kind of activity
+ * @name: Device, driver or function the activity belongs to
+ * @start_us: Value returned by bootstage_prof_start() when it started
+ * @bytes: Number of bytes transferred, or 0
+ */
+void bootstage_prof_add(enum bootstage_prof_kind kind, const char *name,
+			ulong start_us, u64 bytes);
+#else
+static inline ulong bootstage_prof_start(void)
+{
+	return 0;
+}
+
+static inline void bootstage_prof_add(enum bootstage_prof_kind kind,
+				      const char *name, ulong start_us,
+				      uint64_t bytes)
+{
+}
+#endif
+
 /* helpers for SPL */
 int _bootstage_stash_default(void);
 int _bootstage_unstash_default(void);
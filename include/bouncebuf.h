@@ -49,6 +49,8 @@ struct bounce_buffer {
 	size_t len;
 	/* DMA-aligned buffer length */
 	size_t len_aligned;
+	/* Size of the allocated bounce buffer, or 0 if .user_buffer is used */
+	size_t bounce_size;
 	/* Copy of flags parameter passed to start() */
 	unsigned int flags;
 };
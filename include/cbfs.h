@@ -163,8 +163,24 @@ struct cbfs_payload {
 #define PAYLOAD_SEGMENT_PARAMS 0x41524150
 #define PAYLOAD_SEGMENT_ENTRY  0x52544E45
 
+/**
+ * struct cbfs_cachenode - Information about a file in CBFS
+ *
+ * @next: Next file in the CBFS, in the order they appear
+ * @hash_next: Next file with the same name hash, used for lookups
+ * @data: Pointer to the file's data, within the CBFS (e.g. memory-mapped SPI
+ *	flash)
+ * @name: Name of the file
+ * @type: File type (CBFS_TYPE_...)
+ * @data_length: Size of the data in bytes
+ * @name_length: Space used by the name, including padding
+ * @attr_offset: Offset of the attributes from the start of the file header
+ * @comp_algo: Compression algorithm (CBFS_COMPRESS_...)
+ * @decomp_size: Size of the data after decompression
+ */
 struct cbfs_cachenode {
 	struct cbfs_cachenode *next;
+	struct cbfs_cachenode *hash_next;
 	void *data;
 	char *name;
 	u32 type;
@@ -324,6 +340,18 @@ u32 file_cbfs_size(const struct cbfs_cachenode *file);
  */
 u32 file_cbfs_type(const struct cbfs_cachenode *file);
 
+/**
+ * file_cbfs_data() - Get a pointer to the data of a file in CBFS
+ *
+ * This avoids copying the file when the CBFS is memory-mapped, e.g. from SPI
+ * flash. Use file_cbfs_size() to get the size of the data.
+ *
+ * @file:		The handle to the file.
+ *
+ * Return: Pointer to the data of the file
+ */
+const void *file_cbfs_data(const struct cbfs_cachenode *file);
+
 /**
  * file_cbfs_read() - Read a file from CBFS into RAM
  *
@@ -111,6 +111,45 @@ struct cpu_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*release_core)(const struct udevice *dev, phys_addr_t addr);
+
+	/**
+	 * start_job() - Start running a function on a parked CPU core
+	 *
+	 * The function runs without U-Boot's services, so it must not use
+	 * malloc(), the console or driver model. The core goes back to its
+	 * parked state once the function returns, so that it can be handed
+	 * over to the OS as usual.
+	 *
+	 * @dev:	Device to use (UCLASS_CPU)
+	 * @func:	Function to run
+	 * @arg:	Argument to pass to @func
+	 * @return 0 if OK, -EBUSY if the core cannot run a job, other -ve on
+	 *	   error
+	 */
+	int (*start_job)(struct udevice *dev, void (*func)(void *arg),
+			 void *arg);
+
+	/**
+	 * wait_job() - Wait for the job started on a CPU core to finish
+	 *
+	 * @dev:	Device to use (UCLASS_CPU)
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*wait_job)(struct udevice *dev);
+};
+
+/**
+ * struct cpu_job - a job which may be run on any CPU core
+ *
+ * @func:	Function to run
+ * @arg:	Argument to pass to @func
+ * @dev:	CPU core the job was started on, NULL if on the current one.
+ *		This is set by cpu_run_jobs()
+ */
+struct cpu_job {
+	void (*func)(void *arg);
+	void *arg;
+	struct udevice *dev;
 };
 
 #define cpu_get_ops(dev)        ((struct cpu_ops *)(dev)->driver->ops)
@@ -180,6 +219,21 @@ struct udevice *cpu_get_current_dev(void);
  */
 int cpu_release_core(const struct udevice *dev, phys_addr_t addr);
 
+/**
+ * cpu_run_jobs() - Run independent jobs spread over the available CPU cores
+ *
+ * Each job is started on a parked core which supports it, with the current
+ * core running one itself. This continues until all jobs are done. Jobs run
+ * on the current core if there are no other cores to use, so the result
+ * is the same whatever the hardware. See the start_job() operation for the
+ * restrictions on what a job may do.
+ *
+ * @jobs:	Jobs to run
+ * @count:	Number of jobs
+ * Return: 0 if OK, -ve if waiting for a core failed
+ */
+int cpu_run_jobs(struct cpu_job *jobs, int count);
+
 /**
  * cpu_phys_address_size() - Get the physical-address size for the CPU
  *
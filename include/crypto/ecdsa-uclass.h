@@ -17,6 +17,8 @@ struct ecdsa_public_key {
 	const void *x;		/* x coordinate of public key */
 	const void *y;		/* y coordinate of public key */
 	unsigned int size_bits;	/* key size in bits, derived from curve name */
+	const void *comb;	/* multiples of the key, or NULL if none */
+	int comb_len;		/* size of comb table in bytes */
 };
 
 struct ecdsa_ops {
@@ -11,6 +11,7 @@
 #ifndef __cyclic_h
 #define __cyclic_h
 
+#include <linux/errno.h>
 #include <linux/list.h>
 #include <asm/types.h>
 #include <u-boot/schedule.h> // to be removed later
@@ -23,8 +24,11 @@
  * @delay_us: Delay is us after which this function shall get executed
  * @start_time_us: Start time in us, when this function started its execution
  * @cpu_time_us: Total CPU time of this function
+ * @max_cpu_time_us: Longest CPU time of a single call
+ * @max_latency_us: Longest time by which a call was later than due
  * @run_cnt: Counter of executions occurances
- * @next_call: Next time in us, when the function shall be executed again
+ * @next_call: Next time in us, when the function shall be executed again.
+ *	The list is kept in this order, so use cyclic_defer() to change it
  * @list: List node
  * @already_warned: Flag that we've warned about exceeding CPU time usage
  *
@@ -37,6 +41,8 @@ struct cyclic_info {
 	uint64_t delay_us;
 	uint64_t start_time_us;
 	uint64_t cpu_time_us;
+	uint64_t max_cpu_time_us;
+	uint64_t max_latency_us;
 	uint64_t run_cnt;
 	uint64_t next_call;
 	struct hlist_node list;
@@ -47,6 +53,100 @@ struct cyclic_info {
 /** Function type for cyclic functions */
 typedef void (*cyclic_func_t)(struct cyclic_info *c);
 
+struct cyclic_work;
+
+/**
+ * typedef cyclic_work_func_t - Step function for a job
+ *
+ * @work: Job to make progress on
+ * Return: -EINPROGRESS if the job is not complete yet, 0 if it completed,
+ * other -ve value if it failed
+ */
+typedef int (*cyclic_work_func_t)(struct cyclic_work *work);
+
+/**
+ * struct cyclic_work - A slow job which completes in the background
+ *
+ * Drivers which wait for hardware, e.g. for autonegotiation or a port to
+ * settle, can put the wait into a step function which checks the hardware
+ * and returns -EINPROGRESS until it is ready. The step function is then
+ * polled from schedule(), so that the wait overlaps other work, and the
+ * driver only blocks in cyclic_work_wait() once it needs the result.
+ *
+ * Without CONFIG_CYCLIC the job only progresses when cyclic_work_poll() or
+ * cyclic_work_wait() is called.
+ *
+ * @cyclic: Cyclic function which polls the job
+ * @step: Step function
+ * @result: -EINPROGRESS while the job is running, else its result
+ * @delay_us: Time between calls to @step
+ * @deadline_us: Time at which the job times out, 0 if never
+ */
+struct cyclic_work {
+	struct cyclic_info cyclic;
+	cyclic_work_func_t step;
+	int result;
+	uint64_t delay_us;
+	uint64_t deadline_us;
+};
+
+/**
+ * cyclic_work_start() - Start a job
+ *
+ * This calls @step once. If the job is not complete, it is polled every
+ * @delay_us from then on, until it completes or times out.
+ *
+ * @work: Job to start, which must not be running
+ * @step: Step function
+ * @delay_us: Time between calls to @step
+ * @timeout_us: Time after which the job fails with -ETIMEDOUT, 0 for none
+ * @name: Name of the job, shown by the 'cyclic' command
+ * Return: -EINPROGRESS if the job is now running in the background, else
+ * the result of the job
+ */
+int cyclic_work_start(struct cyclic_work *work, cyclic_work_func_t step,
+		      uint64_t delay_us, uint64_t timeout_us, const char *name);
+
+/**
+ * cyclic_work_poll() - Make progress on a job now
+ *
+ * @work: Job to poll
+ * Return: -EINPROGRESS if the job is still running, else its result
+ */
+int cyclic_work_poll(struct cyclic_work *work);
+
+/**
+ * cyclic_work_wait() - Wait for a job to complete
+ *
+ * Other cyclic functions, including other jobs, keep running while
+ * waiting.
+ *
+ * @work: Job to wait for
+ * Return: result of the job
+ */
+int cyclic_work_wait(struct cyclic_work *work);
+
+/**
+ * cyclic_work_cancel() - Stop a job
+ *
+ * If the job is running, its step function is not called again and its
+ * result becomes -ECANCELED. Call this before freeing a running job.
+ *
+ * @work: Job to stop
+ */
+void cyclic_work_cancel(struct cyclic_work *work);
+
+/**
+ * cyclic_work_busy() - Check whether a job is running
+ *
+ * @work: Job to check
+ * Return: true if the job has been started and is not complete
+ */
+static inline bool cyclic_work_busy(const struct cyclic_work *work)
+{
+	return work->result == -EINPROGRESS;
+}
+
 #if CONFIG_IS_ENABLED(CYCLIC)
 
 /**
@@ -71,6 +171,14 @@ void cyclic_register(struct cyclic_info *cyclic, cyclic_func_t func,
  */
 void cyclic_unregister(struct cyclic_info *cyclic);
 
+/**
+ * cyclic_defer() - Put off the next call of a cyclic function
+ *
+ * @cyclic: Cyclic function, which must be registered
+ * @delay_us: Time from now until the function is next called
+ */
+void cyclic_defer(struct cyclic_info *cyclic, uint64_t delay_us);
+
 /**
  * cyclic_unregister_all() - Clean up cyclic functions
  *
@@ -98,6 +206,11 @@ static inline void cyclic_unregister(struct cyclic_info *cyclic)
 {
 }
 
+static inline void cyclic_defer(struct cyclic_info *cyclic,
+				uint64_t delay_us)
+{
+}
+
 static inline int cyclic_unregister_all(void)
 {
 	return 0;
@@ -169,10 +169,14 @@ struct dfu_entity {
 	long b_left;
 
 	u32 bad_skip;	/* for nand use */
+	ulong drain_time;	/* ms taken by the last buffer drain */
 
 	unsigned int inited:1;
+	unsigned int defer_drain:1;	/* caller calls dfu_write_drain() */
+	unsigned int drain_pending:1;
 };
 
+struct hash_algo;
 struct list_head;
 extern struct list_head dfu_list;
 
@@ -356,6 +360,21 @@ int dfu_read(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
  */
 int dfu_write(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
 
+/**
+ * dfu_write_drain() - write out a buffer left full by dfu_write()
+ *
+ * When @de->defer_drain is set, dfu_write() does not write a full buffer to
+ * the medium itself but only marks it pending, so that the caller can do the
+ * slow write at a time of its choosing, e.g. outside of a USB completion
+ * handler. This function performs that write; it does nothing if no drain is
+ * pending. The buffer must be drained before the next call to dfu_write(),
+ * which otherwise drains it synchronously.
+ *
+ * @de:			dfu entity
+ * Return:		0 for success, negative value for error
+ */
+int dfu_write_drain(struct dfu_entity *de);
+
 /**
  * dfu_flush() - flush to dfu entity
  *
@@ -436,6 +455,33 @@ static inline void dfu_set_defer_flush(struct dfu_entity *dfu)
 	dfu_defer_flush = dfu;
 }
 
+/*
+ * dfu_defer_drain - pointer to store dfu_entity whose full buffer should be
+ *		     written out by the main loop. It should be NULL when not
+ *		     used.
+ */
+extern struct dfu_entity *dfu_defer_drain;
+
+/**
+ * dfu_get_defer_drain() - get current value of dfu_defer_drain pointer
+ *
+ * Return:	value of the dfu_defer_drain pointer
+ */
+static inline struct dfu_entity *dfu_get_defer_drain(void)
+{
+	return dfu_defer_drain;
+}
+
+/**
+ * dfu_set_defer_drain() - set the dfu_defer_drain pointer
+ *
+ * @dfu:	pointer to the dfu_entity, whose buffer should be drained
+ */
+static inline void dfu_set_defer_drain(struct dfu_entity *dfu)
+{
+	dfu_defer_drain = dfu;
+}
+
 /**
  * dfu_write_from_mem_addr() - write data from memory to DFU managed medium
  *
@@ -450,6 +496,24 @@ static inline void dfu_set_defer_flush(struct dfu_entity *dfu)
  */
 int dfu_write_from_mem_addr(struct dfu_entity *dfu, void *buf, int size);
 
+/**
+ * dfu_write_from_mem_addr_hash() - write data from memory and hash it
+ *
+ * This is the same as dfu_write_from_mem_addr() but also passes each chunk
+ * to @algo before it is written, so that the caller can check the data
+ * without reading it a second time.
+ *
+ * @dfu:	dfu entity to which we want to store data
+ * @buf:	fixed memory address from where data starts
+ * @size:	number of bytes to write
+ * @algo:	hash algorithm to update, or NULL
+ * @ctx:	context from @algo->hash_init()
+ *
+ * Return:	0 on success, other value on failure
+ */
+int dfu_write_from_mem_addr_hash(struct dfu_entity *dfu, void *buf, int size,
+				 struct hash_algo *algo, void *ctx);
+
 /* Device specific */
 /* Each entity has 5 arguments in maximum. */
 #define DFU_MAX_ENTITY_ARGS	5
@@ -578,6 +642,22 @@ int dfu_write_by_name(char *dfu_entity_name, void *addr,
  */
 int dfu_write_by_alt(int dfu_alt_num, void *addr, unsigned int len,
 		     char *interface, char *devstring);
+
+/**
+ * dfu_write_by_alt_hash() - write data to DFU medium and hash it
+ * @dfu_alt_num:	DFU alt setting number
+ * @addr:		Address of data buffer to write
+ * @len:		Number of bytes
+ * @interface:		Destination DFU medium (e.g. "mmc")
+ * @devstring:		Instance number of destination DFU medium (e.g. "1")
+ * @algo:		Hash algorithm to update with the data, or NULL
+ * @ctx:		Context for @algo
+ *
+ * Return:		0 - on success, error code - otherwise
+ */
+int dfu_write_by_alt_hash(int dfu_alt_num, void *addr, unsigned int len,
+			  char *interface, char *devstring,
+			  struct hash_algo *algo, void *ctx);
 #else
 static inline int dfu_write_by_name(char *dfu_entity_name, void *addr,
 				    unsigned int len, char *interface,
@@ -594,6 +674,15 @@ static inline int dfu_write_by_alt(int dfu_alt_num, void *addr,
 	puts("write support for DFU not available!\n");
 	return -ENOSYS;
 }
+
+static inline int dfu_write_by_alt_hash(int dfu_alt_num, void *addr,
+					unsigned int len, char *interface,
+					char *devstring,
+					struct hash_algo *algo, void *ctx)
+{
+	puts("write support for DFU not available!\n");
+	return -ENOSYS;
+}
 #endif
 
 int dfu_add(struct usb_configuration *c);
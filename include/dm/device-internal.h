@@ -192,6 +192,30 @@ int device_of_to_plat(struct udevice *dev);
  */
 int device_probe(struct udevice *dev);
 
+/**
+ * device_probe_begin() - Start probing a device
+ *
+ * This is like device_probe() except that, if the driver has a
+ * probe_finish() method, it is not called. Instead the device is marked with
+ * DM_FLAG_PROBE_PENDING and the probe is completed by device_probe_finish(),
+ * or by the next device_probe() on the device.
+ *
+ * @dev: Pointer to device to probe
+ * Return: 0 if OK, -ve on error
+ */
+int device_probe_begin(struct udevice *dev);
+
+/**
+ * device_probe_finish() - Complete probing a device
+ *
+ * Completes a probe started by device_probe_begin(). This does nothing if the
+ * device does not have a probe pending.
+ *
+ * @dev: Pointer to device to finish probing
+ * Return: 0 if OK, -ve on error, in which case the device is removed
+ */
+int device_probe_finish(struct udevice *dev);
+
 /**
  * device_remove() - Remove a device, de-activating it
  *
@@ -429,6 +453,23 @@ static inline void devres_release_all(struct udevice *dev)
 
 #endif /* DEVRES */
 
+#if CONFIG_IS_ENABLED(DM_HANDOFF)
+/**
+ * dm_handoff_apply() - Mark a device as set up by an earlier phase
+ *
+ * If the earlier phase recorded @dev with dm_handoff_write(), this sets
+ * DM_FLAG_HANDED_OFF on @dev, as well as DM_FLAG_PINCTRL_DONE if the earlier
+ * phase applied its default pinctrl state.
+ *
+ * @dev: Device which has just been bound
+ */
+void dm_handoff_apply(struct udevice *dev);
+#else
+static inline void dm_handoff_apply(struct udevice *dev)
+{
+}
+#endif
+
 static inline int device_notify(const struct udevice *dev, enum event_t type)
 {
 #if CONFIG_IS_ENABLED(DM_EVENT)
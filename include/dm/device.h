@@ -84,6 +84,24 @@ struct driver_info;
 /* Device must be probed after it was bound */
 #define DM_FLAG_PROBE_AFTER_BIND	(1 << 15)
 
+/*
+ * Device probe has been started by device_probe_begin() but its driver's
+ * probe_finish() method has not been called yet. Cleared when it is removed
+ */
+#define DM_FLAG_PROBE_PENDING		(1 << 16)
+
+/*
+ * Device's default pinctrl state is set up, by this phase or an earlier one.
+ * Cleared when it is removed
+ */
+#define DM_FLAG_PINCTRL_DONE		(1 << 17)
+
+/*
+ * An earlier phase probed the device (see CONFIG_DM_HANDOFF), so its
+ * 'assigned-clocks' settings are already applied. Cleared when it is removed
+ */
+#define DM_FLAG_HANDED_OFF		(1 << 18)
+
 /*
  * One or multiple of these flags are passed to device_remove() so that
  * a selective device removal as specified by the remove-stage and the
@@ -166,6 +184,9 @@ enum {
  * @dma_offset: Offset between the physical address space (CPU's) and the
  *		device's bus address space
  * @iommu: IOMMU device associated with this device
+ * @priv_arena_: Block holding @priv_, @uclass_priv_ and @parent_priv_ when
+ *	they are allocated together, else NULL (do not access outside driver
+ *	model)
  */
 struct udevice {
 	const struct driver *driver;
@@ -198,6 +219,9 @@ struct udevice {
 #if CONFIG_IS_ENABLED(IOMMU)
 	struct udevice *iommu;
 #endif
+#if CONFIG_IS_ENABLED(DM_PRIV_ARENA)
+	void *priv_arena_;
+#endif
 };
 
 static inline int dm_udevice_size(void)
@@ -295,10 +319,30 @@ static inline __attribute_const__ bool dev_has_ofnode(const struct udevice *dev)
 #endif
 }
 
+struct uclass;
+
+#if CONFIG_IS_ENABLED(DM_UCLASS_INDEX)
+/**
+ * uclass_index_invalidate() - Drop a uclass' lookup tables
+ *
+ * This must be called when the sequence number, name or ofnode of a device
+ * in the uclass changes, so that lookups see the new value. The tables are
+ * built again on the next lookup.
+ *
+ * @uc: uclass to update, or NULL to do nothing
+ */
+void uclass_index_invalidate(struct uclass *uc);
+#else
+static inline void uclass_index_invalidate(struct uclass *uc)
+{
+}
+#endif
+
 static inline void dev_set_ofnode(struct udevice *dev, ofnode node)
 {
 #if CONFIG_IS_ENABLED(OF_REAL)
 	dev->node_ = node;
+	uclass_index_invalidate(dev->uclass);
 #endif
 }
 
@@ -342,6 +386,11 @@ struct udevice_id {
  * for each.
  * @bind: Called to bind a device to its driver
  * @probe: Called to probe a device, i.e. activate it
+ * @probe_finish: Called to complete probing a device, if not NULL. This lets
+ * a driver split its probe into a part which starts the hardware, in probe(),
+ * and a part which waits for it to settle. Normally it is called straight
+ * after probe(), but the early-probe pass (CONFIG_DM_PROBE_EARLY) starts
+ * other devices in between, so that the waits overlap
  * @remove: Called to remove a device, i.e. de-activate it
  * @unbind: Called to unbind a device from its driver
  * @of_to_plat: Called before probe to decode device tree data
@@ -377,6 +426,7 @@ struct driver {
 	const struct udevice_id *of_match;
 	int (*bind)(struct udevice *dev);
 	int (*probe)(struct udevice *dev);
+	int (*probe_finish)(struct udevice *dev);
 	int (*remove)(struct udevice *dev);
 	int (*unbind)(struct udevice *dev);
 	int (*of_to_plat)(struct udevice *dev);
@@ -17,16 +17,38 @@ typedef u32 phandle;
  *
  * @name: Property name
  * @length: Length of property in bytes
+ * @hash: Hash of @name, from of_prop_hash(), so that a lookup can skip
+ *	properties without comparing their names
  * @value: Pointer to property value
  * @next: Pointer to next property, or NULL if none
  */
 struct property {
 	char *name;
 	int length;
+	u32 hash;
 	void *value;
 	struct property *next;
 };
 
+/**
+ * of_prop_hash() - Get the hash of a property name
+ *
+ * This is a 32-bit FNV-1a hash. It must be stored in the @hash member of
+ * every property in a live tree.
+ *
+ * @name: Property name
+ * Return: hash of @name
+ */
+static inline u32 of_prop_hash(const char *name)
+{
+	u32 hash = 2166136261U;
+
+	while (*name)
+		hash = (hash ^ (u8)*name++) * 16777619U;
+
+	return hash;
+}
+
 /**
  * struct device_node: Device tree node
  *
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Cache of phandle-to-node lookups for the control devicetree
+ */
+
+#ifndef _DM_PHANDLE_CACHE_H
+#define _DM_PHANDLE_CACHE_H
+
+#include <dm/ofnode_decl.h>
+
+struct device_node;
+
+#if CONFIG_IS_ENABLED(OF_PHANDLE_CACHE)
+/**
+ * phandle_cache_find_np() - Look up a phandle in the live tree
+ *
+ * The cache covers only the control devicetree, i.e. gd->of_root. It is
+ * built on first use, once the full malloc() is available.
+ *
+ * @root: Root of the tree to search, NULL for the control tree
+ * @phandle: Phandle to look up
+ * Return: node with that phandle, or NULL if not cached, in which case the
+ * caller must search the tree
+ */
+struct device_node *phandle_cache_find_np(struct device_node *root,
+					  uint phandle);
+
+/**
+ * phandle_cache_find_offset() - Look up a phandle in a flat tree
+ *
+ * The cache covers only the control devicetree, i.e. gd->fdt_blob. It is
+ * built on first use, once the full malloc() is available. Each result is
+ * checked against the blob, so a stale entry is never returned.
+ *
+ * @blob: Flat tree to search
+ * @phandle: Phandle to look up
+ * Return: offset of the node with that phandle, or -ENOENT if not cached, in
+ * which case the caller must search the tree
+ */
+int phandle_cache_find_offset(const void *blob, uint phandle);
+
+/**
+ * phandle_cache_drop() - Drop the cache for a tree
+ *
+ * This must be called before a live tree is freed, so that a new tree
+ * allocated at the same place does not use stale entries.
+ *
+ * @tree: Root node or flat tree whose cache should be dropped
+ */
+void phandle_cache_drop(const void *tree);
+#else
+static inline struct device_node *phandle_cache_find_np(struct device_node *root,
+							uint phandle)
+{
+	return NULL;
+}
+
+static inline int phandle_cache_find_offset(const void *blob, uint phandle)
+{
+	return -ENOENT;
+}
+
+static inline void phandle_cache_drop(const void *tree)
+{
+}
+#endif
+
+#endif
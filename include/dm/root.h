@@ -151,6 +151,44 @@ int dm_init_and_scan(bool pre_reloc_only);
  */
 int dm_autoprobe(void);
 
+/**
+ * dm_probe_early() - Probe devices marked for probe-after-bind, overlapping
+ *
+ * This probes all devices below @parent which have the
+ * DM_FLAG_PROBE_AFTER_BIND flag, including @parent itself. Each device is
+ * started once its parent and the devices it refers to through 'clocks',
+ * 'resets', 'power-domains', 'phys', 'pinctrl-0' and '<name>-supply'
+ * properties are ready. Devices whose driver has a probe_finish() method are
+ * left pending while others are started, so their hardware settles in
+ * parallel. Errors from individual devices are ignored, as with
+ * dm_autoprobe().
+ *
+ * The node property 'u-boot,probe-early' sets DM_FLAG_PROBE_AFTER_BIND when
+ * the device is bound.
+ *
+ * This is used by dm_autoprobe() if CONFIG_DM_PROBE_EARLY is enabled.
+ *
+ * @parent: Device to start from
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+int dm_probe_early(struct udevice *parent);
+
+/**
+ * dm_handoff_write() - Record the devices set up by this phase
+ *
+ * This adds a record to the bloblist for each device which has been probed,
+ * or which an earlier phase handed off, so that the next phase can skip
+ * setting up its pinctrl state and clocks again. Devices are identified by
+ * a hash of their name and the names of their parents, so the next phase must
+ * use the same devicetree.
+ *
+ * This is used by SPL before it jumps to the next phase, if
+ * CONFIG_SPL_DM_HANDOFF is enabled.
+ *
+ * Return: 0 if OK, -ENOSPC if the bloblist is full
+ */
+int dm_handoff_write(void);
+
 /**
  * dm_init() - Initialise Driver Model structures
  *
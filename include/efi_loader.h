@@ -321,6 +321,8 @@ extern const efi_guid_t efi_guid_host_dev;
 #endif
 /* GUID of the EFI_BLOCK_IO_PROTOCOL */
 extern const efi_guid_t efi_block_io_guid;
+/* GUID of the EFI_BLOCK_IO2_PROTOCOL */
+extern const efi_guid_t efi_block_io2_guid;
 extern const efi_guid_t efi_global_variable_guid;
 extern const efi_guid_t efi_guid_console_control;
 extern const efi_guid_t efi_guid_device_path;
@@ -858,6 +860,14 @@ efi_status_t efi_driver_init(void);
 int efi_disk_probe(void *ctx, struct event *event);
 /* Called when a block device is removed */
 int efi_disk_remove(void *ctx, struct event *event);
+#if IS_ENABLED(CONFIG_BLK)
+/* Install the simple file system protocol on a disk handle on first use */
+void efi_disk_fs_probe(efi_handle_t handle);
+#else
+static inline void efi_disk_fs_probe(efi_handle_t handle)
+{
+}
+#endif
 /* Called by board init to initialize the EFI memory map */
 int efi_memory_init(void);
 /* Adds new or overrides configuration table entry to the system table */
@@ -1088,6 +1098,9 @@ bool efi_signature_verify(struct efi_image_regions *regs,
 			  struct pkcs7_message *msg,
 			  struct efi_signature_store *db,
 			  struct efi_signature_store *dbx);
+bool efi_signature_verify_digest(const u8 *digest, struct pkcs7_message *msg,
+				 struct efi_signature_store *db,
+				 struct efi_signature_store *dbx);
 static inline bool efi_signature_verify_one(struct efi_image_regions *regs,
 					    struct pkcs7_message *msg,
 					    struct efi_signature_store *db)
@@ -1110,8 +1123,6 @@ bool efi_secure_boot_enabled(void);
 
 bool efi_capsule_auth_enabled(void);
 
-void *efi_prepare_aligned_image(void *efi, u64 *efi_size);
-
 bool efi_image_parse(void *efi, size_t len, struct efi_image_regions **regp,
 		     WIN_CERTIFICATE **auth, size_t *auth_len);
 
@@ -1145,6 +1156,53 @@ efi_status_t efi_capsule_authenticate(const void *capsule,
 				      efi_uintn_t capsule_size,
 				      void **image, efi_uintn_t *image_size);
 
+/**
+ * struct efi_capsule_auth - State of a capsule authentication in progress
+ *
+ * @sig:		Signature of the capsule
+ * @sig_buf:		Buffer holding @sig, or NULL
+ * @truststore:		Keys trusted to sign capsules
+ * @monotonic_count:	Monotonic count, which is signed after the image
+ */
+struct efi_capsule_auth {
+	struct pkcs7_message *sig;
+	u8 *sig_buf;
+	struct efi_signature_store *truststore;
+	u64 monotonic_count;
+};
+
+/**
+ * efi_capsule_auth_start() - Start authenticating a capsule
+ *
+ * This parses the authentication header of the capsule so that the caller
+ * can hash the image itself, e.g. while writing it, and then call
+ * efi_capsule_auth_finish() with the SHA-256 digest of the image followed by
+ * @auth->monotonic_count.
+ *
+ * @capsule:		Capsule
+ * @capsule_size:	Size of @capsule
+ * @image:		Returns a pointer to the image within @capsule
+ * @image_size:		Returns the size of the image
+ * @auth:		Returns the state of the authentication
+ * Return:		status code
+ */
+efi_status_t efi_capsule_auth_start(const void *capsule,
+				    efi_uintn_t capsule_size, void **image,
+				    efi_uintn_t *image_size,
+				    struct efi_capsule_auth *auth);
+
+/**
+ * efi_capsule_auth_finish() - Finish authenticating a capsule
+ *
+ * @auth:	State from efi_capsule_auth_start(), which is freed
+ * @digest:	SHA-256 digest of the image and the monotonic count, or NULL
+ *		to abandon the authentication
+ * Return:	EFI_SUCCESS if the capsule is authentic, else
+ *		EFI_SECURITY_VIOLATION
+ */
+efi_status_t efi_capsule_auth_finish(struct efi_capsule_auth *auth,
+				     const u8 *digest);
+
 #define EFI_CAPSULE_DIR u"\\EFI\\UpdateCapsule\\"
 
 /**
@@ -145,6 +145,35 @@ struct efi_var_file {
  */
 efi_status_t efi_var_to_file(void);
 
+#if !IS_ENABLED(CONFIG_EFI_MM_COMM_TEE)
+/**
+ * efi_var_batch_start() - start deferring writes of the variable file
+ *
+ * Until the matching efi_var_batch_end() call efi_var_to_file() only records
+ * that the file needs to be written. Calls may be nested.
+ */
+void efi_var_batch_start(void);
+
+/**
+ * efi_var_batch_end() - end deferring writes of the variable file
+ *
+ * When the outermost batch ends, the variable file is written once if any
+ * non-volatile variable was changed in between.
+ *
+ * Return:	status code
+ */
+efi_status_t efi_var_batch_end(void);
+#else
+static inline void efi_var_batch_start(void)
+{
+}
+
+static inline efi_status_t efi_var_batch_end(void)
+{
+	return EFI_SUCCESS;
+}
+#endif
+
 /**
  * efi_var_collect() - collect variables in buffer
  *
@@ -104,6 +104,10 @@ struct expo_theme {
  * type set to EXPOACT_NONE if there is no action
  * @text_mode: true to use text mode for the menu (no vidconsole)
  * @popup: true to use popup menus, instead of showing all items
+ * @redraw: true to redraw the whole display on the next render, even if only
+ *	some objects have changed
+ * @rendered_id: ID of the scene last rendered in full on the display, 0 if
+ *	none
  * @priv: Private data for the controller
  * @theme: Information about fonts styles, etc.
  * @scene_head: List of scenes
@@ -118,6 +122,8 @@ struct expo {
 	struct expo_action action;
 	bool text_mode;
 	bool popup;
+	bool redraw;
+	uint rendered_id;
 	void *priv;
 	struct expo_theme theme;
 	struct list_head scene_head;
@@ -230,6 +236,10 @@ enum {
  * @flags: Flags for this object
  * @bit_length: Number of bits used for this object in CMOS RAM
  * @start_bit: Start bit to use for this object in CMOS RAM
+ * @paint: Area of the display this object covered when it was last rendered
+ *	(empty if hidden), used with CONFIG_EXPO_PARTIAL_RENDER
+ * @sig: Signature of the object's contents when it was last rendered, 0 if
+ *	not yet rendered, used with CONFIG_EXPO_PARTIAL_RENDER
  * @sibling: Node to link this object to its siblings
  */
 struct scene_obj {
@@ -241,6 +251,8 @@ struct scene_obj {
 	u8 flags;
 	u8 bit_length;
 	u16 start_bit;
+	struct scene_dim paint;
+	u32 sig;
 	struct list_head sibling;
 };
 
@@ -472,6 +484,10 @@ int expo_first_scene_id(struct expo *exp);
 /**
  * expo_render() - render the expo on the display / console
  *
+ * With CONFIG_EXPO_PARTIAL_RENDER, only the objects which have changed since
+ * the last render (and any objects which overlap them) are drawn again,
+ * unless the scene has changed or expo_redraw() has been called.
+ *
  * @exp: Expo to render
  *
  * Returns: 0 if OK, -ECHILD if there is no current scene, -ENOENT if the
@@ -479,6 +495,16 @@ int expo_first_scene_id(struct expo *exp);
  */
 int expo_render(struct expo *exp);
 
+/**
+ * expo_redraw() - Redraw the whole display on the next render
+ *
+ * This should be called if something else has drawn on the display since the
+ * expo was last rendered
+ *
+ * @exp: Expo to update
+ */
+void expo_redraw(struct expo *exp);
+
 /**
  * expo_set_text_mode() - Controls whether the expo renders in text mode
  *
@@ -166,6 +166,9 @@ struct ext_filesystem {
 	int curr_inode_no;
 	uint16_t first_pass_ibmap;
 
+	/* Per block group, which bitmaps need writing (EXT4_BMAP_...) */
+	unsigned char *bmaps_dirty;
+
 	/* Journal Related */
 
 	/* Block Device Descriptor */
@@ -178,6 +181,9 @@ struct ext_block_cache {
 	int size;
 };
 
+/* Number of extent tree levels cached by ext4fs_map_blocks() */
+#define EXT4_EXT_CACHE_LEVELS	5
+
 extern struct ext2_data *ext4fs_root;
 extern struct ext2fs_node *ext4fs_file;
 
@@ -210,6 +216,22 @@ int ext4fs_devread(lbaint_t sector, int byte_offset, int byte_len, char *buf);
 void ext4fs_set_blk_dev(struct blk_desc *rbdd, struct disk_partition *info);
 long int read_allocated_block(struct ext2_inode *inode, int fileblock,
 			      struct ext_block_cache *cache);
+/**
+ * ext4fs_map_blocks() - map a run of file blocks to the filesystem
+ *
+ * For files using extents this resolves a whole extent at once, so that
+ * the caller can read it with a single request. Other files are mapped
+ * one block at a time.
+ *
+ * @inode: Inode of the file
+ * @fileblock: First logical block to map
+ * @cache: Extent index block caches, EXT4_EXT_CACHE_LEVELS of them
+ * @count: Returns the number of blocks from @fileblock which are contiguous
+ *	in the filesystem, or which are all part of a hole
+ * Return: filesystem block of @fileblock, 0 for a hole, -ve on error
+ */
+long int ext4fs_map_blocks(struct ext2_inode *inode, int fileblock,
+			   struct ext_block_cache *cache, int *count);
 int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 struct disk_partition *fs_partition);
 int ext4_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
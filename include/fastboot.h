@@ -51,6 +51,7 @@ enum {
 	FASTBOOT_COMMAND_OEM_RUN,
 	FASTBOOT_COMMAND_OEM_CONSOLE,
 	FASTBOOT_COMMAND_OEM_BOARD,
+	FASTBOOT_COMMAND_OEM_STREAM,
 	FASTBOOT_COMMAND_ACMD,
 	FASTBOOT_COMMAND_UCMD,
 	FASTBOOT_COMMAND_COUNT
@@ -163,6 +164,18 @@ int fastboot_handle_command(char *cmd_string, char *response);
  */
 u32 fastboot_data_remaining(void);
 
+/**
+ * fastboot_data_buf() - return where the next downloaded data goes
+ *
+ * A transport can receive data straight into this buffer and then pass it to
+ * fastboot_data_download(), which does not copy it again.
+ *
+ * Return: Pointer into fastboot_buf_addr for the next byte of the current
+ * download, or NULL if the download is streamed to a partition, in which case
+ * data must be passed to fastboot_data_download() in order
+ */
+void *fastboot_data_buf(void);
+
 /**
  * fastboot_data_download() - Copy image data to fastboot_buf_addr.
  *
@@ -172,7 +185,8 @@ u32 fastboot_data_remaining(void);
  *
  * Copies image data from fastboot_data to fastboot_buf_addr. Writes to
  * response. fastboot_bytes_received is updated to indicate the number
- * of bytes that have been transferred.
+ * of bytes that have been transferred. Nothing is copied if the data has been
+ * received in place, at fastboot_data_buf().
  */
 void fastboot_data_download(const void *fastboot_data,
 			    unsigned int fastboot_data_len, char *response);
@@ -31,6 +31,14 @@ struct disk_partition;
 #define FAT16BUFSIZE	(FATBUFSIZE/2)
 #define FAT32BUFSIZE	(FATBUFSIZE/4)
 
+#if CONFIG_IS_ENABLED(FS_FAT)
+#define FAT_CACHE_WINDOWS	CONFIG_VAL(FS_FAT_CACHE_WINDOWS)
+#else
+#define FAT_CACHE_WINDOWS	0
+#endif
+/* fatbuf is followed by FAT_CACHE_WINDOWS cached windows */
+#define FATBUFALLOCSIZE	(FATBUFSIZE * (1 + FAT_CACHE_WINDOWS))
+
 /* Maximum number of entry for long file name according to spec */
 #define MAX_LFN_SLOT	20
 
@@ -176,6 +184,9 @@ typedef struct {
 	__u32	root_cluster;	/* First cluster of root dir for FAT32 */
 	u32	total_sect;	/* Number of sectors */
 	int	fats;		/* Number of FATs */
+	int	fatcache_next;	/* Next cache slot to evict */
+	int	fatcachenum[FAT_CACHE_WINDOWS]; /* Window held by each slot */
+	__u32	fatcache_dirty;	/* Bit n set if slot n is not yet written */
 } fsdata;
 
 struct fat_itr;
@@ -8,6 +8,7 @@
 
 struct blk_desc;
 struct disk_partition;
+struct sparse_storage;
 
 /**
  * fastboot_mmc_get_part_info() - Lookup eMMC partion by name
@@ -32,6 +33,22 @@ int fastboot_mmc_get_part_info(const char *part_name,
  */
 void fastboot_mmc_flash_write(const char *cmd, void *download_buffer,
 			      u32 download_bytes, char *response);
+
+/**
+ * fastboot_mmc_stream_open() - Set up storage for an image written as it
+ * arrives
+ *
+ * The special partitions handled by fastboot_mmc_flash_write(), such as the
+ * GPT and eMMC boot partitions, cannot be used.
+ *
+ * @cmd: Named partition to write image to
+ * @sparse: Returns the storage to pass to sparse_stream_init()
+ * @response: Pointer to fastboot response buffer
+ * Return: 0 if OK, -ve if the partition cannot be used
+ */
+int fastboot_mmc_stream_open(const char *cmd, struct sparse_storage *sparse,
+			     char *response);
+
 /**
  * fastboot_mmc_flash_erase() - Erase eMMC for fastboot
  *
@@ -140,6 +140,67 @@ static inline int fdt_fixup_memory_banks(void *blob, u64 start[], u64 size[],
 #endif
 
 void fdt_fixup_ethernet(void *fdt);
+
+/**
+ * fdt_batch_start() - start a batch of property changes
+ *
+ * Until fdt_batch_finish() is called, fdt_find_and_setprop(),
+ * do_fixup_by_path(), do_fixup_by_prop(), do_fixup_by_compat() and
+ * fdt_batch_setprop() record their changes instead of making them, so that
+ * the tree is rewritten once rather than moved by each change. Reading the
+ * tree shows the old values and node offsets stay valid.
+ *
+ * Other libfdt functions must not change the tree during a batch, with the
+ * exception of fdt_find_or_add_subnode(), which writes out the batch first
+ * if it needs to add a node (so offsets found before it are no longer valid).
+ *
+ * Only one batch may be active at a time.
+ *
+ * @fdt: FDT blob to update
+ * Return: 0 if ok, -FDT_ERR_BADSTATE if a batch is already active, or other
+ *	-FDT_ERR_... if the tree is not valid
+ */
+int fdt_batch_start(void *fdt);
+
+/**
+ * fdt_batch_setprop() - set a property, as part of a batch if one is active
+ *
+ * This is the same as fdt_setprop() if there is no active batch for @fdt
+ *
+ * @fdt: FDT blob to update
+ * @nodeoffset: offset of node
+ * @name: property name
+ * @val: value to set
+ * @len: length of value in bytes
+ * Return: 0 if ok, or -FDT_ERR_... on error
+ */
+int fdt_batch_setprop(void *fdt, int nodeoffset, const char *name,
+		      const void *val, int len);
+
+/**
+ * fdt_batch_flush() - write out the changes in the active batch
+ *
+ * The batch stays active. This does nothing if there is no active batch for
+ * @fdt. Node offsets found before this call are no longer valid.
+ *
+ * @fdt: FDT blob to update
+ * Return: 0 if ok, -FDT_ERR_NOSPACE if the tree has no room for the changes,
+ *	-FDT_ERR_BADSTATE if the tree was changed outside the batch, or other
+ *	-FDT_ERR_... on error
+ */
+int fdt_batch_flush(void *fdt);
+
+/**
+ * fdt_batch_finish() - write out the changes and end the batch
+ *
+ * The batch is ended even if the changes cannot be written.
+ *
+ * @fdt: FDT blob to update
+ * Return: 0 if ok, -FDT_ERR_BADSTATE if there is no active batch for @fdt,
+ *	or as for fdt_batch_flush()
+ */
+int fdt_batch_finish(void *fdt);
+
 int fdt_find_and_setprop(void *fdt, const char *node, const char *prop,
 			 const void *val, int len, int create);
 void fdt_fixup_qe_firmware(void *fdt);
@@ -674,6 +674,18 @@ int fdtdec_get_chosen_node(const void *blob, const char *name);
  */
 const char *fdtdec_get_compatible(enum fdt_compat_id id);
 
+/**
+ * fdtdec_node_offset_by_phandle() - Find the node with a given phandle
+ *
+ * This is fdt_node_offset_by_phandle(), using the phandle cache for the
+ * control devicetree if CONFIG_OF_PHANDLE_CACHE is enabled.
+ *
+ * @blob: FDT blob
+ * @phandle: Phandle to look for
+ * Return: node offset if found, -ve error code on error
+ */
+int fdtdec_node_offset_by_phandle(const void *blob, uint phandle);
+
 /* Look up a phandle and follow it to its node. Then return the offset
  * of that node.
  *
@@ -20,6 +20,7 @@ struct cmd_tbl;
 #define FS_TYPE_SEMIHOSTING 8
 
 struct blk_desc;
+struct disk_partition;
 
 /**
  * do_fat_fsload - Run the fatload command
@@ -78,6 +79,24 @@ void fs_set_type(int type);
  */
 int fs_set_blk_dev_with_part(struct blk_desc *desc, int part);
 
+/**
+ * fs_set_blk_dev_with_part_info() - Set current block device + partition
+ *
+ * Similar to fs_set_blk_dev_with_part(), but uses partition information which
+ * the caller already has, instead of reading the partition table again. This
+ * is useful for callers which access the same filesystem many times.
+ *
+ * @desc: Block device
+ * @part: Partition number, 0 for the whole device
+ * @pinfo: Partition information, e.g. from part_get_info()
+ * @fstype: Filesystem type to probe for (FS_TYPE_...), or FS_TYPE_ANY to try
+ *	all of them
+ * Return: 0 on success, non-zero if no filesystem could be recognised
+ */
+int fs_set_blk_dev_with_part_info(struct blk_desc *desc, int part,
+				  const struct disk_partition *pinfo,
+				  int fstype);
+
 /**
  * fs_close() - Unset current block device and partition
  *
@@ -150,6 +169,24 @@ int fs_size(const char *filename, loff_t *size);
 int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	    loff_t *actread);
 
+/**
+ * fs_read_gunzip() - read a gzipped file and decompress it while reading
+ *
+ * The file is read a chunk at a time, each chunk being decompressed to
+ * @addr before the next is read, so the compressed data never needs a
+ * buffer of its own. The filesystem must support reading at an offset.
+ * With CONFIG_ZSTD, a file holding a single zstd frame is also accepted.
+ *
+ * @filename:	full path of the file to read from
+ * @addr:	address of the buffer to decompress to
+ * @maxlen:	size of the buffer, 0 to use all free memory at @addr
+ * @actread:	returns the number of bytes decompressed
+ * Return:	0 if OK with valid @actread, -ENOSPC if the buffer is too
+ *		small, other -ve on error
+ */
+int fs_read_gunzip(const char *filename, ulong addr, ulong maxlen,
+		   loff_t *actread);
+
 /**
  * fs_write() - write file to the partition previously set by fs_set_blk_dev()
  *
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Directory-entry lookup cache shared by the filesystem drivers
+ */
+
+#ifndef __FS_DCACHE_H
+#define __FS_DCACHE_H
+
+#include <blk.h>
+#include <linux/types.h>
+
+/* Longest path component which is cached */
+#define FS_DCACHE_NAME_LEN	64
+
+/* Space for the filesystem-specific result of a lookup */
+#define FS_DCACHE_DATA_LEN	32
+
+/**
+ * struct fs_dcache_ent - result of looking up one name in one directory
+ *
+ * @dir: Filesystem-specific identifier of the directory that was searched,
+ *	e.g. its first cluster or inode number
+ * @found: true if the name exists in @dir, false for a cached miss
+ * @len: Length of @name
+ * @name: Name that was looked up (not nul-terminated)
+ * @data: Filesystem-specific result, e.g. a copy of the directory entry
+ */
+struct fs_dcache_ent {
+	ulong dir;
+	bool found;
+	u8 len;
+	char name[FS_DCACHE_NAME_LEN];
+	u8 data[FS_DCACHE_DATA_LEN] __aligned(sizeof(ulong));
+};
+
+#if CONFIG_IS_ENABLED(FS_DCACHE)
+/**
+ * fs_dcache_bind() - attach the cache to a mounted filesystem
+ *
+ * Filesystems call this each time they mount, i.e. for every fs_*()
+ * operation. The cache is kept as long as the same filesystem is mounted
+ * again and dropped otherwise, so that lookups are shared across calls.
+ *
+ * @desc: Block device holding the filesystem
+ * @part_start: First block of the partition
+ * @sig: Signature of the filesystem, e.g. a CRC of its superblock, so that
+ *	a media change is noticed
+ */
+void fs_dcache_bind(struct blk_desc *desc, lbaint_t part_start, u32 sig);
+
+/**
+ * fs_dcache_find() - look up a name in the cache
+ *
+ * The cache is dropped first if the device was written to since the
+ * entries were added.
+ *
+ * @dir: Directory being searched
+ * @name: Name to look for
+ * @len: Length of @name
+ * @nocase: true to compare names without regard to case
+ * Return: cache entry, or NULL if the lookup must be done on the media
+ */
+struct fs_dcache_ent *fs_dcache_find(ulong dir, const char *name, int len,
+				     bool nocase);
+
+/**
+ * fs_dcache_add() - record the result of a lookup
+ *
+ * Names longer than FS_DCACHE_NAME_LEN are not recorded.
+ *
+ * @dir: Directory which was searched
+ * @name: Name which was looked for
+ * @len: Length of @name
+ * @found: true if @name was found in @dir
+ * @data: Result to record, if @found
+ * @size: Size of @data, at most FS_DCACHE_DATA_LEN
+ */
+void fs_dcache_add(ulong dir, const char *name, int len, bool found,
+		   const void *data, int size);
+
+/**
+ * fs_dcache_invalidate() - drop all cached lookups
+ *
+ * This also detaches the cache until the next fs_dcache_bind(). Call it
+ * before removing the block device the cache is bound to.
+ */
+void fs_dcache_invalidate(void);
+#else
+static inline void fs_dcache_bind(struct blk_desc *desc, lbaint_t part_start,
+				  u32 sig)
+{
+}
+
+static inline struct fs_dcache_ent *fs_dcache_find(ulong dir,
+						   const char *name, int len,
+						   bool nocase)
+{
+	return NULL;
+}
+
+static inline void fs_dcache_add(ulong dir, const char *name, int len,
+				 bool found, const void *data, int size)
+{
+}
+
+static inline void fs_dcache_invalidate(void)
+{
+}
+#endif
+
+#endif
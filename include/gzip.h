@@ -49,6 +49,43 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 	   int stoponerr, int offset);
 
+struct gunzip_stream;
+
+/**
+ * gunzip_stream_start() - Start decompressing gzipped data piece by piece
+ *
+ * This allows a file to be decompressed while it is still being read, so
+ * that the compressed data never has to be held in memory in one piece.
+ *
+ * @dst: Destination for uncompressed data
+ * @dstlen: Size of destination buffer
+ * Return: stream, or NULL if out of memory
+ */
+struct gunzip_stream *gunzip_stream_start(void *dst, ulong dstlen);
+
+/**
+ * gunzip_stream_feed() - Decompress the next piece of gzipped data
+ *
+ * The first piece must hold the whole gzip header.
+ *
+ * @gz: Stream to use
+ * @src: Compressed data following what was passed in the previous call
+ * @len: Length of data at @src
+ * Return: 1 if the end of the data has been reached, 0 if more is needed,
+ *	-ENOSPC if the destination buffer is full, other -ve on error
+ */
+int gunzip_stream_feed(struct gunzip_stream *gz, const void *src, ulong len);
+
+/**
+ * gunzip_stream_finish() - Check the decompressed data and free the stream
+ *
+ * @gz: Stream to finish
+ * @lenp: Returns the number of bytes written to the destination buffer
+ * Return: 0 if OK, -EIO if the data is incomplete or does not match the
+ *	gzip trailer
+ */
+int gunzip_stream_finish(struct gunzip_stream *gz, ulong *lenp);
+
 /**
  * gzwrite progress indicators: defined weak to allow board-specific
  * overrides:
@@ -22,6 +22,15 @@ struct cmd_tbl;
 #define HASH_MAX_DIGEST_SIZE	32
 #endif
 
+/* Most algorithms hash_block_multi() and the hash command take at once */
+#define HASH_MULTI_MAX		4
+
+/*
+ * Bytes each algorithm hashes in turn in hash_block_multi(), small enough
+ * to stay in the data cache until the last algorithm has seen them
+ */
+#define HASH_MULTI_CHUNK	(16 * 1024)
+
 enum {
 	HASH_FLAG_VERIFY	= 1 << 0,	/* Enable verify mode */
 	HASH_FLAG_ENV		= 1 << 1,	/* Allow env vars */
@@ -120,6 +129,26 @@ int hash_command(const char *algo_name, int flags, struct cmd_tbl *cmdtp,
 int hash_block(const char *algo_name, const void *data, unsigned int len,
 	       uint8_t *output, int *output_size);
 
+/**
+ * hash_block_multi() - Hash a block with several algorithms in one pass
+ *
+ * Each HASH_MULTI_CHUNK bytes of @data are passed to every algorithm in turn
+ * while they are still in the cache, so that a large buffer is only read
+ * from memory once however many digests are needed.
+ *
+ * @algos:	Algorithms to use, which must support progressive hashing
+ * @count:	Number of algorithms, at most HASH_MULTI_MAX
+ * @data:	Data to hash
+ * @len:	Length of data to hash in bytes
+ * @outputs:	Place to put each hash value, each large enough for the digest
+ *		of its algorithm
+ * Return: 0 if ok, -EINVAL if @count is out of range, -EIO if an algorithm
+ * failed
+ */
+int hash_block_multi(struct hash_algo *const algos[], int count,
+		     const void *data, unsigned int len,
+		     uint8_t *const outputs[]);
+
 #endif /* !USE_HOSTCC */
 
 /**
@@ -26,6 +26,14 @@ struct sparse_storage {
 				 lbaint_t blk,
 				 lbaint_t blkcnt);
 
+	/*
+	 * Optional: make the blocks read back as zeroes, more quickly than
+	 * writing them. Returns blkcnt if done.
+	 */
+	lbaint_t	(*erase)(struct sparse_storage *info,
+				 lbaint_t blk,
+				 lbaint_t blkcnt);
+
 	void		(*mssg)(const char *str, char *response);
 };
 
@@ -42,3 +50,97 @@ static inline int is_sparse_image(void *buf)
 
 int write_sparse_image(struct sparse_storage *info, const char *part_name,
 		       void *data, char *response);
+
+enum sparse_stream_state {
+	SPARSE_STREAM_HEADER,
+	SPARSE_STREAM_CHUNK,
+	SPARSE_STREAM_RAW,
+	SPARSE_STREAM_FILL,
+	SPARSE_STREAM_IMAGE,
+	SPARSE_STREAM_DONE,
+	SPARSE_STREAM_ERROR,
+};
+
+/**
+ * struct sparse_stream - state of an image being written as it arrives
+ *
+ * @info: Storage to write to
+ * @part_name: Name of the partition, for messages
+ * @state: What the next bytes are
+ * @header: Sparse image header
+ * @chunk: Header of the current chunk
+ * @hdr_len: Number of bytes of @header, @chunk or @fill_val gathered so far
+ * @skip: Number of bytes to drop before going on in @state
+ * @left: Bytes of data left in the current chunk
+ * @chunk_idx: Number of chunks finished
+ * @blk: Next block to write
+ * @total_blocks: Blocks of the output image written or skipped so far
+ * @bytes_written: Bytes written so far
+ * @fill_val: Value of the current CHUNK_TYPE_FILL chunk
+ * @buf: Buffer collecting data until there are enough blocks to write
+ * @buf_len: Number of bytes in @buf
+ * @buf_size: Size of @buf
+ */
+struct sparse_stream {
+	struct sparse_storage *info;
+	const char *part_name;
+	enum sparse_stream_state state;
+	sparse_header_t header;
+	chunk_header_t chunk;
+	uint hdr_len;
+	uint skip;
+	u64 left;
+	uint chunk_idx;
+	u32 total_blocks;
+	u64 bytes_written;
+	lbaint_t blk;
+	u32 fill_val;
+	void *buf;
+	uint buf_len;
+	uint buf_size;
+};
+
+/**
+ * sparse_stream_init() - start writing an image which arrives in pieces
+ *
+ * The image may be an Android sparse image or a raw one, which is written
+ * from the start of the partition.
+ *
+ * @stream: Stream to set up
+ * @info: Storage to write to
+ * @part_name: Name of the partition, for messages
+ * @response: Response buffer for failure messages
+ * Return: 0 if OK, -ENOMEM if the buffer cannot be allocated
+ */
+int sparse_stream_init(struct sparse_stream *stream,
+		       struct sparse_storage *info, const char *part_name,
+		       char *response);
+
+/**
+ * sparse_stream_write() - write the next piece of an image
+ *
+ * Chunks are parsed and written to storage as their data arrives, so the
+ * whole image never needs to be held in memory. Pieces can be of any size
+ * and need not line up with chunks.
+ *
+ * @stream: Stream from sparse_stream_init()
+ * @data: Next piece of the image
+ * @len: Length of @data
+ * @response: Response buffer for failure messages
+ * Return: 0 if OK, -ve on error, after which the stream only returns errors
+ */
+int sparse_stream_write(struct sparse_stream *stream, const void *data,
+			uint len, char *response);
+
+/**
+ * sparse_stream_finish() - finish writing an image
+ *
+ * This writes out any data still buffered, checks that the whole image was
+ * received and frees the stream's buffer. It must be called even after an
+ * error.
+ *
+ * @stream: Stream from sparse_stream_init()
+ * @response: Response buffer for failure messages
+ * Return: 0 if OK, -ve on error
+ */
+int sparse_stream_finish(struct sparse_stream *stream, char *response);
@@ -380,6 +380,14 @@ struct bootm_headers {
 	const char	*fit_uname_setup; /* x86 setup subimage node name */
 	int		fit_noffset_setup;/* x86 setup subimage node offset */
 
+	/*
+	 * Configuration whose signatures have been checked, so that loading
+	 * the other images of the same configuration does not check them again
+	 */
+	const void	*fit_verified;	/* FIT holding that configuration */
+	int		fit_noffset_verified; /* configuration node offset */
+	uint		fit_size_verified; /* size of the FIT when checked */
+
 #ifndef USE_HOSTCC
 	struct image_info	os;		/* os image info */
 	ulong		ep;		/* entry point of OS */
@@ -943,6 +951,23 @@ phys_size_t env_get_bootm_mapsize(void);
 #endif
 void memmove_wd(void *to, void *from, size_t len, ulong chunksz);
 
+/**
+ * image_copy() - Move image data to its load address
+ *
+ * This behaves like memmove(), but large copies between regions which do not
+ * overlap are handed to a DMA engine when CONFIG_IMAGE_COPY_DMA is enabled.
+ * The CPU does the copy if there is no suitable engine or the transfer fails.
+ *
+ * @to: Destination address
+ * @from: Source address
+ * @len: Number of bytes to copy
+ */
+#ifdef USE_HOSTCC
+#define image_copy(to, from, len)	memmove(to, from, len)
+#else
+void image_copy(void *to, const void *from, size_t len);
+#endif
+
 static inline int image_check_magic(const struct legacy_img_hdr *hdr)
 {
 	return (image_get_magic(hdr) == IH_MAGIC);
@@ -1088,6 +1113,7 @@ int booti_setup(ulong image, ulong *relocated_addr, ulong *size,
 #define FIT_TYPE_PROP		"type"
 #define FIT_OS_PROP		"os"
 #define FIT_COMP_PROP		"compression"
+#define FIT_COMP_DICT_PROP	"compression-dictionary"
 #define FIT_ENTRY_PROP		"entry"
 #define FIT_LOAD_PROP		"load"
 
@@ -1340,6 +1366,135 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 			       const void *key_blob, const void *data,
 			       size_t size);
 
+/**
+ * struct fit_load_hash - hash of an image worked out while it is read
+ *
+ * This lets a loader hash each part of an image as it arrives, rather than
+ * going over the whole image again once it is in memory.
+ *
+ * @noffset:	Offset in the FIT of the hash node being worked out
+ * @algo:	Hash algorithm
+ * @ctx:	Progressive hash context
+ * @done:	true once @value holds the digest of the whole image
+ * @value:	Digest
+ */
+struct fit_load_hash {
+	int noffset;
+	struct hash_algo *algo;
+	void *ctx;
+	bool done;
+	uint8_t value[FIT_MAX_HASH_LEN];
+};
+
+/**
+ * fit_image_hash_start() - Start hashing an image while it is read
+ *
+ * This picks the first hash node of the image which is not ignored.
+ *
+ * @fit:	Pointer to the FIT format image header
+ * @image_noffset: Offset in @fit of the image
+ * @lh:	Returns the hash state
+ * Return: 0 if OK, -ENOENT if the image has no usable hash node, -ENOSYS
+ *	if its algorithm cannot be worked out a piece at a time or there is a
+ *	hash device to use instead
+ */
+int fit_image_hash_start(const void *fit, int image_noffset,
+			 struct fit_load_hash *lh);
+
+/**
+ * fit_image_hash_update() - Add the next part of an image to its hash
+ *
+ * @lh:		Hash state from fit_image_hash_start()
+ * @data:	Data following what was passed in the previous call
+ * @size:	Length of @data
+ * Return: 0 if OK, -ve on error
+ */
+int fit_image_hash_update(struct fit_load_hash *lh, const void *data,
+			  size_t size);
+
+/**
+ * fit_image_hash_finish() - Finish hashing an image
+ *
+ * This must be called once fit_image_hash_start() succeeds, even if the
+ * image could not be read, to free the hash context.
+ *
+ * @lh:		Hash state from fit_image_hash_start()
+ * Return: 0 if OK, -ve on error
+ */
+int fit_image_hash_finish(struct fit_load_hash *lh);
+
+/**
+ * fit_image_verify_loaded() - Verify an image hashed while it was read
+ *
+ * This is fit_image_verify_with_data(), except that the hash in @lh is
+ * used rather than going over the data again for that hash node.
+ *
+ * @fit:	Pointer to the FIT format image header
+ * @image_noffset: Offset in @fit of image to verify
+ * @key_blob:	FDT containing public keys
+ * @data:	Image data to verify
+ * @size:	Size of image data
+ * @lh:		Hash worked out while reading, or NULL if none
+ * Return: 1 if the image is valid, 0 otherwise
+ */
+int fit_image_verify_loaded(const void *fit, int image_noffset,
+			    const void *key_blob, const void *data,
+			    size_t size, const struct fit_load_hash *lh);
+
+#define FIT_VERIFIED_ALGO_LEN	16
+
+/**
+ * enum fit_verified_status - State of a record of a checked image
+ *
+ * @FIT_VERIFIED_OK: The image hash matched and the record has not been used
+ * @FIT_VERIFIED_USED: The record was used to skip a hash check, so it cannot
+ *	be used again
+ */
+enum fit_verified_status {
+	FIT_VERIFIED_OK		= 1,
+	FIT_VERIFIED_USED,
+};
+
+/**
+ * struct fit_verified - Record of an image whose hash has been checked
+ *
+ * An array of these is held in the bloblist, with the tag
+ * BLOBLISTT_U_BOOT_FIT_VERIFIED, so that a later phase can use an image which
+ * is still in memory without hashing it again. See FIT_VERIFIED_HANDOFF
+ *
+ * @addr:	Address of the image data
+ * @size:	Size of the image data in bytes
+ * @algo:	Hash algorithm, e.g. "sha256" (nul-terminated)
+ * @value_len:	Length of @value in bytes
+ * @status:	Status of the record (enum fit_verified_status)
+ * @value:	Hash value which the image matched
+ */
+struct fit_verified {
+	uint64_t addr;
+	uint64_t size;
+	char algo[FIT_VERIFIED_ALGO_LEN];
+	uint32_t value_len;
+	uint32_t status;
+	uint8_t value[FIT_MAX_HASH_LEN];
+};
+
+/**
+ * fit_verified_add() - Record that an image matched its hash
+ *
+ * This is done automatically in xPL phases when FIT_VERIFIED_HANDOFF is
+ * enabled.
+ *
+ * @data:	Image data
+ * @size:	Size of image data
+ * @algo:	Hash algorithm
+ * @value:	Hash value which the image matched
+ * @value_len:	Length of @value in bytes
+ * Return: 0 if OK, -ENOSYS if not enabled, -E2BIG if the algorithm name or
+ *	value is too long, -ENOSPC if the bloblist is full
+ */
+int fit_verified_add(const void *data, size_t size, const char *algo,
+		     const uint8_t *value, int value_len);
+
 int fit_image_verify(const void *fit, int noffset);
 #if CONFIG_IS_ENABLED(FIT_SIGNATURE)
 int fit_config_verify(const void *fit, int conf_noffset);
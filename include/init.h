@@ -280,6 +280,25 @@ void arch_setup_gd(struct global_data *gd_ptr);
 void board_init_r(struct global_data *id, ulong dest_addr)
 	__attribute__ ((noreturn));
 
+/**
+ * board_reenter() - Restart U-Boot proper without resetting the SoC
+ *
+ * This removes all devices, puts back the copy of U-Boot taken when
+ * board_init_r() first started and runs board_init_r() again, keeping the
+ * global data and everything reserved by board_init_f().
+ *
+ * Return: -ENOSYS if CONFIG_REENTER is not enabled, otherwise does not return
+ */
+int board_reenter(void);
+
+/**
+ * arch_reenter_r() - Call board_init_r() on a fresh stack
+ *
+ * This resets the stack pointer to where it was when board_init_r() was first
+ * called, then calls board_init_r() again.
+ */
+void arch_reenter_r(void) __attribute__ ((noreturn));
+
 int cpu_init_r(void);
 int mac_read_from_eeprom(void);
 
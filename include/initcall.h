@@ -24,6 +24,9 @@ typedef int (*init_fnc_t)(void);
 
 #define INITCALL_EVENT(_type)	(void *)((_type) | INITCALL_IS_EVENT)
 
+/* Runs the finish phase of every initcall deferred so far (see below) */
+#define INITCALL_SYNC		INITCALL_EVENT(EVT_NONE)
+
 /**
  * initcall_run_list() - Run through a list of function calls
  *
@@ -35,4 +38,29 @@ typedef int (*init_fnc_t)(void);
  */
 int initcall_run_list(const init_fnc_t init_sequence[]);
 
+/**
+ * initcall_defer() - Run the second phase of an initcall later
+ *
+ * An initcall which mostly waits for hardware (e.g. for a link to come up) can
+ * start the hardware, then call this so that @finish is called later, leaving
+ * the following initcalls to run in the meantime. Deferred functions are
+ * called in order, at the next INITCALL_SYNC in the init sequence, when
+ * initcall_sync() is called, or at the end of the sequence.
+ *
+ * @name: Name to use for bootstage and error reports
+ * @finish: Function to call
+ * Return: 0 if OK, -ENOSPC if too many functions are already deferred
+ */
+int initcall_defer(const char *name, init_fnc_t finish);
+
+/**
+ * initcall_sync() - Run all deferred initcall phases now
+ *
+ * An initcall which needs something set up by a deferred phase should call
+ * this first, to declare the dependency.
+ *
+ * Return: 0 if OK, or -ve error code from the first failure
+ */
+int initcall_sync(void);
+
 #endif
@@ -35,6 +35,33 @@ struct iotrace_record {
 	iovalue_t value;
 };
 
+enum {
+	IOTRACE_STATS_SHIFT	= 12,	/* Stats are kept per 4KiB region */
+	IOTRACE_STATS_REGIONS	= 32,	/* Max. number of regions with stats */
+	IOTRACE_HIST_BUCKETS	= 8,	/* <125ns, <250ns ... <8us, >=8us */
+};
+
+/**
+ * struct iotrace_stats - Access counts and latencies for one region
+ *
+ * @base: Address of the region
+ * @count: Number of accesses
+ * @polls: Number of reads of the same address as the previous access, which
+ *	usually means a loop waiting for a status bit
+ * @total_ns: Total time taken by the accesses, in nanoseconds
+ * @max_ns: Longest time taken by an access, in nanoseconds
+ * @hist: Number of accesses in each latency range, starting with <125ns and
+ *	doubling each time
+ */
+struct iotrace_stats {
+	ulong base;
+	ulong count;
+	ulong polls;
+	u64 total_ns;
+	u32 max_ns;
+	ulong hist[IOTRACE_HIST_BUCKETS];
+};
+
 /*
  * This file is designed to be included in arch/<arch>/include/asm/io.h.
  * It redirects all IO access through a tracing/checksumming feature for
@@ -140,6 +167,36 @@ int iotrace_get_enabled(void);
  */
 void iotrace_set_buffer(ulong start, ulong size);
 
+/**
+ * iotrace_set_ring() - Set whether the iotrace buffer is a ring
+ *
+ * In a ring, once the buffer is full the oldest records are overwritten, so
+ * that it always holds the latest accesses
+ *
+ * @ring: true to use the buffer as a ring, false to stop when it is full
+ */
+void iotrace_set_ring(bool ring);
+
+/**
+ * iotrace_get_record() - Get a record from the iotrace buffer
+ *
+ * @n: Record number, 0 for the oldest
+ * Return: record, or NULL if there is no such record
+ */
+struct iotrace_record *iotrace_get_record(ulong n);
+
+/**
+ * iotrace_get_stats() - Get the access counts and latencies
+ *
+ * These are kept for each 4KiB region which is accessed, for as many
+ * regions as fit in the table. They are reset by iotrace_set_buffer().
+ *
+ * @countp: Returns the number of regions
+ * @droppedp: Returns the number of accesses to regions which did not fit
+ * Return: list of regions, most total time first
+ */
+const struct iotrace_stats *iotrace_get_stats(int *countp, ulong *droppedp);
+
 /**
  * iotrace_get_buffer() - Get buffer information
  *
@@ -148,7 +205,8 @@ void iotrace_set_buffer(ulong start, ulong size);
  * @needed_size: Returns needed size of buffer in bytes
  * @offset: Returns the byte offset where the next output trace record will
  * @count: Returns the number of trace records recorded
- * be written (or would be if the buffer was large enough)
+ * be written (or would be if the buffer was large enough). In a ring which
+ * has wrapped, this is the number of records in the buffer.
  */
 void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *offset, ulong *count);
 
@@ -35,6 +35,59 @@ struct irq {
 	ulong flags;
 };
 
+/**
+ * typedef irq_handler_t - Function called when an interrupt is raised
+ *
+ * This is called from the interrupt vector, with interrupts disabled, so it
+ * should do as little as possible, e.g. clear the interrupt in the device and
+ * mark some work as complete
+ *
+ * @irq: Interrupt that was raised
+ * @ctx: Context pointer passed to irq_set_handler()
+ */
+typedef void (*irq_handler_t)(struct irq *irq, void *ctx);
+
+/* Number of handlers which can be set on each interrupt controller */
+#define IRQ_MAX_HANDLERS	16
+
+/**
+ * struct irq_handler_entry - A handler set up with irq_set_handler()
+ *
+ * @irq: Interrupt being handled
+ * @handler: Function to call, or NULL if this entry is free
+ * @ctx: Context pointer to pass to @handler
+ */
+struct irq_handler_entry {
+	struct irq irq;
+	irq_handler_t handler;
+	void *ctx;
+};
+
+/**
+ * struct irq_uc_priv - Uclass information for an interrupt controller
+ *
+ * @handlers: Handlers set up on this controller
+ * @count: Number of interrupts handled
+ * @unhandled: Number of interrupts raised with no handler
+ */
+struct irq_uc_priv {
+	struct irq_handler_entry handlers[IRQ_MAX_HANDLERS];
+	ulong count;
+	ulong unhandled;
+};
+
+/**
+ * struct irq_completion - Records that a device has finished some work
+ *
+ * Use irq_complete() as the handler for the device's interrupt, then wait with
+ * irq_wait_completion()
+ *
+ * @done: true once the interrupt has been raised
+ */
+struct irq_completion {
+	bool done;
+};
+
 /**
  * struct irq_ops - Operations for the IRQ
  *
@@ -124,6 +177,36 @@ struct irq_ops {
 	 * @return 0 if OK, or a negative error code.
 	 */
 	int (*free)(struct irq *irq);
+	/**
+	 * set_enable() - Enable or disable an interrupt
+	 *
+	 * This is used when a handler is set or cleared, so that the
+	 * controller passes the interrupt to the CPU
+	 *
+	 * @irq:	Interrupt to update
+	 * @enable:	true to enable, false to disable
+	 * @return 0 if OK, or a negative error code
+	 */
+	int (*set_enable)(struct irq *irq, bool enable);
+	/**
+	 * ack() - Acknowledge the highest-priority pending interrupt
+	 *
+	 * The interrupt becomes active, so it is not raised again until
+	 * eoi() is called
+	 *
+	 * @dev:	Interrupt controller
+	 * @idp:	Returns the ID of the interrupt
+	 * @return 0 if OK, -ENOENT if no interrupt is pending
+	 */
+	int (*ack)(struct udevice *dev, ulong *idp);
+	/**
+	 * eoi() - Signal the end of an interrupt
+	 *
+	 * @dev:	Interrupt controller
+	 * @id:		ID returned by ack()
+	 * @return 0 if OK, or a negative error code
+	 */
+	int (*eoi)(struct udevice *dev, ulong id);
 
 #if CONFIG_IS_ENABLED(ACPIGEN)
 	/**
@@ -309,4 +392,92 @@ int irq_first_device_type(enum irq_dev_t type, struct udevice **devp);
  */
 int irq_get_acpi(const struct irq *irq, struct acpi_irq *acpi_irq);
 
+/**
+ * irq_set_handler() - Set a function to call when an interrupt is raised
+ *
+ * This records the handler and enables the interrupt in its controller. The
+ * CPU only takes the interrupt once interrupts are enabled with
+ * enable_interrupts(). Until then, irq_wait_completion() polls for it.
+ *
+ * @irq:	Interrupt to handle, e.g. from irq_get_by_index()
+ * @handler:	Function to call
+ * @ctx:	Context pointer to pass to @handler
+ * Return: 0 if OK, -ENOSPC if the controller has no free handler slots,
+ *	-ENOSYS if it cannot dispatch interrupts, other -ve on error
+ */
+int irq_set_handler(struct irq *irq, irq_handler_t handler, void *ctx);
+
+/**
+ * irq_clear_handler() - Stop handling an interrupt
+ *
+ * This disables the interrupt and removes its handler
+ *
+ * @irq:	Interrupt passed to irq_set_handler()
+ * Return: 0 if OK, -ENOENT if there is no handler, other -ve on error
+ */
+int irq_clear_handler(struct irq *irq);
+
+/**
+ * irq_handle() - Handle all pending interrupts on a controller
+ *
+ * Each pending interrupt is passed to its handler. An interrupt with no
+ * handler is disabled, so that it cannot be raised again.
+ *
+ * @dev:	Interrupt controller
+ * Return: number of interrupts handled, or -ENOSYS if the controller cannot
+ *	dispatch interrupts
+ */
+int irq_handle(struct udevice *dev);
+
+/**
+ * irq_handle_all() - Handle all pending interrupts
+ *
+ * This is called from the CPU's interrupt vector. It checks each active
+ * interrupt controller which can dispatch interrupts.
+ *
+ * Return: number of interrupts handled, or -ENODEV if there is no controller
+ */
+int irq_handle_all(void);
+
+/**
+ * irq_completion_init() - Set up a completion before starting some work
+ *
+ * @comp:	Completion to set up
+ */
+static inline void irq_completion_init(struct irq_completion *comp)
+{
+	comp->done = false;
+}
+
+/**
+ * irq_complete() - Handler which marks a completion as done
+ *
+ * Pass this to irq_set_handler() with the completion as @ctx
+ *
+ * @irq:	Interrupt that was raised
+ * @ctx:	Pointer to struct irq_completion
+ */
+void irq_complete(struct irq *irq, void *ctx);
+
+/**
+ * irq_wait_completion() - Wait for a completion to be marked as done
+ *
+ * This sleeps until an interrupt arrives if the architecture can, otherwise
+ * it polls the interrupt controllers. Cyclic functions are run while waiting.
+ *
+ * @comp:	Completion to wait for
+ * @timeout_ms:	Time to wait in milliseconds
+ * Return: 0 if OK, -ETIMEDOUT if @comp was not done in time
+ */
+int irq_wait_completion(struct irq_completion *comp, ulong timeout_ms);
+
+/**
+ * arch_irq_wait() - Wait a short time for an interrupt to arrive
+ *
+ * The default implementation calls irq_handle_all(), so that interrupts are
+ * polled. An architecture which takes interrupts can instead sleep until
+ * one arrives, but must wake up often enough to notice a timeout.
+ */
+void arch_irq_wait(void);
+
 #endif
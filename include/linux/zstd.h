@@ -455,4 +455,57 @@ struct abuf;
  */
 int zstd_decompress(struct abuf *in, struct abuf *out);
 
+/**
+ * zstd_decompress_dict() - Decompress Zstandard data using a dictionary
+ *
+ * The workspace used for decompression is kept for the next call once
+ * U-Boot has relocated, rather than being allocated each time.
+ *
+ * @in: Input buffer to decompress
+ * @out: Output buffer to hold the results (must be large enough)
+ * @dict: Dictionary which the data was compressed with, either a zstd
+ *	dictionary or raw content, or NULL for none
+ * Return: size of the decompressed data, or -ve on error
+ */
+int zstd_decompress_dict(struct abuf *in, struct abuf *out,
+			 const struct abuf *dict);
+
+struct zstd_stream;
+
+/**
+ * zstd_stream_start() - Start decompressing Zstandard data piece by piece
+ *
+ * This allows a file to be decompressed while it is still being read, so
+ * that the compressed data never has to be held in memory in one piece. The
+ * data must be a single frame.
+ *
+ * @dst: Destination for uncompressed data
+ * @dstlen: Size of destination buffer
+ * Return: stream, or NULL if out of memory
+ */
+struct zstd_stream *zstd_stream_start(void *dst, ulong dstlen);
+
+/**
+ * zstd_stream_feed() - Decompress the next piece of Zstandard data
+ *
+ * The first piece must hold the whole frame header. The workspace needed for
+ * the frame's window is allocated then.
+ *
+ * @zs: Stream to use
+ * @src: Compressed data following what was passed in the previous call
+ * @len: Length of data at @src
+ * Return: 1 if the end of the frame has been reached, 0 if more is needed,
+ *	-ENOSPC if the destination buffer is full, other -ve on error
+ */
+int zstd_stream_feed(struct zstd_stream *zs, const void *src, ulong len);
+
+/**
+ * zstd_stream_finish() - Finish decompressing and free the stream
+ *
+ * @zs: Stream to finish
+ * @lenp: Returns the number of bytes written to the destination buffer
+ * Return: 0 if OK, -EIO if the frame is incomplete
+ */
+int zstd_stream_finish(struct zstd_stream *zs, ulong *lenp);
+
 #endif  /* LINUX_ZSTD_H */
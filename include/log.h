@@ -442,6 +442,17 @@ struct log_driver {
 	 * for processing. The filter is checked before calling this function.
 	 */
 	int (*emit)(struct log_device *ldev, struct log_rec *rec);
+
+	/**
+	 * @emit_fmt: emit a log record without formatting it
+	 *
+	 * This is optional. If present it is called instead of @emit, with
+	 * @rec->msg set to NULL, so the driver can store the format string
+	 * and arguments and leave formatting until later. The filter is
+	 * checked before calling this function.
+	 */
+	int (*emit_fmt)(struct log_device *ldev, struct log_rec *rec,
+			const char *fmt, va_list args);
 	unsigned short flags;
 };
 
@@ -520,6 +531,16 @@ struct log_filter {
 #define LOG_GET_DRIVER(__name)						\
 	ll_entry_get(struct log_driver, __name, log_driver)
 
+/**
+ * log_binary_show() - Show the contents of the binary log
+ *
+ * This formats and prints each record held by the binary log driver, oldest
+ * first
+ *
+ * Return: 0 if OK, -ENOENT if the log has not been set up
+ */
+int log_binary_show(void);
+
 /**
  * log_get_cat_name() - Get the name of a category
  *
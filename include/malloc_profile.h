@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Heap usage for each allocation site
+ *
+ * Each place which calls malloc() and friends gets an entry recording how
+ * much it allocates and for how long. This shows which callers need the
+ * space in the early and full heaps, so that they can be sized to fit.
+ */
+
+#ifndef __MALLOC_PROFILE_H
+#define __MALLOC_PROFILE_H
+
+#include <linux/errno.h>
+#include <linux/types.h>
+
+/* Version of struct malloc_profile and the sites which follow it */
+#define MALLOC_PROFILE_VERSION	1
+
+/**
+ * struct malloc_profile_site - heap usage of one caller
+ *
+ * Lifetimes are measured as the number of allocations made, by anyone,
+ * between an allocation and its free, since no timer can be used from
+ * within malloc().
+ *
+ * @caller: Link address of the code which called the allocator (low 32
+ *	bits); on sandbox this is the offset from the start of the image
+ * @count: Number of successful allocations
+ * @failed: Number of allocations which failed
+ * @frees: Number of those allocations which have been freed
+ * @live: Number of bytes currently held
+ * @peak: Largest number of bytes held at once
+ * @total: Number of bytes allocated in total
+ * @lifetime: Sum of the lifetimes of the allocations which were freed
+ * @spare: Reserved, must be 0
+ */
+struct malloc_profile_site {
+	u32 caller;
+	u32 count;
+	u32 failed;
+	u32 frees;
+	u32 live;
+	u32 peak;
+	u32 total;
+	u32 lifetime;
+	u32 spare;
+};
+
+/**
+ * struct malloc_profile - heap usage of one phase of U-Boot
+ *
+ * This is followed by @max_sites sites, of which the first @num_sites are
+ * used, then by a hash table of 2 * @max_sites u16 values, each 0 if empty
+ * or one more than the index of a site. With a bloblist, it is stored in a
+ * BLOBLISTT_U_BOOT_MALLOC_PROFILE or BLOBLISTT_U_BOOT_SPL_MALLOC_PROFILE
+ * blob.
+ *
+ * @version: MALLOC_PROFILE_VERSION
+ * @max_sites: Number of sites there is space for
+ * @num_sites: Number of sites in use
+ * @seq: Number of allocations seen
+ * @dropped: Number of allocations by callers which did not fit in the table
+ * @untracked: Number of allocations which could not be tracked until freed
+ */
+struct malloc_profile {
+	u32 version;
+	u32 max_sites;
+	u32 num_sites;
+	u32 seq;
+	u32 dropped;
+	u32 untracked;
+	struct malloc_profile_site site[];
+};
+
+/* Size of a table with space for @max_sites sites, in bytes */
+#define MALLOC_PROFILE_SIZE(max_sites) \
+	(sizeof(struct malloc_profile) + (max_sites) * \
+	 (sizeof(struct malloc_profile_site) + 2 * sizeof(u16)))
+
+/**
+ * malloc_profile_index() - get the hash table of a table
+ *
+ * @prof: Table
+ * Return: hash table, which follows the sites
+ */
+static inline u16 *malloc_profile_index(struct malloc_profile *prof)
+{
+	return (u16 *)&prof->site[prof->max_sites];
+}
+
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE)
+/**
+ * malloc_profile_alloc() - record an allocation
+ *
+ * @ptr: Memory that was allocated, or NULL if the allocation failed
+ * @size: Number of bytes requested
+ * @caller: Return address of the call to the allocator
+ */
+void malloc_profile_alloc(void *ptr, size_t size, void *caller);
+
+/**
+ * malloc_profile_free() - record that memory was freed
+ *
+ * This does nothing if @ptr was not tracked.
+ *
+ * @ptr: Memory which is being freed
+ */
+void malloc_profile_free(void *ptr);
+
+/**
+ * malloc_profile_get() - get the table for the current phase
+ *
+ * Return: table, or NULL if nothing has been recorded yet
+ */
+struct malloc_profile *malloc_profile_get(void);
+
+/**
+ * malloc_profile_stash() - pass the table on to the next phase
+ *
+ * If the table is not already in the bloblist, this copies it there.
+ *
+ * Return: 0 if OK, -ENOENT if there is no table, -ENOSPC if the bloblist
+ *	is full, -ENOSYS if there is no bloblist
+ */
+int malloc_profile_stash(void);
+#else
+static inline void malloc_profile_alloc(void *ptr, size_t size, void *caller)
+{
+}
+
+static inline void malloc_profile_free(void *ptr)
+{
+}
+
+static inline struct malloc_profile *malloc_profile_get(void)
+{
+	return NULL;
+}
+
+static inline int malloc_profile_stash(void)
+{
+	return -ENOSYS;
+}
+#endif
+
+/**
+ * malloc_profile_show() - show a table of allocation sites
+ *
+ * @prof: Table to show
+ */
+void malloc_profile_show(const struct malloc_profile *prof);
+
+#endif
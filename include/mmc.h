@@ -68,6 +68,8 @@ struct bd_info;
 #define MMC_CAP_NONREMOVABLE	BIT(14)
 #define MMC_CAP_NEEDS_POLL	BIT(15)
 #define MMC_CAP_CD_ACTIVE_HIGH  BIT(16)
+#define MMC_CAP_NO_CMD23	BIT(17)	/* host stops transfers by itself */
+#define MMC_CAP_SG		BIT(18)	/* host takes scatter-gather lists */
 
 #define MMC_MODE_8BIT		BIT(30)
 #define MMC_MODE_4BIT		BIT(29)
@@ -75,12 +77,17 @@ struct bd_info;
 #define MMC_MODE_SPI		BIT(27)
 
 #define SD_DATA_4BIT	0x00040000
+#define SD_SCR_CMD23_SUPPORT	BIT(1)	/* SET_BLOCK_COUNT is supported */
 
 #define IS_SD(x)	((x)->version & SD_VERSION_SD)
 #define IS_MMC(x)	((x)->version & MMC_VERSION_MMC)
 
 #define MMC_DATA_READ		1
 #define MMC_DATA_WRITE		2
+#define MMC_DATA_SG		4	/* use @sg instead of @dest / @src */
+
+/* Maximum number of segments in a scatter-gather transfer */
+#define MMC_MAX_SG		16
 
 #define MMC_CMD_GO_IDLE_STATE		0
 #define MMC_CMD_SEND_OP_COND		1
@@ -223,6 +230,7 @@ static inline bool mmc_is_tuning_cmd(uint cmdidx)
 #define EXT_CSD_ERASE_GROUP_DEF		175	/* R/W */
 #define EXT_CSD_BOOT_BUS_WIDTH		177
 #define EXT_CSD_PART_CONF		179	/* R/W */
+#define EXT_CSD_ERASED_MEM_CONT		181	/* RO */
 #define EXT_CSD_BUS_WIDTH		183	/* R/W */
 #define EXT_CSD_STROBE_SUPPORT		184	/* R/W */
 #define EXT_CSD_HS_TIMING		185	/* R/W */
@@ -445,6 +453,35 @@ struct mmc_data {
 	uint flags;
 	uint blocks;
 	uint blocksize;
+	/* only valid when MMC_DATA_SG is set in @flags */
+	const struct blk_sg *sg;
+	uint sg_count;
+};
+
+struct blk_request;
+
+/**
+ * struct mmc_async - an asynchronous read in progress on an MMC device
+ *
+ * @req:	Block request being handled, NULL if none
+ * @data:	Data of the command in flight
+ * @start:	First block of the next command
+ * @left:	Number of blocks not yet read
+ * @dst:	Buffer position of the next command
+ * @b_max:	Maximum number of blocks in one command
+ * @predefined:	true if the command in flight was announced with CMD23
+ * @stepping:	true while commands are sent to move the request on, so that
+ *		they do not wait for the request itself
+ */
+struct mmc_async {
+	struct blk_request *req;
+	struct mmc_data data;
+	lbaint_t start;
+	lbaint_t left;
+	void *dst;
+	uint b_max;
+	bool predefined;
+	bool stepping;
 };
 
 /* forward decl. */
@@ -514,6 +551,27 @@ struct dm_mmc_ops {
 	int (*execute_tuning)(struct udevice *dev, uint opcode);
 #endif
 
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+	/**
+	 * get_tuning() - read back the result of the last tuning
+	 *
+	 * @dev:	Device that was tuned
+	 * @valp:	Returns a driver-specific value describing the result,
+	 *		e.g. the selected tap or phase
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*get_tuning)(struct udevice *dev, u32 *valp);
+
+	/**
+	 * set_tuning() - apply a result previously read with get_tuning()
+	 *
+	 * @dev:	Device to set up
+	 * @val:	Value from get_tuning(), for the current mode
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*set_tuning)(struct udevice *dev, u32 val);
+#endif
+
 	/**
 	 * wait_dat0() - wait until dat0 is in the target state
 	 *		(CLK must be running during the wait)
@@ -560,6 +618,34 @@ struct dm_mmc_ops {
 	 * @return 0 if success, -ve on error
 	 */
 	int (*hs400_prepare_ddr)(struct udevice *dev);
+
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	/**
+	 * send_cmd_async() - Send a data command without waiting for the data
+	 *
+	 * This sends the command and waits for its response, then returns
+	 * with the data transfer still running. poll_data() is used to wait
+	 * for it.
+	 *
+	 * @dev:	Device to receive the command
+	 * @cmd:	Command to send
+	 * @data:	Data to receive, which must stay valid until poll_data()
+	 *		returns something other than -EBUSY
+	 * @return 0 if OK, -ENOSYS if the transfer cannot run in the
+	 * background, other -ve on error
+	 */
+	int (*send_cmd_async)(struct udevice *dev, struct mmc_cmd *cmd,
+			      struct mmc_data *data);
+
+	/**
+	 * poll_data() - Check for completion of a background data transfer
+	 *
+	 * @dev:	Device with a transfer started by send_cmd_async()
+	 * @data:	Data passed to send_cmd_async()
+	 * @return 0 if complete, -EBUSY if still running, other -ve on error
+	 */
+	int (*poll_data)(struct udevice *dev, struct mmc_data *data);
+#endif
 };
 
 #define mmc_get_ops(dev)        ((struct dm_mmc_ops *)(dev)->driver->ops)
@@ -577,6 +663,9 @@ int mmc_reinit(struct mmc *mmc);
 int mmc_get_b_max(struct mmc *mmc, void *dst, lbaint_t blkcnt);
 int mmc_hs400_prepare_ddr(struct mmc *mmc);
 int mmc_send_stop_transmission(struct mmc *mmc, bool write);
+int mmc_send_cmd_async(struct mmc *mmc, struct mmc_cmd *cmd,
+		       struct mmc_data *data);
+int mmc_poll_data(struct mmc *mmc, struct mmc_data *data);
 
 #else
 struct mmc_ops {
@@ -678,6 +767,75 @@ static inline bool supports_uhs(uint caps)
  *
  * TODO struct mmc should be in mmc_private but it's hard to fix right now
  */
+/* Number of controllers described in struct mmc_handoff */
+#define MMC_HANDOFF_CARDS	4
+
+/**
+ * struct mmc_handoff - card state passed from SPL to U-Boot proper
+ *
+ * This is stored under BLOBLISTT_U_BOOT_MMC_HANDOFF by SPL for each card it
+ * initialises. The card is left selected and in transfer mode, using the
+ * recorded bus mode, width and signal voltage.
+ *
+ * @count: Number of valid entries in @card
+ * @card: Card state for each controller
+ * @card.seq: Sequence number of the MMC controller, or -1 once used
+ * @card.version: Card version (SD_VERSION_... or MMC_VERSION_...)
+ * @card.ocr: Operating conditions register
+ * @card.rca: Relative card address
+ * @card.high_capacity: 1 if the card uses block addressing
+ * @card.cmd23: 1 if the card supports SET_BLOCK_COUNT
+ * @card.cid: Card identification register
+ * @card.csd: Card-specific data register
+ * @card.scr: SD configuration register (SD cards only)
+ * @card.card_caps: Modes and widths supported by the card (MMC_CAP...)
+ * @card.mode: Bus mode in use (enum bus_mode)
+ * @card.bus_width: Bus width in use: 1, 4 or 8
+ * @card.voltage: Signal voltage in use (enum mmc_voltage)
+ */
+struct mmc_handoff {
+	u32 count;
+	struct {
+		u32 seq;
+		u32 version;
+		u32 ocr;
+		u32 rca;
+		u32 high_capacity;
+		u32 cmd23;
+		u32 cid[4];
+		u32 csd[4];
+		u32 scr[2];
+		u32 card_caps;
+		u32 mode;
+		u32 bus_width;
+		u32 voltage;
+	} card[MMC_HANDOFF_CARDS];
+};
+
+/* Number of tuning results kept in struct mmc_tuning_cache */
+#define MMC_TUNING_CACHE_SIZE	8
+
+/**
+ * struct mmc_tuning_cache - tuning results kept in the bloblist
+ *
+ * This is stored under BLOBLISTT_U_BOOT_MMC_TUNING so that each phase can
+ * reuse the tuning done by an earlier one.
+ *
+ * @count: Number of valid entries in @ent
+ * @ent: Tuning results, oldest first
+ * @ent.seq: Sequence number of the MMC controller
+ * @ent.mode: Bus mode (enum bus_mode) the controller was tuned for
+ * @ent.val: Value returned by the driver's get_tuning() operation
+ */
+struct mmc_tuning_cache {
+	u32 count;
+	struct {
+		u32 seq;
+		u32 mode;
+		u32 val;
+	} ent[MMC_TUNING_CACHE_SIZE];
+};
+
 struct mmc {
 #if !CONFIG_IS_ENABLED(BLK)
 	struct list_head link;
@@ -714,6 +872,7 @@ struct mmc {
 #if CONFIG_IS_ENABLED(MMC_WRITE)
 	uint write_bl_len;
 	uint erase_grp_size;	/* in 512-byte sectors */
+	bool erase_zeroes;	/* erased blocks read back as zeroes */
 #endif
 #if CONFIG_IS_ENABLED(MMC_HW_PARTITIONING)
 	uint hc_wp_grp_size;	/* in 512-byte sectors */
@@ -756,10 +915,15 @@ struct mmc {
 	u32 quirks;
 	bool tuning:1;
 	bool hs400_tuning:1;
+	bool cmd23:1;		/* card supports SET_BLOCK_COUNT (CMD23) */
+	bool handoff:1;		/* card state was taken over from SPL */
 
 	enum bus_mode user_speed_mode; /* input speed mode from user */
 
 	CONFIG_IS_ENABLED(CYCLIC, (struct cyclic_info cyclic));
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	struct mmc_async async;	/* asynchronous read in progress */
+#endif
 };
 
 #if CONFIG_IS_ENABLED(DM_MMC)
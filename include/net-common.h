@@ -204,6 +204,58 @@ extern void (*push_packet)(void *packet, int length);
 #endif
 int eth_rx(void);			/* Check for received packets */
 
+#ifdef CONFIG_NET_RX_DIRECT
+/**
+ * net_set_rx_direct() - say where the payload of the next packet is going
+ *
+ * A protocol which knows where the payload of the next packet it expects is
+ * to be stored can call this, so that a driver can receive the packet with
+ * its payload already in place, saving a copy. The memory after the payload,
+ * up to the size of a full packet, must not hold anything yet, since it may
+ * be overwritten. The hint stays until changed.
+ *
+ * @dest: Address for the payload, 0 to cancel the hint
+ * @hdr_len: Size of all the headers before the payload, from the start of
+ *	the Ethernet header
+ * @len: Size of the payload
+ */
+void net_set_rx_direct(ulong dest, int hdr_len, int len);
+
+/**
+ * net_rx_direct_buf() - get a buffer which places the payload in its place
+ *
+ * A driver which copies each packet from the hardware can call this to get
+ * the buffer to copy the next packet into, then return that buffer from its
+ * recv() method. With recv_burst(), only the first packet of a burst may use
+ * it. The headers overwrite the memory before the payload; this is put back
+ * once the packet has been processed.
+ *
+ * @len: Size of the packet which will be placed in the buffer
+ * Return: buffer, or NULL if there is no hint or it cannot be used
+ */
+uchar *net_rx_direct_buf(int len);
+
+/**
+ * net_rx_direct_done() - finish with the buffer from net_rx_direct_buf()
+ *
+ * @pkt: Packet which has been processed, NULL to finish in any case
+ */
+void net_rx_direct_done(uchar *pkt);
+#else
+static inline void net_set_rx_direct(ulong dest, int hdr_len, int len)
+{
+}
+
+static inline uchar *net_rx_direct_buf(int len)
+{
+	return NULL;
+}
+
+static inline void net_rx_direct_done(uchar *pkt)
+{
+}
+#endif
+
 /**
  * reset_phy() - Reset the Ethernet PHY
  *
@@ -256,6 +308,14 @@ enum eth_recv_flags {
  * free_pkt: Give the driver an opportunity to manage its packet buffer memory
  *	     when the network stack is finished processing it. This will only be
  *	     called when no error was returned from recv - optional
+ * recv_burst: Check for up to @max received packets, setting the pointer to
+ *	       and length of each in @packets and @lengths. Return the number
+ *	       found, 0 or -EAGAIN if there are none, or an error. A length of 0
+ *	       marks a bad packet, which is not processed but is freed. Used
+ *	       instead of recv when supplied - optional
+ * free_pkts: Give back all the packets from one call to recv_burst once the
+ *	      network stack has processed them. If not supplied, free_pkt is
+ *	      called for each packet instead - optional
  * stop: Stop the hardware from looking for packets - may be called even if
  *	 state == PASSIVE
  * mcast: Join or leave a multicast group (for TFTP) - optional
@@ -278,6 +338,10 @@ struct eth_ops {
 	int (*send)(struct udevice *dev, void *packet, int length);
 	int (*recv)(struct udevice *dev, int flags, uchar **packetp);
 	int (*free_pkt)(struct udevice *dev, uchar *packet, int length);
+	int (*recv_burst)(struct udevice *dev, int flags, uchar **packets,
+			  int *lengths, int max);
+	int (*free_pkts)(struct udevice *dev, uchar **packets, int *lengths,
+			 int count);
 	void (*stop)(struct udevice *dev);
 	int (*mcast)(struct udevice *dev, const u8 *enetaddr, int join);
 	int (*write_hwaddr)(struct udevice *dev);
@@ -307,6 +371,18 @@ enum eth_state_t {
 	ETH_STATE_ACTIVE
 };
 
+/*
+ * Checksum work done by the hardware, for eth_pdata::offload
+ *
+ * ETH_OFFLOAD_RX_CSUM: The IPv4 header checksum and the TCP and UDP checksums
+ *	of received packets are checked, and packets where one is wrong are
+ *	dropped
+ * ETH_OFFLOAD_TX_CSUM: The IPv4 header checksum and the TCP checksum of sent
+ *	packets are filled in, so the network stack leaves them as zero
+ */
+#define ETH_OFFLOAD_RX_CSUM	(1 << 0)
+#define ETH_OFFLOAD_TX_CSUM	(1 << 1)
+
 /**
  * struct eth_pdata - Platform data for Ethernet MAC controllers
  *
@@ -314,6 +390,8 @@ enum eth_state_t {
  * @enetaddr: The Ethernet MAC address that is loaded from EEPROM or env
  * @phy_interface: PHY interface to use - see PHY_INTERFACE_MODE_...
  * @max_speed: Maximum speed of Ethernet connection supported by MAC
+ * @offload: Checksum work done by the hardware (ETH_OFFLOAD_...), set by
+ *	the driver while the device is started
  * @priv_pdata: device specific plat
  */
 struct eth_pdata {
@@ -321,9 +399,18 @@ struct eth_pdata {
 	unsigned char enetaddr[ARP_HLEN];
 	int phy_interface;
 	int max_speed;
+	uint offload;
 	void *priv_pdata;
 };
 
+/**
+ * eth_offload() - check for checksum work done by the current device
+ *
+ * @flags: ETH_OFFLOAD_... flags to check
+ * Return: true if the current device does all the work in @flags
+ */
+bool eth_offload(uint flags);
+
 struct ethernet_hdr {
 	u8		et_dest[ARP_HLEN];	/* Destination node	*/
 	u8		et_src[ARP_HLEN];	/* Source node		*/
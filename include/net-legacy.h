@@ -108,6 +108,18 @@ int eth_send(void *packet, int length);	   /* Send a packet */
 int eth_receive(void *packet, int length); /* Receive a packet*/
 extern void (*push_packet)(void *packet, int length);
 #endif
+
+/**
+ * eth_mcast_join() - join or leave an IPv4 multicast group
+ *
+ * This uses the driver's mcast() method, falling back to set_promisc() if
+ * there is none.
+ *
+ * @mcast_addr: Group address
+ * @join: 1 to join the group, 0 to leave it
+ * Return: 0 if OK, -ENOSYS if the device cannot receive multicast, other
+ *	-ve on error
+ */
 int eth_mcast_join(struct in_addr mcast_addr, int join);
 
 /**********************************************************************/
@@ -289,6 +301,9 @@ extern char	net_root_path[CONFIG_BOOTP_MAX_ROOT_PATH_LEN];	/* Our root path */
 extern u8		net_ethaddr[ARP_HLEN];		/* Our ethernet address */
 extern u8		net_server_ethaddr[ARP_HLEN];	/* Boot server enet address */
 extern struct in_addr	net_server_ip;	/* Server IP addr (0 = unknown) */
+#ifdef CONFIG_TFTP_MULTICAST
+extern struct in_addr	net_mcast_addr;	/* Multicast group (0 = none) */
+#endif
 extern uchar		*net_tx_packet;		/* THE transmit packet */
 extern uchar		*net_rx_packets[PKTBUFSRX]; /* Receive packets */
 extern uchar		*net_rx_packet;		/* Current receive packet */
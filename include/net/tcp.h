@@ -144,6 +144,15 @@ struct sack_edges {
 
 #define TCP_SACK_HILLS	4
 
+/*
+ * With the timestamp option, only three SACK blocks fit in the 40 bytes of
+ * TCP options (RFC 2018)
+ */
+#define TCP_SACK_TX_HILLS	3
+
+/* Largest window scale factor allowed (RFC 7323) */
+#define TCP_MAX_WIN_SCALE	14
+
 /**
  * struct tcp_sack_v - TCP option structure for SACK
  * @kind: Field ID
@@ -353,13 +362,20 @@ enum tcp_status {
  * @irs:		Initial receive sequence number
  * @rcv_nxt:		Receive next
  * @rcv_wnd:		Receive window (in bytes)
+ * @rcv_space:		If non-zero, the number of bytes of the stream which the
+ *			  receiver has room for; the window is not opened past
+ *			  this
  *
  * @loc_timestamp:	Local timestamp
  * @rmt_timestamp:	Remote timestamp
  *
  * @rmt_win_scale:	Remote window scale factor
+ * @loc_win_scale:	Local window scale factor; this and @rmt_win_scale are
+ *			  0 unless both ends sent the option in their SYN
  *
  * @lost:		Used for SACK
+ * @sack_recent:	Sequence number of the segment most recently received
+ *			  out of order, reported first in SACK options
  *
  * @retry_cnt:		Number of retry attempts remaining. Only SYN, FIN
  *			  or DATA segments are tried to retransmit.
@@ -413,6 +429,7 @@ struct tcp_stream {
 	u32		irs;
 	u32		rcv_nxt;
 	u32		rcv_wnd;
+	u32		rcv_space;
 
 	/* TCP option timestamp */
 	u32		loc_timestamp;
@@ -420,9 +437,11 @@ struct tcp_stream {
 
 	/* TCP window scale */
 	u8		rmt_win_scale;
+	u8		loc_win_scale;
 
 	/* TCP sliding window control used to request re-TX */
 	struct tcp_sack_v lost;
+	u32		sack_recent;
 
 	/* used for data retransmission */
 	int		retry_cnt;
@@ -518,7 +537,7 @@ void tcp_streams_poll(void);
 int tcp_set_tcp_header(struct tcp_stream *tcp, uchar *pkt, int payload_len,
 		       u8 action, u32 tcp_seq_num, u32 tcp_ack_num);
 
-void rxhand_tcp_f(union tcp_build_pkt *b, unsigned int len);
+void rxhand_tcp_f(union tcp_build_pkt *b, unsigned int len, bool csum_ok);
 
 u16 tcp_set_pseudo_header(uchar *pkt, struct in_addr src, struct in_addr dest,
 			  int tcp_len, int pkt_len);
@@ -9,12 +9,49 @@
 #ifndef _OF_LIVE_H
 #define _OF_LIVE_H
 
+#include <linux/types.h>
+
 struct abuf;
 struct device_node;
 
+/* Version of struct of_live_hdr and the tree which follows it */
+#define OF_LIVE_HDR_VERSION	1
+
+/**
+ * struct of_live_hdr - header of a saved live tree
+ *
+ * This is followed by the tree itself, exactly as it was unflattened. The
+ * tree points into the flat tree it was unflattened from, so it can only be
+ * used with an identical flat tree.
+ *
+ * @version: OF_LIVE_HDR_VERSION
+ * @node_size: sizeof(struct device_node) in the phase which saved the tree
+ * @prop_size: sizeof(struct property) in the phase which saved the tree
+ * @size: Size of the tree in bytes, excluding this header
+ * @fdt_size: Size of the flat tree
+ * @fdt_crc: CRC32 of the flat tree
+ * @spare: Reserved, must be 0
+ * @base: Address of the tree when it was saved
+ * @fdt_addr: Address of the flat tree when the tree was saved
+ */
+struct of_live_hdr {
+	u32 version;
+	u16 node_size;
+	u16 prop_size;
+	u32 size;
+	u32 fdt_size;
+	u32 fdt_crc;
+	u32 spare;
+	u64 base;
+	u64 fdt_addr;
+};
+
 /**
  * of_live_build() - build a live (hierarchical) tree from a flat DT
  *
+ * If the previous phase passed on a live tree for @fdt_blob, with
+ * of_live_handoff_write(), that is used instead of unflattening @fdt_blob.
+ *
  * @fdt_blob: Input tree to convert
  * @rootp: Returns live tree that was created
  * Return: 0 if OK, -ve on error
@@ -37,6 +74,66 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp);
  */
 int unflatten_device_tree(const void *blob, struct device_node **mynodes);
 
+/**
+ * of_live_relocate() - Fix up a tree which has been moved
+ *
+ * A tree created by unflatten_device_tree() is held in a single block of
+ * memory and points into the flat tree it came from. This adjusts its
+ * pointers after either or both have been copied somewhere else.
+ *
+ * @root: New address of the tree, being the start of the block
+ * @old_base: Old address of the block
+ * @size: Size of the block
+ * @old_blob: Old address of the flat tree
+ * @blob: New address of the flat tree
+ * Return: 0 if OK, -EFAULT if the tree is not in the expected form
+ */
+int of_live_relocate(struct device_node *root, ulong old_base, ulong size,
+		     const void *old_blob, const void *blob);
+
+/**
+ * of_live_save() - Unflatten a tree into a buffer, so it can be passed on
+ *
+ * This writes a struct of_live_hdr followed by the tree. Pass a NULL @buf to
+ * find out how much space is needed.
+ *
+ * @blob: Flat tree to unflatten
+ * @buf: Buffer for the tree, or NULL
+ * @buf_size: Size of @buf
+ * @sizep: Returns the number of bytes needed
+ * Return: 0 if OK, -ENOSPC if @buf is too small, other -ve on error
+ */
+int of_live_save(const void *blob, void *buf, int buf_size, int *sizep);
+
+/**
+ * of_live_restore() - Set up a live tree from one written by of_live_save()
+ *
+ * The tree is copied into allocated memory and relocated to suit @blob, so
+ * unflattening is not needed. It can be freed with of_live_free().
+ *
+ * @buf: Buffer holding the saved tree
+ * @buf_size: Size of @buf
+ * @blob: Flat tree which the tree was unflattened from, perhaps moved since
+ * @rootp: Returns the root of the tree
+ * Return: 0 if OK, -EINVAL if @buf does not hold a tree for this build,
+ *	-ESTALE if @blob does not match the one the tree was created from,
+ *	-ENOMEM if out of memory
+ */
+int of_live_restore(const void *buf, int buf_size, const void *blob,
+		    struct device_node **rootp);
+
+/**
+ * of_live_handoff_write() - Pass a live tree to the next phase
+ *
+ * This unflattens @blob into the bloblist, so that of_live_build() in the
+ * next phase can use it without unflattening @blob again.
+ *
+ * @blob: Control devicetree of the next phase
+ * Return: 0 if OK, -ENOSPC if there is no room in the bloblist, other -ve on
+ *	error
+ */
+int of_live_handoff_write(const void *blob);
+
 /**
  * of_live_free() - Dispose of a livetree
  *
@@ -147,6 +147,19 @@ unsigned int os_alarm(unsigned int seconds);
  */
 void os_set_alarm_handler(void (*handler)(int));
 
+/**
+ * os_prof_timer() - start or stop a profiling timer
+ *
+ * This uses SIGPROF, which is sent as the process uses CPU time.
+ *
+ * @period_us: Time between calls to @handler, in microseconds of CPU time
+ * @handler: Function to call with the interrupted program counter, frame
+ *	pointer and stack pointer, or NULL to stop the timer
+ * Return: 0 if OK, -1 on error
+ */
+int os_prof_timer(unsigned int period_us,
+		  void (*handler)(ulong pc, ulong fp, ulong sp));
+
 /**
  * os_raise_sigalrm() - do raise(SIGALRM)
  */
@@ -548,4 +561,26 @@ long os_get_time_offset(void);
  */
 void os_set_time_offset(long offset);
 
+/**
+ * os_insn_count_start() - start counting instructions
+ *
+ * This counts the instructions run by U-Boot in user space, using the host's
+ * performance counters. Unlike the time taken, this does not depend on the
+ * load on the host, so it is suitable for checking for performance
+ * regressions.
+ *
+ * Return:	handle to pass to os_insn_count_end(), or -ve error if counters
+ *		are not available, e.g. because the host does not allow them
+ */
+int os_insn_count_start(void);
+
+/**
+ * os_insn_count_end() - stop counting instructions
+ *
+ * @handle:	handle returned by os_insn_count_start()
+ * @countp:	returns the number of instructions run since the start
+ * Return:	0 if OK, -ve on error
+ */
+int os_insn_count_end(int handle, unsigned long long *countp);
+
 #endif
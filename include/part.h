@@ -473,6 +473,22 @@ struct part_driver {
 	int (*get_info)(struct blk_desc *desc, int part,
 			struct disk_partition *info);
 
+	/**
+	 * @get_info_by_name:	Look up a partition by name (optional)
+	 *
+	 * If this is NULL, part_get_info_by_name() calls @get_info for each
+	 * partition in turn.
+	 *
+	 * @get_info_by_name.desc:	Block device descriptor
+	 * @get_info_by_name.name:	Partition name to find
+	 * @get_info_by_name.info:	Returns partition information
+	 * @get_info_by_name.Return:	partition number (1 = first) on
+	 *				success, -ENOENT if not found, other -ve
+	 *				on error
+	 */
+	int (*get_info_by_name)(struct blk_desc *desc, const char *name,
+				struct disk_partition *info);
+
 	/**
 	 * @print:		Print partition information
 	 *
@@ -628,6 +644,18 @@ int gpt_verify_partitions(struct blk_desc *desc,
  */
 int get_disk_guid(struct blk_desc *desc, char *guid);
 
+/**
+ * gpt_cache_invalidate() - Drop any cached GPT for a block device
+ *
+ * The GPT is cached after it has been validated, keyed on the device's write
+ * count. This drops the cached copy, e.g. when the media has changed.
+ *
+ * @desc:	block device descriptor
+ */
+void gpt_cache_invalidate(struct blk_desc *desc);
+
+#else
+static inline void gpt_cache_invalidate(struct blk_desc *desc) {}
 #endif
 
 #if CONFIG_IS_ENABLED(DOS_PARTITION)
@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * CPU performance-monitor counters
+ *
+ * These count events in hardware so that a slow phase of boot can be broken
+ * down into where the time goes, e.g. cache or TLB misses, without any
+ * change to the code being measured.
+ */
+
+#ifndef __PMU_H
+#define __PMU_H
+
+#include <linux/types.h>
+
+/**
+ * enum pmu_event - Events counted by the PMU
+ *
+ * @PMU_CYCLES: CPU cycles
+ * @PMU_INSNS: Instructions retired
+ * @PMU_CACHE_MISSES: Level 1 data-cache refills
+ * @PMU_TLB_MISSES: Level 1 data-TLB refills
+ * @PMU_EVENT_COUNT: Number of events
+ */
+enum pmu_event {
+	PMU_CYCLES,
+	PMU_INSNS,
+	PMU_CACHE_MISSES,
+	PMU_TLB_MISSES,
+
+	PMU_EVENT_COUNT,
+};
+
+/**
+ * pmu_start() - Program the counters and start them
+ *
+ * If the counters are already running, e.g. because an earlier phase of
+ * U-Boot started them, they are left alone so that counts carry on across
+ * phases
+ *
+ * Return: 0 if OK, -ENOSYS if the CPU has no usable PMU
+ */
+int pmu_start(void);
+
+/**
+ * pmu_reset() - Set all counters back to zero
+ */
+void pmu_reset(void);
+
+/**
+ * pmu_read() - Read the counters
+ *
+ * @counts: Returns the count for each event, indexed by enum pmu_event.
+ *	Events which the CPU cannot count, or counters which have not been
+ *	started, read as 0
+ */
+void pmu_read(u64 counts[PMU_EVENT_COUNT]);
+
+/**
+ * pmu_event_name() - Get the name of an event
+ *
+ * @event: Event to look up
+ * Return: Short name of the event, e.g. "cycles"
+ */
+const char *pmu_event_name(enum pmu_event event);
+
+#endif
@@ -160,12 +160,16 @@ struct pmic {
  * @reg_count: device's register count
  * @read:      read 'len' bytes at "reg" and store it into the 'buffer'
  * @write:     write 'len' bytes from the 'buffer' to the register at 'reg' address
+ * @reg_volatile: optional, check if register 'reg' can change by itself (e.g.
+ *             status or interrupt registers). Providing this allows the other
+ *             registers to be cached, with CONFIG_PMIC_REG_CACHE
  */
 struct dm_pmic_ops {
 	int (*reg_count)(struct udevice *dev);
 	int (*read)(struct udevice *dev, uint reg, uint8_t *buffer, int len);
 	int (*write)(struct udevice *dev, uint reg, const uint8_t *buffer,
 		     int len);
+	bool (*reg_volatile)(struct udevice *dev, uint reg);
 };
 
 /**
@@ -302,10 +306,18 @@ int pmic_clrsetbits(struct udevice *dev, uint reg, uint clr, uint set);
 /*
  * This structure holds the private data for PMIC uclass
  * For now we store information about the number of bytes
- * being sent at once to the device.
+ * being sent at once to the device, and the register cache.
+ *
+ * @trans_len:   number of bytes in each register
+ * @cache:       cached register values, or NULL if not caching
+ * @cache_valid: bitmap of registers whose value is in @cache
+ * @cache_count: number of registers in @cache
  */
 struct uc_pmic_priv {
 	uint trans_len;
+	u32 *cache;
+	ulong *cache_valid;
+	int cache_count;
 };
 
 #endif /* DM_PMIC */
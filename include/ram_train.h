@@ -0,0 +1,97 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Cache of DRAM-training results
+ *
+ * A RAM driver uses this to skip training on boots where nothing has changed:
+ *
+ *	fingerprint = crc32(0, (u8 *)params, sizeof(*params));
+ *	if (ram_train_restore(fingerprint, &trn, sizeof(trn)) ||
+ *	    apply_training(&trn) || ram_train_verify(base, size)) {
+ *		ret = full_training(&trn);
+ *		if (!ret)
+ *			ram_train_save(fingerprint, &trn, sizeof(trn));
+ *	}
+ *
+ * The fingerprint should cover everything the results depend on, e.g. the
+ * board, the DIMM's SPD, the controller settings and the layout of the saved
+ * values.
+ */
+
+#ifndef __RAM_TRAIN_H
+#define __RAM_TRAIN_H
+
+#include <linux/types.h>
+
+/**
+ * ram_train_restore() - Read saved DRAM-training results
+ *
+ * @fingerprint: Fingerprint of the setup that the results must be for
+ * @data: Returns the saved results
+ * @size: Size of @data
+ * Return: 0 if OK, -ENOENT if nothing is saved, -ESTALE if the results saved
+ *	are for a different fingerprint or size, -EBADMSG if they are corrupt,
+ *	other -ve if the store cannot be read
+ */
+int ram_train_restore(u32 fingerprint, void *data, uint size);
+
+/**
+ * ram_train_save() - Save DRAM-training results
+ *
+ * Nothing is written if the same results are saved already, so this can be
+ * called on every boot without wearing out the flash.
+ *
+ * @fingerprint: Fingerprint of the setup that the results are for
+ * @data: Results to save
+ * @size: Size of @data
+ * Return: 0 if OK, -E2BIG if @data does not fit in the store, other -ve if the
+ *	store cannot be written
+ */
+int ram_train_save(u32 fingerprint, const void *data, uint size);
+
+/**
+ * ram_train_verify() - Quickly check that DRAM works
+ *
+ * This is much faster than a memory test: it writes walking ones to find
+ * faulty data lines and a value at each power-of-two offset to find faulty
+ * address lines. The contents of the region are lost.
+ *
+ * @base: Start of DRAM
+ * @size: Size of DRAM
+ * Return: 0 if OK, -EIO if memory does not read back what was written
+ */
+int ram_train_verify(phys_addr_t base, phys_size_t size);
+
+/**
+ * ram_train_store_read() - Read from the store for training results
+ *
+ * This reads from the first SPI flash. A board may provide its own version
+ * to use e.g. an eMMC boot partition instead, along with
+ * ram_train_store_erase() and ram_train_store_write().
+ *
+ * @offset: Offset within the store
+ * @buf: Returns the data read
+ * @size: Number of bytes to read
+ * Return: 0 if OK, -ve on error
+ */
+int ram_train_store_read(uint offset, void *buf, uint size);
+
+/**
+ * ram_train_store_erase() - Erase the whole store for training results
+ *
+ * Return: 0 if OK, -ve on error
+ */
+int ram_train_store_erase(void);
+
+/**
+ * ram_train_store_write() - Write to the store for training results
+ *
+ * This is only called after ram_train_store_erase()
+ *
+ * @offset: Offset within the store
+ * @buf: Data to write
+ * @size: Number of bytes to write
+ * Return: 0 if OK, -ve on error
+ */
+int ram_train_store_write(uint offset, const void *buf, uint size);
+
+#endif
@@ -14,11 +14,20 @@
  * @label: Label for this device (allocated)
  * @filename: Name of file this is attached to, or NULL (allocated)
  * @fd: File descriptor of file, or 0 for none (file is not open)
+ * @map: Contents of the file mapped into memory, or NULL if it is accessed
+ *	by reading and writing @fd
+ * @map_size: Size of @map in bytes
+ * @latency_us: Time to add to each transfer, to emulate a slower device
+ * @rate_kib: Transfer rate to emulate in KiB/s, or 0 for no limit
  */
 struct host_sb_plat {
 	char *label;
 	char *filename;
 	int fd;
+	void *map;
+	int map_size;
+	uint latency_us;
+	uint rate_kib;
 };
 
 /**
@@ -142,6 +142,7 @@ struct scsi_cmd {
 #define SCSI_MODE_SEN6	0x1A		/* Mode Sense 6-byte (Device Specific) */
 #define SCSI_MODE_SEN10	0x5A		/* Mode Sense 10-byte (Device Specific) */
 #define SCSI_READ_BUFF	0x3C		/* Read Buffer (O) */
+#define SCSI_REPORT_LUNS	0xA0		/* Report LUNs (O) */
 #define SCSI_REQ_SENSE	0x03		/* Request Sense (MANDATORY) */
 #define SCSI_SEND_DIAG	0x1D		/* Send Diagnostic (O) */
 #define SCSI_TST_U_RDY	0x00		/* Test Unit Ready (MANDATORY) */
@@ -276,6 +276,11 @@ struct sdhci_ops {
 	int	(*set_ios_post)(struct sdhci_host *host);
 	void	(*set_clock)(struct sdhci_host *host, u32 div);
 	int (*platform_execute_tuning)(struct mmc *host, u8 opcode);
+#if CONFIG_IS_ENABLED(MMC_TUNING_CACHE)
+	/* Read back / apply the result of platform_execute_tuning() */
+	int (*platform_get_tuning)(struct mmc *host, u32 *valp);
+	int (*platform_set_tuning)(struct mmc *host, u32 val);
+#endif
 	int (*set_delay)(struct sdhci_host *host);
 	/* Callback function to set DLL clock configuration */
 	int (*config_dll)(struct sdhci_host *host, u32 clock, bool enable);
@@ -305,8 +310,9 @@ struct sdhci_ops {
 #else
 #define ADMA_DESC_LEN	8
 #endif
-#define ADMA_TABLE_NO_ENTRIES DIV_ROUND_UP(CONFIG_SYS_MMC_MAX_BLK_COUNT * \
-			      MMC_MAX_BLOCK_LEN, ADMA_MAX_LEN)
+/* each scatter-gather segment may need one extra, partially-filled entry */
+#define ADMA_TABLE_NO_ENTRIES (DIV_ROUND_UP(CONFIG_SYS_MMC_MAX_BLK_COUNT * \
+			       MMC_MAX_BLOCK_LEN, ADMA_MAX_LEN) + MMC_MAX_SG)
 
 #define ADMA_TABLE_SZ (ADMA_TABLE_NO_ENTRIES * ADMA_DESC_LEN)
 
@@ -353,6 +359,10 @@ struct sdhci_host {
 	void *align_buffer;
 	bool force_align_buffer;
 	dma_addr_t start_addr;
+#if CONFIG_IS_ENABLED(MMC_SDHCI_ADMA)
+	dma_addr_t sg_addr[MMC_MAX_SG];	/* mapped scatter-gather segments */
+#endif
+	ulong data_start;	/* time at which an async transfer started */
 	int flags;
 #define USE_SDMA	(0x1 << 0)
 #define USE_ADMA	(0x1 << 1)
@@ -538,5 +548,8 @@ struct sdhci_adma_desc *sdhci_adma_init(void);
 void sdhci_prepare_adma_table(struct sdhci_host *host,
 			      struct sdhci_adma_desc *table,
 			      struct mmc_data *data, dma_addr_t start_addr);
+void sdhci_prepare_adma_table_sg(struct sdhci_host *host,
+				 struct sdhci_adma_desc *table,
+				 struct mmc_data *data, const dma_addr_t *addr);
 
 #endif /* __SDHCI_HW_H */
@@ -1,6 +1,7 @@
 #ifndef __SERIAL_H__
 #define __SERIAL_H__
 
+#include <cyclic.h>
 #include <post.h>
 
 struct serial_device {
@@ -295,6 +296,12 @@ struct dm_serial_ops {
  * @buf:	Pointer to the RX buffer
  * @rd_ptr:	Read pointer in the RX buffer
  * @wr_ptr:	Write pointer in the RX buffer
+ *
+ * @tx_buf:	Pointer to the TX buffer, NULL if not allocated (before
+ *		relocation)
+ * @tx_rd:	Read pointer in the TX buffer
+ * @tx_wr:	Write pointer in the TX buffer
+ * @tx_cyclic:	Cyclic function which sends buffered characters
  */
 struct serial_dev_priv {
 	struct stdio_dev *sdev;
@@ -304,6 +311,12 @@ struct serial_dev_priv {
 	uint rd_ptr;
 	uint wr_ptr;
 #endif
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	char *tx_buf;
+	uint tx_rd;
+	uint tx_wr;
+	struct cyclic_info tx_cyclic;
+#endif
 };
 
 /* Access the serial operations for a device */
@@ -338,10 +338,22 @@ struct spl_load_info;
 typedef ulong (*spl_load_reader)(struct spl_load_info *load, ulong sector,
 				 ulong count, void *buf);
 
+/**
+ * spl_load_mapper() - Get a pointer to data on memory-mapped media
+ *
+ * @load: Information about the load state
+ * @offset: Offset of the data in bytes
+ * @count: Number of bytes which will be accessed
+ * @return pointer to the data, or NULL to read it with @load->read instead
+ */
+typedef void *(*spl_load_mapper)(struct spl_load_info *load, ulong offset,
+				 ulong count);
+
 /**
  * Information required to load data from a device
  *
  * @read: Function to call to read from the device
+ * @map: Function to call to access memory-mapped data in place, or NULL
  * @priv: Private data for the device
  * @bl_len: Block length for reading in bytes
  * @phase: Image phase to load
@@ -349,6 +361,9 @@ typedef ulong (*spl_load_reader)(struct spl_load_info *load, ulong sector,
  */
 struct spl_load_info {
 	spl_load_reader read;
+#if CONFIG_IS_ENABLED(LOAD_MAPPED)
+	spl_load_mapper map;
+#endif
 	void *priv;
 #if IS_ENABLED(CONFIG_SPL_LOAD_BLOCK)
 	u16 bl_len;
@@ -378,6 +393,32 @@ static inline void spl_set_bl_len(struct spl_load_info *info, int bl_len)
 #endif
 }
 
+static inline void spl_set_map(struct spl_load_info *info,
+			       spl_load_mapper map)
+{
+#if CONFIG_IS_ENABLED(LOAD_MAPPED)
+	info->map = map;
+#endif
+}
+
+/**
+ * spl_load_map() - Get a pointer to data which can be used in place
+ *
+ * @info: Information about the load state
+ * @offset: Offset of the data in bytes
+ * @count: Number of bytes which will be accessed
+ * Return: pointer to the data, or NULL if it must be read with @info->read
+ */
+static inline void *spl_load_map(struct spl_load_info *info, ulong offset,
+				 ulong count)
+{
+#if CONFIG_IS_ENABLED(LOAD_MAPPED)
+	if (info->map)
+		return info->map(info, offset, count);
+#endif
+	return NULL;
+}
+
 static inline void xpl_set_phase(struct spl_load_info *info,
 				 enum image_phase_t phase)
 {
@@ -420,6 +461,7 @@ static inline void spl_load_init(struct spl_load_info *load,
 				 uint bl_len)
 {
 	load->read = h_read;
+	spl_set_map(load, NULL);
 	load->priv = priv;
 	spl_set_bl_len(load, bl_len);
 	xpl_set_phase(load, IH_PHASE_NONE);
@@ -697,6 +739,40 @@ int spl_parse_image_header(struct spl_image_info *spl_image,
 
 void spl_board_prepare_for_linux(void);
 
+/**
+ * spl_fixup_fdt() - apply SPL's fixups to the OS devicetree
+ *
+ * This shrinks the blob and calls arch_fixup_fdt(). With
+ * CONFIG_SPL_FALCON_FDT_CACHE a blob which was already fixed up for the
+ * same inputs is left alone, and a freshly fixed-up blob records them.
+ *
+ * @fdt_blob: Devicetree to fix up, or NULL to do nothing
+ */
+void spl_fixup_fdt(void *fdt_blob);
+
+/**
+ * spl_fdt_prepared() - check whether a devicetree is already fixed up
+ *
+ * The inputs covered are the DRAM size and banks, plus whatever
+ * board_spl_fdt_fingerprint() adds.
+ *
+ * @fdt_blob: Devicetree to check
+ * Return: true if spl_fixup_fdt() fixed up @fdt_blob for the current inputs
+ */
+bool spl_fdt_prepared(const void *fdt_blob);
+
+/**
+ * board_spl_fdt_fingerprint() - add board inputs to the FDT fingerprint
+ *
+ * Boards whose arch_fixup_fdt() or ft_board_setup() output depends on more
+ * than the DRAM layout, e.g. on a board revision, fold that into @crc so
+ * that a cached devicetree is fixed up again when it changes.
+ *
+ * @crc: Fingerprint so far
+ * Return: updated fingerprint, e.g. crc32(@crc, data, len)
+ */
+u32 board_spl_fdt_fingerprint(u32 crc);
+
 /**
  * spl_board_prepare_for_optee() - Prepare board for an OPTEE payload
  *
@@ -917,6 +993,22 @@ int spl_init(void);
  */
 void spl_soc_init(void);
 
+/**
+ * spl_enable_caches() - Turn on the MMU and caches before loading images
+ *
+ * If xPL_ENABLE_CACHES is enabled, this is called from board_init_r() before
+ * the next phase is loaded. It does nothing if the caches are already on.
+ */
+void spl_enable_caches(void);
+
+/**
+ * spl_disable_caches() - Turn off the caches again before the jump
+ *
+ * If xPL_ENABLE_CACHES is enabled, this is called from board_init_r() just
+ * before jumping to the next phase.
+ */
+void spl_disable_caches(void);
+
 /*
  * spl_board_init() - Do board-specific init in SPL
  *
@@ -1165,7 +1257,8 @@ int spl_load_fit_image(struct spl_image_info *spl_image,
  */
 static inline bool spl_decompression_enabled(void)
 {
-	return IS_ENABLED(CONFIG_SPL_GZIP) || IS_ENABLED(CONFIG_SPL_LZMA);
+	return IS_ENABLED(CONFIG_SPL_GZIP) || IS_ENABLED(CONFIG_SPL_LZMA) ||
+		IS_ENABLED(CONFIG_SPL_LZ4) || IS_ENABLED(CONFIG_SPL_ZSTD);
 }
 
 /**
@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Sampling profiler
+ *
+ * A periodic timer interrupt records where the CPU is, and optionally
+ * how it got there, into a ring buffer. Unlike function tracing, this
+ * needs no instrumentation and costs nothing between samples.
+ */
+
+#ifndef __SPROF_H
+#define __SPROF_H
+
+#include <linux/types.h>
+
+/**
+ * sprof_start() - start sampling
+ *
+ * This drops any samples taken so far.
+ *
+ * @period_us: Time between samples in microseconds
+ * Return: 0 if OK, -ENOSYS if the architecture has no sampling timer,
+ *	-ENOMEM if the buffer cannot be allocated, other -ve on error
+ */
+int sprof_start(uint period_us);
+
+/**
+ * sprof_stop() - stop sampling
+ *
+ * The samples are kept until the next sprof_start().
+ */
+void sprof_stop(void);
+
+/**
+ * sprof_sample() - record a sample
+ *
+ * This is called from the sampling timer's interrupt handler.
+ *
+ * @pc: Interrupted program counter
+ * @fp: Interrupted frame pointer, used with CONFIG_SPROF_BACKTRACE
+ * @sp: Interrupted stack pointer, which bounds the frames that are walked
+ */
+void sprof_sample(ulong pc, ulong fp, ulong sp);
+
+/**
+ * sprof_list_samples() - write the samples for proftool
+ *
+ * This writes a struct trace_output_hdr of type TRACE_CHUNK_SAMPLES
+ * followed by the samples, oldest first.
+ *
+ * @buff: Buffer to write to
+ * @buff_size: Size of @buff
+ * @needed: Returns the number of bytes needed for all the samples
+ * Return: 0 if OK, -ENOSPC if the buffer is too small
+ */
+int sprof_list_samples(void *buff, size_t buff_size, size_t *needed);
+
+/**
+ * sprof_print_stats() - print how many samples were taken and kept
+ */
+void sprof_print_stats(void);
+
+/**
+ * arch_sprof_start() - start the architecture's sampling timer
+ *
+ * The timer calls sprof_sample() every @period_us microseconds.
+ *
+ * @period_us: Time between samples in microseconds
+ * Return: 0 if OK, -ENOSYS if not supported
+ */
+int arch_sprof_start(uint period_us);
+
+/**
+ * arch_sprof_stop() - stop the architecture's sampling timer
+ */
+void arch_sprof_stop(void);
+
+#endif
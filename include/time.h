@@ -145,4 +145,26 @@ unsigned long timer_get_us(void);
  */
 uint64_t get_ticks(void);
 
+/**
+ * timer_wait_until() - Wait until the tick counter reaches a value
+ *
+ * Where the architecture supports it, the CPU sleeps for most of the wait
+ * rather than polling the counter, which saves power in long waits such as
+ * the autoboot countdown.
+ *
+ * @ticks: Value of get_ticks() to wait for
+ */
+void timer_wait_until(uint64_t ticks);
+
+/**
+ * arch_timer_sleep() - Sleep until the tick counter is close to a value
+ *
+ * This is called by timer_wait_until(), which polls the counter afterwards,
+ * so it may return early but must not return much later than @ticks. The
+ * default does nothing.
+ *
+ * @ticks: Value of get_ticks() to sleep until
+ */
+void arch_timer_sleep(uint64_t ticks);
+
 #endif /* _TIME_H */
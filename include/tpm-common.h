@@ -65,6 +65,8 @@ enum tpm_version {
  * @pcr_select_min:	Minimum size in bytes of the pcrSelect array
  * @active_bank_count:	Number of active PCR banks
  * @active_banks:	Array of active PCRs
+ * @banks_checked:	The active banks have been found to be supported, so PCRs
+ *			may be extended
  * @plat_hier_disabled:	Platform hierarchy has been disabled (TPM is locked
  *			down until next reboot)
  */
@@ -81,6 +83,7 @@ struct tpm_chip_priv {
 #if IS_ENABLED(CONFIG_TPM_V2)
 	u8 active_bank_count;
 	u32 active_banks[TPM2_NUM_PCR_BANKS];
+	bool banks_checked;
 #endif
 	bool plat_hier_disabled;
 };
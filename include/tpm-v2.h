@@ -488,6 +488,21 @@ u32 tpm2_nv_define_space(struct udevice *dev, u32 space_index,
 u32 tpm2_pcr_extend(struct udevice *dev, u32 index, u32 algorithm,
 		    const u8 *digest, u32 digest_len);
 
+/**
+ * tpm2_pcr_extend_digests() - Extend a PCR in several banks at once
+ *
+ * This issues a single TPM2_PCR_Extend command with a digest for each bank,
+ * rather than one command per bank
+ *
+ * @dev:	TPM device
+ * @index:	Index of the PCR
+ * @digest_list: Digests to extend, one per bank
+ *
+ * Return: code of the operation
+ */
+u32 tpm2_pcr_extend_digests(struct udevice *dev, u32 index,
+			    const struct tpml_digest_values *digest_list);
+
 /**
  * Read data from the secure storage
  *
@@ -34,6 +34,16 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_SAMPLES,
+};
+
+/*
+ * A sample from the sampling profiler, as written to the profile output
+ * file. It is followed by @depth code offsets, the interrupted one first
+ * and then the return address of each caller.
+ */
+struct trace_output_sample {
+	uint32_t depth;			/* Number of offsets which follow */
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -89,6 +99,34 @@ struct trace_call {
 
 int trace_list_calls(void *buff, size_t buff_size, size_t *needed);
 
+/**
+ * trace_set_limits() - Set which function calls are traced
+ *
+ * Calls deeper than @depth_limit, or to functions outside the range, are
+ * not traced, though they are still included in the call counts. Offsets are
+ * from the start of U-Boot's code, as with the trace output.
+ *
+ * @depth_limit:	Maximum call depth to trace
+ * @start:		Offset of first function to trace
+ * @end:		Offset just after the last function to trace, or 0 for
+ *			no limit
+ * Return: 0 if OK, -ENOENT if tracing is not set up
+ */
+int trace_set_limits(int depth_limit, ulong start, ulong end);
+
+/**
+ * trace_print_totals() - Show the functions which took the most time
+ *
+ * This needs CONFIG_TRACE_AGGREGATE. Functions are shown by offset, most
+ * exclusive time first, with the number of calls and the time spent
+ * including and excluding the functions they call. The inclusive time of
+ * a recursive function counts each nested call.
+ *
+ * @count:	Maximum number of functions to show
+ * Return: 0 if OK, -ENOENT if there are no totals, -ENOMEM if out of memory
+ */
+int trace_print_totals(int count);
+
 /**
  * Turn function tracing on and off
  *
@@ -68,4 +68,17 @@ int ecdsa_verify(struct image_sign_info *info,
 #define ECDSA384_BYTES	(384 / 8)
 #define ECDSA521_BYTES	((521 + 7) / 8)
 
+/*
+ * The optional "ecdsa,comb-table" property of a key holds multiples of the
+ * public key Q, so that verifiers using the comb method of multiplication do
+ * not need to work them out at each boot. With window w and spacing d, entry
+ * i of the 2^(w-1) entries is (1 + the sum of 2^(kd) for each bit k-1 set in
+ * i) * Q, stored as the X and then Y coordinate in big-endian form. This
+ * matches the layout of the tables MbedTLS uses for the base point.
+ */
+#define ECDSA_COMB_WINDOW(bits)		((bits) >= 384 ? 6 : 5)
+#define ECDSA_COMB_SPACING(bits)	\
+	(((bits) + ECDSA_COMB_WINDOW(bits) - 1) / ECDSA_COMB_WINDOW(bits))
+#define ECDSA_COMB_SIZE(bits)		(1 << (ECDSA_COMB_WINDOW(bits) - 1))
+
 #endif
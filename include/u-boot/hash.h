@@ -5,6 +5,8 @@
 #ifndef _UBOOT_HASH_H
 #define _UBOOT_HASH_H
 
+struct udevice;
+
 enum HASH_ALGO {
 	HASH_ALGO_CRC16_CCITT,
 	HASH_ALGO_CRC32,
@@ -31,6 +33,24 @@ int hash_digest(struct udevice *dev, enum HASH_ALGO algo,
 int hash_digest_wd(struct udevice *dev, enum HASH_ALGO algo,
 		   const void *ibuf, const uint32_t ilen,
 		   void *obuf, uint32_t chunk_sz);
+
+/**
+ * hash_digest_by_name() - Hash a buffer using the first hash device
+ *
+ * This allows callers to use hardware acceleration when the board has it,
+ * falling back to software hashing if this function fails, e.g. because
+ * there is no device or it does not support the algorithm.
+ *
+ * @name: Name of the algorithm, e.g. "sha256"
+ * @ibuf: Data to hash
+ * @ilen: Length of data in bytes
+ * @obuf: Returns the digest
+ * @chunk_sz: Trigger the watchdog after hashing this many bytes
+ * Return: size of the digest in bytes, -EPROTONOSUPPORT if the algorithm is
+ *	unknown, -ENODEV if there is no hash device, other -ve on error
+ */
+int hash_digest_by_name(const char *name, const void *ibuf,
+			const uint32_t ilen, void *obuf, uint32_t chunk_sz);
 int hash_init(struct udevice *dev, enum HASH_ALGO algo, void **ctxp);
 int hash_update(struct udevice *dev, void *ctx, const void *ibuf, const uint32_t ilen);
 int hash_finish(struct udevice *dev, void *ctx, void *obuf);
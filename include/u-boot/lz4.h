@@ -21,6 +21,33 @@
  */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
+/**
+ * ulz4fn_parallel() - Decompress LZ4 data, spreading blocks over CPU cores
+ *
+ * This is the same as ulz4fn() except that the blocks of the frame are
+ * decompressed as separate jobs with cpu_run_jobs(), each placed as if the
+ * blocks before it were full. If the frame does not allow this, e.g. because
+ * the output overlaps the input or a block other than the last is short, the
+ * data is decompressed by ulz4fn() instead.
+ *
+ * Without CONFIG_CPU this is the same as ulz4fn().
+ *
+ * @src: Source data to decompress
+ * @srcn: Length of source data
+ * @dst: Destination for uncompressed data
+ * @dstn: Returns length of uncompressed data
+ * Return: as for ulz4fn()
+ */
+#if CONFIG_IS_ENABLED(CPU)
+int ulz4fn_parallel(const void *src, size_t srcn, void *dst, size_t *dstn);
+#else
+static inline int ulz4fn_parallel(const void *src, size_t srcn, void *dst,
+				  size_t *dstn)
+{
+	return ulz4fn(src, srcn, dst, dstn);
+}
+#endif
+
 /**
  * LZ4_decompress_safe() - Decompression protected against buffer overflow
  * @source: source address of the compressed data
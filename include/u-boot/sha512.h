@@ -37,6 +37,24 @@ void sha512_finish(sha512_context * ctx, uint8_t digest[SHA512_SUM_LEN]);
 void sha512_csum_wd(const unsigned char *input, unsigned int ilen,
 		unsigned char *output, unsigned int chunk_sz);
 
+#if !CONFIG_IS_ENABLED(MBEDTLS_LIB_CRYPTO)
+/**
+ * sha512_process() - hash whole blocks, for SHA-384 and SHA-512
+ *
+ * This is weak so that an architecture may provide a faster version.
+ *
+ * @ctx: Context to update
+ * @data: Data to hash
+ * @blocks: Number of SHA512_BLOCK_SIZE blocks at @data
+ */
+void sha512_process(sha512_context *ctx, const unsigned char *data,
+		    unsigned int blocks);
+
+/* Portable version of sha512_process(), for use as a fallback */
+void sha512_process_generic(sha512_context *ctx, const unsigned char *data,
+			    unsigned int blocks);
+#endif
+
 extern const uint8_t sha384_der_prefix[];
 
 void sha384_starts(sha512_context * ctx);
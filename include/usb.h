@@ -843,6 +843,25 @@ bool usb_hub_is_root_hub(struct udevice *hub);
  */
 int usb_hub_scan(struct udevice *hub);
 
+/**
+ * usb_hub_scan_hold() - Hold back scanning of hub ports
+ *
+ * Until usb_hub_scan_release() is called, configuring a hub only powers on
+ * its ports and adds them to the list of ports to scan. This allows the
+ * power-on and connection waits of several controllers to overlap.
+ */
+void usb_hub_scan_hold(void);
+
+/**
+ * usb_hub_scan_release() - Scan the ports held back by usb_hub_scan_hold()
+ *
+ * This returns once all ports, including those of hubs found on the way,
+ * have been scanned
+ *
+ * Return: 0 if OK, -ve on error
+ */
+int usb_hub_scan_release(void);
+
 /**
  * usb_scan_device() - Scan a device on a bus
  *
@@ -988,6 +988,8 @@ typedef enum {
 /* Allow two commands + a link TRB, along with any reserved command TRBs */
 #define MAX_RSVD_CMD_TRBS	(TRBS_PER_SEGMENT - 3)
 #define SEGMENT_SIZE		(TRBS_PER_SEGMENT*16)
+/* Segments in each bulk endpoint ring, see xhci_get_max_xfer_size() */
+#define XHCI_BULK_RING_SEGS	CONFIG_USB_XHCI_BULK_RING_SEGS
 /* SEGMENT_SHIFT should be log2(SEGMENT_SIZE).
  * Change this if you change TRBS_PER_SEGMENT!
  */
@@ -69,6 +69,21 @@ enum video_format {
 	VIDEO_X2R10G10B10,
 };
 
+/**
+ * struct video_bbox - A rectangle within the frame buffer
+ *
+ * @x0: Left edge, in pixels
+ * @y0: Top edge, in pixels
+ * @x1: Right edge, in pixels (exclusive)
+ * @y1: Bottom edge, in pixels (exclusive)
+ */
+struct video_bbox {
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+};
+
 /**
  * struct video_priv - Device information used by the video uclass
  *
@@ -95,6 +110,8 @@ enum video_format {
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
  * @last_sync:	Monotonic time of last video sync
+ * @damage:	Region changed since the last sync (empty if @damage.x0 >=
+ *		@damage.x1), only used with CONFIG_VIDEO_DAMAGE
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -120,6 +137,7 @@ struct video_priv {
 	u8 fg_col_idx;
 	u8 bg_col_idx;
 	ulong last_sync;
+	struct video_bbox damage;
 };
 
 /**
@@ -129,9 +147,24 @@ struct video_priv {
  *		For these devices implement video_sync hook to call a sync
  *		function. vid is pointer to video device udevice. Function
  *		should return 0 on success video_sync and error code otherwise
+ * @fill:	Optional: Fill a rectangle of the frame buffer with a colour,
+ *		e.g. using a 2D engine or DMA. The bounds are as for
+ *		video_fill_part(). The driver must make sure that the result
+ *		is visible to the CPU (e.g. by flushing and invalidating the
+ *		region) before returning. Returns 0 if OK, -ENOSYS to fall back
+ *		to filling with the CPU, or other -ve error
+ * @move_rows:	Optional: Move a band of pixel rows within the frame buffer,
+ *		e.g. for scrolling. The regions may overlap. @ydst and @ysrc
+ *		are the first pixel row of each region and @height is the
+ *		number of pixel rows to move. The same cache requirements apply
+ *		as for @fill. Returns 0 if OK, -ENOSYS to fall back to
+ *		memmove(), or other -ve error
  */
 struct video_ops {
 	int (*video_sync)(struct udevice *vid);
+	int (*fill)(struct udevice *vid, int xstart, int ystart, int xend,
+		    int yend, u32 colour);
+	int (*move_rows)(struct udevice *vid, int ydst, int ysrc, int height);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -249,6 +282,20 @@ int video_fill(struct udevice *dev, u32 colour);
 int video_fill_part(struct udevice *dev, int xstart, int ystart, int xend,
 		    int yend, u32 colour);
 
+/**
+ * video_move_rows() - Move a band of pixel rows within the frame buffer
+ *
+ * This uses the driver's move_rows() operation if it has one, otherwise
+ * memmove(). The copy frame buffer, if any, is updated to match.
+ *
+ * @dev:	Device to update
+ * @ydst:	First pixel row of the destination
+ * @ysrc:	First pixel row of the source
+ * @height:	Number of pixel rows to move
+ * Return: 0 if OK, -ve on error
+ */
+int video_move_rows(struct udevice *dev, int ydst, int ysrc, int height);
+
 /**
  * video_sync() - Sync a device's frame buffer with its hardware
  *
@@ -343,13 +390,38 @@ void video_set_default_colors(struct udevice *dev, bool invert);
  */
 int video_default_font_height(struct udevice *dev);
 
-#ifdef CONFIG_VIDEO_COPY
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * video_damage() - Record that a region of the frame buffer has changed
+ *
+ * The changed regions are merged into one rectangle, and only that rectangle
+ * is copied to the copy framebuffer and flushed from the cache at the next
+ * video_sync().
+ *
+ * @vid: Video device
+ * @x: Left edge of the region, in pixels
+ * @y: Top edge of the region, in pixels
+ * @width: Width of the region, in pixels
+ * @height: Height of the region, in pixels
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
+#if defined(CONFIG_VIDEO_COPY) || defined(CONFIG_VIDEO_DAMAGE)
 /**
  * vidconsole_sync_copy() - Sync back to the copy framebuffer
  *
  * This ensures that the copy framebuffer has the same data as the framebuffer
  * for a particular region. It should be called after the framebuffer is updated
  *
+ * With CONFIG_VIDEO_DAMAGE this only records the region, and the copy is done
+ * by the next video_sync().
+ *
  * @from and @to can be in either order. The region between them is synced.
  *
  * @dev: Vidconsole device being updated
@@ -11,6 +11,7 @@
 #include <malloc.h>
 #include <stdio.h>
 #include <string.h>
+#include <linux/kernel.h>
 
 enum {
 	ALIST_INITIAL_SIZE	= 4,	/* default size of unsized list */
@@ -60,6 +61,12 @@ static bool alist_expand_to(struct alist *lst, uint new_alloc)
 	if (lst->flags & ALISTF_FAIL)
 		return false;
 
+	/* the allocated size must fit in lst->alloc */
+	if (new_alloc > U16_MAX) {
+		lst->flags |= ALISTF_FAIL;
+		return false;
+	}
+
 	/* avoid using realloc() since it increases code size */
 	new_data = malloc(lst->obj_size * new_alloc);
 	if (!new_data) {
@@ -67,11 +74,12 @@ static bool alist_expand_to(struct alist *lst, uint new_alloc)
 		return false;
 	}
 
-	memcpy(new_data, lst->data, lst->obj_size * lst->alloc);
+	/* only the elements in use need to be kept */
+	memcpy(new_data, lst->data, lst->obj_size * lst->count);
 	free(lst->data);
 
-	memset(new_data + lst->obj_size * lst->alloc, '\0',
-	       lst->obj_size * (new_alloc - lst->alloc));
+	memset(new_data + lst->obj_size * lst->count, '\0',
+	       lst->obj_size * (new_alloc - lst->count));
 	lst->alloc = new_alloc;
 	lst->data = new_data;
 
@@ -86,7 +94,8 @@ bool alist_expand_by(struct alist *lst, uint inc_by)
 /**
  * alist_expand_min() - Expand to at least the provided size
  *
- * Expands to the lowest power of two which can incorporate the new size
+ * Expands to the lowest power of two which can incorporate the new size, or
+ * to the largest size allowed if that is smaller
  *
  * @lst: alist to expand
  * @min_alloc: Minimum new allocated size; if 0 then ALIST_INITIAL_SIZE is used
@@ -99,6 +108,8 @@ static bool alist_expand_min(struct alist *lst, uint min_alloc)
 	for (new_alloc = lst->alloc ?: ALIST_INITIAL_SIZE;
 	     new_alloc < min_alloc;)
 		new_alloc *= 2;
+	if (min_alloc <= U16_MAX)
+		new_alloc = min(new_alloc, (uint)U16_MAX);
 
 	return alist_expand_to(lst, new_alloc);
 }
@@ -177,6 +177,33 @@ const uint32_t * ZEXPORT get_crc_table()
 
 /* ========================================================================= */
 
+#if defined(CONFIG_CRC32_SLICE_BY_8) && !defined(USE_HOSTCC) && \
+	!defined(CONFIG_XPL_BUILD) && __BYTE_ORDER == __LITTLE_ENDIAN
+#define CRC32_SLICE_BY_8
+
+/*
+ * crc_table8[k][n] is the CRC of byte n followed by k zero bytes, so that
+ * eight bytes can be folded into the CRC with one lookup each and no
+ * dependency between the lookups. The tables are built from crc_table on
+ * first use.
+ */
+static int __efi_runtime_data crc_table8_empty = 1;
+static uint32_t __efi_runtime_data crc_table8[8][256];
+
+static void __efi_runtime make_crc_table8(void)
+{
+    int k, n;
+
+    for (n = 0; n < 256; n++)
+	 crc_table8[0][n] = crc_table[n];
+    for (k = 1; k < 8; k++)
+	 for (n = 0; n < 256; n++)
+	      crc_table8[k][n] = (crc_table8[k - 1][n] >> 8) ^
+				 crc_table[crc_table8[k - 1][n] & 255];
+    crc_table8_empty = 0;
+}
+#endif
+
 /* No ones complement version. JFFS2 (and other things ?)
  * don't use ones compliment in their CRC calculations.
  */
@@ -184,8 +211,15 @@ uint32_t __efi_runtime crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 {
 #ifdef CONFIG_ARM64_CRC32
     crc = cpu_to_le32(crc);
+    /* Align it, then take eight bytes per instruction */
+    while (len && ((long)buf & 7)) {
+	 crc = __builtin_aarch64_crc32b(crc, *buf++);
+	 len--;
+    }
+    for (; len >= 8; len -= 8, buf += 8)
+	 crc = __builtin_aarch64_crc32x(crc, le64_to_cpu(*(uint64_t *)buf));
     while (len--)
-        crc = __builtin_aarch64_crc32b(crc, *buf++);
+	 crc = __builtin_aarch64_crc32b(crc, *buf++);
     return le32_to_cpu(crc);
 #else
     const uint32_t *tab = crc_table;
@@ -205,6 +239,20 @@ uint32_t __efi_runtime crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 	 b = (uint32_t *)p;
     }
 
+#ifdef CRC32_SLICE_BY_8
+    if (crc_table8_empty)
+	 make_crc_table8();
+    for (; len >= 8; len -= 8, b += 2) {
+	 uint32_t lo = crc ^ b[0];
+	 uint32_t hi = b[1];
+
+	 crc = crc_table8[7][lo & 255] ^ crc_table8[6][(lo >> 8) & 255] ^
+	       crc_table8[5][(lo >> 16) & 255] ^ crc_table8[4][lo >> 24] ^
+	       crc_table8[3][hi & 255] ^ crc_table8[2][(hi >> 8) & 255] ^
+	       crc_table8[1][(hi >> 16) & 255] ^ crc_table8[0][hi >> 24];
+    }
+#endif
+
     rem_len = len & 3;
     len = len >> 2;
     for (--b; len; --len) {
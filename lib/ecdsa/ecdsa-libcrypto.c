@@ -272,6 +272,63 @@ int ecdsa_verify(struct image_sign_info *info,
 	return ret;
 }
 
+/*
+ * Add the multiples of the public key which the software verifier uses, so
+ * that it does not need to work them out at each boot
+ */
+static int add_comb_table(void *fdt, int key_node, const EC_GROUP *group,
+			  const EC_POINT *point, int key_bits)
+{
+	int count = ECDSA_COMB_SIZE(key_bits);
+	int spacing = ECDSA_COMB_SPACING(key_bits);
+	int window = ECDSA_COMB_WINDOW(key_bits);
+	int bytes = key_bits / 8;
+	uint8_t *buf, *ptr;
+	BN_CTX *bn_ctx;
+	BIGNUM *k, *x, *y;
+	EC_POINT *mult;
+	int i, j, ret;
+
+	buf = malloc(count * bytes * 2);
+	bn_ctx = BN_CTX_new();
+	k = BN_new();
+	x = BN_new();
+	y = BN_new();
+	mult = EC_POINT_new(group);
+	ret = -ENOMEM;
+	if (!buf || !bn_ctx || !k || !x || !y || !mult)
+		goto out;
+
+	ret = -EINVAL;
+	for (i = 0, ptr = buf; i < count; i++, ptr += bytes * 2) {
+		BN_one(k);
+		for (j = 1; j < window; j++) {
+			if (i & (1 << (j - 1)))
+				BN_set_bit(k, j * spacing);
+		}
+		if (!EC_POINT_mul(group, mult, NULL, point, k, bn_ctx) ||
+		    !EC_POINT_get_affine_coordinates(group, mult, x, y,
+						     bn_ctx) ||
+		    BN_bn2binpad(x, ptr, bytes) != bytes ||
+		    BN_bn2binpad(y, ptr + bytes, bytes) != bytes) {
+			fprintf(stderr, "Cannot work out ECDSA comb table\n");
+			goto out;
+		}
+	}
+
+	ret = fdt_setprop(fdt, key_node, "ecdsa,comb-table", buf,
+			  count * bytes * 2);
+out:
+	EC_POINT_free(mult);
+	BN_free(y);
+	BN_free(x);
+	BN_free(k);
+	BN_CTX_free(bn_ctx);
+	free(buf);
+
+	return ret;
+}
+
 static int do_add(struct signer *ctx, void *fdt, const char *key_node_name,
 		  struct image_sign_info *info)
 {
@@ -340,6 +397,12 @@ static int do_add(struct signer *ctx, void *fdt, const char *key_node_name,
 	if (ret < 0)
 		return ret;
 
+	if (key_bits == 256 || key_bits == 384) {
+		ret = add_comb_table(fdt, key_node, group, point, key_bits);
+		if (ret < 0)
+			return ret;
+	}
+
 	ret = fdt_setprop_string(fdt, key_node, FIT_ALGO_PROP,
 				 info->name);
 	if (ret < 0)
@@ -56,6 +56,9 @@ static int fdt_get_key(struct ecdsa_public_key *key, const void *fdt, int node)
 		return -EINVAL;
 	}
 
+	/* Optional table of multiples of the key, see ECDSA_COMB_WINDOW() */
+	key->comb = fdt_getprop(fdt, node, "ecdsa,comb-table", &key->comb_len);
+
 	return 0;
 }
 
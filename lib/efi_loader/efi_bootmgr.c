@@ -1112,6 +1112,10 @@ efi_status_t efi_bootmgr_update_media_device_boot_option(void)
 	efi_uintn_t count, num, total;
 	efi_handle_t *handles = NULL;
 	struct eficonfig_media_boot_option *opt = NULL;
+	efi_status_t ret2;
+
+	/* write the variable file once for all boot options changed */
+	efi_var_batch_start();
 
 	ret = efi_locate_handle_buffer_int(BY_PROTOCOL,
 					   &efi_block_io_guid,
@@ -1186,8 +1190,11 @@ out:
 	free(opt);
 	efi_free_pool(handles);
 
+	ret2 = efi_var_batch_end();
 	if (ret == EFI_NOT_FOUND)
-		return EFI_SUCCESS;
+		ret = EFI_SUCCESS;
+	if (ret == EFI_SUCCESS)
+		ret = ret2;
 	return ret;
 }
 
@@ -41,6 +41,12 @@ static LIST_HEAD(efi_event_queue);
 /* Flag to disable timer activity in ExitBootServices() */
 static bool timers_enabled = true;
 
+/*
+ * Earliest time (in us) at which any armed timer event may fire. It may be
+ * earlier than the true next deadline, but never later.
+ */
+static u64 efi_timer_next = -1ULL;
+
 /* Flag used by the selftest to avoid detaching devices in ExitBootServices() */
 bool efi_st_keep_devices;
 
@@ -592,6 +598,8 @@ efi_status_t efi_search_protocol(const efi_handle_t handle,
 	efiobj = efi_search_obj(handle);
 	if (!efiobj)
 		return EFI_INVALID_PARAMETER;
+	if (!guidcmp(protocol_guid, &efi_simple_file_system_protocol_guid))
+		efi_disk_fs_probe(efiobj);
 	list_for_each(lhandle, &efiobj->protocols) {
 		struct efi_handler *protocol;
 
@@ -855,29 +863,33 @@ static efi_status_t EFIAPI efi_create_event_ext(
  *
  * Our timers have to work without interrupts, so we check whenever keyboard
  * input or disk accesses happen if enough time elapsed for them to fire.
+ *
+ * The list of events is only walked once the earliest deadline has passed,
+ * so that frequent calls are cheap even if many timer events exist.
  */
 void efi_timer_check(void)
 {
 	struct efi_event *evt;
 	u64 now = timer_get_us();
 
-	list_for_each_entry(evt, &efi_events, link) {
-		if (!timers_enabled)
-			continue;
-		if (!(evt->type & EVT_TIMER) || now < evt->trigger_next)
-			continue;
-		switch (evt->trigger_type) {
-		case EFI_TIMER_RELATIVE:
-			evt->trigger_type = EFI_TIMER_STOP;
-			break;
-		case EFI_TIMER_PERIODIC:
-			evt->trigger_next += evt->trigger_time;
-			break;
-		default:
-			continue;
+	if (timers_enabled && now >= efi_timer_next) {
+		efi_timer_next = -1ULL;
+		list_for_each_entry(evt, &efi_events, link) {
+			if (!(evt->type & EVT_TIMER) ||
+			    evt->trigger_type == EFI_TIMER_STOP)
+				continue;
+			if (now >= evt->trigger_next) {
+				if (evt->trigger_type == EFI_TIMER_RELATIVE)
+					evt->trigger_type = EFI_TIMER_STOP;
+				else
+					evt->trigger_next += evt->trigger_time;
+				evt->is_signaled = false;
+				efi_signal_event(evt);
+			}
+			if (evt->trigger_type != EFI_TIMER_STOP &&
+			    evt->trigger_next < efi_timer_next)
+				efi_timer_next = evt->trigger_next;
 		}
-		evt->is_signaled = false;
-		efi_signal_event(evt);
 	}
 	efi_process_event_queue();
 	schedule();
@@ -914,6 +926,8 @@ efi_status_t efi_set_timer(struct efi_event *event, enum efi_timer_delay type,
 	case EFI_TIMER_PERIODIC:
 	case EFI_TIMER_RELATIVE:
 		event->trigger_next = timer_get_us() + trigger_time;
+		if (event->trigger_next < efi_timer_next)
+			efi_timer_next = event->trigger_next;
 		break;
 	default:
 		return EFI_INVALID_PARAMETER;
@@ -2236,6 +2250,7 @@ static efi_status_t EFIAPI efi_exit_boot_services(efi_handle_t image_handle,
 		if (IS_ENABLED(CONFIG_USB_DEVICE))
 			udc_disconnect();
 		board_quiesce_devices();
+		flush();
 		dm_remove_devices_active();
 	}
 
@@ -2516,6 +2531,7 @@ static efi_status_t EFIAPI efi_protocols_per_handle(
 	if (!efiobj)
 		return EFI_EXIT(EFI_INVALID_PARAMETER);
 
+	efi_disk_fs_probe(efiobj);
 	*protocol_buffer_count = list_count_nodes(&efiobj->protocols);
 
 	/* Copy GUIDs */
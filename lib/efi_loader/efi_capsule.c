@@ -316,78 +316,115 @@ int efi_get_public_key_data(void **pkey, efi_uintn_t *pkey_len)
 	return 0;
 }
 
-efi_status_t efi_capsule_authenticate(const void *capsule, efi_uintn_t capsule_size,
-				      void **image, efi_uintn_t *image_size)
+efi_status_t efi_capsule_auth_start(const void *capsule,
+				    efi_uintn_t capsule_size, void **image,
+				    efi_uintn_t *image_size,
+				    struct efi_capsule_auth *auth)
 {
-	u8 *buf;
 	int ret;
 	void *fdt_pkey, *pkey;
 	efi_uintn_t pkey_len;
-	uint64_t monotonic_count;
-	struct efi_signature_store *truststore;
-	struct pkcs7_message *capsule_sig;
-	struct efi_image_regions *regs;
 	struct efi_firmware_image_authentication *auth_hdr;
-	efi_status_t status;
 
-	status = EFI_SECURITY_VIOLATION;
-	capsule_sig = NULL;
-	truststore = NULL;
-	regs = NULL;
+	memset(auth, '\0', sizeof(*auth));
 
 	/* Sanity checks */
 	if (capsule == NULL || capsule_size == 0)
-		goto out;
+		return EFI_SECURITY_VIOLATION;
 
 	*image = (uint8_t *)capsule;
 	*image_size = capsule_size;
 	if (efi_remove_auth_hdr(image, image_size) != EFI_SUCCESS)
-		goto out;
+		return EFI_SECURITY_VIOLATION;
 
 	auth_hdr = (struct efi_firmware_image_authentication *)capsule;
 	if (guidcmp(&auth_hdr->auth_info.cert_type, &efi_guid_cert_type_pkcs7))
-		goto out;
+		return EFI_SECURITY_VIOLATION;
 
-	memcpy(&monotonic_count, &auth_hdr->monotonic_count,
-	       sizeof(monotonic_count));
+	memcpy(&auth->monotonic_count, &auth_hdr->monotonic_count,
+	       sizeof(auth->monotonic_count));
 
-	/* data to be digested */
-	regs = calloc(sizeof(*regs) + sizeof(struct image_region) * 2, 1);
-	if (!regs)
-		goto out;
-
-	regs->max = 2;
-	efi_image_region_add(regs, (uint8_t *)*image,
-			     (uint8_t *)*image + *image_size, 1);
-
-	efi_image_region_add(regs, (uint8_t *)&monotonic_count,
-			     (uint8_t *)&monotonic_count + sizeof(monotonic_count),
-			     1);
-
-	capsule_sig = efi_parse_pkcs7_header(auth_hdr->auth_info.cert_data,
-					     auth_hdr->auth_info.hdr.dwLength
-					     - sizeof(auth_hdr->auth_info),
-					     &buf);
-	if (!capsule_sig) {
+	auth->sig = efi_parse_pkcs7_header(auth_hdr->auth_info.cert_data,
+					   auth_hdr->auth_info.hdr.dwLength
+					   - sizeof(auth_hdr->auth_info),
+					   &auth->sig_buf);
+	if (!auth->sig) {
 		debug("Parsing variable's pkcs7 header failed\n");
-		goto out;
+		goto err;
 	}
 
 	ret = efi_get_public_key_data(&fdt_pkey, &pkey_len);
 	if (ret < 0)
-		goto out;
+		goto err;
 
 	pkey = malloc(pkey_len);
 	if (!pkey)
-		goto out;
+		goto err;
 
 	memcpy(pkey, fdt_pkey, pkey_len);
-	truststore = efi_build_signature_store(pkey, pkey_len);
-	if (!truststore)
+	auth->truststore = efi_build_signature_store(pkey, pkey_len);
+	if (!auth->truststore)
+		goto err;
+
+	return EFI_SUCCESS;
+
+err:
+	efi_capsule_auth_finish(auth, NULL);
+
+	return EFI_SECURITY_VIOLATION;
+}
+
+efi_status_t efi_capsule_auth_finish(struct efi_capsule_auth *auth,
+				     const u8 *digest)
+{
+	efi_status_t status = EFI_SECURITY_VIOLATION;
+
+	if (digest) {
+		if (efi_signature_verify_digest(digest, auth->sig,
+						auth->truststore, NULL)) {
+			debug("Verified\n");
+			status = EFI_SUCCESS;
+		} else {
+			debug("Verifying variable's signature failed\n");
+		}
+	}
+
+	efi_sigstore_free(auth->truststore);
+	pkcs7_free_message(auth->sig);
+	free(auth->sig_buf);
+	memset(auth, '\0', sizeof(*auth));
+
+	return status;
+}
+
+efi_status_t efi_capsule_authenticate(const void *capsule, efi_uintn_t capsule_size,
+				      void **image, efi_uintn_t *image_size)
+{
+	struct efi_capsule_auth auth;
+	struct efi_image_regions *regs;
+	efi_status_t status;
+
+	status = efi_capsule_auth_start(capsule, capsule_size, image,
+					image_size, &auth);
+	if (status != EFI_SUCCESS)
+		return status;
+
+	/* data to be digested */
+	status = EFI_SECURITY_VIOLATION;
+	regs = calloc(sizeof(*regs) + sizeof(struct image_region) * 2, 1);
+	if (!regs)
 		goto out;
 
+	regs->max = 2;
+	efi_image_region_add(regs, (uint8_t *)*image,
+			     (uint8_t *)*image + *image_size, 1);
+
+	efi_image_region_add(regs, (uint8_t *)&auth.monotonic_count,
+			     (uint8_t *)&auth.monotonic_count +
+			     sizeof(auth.monotonic_count), 1);
+
 	/* verify signature */
-	if (efi_signature_verify(regs, capsule_sig, truststore, NULL)) {
+	if (efi_signature_verify(regs, auth.sig, auth.truststore, NULL)) {
 		debug("Verified\n");
 	} else {
 		debug("Verifying variable's signature failed\n");
@@ -397,8 +434,7 @@ efi_status_t efi_capsule_authenticate(const void *capsule, efi_uintn_t capsule_s
 	status = EFI_SUCCESS;
 
 out:
-	efi_sigstore_free(truststore);
-	pkcs7_free_message(capsule_sig);
+	efi_capsule_auth_finish(&auth, NULL);
 	free(regs);
 
 	return status;
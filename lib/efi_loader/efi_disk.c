@@ -24,6 +24,7 @@ struct efi_system_partition efi_system_partition = {
 };
 
 const efi_guid_t efi_block_io_guid = EFI_BLOCK_IO_PROTOCOL_GUID;
+const efi_guid_t efi_block_io2_guid = EFI_BLOCK_IO2_PROTOCOL_GUID;
 const efi_guid_t efi_system_partition_guid = PARTITION_SYSTEM_GUID;
 
 /**
@@ -31,18 +32,32 @@ const efi_guid_t efi_system_partition_guid = PARTITION_SYSTEM_GUID;
  *
  * @header:	EFI object header
  * @ops:	EFI disk I/O protocol interface
+ * @ops2:	EFI disk I/O 2 protocol interface
  * @media:	block I/O media information
  * @dp:		device path to the block device
  * @volume:	simple file system protocol of the partition
+ * @desc:	internal block device
+ * @part:	partition number, 0 for the whole disk
+ * @fs_link:	link in efi_disk_fs_list while the file system check is pending
  */
 struct efi_disk_obj {
 	struct efi_object header;
 	struct efi_block_io ops;
+	struct efi_block_io2 ops2;
 	struct efi_block_io_media media;
 	struct efi_device_path *dp;
 	struct efi_simple_file_system_protocol *volume;
+	struct blk_desc *desc;
+	unsigned int part;
+	struct list_head fs_link;
 };
 
+/*
+ * Disk objects which may carry a file system. The file system is only probed
+ * when the simple file system protocol is first looked up on the handle.
+ */
+static LIST_HEAD(efi_disk_fs_list);
+
 /**
  * efi_disk_reset() - reset block device
  *
@@ -147,6 +162,37 @@ static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
 	return EFI_SUCCESS;
 }
 
+/**
+ * efi_disk_check_access() - check the parameters of a block access
+ *
+ * @media:		media information of the block device
+ * @media_id:		id of the medium to be accessed
+ * @lba:		starting logical block
+ * @buffer_size:	size of the buffer
+ * @buffer:		pointer to the buffer
+ * Return:		status code
+ */
+static efi_status_t efi_disk_check_access(struct efi_block_io_media *media,
+					  u32 media_id, u64 lba,
+					  efi_uintn_t buffer_size,
+					  void *buffer)
+{
+	/* TODO: check for media changes */
+	if (media_id != media->media_id)
+		return EFI_MEDIA_CHANGED;
+	if (!media->media_present)
+		return EFI_NO_MEDIA;
+	/* media->io_align is a power of 2 or 0 */
+	if (media->io_align &&
+	    (uintptr_t)buffer & (media->io_align - 1))
+		return EFI_INVALID_PARAMETER;
+	if (lba * media->block_size + buffer_size >
+	    (media->last_block + 1) * media->block_size)
+		return EFI_INVALID_PARAMETER;
+
+	return EFI_SUCCESS;
+}
+
 /**
  * efi_disk_read_blocks() - reads blocks from device
  *
@@ -171,18 +217,10 @@ static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
 
 	if (!this)
 		return EFI_INVALID_PARAMETER;
-	/* TODO: check for media changes */
-	if (media_id != this->media->media_id)
-		return EFI_MEDIA_CHANGED;
-	if (!this->media->media_present)
-		return EFI_NO_MEDIA;
-	/* media->io_align is a power of 2 or 0 */
-	if (this->media->io_align &&
-	    (uintptr_t)buffer & (this->media->io_align - 1))
-		return EFI_INVALID_PARAMETER;
-	if (lba * this->media->block_size + buffer_size >
-	    (this->media->last_block + 1) * this->media->block_size)
-		return EFI_INVALID_PARAMETER;
+	r = efi_disk_check_access(this->media, media_id, lba, buffer_size,
+				  buffer);
+	if (r != EFI_SUCCESS)
+		return r;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
@@ -239,18 +277,10 @@ static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
 		return EFI_INVALID_PARAMETER;
 	if (this->media->read_only)
 		return EFI_WRITE_PROTECTED;
-	/* TODO: check for media changes */
-	if (media_id != this->media->media_id)
-		return EFI_MEDIA_CHANGED;
-	if (!this->media->media_present)
-		return EFI_NO_MEDIA;
-	/* media->io_align is a power of 2 or 0 */
-	if (this->media->io_align &&
-	    (uintptr_t)buffer & (this->media->io_align - 1))
-		return EFI_INVALID_PARAMETER;
-	if (lba * this->media->block_size + buffer_size >
-	    (this->media->last_block + 1) * this->media->block_size)
-		return EFI_INVALID_PARAMETER;
+	r = efi_disk_check_access(this->media, media_id, lba, buffer_size,
+				  buffer);
+	if (r != EFI_SUCCESS)
+		return r;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
@@ -307,6 +337,335 @@ static const struct efi_block_io block_io_disk_template = {
 	.flush_blocks = &efi_disk_flush_blocks,
 };
 
+/**
+ * struct efi_disk_io2_req - asynchronous read started by ReadBlocksEx()
+ *
+ * @link:	entry in efi_disk_io2_list
+ * @token:	token to complete when the read has finished
+ * @req:	block device request
+ */
+struct efi_disk_io2_req {
+	struct list_head link;
+	struct efi_block_io2_token *token;
+	struct blk_request req;
+};
+
+/* Reads started by ReadBlocksEx() which have not been signalled yet */
+static LIST_HEAD(efi_disk_io2_list);
+/* Timer event used to check for completed reads */
+static struct efi_event *efi_disk_io2_event;
+
+/**
+ * efi_disk_io2_signal() - complete a Block IO 2 token
+ *
+ * @token:	token to complete
+ * @status:	result of the transaction
+ */
+static void efi_disk_io2_signal(struct efi_block_io2_token *token,
+				efi_status_t status)
+{
+	token->transaction_status = status;
+	efi_signal_event(token->event);
+}
+
+/**
+ * efi_disk_io2_finish() - complete a finished asynchronous read
+ *
+ * @r:		request, which is freed
+ * @ret:	result of the block device request
+ */
+static void efi_disk_io2_finish(struct efi_disk_io2_req *r, int ret)
+{
+	efi_status_t status = EFI_SUCCESS;
+
+	if (ret < 0 || r->req.done != r->req.blkcnt)
+		status = EFI_DEVICE_ERROR;
+	list_del(&r->link);
+	efi_disk_io2_signal(r->token, status);
+	free(r);
+}
+
+/**
+ * efi_disk_io2_poll() - signal all asynchronous reads which have finished
+ */
+static void efi_disk_io2_poll(void)
+{
+	struct efi_disk_io2_req *r, *n;
+	int ret;
+
+	list_for_each_entry_safe(r, n, &efi_disk_io2_list, link) {
+		ret = blk_poll(&r->req);
+		if (ret != -EBUSY)
+			efi_disk_io2_finish(r, ret);
+	}
+}
+
+/**
+ * efi_disk_io2_wait() - finish the asynchronous read on a block device
+ *
+ * Block devices only handle one asynchronous request at a time, so this is
+ * called before starting another one and before the device is removed.
+ *
+ * @dev:	block device (UCLASS_BLK)
+ */
+static void efi_disk_io2_wait(struct udevice *dev)
+{
+	struct efi_disk_io2_req *r, *n;
+
+	list_for_each_entry_safe(r, n, &efi_disk_io2_list, link) {
+		if (r->req.dev == dev)
+			efi_disk_io2_finish(r, blk_wait(&r->req));
+	}
+}
+
+/**
+ * efi_disk_io2_notify() - check for completed asynchronous reads
+ *
+ * This notification function is called in every timer cycle.
+ *
+ * @event:	the event for which this notification function is registered
+ * @context:	event context - not used in this function
+ */
+static void EFIAPI efi_disk_io2_notify(struct efi_event *event, void *context)
+{
+	EFI_ENTRY("%p, %p", event, context);
+	efi_disk_io2_poll();
+	EFI_EXIT(EFI_SUCCESS);
+}
+
+/**
+ * efi_disk_io2_blk() - get the block device and its LBA for a disk access
+ *
+ * @diskobj:	disk or partition object
+ * @lba:	logical block within @diskobj, updated to the block device
+ * Return:	block device (UCLASS_BLK)
+ */
+static struct udevice *efi_disk_io2_blk(struct efi_disk_obj *diskobj,
+					u64 *lba)
+{
+	struct udevice *dev = diskobj->header.dev;
+
+	if (CONFIG_IS_ENABLED(PARTITIONS) &&
+	    device_get_uclass_id(dev) == UCLASS_PARTITION) {
+		struct disk_part *part = dev_get_uclass_plat(dev);
+
+		*lba += part->gpt_part_info.start;
+		dev = dev_get_parent(dev);
+	}
+
+	return dev;
+}
+
+/**
+ * efi_disk_reset_ex() - reset block device
+ *
+ * This function implements the Reset service of the EFI_BLOCK_IO2_PROTOCOL.
+ *
+ * As U-Boot's block devices do not have a reset function simply return
+ * EFI_SUCCESS.
+ *
+ * See the Unified Extensible Firmware Interface (UEFI) specification for
+ * details.
+ *
+ * @this:			pointer to the BLOCK_IO2_PROTOCOL
+ * @extended_verification:	extended verification
+ * Return:			status code
+ */
+static efi_status_t EFIAPI efi_disk_reset_ex(struct efi_block_io2 *this,
+					     bool extended_verification)
+{
+	EFI_ENTRY("%p, %x", this, extended_verification);
+	return EFI_EXIT(EFI_SUCCESS);
+}
+
+/**
+ * efi_disk_read_blocks_ex() - reads blocks from device
+ *
+ * This function implements the ReadBlocksEx service of the
+ * EFI_BLOCK_IO2_PROTOCOL.
+ *
+ * If a token with an event is provided, the read is started and the event is
+ * signalled once it has finished. Without a token the read is synchronous.
+ *
+ * See the Unified Extensible Firmware Interface (UEFI) specification for
+ * details.
+ *
+ * @this:			pointer to the BLOCK_IO2_PROTOCOL
+ * @media_id:			id of the medium to be read from
+ * @lba:			starting logical block for reading
+ * @token:			token to signal on completion, may be NULL
+ * @buffer_size:		size of the read buffer
+ * @buffer:			pointer to the destination buffer
+ * Return:			status code
+ */
+static efi_status_t EFIAPI efi_disk_read_blocks_ex(struct efi_block_io2 *this,
+			u32 media_id, u64 lba, struct efi_block_io2_token *token,
+			efi_uintn_t buffer_size, void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	struct efi_disk_io2_req *r;
+	struct udevice *dev;
+	efi_status_t ret;
+
+	EFI_ENTRY("%p, %x, %llx, %p, %zx, %p", this, media_id, lba, token,
+		  buffer_size, buffer);
+
+	if (!this) {
+		ret = EFI_INVALID_PARAMETER;
+		goto out;
+	}
+	diskobj = container_of(this, struct efi_disk_obj, ops2);
+
+	if (!token || !token->event) {
+		ret = EFI_CALL(efi_disk_read_blocks(&diskobj->ops, media_id,
+						    lba, buffer_size, buffer));
+		goto out;
+	}
+
+	ret = efi_disk_check_access(this->media, media_id, lba, buffer_size,
+				    buffer);
+	if (ret != EFI_SUCCESS)
+		goto out;
+	if (buffer_size & (this->media->block_size - 1)) {
+		ret = EFI_BAD_BUFFER_SIZE;
+		goto out;
+	}
+
+	/* The shared bounce buffer cannot be used in the background */
+	if (IS_ENABLED(CONFIG_EFI_LOADER_BOUNCE_BUFFER) || !buffer_size) {
+		efi_disk_io2_signal(token,
+			EFI_CALL(efi_disk_read_blocks(&diskobj->ops, media_id,
+						      lba, buffer_size,
+						      buffer)));
+		goto out;
+	}
+
+	if (!efi_disk_io2_event) {
+		ret = efi_create_event(EVT_TIMER | EVT_NOTIFY_SIGNAL,
+				       TPL_CALLBACK, efi_disk_io2_notify, NULL,
+				       NULL, &efi_disk_io2_event);
+		if (ret != EFI_SUCCESS)
+			goto out;
+		ret = efi_set_timer(efi_disk_io2_event, EFI_TIMER_PERIODIC, 0);
+		if (ret != EFI_SUCCESS)
+			goto out;
+	}
+
+	r = calloc(1, sizeof(*r));
+	if (!r) {
+		ret = EFI_OUT_OF_RESOURCES;
+		goto out;
+	}
+	r->token = token;
+	token->transaction_status = EFI_NOT_READY;
+
+	dev = efi_disk_io2_blk(diskobj, &lba);
+	efi_disk_io2_wait(dev);
+	if (blk_submit(dev, &r->req, lba, buffer_size / this->media->block_size,
+		       buffer)) {
+		free(r);
+		ret = EFI_DEVICE_ERROR;
+		goto out;
+	}
+	list_add_tail(&r->link, &efi_disk_io2_list);
+
+	/* Devices without asynchronous support have already finished */
+	efi_disk_io2_poll();
+out:
+	return EFI_EXIT(ret);
+}
+
+/**
+ * efi_disk_write_blocks_ex() - writes blocks to device
+ *
+ * This function implements the WriteBlocksEx service of the
+ * EFI_BLOCK_IO2_PROTOCOL.
+ *
+ * Writes are always done synchronously. If a token is provided, its event is
+ * signalled before returning.
+ *
+ * See the Unified Extensible Firmware Interface (UEFI) specification for
+ * details.
+ *
+ * @this:			pointer to the BLOCK_IO2_PROTOCOL
+ * @media_id:			id of the medium to be written to
+ * @lba:			starting logical block for writing
+ * @token:			token to signal on completion, may be NULL
+ * @buffer_size:		size of the write buffer
+ * @buffer:			pointer to the source buffer
+ * Return:			status code
+ */
+static efi_status_t EFIAPI efi_disk_write_blocks_ex(struct efi_block_io2 *this,
+			u32 media_id, u64 lba, struct efi_block_io2_token *token,
+			efi_uintn_t buffer_size, void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	efi_status_t ret;
+
+	EFI_ENTRY("%p, %x, %llx, %p, %zx, %p", this, media_id, lba, token,
+		  buffer_size, buffer);
+
+	if (!this) {
+		ret = EFI_INVALID_PARAMETER;
+		goto out;
+	}
+	diskobj = container_of(this, struct efi_disk_obj, ops2);
+
+	if (token && token->event) {
+		if (this->media->read_only) {
+			ret = EFI_WRITE_PROTECTED;
+			goto out;
+		}
+		ret = efi_disk_check_access(this->media, media_id, lba,
+					    buffer_size, buffer);
+		if (ret != EFI_SUCCESS)
+			goto out;
+	}
+
+	efi_disk_io2_wait(efi_disk_io2_blk(diskobj, &lba));
+	ret = EFI_CALL(efi_disk_write_blocks(&diskobj->ops, media_id, lba,
+					     buffer_size, buffer));
+	if (token && token->event) {
+		efi_disk_io2_signal(token, ret);
+		ret = EFI_SUCCESS;
+	}
+out:
+	return EFI_EXIT(ret);
+}
+
+/**
+ * efi_disk_flush_blocks_ex() - flushes modified data to the device
+ *
+ * This function implements the FlushBlocksEx service of the
+ * EFI_BLOCK_IO2_PROTOCOL.
+ *
+ * As we always write synchronously nothing is done here.
+ *
+ * See the Unified Extensible Firmware Interface (UEFI) specification for
+ * details.
+ *
+ * @this:			pointer to the BLOCK_IO2_PROTOCOL
+ * @token:			token to signal on completion, may be NULL
+ * Return:			status code
+ */
+static efi_status_t EFIAPI efi_disk_flush_blocks_ex(struct efi_block_io2 *this,
+			struct efi_block_io2_token *token)
+{
+	EFI_ENTRY("%p, %p", this, token);
+
+	if (token && token->event)
+		efi_disk_io2_signal(token, EFI_SUCCESS);
+
+	return EFI_EXIT(EFI_SUCCESS);
+}
+
+static const struct efi_block_io2 block_io2_disk_template = {
+	.reset = &efi_disk_reset_ex,
+	.read_blocks_ex = &efi_disk_read_blocks_ex,
+	.write_blocks_ex = &efi_disk_write_blocks_ex,
+	.flush_blocks_ex = &efi_disk_flush_blocks_ex,
+};
+
 /**
  * efi_fs_from_path() - retrieve simple file system protocol
  *
@@ -371,11 +730,54 @@ static int efi_fs_exists(struct blk_desc *desc, int part)
 	return 1;
 }
 
+/**
+ * efi_disk_fs_probe() - install the simple file system protocol on demand
+ *
+ * If the file system check for a disk object is still pending, probe for a
+ * file system and install the simple file system protocol if one is found.
+ * This is called whenever the protocol is looked up on a handle.
+ *
+ * @handle:	handle to check
+ */
+void efi_disk_fs_probe(efi_handle_t handle)
+{
+	struct efi_disk_obj *pos, *diskobj = NULL;
+	efi_status_t ret;
+
+	list_for_each_entry(pos, &efi_disk_fs_list, fs_link) {
+		if (&pos->header == handle) {
+			diskobj = pos;
+			break;
+		}
+	}
+	if (!diskobj)
+		return;
+
+	list_del_init(&diskobj->fs_link);
+	if (!efi_fs_exists(diskobj->desc, diskobj->part))
+		return;
+
+	ret = efi_create_simple_file_system(diskobj->desc, diskobj->part,
+					    diskobj->dp, &diskobj->volume);
+	if (ret != EFI_SUCCESS)
+		return;
+
+	ret = efi_add_protocol(&diskobj->header,
+			       &efi_simple_file_system_protocol_guid,
+			       diskobj->volume);
+	if (ret != EFI_SUCCESS) {
+		log_err("Failed to install simple file system protocol\n");
+		free(diskobj->volume);
+		diskobj->volume = NULL;
+	}
+}
+
 static void efi_disk_free_diskobj(struct efi_disk_obj *diskobj)
 {
 	struct efi_device_path *dp = diskobj->dp;
 	struct efi_simple_file_system_protocol *volume = diskobj->volume;
 
+	list_del_init(&diskobj->fs_link);
 	/*
 	 * ignore error of efi_delete_handle() since this function
 	 * is expected to be called in error path.
@@ -418,6 +820,9 @@ static efi_status_t efi_disk_add_dev(
 	diskobj = calloc(1, sizeof(*diskobj));
 	if (!diskobj)
 		return EFI_OUT_OF_RESOURCES;
+	INIT_LIST_HEAD(&diskobj->fs_link);
+	diskobj->desc = desc;
+	diskobj->part = part;
 
 	/* Hook up to the device list */
 	efi_add_handle(&diskobj->header);
@@ -487,23 +892,21 @@ static efi_status_t efi_disk_add_dev(
 	}
 
 	/*
-	 * On partitions or whole disks without partitions install the
-	 * simple file system protocol if a file system is available.
+	 * On partitions or whole disks without partitions the simple file
+	 * system protocol is installed if a file system is available. Probing
+	 * for it is deferred to efi_disk_fs_probe().
 	 */
-	if ((part || desc->part_type == PART_TYPE_UNKNOWN) &&
-	    efi_fs_exists(desc, part)) {
-		ret = efi_create_simple_file_system(desc, part, diskobj->dp,
-						    &diskobj->volume);
-		if (ret != EFI_SUCCESS)
-			goto error;
-
-		ret = efi_add_protocol(&diskobj->header,
-				       &efi_simple_file_system_protocol_guid,
-				       diskobj->volume);
+	if (part || desc->part_type == PART_TYPE_UNKNOWN)
+		list_add_tail(&diskobj->fs_link, &efi_disk_fs_list);
+	diskobj->ops = block_io_disk_template;
+	if (IS_ENABLED(CONFIG_EFI_BLOCK_IO2_PROTOCOL)) {
+		diskobj->ops2 = block_io2_disk_template;
+		diskobj->ops2.media = &diskobj->media;
+		ret = efi_add_protocol(&diskobj->header, &efi_block_io2_guid,
+				       &diskobj->ops2);
 		if (ret != EFI_SUCCESS)
 			goto error;
 	}
-	diskobj->ops = block_io_disk_template;
 
 	/* Fill in EFI IO Media info (for read/write callbacks) */
 	diskobj->media.removable_media = desc->removable;
@@ -737,6 +1140,9 @@ int efi_disk_remove(void *ctx, struct event *event)
 			return 0;
 
 		diskobj = (struct efi_disk_obj *)handle;
+		/* This also covers reads started through its partitions */
+		if (IS_ENABLED(CONFIG_EFI_BLOCK_IO2_PROTOCOL))
+			efi_disk_io2_wait(dev);
 		break;
 	case UCLASS_PARTITION:
 		diskobj = (struct efi_disk_obj *)handle;
@@ -748,6 +1154,7 @@ int efi_disk_remove(void *ctx, struct event *event)
 		return 0;
 	}
 
+	list_del_init(&diskobj->fs_link);
 	dp = diskobj->dp;
 	volume = diskobj->volume;
 
@@ -14,6 +14,7 @@
 #include <mapmem.h>
 #include <fs.h>
 #include <part.h>
+#include <linux/sizes.h>
 
 /* GUID for file system information */
 const efi_guid_t efi_file_system_info_guid = EFI_FILE_SYSTEM_INFO_GUID;
@@ -26,6 +27,9 @@ struct file_system {
 	struct efi_device_path *dp;
 	struct blk_desc *desc;
 	int part;
+	/* partition information and filesystem type found on first access */
+	struct disk_partition part_info;
+	int fstype;
 };
 #define to_fs(x) container_of(x, struct file_system, base)
 
@@ -40,10 +44,21 @@ struct file_handle {
 	struct fs_dir_stream *dirs;
 	struct fs_dirent *dent;
 
+	/* cached file size and read-ahead, valid while write_count matches: */
+	uint write_count;
+	bool size_valid;
+	loff_t size;
+	void *ra_buf;
+	loff_t ra_start;
+	loff_t ra_len;
+
 	char path[0];
 };
 #define to_fh(x) container_of(x, struct file_handle, base)
 
+/* Reads smaller than this are served from the per-handle read-ahead buffer */
+#define EFI_FILE_RA_SIZE	SZ_64K
+
 static const struct efi_file_handle efi_file_handle_protocol;
 
 static char *basename(struct file_handle *fh)
@@ -54,9 +69,58 @@ static char *basename(struct file_handle *fh)
 	return fh->path;
 }
 
+/**
+ * set_blk_dev() - select the filesystem of a file handle
+ *
+ * The partition information and the filesystem type are looked up on first
+ * use and reused afterwards, so that later calls only need to probe the one
+ * filesystem driver which is known to match.
+ *
+ * @fh:		file handle
+ * Return:	0 on success, non-zero if no filesystem was found
+ */
 static int set_blk_dev(struct file_handle *fh)
 {
-	return fs_set_blk_dev_with_part(fh->fs->desc, fh->fs->part);
+	struct file_system *fs = fh->fs;
+	int ret;
+
+	if (fs->fstype != FS_TYPE_ANY) {
+		if (!fs_set_blk_dev_with_part_info(fs->desc, fs->part,
+						   &fs->part_info, fs->fstype))
+			return 0;
+		/* The medium may have changed, start again */
+		fs->fstype = FS_TYPE_ANY;
+	}
+
+	if (fs->part >= 1)
+		ret = part_get_info(fs->desc, fs->part, &fs->part_info);
+	else
+		ret = part_get_info_whole_disk(fs->desc, &fs->part_info);
+	if (ret)
+		return ret;
+
+	ret = fs_set_blk_dev_with_part_info(fs->desc, fs->part, &fs->part_info,
+					    FS_TYPE_ANY);
+	if (!ret)
+		fs->fstype = fs_get_type();
+
+	return ret;
+}
+
+/**
+ * check_cache() - drop cached file data if the device has been written
+ *
+ * @fh:		file handle
+ */
+static void check_cache(struct file_handle *fh)
+{
+	uint write_count = fh->fs->desc->write_count;
+
+	if (fh->write_count != write_count) {
+		fh->size_valid = false;
+		fh->ra_len = 0;
+		fh->write_count = write_count;
+	}
 }
 
 /**
@@ -368,6 +432,7 @@ out:
 static efi_status_t file_close(struct file_handle *fh)
 {
 	fs_closedir(fh->dirs);
+	free(fh->ra_buf);
 	free(fh);
 	return EFI_SUCCESS;
 }
@@ -409,12 +474,21 @@ static efi_status_t EFIAPI efi_file_delete(struct efi_file_handle *file)
 static efi_status_t efi_get_file_size(struct file_handle *fh,
 				      loff_t *file_size)
 {
+	check_cache(fh);
+	if (fh->size_valid) {
+		*file_size = fh->size;
+		return EFI_SUCCESS;
+	}
+
 	if (set_blk_dev(fh))
 		return EFI_DEVICE_ERROR;
 
 	if (fs_size(fh->path, file_size))
 		return EFI_DEVICE_ERROR;
 
+	fh->size = *file_size;
+	fh->size_valid = true;
+
 	return EFI_SUCCESS;
 }
 
@@ -457,12 +531,56 @@ out:
 	return ret;
 }
 
+/**
+ * file_read_ahead() - serve a small read from the read-ahead buffer
+ *
+ * The buffer is refilled from the current position if it does not cover the
+ * requested range.
+ *
+ * @fh:		file handle
+ * @len:	number of bytes to read, less than EFI_FILE_RA_SIZE
+ * @file_size:	size of the file
+ * @buffer:	buffer to fill
+ * @actread:	returns number of bytes read
+ * Return:	0 on success, -ve on error
+ */
+static int file_read_ahead(struct file_handle *fh, loff_t len,
+			   loff_t file_size, void *buffer, loff_t *actread)
+{
+	loff_t ra_len;
+
+	if (fh->offset < fh->ra_start ||
+	    fh->offset + len > fh->ra_start + fh->ra_len) {
+		if (!fh->ra_buf) {
+			fh->ra_buf = malloc(EFI_FILE_RA_SIZE);
+			if (!fh->ra_buf)
+				return -ENOMEM;
+		}
+		fh->ra_len = 0;
+		if (set_blk_dev(fh))
+			return -EIO;
+		ra_len = min_t(loff_t, EFI_FILE_RA_SIZE,
+			       file_size - fh->offset);
+		if (fs_read(fh->path, map_to_sysmem(fh->ra_buf), fh->offset,
+			    ra_len, &ra_len))
+			return -EIO;
+		fh->ra_start = fh->offset;
+		fh->ra_len = ra_len;
+	}
+
+	*actread = min(len, fh->ra_start + fh->ra_len - fh->offset);
+	memcpy(buffer, fh->ra_buf + (fh->offset - fh->ra_start), *actread);
+
+	return 0;
+}
+
 static efi_status_t file_read(struct file_handle *fh, u64 *buffer_size,
 		void *buffer)
 {
 	loff_t actread;
 	efi_status_t ret;
 	loff_t file_size;
+	loff_t len;
 
 	if (!buffer) {
 		ret = EFI_INVALID_PARAMETER;
@@ -477,11 +595,17 @@ static efi_status_t file_read(struct file_handle *fh, u64 *buffer_size,
 		return ret;
 	}
 
-	if (set_blk_dev(fh))
-		return EFI_DEVICE_ERROR;
-	if (fs_read(fh->path, map_to_sysmem(buffer), fh->offset,
-		    *buffer_size, &actread))
-		return EFI_DEVICE_ERROR;
+	len = min_t(u64, *buffer_size, file_size - fh->offset);
+	actread = 0;
+	/* Small reads go through the read-ahead buffer, large ones directly */
+	if (len && (len >= EFI_FILE_RA_SIZE ||
+		    file_read_ahead(fh, len, file_size, buffer, &actread))) {
+		if (set_blk_dev(fh))
+			return EFI_DEVICE_ERROR;
+		if (fs_read(fh->path, map_to_sysmem(buffer), fh->offset,
+			    len, &actread))
+			return EFI_DEVICE_ERROR;
+	}
 
 	*buffer_size = actread;
 	fh->offset += actread;
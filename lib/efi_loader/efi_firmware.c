@@ -13,10 +13,12 @@
 #include <efi_loader.h>
 #include <efi_variable.h>
 #include <fwu.h>
+#include <hash.h>
 #include <image.h>
 #include <signatures.h>
 
 #include <linux/list.h>
+#include <u-boot/sha256.h>
 
 #define FMP_PAYLOAD_HDR_SIGNATURE	SIGNATURE_32('M', 'S', 'S', '1')
 
@@ -519,6 +521,36 @@ static void efi_firmware_get_fw_version(const void **p_image,
 	}
 }
 
+/**
+ * efi_firmware_check_version - check the version of an image
+ * @image_index:	Image index
+ * @state:		Pointer to fmp state
+ *
+ * Check if the fw_version is equal or greater than the lowest supported
+ * version.
+ *
+ * Return:		status code
+ */
+static efi_status_t efi_firmware_check_version(u8 image_index,
+					       struct fmp_state *state)
+{
+	u32 lsv;
+	efi_guid_t *image_type_id;
+
+	image_type_id = efi_firmware_get_image_type_id(image_index);
+	if (!image_type_id)
+		return EFI_INVALID_PARAMETER;
+
+	efi_firmware_get_lsv_from_dtb(image_index, image_type_id, &lsv);
+	if (state->fw_version < lsv) {
+		log_err("Firmware version %u too low. Expecting >= %u. Aborting update\n",
+			state->fw_version, lsv);
+		return EFI_INVALID_PARAMETER;
+	}
+
+	return EFI_SUCCESS;
+}
+
 /**
  * efi_firmware_verify_image - verify image
  * @p_image:		Pointer to new image
@@ -537,9 +569,7 @@ efi_status_t efi_firmware_verify_image(const void **p_image,
 				       u8 image_index,
 				       struct fmp_state *state)
 {
-	u32 lsv;
 	efi_status_t ret;
-	efi_guid_t *image_type_id;
 
 	ret = efi_firmware_capsule_authenticate(p_image, p_image_size);
 	if (ret != EFI_SUCCESS)
@@ -547,18 +577,7 @@ efi_status_t efi_firmware_verify_image(const void **p_image,
 
 	efi_firmware_get_fw_version(p_image, p_image_size, state);
 
-	image_type_id = efi_firmware_get_image_type_id(image_index);
-	if (!image_type_id)
-		return EFI_INVALID_PARAMETER;
-
-	efi_firmware_get_lsv_from_dtb(image_index, image_type_id, &lsv);
-	if (state->fw_version < lsv) {
-		log_err("Firmware version %u too low. Expecting >= %u. Aborting update\n",
-			state->fw_version, lsv);
-		return EFI_INVALID_PARAMETER;
-	}
-
-	return ret;
+	return efi_firmware_check_version(image_index, state);
 }
 
 /**
@@ -687,6 +706,89 @@ const struct efi_firmware_management_protocol efi_fmp_fit = {
  * method with raw data.
  */
 
+/**
+ * efi_firmware_raw_write_verified - write an image and authenticate it
+ * @image:		New image, with its authentication header
+ * @image_size:		Size of new image
+ * @image_index:	Image index
+ * @state:		Pointer to fmp state
+ *
+ * With multi-bank update the image goes to the bank which is not being
+ * booted, and that bank is only made active once every image in the capsule
+ * has been written successfully. So the image can be hashed while it is
+ * written, rather than in a separate pass beforehand. If the signature turns
+ * out to be wrong, the update fails and the active bank is left as it is.
+ *
+ * Return:		status code
+ */
+static efi_status_t efi_firmware_raw_write_verified(const void *image,
+						    efi_uintn_t image_size,
+						    u8 image_index,
+						    struct fmp_state *state)
+{
+	u8 digest[SHA256_SUM_LEN];
+	struct efi_capsule_auth auth;
+	struct hash_algo *algo;
+	const void *payload;
+	efi_uintn_t size;
+	efi_status_t status;
+	void *signed_data;
+	u8 dfu_alt_num;
+	void *ctx;
+	int ret;
+
+	status = efi_capsule_auth_start(image, image_size, &signed_data, &size,
+					&auth);
+	if (status == EFI_SECURITY_VIOLATION) {
+		printf("Capsule authentication check failed. Aborting update\n");
+		return status;
+	} else if (status != EFI_SUCCESS) {
+		return status;
+	}
+
+	payload = signed_data;
+	efi_firmware_get_fw_version(&payload, &size, state);
+	status = efi_firmware_check_version(image_index, state);
+	if (status != EFI_SUCCESS)
+		goto err;
+
+	status = EFI_DEVICE_ERROR;
+	if (fwu_get_dfu_alt_num(image_index, &dfu_alt_num)) {
+		log_debug("Unable to get FWU image_index\n");
+		goto err;
+	}
+
+	if (hash_lookup_algo("sha256", &algo) || algo->hash_init(algo, &ctx))
+		goto err;
+
+	/* The FMP payload header is signed too, but is not written */
+	ret = algo->hash_update(algo, ctx, signed_data, payload - signed_data,
+				0);
+	if (!ret)
+		ret = dfu_write_by_alt_hash(dfu_alt_num, (void *)payload, size,
+					    NULL, NULL, algo, ctx);
+	if (!ret)
+		ret = algo->hash_update(algo, ctx, &auth.monotonic_count,
+					sizeof(auth.monotonic_count), 1);
+	algo->hash_finish(algo, ctx, digest, sizeof(digest));
+	if (ret)
+		goto err;
+
+	status = efi_capsule_auth_finish(&auth, digest);
+	if (status != EFI_SUCCESS) {
+		printf("Capsule authentication check failed. Aborting update\n");
+		return status;
+	}
+	debug("Capsule authentication successful\n");
+
+	return EFI_SUCCESS;
+
+err:
+	efi_capsule_auth_finish(&auth, NULL);
+
+	return status;
+}
+
 /**
  * efi_firmware_raw_set_image - update the firmware image
  * @this:		Protocol instance
@@ -724,6 +826,18 @@ efi_status_t EFIAPI efi_firmware_raw_set_image(
 	if (!image)
 		return EFI_EXIT(EFI_INVALID_PARAMETER);
 
+	if (IS_ENABLED(CONFIG_FWU_MULTI_BANK_UPDATE) &&
+	    IS_ENABLED(CONFIG_EFI_CAPSULE_AUTHENTICATE)) {
+		status = efi_firmware_raw_write_verified(image, image_size,
+							 image_index, &state);
+		if (status != EFI_SUCCESS)
+			return EFI_EXIT(status);
+
+		efi_firmware_set_fmp_state_var(&state, image_index);
+
+		return EFI_EXIT(EFI_SUCCESS);
+	}
+
 	status = efi_firmware_verify_image(&image, &image_size, image_index,
 					   &state);
 	if (status != EFI_SUCCESS)
@@ -298,38 +298,6 @@ static int cmp_pe_section(const void *arg1, const void *arg2)
 		return 1;
 }
 
-/**
- * efi_prepare_aligned_image() - prepare 8-byte aligned image
- * @efi:		pointer to the EFI binary
- * @efi_size:		size of @efi binary
- *
- * If @efi is not 8-byte aligned, this function newly allocates
- * the image buffer.
- *
- * Return:	valid pointer to a image, return NULL if allocation fails.
- */
-void *efi_prepare_aligned_image(void *efi, u64 *efi_size)
-{
-	size_t new_efi_size;
-	void *new_efi;
-
-	/*
-	 * Size must be 8-byte aligned and the trailing bytes must be
-	 * zero'ed. Otherwise hash value may be incorrect.
-	 */
-	if (!IS_ALIGNED(*efi_size, 8)) {
-		new_efi_size = ALIGN(*efi_size, 8);
-		new_efi = calloc(new_efi_size, 1);
-		if (!new_efi)
-			return NULL;
-		memcpy(new_efi, efi, *efi_size);
-		*efi_size = new_efi_size;
-		return new_efi;
-	} else {
-		return efi;
-	}
-}
-
 /**
  * efi_image_parse() - parse a PE image
  * @efi:	Pointer to image
@@ -340,6 +308,8 @@ void *efi_prepare_aligned_image(void *efi, u64 *efi_size)
  *
  * Parse image binary in PE32(+) format, assuming that sanity of PE image
  * has been checked by a caller.
+ * The digest covers the image padded with zeroes to a multiple of 8 bytes.
+ * The padding is taken from a static buffer, so @efi need not be copied.
  * On success, an address of authentication data in @efi and its size will
  * be returned in @auth and @auth_len, respectively.
  *
@@ -348,6 +318,7 @@ void *efi_prepare_aligned_image(void *efi, u64 *efi_size)
 bool efi_image_parse(void *efi, size_t len, struct efi_image_regions **regp,
 		     WIN_CERTIFICATE **auth, size_t *auth_len)
 {
+	static const u8 zero_pad[8];
 	struct efi_image_regions *regs;
 	IMAGE_DOS_HEADER *dos;
 	IMAGE_NT_HEADERS32 *nt;
@@ -355,7 +326,7 @@ bool efi_image_parse(void *efi, size_t len, struct efi_image_regions **regp,
 	int num_regions, num_sections, i;
 	int ctidx = IMAGE_DIRECTORY_ENTRY_SECURITY;
 	u32 align, size, authsz, authoff;
-	size_t bytes_hashed;
+	size_t bytes_hashed, extra_end;
 
 	dos = (void *)efi;
 	nt = (void *)(efi + dos->e_lfanew);
@@ -369,7 +340,7 @@ bool efi_image_parse(void *efi, size_t len, struct efi_image_regions **regp,
 	 */
 	num_regions = 3; /* for header */
 	num_regions += nt->FileHeader.NumberOfSections;
-	num_regions++; /* for extra */
+	num_regions += 2; /* for extra and padding */
 
 	regs = calloc(sizeof(*regs) + sizeof(struct image_region) * num_regions,
 		      1);
@@ -473,11 +444,17 @@ bool efi_image_parse(void *efi, size_t len, struct efi_image_regions **regp,
 	free(sorted);
 
 	/* 3. Extra data excluding Certificates Table */
-	if (bytes_hashed + authsz < len) {
+	if (bytes_hashed + authsz < ALIGN(len, 8)) {
+		extra_end = ALIGN(len, 8) - authsz;
 		log_debug("extra data for hash: %zu\n",
-			  len - (bytes_hashed + authsz));
-		efi_image_region_add(regs, efi + bytes_hashed,
-				     efi + len - authsz, 0);
+			  extra_end - bytes_hashed);
+		if (bytes_hashed < len)
+			efi_image_region_add(regs, efi + bytes_hashed,
+					     efi + min(len, extra_end), 0);
+		if (extra_end > len)
+			efi_image_region_add(regs, zero_pad, zero_pad +
+					     extra_end - max(len, bytes_hashed),
+					     1);
 	}
 
 	/* Return Certificates Table */
@@ -585,9 +562,7 @@ static bool efi_image_authenticate(void *efi, size_t efi_size)
 	size_t wincerts_len;
 	struct pkcs7_message *msg = NULL;
 	struct efi_signature_store *db = NULL, *dbx = NULL;
-	void *new_efi = NULL;
 	u8 *auth, *wincerts_end;
-	u64 new_efi_size = efi_size;
 	size_t auth_size;
 	bool ret = false;
 
@@ -596,11 +571,7 @@ static bool efi_image_authenticate(void *efi, size_t efi_size)
 	if (!efi_secure_boot_enabled())
 		return true;
 
-	new_efi = efi_prepare_aligned_image(efi, &new_efi_size);
-	if (!new_efi)
-		return false;
-
-	if (!efi_image_parse(new_efi, new_efi_size, &regs, &wincerts,
+	if (!efi_image_parse(efi, efi_size, &regs, &wincerts,
 			     &wincerts_len)) {
 		log_err("Parsing PE executable image failed\n");
 		goto out;
@@ -748,8 +719,6 @@ out:
 	efi_sigstore_free(dbx);
 	pkcs7_free_message(msg);
 	free(regs);
-	if (new_efi != efi)
-		free(new_efi);
 
 	log_debug("%s: Exit, %d\n", __func__, ret);
 	return ret;
@@ -959,9 +928,10 @@ efi_status_t efi_load_pe(struct efi_loaded_image_obj *handle,
 		u32 copy_size = section_size(sec);
 
 		if (copy_size > sec->SizeOfRawData) {
+			/* Only the part not backed by the file needs zeroing */
 			copy_size = sec->SizeOfRawData;
-			memset(efi_reloc + sec->VirtualAddress, 0,
-			       sec->Misc.VirtualSize);
+			memset(efi_reloc + sec->VirtualAddress + copy_size, 0,
+			       sec->Misc.VirtualSize - copy_size);
 		}
 		memcpy(efi_reloc + sec->VirtualAddress,
 		       efi + sec->PointerToRawData,
@@ -17,7 +17,6 @@
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/sections.h>
-#include <linux/list_sort.h>
 #include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -32,12 +31,12 @@ struct efi_mem_list {
 	struct efi_mem_desc desc;
 };
 
-#define EFI_CARVE_NO_OVERLAP		-1
-#define EFI_CARVE_LOOP_AGAIN		-2
-#define EFI_CARVE_OVERLAPS_NONRAM	-3
-#define EFI_CARVE_OUT_OF_RESOURCES	-4
-
-/* This list contains all memory map items */
+/*
+ * This list contains all memory map items, sorted from highest address to
+ * lowest, so that allocation starts from the highest address chunk. Items do
+ * not overlap and adjacent items with the same type and attributes are
+ * always merged, so each change only needs to look at the items it touches.
+ */
 static LIST_HEAD(efi_mem);
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
@@ -83,33 +82,6 @@ static u64 checksum(struct efi_pool_allocation *alloc)
 	return ret;
 }
 
-/**
- * efi_mem_cmp() - comparator function for sorting memory map
- *
- * Sorts the memory list from highest address to lowest address
- *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
- *
- * @priv:	unused
- * @a:		first memory area
- * @b:		second memory area
- * Return:	1 if @a is before @b, -1 if @b is before @a, 0 if equal
- */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
-{
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
-
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
-}
-
 /**
  * desc_get_end() - get end address of memory area
  *
@@ -122,139 +94,115 @@ static uint64_t desc_get_end(struct efi_mem_desc *desc)
 }
 
 /**
- * efi_mem_sort() - sort memory map
+ * efi_mem_merge() - merge a memory area with its neighbours
  *
- * Sort the memory map and then try to merge adjacent memory areas.
+ * @lmem:	memory area, which has just been added to the map
  */
-static void efi_mem_sort(void)
+static void efi_mem_merge(struct efi_mem_list *lmem)
 {
-	struct efi_mem_list *lmem;
-	struct efi_mem_list *prevmem = NULL;
-	bool merge_again = true;
-
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
-
-	/* Now merge entries that can be merged */
-	while (merge_again) {
-		merge_again = false;
-		list_for_each_entry(lmem, &efi_mem, link) {
-			struct efi_mem_desc *prev;
-			struct efi_mem_desc *cur;
-			uint64_t pages;
-
-			if (!prevmem) {
-				prevmem = lmem;
-				continue;
-			}
-
-			cur = &lmem->desc;
-			prev = &prevmem->desc;
-
-			if ((desc_get_end(cur) == prev->physical_start) &&
-			    (prev->type == cur->type) &&
-			    (prev->attribute == cur->attribute)) {
-				/* There is an existing map before, reuse it */
-				pages = cur->num_pages;
-				prev->num_pages += pages;
-				prev->physical_start -= pages << EFI_PAGE_SHIFT;
-				prev->virtual_start -= pages << EFI_PAGE_SHIFT;
-				list_del(&lmem->link);
-				free(lmem);
-
-				merge_again = true;
-				break;
-			}
-
-			prevmem = lmem;
+	struct efi_mem_list *other;
+
+	/* The area above, which comes first in the list */
+	if (lmem->link.prev != &efi_mem) {
+		other = list_entry(lmem->link.prev, struct efi_mem_list, link);
+		if (desc_get_end(&lmem->desc) == other->desc.physical_start &&
+		    lmem->desc.type == other->desc.type &&
+		    lmem->desc.attribute == other->desc.attribute) {
+			lmem->desc.num_pages += other->desc.num_pages;
+			list_del(&other->link);
+			free(other);
+		}
+	}
+
+	/* The area below */
+	if (lmem->link.next != &efi_mem) {
+		other = list_entry(lmem->link.next, struct efi_mem_list, link);
+		if (desc_get_end(&other->desc) == lmem->desc.physical_start &&
+		    lmem->desc.type == other->desc.type &&
+		    lmem->desc.attribute == other->desc.attribute) {
+			other->desc.num_pages += lmem->desc.num_pages;
+			list_del(&lmem->link);
+			free(lmem);
 		}
 	}
 }
 
 /**
- * efi_mem_carve_out() - unmap memory region
+ * efi_mem_carve_out() - unmap a memory region
  *
- * @map:			memory map
- * @carve_desc:			memory region to unmap
+ * Removes the region [@start, @end) from the map. Map items which partly
+ * overlap it are shrunk, or split if the region is in their middle.
+ *
+ * @start:			start address of the region
+ * @end:			end address of the region
  * @overlap_conventional:	the carved out region may only overlap free,
  *				or conventional memory
- * Return:			the number of overlapping pages which have been
- *				removed from the map,
- *				EFI_CARVE_NO_OVERLAP, if the regions don't
- *				overlap, EFI_CARVE_OVERLAPS_NONRAM, if the carve
- *				and map overlap, and the map contains anything
- *				but free ram(only when overlap_conventional is
- *				true),
- *				EFI_CARVE_LOOP_AGAIN, if the mapping list should
- *				be traversed again, as it has been altered.
- *
- * Unmaps all memory occupied by the carve_desc region from the list entry
- * pointed to by map.
- *
- * In case of EFI_CARVE_OVERLAPS_NONRAM it is the callers responsibility
- * to re-add the already carved out pages to the mapping.
+ * @carvedp:			returns the number of pages which were
+ *				removed from the map
+ * Return:			EFI_SUCCESS, EFI_NO_MAPPING if the region
+ *				overlaps anything but free RAM and
+ *				@overlap_conventional is true, or
+ *				EFI_OUT_OF_RESOURCES
+ *
+ * In case of EFI_NO_MAPPING it is the callers responsibility to re-add the
+ * already carved out pages to the mapping.
  */
-static s64 efi_mem_carve_out(struct efi_mem_list *map,
-			     struct efi_mem_desc *carve_desc,
-			     bool overlap_conventional)
+static efi_status_t efi_mem_carve_out(u64 start, u64 end,
+				      bool overlap_conventional,
+				      u64 *carvedp)
 {
-	struct efi_mem_list *newmap;
-	struct efi_mem_desc *map_desc = &map->desc;
-	uint64_t map_start = map_desc->physical_start;
-	uint64_t map_end = map_start + (map_desc->num_pages << EFI_PAGE_SHIFT);
-	uint64_t carve_start = carve_desc->physical_start;
-	uint64_t carve_end = carve_start +
-			     (carve_desc->num_pages << EFI_PAGE_SHIFT);
-
-	/* check whether we're overlapping */
-	if ((carve_end <= map_start) || (carve_start >= map_end))
-		return EFI_CARVE_NO_OVERLAP;
-
-	/* We're overlapping with non-RAM, warn the caller if desired */
-	if (overlap_conventional && (map_desc->type != EFI_CONVENTIONAL_MEMORY))
-		return EFI_CARVE_OVERLAPS_NONRAM;
-
-	/* Sanitize carve_start and carve_end to lie within our bounds */
-	carve_start = max(carve_start, map_start);
-	carve_end = min(carve_end, map_end);
-
-	/* Carving at the beginning of our map? Just move it! */
-	if (carve_start == map_start) {
-		if (map_end == carve_end) {
-			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
+	struct efi_mem_list *lmem, *tmp, *newmap;
+
+	*carvedp = 0;
+	list_for_each_entry_safe(lmem, tmp, &efi_mem, link) {
+		struct efi_mem_desc *desc = &lmem->desc;
+		u64 map_start = desc->physical_start;
+		u64 map_end = desc_get_end(desc);
+
+		/* Skip areas above the region, stop at the first one below */
+		if (map_start >= end)
+			continue;
+		if (map_end <= start)
+			break;
+
+		/* We're overlapping with non-RAM, warn the caller if desired */
+		if (overlap_conventional &&
+		    desc->type != EFI_CONVENTIONAL_MEMORY)
+			return EFI_NO_MAPPING;
+
+		*carvedp += (min(end, map_end) - max(start, map_start)) >>
+			EFI_PAGE_SHIFT;
+		if (map_start < start && map_end > end) {
+			/*
+			 * Split the area, putting [ end ... map_end ] before
+			 * it, since the list is in descending address order
+			 */
+			newmap = calloc(1, sizeof(*newmap));
+			if (!newmap)
+				return EFI_OUT_OF_RESOURCES;
+			newmap->desc = *desc;
+			newmap->desc.physical_start = end;
+			newmap->desc.virtual_start = end;
+			newmap->desc.num_pages = (map_end - end) >>
+				EFI_PAGE_SHIFT;
+			list_add_tail(&newmap->link, &lmem->link);
+			desc->num_pages = (start - map_start) >> EFI_PAGE_SHIFT;
+		} else if (map_start < start) {
+			/* Keep [ map_start ... start ] */
+			desc->num_pages = (start - map_start) >> EFI_PAGE_SHIFT;
+		} else if (map_end > end) {
+			/* Keep [ end ... map_end ] */
+			desc->physical_start = end;
+			desc->virtual_start = end;
+			desc->num_pages = (map_end - end) >> EFI_PAGE_SHIFT;
 		} else {
-			map->desc.physical_start = carve_end;
-			map->desc.virtual_start = carve_end;
-			map->desc.num_pages = (map_end - carve_end)
-					      >> EFI_PAGE_SHIFT;
+			/* Full overlap, just remove map */
+			list_del(&lmem->link);
+			free(lmem);
 		}
-
-		return (carve_end - carve_start) >> EFI_PAGE_SHIFT;
 	}
 
-	/*
-	 * Overlapping maps, just split the list map at carve_start,
-	 * it will get moved or removed in the next iteration.
-	 *
-	 * [ map_desc |__carve_start__| newmap ]
-	 */
-
-	/* Create a new map from [ carve_start ... map_end ] */
-	newmap = calloc(1, sizeof(*newmap));
-	if (!newmap)
-		return EFI_CARVE_OUT_OF_RESOURCES;
-	newmap->desc = map->desc;
-	newmap->desc.physical_start = carve_start;
-	newmap->desc.virtual_start = carve_start;
-	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
-
-	/* Shrink the map to [ map_start ... carve_start ] */
-	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
-
-	return EFI_CARVE_LOOP_AGAIN;
+	return EFI_SUCCESS;
 }
 
 /**
@@ -275,9 +223,9 @@ efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 {
 	struct efi_mem_list *lmem;
 	struct efi_mem_list *newlist;
-	bool carve_again;
-	uint64_t carved_pages = 0;
+	u64 carved_pages;
 	struct efi_event *evt;
+	efi_status_t ret;
 
 	EFI_PRINT("%s: 0x%llx 0x%llx %d %s\n", __func__,
 		  start, pages, memory_type, overlap_conventional ?
@@ -311,48 +259,13 @@ efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 		break;
 	}
 
-	/* Add our new map */
-	do {
-		carve_again = false;
-		list_for_each_entry(lmem, &efi_mem, link) {
-			s64 r;
-
-			r = efi_mem_carve_out(lmem, &newlist->desc,
-					      overlap_conventional);
-			switch (r) {
-			case EFI_CARVE_OUT_OF_RESOURCES:
-				free(newlist);
-				return EFI_OUT_OF_RESOURCES;
-			case EFI_CARVE_OVERLAPS_NONRAM:
-				/*
-				 * The user requested to only have RAM overlaps,
-				 * but we hit a non-RAM region. Error out.
-				 */
-				free(newlist);
-				return EFI_NO_MAPPING;
-			case EFI_CARVE_NO_OVERLAP:
-				/* Just ignore this list entry */
-				break;
-			case EFI_CARVE_LOOP_AGAIN:
-				/*
-				 * We split an entry, but need to loop through
-				 * the list again to actually carve it.
-				 */
-				carve_again = true;
-				break;
-			default:
-				/* We carved a number of pages */
-				carved_pages += r;
-				carve_again = true;
-				break;
-			}
-
-			if (carve_again) {
-				/* The list changed, we need to start over */
-				break;
-			}
-		}
-	} while (carve_again);
+	/* Make room for our new map */
+	ret = efi_mem_carve_out(start, start + (pages << EFI_PAGE_SHIFT),
+				overlap_conventional, &carved_pages);
+	if (ret != EFI_SUCCESS) {
+		free(newlist);
+		return ret;
+	}
 
 	if (overlap_conventional && (carved_pages != pages)) {
 		/*
@@ -363,11 +276,13 @@ efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 		return EFI_NO_MAPPING;
 	}
 
-	/* Add our new map */
-        list_add_tail(&newlist->link, &efi_mem);
-
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	/* Add our new map, keeping the list in descending order */
+	list_for_each_entry(lmem, &efi_mem, link) {
+		if (lmem->desc.physical_start < start)
+			break;
+	}
+	list_add_tail(&newlist->link, &lmem->link);
+	efi_mem_merge(newlist);
 
 	/* Notify that the memory map was changed */
 	list_for_each_entry(evt, &efi_events, link) {
@@ -427,13 +342,16 @@ static efi_status_t efi_check_allocated(u64 addr, bool must_be_allocated)
 		u64 start = item->desc.physical_start;
 		u64 end = start + (item->desc.num_pages << EFI_PAGE_SHIFT);
 
-		if (addr >= start && addr < end) {
-			if (must_be_allocated ^
-			    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
-				return EFI_SUCCESS;
-			else
-				return EFI_NOT_FOUND;
-		}
+		if (addr < start)
+			continue;
+		/* Areas further on are lower, so cannot hold @addr either */
+		if (addr >= end)
+			break;
+		if (must_be_allocated ^
+		    (item->desc.type == EFI_CONVENTIONAL_MEMORY))
+			return EFI_SUCCESS;
+		else
+			return EFI_NOT_FOUND;
 	}
 
 	return EFI_NOT_FOUND;
@@ -19,6 +19,7 @@
 #include <linux/oid_registry.h>
 #include <u-boot/hash-checksum.h>
 #include <u-boot/rsa.h>
+#include <u-boot/sha256.h>
 
 const efi_guid_t efi_guid_sha256 = EFI_CERT_SHA256_GUID;
 const efi_guid_t efi_guid_cert_rsa2048 = EFI_CERT_RSA2048_GUID;
@@ -489,21 +490,20 @@ out:
 }
 
 /*
- * efi_signature_verify - verify signatures with db and dbx
- * @regs:	List of regions to be authenticated
+ * __efi_signature_verify - verify signatures with db and dbx
+ * @regs:	List of regions to be authenticated, or NULL to use @digest
+ * @digest:	SHA-256 digest of the data to be authenticated, if @regs is NULL
  * @msg:	Signature
  * @db:		Signature database for trusted certificates
  * @dbx:	Revocation signature database
  *
- * All the signature pointed to by @msg against image pointed to by @regs
- * will be verified by signature database pointed to by @db and @dbx.
- *
  * Return:	true if verification for all signatures passed, false otherwise
  */
-bool efi_signature_verify(struct efi_image_regions *regs,
-			  struct pkcs7_message *msg,
-			  struct efi_signature_store *db,
-			  struct efi_signature_store *dbx)
+static bool __efi_signature_verify(struct efi_image_regions *regs,
+				   const u8 *digest,
+				   struct pkcs7_message *msg,
+				   struct efi_signature_store *db,
+				   struct efi_signature_store *dbx)
 {
 	struct pkcs7_signed_info *sinfo;
 	struct x509_certificate *signer, *root;
@@ -512,7 +512,7 @@ bool efi_signature_verify(struct efi_image_regions *regs,
 
 	EFI_PRINT("%s: Enter, %p, %p, %p, %p\n", __func__, regs, msg, db, dbx);
 
-	if (!regs || !msg || !db || !db->sig_data_list)
+	if ((!regs && !digest) || !msg || !db || !db->sig_data_list)
 		goto out;
 
 	for (sinfo = msg->signed_infos; sinfo; sinfo = sinfo->next) {
@@ -526,11 +526,17 @@ bool efi_signature_verify(struct efi_image_regions *regs,
 		 * hash calculation will be done in
 		 * pkcs7_verify_one().
 		 */
-		if (!msg->data &&
-		    !efi_hash_regions(regs->reg, regs->num,
-				      (void **)&sinfo->sig->digest,
-				      guid_to_sha_str(&efi_guid_sha256),
-				      NULL)) {
+		if (!msg->data && !regs) {
+			if (!sinfo->sig->digest)
+				sinfo->sig->digest = malloc(SHA256_SUM_LEN);
+			if (!sinfo->sig->digest)
+				goto out;
+			memcpy(sinfo->sig->digest, digest, SHA256_SUM_LEN);
+		} else if (!msg->data &&
+			   !efi_hash_regions(regs->reg, regs->num,
+					     (void **)&sinfo->sig->digest,
+					     guid_to_sha_str(&efi_guid_sha256),
+					     NULL)) {
 			EFI_PRINT("Digesting an image failed\n");
 			goto out;
 		}
@@ -571,6 +577,48 @@ out:
 	return verified;
 }
 
+/*
+ * efi_signature_verify - verify signatures with db and dbx
+ * @regs:	List of regions to be authenticated
+ * @msg:	Signature
+ * @db:		Signature database for trusted certificates
+ * @dbx:	Revocation signature database
+ *
+ * All the signature pointed to by @msg against image pointed to by @regs
+ * will be verified by signature database pointed to by @db and @dbx.
+ *
+ * Return:	true if verification for all signatures passed, false otherwise
+ */
+bool efi_signature_verify(struct efi_image_regions *regs,
+			  struct pkcs7_message *msg,
+			  struct efi_signature_store *db,
+			  struct efi_signature_store *dbx)
+{
+	if (!regs)
+		return false;
+
+	return __efi_signature_verify(regs, NULL, msg, db, dbx);
+}
+
+/*
+ * efi_signature_verify_digest - verify detached signatures of a digest
+ * @digest:	SHA-256 digest of the data to be authenticated
+ * @msg:	Signature
+ * @db:		Signature database for trusted certificates
+ * @dbx:	Revocation signature database
+ *
+ * This is the same as efi_signature_verify() but for data which the caller
+ * has hashed already, e.g. while writing it out.
+ *
+ * Return:	true if verification for all signatures passed, false otherwise
+ */
+bool efi_signature_verify_digest(const u8 *digest, struct pkcs7_message *msg,
+				 struct efi_signature_store *db,
+				 struct efi_signature_store *dbx)
+{
+	return __efi_signature_verify(NULL, digest, msg, db, dbx);
+}
+
 /**
  * efi_signature_check_signers - check revocation against all signers with dbx
  * @msg:	Signature
@@ -382,18 +382,13 @@ static efi_status_t tcg2_hash_pe_image(void *efi, u64 efi_size,
 	WIN_CERTIFICATE *wincerts = NULL;
 	size_t wincerts_len;
 	struct efi_image_regions *regs = NULL;
-	void *new_efi = NULL;
 	u8 hash[TPM2_SHA512_DIGEST_SIZE];
 	struct udevice *dev;
 	efi_status_t ret = EFI_SUCCESS;
 	u32 active;
 	int i;
 
-	new_efi = efi_prepare_aligned_image(efi, &efi_size);
-	if (!new_efi)
-		return EFI_OUT_OF_RESOURCES;
-
-	if (!efi_image_parse(new_efi, efi_size, &regs, &wincerts,
+	if (!efi_image_parse(efi, efi_size, &regs, &wincerts,
 			     &wincerts_len)) {
 		log_err("Parsing PE executable image failed\n");
 		ret = EFI_UNSUPPORTED;
@@ -439,8 +434,6 @@ static efi_status_t tcg2_hash_pe_image(void *efi, u64 efi_size,
 	}
 
 out:
-	if (new_efi != efi)
-		free(new_efi);
 	free(regs);
 
 	return ret;
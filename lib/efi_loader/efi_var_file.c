@@ -50,16 +50,14 @@ static efi_status_t __maybe_unused efi_set_blk_dev_to_system_partition(void)
 	return EFI_SUCCESS;
 }
 
+#ifdef CONFIG_EFI_VARIABLE_FILE_STORE
 /**
- * efi_var_to_file() - save non-volatile variables as file
- *
- * File ubootefi.var is created on the EFI system partion.
+ * efi_var_write_file() - write non-volatile variables to the file
  *
  * Return:	status code
  */
-efi_status_t efi_var_to_file(void)
+static efi_status_t efi_var_write_file(void)
 {
-#ifdef CONFIG_EFI_VARIABLE_FILE_STORE
 	efi_status_t ret;
 	struct efi_var_file *buf;
 	loff_t len;
@@ -91,11 +89,50 @@ error:
 out:
 	free(buf);
 	return ret;
+}
+#endif
+
+/* Nesting depth of efi_var_batch_start() */
+static int efi_var_batch_depth;
+/* A write to the variable file has been deferred */
+static bool efi_var_batch_dirty;
+
+/**
+ * efi_var_to_file() - save non-volatile variables as file
+ *
+ * File ubootefi.var is created on the EFI system partion.
+ *
+ * Return:	status code
+ */
+efi_status_t efi_var_to_file(void)
+{
+#ifdef CONFIG_EFI_VARIABLE_FILE_STORE
+	if (efi_var_batch_depth) {
+		efi_var_batch_dirty = true;
+		return EFI_SUCCESS;
+	}
+
+	return efi_var_write_file();
 #else
 	return EFI_SUCCESS;
 #endif
 }
 
+void efi_var_batch_start(void)
+{
+	++efi_var_batch_depth;
+}
+
+efi_status_t efi_var_batch_end(void)
+{
+	if (--efi_var_batch_depth || !efi_var_batch_dirty)
+		return EFI_SUCCESS;
+
+	efi_var_batch_dirty = false;
+
+	return efi_var_to_file();
+}
+
 efi_status_t efi_var_restore(struct efi_var_file *buf, bool safe)
 {
 	struct efi_var_entry *var, *last_var;
@@ -21,6 +21,86 @@ static struct efi_var_file __efi_runtime_data *efi_var_buf;
 static struct efi_var_entry __efi_runtime_data *efi_current_var;
 static const u16 __efi_runtime_rodata vtf[] = u"VarToFile";
 
+/*
+ * Hash index over GUID and name. Each slot holds the offset of a variable
+ * relative to efi_var_buf, 0 marks an empty slot. Offsets stay valid across
+ * SetVirtualAddressMap(). If too many variables exist the index is disabled
+ * and lookups fall back to scanning the buffer.
+ */
+#define EFI_VAR_HASH_SIZE	1024
+#define EFI_VAR_HASH_MASK	(EFI_VAR_HASH_SIZE - 1)
+
+static u32 __efi_runtime_data efi_var_hash[EFI_VAR_HASH_SIZE];
+static u32 __efi_runtime_data efi_var_hash_count;
+static bool __efi_runtime_data efi_var_hash_ok;
+
+/**
+ * efi_var_mem_hash() - compute hash of a variable's GUID and name
+ *
+ * @guid:	GUID of the variable
+ * @name:	name of the variable
+ * Return:	hash value
+ */
+static u32 __efi_runtime efi_var_mem_hash(const efi_guid_t *guid,
+					  const u16 *name)
+{
+	const u8 *pos = (const u8 *)guid;
+	u32 hash = 2166136261U;
+	int i;
+
+	for (i = 0; i < sizeof(efi_guid_t); ++i)
+		hash = (hash ^ pos[i]) * 16777619U;
+	for (; *name; ++name)
+		hash = (hash ^ *name) * 16777619U;
+
+	return hash;
+}
+
+/**
+ * efi_var_hash_add() - add a variable to the hash index
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_hash_add(struct efi_var_entry *var)
+{
+	u32 i;
+
+	if (!efi_var_hash_ok)
+		return;
+	if (efi_var_hash_count >= EFI_VAR_HASH_SIZE / 4 * 3) {
+		efi_var_hash_ok = false;
+		return;
+	}
+
+	i = efi_var_mem_hash(&var->guid, var->name) & EFI_VAR_HASH_MASK;
+	while (efi_var_hash[i])
+		i = (i + 1) & EFI_VAR_HASH_MASK;
+	efi_var_hash[i] = (uintptr_t)var - (uintptr_t)efi_var_buf;
+	++efi_var_hash_count;
+}
+
+/**
+ * efi_var_hash_rebuild() - rebuild the hash index from efi_var_buf
+ *
+ * This is needed whenever variables move inside the buffer.
+ */
+static void __efi_runtime efi_var_hash_rebuild(void)
+{
+	struct efi_var_entry *var, *last;
+	int i;
+
+	for (i = 0; i < EFI_VAR_HASH_SIZE; ++i)
+		efi_var_hash[i] = 0;
+	efi_var_hash_count = 0;
+	efi_var_hash_ok = true;
+
+	last = (struct efi_var_entry *)
+	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	for (var = efi_var_buf->var; var < last;
+	     var = (void *)var + efi_var_entry_len(var))
+		efi_var_hash_add(var);
+}
+
 /**
  * efi_var_mem_compare() - compare GUID and name with a variable
  *
@@ -105,6 +185,23 @@ struct efi_var_entry __efi_runtime
 		return efi_current_var;
 	}
 
+	if (efi_var_hash_ok) {
+		u32 i = efi_var_mem_hash(guid, name) & EFI_VAR_HASH_MASK;
+
+		for (; efi_var_hash[i]; i = (i + 1) & EFI_VAR_HASH_MASK) {
+			var = (struct efi_var_entry *)
+			      ((uintptr_t)efi_var_buf + efi_var_hash[i]);
+			if (efi_var_mem_compare(var, guid, name, next)) {
+				if (next && *next >= last)
+					*next = NULL;
+				return var;
+			}
+		}
+		if (next)
+			*next = NULL;
+		return NULL;
+	}
+
 	var = efi_var_buf->var;
 	if (var < last) {
 		for (; var;) {
@@ -152,6 +249,7 @@ void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 	efi_var_buf->crc32 = crc32(0, (u8 *)efi_var_buf->var,
 				   efi_var_buf->length -
 				   sizeof(struct efi_var_file));
+	efi_var_hash_rebuild();
 }
 
 efi_status_t __efi_runtime efi_var_mem_ins(
@@ -162,11 +260,12 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 				const u64 time)
 {
 	u16 *data;
-	struct efi_var_entry *var;
+	struct efi_var_entry *var, *new_var;
 	u32 var_name_len;
 
 	var = (struct efi_var_entry *)
 	      ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	new_var = var;
 	var_name_len = u16_strlen(variable_name) + 1;
 	data = var->name + var_name_len;
 
@@ -190,6 +289,7 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 	efi_var_buf->crc32 = crc32(0, (u8 *)efi_var_buf->var,
 				   efi_var_buf->length -
 				   sizeof(struct efi_var_file));
+	efi_var_hash_add(new_var);
 
 	return EFI_SUCCESS;
 }
@@ -234,6 +334,7 @@ efi_status_t efi_var_mem_init(void)
 	efi_var_buf->magic = EFI_VAR_FILE_MAGIC;
 	efi_var_buf->length = (uintptr_t)efi_var_buf->var -
 			      (uintptr_t)efi_var_buf;
+	efi_var_hash_rebuild();
 
 	ret = efi_create_event(EVT_SIGNAL_VIRTUAL_ADDRESS_CHANGE, TPL_CALLBACK,
 			       efi_var_mem_notify_virtual_address_map, NULL,
@@ -399,4 +500,6 @@ skip:
 void efi_var_buf_update(struct efi_var_file *var_buf)
 {
 	memcpy(efi_var_buf, var_buf, EFI_VAR_BUF_SIZE);
+	efi_current_var = NULL;
+	efi_var_hash_rebuild();
 }
@@ -12,10 +12,12 @@
 #include <image.h>
 #include <malloc.h>
 #include <memalign.h>
+#include <time.h>
 #include <u-boot/crc.h>
 #include <watchdog.h>
 #include <u-boot/zlib.h>
 #include <asm/sections.h>
+#include <asm/unaligned.h>
 
 #define HEADER0			'\x1f'
 #define HEADER1			'\x8b'
@@ -82,6 +84,102 @@ __rcode int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *len
 	return zunzip(dst, dstlen, src, lenp, 1, offset);
 }
 
+/**
+ * struct gunzip_stream - state of a piecewise decompression
+ *
+ * @s: zlib state
+ * @crc: CRC32 of the data decompressed so far
+ * @started: true once the gzip header has been skipped
+ * @ended: true once the end of the deflate stream has been seen
+ * @trailer_len: Number of bytes collected in @trailer
+ * @trailer: gzip trailer: CRC32 and length of the uncompressed data
+ */
+struct gunzip_stream {
+	z_stream s;
+	u32 crc;
+	bool started;
+	bool ended;
+	int trailer_len;
+	u8 trailer[8];
+};
+
+struct gunzip_stream *gunzip_stream_start(void *dst, ulong dstlen)
+{
+	struct gunzip_stream *gz;
+
+	gz = calloc(1, sizeof(*gz));
+	if (!gz)
+		return NULL;
+
+	gz->s.zalloc = gzalloc;
+	gz->s.zfree = gzfree;
+	if (inflateInit2(&gz->s, -MAX_WBITS) != Z_OK) {
+		free(gz);
+		return NULL;
+	}
+	gz->s.next_out = dst;
+	gz->s.avail_out = dstlen;
+
+	return gz;
+}
+
+int gunzip_stream_feed(struct gunzip_stream *gz, const void *src, ulong len)
+{
+	const unsigned char *in = src;
+	unsigned char *out;
+	int n, r;
+
+	if (!gz->started) {
+		if (len < 10 || in[0] != HEADER0 || in[1] != HEADER1)
+			return -EINVAL;
+		n = gzip_parse_header(in, len);
+		if (n < 0)
+			return -EINVAL;
+		in += n;
+		len -= n;
+		gz->started = true;
+	}
+
+	if (!gz->ended && len) {
+		out = gz->s.next_out;
+		gz->s.next_in = (unsigned char *)in;
+		gz->s.avail_in = len;
+		r = inflate(&gz->s, Z_SYNC_FLUSH);
+		gz->crc = crc32(gz->crc, out, gz->s.next_out - out);
+		if (r == Z_STREAM_END)
+			gz->ended = true;
+		else if (r != Z_OK && r != Z_BUF_ERROR)
+			return -EIO;
+		else if (gz->s.avail_in)
+			return -ENOSPC;
+		in = gz->s.next_in;
+		len = gz->s.avail_in;
+	}
+
+	if (gz->ended) {
+		n = min_t(ulong, len, sizeof(gz->trailer) - gz->trailer_len);
+		memcpy(gz->trailer + gz->trailer_len, in, n);
+		gz->trailer_len += n;
+	}
+
+	return gz->trailer_len == sizeof(gz->trailer);
+}
+
+int gunzip_stream_finish(struct gunzip_stream *gz, ulong *lenp)
+{
+	int ret = 0;
+
+	*lenp = gz->s.total_out;
+	if (gz->trailer_len != sizeof(gz->trailer) ||
+	    get_unaligned_le32(gz->trailer) != gz->crc ||
+	    get_unaligned_le32(gz->trailer + 4) != (u32)gz->s.total_out)
+		ret = -EIO;
+	inflateEnd(&gz->s);
+	free(gz);
+
+	return ret;
+}
+
 #ifdef CONFIG_CMD_UNZIP
 __weak
 void gzwrite_progress_init(ulong expectedsize)
@@ -94,8 +192,13 @@ void gzwrite_progress(int iteration,
 		     ulong bytes_written,
 		     ulong total_bytes)
 {
-	if (0 == (iteration & 3))
+	static ulong last;
+
+	/* A slow serial console would otherwise hold up the writes */
+	if (!iteration || get_timer(last) >= 1000) {
 		printf("%lu/%lu\r", bytes_written, total_bytes);
+		last = get_timer(0);
+	}
 }
 
 __weak
@@ -116,6 +219,51 @@ void gzwrite_progress_finish(int returnval,
 	}
 }
 
+/**
+ * gzwrite_start() - Start writing a buffer of decompressed data
+ *
+ * With CONFIG_BLK_ASYNC the write may still be in flight on return, so that
+ * the next buffer can be decompressed meanwhile
+ *
+ * @dev: Block device to write to
+ * @req: Returns the request, to pass to gzwrite_wait()
+ * @start: First block to write
+ * @blkcnt: Number of blocks to write
+ * @buf: Data to write
+ */
+static void gzwrite_start(struct blk_desc *dev, struct blk_request *req,
+			  lbaint_t start, lbaint_t blkcnt, const void *buf)
+{
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	int ret;
+
+	ret = blk_submit_write(dev->bdev, req, start, blkcnt, buf);
+	if (ret) {
+		req->complete = true;
+		req->ret = ret;
+	}
+#else
+	memset(req, '\0', sizeof(*req));
+	req->done = blk_dwrite(dev, start, blkcnt, buf);
+	req->complete = true;
+#endif
+}
+
+/**
+ * gzwrite_wait() - Wait for a write started by gzwrite_start()
+ *
+ * @req: Request to wait for
+ * Return: number of blocks written, or -ve on error
+ */
+static long gzwrite_wait(struct blk_request *req)
+{
+#if CONFIG_IS_ENABLED(BLK_ASYNC)
+	return blk_wait(req);
+#else
+	return req->done;
+#endif
+}
+
 int gzwrite(unsigned char *src, int len,
 	    struct blk_desc *dev,
 	    unsigned long szwritebuf,
@@ -125,7 +273,10 @@ int gzwrite(unsigned char *src, int len,
 	int i, flags;
 	z_stream s;
 	int r = 0;
-	unsigned char *writebuf;
+	unsigned char *writebuf[2];
+	struct blk_request req;
+	bool pending = false;
+	int cur = 0;
 	unsigned crc = 0;
 	ulong totalfilled = 0;
 	lbaint_t blksperbuf, outblock;
@@ -205,7 +356,15 @@ int gzwrite(unsigned char *src, int len,
 
 	s.next_in = src + i;
 	s.avail_in = payload_size+8;
-	writebuf = (unsigned char *)malloc_cache_aligned(szwritebuf);
+
+	/* one buffer is written while the other is filled */
+	writebuf[0] = (unsigned char *)malloc_cache_aligned(szwritebuf);
+	writebuf[1] = (unsigned char *)malloc_cache_aligned(szwritebuf);
+	if (!writebuf[0] || !writebuf[1]) {
+		puts("Error: out of memory\n");
+		r = -1;
+		goto out;
+	}
 
 	/* decompress until deflate stream ends or end of file */
 	do {
@@ -217,12 +376,13 @@ int gzwrite(unsigned char *src, int len,
 
 		/* run inflate() on input until output buffer not full */
 		do {
-			unsigned long blocks_written;
+			unsigned char *buf = writebuf[cur];
+			long blocks_written;
 			int numfilled;
 			lbaint_t writeblocks;
 
 			s.avail_out = szwritebuf;
-			s.next_out = writebuf;
+			s.next_out = buf;
 			r = inflate(&s, Z_SYNC_FLUSH);
 			if ((r != Z_OK) &&
 			    (r != Z_STREAM_END)) {
@@ -230,12 +390,12 @@ int gzwrite(unsigned char *src, int len,
 				goto out;
 			}
 			numfilled = szwritebuf - s.avail_out;
-			crc = crc32(crc, writebuf, numfilled);
+			crc = crc32(crc, buf, numfilled);
 			totalfilled += numfilled;
 			if (numfilled < szwritebuf) {
 				writeblocks = (numfilled+dev->blksz-1)
 						/ dev->blksz;
-				memset(writebuf+numfilled, 0,
+				memset(buf+numfilled, 0,
 				       dev->blksz-(numfilled%dev->blksz));
 			} else {
 				writeblocks = blksperbuf;
@@ -244,9 +404,32 @@ int gzwrite(unsigned char *src, int len,
 			gzwrite_progress(iteration++,
 					 totalfilled,
 					 szexpected);
-			blocks_written = blk_dwrite(dev, outblock,
-						    writeblocks, writebuf);
-			outblock += blocks_written;
+
+			/* the previous buffer must be written before the next */
+			if (pending) {
+				pending = false;
+				blocks_written = gzwrite_wait(&req);
+				if (blocks_written < 0) {
+					printf("Error: write failed (%ld)\n",
+					       blocks_written);
+					r = -1;
+					goto out;
+				}
+				outblock += blocks_written;
+			}
+
+			if (!writeblocks) {
+				/* nothing more came out */
+			} else if (IS_ENABLED(CONFIG_GZWRITE_SKIP_ZEROS) &&
+				   !memchr_inv(buf, 0,
+					       writeblocks * dev->blksz)) {
+				outblock += writeblocks;
+			} else {
+				gzwrite_start(dev, &req, outblock, writeblocks,
+					      buf);
+				pending = true;
+				cur = !cur;
+			}
 			if (ctrlc()) {
 				puts("abort\n");
 				goto out;
@@ -256,6 +439,14 @@ int gzwrite(unsigned char *src, int len,
 		/* done when inflate() says it's done */
 	} while (r != Z_STREAM_END);
 
+	if (pending) {
+		pending = false;
+		if (gzwrite_wait(&req) < 0) {
+			puts("Error: write failed\n");
+			r = -1;
+			goto out;
+		}
+	}
 	if ((szexpected != totalfilled) ||
 	    (crc != expected_crc))
 		r = -1;
@@ -263,9 +454,13 @@ int gzwrite(unsigned char *src, int len,
 		r = 0;
 
 out:
+	/* the buffer may still be in use by the device */
+	if (pending)
+		gzwrite_wait(&req);
 	gzwrite_progress_finish(r, totalfilled, szexpected,
 				expected_crc, crc);
-	free(writebuf);
+	free(writebuf[1]);
+	free(writebuf[0]);
 	inflateEnd(&s);
 
 	return r;
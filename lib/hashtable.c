@@ -768,6 +768,26 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
 	return res;
 }
 
+/*
+ * Count the entries in an environment buffer which himport_r() would parse.
+ * Comments and deletions are counted too; this is only used for sizing.
+ */
+static int himport_count(const char *env, size_t size, const char sep)
+{
+	const char *p = env, *end = env + size;
+	int count = 0;
+
+	while (p < end && *p) {
+		count++;
+		while (p < end && *p && *p != sep)
+			p++;
+		if (p < end && *p == sep)
+			p++;
+	}
+
+	return count;
+}
+
 /*
  * Import linearized data into hash table.
  *
@@ -862,13 +882,21 @@ int himport_r(struct hsearch_data *htab,
 	 * On the other hand we need to add some more entries for free
 	 * space when importing very small buffers. Both boundaries can
 	 * be overwritten in the board config file if needed.
+	 *
+	 * The clipping must not leave the table too small for the entries
+	 * actually present, though, since inserts fail once it is full and
+	 * lookups slow down well before that. So count them and keep the
+	 * table at most half full.
 	 */
 
 	if (!htab->table) {
 		int nent = CONFIG_ENV_MIN_ENTRIES + size / 8;
+		int count = himport_count(env, size, sep);
 
 		if (nent > CONFIG_ENV_MAX_ENTRIES)
 			nent = CONFIG_ENV_MAX_ENTRIES;
+		if (nent < 2 * count)
+			nent = 2 * count;
 
 		debug("Create Hash Table: N=%d\n", nent);
 
@@ -106,6 +106,58 @@ write_fail:
 	return -1;
 }
 
+static lbaint_t write_sparse_chunk_fill(struct sparse_storage *info,
+					lbaint_t blk, lbaint_t blkcnt,
+					uint32_t fill_val, char *response)
+{
+	int fill_buf_num_blks;
+	uint32_t *fill_buf;
+	lbaint_t blks, start = blk;
+	int i;
+	int j;
+
+	/* Zeroed blocks can usually be erased rather than written */
+	if (!fill_val && info->erase) {
+		blks = info->erase(info, blk, blkcnt);
+		if (blks == blkcnt)
+			return blks;
+	}
+
+	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
+	fill_buf = (uint32_t *)
+		   memalign(ARCH_DMA_MINALIGN,
+			    ROUNDUP(info->blksz * fill_buf_num_blks,
+				    ARCH_DMA_MINALIGN));
+	if (!fill_buf) {
+		info->mssg("Malloc failed for: CHUNK_TYPE_FILL", response);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < (info->blksz * fill_buf_num_blks / sizeof(fill_val));
+	     i++)
+		fill_buf[i] = fill_val;
+
+	for (i = 0; i < blkcnt;) {
+		j = blkcnt - i;
+		if (j > fill_buf_num_blks)
+			j = fill_buf_num_blks;
+		blks = info->write(info, blk, j, fill_buf);
+		/* blks might be > j (eg. NAND bad-blocks) */
+		if (blks < j) {
+			printf("%s: %s " LBAFU " [%d]\n", __func__,
+			       "Write failed, block #", blk, j);
+			info->mssg("flash write failure", response);
+			free(fill_buf);
+			return -1;
+		}
+		blk += blks;
+		i += j;
+	}
+	free(fill_buf);
+
+	return blk - start;
+}
+
 int write_sparse_image(struct sparse_storage *info,
 		       const char *part_name, void *data, char *response)
 {
@@ -116,16 +168,10 @@ int write_sparse_image(struct sparse_storage *info,
 	unsigned int chunk;
 	unsigned int offset;
 	uint64_t chunk_data_sz;
-	uint32_t *fill_buf = NULL;
 	uint32_t fill_val;
 	sparse_header_t *sparse_header;
 	chunk_header_t *chunk_header;
 	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
-
-	fill_buf_num_blks = CONFIG_IMAGE_SPARSE_FILLBUF_SIZE / info->blksz;
 
 	/* Read and skip over sparse image header */
 	sparse_header = (sparse_header_t *)data;
@@ -227,26 +273,9 @@ int write_sparse_image(struct sparse_storage *info,
 				return -1;
 			}
 
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
-				info->mssg("Malloc failed for: CHUNK_TYPE_FILL",
-					   response);
-				return -1;
-			}
-
 			fill_val = *(uint32_t *)data;
 			data = (char *)data + sizeof(uint32_t);
 
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
-
 			if (blk + blkcnt > info->start + info->size) {
 				printf(
 				    "%s: Request would exceed partition size!\n",
@@ -256,29 +285,15 @@ int write_sparse_image(struct sparse_storage *info,
 				return -1;
 			}
 
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					info->mssg("flash write failure",
-						   response);
-					free(fill_buf);
-					return -1;
-				}
-				blk += blks;
-				i += j;
-			}
+			blks = write_sparse_chunk_fill(info, blk, blkcnt,
+						       fill_val, response);
+			if (IS_ERR_VALUE(blks))
+				return -1;
+
+			blk += blks;
 			bytes_written += ((u64)blkcnt) * info->blksz;
 			total_blocks += DIV_ROUND_UP_ULL(chunk_data_sz,
 							 sparse_header->blk_sz);
-			free(fill_buf);
 			break;
 
 		case CHUNK_TYPE_DONT_CARE:
@@ -316,3 +331,376 @@ int write_sparse_image(struct sparse_storage *info,
 
 	return 0;
 }
+
+static int sparse_stream_fail(struct sparse_stream *s, const char *msg,
+			      char *response)
+{
+	printf("%s: %s\n", s->part_name, msg);
+	s->info->mssg(msg, response);
+	s->state = SPARSE_STREAM_ERROR;
+
+	return -1;
+}
+
+/* Block after the data held in the buffer */
+static lbaint_t sparse_stream_next_blk(struct sparse_stream *s)
+{
+	return s->blk + s->buf_len / s->info->blksz;
+}
+
+static int sparse_stream_write_blks(struct sparse_stream *s, const void *data,
+				    lbaint_t blkcnt, char *response)
+{
+	lbaint_t blks;
+
+	blks = s->info->write(s->info, s->blk, blkcnt, data);
+	/* blks might be > blkcnt due to NAND bad-blocks */
+	if (IS_ERR_VALUE(blks) || blks < blkcnt) {
+		printf("%s: Write failed, block #" LBAFU " [" LBAFU "]\n",
+		       __func__, s->blk, blkcnt);
+		return sparse_stream_fail(s, "flash write failure", response);
+	}
+	s->blk += blks;
+	s->bytes_written += (u64)blkcnt * s->info->blksz;
+
+	return 0;
+}
+
+static int sparse_stream_flush(struct sparse_stream *s, char *response)
+{
+	lbaint_t blkcnt = s->buf_len / s->info->blksz;
+
+	if (!blkcnt)
+		return 0;
+	s->buf_len = 0;
+
+	return sparse_stream_write_blks(s, s->buf, blkcnt, response);
+}
+
+/*
+ * Collect @size bytes at @dst from the data, returning true once they are
+ * all there
+ */
+static bool sparse_stream_gather(struct sparse_stream *s, void *dst,
+				 uint size, const void **datap, uint *lenp)
+{
+	uint n = min(size - s->hdr_len, *lenp);
+
+	memcpy(dst + s->hdr_len, *datap, n);
+	*datap += n;
+	*lenp -= n;
+	s->hdr_len += n;
+	if (s->hdr_len < size)
+		return false;
+	s->hdr_len = 0;
+
+	return true;
+}
+
+/* Take the data of a raw chunk or image, writing it once enough is there */
+static int sparse_stream_data(struct sparse_stream *s, const void **datap,
+			      uint *lenp, char *response)
+{
+	lbaint_t blksz = s->info->blksz;
+	uint n;
+
+	n = min_t(u64, *lenp, s->left);
+	if (!s->buf_len && IS_ALIGNED((ulong)*datap, ARCH_DMA_MINALIGN) &&
+	    n >= blksz) {
+		/* Write whole blocks straight from the caller's buffer */
+		n -= n % blksz;
+		if (sparse_stream_write_blks(s, *datap, n / blksz, response))
+			return -1;
+	} else {
+		n = min(n, s->buf_size - s->buf_len);
+		memcpy(s->buf + s->buf_len, *datap, n);
+		s->buf_len += n;
+		if (s->buf_len == s->buf_size &&
+		    sparse_stream_flush(s, response))
+			return -1;
+	}
+	*datap += n;
+	*lenp -= n;
+	s->left -= n;
+
+	return 0;
+}
+
+/* Write the image from the start of the partition, as it is not sparse */
+static void sparse_stream_start_image(struct sparse_stream *s)
+{
+	struct sparse_storage *info = s->info;
+
+	memcpy(s->buf, &s->header, s->hdr_len);
+	s->buf_len = s->hdr_len;
+	s->hdr_len = 0;
+	s->left = (u64)info->size * info->blksz - s->buf_len;
+	s->state = SPARSE_STREAM_IMAGE;
+	printf("Flashing Raw Image\n");
+}
+
+static int sparse_stream_start(struct sparse_stream *s, char *response)
+{
+	sparse_header_t *header = &s->header;
+	uint offset;
+
+	if (!is_sparse_image(header)) {
+		s->hdr_len = sizeof(*header);
+		sparse_stream_start_image(s);
+		return 0;
+	}
+
+	if (header->file_hdr_sz > sizeof(sparse_header_t))
+		s->skip = header->file_hdr_sz - sizeof(sparse_header_t);
+	if (header->chunk_hdr_sz < sizeof(chunk_header_t))
+		return sparse_stream_fail(s, "sparse image chunk header issue",
+					  response);
+	div_u64_rem(header->blk_sz, s->info->blksz, &offset);
+	if (offset)
+		return sparse_stream_fail(s, "sparse image block size issue",
+					  response);
+
+	puts("Flashing Sparse Image\n");
+	s->state = header->total_chunks ? SPARSE_STREAM_CHUNK :
+		   SPARSE_STREAM_DONE;
+
+	return 0;
+}
+
+static void sparse_stream_next_chunk(struct sparse_stream *s)
+{
+	s->chunk_idx++;
+	s->state = s->chunk_idx < s->header.total_chunks ?
+		   SPARSE_STREAM_CHUNK : SPARSE_STREAM_DONE;
+}
+
+static int sparse_stream_chunk(struct sparse_stream *s, char *response)
+{
+	struct sparse_storage *info = s->info;
+	chunk_header_t *chunk = &s->chunk;
+	u64 chunk_data_sz;
+	lbaint_t blkcnt;
+
+	s->skip = s->header.chunk_hdr_sz - sizeof(chunk_header_t);
+	chunk_data_sz = (u64)s->header.blk_sz * chunk->chunk_sz;
+	blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, info->blksz);
+
+	switch (chunk->chunk_type) {
+	case CHUNK_TYPE_RAW:
+		if (chunk->total_sz != s->header.chunk_hdr_sz + chunk_data_sz)
+			return sparse_stream_fail(s,
+				"Bogus chunk size for chunk type Raw", response);
+		if (sparse_stream_next_blk(s) + blkcnt >
+		    info->start + info->size)
+			return sparse_stream_fail(s,
+				"Request would exceed partition size!",
+				response);
+
+		/* Consecutive raw chunks are collected in the same buffer */
+		s->left = chunk_data_sz;
+		s->total_blocks += chunk->chunk_sz;
+		s->state = SPARSE_STREAM_RAW;
+		if (!s->left)
+			sparse_stream_next_chunk(s);
+		break;
+
+	case CHUNK_TYPE_FILL:
+		if (chunk->total_sz !=
+		    s->header.chunk_hdr_sz + sizeof(uint32_t))
+			return sparse_stream_fail(s,
+				"Bogus chunk size for chunk type FILL",
+				response);
+		if (sparse_stream_next_blk(s) + blkcnt >
+		    info->start + info->size)
+			return sparse_stream_fail(s,
+				"Request would exceed partition size!",
+				response);
+		s->state = SPARSE_STREAM_FILL;
+		break;
+
+	case CHUNK_TYPE_DONT_CARE:
+		if (sparse_stream_flush(s, response))
+			return -1;
+		s->blk += info->reserve(info, s->blk, blkcnt);
+		s->total_blocks += chunk->chunk_sz;
+		sparse_stream_next_chunk(s);
+		break;
+
+	case CHUNK_TYPE_CRC32:
+		if (chunk->total_sz !=
+		    s->header.chunk_hdr_sz + sizeof(uint32_t))
+			return sparse_stream_fail(s,
+				"Bogus chunk size for chunk type CRC32",
+				response);
+		s->skip += sizeof(uint32_t);
+		s->total_blocks += chunk->chunk_sz;
+		sparse_stream_next_chunk(s);
+		break;
+
+	default:
+		printf("%s: Unknown chunk type: %x\n", __func__,
+		       chunk->chunk_type);
+		return sparse_stream_fail(s, "Unknown chunk type", response);
+	}
+
+	return 0;
+}
+
+static int sparse_stream_fill(struct sparse_stream *s, char *response)
+{
+	lbaint_t blkcnt, blks;
+	u64 chunk_data_sz;
+
+	if (sparse_stream_flush(s, response))
+		return -1;
+
+	chunk_data_sz = (u64)s->header.blk_sz * s->chunk.chunk_sz;
+	blkcnt = DIV_ROUND_UP_ULL(chunk_data_sz, s->info->blksz);
+	blks = write_sparse_chunk_fill(s->info, s->blk, blkcnt, s->fill_val,
+				       response);
+	if (IS_ERR_VALUE(blks)) {
+		s->state = SPARSE_STREAM_ERROR;
+		return -1;
+	}
+	s->blk += blks;
+	s->bytes_written += (u64)blkcnt * s->info->blksz;
+	s->total_blocks += s->chunk.chunk_sz;
+	sparse_stream_next_chunk(s);
+
+	return 0;
+}
+
+int sparse_stream_init(struct sparse_stream *stream,
+		       struct sparse_storage *info, const char *part_name,
+		       char *response)
+{
+	uint size;
+
+	if (!info->mssg)
+		info->mssg = default_log;
+
+	memset(stream, '\0', sizeof(*stream));
+	stream->info = info;
+	stream->part_name = part_name;
+	stream->blk = info->start;
+
+	size = CONFIG_IMAGE_SPARSE_STREAM_BUF_SIZE;
+	size = max_t(uint, size - size % info->blksz, info->blksz);
+	stream->buf = memalign(ARCH_DMA_MINALIGN, size);
+	if (!stream->buf) {
+		info->mssg("Malloc failed for sparse stream", response);
+		stream->state = SPARSE_STREAM_ERROR;
+		return -ENOMEM;
+	}
+	stream->buf_size = size;
+
+	return 0;
+}
+
+int sparse_stream_write(struct sparse_stream *s, const void *data, uint len,
+			char *response)
+{
+	int ret = 0;
+
+	while (len && !ret) {
+		if (s->skip) {
+			uint n = min(s->skip, len);
+
+			data += n;
+			len -= n;
+			s->skip -= n;
+			continue;
+		}
+
+		switch (s->state) {
+		case SPARSE_STREAM_HEADER:
+			if (sparse_stream_gather(s, &s->header,
+						 sizeof(s->header), &data,
+						 &len))
+				ret = sparse_stream_start(s, response);
+			break;
+		case SPARSE_STREAM_CHUNK:
+			if (sparse_stream_gather(s, &s->chunk,
+						 sizeof(s->chunk), &data, &len))
+				ret = sparse_stream_chunk(s, response);
+			break;
+		case SPARSE_STREAM_RAW:
+			ret = sparse_stream_data(s, &data, &len, response);
+			if (!ret && !s->left)
+				sparse_stream_next_chunk(s);
+			break;
+		case SPARSE_STREAM_FILL:
+			if (sparse_stream_gather(s, &s->fill_val,
+						 sizeof(s->fill_val), &data,
+						 &len))
+				ret = sparse_stream_fill(s, response);
+			break;
+		case SPARSE_STREAM_IMAGE:
+			if (!s->left)
+				return sparse_stream_fail(s,
+					"Request would exceed partition size!",
+					response);
+			ret = sparse_stream_data(s, &data, &len, response);
+			break;
+		case SPARSE_STREAM_DONE:
+			return sparse_stream_fail(s,
+				"Data after end of sparse image", response);
+		case SPARSE_STREAM_ERROR:
+			return -1;
+		}
+	}
+
+	return ret;
+}
+
+int sparse_stream_finish(struct sparse_stream *s, char *response)
+{
+	lbaint_t blksz = s->info->blksz;
+	int ret = 0;
+
+	/* An image shorter than a sparse header cannot be a sparse one */
+	if (s->state == SPARSE_STREAM_HEADER && s->hdr_len)
+		sparse_stream_start_image(s);
+
+	switch (s->state) {
+	case SPARSE_STREAM_IMAGE:
+		if (s->buf_len % blksz) {
+			uint pad = blksz - s->buf_len % blksz;
+
+			memset(s->buf + s->buf_len, '\0', pad);
+			s->buf_len += pad;
+		}
+		ret = sparse_stream_flush(s, response);
+		break;
+	case SPARSE_STREAM_DONE:
+		if (s->skip) {
+			ret = sparse_stream_fail(s, "sparse image incomplete",
+						 response);
+			break;
+		}
+		ret = sparse_stream_flush(s, response);
+		if (ret)
+			break;
+		debug("Wrote %d blocks, expected to write %d blocks\n",
+		      s->total_blocks, s->header.total_blks);
+		if (s->total_blocks != s->header.total_blks)
+			ret = sparse_stream_fail(s,
+				"sparse image write failure", response);
+		break;
+	case SPARSE_STREAM_ERROR:
+		ret = -1;
+		break;
+	default:
+		ret = sparse_stream_fail(s, "sparse image incomplete",
+					 response);
+		break;
+	}
+	if (!ret)
+		printf("........ wrote %llu bytes to '%s'\n", s->bytes_written,
+		       s->part_name);
+
+	free(s->buf);
+	s->buf = NULL;
+
+	return ret;
+}
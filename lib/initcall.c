@@ -3,14 +3,33 @@
  * Copyright (c) 2013 The Chromium OS Authors.
  */
 
+#include <bootstage.h>
 #include <efi.h>
 #include <initcall.h>
 #include <log.h>
 #include <relocate.h>
 #include <asm/global_data.h>
+#include <linux/errno.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#define MAX_DEFERRED	8
+
+/**
+ * struct initcall_deferred - An initcall phase waiting to run
+ *
+ * @name: Name to use for bootstage and error reports
+ * @finish: Function to call
+ */
+struct initcall_deferred {
+	const char *name;
+	init_fnc_t finish;
+};
+
+/* Placed in .data since this is used before relocation, when BSS is not */
+static struct initcall_deferred deferred[MAX_DEFERRED] __section(".data");
+static int num_deferred __section(".data");
+
 static ulong calc_reloc_ofs(void)
 {
 #ifdef CONFIG_EFI_APP
@@ -42,6 +61,68 @@ static int initcall_is_event(init_fnc_t func)
 	return 0;
 }
 
+/**
+ * initcall_prof_add() - account for the time taken by an initcall
+ *
+ * @func: Function pointer, or event
+ * @type: Event number, if this is an event, else 0
+ * @reloc_ofs: Relocation offset, so that the address can be found in
+ *	u-boot.map
+ * @start_us: Time when the initcall was started
+ */
+static void initcall_prof_add(init_fnc_t func, int type, ulong reloc_ofs,
+			      ulong start_us)
+{
+	char name[BOOTSTAGE_PROF_NAME_LEN];
+
+	if (CONFIG_IS_ENABLED(EVENT) && type)
+		snprintf(name, sizeof(name), "event %s", event_type_name(type));
+	else
+		snprintf(name, sizeof(name), "%p", (char *)func - reloc_ofs);
+	bootstage_prof_add(BOOTSTAGE_PROF_INITCALL, name, start_us, 0);
+}
+
+int initcall_defer(const char *name, init_fnc_t finish)
+{
+	struct initcall_deferred *def;
+
+	if (num_deferred == MAX_DEFERRED)
+		return -ENOSPC;
+	def = &deferred[num_deferred++];
+	def->name = name;
+	def->finish = finish;
+	debug("initcall: defer %s\n", name);
+
+	return 0;
+}
+
+int initcall_sync(void)
+{
+	int i, count = num_deferred;
+	int ret = 0;
+
+	/* anything deferred from here on waits for the next sync */
+	num_deferred = 0;
+	for (i = 0; i < count; i++) {
+		struct initcall_deferred *def = &deferred[i];
+		ulong start_us;
+
+		debug("initcall: finish %s\n", def->name);
+		start_us = bootstage_prof_start();
+		ret = def->finish();
+		if (ret) {
+			printf("initcall failed at %s (err=%d)\n", def->name,
+			       ret);
+			break;
+		}
+		if (CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE))
+			bootstage_prof_add(BOOTSTAGE_PROF_INITCALL, def->name,
+					   start_us, 0);
+	}
+
+	return ret;
+}
+
 /*
  * To enable debugging. add #define DEBUG at the top of the including file.
  *
@@ -53,9 +134,16 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 	const init_fnc_t *ptr;
 	enum event_t type;
 	init_fnc_t func;
+	ulong start_us;
 	int ret = 0;
 
 	for (ptr = init_sequence; func = *ptr, func; ptr++) {
+		if (func == INITCALL_SYNC) {
+			ret = initcall_sync();
+			if (ret)
+				return ret;
+			continue;
+		}
 		reloc_ofs = calc_reloc_ofs();
 		type = initcall_is_event(func);
 
@@ -71,12 +159,17 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 			debug("initcall: %p\n", (char *)func - reloc_ofs);
 		}
 
+		start_us = bootstage_prof_start();
 		ret = type ? event_notify_null(type) : func();
 		if (ret)
 			break;
+		if (CONFIG_IS_ENABLED(BOOTSTAGE_PROFILE))
+			initcall_prof_add(func, type, reloc_ofs, start_us);
 	}
 
 	if (ret) {
+		/* the sequence is abandoned, so drop its deferred phases */
+		num_deferred = 0;
 		if (CONFIG_IS_ENABLED(EVENT)) {
 			char buf[60];
 
@@ -98,5 +191,5 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 		return ret;
 	}
 
-	return 0;
+	return initcall_sync();
 }
@@ -73,17 +73,60 @@ static long lmb_regions_adjacent(struct alist *lmb_rgn_lst, unsigned long r1,
 	return lmb_addrs_adjacent(base1, size1, base2, size2);
 }
 
-static void lmb_remove_region(struct alist *lmb_rgn_lst, unsigned long r)
+/*
+ * Regions are kept sorted by address and do not overlap, so their end
+ * addresses are sorted too. This finds the first region which ends at or
+ * after @addr, being the only one which can be the first to overlap a range
+ * starting at @addr. It returns the number of regions if there is none.
+ */
+static unsigned long lmb_first_region_from(struct alist *lmb_rgn_lst,
+					   phys_addr_t addr)
 {
-	unsigned long i;
 	struct lmb_region *rgn = lmb_rgn_lst->data;
+	unsigned long lo = 0, hi = lmb_rgn_lst->count, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (rgn[mid].base + rgn[mid].size - 1 < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
 
-	for (i = r; i < lmb_rgn_lst->count - 1; i++) {
-		rgn[i].base = rgn[i + 1].base;
-		rgn[i].size = rgn[i + 1].size;
-		rgn[i].flags = rgn[i + 1].flags;
+/* Find the index at which a region starting at @base should be inserted */
+static unsigned long lmb_insert_pos(struct alist *lmb_rgn_lst,
+				    phys_addr_t base)
+{
+	struct lmb_region *rgn = lmb_rgn_lst->data;
+	unsigned long lo = 0, hi = lmb_rgn_lst->count, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (rgn[mid].base <= base)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-	lmb_rgn_lst->count--;
+
+	return lo;
+}
+
+static void lmb_remove_regions(struct alist *lmb_rgn_lst, unsigned long r,
+			       unsigned long count)
+{
+	struct lmb_region *rgn = lmb_rgn_lst->data;
+
+	memmove(&rgn[r], &rgn[r + count],
+		(lmb_rgn_lst->count - r - count) * sizeof(*rgn));
+	lmb_rgn_lst->count -= count;
+}
+
+static void lmb_remove_region(struct alist *lmb_rgn_lst, unsigned long r)
+{
+	lmb_remove_regions(lmb_rgn_lst, r, 1);
 }
 
 /* Assumption: base addr of region 1 < base addr of region 2 */
@@ -146,6 +189,9 @@ static long lmb_resize_regions(struct alist *lmb_rgn_lst,
 				return -1;
 			rgn_cnt++;
 			idx_end = idx;
+		} else if (rgnbase > base) {
+			/* This and all later regions are above the range */
+			break;
 		}
 		idx++;
 	}
@@ -160,8 +206,7 @@ static long lmb_resize_regions(struct alist *lmb_rgn_lst,
 	rgn[idx_start].size = mergeend - mergebase;
 
 	/* Now remove the merged regions */
-	while (--rgn_cnt)
-		lmb_remove_region(lmb_rgn_lst, idx_start + 1);
+	lmb_remove_regions(lmb_rgn_lst, idx_start + 1, rgn_cnt - 1);
 
 	return 0;
 }
@@ -193,26 +238,29 @@ static long lmb_add_region_flags(struct alist *lmb_rgn_lst, phys_addr_t base,
 	if (alist_err(lmb_rgn_lst))
 		return -1;
 
-	/* First try and coalesce this LMB with another. */
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
+	/*
+	 * First try and coalesce this LMB with another. Only the first region
+	 * which ends at or after base - 1 need be checked: those before it end
+	 * too low to touch the new one and those after it start higher up.
+	 */
+	i = lmb_first_region_from(lmb_rgn_lst, base ? base - 1 : 0);
+	if (i < lmb_rgn_lst->count) {
 		phys_addr_t rgnbase = rgn[i].base;
 		phys_size_t rgnsize = rgn[i].size;
 		u32 rgnflags = rgn[i].flags;
 
 		ret = lmb_addrs_adjacent(base, size, rgnbase, rgnsize);
 		if (ret > 0) {
-			if (flags != rgnflags)
-				break;
-			rgn[i].base -= size;
-			rgn[i].size += size;
-			coalesced++;
-			break;
+			if (flags == rgnflags) {
+				rgn[i].base -= size;
+				rgn[i].size += size;
+				coalesced++;
+			}
 		} else if (ret < 0) {
-			if (flags != rgnflags)
-				break;
-			rgn[i].size += size;
-			coalesced++;
-			break;
+			if (flags == rgnflags) {
+				rgn[i].size += size;
+				coalesced++;
+			}
 		} else if (lmb_addrs_overlap(base, size, rgnbase, rgnsize)) {
 			if (flags != LMB_NONE)
 				return -EEXIST;
@@ -222,9 +270,8 @@ static long lmb_add_region_flags(struct alist *lmb_rgn_lst, phys_addr_t base,
 				return -1;
 
 			coalesced++;
-			break;
-
-			return -1;
+		} else {
+			i = lmb_rgn_lst->count;
 		}
 	}
 
@@ -251,16 +298,12 @@ static long lmb_add_region_flags(struct alist *lmb_rgn_lst, phys_addr_t base,
 	rgn = lmb_rgn_lst->data;
 
 	/* Couldn't coalesce the LMB, so add it to the sorted table. */
-	for (i = lmb_rgn_lst->count; i >= 0; i--) {
-		if (i && base < rgn[i - 1].base) {
-			rgn[i] = rgn[i - 1];
-		} else {
-			rgn[i].base = base;
-			rgn[i].size = size;
-			rgn[i].flags = flags;
-			break;
-		}
-	}
+	i = lmb_insert_pos(lmb_rgn_lst, base);
+	memmove(&rgn[i + 1], &rgn[i],
+		(lmb_rgn_lst->count - i) * sizeof(*rgn));
+	rgn[i].base = base;
+	rgn[i].size = size;
+	rgn[i].flags = flags;
 
 	lmb_rgn_lst->count++;
 
@@ -281,16 +324,14 @@ static long _lmb_free(struct alist *lmb_rgn_lst, phys_addr_t base,
 
 	rgn = lmb_rgn_lst->data;
 	/* Find the region where (base, size) belongs to */
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
+	i = lmb_first_region_from(lmb_rgn_lst, end);
+	if (i < lmb_rgn_lst->count) {
 		rgnbegin = rgn[i].base;
 		rgnend = rgnbegin + rgn[i].size - 1;
-
-		if (rgnbegin <= base && end <= rgnend)
-			break;
 	}
 
 	/* Didn't find the region */
-	if (i == lmb_rgn_lst->count)
+	if (i == lmb_rgn_lst->count || rgnbegin > base)
 		return -1;
 
 	/* Check to see if we are removing entire region */
@@ -327,15 +368,12 @@ static long lmb_overlaps_region(struct alist *lmb_rgn_lst, phys_addr_t base,
 	unsigned long i;
 	struct lmb_region *rgn = lmb_rgn_lst->data;
 
-	for (i = 0; i < lmb_rgn_lst->count; i++) {
-		phys_addr_t rgnbase = rgn[i].base;
-		phys_size_t rgnsize = rgn[i].size;
+	i = lmb_first_region_from(lmb_rgn_lst, base);
+	if (i < lmb_rgn_lst->count &&
+	    lmb_addrs_overlap(base, size, rgn[i].base, rgn[i].size))
+		return i;
 
-		if (lmb_addrs_overlap(base, size, rgnbase, rgnsize))
-			break;
-	}
-
-	return (i < lmb_rgn_lst->count) ? i : -1;
+	return -1;
 }
 
 /*
@@ -749,16 +787,14 @@ phys_size_t lmb_get_free_size(phys_addr_t addr)
 	/* check if the requested address is in the memory regions */
 	rgn = lmb_overlaps_region(&lmb.available_mem, addr, 1);
 	if (rgn >= 0) {
-		for (i = 0; i < lmb.used_mem.count; i++) {
+		i = lmb_first_region_from(&lmb.used_mem, addr);
+		if (i < lmb.used_mem.count) {
 			if (addr < lmb_used[i].base) {
 				/* first reserved range > requested address */
 				return lmb_used[i].base - addr;
 			}
-			if (lmb_used[i].base +
-			    lmb_used[i].size > addr) {
-				/* requested addr is in this reserved range */
-				return 0;
-			}
+			/* requested addr is in this reserved range */
+			return 0;
 		}
 		/* if we come here: no reserved ranges above requested addr */
 		return lmb_memory[lmb.available_mem.count - 1].base +
@@ -769,15 +805,13 @@ phys_size_t lmb_get_free_size(phys_addr_t addr)
 
 int lmb_is_reserved_flags(phys_addr_t addr, int flags)
 {
-	int i;
+	long i;
 	struct lmb_region *lmb_used = lmb.used_mem.data;
 
-	for (i = 0; i < lmb.used_mem.count; i++) {
-		phys_addr_t upper = lmb_used[i].base +
-			lmb_used[i].size - 1;
-		if (addr >= lmb_used[i].base && addr <= upper)
-			return (lmb_used[i].flags & flags) == flags;
-	}
+	i = lmb_overlaps_region(&lmb.used_mem, addr, 1);
+	if (i >= 0)
+		return (lmb_used[i].flags & flags) == flags;
+
 	return 0;
 }
 
@@ -135,6 +135,10 @@
 #define PBUF_LINK_HLEN                  14
 #define PBUF_POOL_BUFSIZE               LWIP_MEM_ALIGN_SIZE(TCP_MSS + 40 + PBUF_LINK_HLEN)
 
+#if defined(CONFIG_LWIP_RX_ZERO_COPY)
+#define LWIP_SUPPORT_CUSTOM_PBUF        1
+#endif
+
 #define LWIP_HAVE_LOOPIF                0
 
 #define LWIP_NETCONN                    0
@@ -151,6 +155,9 @@
 
 #define LWIP_NETIF_LOOPBACK		0
 
+/* let new_netif() skip the checksums the Ethernet hardware handles */
+#define LWIP_CHECKSUM_CTRL_PER_NETIF	1
+
 /* use malloc instead of pool */
 #define MEMP_MEM_MALLOC                 1
 #define MEMP_MEM_INIT			1
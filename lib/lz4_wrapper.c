@@ -4,8 +4,10 @@
  */
 
 #include <compiler.h>
+#include <cpu.h>
 #include <image.h>
 #include <linux/kernel.h>
+#include <linux/sizes.h>
 #include <linux/types.h>
 #include <asm/unaligned.h>
 #include <u-boot/lz4.h>
@@ -15,51 +17,78 @@
 
 #define LZ4F_BLOCKUNCOMPRESSED_FLAG 0x80000000U
 
+/**
+ * ulz4_parse_header() - Check an LZ4 frame header and skip over it
+ *
+ * @src: Start of the frame
+ * @srcn: Length of the frame
+ * @inp: Returns a pointer to the first block header
+ * @has_block_checksum: Returns true if each block is followed by a checksum
+ * @block_max: Returns the largest number of bytes which a block can hold
+ * Return: 0 if OK, -ve on error, as for ulz4fn()
+ */
+static __rcode int ulz4_parse_header(const void *src, size_t srcn,
+				     const void **inp, int *has_block_checksum,
+				     size_t *block_max)
+{
+	/* With in-place decompression the header may become invalid later. */
+	const void *in = src;
+	u32 magic;
+	u8 flags, version, independent_blocks, has_content_size;
+	u8 block_desc;
+
+	if (srcn < sizeof(u32) + 3*sizeof(u8))
+		return -EINVAL;	/* input overrun */
+
+	magic = get_unaligned_le32(in);
+	in += sizeof(u32);
+	flags = *(u8 *)in;
+	in += sizeof(u8);
+	block_desc = *(u8 *)in;
+	in += sizeof(u8);
+
+	version = (flags >> 6) & 0x3;
+	independent_blocks = (flags >> 5) & 0x1;
+	*has_block_checksum = (flags >> 4) & 0x1;
+	has_content_size = (flags >> 3) & 0x1;
+
+	/* We assume there's always only a single, standard frame. */
+	if (magic != LZ4F_MAGIC || version != 1)
+		return -EPROTONOSUPPORT;	/* unknown format */
+	if ((flags & 0x03) || (block_desc & 0x8f))
+		return -EINVAL;	/* reserved bits must be zero */
+	if (!independent_blocks)
+		return -EPROTONOSUPPORT; /* we can't support this yet */
+
+	/* 4 is 64KB, 5 is 256KB, 6 is 1MB and 7 is 4MB */
+	*block_max = 1U << (8 + 2 * ((block_desc >> 4) & 0x7));
+
+	if (has_content_size) {
+		if (srcn < sizeof(u32) + 3*sizeof(u8) + sizeof(u64))
+			return -EINVAL;	/* input overrun */
+		in += sizeof(u64);
+	}
+	/* Header checksum byte */
+	in += sizeof(u8);
+	*inp = in;
+
+	return 0;
+}
+
 __rcode int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 {
 	const void *end = dst + *dstn;
-	const void *in = src;
+	const void *in;
 	void *out = dst;
 	int has_block_checksum;
+	size_t block_max;
 	int ret;
 	*dstn = 0;
 
-	{ /* With in-place decompression the header may become invalid later. */
-		u32 magic;
-		u8 flags, version, independent_blocks, has_content_size;
-		u8 block_desc;
-
-		if (srcn < sizeof(u32) + 3*sizeof(u8))
-			return -EINVAL;	/* input overrun */
-
-		magic = get_unaligned_le32(in);
-		in += sizeof(u32);
-		flags = *(u8 *)in;
-		in += sizeof(u8);
-		block_desc = *(u8 *)in;
-		in += sizeof(u8);
-
-		version = (flags >> 6) & 0x3;
-		independent_blocks = (flags >> 5) & 0x1;
-		has_block_checksum = (flags >> 4) & 0x1;
-		has_content_size = (flags >> 3) & 0x1;
-
-		/* We assume there's always only a single, standard frame. */
-		if (magic != LZ4F_MAGIC || version != 1)
-			return -EPROTONOSUPPORT;	/* unknown format */
-		if ((flags & 0x03) || (block_desc & 0x8f))
-			return -EINVAL;	/* reserved bits must be zero */
-		if (!independent_blocks)
-			return -EPROTONOSUPPORT; /* we can't support this yet */
-
-		if (has_content_size) {
-			if (srcn < sizeof(u32) + 3*sizeof(u8) + sizeof(u64))
-				return -EINVAL;	/* input overrun */
-			in += sizeof(u64);
-		}
-		/* Header checksum byte */
-		in += sizeof(u8);
-	}
+	ret = ulz4_parse_header(src, srcn, &in, &has_block_checksum,
+				&block_max);
+	if (ret)
+		return ret;
 
 	while (1) {
 		u32 block_header, block_size;
@@ -106,3 +135,152 @@ __rcode int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 	*dstn = out - dst;
 	return ret;
 }
+
+#if CONFIG_IS_ENABLED(CPU)
+/* Most blocks decompressed in parallel at once */
+#define LZ4_MAX_JOBS	16
+
+/**
+ * struct ulz4_block - one block to decompress
+ *
+ * @src: Block data, after its header
+ * @src_len: Length of @src
+ * @dst: Where to put the decompressed data
+ * @dst_len: Space available at @dst
+ * @uncompressed: true if the block is stored without compression
+ * @ret: Number of bytes decompressed, or -ve on error
+ */
+struct ulz4_block {
+	const void *src;
+	u32 src_len;
+	void *dst;
+	size_t dst_len;
+	bool uncompressed;
+	int ret;
+};
+
+/* Runs as a CPU job, so must not use malloc() or the console */
+static void ulz4_decompress_block(void *arg)
+{
+	struct ulz4_block *blk = arg;
+
+	if (blk->uncompressed) {
+		if (blk->src_len > blk->dst_len) {
+			blk->ret = -ENOBUFS;
+			return;
+		}
+		memcpy(blk->dst, blk->src, blk->src_len);
+		blk->ret = blk->src_len;
+		return;
+	}
+	blk->ret = LZ4_decompress_generic(blk->src, blk->dst, blk->src_len,
+					  blk->dst_len, endOnInputSize,
+					  decode_full_block, noDict, blk->dst,
+					  NULL, 0);
+	if (blk->ret < 0)
+		blk->ret = -EPROTO;
+}
+
+/* Check whether the block just decoded is the last one in the frame */
+static bool ulz4_at_end(const void *in, const void *src_end, bool last)
+{
+	return last || (in + sizeof(u32) <= src_end &&
+			!get_unaligned_le32(in));
+}
+
+/*
+ * Decompress the blocks of a frame in batches, one job per block. Each block
+ * is placed as if all those before it were full, which is how the lz4 tool
+ * writes frames.
+ *
+ * Return: 0 if OK, -EAGAIN if the data must be decompressed serially, other
+ * -ve on error
+ */
+static int ulz4fn_jobs(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	struct ulz4_block blks[LZ4_MAX_JOBS];
+	struct cpu_job jobs[LZ4_MAX_JOBS];
+	const void *in, *src_end = src + srcn;
+	void *out = dst, *end = dst + *dstn;
+	int has_block_checksum;
+	size_t block_max;
+	bool last = false;
+	int count, i, ret;
+
+	/* Blocks are written out of order, so they cannot share a buffer */
+	if (src_end < src || (src < end && dst < src_end))
+		return -EAGAIN;
+	ret = ulz4_parse_header(src, srcn, &in, &has_block_checksum,
+				&block_max);
+	if (ret)
+		return ret;
+	if (block_max < SZ_64K)
+		return -EAGAIN;
+
+	while (!last) {
+		for (count = 0; count < LZ4_MAX_JOBS; count++) {
+			struct ulz4_block *blk = &blks[count];
+			u32 block_header;
+
+			if (in + sizeof(u32) > src_end)
+				return -EINVAL;		/* input overrun */
+			block_header = get_unaligned_le32(in);
+			in += sizeof(u32);
+			blk->src_len = block_header & ~LZ4F_BLOCKUNCOMPRESSED_FLAG;
+			if (!blk->src_len) {
+				last = true;
+				break;
+			}
+			if (in + blk->src_len > src_end)
+				return -EINVAL;		/* input overrun */
+			if (out >= end)
+				return -EAGAIN;		/* let ulz4fn() report it */
+
+			blk->src = in;
+			blk->dst = out;
+			blk->dst_len = min((size_t)(end - out), block_max);
+			blk->uncompressed = block_header &
+				LZ4F_BLOCKUNCOMPRESSED_FLAG;
+			jobs[count].func = ulz4_decompress_block;
+			jobs[count].arg = blk;
+
+			in += blk->src_len;
+			if (has_block_checksum)
+				in += sizeof(u32);
+			out += blk->dst_len;
+		}
+
+		ret = cpu_run_jobs(jobs, count);
+		if (ret)
+			return ret;
+
+		for (i = 0; i < count; i++) {
+			if (blks[i].ret < 0)
+				return blks[i].ret;
+			/* A short block moves the rest, so start again */
+			if (blks[i].ret != blks[i].dst_len &&
+			    (i != count - 1 || !ulz4_at_end(in, src_end, last)))
+				return -EAGAIN;
+		}
+		if (count)
+			out = blks[count - 1].dst + blks[count - 1].ret;
+	}
+	*dstn = out - dst;
+
+	return 0;
+}
+
+int ulz4fn_parallel(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	size_t len = *dstn;
+	int ret;
+
+	ret = ulz4fn_jobs(src, srcn, dst, &len);
+	if (ret != -EAGAIN) {
+		*dstn = ret ? 0 : len;
+		return ret;
+	}
+
+	return ulz4fn(src, srcn, dst, dstn);
+}
+#endif
@@ -26,6 +26,20 @@
   { UPDATE_1(p); i = (i + i) + 1; A1; }
 #define GET_BIT(p, i) GET_BIT2(p, i, ; , ;)
 
+/*
+ * Branchless form of GET_BIT(), for the bits of literals, which are hard to
+ * predict. A mispredicted branch costs more than working out both outcomes
+ * and selecting one with a mask.
+ */
+#define GET_BIT_NB(p, i) { UInt32 mask; ttt = *(p); NORMALIZE; \
+  bound = (range >> kNumBitModelTotalBits) * ttt; \
+  mask = 0 - (UInt32)(code >= bound); \
+  range = ((range - bound) & mask) | (bound & ~mask); \
+  code -= bound & mask; \
+  *(p) = (CLzmaProb)(ttt + (((kBitModelTotal - ttt) >> kNumMoveBits) & ~mask) - \
+    ((ttt >> kNumMoveBits) & mask)); \
+  i = (i + i) - mask; }
+
 #define TREE_GET_BIT(probs, i) { GET_BIT((probs + i), i); }
 #define TREE_DECODE(probs, limit, i) \
   { i = 1; do { TREE_GET_BIT(probs, i); } while (i < limit); i -= limit; }
@@ -175,8 +189,18 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
       {
         state -= (state < 4) ? state : 3;
         symbol = 1;
-
-        do { GET_BIT(prob + symbol, symbol) } while (symbol < 0x100);
+#ifdef _LZMA_SIZE_OPT
+        do { GET_BIT_NB(prob + symbol, symbol) } while (symbol < 0x100);
+#else
+        GET_BIT_NB(prob + symbol, symbol)
+        GET_BIT_NB(prob + symbol, symbol)
+        GET_BIT_NB(prob + symbol, symbol)
+        GET_BIT_NB(prob + symbol, symbol)
+        GET_BIT_NB(prob + symbol, symbol)
+        GET_BIT_NB(prob + symbol, symbol)
+        GET_BIT_NB(prob + symbol, symbol)
+        GET_BIT_NB(prob + symbol, symbol)
+#endif
       }
       else
       {
@@ -192,7 +216,9 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
           matchByte <<= 1;
           bit = (matchByte & offs);
           probLit = prob + offs + bit + symbol;
-          GET_BIT2(probLit, symbol, offs &= ~bit, offs &= bit)
+          GET_BIT_NB(probLit, symbol)
+          /* offs is 0x100 until a decoded bit differs from matchByte */
+          offs &= ~((symbol << 8) ^ bit);
         }
         while (symbol < 0x100);
       }
@@ -400,9 +426,13 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
           const Byte *lim = dest + curLen;
           dicPos += curLen;
 
-          do
-            *(dest) = (Byte)*(dest + src);
-          while (++dest != lim);
+          /* long matches which do not overlap are copied in one go */
+          if (curLen >= 16 && src <= -(ptrdiff_t)curLen)
+            memcpy(dest, dest + src, curLen);
+          else
+            do
+              *(dest) = (Byte)*(dest + src);
+            while (++dest != lim);
         }
         else
         {
@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * ECDSA signature verification in software, using MbedTLS
+ *
+ * Verification works out u1 * G + u2 * Q, where G is the base point of the
+ * curve and Q is the public key. MbedTLS has built-in tables of multiples of
+ * G, so the cost is dominated by multiplying Q. Since the key is fixed, mkimage
+ * can store a table of multiples of Q alongside it (see ECDSA_COMB_WINDOW()).
+ * When present this is handed to MbedTLS as though Q were the base point of
+ * a second copy of the group, so that both multiplications use tables.
+ */
+
+#define LOG_CATEGORY UCLASS_ECDSA
+#define MBEDTLS_ALLOW_PRIVATE_ACCESS
+
+#include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <crypto/ecdsa-uclass.h>
+#include <u-boot/ecdsa.h>
+#include <mbedtls/ecp.h>
+
+/*
+ * Only public values are involved in verification, so the blinding which
+ * mbedtls_ecp_mul() insists on does not need real randomness
+ */
+static int ecdsa_mbedtls_rng(void *ctx, unsigned char *buf, size_t len)
+{
+	u32 *seed = ctx;
+
+	while (len--) {
+		*seed = *seed * 1103515245 + 12345;
+		*buf++ = *seed >> 16;
+	}
+
+	return 0;
+}
+
+/**
+ * load_comb() - Set up a group whose base point is the public key
+ *
+ * @grp: Curve group to copy
+ * @qgrp: Returns the group, with the key's table as its table
+ * @q: Public key
+ * @pubkey: Public key properties, including the table
+ * Return: 0 if OK, -EINVAL if the table is not valid for this key, -ENOMEM
+ *	if out of memory
+ */
+static int load_comb(const mbedtls_ecp_group *grp, mbedtls_ecp_group *qgrp,
+		     const mbedtls_ecp_point *q,
+		     const struct ecdsa_public_key *pubkey)
+{
+	int count = ECDSA_COMB_SIZE(pubkey->size_bits);
+	int bytes = pubkey->size_bits / 8;
+	const u8 *ptr = pubkey->comb;
+	mbedtls_ecp_point *tab;
+	int i;
+
+	if (pubkey->comb_len != count * bytes * 2)
+		return -EINVAL;
+	if (mbedtls_ecp_group_load(qgrp, grp->id))
+		return -ENOMEM;
+
+	/*
+	 * G and T refer to the curve's constant data; give the group its own G
+	 * and drop T, which is replaced below
+	 */
+	qgrp->T = NULL;
+	mbedtls_ecp_point_init(&qgrp->G);
+	if (mbedtls_ecp_copy(&qgrp->G, q))
+		return -ENOMEM;
+
+	tab = calloc(count, sizeof(*tab));
+	if (!tab)
+		return -ENOMEM;
+	for (i = 0; i < count; i++)
+		mbedtls_ecp_point_init(&tab[i]);
+	for (i = 0; i < count; i++, ptr += bytes * 2) {
+		if (mbedtls_mpi_read_binary(&tab[i].X, ptr, bytes) ||
+		    mbedtls_mpi_read_binary(&tab[i].Y, ptr + bytes, bytes) ||
+		    mbedtls_mpi_lset(&tab[i].Z, 1))
+			break;
+	}
+
+	/* the first entry is the key itself, which catches a stale table */
+	if (i < count || mbedtls_ecp_point_cmp(&tab[0], q)) {
+		for (i = 0; i < count; i++)
+			mbedtls_ecp_point_free(&tab[i]);
+		free(tab);
+		return -EINVAL;
+	}
+
+	/* a zero size marks the table as static, so MbedTLS does not free it */
+	qgrp->T = tab;
+	qgrp->T_size = 0;
+
+	return 0;
+}
+
+/* Free a group set up by load_comb(), even if that failed */
+static void free_comb(mbedtls_ecp_group *qgrp)
+{
+	int count = ECDSA_COMB_SIZE(qgrp->nbits);
+	mbedtls_ecp_point *tab = qgrp->T;
+	int i;
+
+	/* MbedTLS leaves G alone for known curves, so free it here */
+	qgrp->T = NULL;
+	mbedtls_ecp_point_free(&qgrp->G);
+	mbedtls_ecp_group_free(qgrp);
+	if (tab) {
+		for (i = 0; i < count; i++)
+			mbedtls_ecp_point_free(&tab[i]);
+		free(tab);
+	}
+}
+
+/* Work out u1 * G + u2 * Q */
+static int ecdsa_mbedtls_muladd(mbedtls_ecp_group *grp, mbedtls_ecp_point *res,
+				const mbedtls_mpi *u1, const mbedtls_mpi *u2,
+				const mbedtls_ecp_point *q,
+				const struct ecdsa_public_key *pubkey)
+{
+	mbedtls_ecp_point r1, r2;
+	mbedtls_ecp_group qgrp;
+	mbedtls_mpi one;
+	u32 seed = 1;
+	int ret;
+
+	mbedtls_ecp_group_init(&qgrp);
+	ret = -ENOENT;
+	if (pubkey->comb) {
+		ret = load_comb(grp, &qgrp, q, pubkey);
+		if (ret)
+			log_warning("Ignoring ECDSA comb table (err=%d)\n", ret);
+	}
+	if (ret) {
+		free_comb(&qgrp);
+		return mbedtls_ecp_muladd(grp, res, u1, &grp->G, u2, q);
+	}
+
+	mbedtls_ecp_point_init(&r1);
+	mbedtls_ecp_point_init(&r2);
+	mbedtls_mpi_init(&one);
+	ret = mbedtls_ecp_mul(grp, &r1, u1, &grp->G, ecdsa_mbedtls_rng, &seed);
+	if (!ret)
+		ret = mbedtls_ecp_mul(&qgrp, &r2, u2, &qgrp.G,
+				      ecdsa_mbedtls_rng, &seed);
+	if (!ret)
+		ret = mbedtls_mpi_lset(&one, 1);
+	if (!ret)
+		ret = mbedtls_ecp_muladd(grp, res, &one, &r1, &one, &r2);
+	mbedtls_mpi_free(&one);
+	mbedtls_ecp_point_free(&r2);
+	mbedtls_ecp_point_free(&r1);
+	free_comb(&qgrp);
+
+	return ret;
+}
+
+static int ecdsa_mbedtls_verify(struct udevice *dev,
+				const struct ecdsa_public_key *pubkey,
+				const void *hash, size_t hash_len,
+				const void *signature, size_t sig_len)
+{
+	int bytes = pubkey->size_bits / 8;
+	mbedtls_mpi r, s, e, sinv, u1, u2;
+	mbedtls_ecp_group_id id;
+	mbedtls_ecp_point q, res;
+	mbedtls_ecp_group grp;
+	int ret;
+
+	if (pubkey->size_bits == 256)
+		id = MBEDTLS_ECP_DP_SECP256R1;
+	else if (pubkey->size_bits == 384)
+		id = MBEDTLS_ECP_DP_SECP384R1;
+	else
+		return log_msg_ret("crv", -EOPNOTSUPP);
+	if (sig_len != bytes * 2)
+		return log_msg_ret("len", -EINVAL);
+
+	mbedtls_ecp_group_init(&grp);
+	mbedtls_ecp_point_init(&q);
+	mbedtls_ecp_point_init(&res);
+	mbedtls_mpi_init(&r);
+	mbedtls_mpi_init(&s);
+	mbedtls_mpi_init(&e);
+	mbedtls_mpi_init(&sinv);
+	mbedtls_mpi_init(&u1);
+	mbedtls_mpi_init(&u2);
+
+	ret = -EINVAL;
+	if (mbedtls_ecp_group_load(&grp, id) ||
+	    mbedtls_mpi_read_binary(&q.X, pubkey->x, bytes) ||
+	    mbedtls_mpi_read_binary(&q.Y, pubkey->y, bytes) ||
+	    mbedtls_mpi_lset(&q.Z, 1) ||
+	    mbedtls_ecp_check_pubkey(&grp, &q))
+		goto out;
+
+	/* r and s must be in [1, n - 1] */
+	if (mbedtls_mpi_read_binary(&r, signature, bytes) ||
+	    mbedtls_mpi_read_binary(&s, signature + bytes, bytes))
+		goto out;
+	ret = -EPERM;
+	if (mbedtls_mpi_cmp_int(&r, 1) < 0 ||
+	    mbedtls_mpi_cmp_mpi(&r, &grp.N) >= 0 ||
+	    mbedtls_mpi_cmp_int(&s, 1) < 0 ||
+	    mbedtls_mpi_cmp_mpi(&s, &grp.N) >= 0)
+		goto out;
+
+	/* The hash is truncated to the size of the curve's order */
+	if (mbedtls_mpi_read_binary(&e, hash, min_t(size_t, hash_len, bytes)) ||
+	    mbedtls_mpi_inv_mod(&sinv, &s, &grp.N) ||
+	    mbedtls_mpi_mul_mpi(&u1, &e, &sinv) ||
+	    mbedtls_mpi_mod_mpi(&u1, &u1, &grp.N) ||
+	    mbedtls_mpi_mul_mpi(&u2, &r, &sinv) ||
+	    mbedtls_mpi_mod_mpi(&u2, &u2, &grp.N))
+		goto out;
+
+	if (ecdsa_mbedtls_muladd(&grp, &res, &u1, &u2, &q, pubkey) ||
+	    mbedtls_ecp_is_zero(&res))
+		goto out;
+
+	/* The signature is valid if r is the X coordinate, mod n */
+	if (mbedtls_mpi_mod_mpi(&res.X, &res.X, &grp.N) ||
+	    mbedtls_mpi_cmp_mpi(&res.X, &r))
+		goto out;
+	ret = 0;
+
+out:
+	mbedtls_mpi_free(&u2);
+	mbedtls_mpi_free(&u1);
+	mbedtls_mpi_free(&sinv);
+	mbedtls_mpi_free(&e);
+	mbedtls_mpi_free(&s);
+	mbedtls_mpi_free(&r);
+	mbedtls_ecp_point_free(&res);
+	mbedtls_ecp_point_free(&q);
+	mbedtls_ecp_group_free(&grp);
+
+	return ret;
+}
+
+static const struct ecdsa_ops ecdsa_mbedtls_ops = {
+	.verify	= ecdsa_mbedtls_verify,
+};
+
+U_BOOT_DRIVER(ecdsa_mbedtls) = {
+	.name	= "ecdsa_mbedtls",
+	.id	= UCLASS_ECDSA,
+	.ops	= &ecdsa_mbedtls_ops,
+	.flags	= DM_FLAG_PRE_RELOC,
+};
+
+U_BOOT_DRVINFO(ecdsa_mbedtls) = {
+	.name = "ecdsa_mbedtls",
+};
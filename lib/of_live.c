@@ -11,13 +11,18 @@
 #define LOG_CATEGORY	LOGC_DT
 
 #include <abuf.h>
+#include <bloblist.h>
 #include <log.h>
+#include <mapmem.h>
 #include <linux/libfdt.h>
 #include <of_live.h>
 #include <malloc.h>
 #include <dm/of_access.h>
+#include <dm/phandle-cache.h>
 #include <linux/err.h>
+#include <linux/log2.h>
 #include <linux/sizes.h>
+#include <u-boot/crc.h>
 
 enum {
 	BUF_STEP	= SZ_64K,
@@ -174,6 +179,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 				np->phandle = be32_to_cpup(p);
 			pp->name = (char *)pname;
 			pp->length = sz;
+			pp->hash = of_prop_hash(pname);
 			pp->value = (__be32 *)p;
 			*prev_pp = pp;
 			prev_pp = &pp->next;
@@ -202,6 +208,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		if (!dryrun) {
 			pp->name = "name";
 			pp->length = sz;
+			pp->hash = of_prop_hash("name");
 			pp->value = pp + 1;
 			*prev_pp = pp;
 			prev_pp = &pp->next;
@@ -260,18 +267,11 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	return mem;
 }
 
-int unflatten_device_tree(const void *blob, struct device_node **mynodes)
+/* Work out the memory needed to unflatten a tree */
+static int unflatten_size(const void *blob, ulong *sizep)
 {
 	unsigned long size;
 	int start;
-	void *mem;
-
-	debug(" -> unflatten_device_tree()\n");
-
-	if (!blob) {
-		debug("No device tree pointer\n");
-		return -EINVAL;
-	}
 
 	debug("Unflattening device tree:\n");
 	debug("magic: %08x\n", fdt_magic(blob));
@@ -289,12 +289,17 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 						0, true);
 	if (!size)
 		return -EFAULT;
-	size = ALIGN(size, 4);
+	*sizep = ALIGN(size, 4);
 
-	debug("  size is %lx, allocating...\n", size);
+	return 0;
+}
+
+/* Unflatten a tree into @mem, which must have space for @size + 4 bytes */
+static int unflatten_into(const void *blob, void *mem, ulong size,
+			  struct device_node **mynodes)
+{
+	int start;
 
-	/* Allocate memory for the expanded device tree */
-	mem = memalign(__alignof__(struct device_node), size + 4);
 	memset(mem, '\0', size);
 
 	/* Set up value for dm_test_livetree_align() */
@@ -313,17 +318,239 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 		return -ENOSPC;
 	}
 
+	return 0;
+}
+
+int unflatten_device_tree(const void *blob, struct device_node **mynodes)
+{
+	unsigned long size;
+	void *mem;
+	int ret;
+
+	debug(" -> unflatten_device_tree()\n");
+
+	if (!blob) {
+		debug("No device tree pointer\n");
+		return -EINVAL;
+	}
+
+	ret = unflatten_size(blob, &size);
+	if (ret)
+		return ret;
+
+	debug("  size is %lx, allocating...\n", size);
+
+	/* Allocate memory for the expanded device tree */
+	mem = memalign(__alignof__(struct device_node), size + 4);
+	if (!mem)
+		return -ENOMEM;
+	ret = unflatten_into(blob, mem, size, mynodes);
+	if (ret)
+		return ret;
+
 	debug(" <- unflatten_device_tree()\n");
 
 	return 0;
 }
 
+/**
+ * struct of_live_reloc - where a tree was and where it is now
+ *
+ * @old_base: Old address of the memory holding the tree
+ * @size: Size of that memory
+ * @old_blob: Old address of the flat tree it was unflattened from
+ * @blob_size: Size of the flat tree
+ * @mem_delta: Amount the tree has moved
+ * @blob_delta: Amount the flat tree has moved
+ */
+struct of_live_reloc {
+	ulong old_base;
+	ulong size;
+	ulong old_blob;
+	ulong blob_size;
+	long mem_delta;
+	long blob_delta;
+};
+
+/*
+ * Adjust a pointer into the tree or the flat tree. Anything else is one of
+ * the strings which unflattening points to, so is replaced with @other.
+ */
+static void *of_live_reloc_ptr(const struct of_live_reloc *rel,
+			       const void *ptr, const char *other)
+{
+	ulong addr = (ulong)ptr;
+
+	if (!ptr)
+		return NULL;
+	if (addr - rel->old_base < rel->size)
+		return (void *)(addr + rel->mem_delta);
+	if (addr - rel->old_blob < rel->blob_size)
+		return (void *)(addr + rel->blob_delta);
+
+	return (void *)other;
+}
+
+int of_live_relocate(struct device_node *root, ulong old_base, ulong size,
+		     const void *old_blob, const void *blob)
+{
+	struct of_live_reloc rel;
+	struct device_node *np;
+
+	rel.old_base = old_base;
+	rel.size = size;
+	rel.old_blob = (ulong)old_blob;
+	rel.blob_size = fdt_totalsize(blob);
+	rel.mem_delta = (ulong)root - old_base;
+	rel.blob_delta = (ulong)blob - (ulong)old_blob;
+
+	/* Each node is fixed up before its links are followed */
+	for (np = root; np; ) {
+		struct property *pp, **ppp;
+
+		np->name = of_live_reloc_ptr(&rel, np->name,
+					     np->parent ? "<NULL>" : "");
+		np->type = of_live_reloc_ptr(&rel, np->type, "<NULL>");
+		np->full_name = of_live_reloc_ptr(&rel, np->full_name, "");
+		np->parent = of_live_reloc_ptr(&rel, np->parent, NULL);
+		np->child = of_live_reloc_ptr(&rel, np->child, NULL);
+		np->sibling = of_live_reloc_ptr(&rel, np->sibling, NULL);
+		for (ppp = &np->properties; *ppp; ppp = &pp->next) {
+			pp = of_live_reloc_ptr(&rel, *ppp, NULL);
+			if (!pp)
+				return log_msg_ret("prp", -EFAULT);
+			*ppp = pp;
+			pp->name = of_live_reloc_ptr(&rel, pp->name, "name");
+			pp->value = of_live_reloc_ptr(&rel, pp->value, NULL);
+		}
+
+		/* Move to the next node, as of_find_all_nodes() does */
+		if (np->child) {
+			np = np->child;
+		} else {
+			while (np->parent && !np->sibling)
+				np = np->parent;
+			np = np->sibling;
+		}
+	}
+
+	return 0;
+}
+
+#if CONFIG_IS_ENABLED(OF_LIVE_HANDOFF)
+int of_live_save(const void *blob, void *buf, int buf_size, int *sizep)
+{
+	struct of_live_hdr *hdr = buf;
+	struct device_node *root;
+	ulong size;
+	int ret;
+
+	ret = unflatten_size(blob, &size);
+	if (ret)
+		return log_msg_ret("siz", ret);
+	*sizep = sizeof(*hdr) + size + 4;
+	if (!buf)
+		return 0;
+	if (buf_size < *sizep)
+		return log_msg_ret("spc", -ENOSPC);
+
+	ret = unflatten_into(blob, hdr + 1, size, &root);
+	if (ret)
+		return log_msg_ret("unf", ret);
+	hdr->version = OF_LIVE_HDR_VERSION;
+	hdr->node_size = sizeof(struct device_node);
+	hdr->prop_size = sizeof(struct property);
+	hdr->size = size;
+	hdr->fdt_size = fdt_totalsize(blob);
+	hdr->fdt_crc = crc32(0, blob, hdr->fdt_size);
+	hdr->spare = 0;
+	hdr->base = map_to_sysmem(root);
+	hdr->fdt_addr = map_to_sysmem(blob);
+
+	return 0;
+}
+
+int of_live_restore(const void *buf, int buf_size, const void *blob,
+		    struct device_node **rootp)
+{
+	const struct of_live_hdr *hdr = buf;
+	struct device_node *root;
+	int ret;
+
+	if (buf_size < sizeof(*hdr) || hdr->version != OF_LIVE_HDR_VERSION ||
+	    hdr->node_size != sizeof(struct device_node) ||
+	    hdr->prop_size != sizeof(struct property) ||
+	    buf_size < sizeof(*hdr) + hdr->size)
+		return log_msg_ret("hdr", -EINVAL);
+
+	/* The tree points into the flat tree, so that must be unchanged */
+	if (hdr->fdt_size != fdt_totalsize(blob) ||
+	    hdr->fdt_crc != crc32(0, blob, hdr->fdt_size))
+		return log_msg_ret("fdt", -ESTALE);
+
+	root = memalign(__alignof__(struct device_node), hdr->size);
+	if (!root)
+		return log_msg_ret("mem", -ENOMEM);
+	memcpy(root, hdr + 1, hdr->size);
+	ret = of_live_relocate(root, (ulong)map_sysmem(hdr->base, 0), hdr->size,
+			       map_sysmem(hdr->fdt_addr, 0), blob);
+	if (ret) {
+		free(root);
+		return log_msg_ret("rel", ret);
+	}
+	*rootp = root;
+
+	return 0;
+}
+
+int of_live_handoff_write(const void *blob)
+{
+	void *buf;
+	int ret, size;
+
+	ret = of_live_save(blob, NULL, 0, &size);
+	if (ret)
+		return log_msg_ret("siz", ret);
+	buf = bloblist_add(BLOBLISTT_U_BOOT_LIVE_TREE, size,
+			   ilog2(__alignof__(struct of_live_hdr)));
+	if (!buf)
+		return log_msg_ret("blb", -ENOSPC);
+	ret = of_live_save(blob, buf, size, &size);
+	if (ret)
+		return log_msg_ret("sav", ret);
+
+	return 0;
+}
+
+/* Use the tree passed on by the previous phase, if it matches @blob */
+static int of_live_handoff_read(const void *blob, struct device_node **rootp)
+{
+	void *buf;
+	int size;
+
+	buf = bloblist_get_blob(BLOBLISTT_U_BOOT_LIVE_TREE, &size);
+	if (!buf)
+		return -ENOENT;
+
+	return of_live_restore(buf, size, blob, rootp);
+}
+#else
+static int of_live_handoff_read(const void *blob, struct device_node **rootp)
+{
+	return -ENOENT;
+}
+#endif
+
 int of_live_build(const void *fdt_blob, struct device_node **rootp)
 {
 	int ret;
 
 	debug("%s: start\n", __func__);
-	ret = unflatten_device_tree(fdt_blob, rootp);
+	ret = of_live_handoff_read(fdt_blob, rootp);
+	if (ret && ret != -ENOENT)
+		log_warning("Cannot use live tree from SPL (err=%d)\n", ret);
+	if (ret)
+		ret = unflatten_device_tree(fdt_blob, rootp);
 	if (ret) {
 		debug("Failed to create live tree: err=%d\n", ret);
 		return ret;
@@ -340,6 +567,8 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp)
 
 void of_live_free(struct device_node *root)
 {
+	phandle_cache_drop(root);
+
 	/* the tree is stored as a contiguous block of memory */
 	free(root);
 }
@@ -246,6 +246,198 @@ static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 	return 0;
 }
 
+#ifdef __SIZEOF_INT128__
+/*
+ * On 64-bit CPUs, work with 64-bit limbs. This quarters the number of
+ * multiply steps in each Montgomery multiplication compared with 32-bit
+ * limbs, which is where nearly all the time of a verification goes.
+ */
+
+/**
+ * struct rsa_public_key64 - RSA public key with 64-bit limbs
+ *
+ * @len:	Length of modulus[] in number of uint64_t
+ * @n0inv:	-1 / modulus[0] mod 2^64
+ * @modulus:	Modulus as little endian array
+ * @rr:		R^2 as little endian array
+ * @exponent:	Public exponent
+ */
+struct rsa_public_key64 {
+	uint len;
+	uint64_t n0inv;
+	uint64_t *modulus;
+	uint64_t *rr;
+	uint64_t exponent;
+};
+
+static void subtract_modulus64(const struct rsa_public_key64 *key,
+			       uint64_t num[])
+{
+	uint64_t borrow = 0;
+	uint i;
+
+	for (i = 0; i < key->len; i++) {
+		unsigned __int128 diff;
+
+		diff = (unsigned __int128)num[i] - key->modulus[i] - borrow;
+		num[i] = (uint64_t)diff;
+		borrow = (uint64_t)(diff >> 64) & 1;
+	}
+}
+
+static int greater_equal_modulus64(const struct rsa_public_key64 *key,
+				   uint64_t num[])
+{
+	int i;
+
+	for (i = (int)key->len - 1; i >= 0; i--) {
+		if (num[i] < key->modulus[i])
+			return 0;
+		if (num[i] > key->modulus[i])
+			return 1;
+	}
+
+	return 1;  /* equal */
+}
+
+/* Operation: result[] = a[] * b[] / R mod modulus */
+static void montgomery_mul64(const struct rsa_public_key64 *key,
+			     uint64_t result[], const uint64_t a[],
+			     const uint64_t b[])
+{
+	unsigned __int128 acc_a, acc_b;
+	uint64_t d0;
+	uint i, j;
+
+	for (i = 0; i < key->len; i++)
+		result[i] = 0;
+	for (i = 0; i < key->len; i++) {
+		acc_a = (unsigned __int128)a[i] * b[0] + result[0];
+		d0 = (uint64_t)acc_a * key->n0inv;
+		acc_b = (unsigned __int128)d0 * key->modulus[0] +
+				(uint64_t)acc_a;
+		for (j = 1; j < key->len; j++) {
+			acc_a = (acc_a >> 64) +
+				(unsigned __int128)a[i] * b[j] + result[j];
+			acc_b = (acc_b >> 64) +
+				(unsigned __int128)d0 * key->modulus[j] +
+				(uint64_t)acc_a;
+			result[j - 1] = (uint64_t)acc_b;
+		}
+		acc_a = (acc_a >> 64) + (acc_b >> 64);
+		result[j - 1] = (uint64_t)acc_a;
+		if (acc_a >> 64)
+			subtract_modulus64(key, result);
+	}
+}
+
+/* Convert between a big-endian byte array and a little endian limb array */
+static void rsa_from_big_endian64(uint64_t *dst, const void *src, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		dst[i] = fdt64_to_cpup(src + (len - 1 - i) * sizeof(*dst));
+}
+
+static void rsa_to_big_endian64(void *dst, const uint64_t *src, int len)
+{
+	fdt64_t w;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		w = cpu_to_fdt64(src[len - 1 - i]);
+		memcpy(dst + i * sizeof(w), &w, sizeof(w));
+	}
+}
+
+/**
+ * pow_mod64() - public exponentiation with 64-bit limbs
+ *
+ * This follows pow_mod().
+ *
+ * @key:	RSA key
+ * @inout:	Big-endian byte array containing value and result
+ */
+static int pow_mod64(const struct rsa_public_key64 *key, void *inout)
+{
+	uint64_t val[key->len], acc[key->len], tmp[key->len];
+	uint64_t a_scaled[key->len];
+	int j, k;
+
+	rsa_from_big_endian64(val, inout, key->len);
+
+	/* Number of bits in the exponent (no fls64() in host builds) */
+	for (k = 0; k < 64 && key->exponent >> k; k++)
+		;
+	if (k < 2 || !(key->exponent & 1)) {
+		debug("Public exponent must be odd and at least 2 bits\n");
+		return -EINVAL;
+	}
+
+	montgomery_mul64(key, acc, val, key->rr);
+	memcpy(a_scaled, acc, sizeof(acc));
+
+	for (j = k - 2; j > 0; --j) {
+		montgomery_mul64(key, tmp, acc, acc);
+		if (key->exponent & (1ULL << j))
+			montgomery_mul64(key, acc, tmp, a_scaled);
+		else
+			memcpy(acc, tmp, sizeof(acc));
+	}
+
+	montgomery_mul64(key, tmp, acc, acc);
+	montgomery_mul64(key, acc, tmp, val);
+
+	if (greater_equal_modulus64(key, acc))
+		subtract_modulus64(key, acc);
+
+	rsa_to_big_endian64(inout, acc, key->len);
+
+	return 0;
+}
+
+/**
+ * rsa_mod_exp_sw64() - rsa_mod_exp_sw() using 64-bit limbs
+ *
+ * Return: 0 if OK, -EAGAIN if the key does not suit 64-bit limbs, other
+ *	-ve on error
+ */
+static int rsa_mod_exp_sw64(const uint8_t *sig, uint32_t sig_len,
+			    struct key_prop *prop, uint64_t exponent,
+			    uint8_t *out)
+{
+	struct rsa_public_key64 key;
+	uint64_t inv;
+
+	if (prop->num_bits % 64 || sig_len != prop->num_bits / 8)
+		return -EAGAIN;
+
+	key.len = prop->num_bits / 64;
+	key.exponent = exponent;
+	uint64_t modulus[key.len], rr[key.len];
+
+	key.modulus = modulus;
+	key.rr = rr;
+	rsa_from_big_endian64(key.modulus, prop->modulus, key.len);
+	rsa_from_big_endian64(key.rr, prop->rr, key.len);
+
+	/*
+	 * Extend 1 / modulus[0] from 32 to 64 bits with a Newton step. This
+	 * also catches a key whose n0inv does not match its modulus.
+	 */
+	inv = (uint32_t)-prop->n0inv;
+	inv *= 2 - key.modulus[0] * inv;
+	if (key.modulus[0] * inv != 1)
+		return -EAGAIN;
+	key.n0inv = -inv;
+
+	memmove(out, sig, sig_len);
+
+	return pow_mod64(&key, out);
+}
+#endif
+
 static void rsa_convert_big_endian(uint32_t *dst, const uint32_t *src, int len)
 {
 	int i;
@@ -283,6 +475,12 @@ int rsa_mod_exp_sw(const uint8_t *sig, uint32_t sig_len,
 		      key.len, RSA_MIN_KEY_BITS, RSA_MAX_KEY_BITS);
 		return -EFAULT;
 	}
+
+#ifdef __SIZEOF_INT128__
+	ret = rsa_mod_exp_sw64(sig, sig_len, prop, key.exponent, out);
+	if (ret != -EAGAIN)
+		return ret;
+#endif
 	key.len /= sizeof(uint32_t) * 8;
 	uint32_t key1[key.len], key2[key.len];
 
@@ -97,17 +97,29 @@ long smh_read(long fd, void *memp, size_t len)
 {
 	long ret;
 	struct smh_rdwr_s read;
+	size_t done = 0;
 
 	debug("%s: fd %ld, memp %p, len %zu\n", __func__, fd, memp, len);
 
-	read.fd = fd;
-	read.memp = memp;
-	read.len = len;
+	/*
+	 * Each call traps to the debugger, so ask for everything at once. The
+	 * host may still return less, e.g. if its buffer is smaller, in which
+	 * case carry on until the end of the file.
+	 */
+	while (done < len) {
+		read.fd = fd;
+		read.memp = memp + done;
+		read.len = len - done;
+
+		ret = smh_trap(SYSREAD, &read);
+		if (ret < 0)
+			return smh_errno();
+		if (ret >= read.len)
+			break;
+		done += read.len - ret;
+	}
 
-	ret = smh_trap(SYSREAD, &read);
-	if (ret < 0)
-		return smh_errno();
-	return len - ret;
+	return done;
 }
 
 long smh_write(long fd, const void *memp, size_t len, ulong *written)
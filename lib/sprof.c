@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler
+ *
+ * Samples are kept in a ring buffer, so that a long run keeps the most
+ * recent ones. Each sample holds code offsets in the same form as the
+ * function tracer uses, so proftool can turn them into a flamegraph.
+ */
+
+#include <errno.h>
+#include <malloc.h>
+#include <sprof.h>
+#include <trace.h>
+#include <asm/global_data.h>
+#include <asm/sections.h>
+#include <linux/sizes.h>
+#include <linux/string.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#ifdef CONFIG_SPROF_BACKTRACE
+#define SPROF_DEPTH		CONFIG_SPROF_DEPTH
+#else
+#define SPROF_DEPTH		1
+#endif
+
+/* Largest stack frame which is followed when walking the frame records */
+#define SPROF_MAX_FRAME		SZ_64K
+
+/**
+ * struct sprof_rec - a sample
+ *
+ * @depth: Number of valid entries in @offset
+ * @offset: Code offsets, the interrupted one first, then the callers
+ */
+struct sprof_rec {
+	u32 depth;
+	u32 offset[SPROF_DEPTH];
+};
+
+/**
+ * struct sprof_info - state of the profiler
+ *
+ * @rec: Ring buffer of CONFIG_SPROF_SAMPLES samples
+ * @count: Number of samples taken since sprof_start(); once it exceeds
+ *	CONFIG_SPROF_SAMPLES the oldest samples have been overwritten
+ * @running: true while the sampling timer is running
+ */
+struct sprof_info {
+	struct sprof_rec *rec;
+	ulong count;
+	bool running;
+};
+
+static struct sprof_info sprof;
+
+/* Convert an address to an offset in the same way as lib/trace.c */
+static u32 sprof_offset(ulong addr)
+{
+#ifdef CONFIG_SANDBOX
+	addr -= (ulong)_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		addr -= gd->relocaddr;
+	else
+		addr -= CONFIG_TEXT_BASE;
+#endif
+	return addr;
+}
+
+void sprof_sample(ulong pc, ulong fp, ulong sp)
+{
+	struct sprof_rec *rec;
+	uint depth = 0;
+
+	if (!sprof.running)
+		return;
+	rec = &sprof.rec[sprof.count++ % CONFIG_SPROF_SAMPLES];
+	rec->offset[depth++] = sprof_offset(pc);
+
+	/*
+	 * Walk the frame records: each holds the caller's frame pointer
+	 * followed by the return address. Stop at anything which does not
+	 * look like a frame further up the interrupted stack.
+	 */
+	while (IS_ENABLED(CONFIG_SPROF_BACKTRACE) && depth < SPROF_DEPTH) {
+		const ulong *frame = (const ulong *)fp;
+
+		if (fp < sp || fp - sp > SPROF_MAX_FRAME * SPROF_DEPTH ||
+		    fp & (sizeof(ulong) - 1))
+			break;
+		if (!frame[1])
+			break;
+		rec->offset[depth++] = sprof_offset(frame[1]);
+		if (frame[0] <= fp || frame[0] - fp > SPROF_MAX_FRAME)
+			break;
+		fp = frame[0];
+	}
+	rec->depth = depth;
+}
+
+int sprof_start(uint period_us)
+{
+	int ret;
+
+	sprof_stop();
+	if (!sprof.rec) {
+		sprof.rec = calloc(CONFIG_SPROF_SAMPLES, sizeof(*sprof.rec));
+		if (!sprof.rec)
+			return -ENOMEM;
+	}
+	sprof.count = 0;
+	sprof.running = true;
+	ret = arch_sprof_start(period_us);
+	if (ret)
+		sprof.running = false;
+
+	return ret;
+}
+
+void sprof_stop(void)
+{
+	if (!sprof.running)
+		return;
+	arch_sprof_stop();
+	sprof.running = false;
+}
+
+/* Get the number of samples held and the index of the oldest one */
+static ulong sprof_held(ulong *firstp)
+{
+	if (sprof.count > CONFIG_SPROF_SAMPLES) {
+		*firstp = sprof.count % CONFIG_SPROF_SAMPLES;
+		return CONFIG_SPROF_SAMPLES;
+	}
+	*firstp = 0;
+
+	return sprof.count;
+}
+
+int sprof_list_samples(void *buff, size_t buff_size, size_t *needed)
+{
+	struct trace_output_hdr *output_hdr = NULL;
+	void *end, *ptr = buff;
+	ulong i, first, held;
+	size_t upto = 0;
+
+	end = buff ? buff + buff_size : NULL;
+	if (ptr + sizeof(struct trace_output_hdr) < end)
+		output_hdr = ptr;
+	ptr += sizeof(struct trace_output_hdr);
+
+	held = sprof.rec ? sprof_held(&first) : 0;
+	for (i = 0; i < held; i++) {
+		const struct sprof_rec *rec;
+		struct trace_output_sample *out = ptr;
+		size_t size;
+
+		rec = &sprof.rec[(first + i) % CONFIG_SPROF_SAMPLES];
+		size = sizeof(*out) + rec->depth * sizeof(u32);
+		if (ptr + size < end) {
+			out->depth = rec->depth;
+			memcpy(out + 1, rec->offset, rec->depth * sizeof(u32));
+			upto++;
+		}
+		ptr += size;
+	}
+
+	if (output_hdr) {
+		memset(output_hdr, '\0', sizeof(*output_hdr));
+		output_hdr->rec_count = upto;
+		output_hdr->type = TRACE_CHUNK_SAMPLES;
+		output_hdr->version = TRACE_VERSION;
+		output_hdr->text_base = CONFIG_TEXT_BASE;
+	}
+
+	*needed = ptr - buff;
+	if (ptr > end)
+		return -ENOSPC;
+
+	return 0;
+}
+
+void sprof_print_stats(void)
+{
+	ulong first, held;
+
+	held = sprof.rec ? sprof_held(&first) : 0;
+	printf("%s, %lu samples taken, %lu held (room for %u)\n",
+	       sprof.running ? "Running" : "Stopped", sprof.count, held,
+	       CONFIG_SPROF_SAMPLES);
+}
+
+__weak int arch_sprof_start(uint period_us)
+{
+	return -ENOSYS;
+}
+
+__weak void arch_sprof_stop(void)
+{
+}
@@ -178,16 +178,22 @@ uint64_t usec_to_tick(unsigned long usec)
 	return tick;
 }
 
-void __weak __udelay(unsigned long usec)
+void __weak arch_timer_sleep(uint64_t ticks)
 {
-	uint64_t tmp;
-
-	tmp = get_ticks() + usec_to_tick(usec);	/* get current timestamp */
+}
 
-	while (get_ticks() < tmp+1)	/* loop till event */
+void timer_wait_until(uint64_t ticks)
+{
+	arch_timer_sleep(ticks);
+	while (get_ticks() < ticks)	/* loop till event */
 		 /*NOP*/;
 }
 
+void __weak __udelay(unsigned long usec)
+{
+	timer_wait_until(get_ticks() + usec_to_tick(usec) + 1);
+}
+
 /* ------------------------------------------------------------------------- */
 
 void udelay(unsigned long usec)
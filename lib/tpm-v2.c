@@ -310,6 +310,32 @@ u32 tpm2_nv_define_space(struct udevice *dev, u32 space_index,
 	return tpm_sendrecv_command(dev, command_v2, NULL, NULL);
 }
 
+/*
+ * Check that all the active banks are supported before extending a PCR. This
+ * asks the TPM for its PCR configuration, so the answer is kept until the
+ * banks are allocated again.
+ */
+static int tpm2_extend_check_banks(struct udevice *dev)
+{
+	struct tpm_chip_priv *priv = dev_get_uclass_priv(dev);
+	int ret;
+
+	if (priv->banks_checked)
+		return 0;
+
+	if (!tpm2_check_active_banks(dev)) {
+		log_err("Cannot extend PCRs if all the TPM enabled algorithms are not supported\n");
+
+		ret = tpm2_pcr_allocate(dev, 0);
+		if (ret)
+			return -EINVAL;
+		return 0;
+	}
+	priv->banks_checked = true;
+
+	return 0;
+}
+
 u32 tpm2_pcr_extend(struct udevice *dev, u32 index, u32 algorithm,
 		    const u8 *digest, u32 digest_len)
 {
@@ -342,13 +368,9 @@ u32 tpm2_pcr_extend(struct udevice *dev, u32 index, u32 algorithm,
 	if (!digest)
 		return -EINVAL;
 
-	if (!tpm2_check_active_banks(dev)) {
-		log_err("Cannot extend PCRs if all the TPM enabled algorithms are not supported\n");
-
-		ret = tpm2_pcr_allocate(dev, 0);
-		if (ret)
-			return -EINVAL;
-	}
+	ret = tpm2_extend_check_banks(dev);
+	if (ret)
+		return ret;
 	/*
 	 * Fill the command structure starting from the first buffer:
 	 *     - the digest
@@ -361,6 +383,62 @@ u32 tpm2_pcr_extend(struct udevice *dev, u32 index, u32 algorithm,
 	return tpm_sendrecv_command(dev, command_v2, NULL, NULL);
 }
 
+u32 tpm2_pcr_extend_digests(struct udevice *dev, u32 index,
+			    const struct tpml_digest_values *digest_list)
+{
+	/* Length of the message header, up to start of the first hash */
+	uint offset = 31;
+	u8 command_v2[COMMAND_BUFFER_SIZE] = {
+		tpm_u16(TPM2_ST_SESSIONS),	/* TAG */
+		tpm_u32(0),			/* Length, filled in below */
+		tpm_u32(TPM2_CC_PCR_EXTEND),	/* Command code */
+
+		/* HANDLE */
+		tpm_u32(index),			/* Handle (PCR Index) */
+
+		/* AUTH_SESSION */
+		tpm_u32(9),			/* Authorization size */
+		tpm_u32(TPM2_RS_PW),		/* Session handle */
+		tpm_u16(0),			/* Size of <nonce> */
+						/* <nonce> (if any) */
+		0,				/* Attributes: Cont/Excl/Rst */
+		tpm_u16(0),			/* Size of <hmac/password> */
+						/* <hmac/password> (if any) */
+
+		/* hashes */
+		tpm_u32(digest_list->count),	/* Count (number of hashes) */
+		/* Algorithm and digest of each hash */
+	};
+	u32 i, alg, len;
+	int ret;
+
+	if (!digest_list->count || digest_list->count > TPM2_NUM_PCR_BANKS)
+		return -EINVAL;
+
+	ret = tpm2_extend_check_banks(dev);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < digest_list->count; i++) {
+		alg = digest_list->digests[i].hash_alg;
+		len = tpm2_algorithm_to_len(alg);
+		if (!len)
+			return -EINVAL;
+		ret = pack_byte_string(command_v2, sizeof(command_v2), "ws",
+				       offset, alg, offset + 2,
+				       (u8 *)&digest_list->digests[i].digest,
+				       len);
+		if (ret)
+			return TPM_LIB_ERROR;
+		offset += 2 + len;
+	}
+	ret = pack_byte_string(command_v2, sizeof(command_v2), "d", 2, offset);
+	if (ret)
+		return TPM_LIB_ERROR;
+
+	return tpm_sendrecv_command(dev, command_v2, NULL, NULL);
+}
+
 u32 tpm2_nv_read_value(struct udevice *dev, u32 index, void *data, u32 count)
 {
 	u8 command_v2[COMMAND_BUFFER_SIZE] = {
@@ -594,11 +672,15 @@ u32 tpm2_send_pcr_allocate(struct udevice *dev, const char *pw,
 
 		/* TPML_PCR_SELECTION */
 	};
+	struct tpm_chip_priv *priv = dev_get_uclass_priv(dev);
 	u8 response[COMMAND_BUFFER_SIZE];
 	size_t response_len = COMMAND_BUFFER_SIZE;
 	u32 i;
 	int ret;
 
+	/* The banks must be checked again before the next extend */
+	priv->banks_checked = false;
+
 	/*
 	 * Fill the command structure starting from the first buffer:
 	 * the password (if any)
@@ -481,19 +481,12 @@ int tcg2_pcr_extend(struct udevice *dev, u32 pcr_index,
 		    struct tpml_digest_values *digest_list)
 {
 	u32 rc;
-	u32 i;
-
-	for (i = 0; i < digest_list->count; i++) {
-		u32 alg = digest_list->digests[i].hash_alg;
 
-		rc = tpm2_pcr_extend(dev, pcr_index, alg,
-				     (u8 *)&digest_list->digests[i].digest,
-				     tpm2_algorithm_to_len(alg));
-		if (rc) {
-			printf("%s: error pcr:%u alg:%08x\n", __func__,
-			       pcr_index, alg);
-			return rc;
-		}
+	/* Extend all the banks with one command */
+	rc = tpm2_pcr_extend_digests(dev, pcr_index, digest_list);
+	if (rc) {
+		printf("%s: error pcr:%u\n", __func__, pcr_index);
+		return rc;
 	}
 
 	return 0;
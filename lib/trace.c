@@ -3,10 +3,13 @@
  * Copyright (c) 2012 The Chromium OS Authors.
  */
 
+#include <malloc.h>
 #include <mapmem.h>
+#include <sort.h>
 #include <time.h>
 #include <trace.h>
 #include <linux/errno.h>
+#include <linux/log2.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <asm/sections.h>
@@ -16,6 +19,26 @@ DECLARE_GLOBAL_DATA_PTR;
 static char trace_enabled __section(".data");
 static char trace_inited __section(".data");
 
+enum {
+	TRACE_STACK_SIZE	= 64,	/* Max. depth of timed calls */
+	TRACE_HASH_MULT		= 0x9e3779b1,
+};
+
+/* Totals for one function, kept with CONFIG_TRACE_AGGREGATE */
+struct trace_func_time {
+	u32 func;		/* Function number */
+	u32 calls;		/* Number of calls, 0 if the entry is unused */
+	u64 incl_us;		/* Time spent including called functions */
+	u64 excl_us;		/* Time spent excluding called functions */
+};
+
+/* A function call being timed, with CONFIG_TRACE_AGGREGATE */
+struct trace_frame {
+	uint func;		/* Function number */
+	ulong start_us;		/* Time of entry */
+	ulong child_us;		/* Time spent in timed functions it called */
+};
+
 /* The header block at the start of the trace memory area */
 struct trace_hdr {
 	int func_count;		/* Total number of function call sites */
@@ -40,6 +63,20 @@ struct trace_hdr {
 	int max_depth;		/* Maximum depth seen so far */
 	int min_depth;		/* Minimum depth seen so far */
 	bool trace_locked;	/* Used to detect recursive tracing */
+
+	/* Range of function numbers to trace, end is exclusive */
+	uint filter_start;
+	uint filter_end;
+	ulong filtered_count;	/* Functions that were filtered out */
+
+	/* Per-function totals, kept instead of ftrace records */
+	struct trace_func_time *func_time;
+	int func_time_bits;	/* log2 of the number of entries */
+	ulong func_time_count;	/* Num. of entries used */
+	ulong func_time_dropped;	/* Calls not counted as table was full */
+	struct trace_frame stack[TRACE_STACK_SIZE];	/* Calls being timed */
+	int stack_depth;	/* Num. of calls in stack[] */
+	int stack_overflow;	/* Num. of calls which did not fit in stack[] */
 };
 
 /* Pointer to start of trace buffer */
@@ -104,16 +141,100 @@ static void notrace trace_swap_gd(void)
 
 #endif
 
+/**
+ * find_func_time() - Find the totals for a function, adding them if needed
+ *
+ * @func:	Function number
+ * Return:	totals, or NULL if the hash table is full
+ */
+static struct trace_func_time *notrace find_func_time(uint func)
+{
+	ulong size = hdr->func_time ? 1UL << hdr->func_time_bits : 0;
+	struct trace_func_time *ft;
+	ulong i, probe;
+
+	i = hdr->func_time_bits ?
+		(u32)(func * TRACE_HASH_MULT) >> (32 - hdr->func_time_bits) : 0;
+	for (probe = 0; probe < size; probe++, i = (i + 1) & (size - 1)) {
+		ft = &hdr->func_time[i];
+		if (ft->calls && ft->func == func)
+			return ft;
+		if (!ft->calls) {
+			/* keep a quarter free so that look-ups stay short */
+			if (hdr->func_time_count >= size - size / 4)
+				return NULL;
+			hdr->func_time_count++;
+			ft->func = func;
+			return ft;
+		}
+	}
+
+	return NULL;
+}
+
+/* Add a call to the totals, timing it from entry to exit */
+static void notrace add_func_time(uint func, ulong flags)
+{
+	ulong now = timer_get_us();
+	struct trace_func_time *ft;
+	struct trace_frame *frame;
+	ulong elapsed;
+
+	if (flags == FUNCF_ENTRY) {
+		if (hdr->stack_depth == TRACE_STACK_SIZE) {
+			hdr->stack_overflow++;
+			return;
+		}
+		frame = &hdr->stack[hdr->stack_depth++];
+		frame->func = func;
+		frame->start_us = now;
+		frame->child_us = 0;
+		return;
+	}
+
+	if (hdr->stack_overflow) {
+		hdr->stack_overflow--;
+		return;
+	}
+	/* Ignore exits from calls which started before tracing */
+	if (!hdr->stack_depth || hdr->stack[hdr->stack_depth - 1].func != func)
+		return;
+	frame = &hdr->stack[--hdr->stack_depth];
+	elapsed = now - frame->start_us;
+	if (hdr->stack_depth)
+		frame[-1].child_us += elapsed;
+
+	ft = find_func_time(func);
+	if (!ft) {
+		hdr->func_time_dropped++;
+		return;
+	}
+	ft->calls++;
+	ft->incl_us += elapsed;
+	ft->excl_us += elapsed - frame->child_us;
+}
+
 static void notrace add_ftrace(void *func_ptr, void *caller, ulong flags)
 {
+	uint func;
+
 	if (hdr->depth > hdr->depth_limit) {
 		hdr->ftrace_too_deep_count++;
 		return;
 	}
+	func = func_ptr_to_num(func_ptr);
+	if (func < hdr->filter_start || func >= hdr->filter_end) {
+		hdr->filtered_count++;
+		return;
+	}
+	if (IS_ENABLED(CONFIG_TRACE_AGGREGATE)) {
+		add_func_time(func, flags);
+		return;
+	}
 	if (hdr->ftrace_count < hdr->ftrace_size) {
 		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
 
-		rec->func = func_ptr_to_num(func_ptr);
+		rec->func = func;
 		rec->caller = func_ptr_to_num(caller);
 		rec->flags = flags | (timer_get_us() & FUNCF_TIMESTAMP_MASK);
 	}
@@ -329,10 +450,78 @@ void trace_print_stats(void)
 	printf("%15d call depth limit\n", hdr->depth_limit);
 	print_grouped_ull(hdr->ftrace_too_deep_count, 10);
 	puts(" calls not traced due to depth\n");
+	print_grouped_ull(hdr->filtered_count, 10);
+	puts(" calls not traced due to filter\n");
+	if (IS_ENABLED(CONFIG_TRACE_AGGREGATE)) {
+		print_grouped_ull(hdr->func_time_count, 10);
+		puts(" functions with totals\n");
+		print_grouped_ull(hdr->func_time_dropped, 10);
+		puts(" calls not totalled as table full\n");
+	}
 	print_grouped_ull(hdr->ftrace_size, 10);
 	puts(" max function calls\n");
 	printf("\ntrace buffer %lx call records %lx\n",
 	       (ulong)map_to_sysmem(hdr), (ulong)map_to_sysmem(hdr->ftrace));
+	if (hdr->filter_start || hdr->filter_end != UINT_MAX)
+		printf("trace filter %lx to %lx\n",
+		       (ulong)hdr->filter_start * FUNC_SITE_SIZE,
+		       hdr->filter_end == UINT_MAX ? 0 :
+		       (ulong)hdr->filter_end * FUNC_SITE_SIZE);
+}
+
+int trace_set_limits(int depth_limit, ulong start, ulong end)
+{
+	if (!trace_inited)
+		return -ENOENT;
+	hdr->depth_limit = depth_limit;
+	hdr->filter_start = start / FUNC_SITE_SIZE;
+	hdr->filter_end = end ? DIV_ROUND_UP(end, FUNC_SITE_SIZE) : UINT_MAX;
+
+	return 0;
+}
+
+static int h_cmp_func_time(const void *v1, const void *v2)
+{
+	const struct trace_func_time *f1 = v1, *f2 = v2;
+
+	/* Most exclusive time first */
+	if (f1->excl_us != f2->excl_us)
+		return f1->excl_us < f2->excl_us ? 1 : -1;
+
+	return 0;
+}
+
+int trace_print_totals(int count)
+{
+	struct trace_func_time *list, *ft;
+	ulong size, i, upto;
+
+	if (!IS_ENABLED(CONFIG_TRACE_AGGREGATE) || !trace_inited)
+		return -ENOENT;
+
+	/* Copy the totals, since sorting the hash table would break it */
+	size = hdr->func_time ? 1UL << hdr->func_time_bits : 0;
+	list = malloc(hdr->func_time_count * sizeof(*list));
+	if (!list && hdr->func_time_count)
+		return -ENOMEM;
+	for (i = upto = 0; i < size && upto < hdr->func_time_count; i++) {
+		if (hdr->func_time[i].calls)
+			list[upto++] = hdr->func_time[i];
+	}
+	qsort(list, upto, sizeof(*list), h_cmp_func_time);
+
+	printf("%10s%13s%15s%15s\n", "Offset", "Calls", "Inclusive us",
+	       "Exclusive us");
+	for (i = 0, ft = list; i < upto && i < count; i++, ft++) {
+		printf("%10lx", (ulong)ft->func * FUNC_SITE_SIZE);
+		print_grouped_ull(ft->calls, 10);
+		print_grouped_ull(ft->incl_us, 12);
+		print_grouped_ull(ft->excl_us, 12);
+		puts("\n");
+	}
+	free(list);
+
+	return 0;
 }
 
 void notrace trace_set_enabled(int enabled)
@@ -340,6 +529,38 @@ void notrace trace_set_enabled(int enabled)
 	trace_enabled = enabled != 0;
 }
 
+/**
+ * trace_set_records() - Set up the area after the call counts
+ *
+ * This holds the call trace, or the per-function totals with
+ * CONFIG_TRACE_AGGREGATE
+ *
+ * @start:	Start of area
+ * @size:	Size of area in bytes
+ */
+static void notrace trace_set_records(void *start, size_t size)
+{
+	ulong count;
+
+	hdr->ftrace = start;
+	if (!IS_ENABLED(CONFIG_TRACE_AGGREGATE)) {
+		hdr->ftrace_size = size / sizeof(*hdr->ftrace);
+		return;
+	}
+
+	/* The hash table must be a power of two in size */
+	hdr->ftrace_size = 0;
+	hdr->func_time = NULL;
+	hdr->func_time_count = 0;
+	count = size / sizeof(*hdr->func_time);
+	if (!count)
+		return;
+	hdr->func_time = start;
+	hdr->func_time_bits = ilog2(count);
+	memset(hdr->func_time, '\0',
+	       sizeof(*hdr->func_time) << hdr->func_time_bits);
+}
+
 static int get_func_count(void)
 {
 	/* Detect no support for mon_len since this means tracing cannot work */
@@ -355,6 +576,7 @@ static int notrace trace_init_(void *buff, size_t buff_size, bool copy_early,
 			       bool enable)
 {
 	int func_count = get_func_count();
+	struct trace_hdr *early = NULL;
 	size_t needed;
 	int was_disabled = !trace_enabled;
 
@@ -388,6 +610,7 @@ static int notrace trace_init_(void *buff, size_t buff_size, bool copy_early,
 		}
 		puts("\n");
 		memcpy(buff, hdr, used);
+		early = hdr;
 #endif
 	}
 	hdr = (struct trace_hdr *)buff;
@@ -401,15 +624,36 @@ static int notrace trace_init_(void *buff, size_t buff_size, bool copy_early,
 	if (was_disabled) {
 		memset(hdr, '\0', needed);
 		hdr->min_depth = INT_MAX;
+		hdr->filter_end = UINT_MAX;
 	}
 	hdr->func_count = func_count;
 	hdr->call_accum = (uintptr_t *)(hdr + 1);
 
 	/* Use any remaining space for the timed function trace */
-	hdr->ftrace = (struct trace_call *)(buff + needed);
-	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
+	trace_set_records(buff + needed, buff_size - needed);
 	hdr->depth_limit = CONFIG_TRACE_CALL_DEPTH_LIMIT;
 
+	/* Carry over the totals from early trace */
+	if (early && early->func_time) {
+		ulong i;
+
+		for (i = 0; i < 1UL << early->func_time_bits; i++) {
+			struct trace_func_time *from = &early->func_time[i];
+			struct trace_func_time *ft;
+
+			if (!from->calls)
+				continue;
+			ft = find_func_time(from->func);
+			if (!ft) {
+				hdr->func_time_dropped += from->calls;
+				continue;
+			}
+			ft->calls += from->calls;
+			ft->incl_us += from->incl_us;
+			ft->excl_us += from->excl_us;
+		}
+	}
+
 	printf("trace: initialized, %senabled\n", enable ? "" : "not ");
 	trace_enabled = enable;
 	trace_inited = 1;
@@ -475,10 +719,10 @@ int notrace trace_early_init(void)
 	hdr->call_accum = (uintptr_t *)(hdr + 1);
 	hdr->func_count = func_count;
 	hdr->min_depth = INT_MAX;
+	hdr->filter_end = UINT_MAX;
 
 	/* Use any remaining space for the timed function trace */
-	hdr->ftrace = (struct trace_call *)((char *)hdr + needed);
-	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
+	trace_set_records((char *)hdr + needed, buff_size - needed);
 	hdr->depth_limit = CONFIG_TRACE_EARLY_CALL_DEPTH_LIMIT;
 	printf("trace: early enable at %08x\n", CONFIG_TRACE_EARLY_ADDR);
 
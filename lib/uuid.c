@@ -119,6 +119,10 @@ static const struct {
 		"Block IO",
 		EFI_BLOCK_IO_PROTOCOL_GUID,
 	},
+	{
+		"Block IO 2",
+		EFI_BLOCK_IO2_PROTOCOL_GUID,
+	},
 	{
 		"Disk IO",
 		EFI_DISK_IO_PROTOCOL_GUID,
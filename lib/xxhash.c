@@ -8,12 +8,33 @@
  * - xxHash source repository: https://github.com/Cyan4973/xxHash
  */
 
+#ifndef USE_HOSTCC
 #include <asm/unaligned.h>
 #include <linux/errno.h>
 #include <linux/compiler.h>
 #include <linux/kernel.h>
 #include <linux/compat.h>
 #include <linux/string.h>
+#else
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EXPORT_SYMBOL(sym)
+
+static inline uint32_t get_unaligned_le32(const void *p)
+{
+	const uint8_t *b = p;
+
+	return b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static inline uint64_t get_unaligned_le64(const void *p)
+{
+	return (uint64_t)get_unaligned_le32(p + 4) << 32 |
+		get_unaligned_le32(p);
+}
+#endif
 #include <linux/xxhash.h>
 
 /*-*************************************
@@ -235,6 +235,19 @@ unsigned start;         /* inflate()'s starting value for strm->avail_out */
                             *out++ = *from++;
                     }
                 }
+#ifdef CONFIG_ZLIB_WIDE_COPY
+                else if (dist >= sizeof(u64)) {
+                    /* chunks this far apart never overlap */
+                    from = out - dist;          /* copy direct from output */
+                    for (; len >= sizeof(u64); len -= sizeof(u64)) {
+                        put_unaligned(get_unaligned((u64 *)from), (u64 *)out);
+                        out += sizeof(u64);
+                        from += sizeof(u64);
+                    }
+                    while (len--)
+                        *out++ = *from++;
+                }
+#endif
                 else {
 		    unsigned short *sout;
 		    unsigned long loops;
@@ -6,30 +6,203 @@
 #define LOG_CATEGORY	LOGC_BOOT
 
 #include <abuf.h>
+#include <cpu.h>
 #include <log.h>
 #include <malloc.h>
+#include <asm/global_data.h>
 #include <linux/errno.h>
 #include <linux/zstd.h>
 
-int zstd_decompress(struct abuf *in, struct abuf *out)
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Most frames decompressed in parallel */
+#define ZSTD_MAX_JOBS	16
+
+/**
+ * struct zstd_frame - one frame to decompress
+ *
+ * @src: Compressed frame
+ * @src_len: Length of @src
+ * @dst: Where to put the decompressed data
+ * @dst_len: Size of the decompressed data
+ * @workspace: Workspace for the decompression context
+ * @wsize: Size of @workspace
+ * @ret: Result of zstd_decompress_dctx()
+ */
+struct zstd_frame {
+	const void *src;
+	size_t src_len;
+	void *dst;
+	size_t dst_len;
+	void *workspace;
+	size_t wsize;
+	size_t ret;
+};
+
+/* Runs as a CPU job, so must not use malloc() or the console */
+static void zstd_decompress_frame(void *arg)
 {
+	struct zstd_frame *frame = arg;
 	zstd_dctx *ctx;
-	size_t wsize, len;
-	void *workspace;
-	int ret;
+
+	ctx = zstd_init_dctx(frame->workspace, frame->wsize);
+	if (!ctx) {
+		frame->ret = -(size_t)ZSTD_error_memory_allocation;
+		return;
+	}
+	frame->ret = zstd_decompress_dctx(ctx, frame->dst, frame->dst_len,
+					  frame->src, frame->src_len);
+}
+
+/*
+ * Split the input into its frames, e.g. as written by pzstd, so they can be
+ * decompressed at the same time. This needs the size of each frame to be
+ * recorded in its header.
+ *
+ * Return: number of frames, or 0 if the data cannot be split
+ */
+static int zstd_split_frames(struct abuf *in, struct abuf *out,
+			     struct zstd_frame *frames)
+{
+	const u8 *src = abuf_data(in);
+	size_t left = abuf_size(in);
+	u8 *dst = abuf_data(out);
+	size_t room = abuf_size(out);
+	zstd_frame_header hdr;
+	size_t len;
+	int count;
+
+	for (count = 0; left; count++) {
+		len = zstd_find_frame_compressed_size(src, left);
+		if (zstd_is_error(len))
+			break;
+		if (count == ZSTD_MAX_JOBS || zstd_get_frame_header(&hdr, src, len))
+			return 0;
+		if (hdr.frameType == ZSTD_skippableFrame)
+			hdr.frameContentSize = 0;
+		if (hdr.frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+		    hdr.frameContentSize > room)
+			return 0;
+
+		frames[count].src = src;
+		frames[count].src_len = len;
+		frames[count].dst = dst;
+		frames[count].dst_len = hdr.frameContentSize;
+		src += len;
+		left -= len;
+		dst += hdr.frameContentSize;
+		room -= hdr.frameContentSize;
+	}
+
+	return count > 1 ? count : 0;
+}
+
+static int zstd_decompress_parallel(struct abuf *in, struct abuf *out)
+{
+	struct zstd_frame frames[ZSTD_MAX_JOBS] = {};
+	struct cpu_job jobs[ZSTD_MAX_JOBS];
+	size_t wsize, total = 0;
+	int count, i, ret;
+
+	count = zstd_split_frames(in, out, frames);
+	if (!count)
+		return -EAGAIN;
 
 	wsize = zstd_dctx_workspace_bound();
-	workspace = malloc(wsize);
+	for (i = 0; i < count; i++) {
+		frames[i].wsize = wsize;
+		frames[i].workspace = malloc(wsize);
+		if (!frames[i].workspace) {
+			ret = -EAGAIN;
+			goto do_free;
+		}
+		jobs[i].func = zstd_decompress_frame;
+		jobs[i].arg = &frames[i];
+	}
+
+	log_debug("decompressing %d frames\n", count);
+	if (CONFIG_IS_ENABLED(CPU)) {
+		ret = cpu_run_jobs(jobs, count);
+		if (ret)
+			goto do_free;
+	} else {
+		for (i = 0; i < count; i++)
+			zstd_decompress_frame(&frames[i]);
+	}
+
+	for (i = 0; i < count; i++) {
+		if (zstd_is_error(frames[i].ret) ||
+		    frames[i].ret != frames[i].dst_len) {
+			log_err("%s: failed to decompress frame %d: %d\n",
+				__func__, i, zstd_get_error_code(frames[i].ret));
+			ret = -EINVAL;
+			goto do_free;
+		}
+		total += frames[i].ret;
+	}
+	ret = total;
+
+do_free:
+	for (i = 0; i < count; i++)
+		free(frames[i].workspace);
+
+	return ret;
+}
+
+/*
+ * Workspace kept for later calls once U-Boot has relocated, e.g. so that a
+ * FIT's kernel and ramdisk share one
+ */
+static void *zstd_workspace;
+
+/**
+ * zstd_get_dctx() - Set up a decompression context
+ *
+ * @freep: Returns the workspace to free when done, or NULL if it is kept
+ * Return: context, or NULL if out of memory
+ */
+static zstd_dctx *zstd_get_dctx(void **freep)
+{
+	bool keep = !IS_ENABLED(CONFIG_XPL_BUILD) &&
+		(gd->flags & GD_FLG_RELOC);
+	size_t wsize = zstd_dctx_workspace_bound();
+	void *workspace = keep ? zstd_workspace : NULL;
+
+	*freep = NULL;
 	if (!workspace) {
-		debug("%s: cannot allocate workspace of size %zu\n", __func__,
-			wsize);
-		return -ENOMEM;
+		workspace = malloc(wsize);
+		if (!workspace) {
+			debug("%s: cannot allocate workspace of size %zu\n",
+			      __func__, wsize);
+			return NULL;
+		}
+		if (keep)
+			zstd_workspace = workspace;
+		else
+			*freep = workspace;
 	}
 
-	ctx = zstd_init_dctx(workspace, wsize);
+	return zstd_init_dctx(workspace, wsize);
+}
+
+int zstd_decompress_dict(struct abuf *in, struct abuf *out,
+			 const struct abuf *dict)
+{
+	zstd_dctx *ctx;
+	size_t len;
+	void *workspace;
+	int ret;
+
+	if (!dict) {
+		ret = zstd_decompress_parallel(in, out);
+		if (ret != -EAGAIN)
+			return ret;
+	}
+
+	ctx = zstd_get_dctx(&workspace);
 	if (!ctx) {
 		log_err("%s: zstd_init_dctx() failed\n", __func__);
-		ret = -EPERM;
+		ret = -ENOMEM;
 		goto do_free;
 	}
 
@@ -45,8 +218,14 @@ int zstd_decompress(struct abuf *in, struct abuf *out)
 		goto do_free;
 	}
 
-	len = zstd_decompress_dctx(ctx, abuf_data(out), abuf_size(out),
-				   abuf_data(in), len);
+	if (dict)
+		len = ZSTD_decompress_usingDict(ctx, abuf_data(out),
+						abuf_size(out), abuf_data(in),
+						len, abuf_data(dict),
+						abuf_size(dict));
+	else
+		len = zstd_decompress_dctx(ctx, abuf_data(out), abuf_size(out),
+					   abuf_data(in), len);
 	if (zstd_is_error(len)) {
 		log_err("%s: failed to decompress: %d\n", __func__,
 			zstd_get_error_code(len));
@@ -59,3 +238,83 @@ do_free:
 	free(workspace);
 	return ret;
 }
+
+int zstd_decompress(struct abuf *in, struct abuf *out)
+{
+	return zstd_decompress_dict(in, out, NULL);
+}
+
+/**
+ * struct zstd_stream - state of a piecewise decompression
+ *
+ * @ds: Decompression stream, NULL until the frame header has been seen
+ * @workspace: Workspace for @ds
+ * @out: Destination buffer and the amount written to it
+ * @ended: true once the end of the frame has been seen
+ */
+struct zstd_stream {
+	zstd_dstream *ds;
+	void *workspace;
+	zstd_out_buffer out;
+	bool ended;
+};
+
+struct zstd_stream *zstd_stream_start(void *dst, ulong dstlen)
+{
+	struct zstd_stream *zs;
+
+	zs = calloc(1, sizeof(*zs));
+	if (!zs)
+		return NULL;
+	zs->out.dst = dst;
+	zs->out.size = dstlen;
+
+	return zs;
+}
+
+int zstd_stream_feed(struct zstd_stream *zs, const void *src, ulong len)
+{
+	zstd_in_buffer in = { .src = src, .size = len };
+	size_t ret;
+
+	/* Size the workspace for the window which the frame needs */
+	if (!zs->ds) {
+		zstd_frame_header hdr;
+		size_t wsize;
+
+		if (zstd_get_frame_header(&hdr, src, len) ||
+		    hdr.frameType != ZSTD_frame)
+			return -EINVAL;
+		wsize = zstd_dstream_workspace_bound(hdr.windowSize);
+		zs->workspace = malloc(wsize);
+		if (!zs->workspace)
+			return -ENOMEM;
+		zs->ds = zstd_init_dstream(hdr.windowSize, zs->workspace,
+					   wsize);
+		if (!zs->ds)
+			return -EINVAL;
+	}
+
+	while (!zs->ended && in.pos < in.size) {
+		ret = zstd_decompress_stream(zs->ds, &zs->out, &in);
+		if (zstd_is_error(ret))
+			return -EIO;
+		if (!ret)
+			zs->ended = true;
+		else if (zs->out.pos == zs->out.size && in.pos < in.size)
+			return -ENOSPC;
+	}
+
+	return zs->ended;
+}
+
+int zstd_stream_finish(struct zstd_stream *zs, ulong *lenp)
+{
+	int ret = zs->ended ? 0 : -EIO;
+
+	*lenp = zs->out.pos;
+	free(zs->workspace);
+	free(zs);
+
+	return ret;
+}
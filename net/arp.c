@@ -27,6 +27,25 @@ int		arp_wait_try;
 uchar	       *arp_tx_packet; /* THE ARP transmit packet */
 static uchar	arp_tx_packet_buf[PKTSIZE_ALIGN + PKTALIGN];
 
+#ifdef CONFIG_NET_ARP_CACHE
+/**
+ * struct arp_entry - An Ethernet address found by ARP
+ *
+ * @ip: IP address, or 0 if the entry is unused
+ * @ethaddr: Ethernet address for @ip
+ * @time: Time when the address was found, from get_timer()
+ */
+struct arp_entry {
+	struct in_addr ip;
+	uchar ethaddr[ARP_HLEN];
+	ulong time;
+};
+
+static struct arp_entry arp_cache[CONFIG_ARP_CACHE_SIZE];
+/* Our Ethernet address when the entries were found */
+static uchar arp_cache_owner[ARP_HLEN];
+#endif
+
 void arp_init(void)
 {
 	/* XXX problem with bss workaround */
@@ -68,23 +87,96 @@ void arp_raw_request(struct in_addr source_ip, const uchar *target_ethaddr,
 	net_send_packet(arp_tx_packet, eth_hdr_size + ARP_HDR_SIZE);
 }
 
+/* Return the address to look up to send to @dest: the gateway, if needed */
+static struct in_addr arp_next_hop(struct in_addr dest)
+{
+	if ((dest.s_addr & net_netmask.s_addr) !=
+	    (net_ip.s_addr & net_netmask.s_addr) && net_gateway.s_addr)
+		return net_gateway;
+
+	return dest;
+}
+
 void arp_request(void)
 {
 	if ((net_arp_wait_packet_ip.s_addr & net_netmask.s_addr) !=
-	    (net_ip.s_addr & net_netmask.s_addr)) {
-		if (net_gateway.s_addr == 0) {
-			puts("## Warning: gatewayip needed but not set\n");
-			net_arp_wait_reply_ip = net_arp_wait_packet_ip;
-		} else {
-			net_arp_wait_reply_ip = net_gateway;
+	    (net_ip.s_addr & net_netmask.s_addr) && net_gateway.s_addr == 0)
+		puts("## Warning: gatewayip needed but not set\n");
+	net_arp_wait_reply_ip = arp_next_hop(net_arp_wait_packet_ip);
+
+	arp_raw_request(net_ip, net_null_ethaddr, net_arp_wait_reply_ip);
+}
+
+#ifdef CONFIG_NET_ARP_CACHE
+static struct arp_entry *arp_cache_find(struct in_addr ip)
+{
+	struct arp_entry *entry;
+
+	/* Forget everything if we are now using a different interface */
+	if (memcmp(arp_cache_owner, net_ethaddr, ARP_HLEN)) {
+		memset(arp_cache, '\0', sizeof(arp_cache));
+		memcpy(arp_cache_owner, net_ethaddr, ARP_HLEN);
+		return NULL;
+	}
+
+	for (entry = arp_cache; entry < arp_cache + ARRAY_SIZE(arp_cache);
+	     entry++) {
+		if (!entry->ip.s_addr || entry->ip.s_addr != ip.s_addr)
+			continue;
+		if (get_timer(entry->time) >= CONFIG_ARP_CACHE_TIMEOUT * 1000) {
+			entry->ip.s_addr = 0;
+			return NULL;
 		}
-	} else {
-		net_arp_wait_reply_ip = net_arp_wait_packet_ip;
+
+		return entry;
 	}
 
-	arp_raw_request(net_ip, net_null_ethaddr, net_arp_wait_reply_ip);
+	return NULL;
+}
+
+static void arp_cache_add(struct in_addr ip, const uchar *ethaddr)
+{
+	struct arp_entry *entry, *victim;
+
+	victim = arp_cache_find(ip);
+	if (!victim) {
+		/* Use a free entry, or else replace the oldest one */
+		victim = arp_cache;
+		for (entry = arp_cache; entry < arp_cache +
+		     ARRAY_SIZE(arp_cache); entry++) {
+			if (!entry->ip.s_addr) {
+				victim = entry;
+				break;
+			}
+			if (get_timer(entry->time) > get_timer(victim->time))
+				victim = entry;
+		}
+	}
+
+	victim->ip = ip;
+	memcpy(victim->ethaddr, ethaddr, ARP_HLEN);
+	victim->time = get_timer(0);
 }
 
+bool arp_cache_lookup(struct in_addr dest, uchar *ethaddr)
+{
+	struct arp_entry *entry;
+
+	entry = arp_cache_find(arp_next_hop(dest));
+	if (!entry)
+		return false;
+	debug_cond(DEBUG_DEV_PKT, "ARP cache has %pI4 at %pM\n", &entry->ip,
+		   entry->ethaddr);
+	memcpy(ethaddr, entry->ethaddr, ARP_HLEN);
+
+	return true;
+}
+#else
+static void arp_cache_add(struct in_addr ip, const uchar *ethaddr)
+{
+}
+#endif
+
 int arp_timeout_check(void)
 {
 	ulong t;
@@ -201,6 +293,7 @@ void arp_receive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len)
 			if (arp_wait_packet_ethaddr != NULL)
 				memcpy(arp_wait_packet_ethaddr,
 				       &arp->ar_sha, ARP_HLEN);
+			arp_cache_add(reply_ip_addr, (uchar *)&arp->ar_sha);
 
 			net_get_arp_handler()((uchar *)arp, 0, reply_ip_addr,
 					      0, len);
@@ -27,4 +27,21 @@ void arp_raw_request(struct in_addr source_ip, const uchar *targetEther,
 int arp_timeout_check(void);
 void arp_receive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len);
 
+#ifdef CONFIG_NET_ARP_CACHE
+/**
+ * arp_cache_lookup() - Find an Ethernet address found by an earlier ARP
+ *
+ * @dest: IP address to send to. If it is not on our subnet, the gateway's
+ *	Ethernet address is found instead
+ * @ethaddr: Returns the Ethernet address, if found
+ * Return: true if found, false if an ARP request is needed
+ */
+bool arp_cache_lookup(struct in_addr dest, uchar *ethaddr);
+#else
+static inline bool arp_cache_lookup(struct in_addr dest, uchar *ethaddr)
+{
+	return false;
+}
+#endif
+
 #endif /* __ARP_H__ */
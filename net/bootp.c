@@ -484,6 +484,12 @@ static int dhcp_extended(u8 *e, int message_type, struct in_addr server_ip,
 	*e++ = (576 - 312 + OPT_FIELD_SIZE) >> 8;
 	*e++ = (576 - 312 + OPT_FIELD_SIZE) & 0xff;
 
+	if (IS_ENABLED(CONFIG_BOOTP_RAPID_COMMIT) &&
+	    message_type == DHCP_DISCOVER) {
+		*e++ = 80;	/* Rapid Commit (RFC 4039) */
+		*e++ = 0;
+	}
+
 	if (server_ip.s_addr) {
 		int tmp = ntohl(server_ip.s_addr);
 
@@ -716,6 +722,23 @@ void bootp_reset(void)
 	bootp_timeout = 250;
 }
 
+#if defined(CONFIG_CMD_DHCP)
+/*
+ * Return the address leased last time, if any. On the first try, this is
+ * asked for again (the INIT-REBOOT state in RFC 2131), which saves waiting
+ * for offers.
+ */
+static struct in_addr dhcp_reboot_ip(void)
+{
+	struct in_addr ip = { .s_addr = 0 };
+
+	if (IS_ENABLED(CONFIG_BOOTP_INIT_REBOOT) && !bootp_try)
+		ip = env_get_ip("dhcplease");
+
+	return ip;
+}
+#endif
+
 void bootp_request(void)
 {
 	uchar *pkt, *iphdr;
@@ -729,10 +752,14 @@ void bootp_request(void)
 	struct in_addr zero_ip;
 	struct in_addr bcast_ip;
 	char *ep;  /* Environment pointer */
+#if defined(CONFIG_CMD_DHCP)
+	struct in_addr reboot_ip;
+#endif
 
 	bootstage_mark_name(BOOTSTAGE_ID_BOOTP_START, "bootp_start");
 #if defined(CONFIG_CMD_DHCP)
 	dhcp_state = INIT;
+	reboot_ip = dhcp_reboot_ip();
 #endif
 
 	ep = env_get("bootpretryperiod");
@@ -794,8 +821,12 @@ void bootp_request(void)
 
 	/* Request additional information from the BOOTP/DHCP server */
 #if defined(CONFIG_CMD_DHCP)
-	extlen = dhcp_extended((u8 *)bp->bp_vend, DHCP_DISCOVER, zero_ip,
-			       zero_ip);
+	if (reboot_ip.s_addr)
+		extlen = dhcp_extended((u8 *)bp->bp_vend, DHCP_REQUEST,
+				       zero_ip, reboot_ip);
+	else
+		extlen = dhcp_extended((u8 *)bp->bp_vend, DHCP_DISCOVER,
+				       zero_ip, zero_ip);
 #else
 	extlen = bootp_extended((u8 *)bp->bp_vend);
 #endif
@@ -824,7 +855,7 @@ void bootp_request(void)
 	net_set_timeout_handler(bootp_timeout, bootp_timeout_handler);
 
 #if defined(CONFIG_CMD_DHCP)
-	dhcp_state = SELECTING;
+	dhcp_state = reboot_ip.s_addr ? REBOOTING : SELECTING;
 	net_set_udp_handler(dhcp_handler);
 #else
 	net_set_udp_handler(bootp_handler);
@@ -1080,6 +1111,15 @@ static void dhcp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	debug("DHCPHandler: got DHCP packet: (src=%d, dst=%d, len=%d) state: "
 	      "%d\n", src, dest, len, dhcp_state);
 
+	/* The lease from last time is not available, so ask for a new one */
+	if (dhcp_state == REBOOTING &&
+	    dhcp_message_type((u8 *)bp->bp_vend) == DHCP_NAK) {
+		debug("DHCP: saved lease refused\n");
+		env_set("dhcplease", NULL);
+		bootp_request();
+		return;
+	}
+
 	if (net_read_ip(&bp->bp_yiaddr).s_addr == 0) {
 #if defined(CONFIG_SERVERIP_FROM_PROXYDHCP)
 		store_bootp_params(bp);
@@ -1096,6 +1136,14 @@ static void dhcp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		 * is a valid OFFER from a server we want.
 		 */
 		debug("DHCP: state=SELECTING bp_file: \"%s\"\n", bp->bp_file);
+		if (IS_ENABLED(CONFIG_BOOTP_RAPID_COMMIT) &&
+		    dhcp_message_type((u8 *)bp->bp_vend) == DHCP_ACK) {
+			debug("got rapid-commit ACK; transitioning to BOUND\n");
+			if (CONFIG_IS_ENABLED(EFI_LOADER) &&
+			    IS_ENABLED(CONFIG_NETDEVICES))
+				efi_net_set_dhcp_ack(pkt, len);
+			goto dhcp_got_bootp;
+		}
 #ifdef CONFIG_SYS_BOOTFILE_PREFIX
 		if (strncmp(bp->bp_file,
 			    CONFIG_SYS_BOOTFILE_PREFIX,
@@ -1128,14 +1176,22 @@ static void dhcp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 		return;
 		break;
+	case REBOOTING:
 	case REQUESTING:
-		debug("DHCP State: REQUESTING\n");
+		debug("DHCP State: %s\n",
+		      dhcp_state == REBOOTING ? "REBOOTING" : "REQUESTING");
 
 		if (dhcp_message_type((u8 *)bp->bp_vend) == DHCP_ACK) {
 dhcp_got_bootp:
 			dhcp_packet_process_options(bp);
 			/* Store net params from reply */
 			store_net_params(bp);
+			if (IS_ENABLED(CONFIG_BOOTP_INIT_REBOOT)) {
+				char lease[22];
+
+				ip_to_string(net_ip, lease);
+				env_set("dhcplease", lease);
+			}
 			dhcp_state = BOUND;
 			printf("DHCP client bound to address %pI4 (%lu ms)\n",
 			       &net_ip, get_timer(bootp_start));
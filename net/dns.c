@@ -25,8 +25,10 @@
 #include <command.h>
 #include <env.h>
 #include <log.h>
+#include <malloc.h>
 #include <net.h>
 #include <asm/unaligned.h>
+#include <linux/kernel.h>
 
 #include "dns.h"
 
@@ -35,6 +37,102 @@ char *net_dns_env_var;	/* The envvar to store the answer in */
 
 static int dns_our_port;
 
+#ifdef CONFIG_DNS_CACHE
+/* Longest time to keep an answer for, in seconds */
+#define DNS_CACHE_MAX_TTL	(24 * 60 * 60)
+
+/**
+ * struct dns_entry - An answer from the DNS server
+ *
+ * @name: Name which was looked up, or NULL if the entry is unused
+ * @server: DNS server which gave the answer
+ * @ip: IP address for @name
+ * @time: Time when the answer was received, from get_timer()
+ * @ttl: Number of milliseconds for which the answer is valid
+ */
+struct dns_entry {
+	char *name;
+	struct in_addr server;
+	struct in_addr ip;
+	ulong time;
+	ulong ttl;
+};
+
+static struct dns_entry dns_cache[CONFIG_DNS_CACHE_SIZE];
+
+static struct dns_entry *dns_cache_find(const char *name)
+{
+	struct dns_entry *entry;
+
+	for (entry = dns_cache; entry < dns_cache + ARRAY_SIZE(dns_cache);
+	     entry++) {
+		if (!entry->name || strcasecmp(entry->name, name) ||
+		    entry->server.s_addr != net_dns_server.s_addr)
+			continue;
+		if (get_timer(entry->time) >= entry->ttl) {
+			free(entry->name);
+			entry->name = NULL;
+			return NULL;
+		}
+
+		return entry;
+	}
+
+	return NULL;
+}
+
+static void dns_cache_add(const char *name, struct in_addr ip, u32 ttl)
+{
+	struct dns_entry *entry, *victim;
+
+	if (!ttl)
+		return;
+	victim = dns_cache_find(name);
+	if (!victim) {
+		/* Use a free entry, or else replace the oldest one */
+		victim = dns_cache;
+		for (entry = dns_cache; entry < dns_cache +
+		     ARRAY_SIZE(dns_cache); entry++) {
+			if (!entry->name) {
+				victim = entry;
+				break;
+			}
+			if (get_timer(entry->time) > get_timer(victim->time))
+				victim = entry;
+		}
+		free(victim->name);
+		victim->name = strdup(name);
+		if (!victim->name)
+			return;
+	}
+	victim->server = net_dns_server;
+	victim->ip = ip;
+	victim->time = get_timer(0);
+	victim->ttl = min_t(u32, ttl, DNS_CACHE_MAX_TTL) * 1000;
+}
+
+static bool dns_cache_lookup(const char *name, struct in_addr *ip)
+{
+	struct dns_entry *entry;
+
+	entry = dns_cache_find(name);
+	if (!entry)
+		return false;
+	*ip = entry->ip;
+
+	return true;
+}
+#else
+static void dns_cache_add(const char *name, struct in_addr ip, u32 ttl)
+{
+}
+
+static bool dns_cache_lookup(const char *name, struct in_addr *ip)
+{
+	return false;
+}
+#endif
+
 /*
  * make port a little random (1024-17407)
  * This keeps the math somewhat trivial to compute, and seems to work with
@@ -105,6 +203,17 @@ static void dns_send(void)
 	debug("DNS packet sent\n");
 }
 
+/* Report the answer, and store it in the requested variable if any */
+static void dns_answer(struct in_addr ip_addr)
+{
+	char ip_str[22];
+
+	ip_to_string(ip_addr, ip_str);
+	printf("%s\n", ip_str);
+	if (net_dns_env_var)
+		env_set(net_dns_env_var, ip_str);
+}
+
 static void dns_timeout_handler(void)
 {
 	puts("Timeout\n");
@@ -118,8 +227,8 @@ static void dns_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	const unsigned char *p, *e, *s;
 	u16 type, i;
 	int found, stop, dlen;
-	char ip_str[22];
 	struct in_addr ip_addr;
+	u32 ttl;
 
 	debug("%s\n", __func__);
 	if (dest != dns_our_port)
@@ -186,15 +295,14 @@ static void dns_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	}
 
 	if (found && &p[12] < e) {
+		ttl = get_unaligned_be32(p + 6);
 		dlen = get_unaligned_be16(p+10);
 		p += 12;
 		memcpy(&ip_addr, p, 4);
 
 		if (p + dlen <= e) {
-			ip_to_string(ip_addr, ip_str);
-			printf("%s\n", ip_str);
-			if (net_dns_env_var)
-				env_set(net_dns_env_var, ip_str);
+			dns_answer(ip_addr);
+			dns_cache_add(net_dns_resolve, ip_addr, ttl);
 		} else {
 			puts("server responded with invalid IP number\n");
 		}
@@ -205,8 +313,16 @@ static void dns_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 void dns_start(void)
 {
+	struct in_addr ip_addr;
+
 	debug("%s\n", __func__);
 
+	if (dns_cache_lookup(net_dns_resolve, &ip_addr)) {
+		dns_answer(ip_addr);
+		net_set_state(NETLOOP_SUCCESS);
+		return;
+	}
+
 	net_set_timeout_handler(DNS_TIMEOUT, dns_timeout_handler);
 	net_set_udp_handler(dns_handler);
 
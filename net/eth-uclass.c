@@ -435,6 +435,85 @@ int eth_send(void *packet, int length)
 	return ret;
 }
 
+int eth_mcast_join(struct in_addr mcast_ip, int join)
+{
+	u32 addr = ntohl(mcast_ip.s_addr);
+	u8 mcast_mac[ARP_HLEN];
+	struct udevice *current;
+
+	current = eth_get_dev();
+	if (!current)
+		return -ENODEV;
+
+	/* RFC 1112: the group's low 23 bits follow 01:00:5e */
+	mcast_mac[0] = 0x01;
+	mcast_mac[1] = 0x00;
+	mcast_mac[2] = 0x5e;
+	mcast_mac[3] = (addr >> 16) & 0x7f;
+	mcast_mac[4] = addr >> 8;
+	mcast_mac[5] = addr;
+
+	if (eth_get_ops(current)->mcast)
+		return eth_get_ops(current)->mcast(current, mcast_mac, join);
+
+	/* Without a filter for the group, accept everything instead */
+	if (eth_get_ops(current)->set_promisc)
+		return eth_get_ops(current)->set_promisc(current, join);
+
+	return -ENOSYS;
+}
+
+/*
+ * Take packets from the driver a burst at a time, processing each burst and
+ * then giving all its buffers back together, until the driver has no more or
+ * the budget of ETH_PACKETS_BATCH_RECV packets is used up
+ */
+static int eth_rx_burst(struct udevice *dev)
+{
+	const struct eth_ops *ops = eth_get_ops(dev);
+	uchar *packets[ETH_PACKETS_BATCH_RECV];
+	int lengths[ETH_PACKETS_BATCH_RECV];
+	int budget = ETH_PACKETS_BATCH_RECV;
+	int flags = ETH_RECV_CHECK_DEVICE;
+	int ret, i;
+
+	do {
+		ret = ops->recv_burst(dev, flags, packets, lengths, budget);
+		flags = 0;
+		if (ret <= 0)
+			break;
+		ret = min(ret, budget);
+		for (i = 0; i < ret; i++) {
+			if (lengths[i] > 0)
+				net_process_received_packet(packets[i],
+							    lengths[i]);
+			net_rx_direct_done(packets[i]);
+		}
+		if (ops->free_pkts) {
+			ops->free_pkts(dev, packets, lengths, ret);
+		} else if (ops->free_pkt) {
+			for (i = 0; i < ret; i++)
+				ops->free_pkt(dev, packets[i], lengths[i]);
+		}
+		budget -= ret;
+	} while (budget);
+
+	return ret;
+}
+
+bool eth_offload(uint flags)
+{
+	struct eth_pdata *pdata;
+	struct udevice *current;
+
+	current = eth_get_dev();
+	if (!current)
+		return false;
+	pdata = dev_get_plat(current);
+
+	return (pdata->offload & flags) == flags;
+}
+
 int eth_rx(void)
 {
 	struct udevice *current;
@@ -450,6 +529,11 @@ int eth_rx(void)
 	if (!eth_is_active(current))
 		return -EINVAL;
 
+	if (eth_get_ops(current)->recv_burst) {
+		ret = eth_rx_burst(current);
+		goto done;
+	}
+
 	/* Process up to 32 packets at one time */
 	flags = ETH_RECV_CHECK_DEVICE;
 	for (i = 0; i < ETH_PACKETS_BATCH_RECV; i++) {
@@ -457,11 +541,14 @@ int eth_rx(void)
 		flags = 0;
 		if (ret > 0)
 			net_process_received_packet(packet, ret);
+		net_rx_direct_done(NULL);
 		if (ret >= 0 && eth_get_ops(current)->free_pkt)
 			eth_get_ops(current)->free_pkt(current, packet, ret);
 		if (ret <= 0)
 			break;
 	}
+done:
+	net_rx_direct_done(NULL);
 	if (ret == -EAGAIN)
 		ret = 0;
 	if (ret < 0) {
@@ -16,68 +16,185 @@ static const uchar *handshake = "FB01";
 static char rxbuf[sizeof(u64) + FASTBOOT_COMMAND_LEN + 1];
 static char txbuf[sizeof(u64) + FASTBOOT_RESPONSE_LEN + 1];
 
+/* Offset in the stream of rxbuf[0], i.e. of the next packet */
 static u32 data_read;
+/*
+ * Offset in the stream up to which the payload of a data packet has been
+ * passed on. The payload ends at data_read, so this equals data_read unless
+ * a data packet is being received.
+ */
+static u32 payload_read;
+static bool downloading;
 static u32 tx_last_offs, tx_last_len;
 
-static void tcp_stream_on_rcv_nxt_update(struct tcp_stream *tcp, u32 rx_bytes)
+static void tcp_stream_respond(void)
 {
-	u64	cmd_size;
 	__be64	len_be;
+	int	len;
+
+	len = strlen(txbuf + sizeof(u64));
+	len_be = __cpu_to_be64(len);
+	memcpy(txbuf, &len_be, sizeof(u64));
+
+	tx_last_offs += tx_last_len;
+	tx_last_len = len + sizeof(u64);
+}
+
+/* Drop @len bytes from the start of rxbuf, with @avail bytes in it */
+static void tcp_stream_consume(u32 len, u32 avail)
+{
+	data_read += len;
+	if (avail > len)
+		memmove(rxbuf, rxbuf + len, avail - len);
+}
+
+static void tcp_stream_on_rcv_nxt_update(struct tcp_stream *tcp, u32 rx_bytes)
+{
+	char	response[FASTBOOT_RESPONSE_LEN];
+	u64	size;
+	u32	avail, len;
 	char	saved;
-	int	fastboot_command_id, len;
+	int	fastboot_command_id;
+
+	for (;;) {
+		/* Account for payload placed in the download buffer by rx() */
+		len = min(rx_bytes - payload_read, data_read - payload_read);
+		if (len) {
+			fastboot_data_download(fastboot_data_buf(), len,
+					       response);
+			payload_read += len;
+		}
+		tcp->rcv_space = data_read + sizeof(rxbuf);
+		if (payload_read != data_read)
+			return;
 
-	if (!data_read && rx_bytes >= handshake_length) {
-		if (memcmp(rxbuf, handshake, handshake_length)) {
-			printf("fastboot: bad handshake\n");
-			tcp_stream_close(tcp);
+		if (downloading && !fastboot_data_remaining()) {
+			downloading = false;
+			fastboot_data_complete(txbuf + sizeof(u64));
+			tcp_stream_respond();
 			return;
 		}
 
-		tx_last_offs = 0;
-		tx_last_len = handshake_length;
-		memcpy(txbuf, handshake, handshake_length);
-
-		data_read += handshake_length;
-		rx_bytes -= handshake_length;
-		if (rx_bytes > 0)
-			memmove(rxbuf, rxbuf + handshake_length, rx_bytes);
-		return;
-	}
+		avail = rx_bytes - data_read;
+		if (!data_read && avail >= handshake_length) {
+			if (memcmp(rxbuf, handshake, handshake_length)) {
+				printf("fastboot: bad handshake\n");
+				tcp_stream_close(tcp);
+				return;
+			}
 
-	if (rx_bytes < sizeof(u64))
-		return;
+			tx_last_offs = 0;
+			tx_last_len = handshake_length;
+			memcpy(txbuf, handshake, handshake_length);
 
-	memcpy(&cmd_size, rxbuf, sizeof(u64));
-	cmd_size = __be64_to_cpu(cmd_size);
-	if (rx_bytes < sizeof(u64) + cmd_size)
-		return;
+			tcp_stream_consume(handshake_length, avail);
+			payload_read = data_read;
+			return;
+		}
 
-	saved = rxbuf[sizeof(u64) + cmd_size];
-	rxbuf[sizeof(u64) + cmd_size] = '\0';
-	fastboot_command_id = fastboot_handle_command(rxbuf + sizeof(u64),
-						      txbuf + sizeof(u64));
-	fastboot_handle_boot(fastboot_command_id,
-			     strncmp("OKAY", txbuf + sizeof(u64), 4) != 0);
-	rxbuf[sizeof(u64) + cmd_size] = saved;
+		if (avail < sizeof(u64))
+			return;
 
-	len = strlen(txbuf + sizeof(u64));
-	len_be = __cpu_to_be64(len);
-	memcpy(txbuf, &len_be, sizeof(u64));
+		memcpy(&size, rxbuf, sizeof(u64));
+		size = __be64_to_cpu(size);
+
+		if (downloading) {
+			if (!size || size > fastboot_data_remaining()) {
+				printf("fastboot: bad data packet\n");
+				tcp_stream_close(tcp);
+				return;
+			}
+
+			/*
+			 * Anything received along with the header is in rxbuf;
+			 * the rest of the payload is placed by rx()
+			 */
+			len = min_t(u64, avail - sizeof(u64), size);
+			if (len)
+				fastboot_data_download(rxbuf + sizeof(u64), len,
+						       response);
+			tcp_stream_consume(sizeof(u64) + len, avail);
+			payload_read = data_read;
+			data_read += size - len;
+			continue;
+		}
 
-	tx_last_offs += tx_last_len;
-	tx_last_len = len + sizeof(u64);
+		if (size > FASTBOOT_COMMAND_LEN) {
+			printf("fastboot: command too long\n");
+			tcp_stream_close(tcp);
+			return;
+		}
+		if (avail < sizeof(u64) + size)
+			return;
 
-	data_read += sizeof(u64) + cmd_size;
-	rx_bytes -= sizeof(u64) + cmd_size;
-	if (rx_bytes > 0)
-		memmove(rxbuf, rxbuf + sizeof(u64) + cmd_size, rx_bytes);
+		saved = rxbuf[sizeof(u64) + size];
+		rxbuf[sizeof(u64) + size] = '\0';
+		fastboot_command_id = fastboot_handle_command(rxbuf + sizeof(u64),
+							      txbuf + sizeof(u64));
+		fastboot_handle_boot(fastboot_command_id,
+				     strncmp("OKAY", txbuf + sizeof(u64), 4) != 0);
+		rxbuf[sizeof(u64) + size] = saved;
+		downloading = fastboot_command_id == FASTBOOT_COMMAND_DOWNLOAD &&
+			fastboot_data_remaining();
+
+		tcp_stream_respond();
+		tcp_stream_consume(sizeof(u64) + size, avail);
+		payload_read = data_read;
+		tcp->rcv_space = data_read + sizeof(rxbuf);
+
+		/* Only one response can be outstanding */
+		return;
+	}
 }
 
+/*
+ * The payload of a data packet is received straight into the download buffer,
+ * in any order. When streaming a download to a partition it is passed on as it
+ * arrives instead, so it must arrive in order. Other data is small and is
+ * only accepted in order, into rxbuf.
+ */
 static int tcp_stream_rx(struct tcp_stream *tcp, u32 rx_offs, void *buf, int len)
 {
-	memcpy(rxbuf + rx_offs - data_read, buf, len);
+	char response[FASTBOOT_RESPONSE_LEN];
+	s32 ofs = rx_offs - payload_read;
+	u32 size = data_read - payload_read;
+	int done = 0, n;
+	void *dest;
+
+	/* Skip anything which has been passed on already */
+	if (ofs < 0) {
+		done = min(len, -ofs);
+		ofs = 0;
+	}
+
+	if (done < len && ofs < size) {
+		n = min_t(u32, len - done, size - ofs);
+		dest = fastboot_data_buf();
+		if (dest) {
+			memcpy(dest + ofs, buf + done, n);
+		} else if (!ofs) {
+			fastboot_data_download(buf + done, n, response);
+			payload_read += n;
+			size -= n;
+		} else {
+			return done;
+		}
+		done += n;
+		ofs += n;
+	}
+
+	if (done < len) {
+		if ((s32)(rx_offs - tcp_stream_rx_offs(tcp)) > 0)
+			return done;
+		ofs -= size;
+		if (ofs >= sizeof(rxbuf))
+			return done;
+		n = min_t(u32, len - done, sizeof(rxbuf) - ofs);
+		memcpy(rxbuf + ofs, buf + done, n);
+		done += n;
+	}
 
-	return len;
+	return done;
 }
 
 static int tcp_stream_tx(struct tcp_stream *tcp, u32 tx_offs, void *buf, int maxlen)
@@ -98,8 +215,11 @@ static int tcp_stream_on_create(struct tcp_stream *tcp)
 		return 0;
 
 	data_read = 0;
+	payload_read = 0;
+	downloading = false;
 	tx_last_offs = 0;
 	tx_last_len = 0;
+	tcp->rcv_space = sizeof(rxbuf);
 
 	tcp->on_rcv_nxt_update = tcp_stream_on_rcv_nxt_update;
 	tcp->rx = tcp_stream_rx;
@@ -12,6 +12,9 @@
 #include <lwip/etharp.h>
 #include <lwip/init.h>
 #include <lwip/prot/etharp.h>
+#if CONFIG_IS_ENABLED(LWIP_RX_ZERO_COPY) && LWIP_TCP
+#include <lwip/priv/tcp_priv.h>
+#endif
 #include <net.h>
 
 /* xx:xx:xx:xx:xx:xx\0 */
@@ -145,6 +148,8 @@ static struct netif *new_netif(struct udevice *udev, bool with_ip)
 {
 	unsigned char enetaddr[ARP_HLEN];
 	char hwstr[MAC_ADDR_STRLEN];
+	u16 csum = NETIF_CHECKSUM_ENABLE_ALL;
+	struct eth_pdata *pdata;
 	ip4_addr_t ip, mask, gw;
 	struct netif *netif;
 	int ret = 0;
@@ -193,6 +198,14 @@ static struct netif *new_netif(struct udevice *udev, bool with_ip)
 		return NULL;
 	}
 
+	pdata = dev_get_plat(udev);
+	if (pdata->offload & ETH_OFFLOAD_RX_CSUM)
+		csum &= ~(NETIF_CHECKSUM_CHECK_IP | NETIF_CHECKSUM_CHECK_UDP |
+			  NETIF_CHECKSUM_CHECK_TCP);
+	if (pdata->offload & ETH_OFFLOAD_TX_CSUM)
+		csum &= ~(NETIF_CHECKSUM_GEN_IP | NETIF_CHECKSUM_GEN_TCP);
+	NETIF_SET_CHECKSUM_CTRL(netif, csum);
+
 	netif_set_up(netif);
 	netif_set_link_up(netif);
 	/* Routing: use this interface to reach the default gateway */
@@ -248,9 +261,141 @@ static struct pbuf *alloc_pbuf_and_copy(uchar *data, int len)
 	return p;
 }
 
-int net_lwip_rx(struct udevice *udev, struct netif *netif)
+#if CONFIG_IS_ENABLED(LWIP_RX_ZERO_COPY)
+/* Number of received frames lwIP may hold on to after processing them */
+#define NET_LWIP_RX_PBUFS	8
+
+/**
+ * struct net_lwip_rx_pbuf - custom pbuf wrapping a driver receive buffer
+ *
+ * @pc: Custom pbuf handed to lwIP
+ * @packet: Driver buffer the pbuf points into, until it is detached
+ * @len: Length of the frame
+ * @in_use: true until lwIP frees the pbuf
+ * @buf: Storage for the frame when lwIP keeps it past free_pkt()
+ */
+struct net_lwip_rx_pbuf {
+	struct pbuf_custom pc;
+	uchar *packet;
+	int len;
+	bool in_use;
+	uchar buf[PKTSIZE_ALIGN];
+};
+
+static struct net_lwip_rx_pbuf net_lwip_rx_pbufs[NET_LWIP_RX_PBUFS];
+
+static void net_lwip_rx_pbuf_free(struct pbuf *p)
+{
+	struct net_lwip_rx_pbuf *rp;
+
+	rp = container_of(p, struct net_lwip_rx_pbuf, pc.pbuf);
+	rp->in_use = false;
+}
+
+/**
+ * alloc_pbuf_ref() - wrap a received frame in a pbuf without copying it
+ *
+ * @data: Frame as returned by the driver
+ * @len: Length of the frame
+ * Return: pbuf, or NULL if none is free or the frame does not fit in one
+ */
+static struct pbuf *alloc_pbuf_ref(uchar *data, int len)
+{
+	struct net_lwip_rx_pbuf *rp;
+	struct pbuf *p;
+	int i;
+
+	if (len > PKTSIZE_ALIGN)
+		return NULL;
+
+	for (i = 0; i < NET_LWIP_RX_PBUFS; i++) {
+		rp = &net_lwip_rx_pbufs[i];
+		if (rp->in_use)
+			continue;
+
+		rp->pc.custom_free_function = net_lwip_rx_pbuf_free;
+		p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &rp->pc, data,
+					len);
+		if (!p)
+			return NULL;
+		rp->packet = data;
+		rp->len = len;
+		rp->in_use = true;
+		LINK_STATS_INC(link.recv);
+
+		return p;
+	}
+
+	return NULL;
+}
+
+/**
+ * detach_pbuf_ref() - stop a pbuf from using the driver's buffer
+ *
+ * Most frames are finished with by the time netif->input() returns, so the
+ * buffer can go back to the driver as it is. The ones lwIP keeps, such as TCP
+ * segments queued out of order, are moved into the pbuf's own storage, along
+ * with the pointers lwIP holds into them.
+ *
+ * @p: pbuf from alloc_pbuf_ref()
+ */
+static void detach_pbuf_ref(struct pbuf *p)
+{
+	struct net_lwip_rx_pbuf *rp;
+	uchar *start, *end;
+	ptrdiff_t delta;
+
+	rp = container_of(p, struct net_lwip_rx_pbuf, pc.pbuf);
+	start = rp->packet;
+	if (!rp->in_use || !start)
+		return;
+	end = start + rp->len;
+	rp->packet = NULL;
+
+	memcpy(rp->buf, start, rp->len);
+	delta = rp->buf - start;
+	p->payload = (uchar *)p->payload + delta;
+#if LWIP_TCP
+	{
+		struct tcp_pcb *pcb;
+		struct tcp_seg *seg;
+
+		for (pcb = tcp_active_pcbs; pcb; pcb = pcb->next) {
+#if TCP_QUEUE_OOSEQ
+			for (seg = pcb->ooseq; seg; seg = seg->next) {
+				uchar *hdr = (uchar *)seg->tcphdr;
+
+				if (hdr >= start && hdr < end)
+					seg->tcphdr = (void *)(hdr + delta);
+			}
+#else
+			(void)seg;
+#endif
+		}
+	}
+#endif
+}
+#endif
+
+static void net_lwip_input(struct netif *netif, uchar *packet, int len)
 {
 	struct pbuf *pbuf;
+
+#if CONFIG_IS_ENABLED(LWIP_RX_ZERO_COPY)
+	pbuf = alloc_pbuf_ref(packet, len);
+	if (pbuf) {
+		netif->input(pbuf, netif);
+		detach_pbuf_ref(pbuf);
+		return;
+	}
+#endif
+	pbuf = alloc_pbuf_and_copy(packet, len);
+	if (pbuf)
+		netif->input(pbuf, netif);
+}
+
+int net_lwip_rx(struct udevice *udev, struct netif *netif)
+{
 	uchar *packet;
 	int flags;
 	int len;
@@ -264,11 +409,8 @@ int net_lwip_rx(struct udevice *udev, struct netif *netif)
 		len = eth_get_ops(udev)->recv(udev, flags, &packet);
 		flags = 0;
 
-		if (len > 0) {
-			pbuf = alloc_pbuf_and_copy(packet, len);
-			if (pbuf)
-				netif->input(pbuf, netif);
-		}
+		if (len > 0)
+			net_lwip_input(netif, packet, len);
 		if (len >= 0 && eth_get_ops(udev)->free_pkt)
 			eth_get_ops(udev)->free_pkt(udev, packet, len);
 		if (len <= 0)
@@ -88,7 +88,9 @@
 #include <errno.h>
 #include <image.h>
 #include <led.h>
+#include <lmb.h>
 #include <log.h>
+#include <mapmem.h>
 #if defined(CONFIG_LED_STATUS)
 #include <miiphy.h>
 #endif
@@ -152,6 +154,10 @@ u8 net_server_ethaddr[6];
 struct in_addr	net_ip;
 /* Server IP addr (0 = unknown) */
 struct in_addr	net_server_ip;
+#ifdef CONFIG_TFTP_MULTICAST
+/* Multicast group being received (0 = none) */
+struct in_addr	net_mcast_addr;
+#endif
 /* Current receive packet */
 uchar *net_rx_packet;
 /* Current rx packet length */
@@ -392,6 +398,7 @@ static void net_clear_handlers(void)
 	net_set_udp_handler(NULL);
 	net_set_arp_handler(NULL);
 	net_set_timeout_handler(0, NULL);
+	net_set_rx_direct(0, 0, 0);
 }
 
 static void net_cleanup_loop(void)
@@ -897,6 +904,65 @@ void net_set_timeout_handler(ulong iv, thand_f *f)
 	}
 }
 
+#ifdef CONFIG_NET_RX_DIRECT
+/**
+ * struct net_rx_direct - receiving a packet so its payload lands in place
+ *
+ * @dest: Address where the payload of the next packet expected is to be
+ *	stored, 0 if none
+ * @hdr_len: Size of the headers before that payload
+ * @len: Size of the payload
+ * @buf: Buffer handed to the driver, NULL if none
+ * @save_len: Number of bytes held in @save
+ * @save: Contents of the memory before @dest which the headers overwrite
+ */
+static struct net_rx_direct {
+	ulong dest;
+	int hdr_len;
+	int len;
+	uchar *buf;
+	int save_len;
+	uchar save[PKTSIZE_ALIGN];
+} net_rx_direct;
+
+void net_set_rx_direct(ulong dest, int hdr_len, int len)
+{
+	net_rx_direct.dest = dest;
+	net_rx_direct.hdr_len = hdr_len;
+	net_rx_direct.len = len;
+}
+
+uchar *net_rx_direct_buf(int len)
+{
+	struct net_rx_direct *rd = &net_rx_direct;
+	ulong start = rd->dest - rd->hdr_len;
+
+	net_rx_direct_done(NULL);
+	if (!rd->dest || len > PKTSIZE_ALIGN ||
+	    rd->hdr_len > sizeof(rd->save))
+		return NULL;
+	if (CONFIG_IS_ENABLED(LMB) && lmb_read_check(start, len))
+		return NULL;
+
+	rd->buf = map_sysmem(start, len);
+	rd->save_len = rd->hdr_len;
+	memcpy(rd->save, rd->buf, rd->save_len);
+
+	return rd->buf;
+}
+
+void net_rx_direct_done(uchar *pkt)
+{
+	struct net_rx_direct *rd = &net_rx_direct;
+
+	if (!rd->buf || (pkt && pkt != rd->buf))
+		return;
+	memcpy(rd->buf, rd->save, rd->save_len);
+	unmap_sysmem(rd->buf);
+	rd->buf = NULL;
+}
+#endif
+
 uchar *net_get_async_tx_pkt_buf(void)
 {
 	if (arp_is_waiting())
@@ -945,6 +1011,8 @@ int net_send_ip_packet(uchar *ether, struct in_addr dest, int dport, int sport,
 	/* if broadcast, make the ether address a broadcast and don't do ARP */
 	if (dest.s_addr == 0xFFFFFFFF)
 		ether = (uchar *)net_bcast_ethaddr;
+	else if (!memcmp(ether, net_null_ethaddr, 6))
+		arp_cache_lookup(dest, ether);	/* found by an earlier ARP? */
 
 	pkt = (uchar *)net_tx_packet;
 
@@ -1019,13 +1087,65 @@ struct hole {
 	u16 unused;
 };
 
+/* Time after which a datagram still missing fragments is given up */
+#define IP_DEFRAG_TIMEOUT	5000UL
+
+/**
+ * struct ip_defrag - a datagram being reassembled
+ *
+ * @buf: IP header, then the payload with the holes list inside it
+ * @first_hole: Index of the first hole, in 8-byte blocks
+ * @total_len: Length of the payload, 0xffff until the last fragment is seen,
+ *	0 if this context is free
+ * @start: Time when the first fragment arrived
+ */
+struct ip_defrag {
+	uchar buf[IP_PKTSIZE] __aligned(PKTALIGN);
+	u16 first_hole;
+	u16 total_len;
+	ulong start;
+};
+
+static struct ip_defrag ip_defrag[CONFIG_NET_DEFRAG_SLOTS];
+
+/*
+ * Find the context for the datagram a fragment belongs to. If there is none,
+ * use a free one, else the oldest, giving up on the datagram it holds. A
+ * datagram still incomplete after IP_DEFRAG_TIMEOUT is given up too.
+ */
+static struct ip_defrag *ip_defrag_find(struct ip_udp_hdr *ip)
+{
+	struct ip_defrag *ctx, *best = NULL;
+	struct ip_udp_hdr *hdr;
+
+	for (ctx = ip_defrag; ctx < ip_defrag + ARRAY_SIZE(ip_defrag); ctx++) {
+		hdr = (struct ip_udp_hdr *)ctx->buf;
+		if (ctx->total_len &&
+		    get_timer(ctx->start) >= IP_DEFRAG_TIMEOUT) {
+			debug("defrag: datagram timed out\n");
+			ctx->total_len = 0;
+		}
+		if (ctx->total_len && hdr->ip_id == ip->ip_id &&
+		    hdr->ip_p == ip->ip_p &&
+		    hdr->ip_src.s_addr == ip->ip_src.s_addr)
+			return ctx;
+		if (!best || !ctx->total_len ||
+		    (best->total_len && (long)(ctx->start - best->start) < 0))
+			best = ctx;
+	}
+	if (best->total_len)
+		debug("defrag: dropping incomplete datagram\n");
+	best->total_len = 0;
+
+	return best;
+}
+
 static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 {
-	static uchar pkt_buff[IP_PKTSIZE] __aligned(PKTALIGN);
-	static u16 first_hole, total_len;
 	struct hole *payload, *thisfrag, *h, *newh;
-	struct ip_udp_hdr *localip = (struct ip_udp_hdr *)pkt_buff;
+	struct ip_udp_hdr *localip;
 	uchar *indata = (uchar *)ip;
+	struct ip_defrag *ctx;
 	int offset8, start, len, done = 0;
 	u16 ip_off = ntohs(ip->ip_off);
 
@@ -1036,10 +1156,7 @@ static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 	if (ntohs(ip->ip_len) <= IP_HDR_SIZE)
 		return NULL;
 
-	/* payload starts after IP header, this fragment is in there */
-	payload = (struct hole *)(pkt_buff + IP_HDR_SIZE);
 	offset8 =  (ip_off & IP_OFFS);
-	thisfrag = payload + offset8;
 	start = offset8 * 8;
 	len = ntohs(ip->ip_len) - IP_HDR_SIZE;
 
@@ -1050,13 +1167,21 @@ static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 	if (start + len > IP_MAXUDP) /* fragment extends too far */
 		return NULL;
 
-	if (!total_len || localip->ip_id != ip->ip_id) {
-		/* new (or different) packet, reset structs */
-		total_len = 0xffff;
+	ctx = ip_defrag_find(ip);
+	localip = (struct ip_udp_hdr *)ctx->buf;
+
+	/* payload starts after IP header, this fragment is in there */
+	payload = (struct hole *)(ctx->buf + IP_HDR_SIZE);
+	thisfrag = payload + offset8;
+
+	if (!ctx->total_len) {
+		/* new packet, reset structs */
+		ctx->total_len = 0xffff;
+		ctx->start = get_timer(0);
 		payload[0].last_byte = ~0;
 		payload[0].next_hole = 0;
 		payload[0].prev_hole = 0;
-		first_hole = 0;
+		ctx->first_hole = 0;
 		/* any IP header will work, copy the first we received */
 		memcpy(localip, ip, IP_HDR_SIZE);
 	}
@@ -1068,7 +1193,7 @@ static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 	 * so it is represented as byte count, not as 8-byte blocks.
 	 */
 
-	h = payload + first_hole;
+	h = payload + ctx->first_hole;
 	while (h->last_byte < start) {
 		if (!h->next_hole) {
 			/* no hole that far away */
@@ -1085,7 +1210,7 @@ static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 
 	if (!(ip_off & IP_FLAGS_MFRAG)) {
 		/* no more fragmentss: truncate this (last) hole */
-		total_len = start + len;
+		ctx->total_len = start + len;
 		h->last_byte = start + len;
 	}
 
@@ -1106,7 +1231,7 @@ static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 			done = 1;
 		} else if (!h->prev_hole) {
 			/* first hole */
-			first_hole = h->next_hole;
+			ctx->first_hole = h->next_hole;
 			payload[h->next_hole].prev_hole = 0;
 		} else if (!h->next_hole) {
 			/* last hole */
@@ -1131,7 +1256,7 @@ static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 		if (h->prev_hole)
 			payload[h->prev_hole].next_hole = (h - payload);
 		else
-			first_hole = (h - payload);
+			ctx->first_hole = (h - payload);
 
 	} else {
 		/* fragment sits in the middle: split the hole */
@@ -1149,8 +1274,10 @@ static struct ip_udp_hdr *__net_defragment(struct ip_udp_hdr *ip, int *lenp)
 	if (!done)
 		return NULL;
 
-	*lenp = total_len + IP_HDR_SIZE;
+	*lenp = ctx->total_len + IP_HDR_SIZE;
 	localip->ip_len = htons(*lenp);
+	/* The buffer stays valid until this context is used again */
+	ctx->total_len = 0;
 	return localip;
 }
 
@@ -1211,9 +1338,10 @@ static void receive_icmp(struct ip_udp_hdr *ip, int len,
 void net_process_received_packet(uchar *in_packet, int len)
 {
 	struct ethernet_hdr *et;
-	struct ip_udp_hdr *ip;
+	struct ip_udp_hdr *ip, *frag;
 	struct in_addr dst_ip;
 	struct in_addr src_ip;
+	bool csum_ok;
 	int eth_proto;
 #if defined(CONFIG_CMD_CDP)
 	int iscdp;
@@ -1358,7 +1486,8 @@ void net_process_received_packet(uchar *in_packet, int len)
 		if ((ip->ip_hl_v & 0x0f) != 0x05)
 			return;
 		/* Check the Checksum of the header */
-		if (!ip_checksum_ok((uchar *)ip, IP_HDR_SIZE)) {
+		csum_ok = eth_offload(ETH_OFFLOAD_RX_CSUM);
+		if (!csum_ok && !ip_checksum_ok((uchar *)ip, IP_HDR_SIZE)) {
 			debug("checksum bad\n");
 			return;
 		}
@@ -1366,6 +1495,10 @@ void net_process_received_packet(uchar *in_packet, int len)
 		dst_ip = net_read_ip(&ip->ip_dst);
 		if (net_ip.s_addr && dst_ip.s_addr != net_ip.s_addr &&
 		    dst_ip.s_addr != 0xFFFFFFFF) {
+#ifdef CONFIG_TFTP_MULTICAST
+			if (!net_mcast_addr.s_addr ||
+			    dst_ip.s_addr != net_mcast_addr.s_addr)
+#endif
 				return;
 		}
 		/* Read source IP address for later use */
@@ -1375,9 +1508,13 @@ void net_process_received_packet(uchar *in_packet, int len)
 		 * a fragment, and either the complete packet or NULL if
 		 * it is a fragment (if !CONFIG_IP_DEFRAG, it returns NULL)
 		 */
+		frag = ip;
 		ip = net_defragment(ip, &len);
 		if (!ip)
 			return;
+		/* The hardware only saw the fragments of a reassembled packet */
+		if (ip != frag)
+			csum_ok = false;
 		/*
 		 * watch for ICMP host redirects
 		 *
@@ -1408,7 +1545,7 @@ void net_process_received_packet(uchar *in_packet, int len)
 				   "TCP PH (to=%pI4, from=%pI4, len=%d)\n",
 				   &dst_ip, &src_ip, len);
 
-			rxhand_tcp_f((union tcp_build_pkt *)ip, len);
+			rxhand_tcp_f((union tcp_build_pkt *)ip, len, csum_ok);
 			return;
 #endif
 		} else if (ip->ip_p != IPPROTO_UDP) {	/* Only UDP packets */
@@ -1422,7 +1559,8 @@ void net_process_received_packet(uchar *in_packet, int len)
 			   "received UDP (to=%pI4, from=%pI4, len=%d)\n",
 			   &dst_ip, &src_ip, len);
 
-		if (IS_ENABLED(CONFIG_UDP_CHECKSUM) && ip->udp_xsum != 0) {
+		if (IS_ENABLED(CONFIG_UDP_CHECKSUM) && ip->udp_xsum != 0 &&
+		    !csum_ok) {
 			ulong   xsum;
 			u8 *sumptr;
 			ushort  sumlen;
@@ -1681,7 +1819,8 @@ void net_set_ip_header(uchar *pkt, struct in_addr dest, struct in_addr source,
 	/* already in network byte order */
 	net_copy_ip((void *)&ip->ip_dst, &dest);
 
-	ip->ip_sum   = compute_ip_checksum(ip, IP_HDR_SIZE);
+	if (!eth_offload(ETH_OFFLOAD_TX_CSUM))
+		ip->ip_sum = compute_ip_checksum(ip, IP_HDR_SIZE);
 }
 
 void net_set_udp_header(uchar *pkt, struct in_addr dest, int dport, int sport,
@@ -52,10 +52,29 @@
 
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
 static const ulong nfs_timeout = CONFIG_NFS_TIMEOUT;
 
+/**
+ * struct nfs_read_slot - a READ request awaiting its reply
+ *
+ * @id: RPC transaction ID of the request, 0 if this slot is free
+ * @offset: Offset in the file of the data asked for
+ * @len: Number of bytes asked for
+ * @sent: Time when the request was last sent
+ */
+struct nfs_read_slot {
+	ulong id;
+	uint offset;
+	uint len;
+	ulong sent;
+};
+
+static struct nfs_read_slot nfs_read_slots[CONFIG_NFS_READ_WINDOW];
+/* Offset of the next data to ask for */
+static uint nfs_read_next;
+/* Offset at which the file was found to end, UINT_MAX until known */
+static uint nfs_read_end;
+
 static char dirfh[NFS3_FHSIZE]; /* NFSv2 / NFSv3 file handle of directory */
 static unsigned int dirfh3_length; /* (variable) length of dirfh when NFSv3 */
 static char filefh[NFS3_FHSIZE]; /* NFSv2 / NFSv3 file handle */
@@ -425,6 +444,66 @@ static void nfs_read_req(int offset, int readlen)
 	rpc_req(PROG_NFS, NFS_READ, data, len);
 }
 
+static void nfs_read_send(struct nfs_read_slot *slot)
+{
+	nfs_read_req(slot->offset, slot->len);
+	slot->id = rpc_id;
+	slot->sent = get_timer(0);
+}
+
+/* Ask for more of the file until CONFIG_NFS_READ_WINDOW requests are out */
+static void nfs_read_fill(void)
+{
+	struct nfs_read_slot *slot;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(nfs_read_slots); i++) {
+		slot = &nfs_read_slots[i];
+		if (slot->id || nfs_read_next >= nfs_read_end)
+			continue;
+		slot->offset = nfs_read_next;
+		slot->len = NFS_READ_SIZE;
+		nfs_read_next += NFS_READ_SIZE;
+		nfs_read_send(slot);
+	}
+}
+
+/*
+ * Send again any requests whose replies have not come in time, or all of
+ * them if @all. Each is given a new ID, so a late reply to the old one is
+ * dropped.
+ */
+static void nfs_read_resend(bool all)
+{
+	struct nfs_read_slot *slot;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(nfs_read_slots); i++) {
+		slot = &nfs_read_slots[i];
+		if (slot->id && (all || get_timer(slot->sent) > nfs_timeout))
+			nfs_read_send(slot);
+	}
+}
+
+static bool nfs_read_idle(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(nfs_read_slots); i++) {
+		if (nfs_read_slots[i].id)
+			return false;
+	}
+
+	return true;
+}
+
+static void nfs_read_start(void)
+{
+	memset(nfs_read_slots, '\0', sizeof(nfs_read_slots));
+	nfs_read_next = 0;
+	nfs_read_end = UINT_MAX;
+}
+
 /**************************************************************************
 RPC request dispatcher
 **************************************************************************/
@@ -455,7 +534,8 @@ static void nfs_send(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_resend(true);
+		nfs_read_fill();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -711,20 +791,29 @@ static int nfs_readlink_reply(uchar *pkt, unsigned len)
 	return 0;
 }
 
-static int nfs_read_reply(uchar *pkt, unsigned len)
+static int nfs_read_reply(uchar *pkt, unsigned len,
+			  struct nfs_read_slot **slotp)
 {
+	struct nfs_read_slot *slot = NULL;
 	struct rpc_t rpc_pkt;
 	int rlen;
 	uchar *data_ptr;
+	ulong id;
+	int i;
 
 	debug("%s\n", __func__);
 
 	memcpy(&rpc_pkt.u.data[0], pkt, sizeof(rpc_pkt.u.reply));
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	/* Replies may come in any order, so find the request */
+	id = ntohl(rpc_pkt.u.reply.id);
+	for (i = 0; i < ARRAY_SIZE(nfs_read_slots); i++) {
+		if (nfs_read_slots[i].id == id)
+			slot = &nfs_read_slots[i];
+	}
+	if (!id || !slot)
 		return -NFS_RPC_DROP;
+	*slotp = slot;
 
 	if (rpc_pkt.u.reply.rstatus  ||
 	    rpc_pkt.u.reply.verifier ||
@@ -737,10 +826,10 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
+	if ((slot->offset != 0) && !((slot->offset) %
 			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
 		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
+	if (!(slot->offset % ((NFS_READ_SIZE / 2) * 10)))
 		putc('#');
 
 	if (choosen_nfs_version != NFS_V3) {
@@ -763,7 +852,10 @@ static int nfs_read_reply(uchar *pkt, unsigned len)
 	if (((uchar *)&(rpc_pkt.u.reply.data[0]) - (uchar *)(&rpc_pkt) + rlen) > len)
 			return -9999;
 
-	if (store_block(data_ptr, nfs_offset, rlen))
+	if (rlen > slot->len)
+		return -9999;
+
+	if (store_block(data_ptr, slot->offset, rlen))
 			return -9999;
 
 	return rlen;
@@ -789,6 +881,7 @@ static void nfs_timeout_handler(void)
 static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			unsigned src, unsigned len)
 {
+	struct nfs_read_slot *slot;
 	int rlen;
 	int reply;
 
@@ -865,8 +958,7 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			nfs_send();
 		} else {
 			nfs_state = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
+			nfs_read_start();
 			nfs_send();
 		}
 		break;
@@ -890,22 +982,39 @@ static void nfs_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		break;
 
 	case STATE_READ_REQ:
-		rlen = nfs_read_reply(pkt, len);
+		rlen = nfs_read_reply(pkt, len, &slot);
 		if (rlen == -NFS_RPC_DROP)
 			break;
 		net_set_timeout_handler(nfs_timeout, nfs_timeout_handler);
 		if (rlen > 0) {
-			nfs_offset += rlen;
+			/* Ask for the rest of a short read */
+			if (rlen < slot->len) {
+				slot->offset += rlen;
+				slot->len -= rlen;
+				nfs_read_send(slot);
+			} else {
+				slot->id = 0;
+			}
+			nfs_read_resend(false);
+			nfs_read_fill();
+		} else if (!rlen) {
+			/*
+			 * The file ends here. Wait for the replies to any
+			 * requests for data before this point.
+			 */
+			nfs_read_end = min(nfs_read_end, slot->offset);
+			slot->id = 0;
+			if (!nfs_read_idle())
+				break;
+			nfs_download_state = NETLOOP_SUCCESS;
+			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			nfs_state = STATE_READLINK_REQ;
 			nfs_send();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
-			if (rlen < 0)
-				debug("NFS READ error (%d)\n", rlen);
+			debug("NFS READ error (%d)\n", rlen);
 			nfs_state = STATE_UMOUNT_REQ;
 			nfs_send();
 		}
@@ -36,7 +36,9 @@
 #define TCP_SEND_RETRY		3
 #define TCP_SEND_TIMEOUT	2000UL
 #define TCP_RX_INACTIVE_TIMEOUT	30000UL
-#if PKTBUFSRX != 0
+#if CONFIG_PROT_TCP_RCV_WINDOW
+  #define TCP_RCV_WND_SIZE	(CONFIG_PROT_TCP_RCV_WINDOW * TCP_MSS)
+#elif PKTBUFSRX != 0
   #define TCP_RCV_WND_SIZE	(PKTBUFSRX * TCP_MSS)
 #else
   #define TCP_RCV_WND_SIZE	(4 * TCP_MSS)
@@ -45,7 +47,7 @@
 #define TCP_PACKET_OK		0
 #define TCP_PACKET_DROP		1
 
-static struct tcp_stream tcp_stream;
+static struct tcp_stream tcp_streams[CONFIG_PROT_TCP_STREAMS];
 
 static int (*tcp_stream_on_create)(struct tcp_stream *tcp);
 
@@ -172,17 +174,20 @@ static void tcp_stream_destroy(struct tcp_stream *tcp)
 void tcp_init(void)
 {
 	static int initialized;
-	struct tcp_stream *tcp = &tcp_stream;
+	struct tcp_stream *tcp;
 
 	tcp_stream_on_create = NULL;
 	if (!initialized) {
 		initialized = 1;
-		memset(tcp, 0, sizeof(struct tcp_stream));
+		memset(tcp_streams, 0, sizeof(tcp_streams));
 	}
 
-	tcp_stream_set_state(tcp, TCP_CLOSED);
-	tcp_stream_set_status(tcp, TCP_ERR_RST);
-	tcp_stream_destroy(tcp);
+	for (tcp = tcp_streams; tcp < tcp_streams + ARRAY_SIZE(tcp_streams);
+	     tcp++) {
+		tcp_stream_set_state(tcp, TCP_CLOSED);
+		tcp_stream_set_status(tcp, TCP_ERR_RST);
+		tcp_stream_destroy(tcp);
+	}
 }
 
 void tcp_stream_set_on_create_handler(int (*on_create)(struct tcp_stream *))
@@ -193,28 +198,38 @@ void tcp_stream_set_on_create_handler(int (*on_create)(struct tcp_stream *))
 static struct tcp_stream *tcp_stream_add(struct in_addr rhost,
 					 u16 rport, u16 lport)
 {
-	struct tcp_stream *tcp = &tcp_stream;
+	struct tcp_stream *tcp;
 
-	if (!tcp_stream_on_create ||
-	    tcp->state != TCP_CLOSED)
+	if (!tcp_stream_on_create)
 		return NULL;
 
-	tcp_stream_init(tcp, rhost, rport, lport);
-	if (!tcp_stream_on_create(tcp))
-		return NULL;
+	for (tcp = tcp_streams; tcp < tcp_streams + ARRAY_SIZE(tcp_streams);
+	     tcp++) {
+		if (tcp->state != TCP_CLOSED)
+			continue;
 
-	return tcp;
+		tcp_stream_init(tcp, rhost, rport, lport);
+		if (!tcp_stream_on_create(tcp))
+			return NULL;
+
+		return tcp;
+	}
+
+	return NULL;
 }
 
 struct tcp_stream *tcp_stream_get(int is_new, struct in_addr rhost,
 				  u16 rport, u16 lport)
 {
-	struct tcp_stream *tcp = &tcp_stream;
+	struct tcp_stream *tcp;
 
-	if (tcp->rhost.s_addr == rhost.s_addr &&
-	    tcp->rport == rport &&
-	    tcp->lport == lport)
-		return tcp;
+	for (tcp = tcp_streams; tcp < tcp_streams + ARRAY_SIZE(tcp_streams);
+	     tcp++) {
+		if (tcp->rhost.s_addr == rhost.s_addr &&
+		    tcp->rport == rport &&
+		    tcp->lport == lport)
+			return tcp;
+	}
 
 	return is_new ? tcp_stream_add(rhost, rport, lport) : NULL;
 }
@@ -434,8 +449,9 @@ void tcp_streams_poll(void)
 	struct tcp_stream	*tcp;
 
 	time = get_timer(0);
-	tcp = &tcp_stream;
-	tcp_stream_poll(tcp, time);
+	for (tcp = tcp_streams; tcp < tcp_streams + ARRAY_SIZE(tcp_streams);
+	     tcp++)
+		tcp_stream_poll(tcp, time);
 }
 
 /**
@@ -476,6 +492,42 @@ u16 tcp_set_pseudo_header(uchar *pkt, struct in_addr src, struct in_addr dest,
 	return compute_ip_checksum(pkt + PSEUDO_PAD_SIZE, checksum_len);
 }
 
+/**
+ * tcp_set_sack_blocks() - fill in the SACK option
+ *
+ * RFC 2018 asks for the block holding the most recently received segment to
+ * come first, since only a few blocks fit and they may be lost. The others
+ * follow in sequence order.
+ *
+ * @tcp: tcp stream
+ * @sack: SACK option to fill in
+ */
+static void tcp_set_sack_blocks(struct tcp_stream *tcp, struct tcp_sack_v *sack)
+{
+	int cnt, first, i, n = 0;
+
+	/* The caller checks that there is at least one block */
+	cnt = (tcp->lost.len - TCP_OPT_LEN_2) / TCP_OPT_LEN_8;
+	for (first = 0; first < cnt; first++) {
+		if (tcp_seq_cmp(tcp->lost.hill[first].l, tcp->sack_recent) <= 0 &&
+		    tcp_seq_cmp(tcp->sack_recent, tcp->lost.hill[first].r) < 0)
+			break;
+	}
+	if (first == cnt)
+		first = 0;
+
+	sack->hill[n].l = htonl(tcp->lost.hill[first].l);
+	sack->hill[n++].r = htonl(tcp->lost.hill[first].r);
+	for (i = 0; i < cnt && n < TCP_SACK_TX_HILLS; i++) {
+		if (i == first)
+			continue;
+		sack->hill[n].l = htonl(tcp->lost.hill[i].l);
+		sack->hill[n++].r = htonl(tcp->lost.hill[i].r);
+	}
+	sack->kind = TCP_V_SACK;
+	sack->len = TCP_OPT_LEN_2 + n * TCP_OPT_LEN_8;
+}
+
 /**
  * net_set_ack_options() - set TCP options in acknowledge packets
  * @tcp: tcp stream
@@ -498,28 +550,13 @@ int net_set_ack_options(struct tcp_stream *tcp, union tcp_build_pkt *b)
 		if (tcp->lost.len > TCP_OPT_LEN_2) {
 			debug_cond(DEBUG_DEV_PKT, "TCP ack opt lost.len %x\n",
 				   tcp->lost.len);
-			b->sack.sack_v.len = tcp->lost.len;
-			b->sack.sack_v.kind = TCP_V_SACK;
-			b->sack.sack_v.hill[0].l = htonl(tcp->lost.hill[0].l);
-			b->sack.sack_v.hill[0].r = htonl(tcp->lost.hill[0].r);
-
-			/*
-			 * These SACK structures are initialized with NOPs to
-			 * provide TCP header alignment padding. There are 4
-			 * SACK structures used for both header padding and
-			 * internally.
-			 */
-			b->sack.sack_v.hill[1].l = htonl(tcp->lost.hill[1].l);
-			b->sack.sack_v.hill[1].r = htonl(tcp->lost.hill[1].r);
-			b->sack.sack_v.hill[2].l = htonl(tcp->lost.hill[2].l);
-			b->sack.sack_v.hill[2].r = htonl(tcp->lost.hill[2].r);
-			b->sack.sack_v.hill[3].l = TCP_O_NOP;
-			b->sack.sack_v.hill[3].r = TCP_O_NOP;
+			tcp_set_sack_blocks(tcp, &b->sack.sack_v);
 		}
 
 		b->sack.hdr.tcp_hlen = SHIFT_TO_TCPHDRLEN_FIELD(ROUND_TCPHDR_LEN(TCP_HDR_SIZE +
 										 TCP_TSOPT_SIZE +
-										 tcp->lost.len));
+										 max_t(int, b->sack.sack_v.len,
+										       TCP_OPT_LEN_2)));
 	} else {
 		b->sack.sack_v.kind = 0;
 		b->sack.hdr.tcp_hlen = SHIFT_TO_TCPHDRLEN_FIELD(ROUND_TCPHDR_LEN(TCP_HDR_SIZE +
@@ -533,6 +570,38 @@ int net_set_ack_options(struct tcp_stream *tcp, union tcp_build_pkt *b)
 	return GET_TCP_HDR_LEN_IN_BYTES(b->sack.hdr.tcp_hlen);
 }
 
+/* Get the smallest window scale which lets the whole window be advertised */
+static u8 tcp_rcv_wnd_scale(void)
+{
+	u8 scale = 0;
+
+	while (scale < TCP_MAX_WIN_SCALE && (TCP_RCV_WND_SIZE >> scale) > U16_MAX)
+		scale++;
+
+	return scale;
+}
+
+/*
+ * Work out the receive window to advertise. It is limited by the space the
+ * receiver has, but does not go below one segment, so that an overflow is
+ * reported by the receiver rather than stalling the stream.
+ */
+static u16 tcp_rcv_wnd_adv(struct tcp_stream *tcp)
+{
+	u32 wnd = TCP_RCV_WND_SIZE;
+	u32 used;
+
+	if (tcp->rcv_space) {
+		used = tcp_stream_rx_offs(tcp);
+		wnd = min(wnd, max(tcp->rcv_space - min(used, tcp->rcv_space),
+				   (u32)TCP_MSS));
+	}
+	wnd = min(wnd >> tcp->loc_win_scale, (u32)U16_MAX);
+	tcp->rcv_wnd = wnd << tcp->loc_win_scale;
+
+	return wnd;
+}
+
 /**
  * net_set_syn_options() - set TCP options in SYN packets
  * @tcp: tcp stream
@@ -549,7 +618,7 @@ void net_set_syn_options(struct tcp_stream *tcp, union tcp_build_pkt *b)
 	b->ip.mss.len = TCP_OPT_LEN_4;
 	b->ip.mss.mss = htons(TCP_MSS);
 	b->ip.scale.kind = TCP_O_SCL;
-	b->ip.scale.scale = TCP_SCALE;
+	b->ip.scale.scale = tcp_rcv_wnd_scale();
 	b->ip.scale.len = TCP_OPT_LEN_3;
 	if (IS_ENABLED(CONFIG_PROT_TCP_SACK)) {
 		b->ip.sack_p.kind = TCP_P_SACK;
@@ -656,13 +725,15 @@ int tcp_set_tcp_header(struct tcp_stream *tcp, uchar *pkt, int payload_len,
 	 * it is, then the u-boot tftp or nfs kernel netboot should be
 	 * considered.
 	 */
-	b->ip.hdr.tcp_win = htons(tcp->rcv_wnd >> TCP_SCALE);
+	b->ip.hdr.tcp_win = htons(tcp_rcv_wnd_adv(tcp));
 
 	b->ip.hdr.tcp_xsum = 0;
 	b->ip.hdr.tcp_ugr = 0;
 
-	b->ip.hdr.tcp_xsum = tcp_set_pseudo_header(pkt, net_ip, tcp->rhost,
-						   tcp_len, pkt_len);
+	if (!eth_offload(ETH_OFFLOAD_TX_CSUM))
+		b->ip.hdr.tcp_xsum = tcp_set_pseudo_header(pkt, net_ip,
+							   tcp->rhost, tcp_len,
+							   pkt_len);
 
 	net_set_ip_header((uchar *)&b->ip, tcp->rhost, net_ip,
 			  pkt_len, IPPROTO_TCP);
@@ -794,8 +865,16 @@ void tcp_parse_options(struct tcp_stream *tcp, uchar *o, int o_len)
 		case TCP_V_SACK:
 			break;
 		case TCP_O_SCL:
+			/*
+			 * Scaling is only used if both SYNs have the option,
+			 * and only an active open sends it
+			 */
+			if (tcp->state != TCP_SYN_SENT)
+				break;
 			wsopt = (struct tcp_scale *)p;
-			tcp->rmt_win_scale = wsopt->scale;
+			tcp->rmt_win_scale = min_t(u8, wsopt->scale,
+						   TCP_MAX_WIN_SCALE);
+			tcp->loc_win_scale = tcp_rcv_wnd_scale();
 			break;
 		case TCP_O_TS:
 			tsopt = (struct tcp_t_opt *)p;
@@ -937,6 +1016,8 @@ static int tcp_rx_user_data(struct tcp_stream *tcp, u32 tcp_seq_num,
 	}
 
 	tmp_len = len;
+	if (tcp_seq_num != tcp->rcv_nxt)
+		tcp->sack_recent = tcp_seq_num;
 	old_offs = tcp_stream_rx_offs(tcp);
 	buf_offs = tcp_seq_num - tcp->irs - 1;
 	if (tcp->rx) {
@@ -1151,37 +1232,24 @@ void tcp_rx_state_machine(struct tcp_stream *tcp,
 	}
 }
 
-/**
- * rxhand_tcp_f() - process receiving data and call data handler.
- * @b: the packet
- * @pkt_len: the length of packet.
- */
-void rxhand_tcp_f(union tcp_build_pkt *b, unsigned int pkt_len)
+/* Check the IP header and TCP checksums of a received packet */
+static bool tcp_rx_csum_ok(union tcp_build_pkt *b, unsigned int pkt_len)
 {
 	int tcp_len = pkt_len - IP_HDR_SIZE;
 	u16 tcp_rx_xsum = b->ip.hdr.ip_sum;
-	struct tcp_stream *tcp;
-	struct in_addr src;
 
 	/* Verify IP header */
 	debug_cond(DEBUG_DEV_PKT,
 		   "TCP RX in RX Sum (to=%pI4, from=%pI4, len=%d)\n",
 		   &b->ip.hdr.ip_src, &b->ip.hdr.ip_dst, pkt_len);
 
-	/*
-	 * src IP address will be destroyed by TCP checksum verification
-	 * algorithm (see tcp_set_pseudo_header()), so remember it before
-	 * it was garbaged.
-	 */
-	src.s_addr = b->ip.hdr.ip_src.s_addr;
-
 	b->ip.hdr.ip_dst = net_ip;
 	b->ip.hdr.ip_sum = 0;
 	if (tcp_rx_xsum != compute_ip_checksum(b, IP_HDR_SIZE)) {
 		debug_cond(DEBUG_DEV_PKT,
 			   "TCP RX IP xSum Error (%pI4, =%pI4, len=%d)\n",
-			   &net_ip, &src, pkt_len);
-		return;
+			   &net_ip, &b->ip.hdr.ip_src, pkt_len);
+		return false;
 	}
 
 	/* Build pseudo header and verify TCP header */
@@ -1191,11 +1259,34 @@ void rxhand_tcp_f(union tcp_build_pkt *b, unsigned int pkt_len)
 						 b->ip.hdr.ip_dst, tcp_len,
 						 pkt_len)) {
 		debug_cond(DEBUG_DEV_PKT,
-			   "TCP RX TCP xSum Error (%pI4, %pI4, len=%d)\n",
-			   &net_ip, &src, tcp_len);
-		return;
+			   "TCP RX TCP xSum Error (%pI4, len=%d)\n",
+			   &net_ip, tcp_len);
+		return false;
 	}
 
+	return true;
+}
+
+/**
+ * rxhand_tcp_f() - process receiving data and call data handler.
+ * @b: the packet
+ * @pkt_len: the length of packet.
+ * @csum_ok: true if the hardware has already checked the checksums
+ */
+void rxhand_tcp_f(union tcp_build_pkt *b, unsigned int pkt_len, bool csum_ok)
+{
+	struct tcp_stream *tcp;
+	struct in_addr src;
+
+	/*
+	 * src IP address will be destroyed by TCP checksum verification
+	 * algorithm (see tcp_set_pseudo_header()), so remember it before
+	 * it was garbaged.
+	 */
+	src.s_addr = b->ip.hdr.ip_src.s_addr;
+	if (!csum_ok && !tcp_rx_csum_ok(b, pkt_len))
+		return;
+
 	tcp = tcp_stream_get(b->ip.hdr.tcp_flags & TCP_SYN,
 			     src,
 			     ntohs(b->ip.hdr.tcp_src),
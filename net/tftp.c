@@ -13,6 +13,7 @@
 #include <led.h>
 #include <lmb.h>
 #include <log.h>
+#include <malloc.h>
 #include <mapmem.h>
 #include <net.h>
 #include <net6.h>
@@ -95,6 +96,43 @@ static ushort	tftp_windowsize;
 static ushort	tftp_next_ack;
 /* Last nack block we send */
 static ushort	tftp_last_nack;
+/*
+ * Blocks in the window which arrived before the one expected: bit n is set
+ * if block tftp_cur_block + 1 + n has been stored
+ */
+static u64	tftp_early;
+/* Number of the short (final) block if it arrived early, else -1 */
+static int	tftp_early_final;
+#ifdef CONFIG_TFTP_ADAPTIVE_TIMEOUT
+/* Smoothed round-trip time in ms, times 8 */
+static ulong	tftp_srtt;
+/* Mean deviation of the round-trip time in ms, times 4 */
+static ulong	tftp_rttvar;
+/* Current timeout in ms, between CONFIG_TFTP_MIN_TIMEOUT and timeout_ms */
+static ulong	tftp_rto;
+/* Time when the packet being timed was sent */
+static ulong	tftp_rtt_start;
+/* true if waiting for the reply to a packet which was only sent once */
+static bool	tftp_rtt_timing;
+#endif
+#ifdef CONFIG_TFTP_MULTICAST
+/* true to ask the server to send the file by multicast */
+static bool	tftp_mcast_want;
+/* Blocks received by multicast, bit n for block n + 1 */
+static u8	*tftp_mcast_bitmap;
+/* UDP port which the group is sent to */
+static int	tftp_mcast_port;
+/* Lowest block not yet received */
+static uint	tftp_mcast_next;
+/* Number of the final (short) block, 0 if not yet received */
+static uint	tftp_mcast_final;
+/* Number of blocks received */
+static uint	tftp_mcast_count;
+/* true if the server asked this client to acknowledge blocks */
+static bool	tftp_mcast_master;
+#else
+#define tftp_mcast_want	false
+#endif
 #ifdef CONFIG_CMD_TFTPPUT
 /* 1 if writing, else 0 */
 static int	tftp_put_active;
@@ -118,6 +156,8 @@ static int	tftp_put_final_block_sent;
 #define TFTP_MTU_BLOCKSIZE6 (CONFIG_TFTP_BLOCKSIZE - 20)
 /* sequence number is 16 bit */
 #define TFTP_SEQUENCE_SIZE	((ulong)(1<<16))
+/* Number of blocks after the expected one which can be kept if early */
+#define TFTP_EARLY_MAX		64
 
 #define DEFAULT_NAME_LEN	(8 + 4 + 1)
 static char default_filename[DEFAULT_NAME_LEN];
@@ -167,8 +207,10 @@ static inline int store_block(int block, uchar *src, unsigned int len)
 		}
 	}
 
+	/* The payload may already be in place, or overlap its place */
 	ptr = map_sysmem(store_addr, len);
-	memcpy(ptr, src, len);
+	if (ptr != src)
+		memmove(ptr, src, len);
 	unmap_sysmem(ptr);
 
 	if (net_boot_file_size < newsize)
@@ -183,12 +225,173 @@ static void new_transfer(void)
 	tftp_prev_block = 0;
 	tftp_block_wrap = 0;
 	tftp_block_wrap_offset = 0;
+	tftp_early = 0;
+	tftp_early_final = -1;
 #ifdef CONFIG_CMD_TFTPPUT
 	tftp_put_final_block_sent = 0;
 #endif
 	led_activity_blink();
 }
 
+/* Get the time to wait for the server before sending again */
+static ulong tftp_timeout(void)
+{
+#ifdef CONFIG_TFTP_ADAPTIVE_TIMEOUT
+	return tftp_rto;
+#else
+	return timeout_ms;
+#endif
+}
+
+/* Start timing the reply to a packet, or stop if it is being sent again */
+static void tftp_rtt_start_timing(bool resend)
+{
+#ifdef CONFIG_TFTP_ADAPTIVE_TIMEOUT
+	tftp_rtt_start = get_timer(0);
+	tftp_rtt_timing = !resend;
+#endif
+}
+
+/*
+ * Update the timeout from the time taken to reply, as TCP does (RFC 6298).
+ * Replies to packets which were sent more than once are not used, since it
+ * is not known which one they answer.
+ */
+static void tftp_rtt_sample(void)
+{
+#ifdef CONFIG_TFTP_ADAPTIVE_TIMEOUT
+	long rtt, err;
+
+	if (!tftp_rtt_timing)
+		return;
+	tftp_rtt_timing = false;
+	rtt = get_timer(tftp_rtt_start);
+	if (!tftp_srtt) {
+		tftp_srtt = rtt * 8;
+		tftp_rttvar = rtt * 2;
+	} else {
+		err = rtt - tftp_srtt / 8;
+		tftp_srtt += err;
+		tftp_rttvar += abs(err) - tftp_rttvar / 4;
+	}
+	tftp_rto = clamp(tftp_srtt / 8 + tftp_rttvar,
+			 (ulong)CONFIG_TFTP_MIN_TIMEOUT, timeout_ms);
+#endif
+}
+
+/*
+ * Back off after a timeout. Return true if the full timeout has expired, so
+ * that the retry counts against tftptimeoutcountmax
+ */
+static bool tftp_rtt_backoff(void)
+{
+#ifdef CONFIG_TFTP_ADAPTIVE_TIMEOUT
+	if (tftp_rto < timeout_ms) {
+		tftp_rto = min(tftp_rto * 2, timeout_ms);
+		return false;
+	}
+#endif
+	return true;
+}
+
+#ifdef CONFIG_TFTP_MULTICAST
+static bool tftp_mcast_active(void)
+{
+	return net_mcast_addr.s_addr;
+}
+
+/* Check for a client which must only listen, not acknowledge */
+static bool tftp_mcast_silent(void)
+{
+	return tftp_mcast_active() && !tftp_mcast_master;
+}
+
+static bool tftp_mcast_dest(unsigned int dest)
+{
+	return tftp_mcast_active() && dest == tftp_mcast_port;
+}
+
+/* Leave the group and drop the record of blocks */
+static void tftp_mcast_stop(void)
+{
+	if (tftp_mcast_active())
+		eth_mcast_join(net_mcast_addr, 0);
+	net_mcast_addr.s_addr = 0;
+	free(tftp_mcast_bitmap);
+	tftp_mcast_bitmap = NULL;
+}
+#else
+static bool tftp_mcast_silent(void)
+{
+	return false;
+}
+
+static bool tftp_mcast_dest(unsigned int dest)
+{
+	return false;
+}
+
+static void tftp_mcast_stop(void)
+{
+}
+#endif
+
+#ifdef CONFIG_TFTP_KEEP_SERVER_ETHADDR
+/* Ethernet address of the server (or gateway) from an earlier transfer */
+static u8 tftp_server_ethaddr[ARP_HLEN];
+static struct in_addr tftp_server_ethaddr_ip;
+static struct in_addr tftp_server_ethaddr_gw;
+static bool tftp_server_ethaddr_used;
+
+/* Use the address found by an earlier transfer from the same server */
+static void tftp_ethaddr_restore(void)
+{
+	tftp_server_ethaddr_used = !(IS_ENABLED(CONFIG_IPV6) && use_ip6) &&
+		tftp_server_ethaddr_ip.s_addr &&
+		tftp_server_ethaddr_ip.s_addr == tftp_remote_ip.s_addr &&
+		tftp_server_ethaddr_gw.s_addr == net_gateway.s_addr;
+	if (tftp_server_ethaddr_used)
+		memcpy(net_server_ethaddr, tftp_server_ethaddr, ARP_HLEN);
+	else
+		memset(net_server_ethaddr, 0, ARP_HLEN);
+}
+
+/* Record the address once the server has replied */
+static void tftp_ethaddr_save(void)
+{
+	if ((IS_ENABLED(CONFIG_IPV6) && use_ip6) ||
+	    is_zero_ethaddr(net_server_ethaddr))
+		return;
+	memcpy(tftp_server_ethaddr, net_server_ethaddr, ARP_HLEN);
+	tftp_server_ethaddr_ip = tftp_remote_ip;
+	tftp_server_ethaddr_gw = net_gateway;
+}
+
+/* No reply using the recorded address, so look the server up again */
+static void tftp_ethaddr_forget(void)
+{
+	if (!tftp_server_ethaddr_used)
+		return;
+	tftp_server_ethaddr_used = false;
+	tftp_server_ethaddr_ip.s_addr = 0;
+	memset(net_server_ethaddr, 0, ARP_HLEN);
+}
+#else
+static void tftp_ethaddr_restore(void)
+{
+	/* zero out server ether in case the server ip has changed */
+	memset(net_server_ethaddr, 0, 6);
+}
+
+static void tftp_ethaddr_save(void)
+{
+}
+
+static void tftp_ethaddr_forget(void)
+{
+}
+#endif
+
 #ifdef CONFIG_CMD_TFTPPUT
 /**
  * Load the next block from memory to be sent over tftp.
@@ -277,9 +480,37 @@ static void update_block_number(void)
 	show_block_marker();
 }
 
+/*
+ * Let the driver receive the next block with its payload already in place.
+ * This needs the memory after the block to be unused, so not once blocks
+ * have arrived early, and the headers to fit before it.
+ */
+static void tftp_set_rx_direct(void)
+{
+	ulong offset;
+	int hdr_len;
+
+	if (!IS_ENABLED(CONFIG_NET_RX_DIRECT))
+		return;
+	offset = tftp_cur_block * tftp_block_size + tftp_block_wrap_offset;
+	hdr_len = net_eth_hdr_size() + 4;
+	if (IS_ENABLED(CONFIG_IPV6) && use_ip6)
+		hdr_len += IP6_HDR_SIZE + UDP_HDR_SIZE;
+	else
+		hdr_len += IP_UDP_HDR_SIZE;
+
+	if (tftp_state != STATE_DATA || tftp_early || tftp_mcast_active() ||
+	    offset < hdr_len) {
+		net_set_rx_direct(0, 0, 0);
+		return;
+	}
+	net_set_rx_direct(tftp_load_addr + offset, hdr_len, tftp_block_size);
+}
+
 /* The TFTP get or put is complete */
 static void tftp_complete(void)
 {
+	tftp_mcast_stop();
 #ifdef CONFIG_TFTP_TSIZE
 	/* Print hash marks for the last packet received */
 	while (tftp_tsize && tftp_tsize_num_hash < 49) {
@@ -357,9 +588,13 @@ static void tftp_send(void)
 		 * Implemented only for tftp get.
 		 * Don't bother sending if it's 1
 		 */
-		if (tftp_state == STATE_SEND_RRQ && tftp_window_size_option > 1)
+		if (tftp_state == STATE_SEND_RRQ && tftp_window_size_option > 1 &&
+		    !tftp_mcast_want)
 			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
 					0, tftp_window_size_option, 0);
+		/* RFC 2090 has no window, so it is one or the other */
+		if (tftp_state == STATE_SEND_RRQ && tftp_mcast_want)
+			pkt += sprintf((char *)pkt, "multicast%c%c", 0, 0);
 		len = pkt - xp;
 		break;
 
@@ -433,8 +668,12 @@ static void tftp_send(void)
 		net_send_udp_packet(net_server_ethaddr, tftp_remote_ip,
 				    tftp_remote_port, tftp_our_port, len);
 
-	if (err_pkt)
+	if (err_pkt) {
+		tftp_mcast_stop();
 		net_set_state(NETLOOP_FAIL);
+	} else {
+		tftp_rtt_start_timing(false);
+	}
 }
 
 #ifdef CONFIG_CMD_TFTPPUT
@@ -449,6 +688,170 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/**
+ * tftp_store_early() - store a block which arrived before the one expected
+ *
+ * With a window, a lost block is followed by the rest of the window. These
+ * are stored at once, so that only the lost block has to be waited for.
+ *
+ * @block: Block number from the packet
+ * @src: Data
+ * @len: Number of bytes of data
+ * Return: true if nothing more is needed, false if the expected block should
+ *	be asked for again
+ */
+static bool tftp_store_early(ushort block, uchar *src, unsigned int len)
+{
+	uint ofs = (ushort)(block - (tftp_cur_block + 1));
+
+	if (ofs >= min_t(uint, tftp_windowsize, TFTP_EARLY_MAX))
+		return false;
+	if (tftp_early & BIT_ULL(ofs))
+		return true;
+
+	/* Use the number past any wrap, for store_block() to find the offset */
+	if (store_block(tftp_cur_block + 1 + ofs, src, len)) {
+		eth_halt();
+		net_set_state(NETLOOP_FAIL);
+		return true;
+	}
+	tftp_early |= BIT_ULL(ofs);
+	tftp_set_rx_direct();
+	if (len < tftp_block_size)
+		tftp_early_final = block;
+
+	return false;
+}
+
+/**
+ * tftp_skip_early() - move past blocks which were stored early
+ *
+ * Return: true if the final block has been reached
+ */
+static bool tftp_skip_early(void)
+{
+	while (tftp_early & 1) {
+		tftp_early >>= 1;
+		tftp_cur_block = (tftp_cur_block + 1) % TFTP_SEQUENCE_SIZE;
+		update_block_number();
+		tftp_prev_block = tftp_cur_block;
+		if (tftp_cur_block == tftp_early_final)
+			return true;
+	}
+
+	return false;
+}
+
+#ifdef CONFIG_TFTP_MULTICAST
+/**
+ * tftp_mcast_option() - handle the multicast option in an OACK
+ *
+ * The value is "addr,port,mc", where mc is 1 if this client is the master,
+ * which acknowledges blocks for the whole group. The address and port are
+ * given in the first OACK and may be left empty in later ones, which the
+ * server sends to change the master.
+ *
+ * @val: Value of the option
+ * Return: 0 if OK, -ve on error
+ */
+static int tftp_mcast_option(const char *val)
+{
+	struct in_addr addr;
+	const char *p;
+	char *end;
+	int port, ret;
+
+	p = strchr(val, ',');
+	if (!p)
+		return -EINVAL;
+	if (!tftp_mcast_active()) {
+		addr = string_to_ip(val);
+		port = dectoul(p + 1, &end);
+		if ((ntohl(addr.s_addr) >> 28) != 0xe || !port || *end != ',')
+			return -EINVAL;
+		tftp_mcast_bitmap =
+			calloc(DIV_ROUND_UP(CONFIG_TFTP_MULTICAST_BLOCKS, 8), 1);
+		if (!tftp_mcast_bitmap)
+			return -ENOMEM;
+		ret = eth_mcast_join(addr, 1);
+		if (ret) {
+			printf("\nCannot join multicast group %pI4 (err=%d)\n",
+			       &addr, ret);
+			tftp_mcast_stop();
+			return ret;
+		}
+		net_mcast_addr = addr;
+		tftp_mcast_port = port;
+		tftp_mcast_next = 1;
+		tftp_mcast_final = 0;
+		tftp_mcast_count = 0;
+		new_transfer();
+	}
+	p = strchr(p + 1, ',');
+	if (!p)
+		return -EINVAL;
+	tftp_mcast_master = dectoul(p + 1, NULL) == 1;
+	debug("multicast %pI4:%d, %smaster\n", &net_mcast_addr,
+	      tftp_mcast_port, tftp_mcast_master ? "" : "not ");
+
+	return 0;
+}
+
+/**
+ * tftp_mcast_data() - handle a block received as part of a group
+ *
+ * The server sends whatever the master asks for, so blocks can arrive in any
+ * order and a client may join part-way through. Each block is stored at its
+ * place in memory and recorded. The master acknowledges the block before the
+ * lowest one it is missing, which the server then sends.
+ *
+ * @block: Block number
+ * @src: Data
+ * @len: Number of bytes of data
+ */
+static void tftp_mcast_data(uint block, uchar *src, uint len)
+{
+	u8 *bitmap = tftp_mcast_bitmap;
+
+	if (!block || (tftp_mcast_final && block > tftp_mcast_final))
+		return;
+	if (block > CONFIG_TFTP_MULTICAST_BLOCKS) {
+		puts("\nTFTP error: file too large for multicast\n");
+		eth_halt();
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	timeout_count = 0;
+	if (tftp_mcast_master)
+		tftp_rtt_sample();
+	net_set_timeout_handler(tftp_timeout(), tftp_timeout_handler);
+
+	/* Acknowledging a block already held would send it twice */
+	if (bitmap[(block - 1) / 8] & BIT((block - 1) % 8))
+		return;
+	if (store_block(block, src, len)) {
+		eth_halt();
+		net_set_state(NETLOOP_FAIL);
+		return;
+	}
+	bitmap[(block - 1) / 8] |= BIT((block - 1) % 8);
+	if (len < tftp_block_size)
+		tftp_mcast_final = block;
+	if (!(++tftp_mcast_count % 10))
+		putc('#');
+	while (tftp_mcast_next <= CONFIG_TFTP_MULTICAST_BLOCKS &&
+	       bitmap[(tftp_mcast_next - 1) / 8] &
+	       BIT((tftp_mcast_next - 1) % 8))
+		tftp_mcast_next++;
+
+	tftp_cur_block = tftp_mcast_next - 1;
+	if (tftp_mcast_master)
+		tftp_send();
+	if (tftp_mcast_final && tftp_mcast_next > tftp_mcast_final)
+		tftp_complete();
+}
+#endif
+
 static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 unsigned src, unsigned len)
 {
@@ -457,7 +860,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 	int i;
 	u16 timeout_val_rcvd;
 
-	if (dest != tftp_our_port) {
+	if (dest != tftp_our_port && !tftp_mcast_dest(dest)) {
 			return;
 	}
 	if (tftp_state != STATE_SEND_RRQ && src != tftp_remote_port &&
@@ -466,6 +869,8 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 	if (len < 2)
 		return;
+	if (tftp_state == STATE_SEND_RRQ || tftp_state == STATE_SEND_WRQ)
+		tftp_ethaddr_save();
 	len -= 2;
 	/* warning: don't use increment (++) in ntohs() macros!! */
 	s = (__be16 *)pkt;
@@ -479,6 +884,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 #ifdef CONFIG_CMD_TFTPPUT
 		if (tftp_put_active) {
 			timeout_count = 0;
+			tftp_rtt_sample();
 			if (tftp_put_final_block_sent) {
 				tftp_complete();
 			} else {
@@ -530,6 +936,21 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				debug("%c", pkt[i]);
 		}
 		debug("\n");
+#ifdef CONFIG_TFTP_MULTICAST
+		/* A later OACK is sent to change the master */
+		if (tftp_mcast_active()) {
+			for (i = 0; i + 10 < len; i++) {
+				if (!strcasecmp((char *)pkt + i, "multicast")) {
+					tftp_mcast_option((char *)pkt + i + 10);
+					break;
+				}
+			}
+			tftp_cur_block = tftp_mcast_next - 1;
+			if (tftp_mcast_master)
+				tftp_send();
+			break;
+		}
+#endif
 		tftp_state = STATE_OACK;
 		tftp_remote_port = src;
 		/*
@@ -574,9 +995,15 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 				debug("windowsize = %s, %d\n",
 				      (char *)pkt + i + 11, tftp_windowsize);
 			}
+#ifdef CONFIG_TFTP_MULTICAST
+			if (strcasecmp((char *)pkt + i, "multicast") == 0 &&
+			    tftp_mcast_option((char *)pkt + i + 10))
+				tftp_state = STATE_INVALID_OPTION;
+#endif
 		}
 
 		tftp_next_ack = tftp_windowsize;
+		tftp_rtt_sample();
 
 #ifdef CONFIG_CMD_TFTPPUT
 		if (tftp_put_active && tftp_state == STATE_OACK) {
@@ -585,13 +1012,22 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			tftp_cur_block++;
 		}
 #endif
-		tftp_send(); /* Send ACK or first data block */
+		/* Only the master acknowledges the OACK */
+		if (tftp_state != STATE_OACK || !tftp_mcast_silent())
+			tftp_send(); /* Send ACK or first data block */
 		break;
 	case TFTP_DATA:
 		if (len < 2)
 			return;
 		len -= 2;
 
+#ifdef CONFIG_TFTP_MULTICAST
+		if (tftp_mcast_active()) {
+			tftp_mcast_data(ntohs(*(__be16 *)pkt), pkt + 2, len);
+			break;
+		}
+#endif
+
 		if (ntohs(*(__be16 *)pkt) != (ushort)(tftp_cur_block + 1)) {
 			debug("Received unexpected block: %d, expected: %d\n",
 			      ntohs(*(__be16 *)pkt),
@@ -604,6 +1040,9 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			 */
 			if ((ushort)(tftp_cur_block + 1) - (short)(ntohs(*(__be16 *)pkt)) > 0)
 				break;
+			if (tftp_state == STATE_DATA &&
+			    tftp_store_early(ntohs(*(__be16 *)pkt), pkt + 2, len))
+				break;
 			/*
 			 * If one packet is dropped most likely
 			 * all other buffers in the window
@@ -652,7 +1091,8 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 		update_block_number();
 		tftp_prev_block = tftp_cur_block;
 		timeout_count_max = tftp_timeout_count_max;
-		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
+		tftp_rtt_sample();
+		net_set_timeout_handler(tftp_timeout(), tftp_timeout_handler);
 
 		if (store_block(tftp_cur_block, pkt + 2, len)) {
 			eth_halt();
@@ -660,6 +1100,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			break;
 		}
 		timeout_count = 0;
+		tftp_early >>= 1;
 
 		if (len < tftp_block_size) {
 			tftp_send();
@@ -667,6 +1108,24 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			break;
 		}
 
+		/*
+		 * Move past any blocks which arrived early. Then acknowledge at
+		 * once, so that a server resending the window after a lost
+		 * block skips those already received.
+		 */
+		if (tftp_early & 1) {
+			if (tftp_skip_early()) {
+				tftp_send();
+				tftp_complete();
+				break;
+			}
+			tftp_send();
+			tftp_next_ack = (ushort)(tftp_cur_block +
+						 tftp_windowsize);
+			tftp_set_rx_direct();
+			break;
+		}
+
 		/*
 		 *	Acknowledge the block just received, which will prompt
 		 *	the remote for the next one.
@@ -675,6 +1134,7 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 			tftp_send();
 			tftp_next_ack += tftp_windowsize;
 		}
+		tftp_set_rx_direct();
 		break;
 
 	case TFTP_ERROR:
@@ -704,13 +1164,18 @@ static void tftp_handler(uchar *pkt, unsigned dest, struct in_addr sip,
 
 static void tftp_timeout_handler(void)
 {
-	if (++timeout_count > timeout_count_max) {
+	if (tftp_rtt_backoff() && ++timeout_count > timeout_count_max) {
 		restart("Retry count exceeded");
 	} else {
 		puts("T ");
-		net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
-		if (tftp_state != STATE_RECV_WRQ)
+		net_set_timeout_handler(tftp_timeout(), tftp_timeout_handler);
+		if (tftp_state == STATE_SEND_RRQ ||
+		    tftp_state == STATE_SEND_WRQ)
+			tftp_ethaddr_forget();
+		if (tftp_state != STATE_RECV_WRQ && !tftp_mcast_silent()) {
 			tftp_send();
+			tftp_rtt_start_timing(true);
+		}
 	}
 }
 
@@ -915,6 +1380,11 @@ void tftp_start(enum proto_t protocol)
 
 	time_start = get_timer(0);
 	timeout_count_max = tftp_timeout_count_max;
+#ifdef CONFIG_TFTP_ADAPTIVE_TIMEOUT
+	tftp_srtt = 0;
+	tftp_rttvar = 0;
+	tftp_rto = timeout_ms;
+#endif
 
 	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 	net_set_udp_handler(tftp_handler);
@@ -937,8 +1407,12 @@ void tftp_start(enum proto_t protocol)
 	tftp_cur_block = 0;
 	tftp_windowsize = 1;
 	tftp_last_nack = 0;
-	/* zero out server ether in case the server ip has changed */
-	memset(net_server_ethaddr, 0, 6);
+	tftp_mcast_stop();
+#ifdef CONFIG_TFTP_MULTICAST
+	tftp_mcast_want = protocol == TFTPGET &&
+		env_get_yesno("tftpmcast") == 1;
+#endif
+	tftp_ethaddr_restore();
 	/* Revert tftp_block_size to dflt */
 	tftp_block_size = TFTP_BLOCK_SIZE;
 #ifdef CONFIG_TFTP_TSIZE
@@ -969,6 +1443,11 @@ void tftp_start_server(void)
 	timeout_count_max = tftp_timeout_count_max;
 	timeout_count = 0;
 	timeout_ms = TIMEOUT;
+#ifdef CONFIG_TFTP_ADAPTIVE_TIMEOUT
+	tftp_srtt = 0;
+	tftp_rttvar = 0;
+	tftp_rto = timeout_ms;
+#endif
 	net_set_timeout_handler(timeout_ms, tftp_timeout_handler);
 
 	/* Revert tftp_block_size to dflt */
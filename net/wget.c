@@ -16,6 +16,7 @@
 #include <net/tcp.h>
 #include <net/wget.h>
 #include <stdlib.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -28,19 +29,74 @@ DECLARE_GLOBAL_DATA_PTR;
 
 #define HTTP_STATUS_BAD		0
 #define HTTP_STATUS_OK		200
+#define HTTP_STATUS_PARTIAL	206
+
+/* Smallest part worth fetching on a connection of its own */
+#define WGET_MIN_PART		SZ_64K
+
+/* Time to wait before asking again for a part whose connection dropped */
+#define WGET_RESUME_DELAY	1000UL
+
+#define WGET_END_UNKNOWN	((ulong)-1)
 
 static const char http_proto[] = "HTTP/1.0";
 static const char http_eom[] = "\r\n\r\n";
 static const char content_len[] = "Content-Length:";
+static const char accept_ranges[] = "Accept-Ranges: bytes";
 static const char linefeed[] = "\r\n";
 static struct in_addr web_server_ip;
 static unsigned int server_port;
 static unsigned long content_length;
-static u32 http_hdr_size, max_rx_pos;
 static int wget_tsize_num_hash;
 
 static char *image_url;
-static enum net_loop_state wget_loop_state;
+
+enum wget_conn_state {
+	WGET_CONN_UNUSED,
+	WGET_CONN_WAITING,
+	WGET_CONN_BUSY,
+	WGET_CONN_DONE,
+};
+
+/**
+ * struct wget_conn - a connection fetching one part of the file
+ *
+ * @tcp: TCP stream, while @state is WGET_CONN_BUSY
+ * @state: Progress of this part
+ * @start: Offset in the file of the first byte of the current request
+ * @next: Offset of the next byte needed; all before it have been stored
+ * @end: Offset just past the end of this part, or WGET_END_UNKNOWN
+ * @resumes: Number of times this part has been asked for again
+ * @excess: true if the server sends past @end, so the connection must be
+ *	reset once the part is complete
+ * @hdr_size: Size of the HTTP header of the response, 0 until received
+ * @hdr_len: Number of bytes held in @hdr
+ * @hdr: Start of the response, held here until the header is complete
+ */
+struct wget_conn {
+	struct tcp_stream *tcp;
+	enum wget_conn_state state;
+	ulong start;
+	ulong next;
+	ulong end;
+	int resumes;
+	bool excess;
+	u32 hdr_size;
+	u32 hdr_len;
+	char hdr[HTTP_MAX_HDR_LEN + 1];
+};
+
+static struct wget_conn wget_conns[CONFIG_WGET_CONNECTIONS];
+/* Connection being opened, for tcp_stream_on_create() to claim */
+static struct wget_conn *wget_connecting;
+/* true if the server accepts Range requests */
+static bool wget_ranges;
+/* true once the transfer has succeeded or failed */
+static bool wget_finished;
+/* Bytes of the file stored so far, by all connections */
+static ulong wget_rx_bytes;
+/* Packets received on connections which have closed */
+static u32 wget_rx_packets;
 
 /**
  * store_block() - store block in memory
@@ -90,13 +146,19 @@ static void show_block_marker(u32 packets)
 	}
 }
 
-static void tcp_stream_on_closed(struct tcp_stream *tcp)
+static void wget_finish(bool ok, enum tcp_status status)
 {
-	if (tcp->status != TCP_ERR_OK)
-		wget_loop_state = NETLOOP_FAIL;
+	struct wget_conn *conn;
 
-	net_set_state(wget_loop_state);
-	if (wget_loop_state != NETLOOP_SUCCESS) {
+	wget_finished = true;
+	for (conn = wget_conns; conn < wget_conns + ARRAY_SIZE(wget_conns);
+	     conn++) {
+		if (conn->state == WGET_CONN_BUSY && conn->tcp)
+			tcp_stream_reset(conn->tcp);
+	}
+
+	if (!ok) {
+		net_set_state(NETLOOP_FAIL);
 		net_boot_file_size = 0;
 		if (wget_info->status_code == HTTP_STATUS_OK) {
 			wget_info->status_code = HTTP_STATUS_BAD;
@@ -104,11 +166,14 @@ static void tcp_stream_on_closed(struct tcp_stream *tcp)
 			if (wget_info->headers)
 				wget_info->headers[0] = 0;
 		}
-		printf("\nwget: Transfer Fail, TCP status - %d\n", tcp->status);
+		printf("\nwget: Transfer Fail, TCP status - %d\n", status);
 		return;
 	}
 
-	printf("\nPackets received %d, Transfer Successful\n", tcp->rx_packets);
+	net_set_state(NETLOOP_SUCCESS);
+	net_boot_file_size = wget_rx_bytes;
+	printf("\nPackets received %d, Transfer Successful\n",
+	       wget_rx_packets);
 	wget_info->file_size = net_boot_file_size;
 	if (wget_info->method == WGET_HTTP_METHOD_GET && wget_info->set_bootdev) {
 		efi_set_bootdev("Http", NULL, image_url,
@@ -118,86 +183,221 @@ static void tcp_stream_on_closed(struct tcp_stream *tcp)
 	}
 }
 
-static void tcp_stream_on_rcv_nxt_update(struct tcp_stream *tcp, u32 rx_bytes)
+static void wget_connect_handler(void);
+
+static int wget_connect(struct wget_conn *conn)
+{
+	wget_connecting = conn;
+	conn->tcp = tcp_stream_connect(web_server_ip, server_port);
+	wget_connecting = NULL;
+	if (!conn->tcp)
+		return -ENOSPC;
+	conn->state = WGET_CONN_BUSY;
+	conn->hdr_size = 0;
+	conn->hdr_len = 0;
+	tcp_stream_put(conn->tcp);
+
+	return 0;
+}
+
+/* Open connections for the parts which are waiting for one */
+static void wget_connect_handler(void)
+{
+	struct wget_conn *conn;
+
+	if (wget_finished)
+		return;
+	for (conn = wget_conns; conn < wget_conns + ARRAY_SIZE(wget_conns);
+	     conn++) {
+		if (conn->state != WGET_CONN_WAITING)
+			continue;
+		if (wget_connect(conn)) {
+			/* try again once another connection has closed */
+			net_set_timeout_handler(WGET_RESUME_DELAY,
+						wget_connect_handler);
+			return;
+		}
+	}
+}
+
+/*
+ * Split the rest of the file between the connections, once the first
+ * response shows the size of the file and that ranges are accepted
+ */
+static void wget_split(struct wget_conn *first, ulong total)
 {
-	char	*pos, *tail;
-	uchar	saved, *ptr;
-	int	reply_len;
+	int count = ARRAY_SIZE(wget_conns);
+	ulong part;
+	int i;
 
-	if (http_hdr_size) {
-		net_boot_file_size = rx_bytes - http_hdr_size;
-		show_block_marker(tcp->rx_packets);
+	first->end = total;
+	if (count < 2 || !wget_ranges || wget_info->method != WGET_HTTP_METHOD_GET)
+		return;
+	count = min_t(ulong, count, total / WGET_MIN_PART);
+	if (count < 2)
 		return;
+
+	part = ALIGN(DIV_ROUND_UP(total, count), SZ_4K);
+	first->end = part;
+	first->excess = true;
+	for (i = 1; i < count && i * part < total; i++) {
+		struct wget_conn *conn = &wget_conns[i];
+
+		conn->start = i * part;
+		conn->next = conn->start;
+		conn->end = min(total, (i + 1) * part);
+		conn->state = WGET_CONN_WAITING;
 	}
+	debug_cond(DEBUG_WGET, "wget: %d parts of %lx bytes\n", i, part);
+	net_set_timeout_handler(0, wget_connect_handler);
+}
+
+/* Check whether all parts are complete */
+static void wget_check_done(void)
+{
+	struct wget_conn *conn;
+
+	for (conn = wget_conns; conn < wget_conns + ARRAY_SIZE(wget_conns);
+	     conn++) {
+		if (conn->state == WGET_CONN_WAITING ||
+		    conn->state == WGET_CONN_BUSY)
+			return;
+	}
+	wget_finish(true, TCP_ERR_OK);
+}
 
-	ptr = map_sysmem(image_load_addr, rx_bytes + 1);
+static void tcp_stream_on_closed(struct tcp_stream *tcp)
+{
+	struct wget_conn *conn = tcp->priv;
+
+	if (wget_finished || !conn || conn->tcp != tcp)
+		return;
+	conn->tcp = NULL;
+	wget_rx_packets += tcp->rx_packets;
+
+	/* Without a size, the file ends where the server closes it */
+	if (conn->hdr_size && tcp->status == TCP_ERR_OK &&
+	    conn->end == WGET_END_UNKNOWN)
+		conn->end = conn->next;
+
+	if (conn->hdr_size && conn->next >= conn->end) {
+		conn->state = WGET_CONN_DONE;
+		wget_check_done();
+		return;
+	}
+
+	/* Ask again for the rest, if the server allows it */
+	if (conn->state == WGET_CONN_BUSY && wget_ranges &&
+	    conn->end != WGET_END_UNKNOWN &&
+	    conn->resumes < WGET_MAX_RESUMES) {
+		printf("\nwget: connection lost, resuming at %#lx\n",
+		       conn->next);
+		conn->resumes++;
+		conn->start = conn->next;
+		conn->excess = false;
+		conn->state = WGET_CONN_WAITING;
+		net_set_timeout_handler(WGET_RESUME_DELAY,
+					wget_connect_handler);
+		return;
+	}
+
+	wget_finish(false, tcp->status == TCP_ERR_OK ? TCP_ERR_RST :
+		    tcp->status);
+}
+
+/* Copy any of the body which arrived with the header into place */
+static int wget_store_hdr_body(struct wget_conn *conn)
+{
+	ulong len;
+
+	if (conn->hdr_len <= conn->hdr_size || conn->start >= conn->end)
+		return 0;
+	len = min_t(ulong, conn->hdr_len - conn->hdr_size,
+		    conn->end - conn->start);
+
+	return store_block((uchar *)conn->hdr + conn->hdr_size, conn->start,
+			   len);
+}
+
+/*
+ * Check the header of a response. Return false, having closed the
+ * connection, if it is not usable
+ */
+static bool wget_parse_hdr(struct wget_conn *conn, struct tcp_stream *tcp,
+			   u32 rx_bytes)
+{
+	bool first = conn == wget_conns && !conn->start;
+	char *ptr = conn->hdr;
+	char *pos, *tail, saved;
+	int reply_len;
+	u32 status;
 
 	saved = ptr[rx_bytes];
 	ptr[rx_bytes] = '\0';
-	pos = strstr((char *)ptr, http_eom);
+	pos = strstr(ptr, http_eom);
 	ptr[rx_bytes] = saved;
-
 	if (!pos) {
 		if (rx_bytes < HTTP_MAX_HDR_LEN &&
 		    tcp->state == TCP_ESTABLISHED)
-			goto end;
+			return false;
 
 		printf("ERROR: misssed HTTP header\n");
-		tcp_stream_close(tcp);
-		goto end;
+		goto bad;
 	}
 
-	http_hdr_size = pos - (char *)ptr + strlen(http_eom);
+	conn->hdr_size = pos - ptr + strlen(http_eom);
 	*pos = '\0';
 
-	if (wget_info->headers && http_hdr_size < MAX_HTTP_HEADERS_SIZE)
+	if (first && wget_info->headers &&
+	    conn->hdr_size < MAX_HTTP_HEADERS_SIZE)
 		strcpy(wget_info->headers, ptr);
 
 	/* check for HTTP proto */
-	if (strncasecmp((char *)ptr, "HTTP/", 5)) {
+	if (strncasecmp(ptr, "HTTP/", 5)) {
 		debug_cond(DEBUG_WGET, "wget: Connected Bad Xfer "
 				       "(no HTTP Status Line found)\n");
-		tcp_stream_close(tcp);
-		goto end;
+		goto bad;
 	}
 
 	/* get HTTP reply len */
-	pos = strstr((char *)ptr, linefeed);
+	pos = strstr(ptr, linefeed);
 	if (pos)
-		reply_len = pos - (char *)ptr;
+		reply_len = pos - ptr;
 	else
-		reply_len = http_hdr_size - strlen(http_eom);
+		reply_len = conn->hdr_size - strlen(http_eom);
 
-	pos = strchr((char *)ptr, ' ');
-	if (!pos || pos - (char *)ptr > reply_len) {
+	pos = strchr(ptr, ' ');
+	if (!pos || pos - ptr > reply_len) {
 		debug_cond(DEBUG_WGET, "wget: Connected Bad Xfer "
 				       "(no HTTP Status Code found)\n");
-		tcp_stream_close(tcp);
-		goto end;
+		goto bad;
 	}
 
-	wget_info->status_code = (u32)simple_strtoul(pos + 1, &tail, 10);
+	status = (u32)simple_strtoul(pos + 1, &tail, 10);
 	if (tail == pos + 1 || *tail != ' ') {
 		debug_cond(DEBUG_WGET, "wget: Connected Bad Xfer "
 				       "(bad HTTP Status Code)\n");
-		tcp_stream_close(tcp);
-		goto end;
+		goto bad;
 	}
 
-	debug_cond(DEBUG_WGET,
-		   "wget: HTTP Status Code %d\n", wget_info->status_code);
+	debug_cond(DEBUG_WGET, "wget: HTTP Status Code %d\n", status);
 
-	if (wget_info->status_code != HTTP_STATUS_OK) {
+	/* A range must come back as one, not as the whole file */
+	if (first)
+		wget_info->status_code = status;
+	if (status != (first ? HTTP_STATUS_OK : HTTP_STATUS_PARTIAL)) {
 		debug_cond(DEBUG_WGET, "wget: Connected Bad Xfer\n");
-		tcp_stream_close(tcp);
-		goto end;
+		goto bad;
 	}
 
 	debug_cond(DEBUG_WGET, "wget: Connctd pkt %p  hlen %x\n",
-		   ptr, http_hdr_size);
+		   ptr, conn->hdr_size);
+
+	if (!first)
+		return true;
 
 	content_length = -1;
-	pos = strstr((char *)ptr, content_len);
+	pos = strstr(ptr, content_len);
 	if (pos) {
 		pos += strlen(content_len) + 1;
 		while (*pos == ' ')
@@ -206,6 +406,7 @@ static void tcp_stream_on_rcv_nxt_update(struct tcp_stream *tcp, u32 rx_bytes)
 		if (*tail != '\r' && *tail != '\n' && *tail != '\0')
 			content_length = -1;
 	}
+	wget_ranges = strstr(ptr, accept_ranges);
 
 	if (content_length >= 0) {
 		debug_cond(DEBUG_WGET,
@@ -213,29 +414,88 @@ static void tcp_stream_on_rcv_nxt_update(struct tcp_stream *tcp, u32 rx_bytes)
 			   content_length);
 		wget_info->hdr_cont_len = content_length;
 	}
+	if (wget_info->method == WGET_HTTP_METHOD_HEAD)
+		conn->end = 0;
+	else if (content_length != -1)
+		wget_split(conn, content_length);
 
-	net_boot_file_size = rx_bytes - http_hdr_size;
-	memmove(ptr, ptr + http_hdr_size, max_rx_pos + 1 - http_hdr_size);
-	wget_loop_state = NETLOOP_SUCCESS;
+	return true;
 
-end:
-	unmap_sysmem(ptr);
+bad:
+	/* Do not ask again, since the server would answer the same */
+	conn->state = WGET_CONN_DONE;
+	conn->hdr_size = 0;
+	tcp_stream_close(tcp);
+
+	return false;
+}
+
+static void tcp_stream_on_rcv_nxt_update(struct tcp_stream *tcp, u32 rx_bytes)
+{
+	struct wget_conn *conn = tcp->priv;
+	ulong next;
+
+	if (!conn->hdr_size) {
+		if (!wget_parse_hdr(conn, tcp, rx_bytes))
+			return;
+		if (wget_store_hdr_body(conn)) {
+			tcp_stream_reset(tcp);
+			return;
+		}
+	}
+
+	next = min(conn->start + rx_bytes - conn->hdr_size, conn->end);
+	if (next > conn->next) {
+		wget_rx_bytes += next - conn->next;
+		conn->next = next;
+	}
+	net_boot_file_size = wget_rx_bytes;
+	show_block_marker(wget_rx_packets + tcp->rx_packets);
+
+	/* Stop the server sending the part fetched by the next connection */
+	if (conn->excess && conn->next >= conn->end)
+		tcp_stream_reset(tcp);
 }
 
 static int tcp_stream_rx(struct tcp_stream *tcp, u32 rx_offs, void *buf, int len)
 {
-	if ((max_rx_pos == (u32)(-1)) || (max_rx_pos < rx_offs + len - 1))
-		max_rx_pos = rx_offs + len - 1;
+	struct wget_conn *conn = tcp->priv;
+	ulong pos;
+	int skip;
+
+	/* Keep the start of the response until the header is complete */
+	if (!conn->hdr_size) {
+		if (rx_offs >= HTTP_MAX_HDR_LEN)
+			return 0;
+		len = min_t(int, len, HTTP_MAX_HDR_LEN - rx_offs);
+		memcpy(conn->hdr + rx_offs, buf, len);
+		conn->hdr_len = max(conn->hdr_len, rx_offs + len);
+
+		return len;
+	}
 
-	store_block(buf, rx_offs - http_hdr_size, len);
+	skip = rx_offs < conn->hdr_size ? conn->hdr_size - rx_offs : 0;
+	if (skip >= len)
+		return len;
+	pos = conn->start + rx_offs + skip - conn->hdr_size;
+	if (pos >= conn->end)
+		return len;
+	if (store_block(buf + skip, pos, min_t(ulong, len - skip,
+					       conn->end - pos))) {
+		/* Asking again would not help */
+		conn->state = WGET_CONN_DONE;
+		return -EIO;
+	}
 
 	return len;
 }
 
 static int tcp_stream_tx(struct tcp_stream *tcp, u32 tx_offs, void *buf, int maxlen)
 {
-	int ret;
+	struct wget_conn *conn = tcp->priv;
+	char range[48] = "";
 	const char *method;
+	int ret;
 
 	if (tx_offs)
 		return 0;
@@ -250,8 +510,12 @@ static int tcp_stream_tx(struct tcp_stream *tcp, u32 tx_offs, void *buf, int max
 		break;
 	}
 
-	ret = snprintf(buf, maxlen, "%s %s %s\r\n\r\n",
-		       method, image_url, http_proto);
+	if (conn->start && conn->end != WGET_END_UNKNOWN)
+		snprintf(range, sizeof(range), "Range: bytes=%lu-%lu\r\n",
+			 conn->start, conn->end - 1);
+
+	ret = snprintf(buf, maxlen, "%s %s %s\r\n%s\r\n",
+		       method, image_url, http_proto, range);
 
 	return ret;
 }
@@ -259,15 +523,19 @@ static int tcp_stream_tx(struct tcp_stream *tcp, u32 tx_offs, void *buf, int max
 static int tcp_stream_on_create(struct tcp_stream *tcp)
 {
 	if (tcp->rhost.s_addr != web_server_ip.s_addr ||
-	    tcp->rport != server_port)
+	    tcp->rport != server_port || !wget_connecting)
 		return 0;
 
+	tcp->priv = wget_connecting;
 	tcp->max_retry_count = WGET_RETRY_COUNT;
 	tcp->initial_timeout = WGET_TIMEOUT;
 	tcp->on_closed = tcp_stream_on_closed;
 	tcp->on_rcv_nxt_update = tcp_stream_on_rcv_nxt_update;
 	tcp->rx = tcp_stream_rx;
 	tcp->tx = tcp_stream_tx;
+	if (CONFIG_IS_ENABLED(LMB) && wget_info->set_bootdev)
+		tcp->rcv_space = min_t(phys_size_t, U32_MAX,
+				       lmb_get_free_size(image_load_addr));
 
 	return 1;
 }
@@ -276,7 +544,7 @@ static int tcp_stream_on_create(struct tcp_stream *tcp)
 
 void wget_start(void)
 {
-	struct tcp_stream *tcp;
+	struct wget_conn *conn = wget_conns;
 
 	if (!wget_info)
 		wget_info = &default_wget_info;
@@ -326,11 +594,14 @@ void wget_start(void)
 
 	memset(net_server_ethaddr, 0, 6);
 
-	max_rx_pos = (u32)(-1);
 	net_boot_file_size = 0;
-	http_hdr_size = 0;
+	content_length = -1;
 	wget_tsize_num_hash = 0;
-	wget_loop_state = NETLOOP_FAIL;
+	memset(wget_conns, '\0', sizeof(wget_conns));
+	wget_ranges = false;
+	wget_finished = false;
+	wget_rx_bytes = 0;
+	wget_rx_packets = 0;
 
 	wget_info->status_code = HTTP_STATUS_BAD;
 	wget_info->file_size = 0;
@@ -340,13 +611,12 @@ void wget_start(void)
 
 	server_port = env_get_ulong("httpdstp", 10, SERVER_PORT) & 0xffff;
 	tcp_stream_set_on_create_handler(tcp_stream_on_create);
-	tcp = tcp_stream_connect(web_server_ip, server_port);
-	if (!tcp) {
+	conn->end = WGET_END_UNKNOWN;
+	if (wget_connect(conn)) {
 		printf("No free tcp streams\n");
 		net_set_state(NETLOOP_FAIL);
 		return;
 	}
-	tcp_stream_put(tcp);
 }
 
 int wget_do_request(ulong dst_addr, char *uri)
@@ -650,24 +650,37 @@ static int overlay_merge(void *fdt, void *fdto)
 
 static int get_path_len(const void *fdt, int nodeoffset)
 {
-	int len = 0, namelen;
-	const char *name;
+	int offset = 0, len = 0, namelen, node, next;
 
 	FDT_RO_PROBE(fdt);
 
-	for (;;) {
-		name = fdt_get_name(fdt, nodeoffset, &namelen);
-		if (!name)
-			return namelen;
-
-		/* root? we're done */
-		if (namelen == 0)
-			break;
+	if (!fdt_get_name(fdt, nodeoffset, &namelen))
+		return namelen;
 
-		nodeoffset = fdt_parent_offset(fdt, nodeoffset);
-		if (nodeoffset < 0)
-			return nodeoffset;
+	/*
+	 * Walk down from the root, skipping the subtrees which don't contain
+	 * the node, rather than looking up each parent in turn, which would
+	 * walk the tree from the root each time
+	 */
+	while (offset != nodeoffset) {
+		node = fdt_first_subnode(fdt, offset);
+		for (;;) {
+			if (node < 0)
+				return node == -FDT_ERR_NOTFOUND ?
+					-FDT_ERR_BADOFFSET : node;
+			next = fdt_next_subnode(fdt, node);
+			if (next == -FDT_ERR_NOTFOUND || next > nodeoffset)
+				break;
+			if (next < 0)
+				return next;
+			node = next;
+		}
+		if (node > nodeoffset)
+			return -FDT_ERR_BADOFFSET;
+		if (!fdt_get_name(fdt, node, &namelen))
+			return namelen;
 		len += namelen + 1;
+		offset = node;
 	}
 
 	/* in case of root pretend it's "/" */
@@ -695,7 +708,8 @@ static int get_path_len(const void *fdt, int nodeoffset)
 static int overlay_symbol_update(void *fdt, void *fdto)
 {
 	int root_sym, ov_sym, prop, path_len, fragment, target;
-	int len, frag_name_len, ret, rel_path_len;
+	int len, frag_name_len, ret, rel_path_len, struct_size;
+	int last_fragment = -1, target_len;
 	const char *s, *e;
 	const char *path;
 	const char *name;
@@ -778,34 +792,43 @@ static int overlay_symbol_update(void *fdt, void *fdto)
 		if (ret < 0)
 			return -FDT_ERR_BADOVERLAY;
 
-		/* get the target of the fragment */
-		ret = overlay_get_target(fdt, fdto, fragment, &target_path);
-		if (ret < 0)
-			return ret;
-		target = ret;
-
-		/* if we have a target path use */
-		if (!target_path) {
-			ret = get_path_len(fdt, target);
+		/*
+		 * get the target of the fragment, unless it is the same as
+		 * for the previous symbol: looking it up by phandle and
+		 * working out its path both walk the base tree
+		 */
+		if (fragment != last_fragment) {
+			ret = overlay_get_target(fdt, fdto, fragment,
+						 &target_path);
 			if (ret < 0)
 				return ret;
-			len = ret;
-		} else {
-			len = strlen(target_path);
+			target = ret;
+
+			/* if we have a target path use */
+			if (!target_path) {
+				ret = get_path_len(fdt, target);
+				if (ret < 0)
+					return ret;
+				target_len = ret;
+			} else {
+				target_len = strlen(target_path);
+			}
+			last_fragment = fragment;
 		}
+		len = target_len;
 
+		struct_size = fdt_size_dt_struct(fdt);
 		ret = fdt_setprop_placeholder(fdt, root_sym, name,
 				len + (len > 1) + rel_path_len, &p);
 		if (ret < 0)
 			return ret;
 
-		if (!target_path) {
-			/* again in case setprop_placeholder changed it */
-			ret = overlay_get_target(fdt, fdto, fragment, &target_path);
-			if (ret < 0)
-				return ret;
-			target = ret;
-		}
+		/*
+		 * setprop_placeholder moves everything after the properties
+		 * of root_sym, including the target if it comes later
+		 */
+		if (target > root_sym)
+			target += fdt_size_dt_struct(fdt) - struct_size;
 
 		buf = p;
 		if (len > 1) { /* target is not root */
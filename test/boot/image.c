@@ -7,10 +7,15 @@
  */
 
 #include <image.h>
+#include <asm/global_data.h>
+#include <linux/libfdt.h>
 #include <test/suites.h>
 #include <test/ut.h>
+#include <u-boot/sha256.h>
 #include "bootstd_common.h"
 
+DECLARE_GLOBAL_DATA_PTR;
+
 /* Test of image phase */
 static int test_image_phase(struct unit_test_state *uts)
 {
@@ -33,3 +38,51 @@ static int test_image_phase(struct unit_test_state *uts)
 	return 0;
 }
 BOOTSTD_TEST(test_image_phase, 0);
+
+/* Test that a record of a checked image is used once in place of its hash */
+static int test_image_fit_verified(struct unit_test_state *uts)
+{
+	static const char data[] = "kernel image";
+	u8 value[SHA256_SUM_LEN];
+	char fit[1024], bad[sizeof(data)];
+	const void *keys = gd->fdt_blob;
+	int node, images;
+
+	if (!IS_ENABLED(CONFIG_FIT_VERIFIED_HANDOFF))
+		return -EAGAIN;
+
+	sha256_csum_wd((const u8 *)data, sizeof(data), value, CHUNKSZ_SHA256);
+	ut_assertok(fdt_create_empty_tree(fit, sizeof(fit)));
+	images = fdt_add_subnode(fit, 0, FIT_IMAGES_PATH + 1);
+	ut_assert(images >= 0);
+	node = fdt_add_subnode(fit, images, "kernel");
+	ut_assert(node >= 0);
+	ut_assert(fdt_add_subnode(fit, node, "hash-1") >= 0);
+	ut_assertok(fdt_setprop_string(fit, fdt_first_subnode(fit, node),
+				       FIT_ALGO_PROP, "sha256"));
+	ut_assertok(fdt_setprop(fit, fdt_first_subnode(fit, node),
+				FIT_VALUE_PROP, value, sizeof(value)));
+	node = fdt_subnode_offset(fit, images, "kernel");
+
+	ut_asserteq(1, fit_image_verify_with_data(fit, node, keys, data,
+						  sizeof(data)));
+
+	/* a changed image fails, unless there is a record for it */
+	memcpy(bad, data, sizeof(data));
+	bad[0] = 'K';
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, keys, bad,
+						  sizeof(bad)));
+	ut_assertok(fit_verified_add(bad, sizeof(bad), "sha256", value,
+				     sizeof(value)));
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, keys, bad,
+						  sizeof(bad) - 1));
+	ut_asserteq(1, fit_image_verify_with_data(fit, node, keys, bad,
+						  sizeof(bad)));
+
+	/* the record has been used up */
+	ut_asserteq(0, fit_image_verify_with_data(fit, node, keys, bad,
+						  sizeof(bad)));
+
+	return 0;
+}
+BOOTSTD_TEST(test_image_fit_verified, 0);
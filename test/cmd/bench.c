@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for bench command
+ */
+
+#include <command.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+static int dm_test_cmd_bench(struct unit_test_state *uts)
+{
+	ut_assertok(run_command("bench blk read mmc 0 1000000 0 10", 0));
+	ut_assert_nextlinen("blk read: 8192 bytes in ");
+	ut_assert_console_end();
+
+	ut_assertok(run_command("bench blk rread mmc 0 1000000 0 10", 0));
+	ut_assert_nextlinen("blk random read: 8192 bytes in ");
+	ut_assert_console_end();
+
+	ut_assertok(run_command("bench memcpy 1000000 1100000 1000", 0));
+	ut_assert_nextlinen("memcpy: 4096 bytes in ");
+	ut_assert_console_end();
+
+	ut_assertok(run_command("bench hash sha256 1000000 1000", 0));
+	ut_assert_nextlinen("sha256: 4096 bytes in ");
+	ut_assert_console_end();
+
+	ut_asserteq(1, run_command("bench hash fred 1000000 1000", 0));
+	ut_assert_nextline("Unknown hash algorithm 'fred'");
+	ut_assert_console_end();
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_bench, UTF_SCAN_FDT | UTF_CONSOLE);
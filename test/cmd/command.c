@@ -106,3 +106,28 @@ static int command_test(struct unit_test_state *uts)
 	return 0;
 }
 CMD_TEST(command_test, 0);
+
+static int command_find_test(struct unit_test_state *uts)
+{
+	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
+	const int count = ll_entry_count(struct cmd_tbl, cmd);
+	char name[40];
+	int i, len;
+
+	/* find_cmd() must agree with a linear search, abbreviations too */
+	for (i = 0; i < count; i++) {
+		strlcpy(name, start[i].name, sizeof(name));
+		for (len = strlen(name); len > 0; len--) {
+			name[len] = '\0';
+			ut_asserteq_ptr(find_cmd_tbl(name, start, count),
+					find_cmd(name));
+		}
+	}
+	ut_asserteq_ptr(find_cmd_tbl("echo.b", start, count),
+			find_cmd("echo.b"));
+	ut_assertnull(find_cmd("no-such-command"));
+	ut_assertnonnull(find_cmd("?"));
+
+	return 0;
+}
+CMD_TEST(command_find_test, 0);
@@ -7,6 +7,7 @@
 
 #include <console.h>
 #include <fdt_support.h>
+#include <fdtdec.h>
 #include <mapmem.h>
 #include <asm/global_data.h>
 #include <linux/libfdt.h>
@@ -312,6 +313,80 @@ static int fdt_test_resize(struct unit_test_state *uts)
 }
 FDT_TEST(fdt_test_resize, UTF_CONSOLE);
 
+/* Test a batch of property changes */
+static int fdt_test_batch(struct unit_test_state *uts)
+{
+	char fdt[4096], orig[4096];
+	int node, subnode, root;
+	ulong addr;
+
+	ut_assertok(make_fuller_fdt(uts, fdt, sizeof(fdt), &addr));
+	ut_assertok(fdt_open_into(fdt, fdt, sizeof(fdt)));
+	memcpy(orig, fdt, sizeof(fdt));
+
+	ut_assertok(fdt_batch_start(fdt));
+	ut_asserteq(-FDT_ERR_BADSTATE, fdt_batch_start(fdt));
+
+	/* Change existing properties, growing one and shrinking another */
+	do_fixup_by_path(fdt, "/", "model", "U-Boot FDT batch test", 22, 0);
+	do_fixup_by_compat_u32(fdt, "u-boot,fdt-test-device1",
+			       "clock-frequency", 1000, 0);
+	do_fixup_by_compat(fdt, "u-boot,fdt-test-device1", "compatible",
+			   "short", 6, 0);
+
+	/* Add properties, the second change to status winning */
+	do_fixup_by_path(fdt, "/test-node@1234", "status", "disabled", 9, 1);
+	do_fixup_by_path(fdt, "/test-node@1234", "status", "okay", 5, 1);
+	do_fixup_by_compat(fdt, "u-boot,fdt-subnode-test-device", "status",
+			   "fail", 5, 1);
+
+	/* Properties which do not exist and are not to be created */
+	do_fixup_by_path_u32(fdt, "/", "missing", 1, 0);
+	do_fixup_by_path_u32(fdt, "/test-node@1234", "missing", 1, 0);
+
+	/* A property added in this batch is updated even with create == 0 */
+	do_fixup_by_path_u32(fdt, "/", "added", 1, 1);
+	do_fixup_by_path_u32(fdt, "/", "added", 2, 0);
+
+	/* Nothing is written until the end of the batch */
+	ut_assertok(memcmp(orig, fdt, sizeof(fdt)));
+	ut_assertok(fdt_batch_finish(fdt));
+	ut_asserteq(-FDT_ERR_BADSTATE, fdt_batch_finish(fdt));
+
+	root = fdt_path_offset(fdt, "/");
+	node = fdt_path_offset(fdt, "/test-node@1234");
+	subnode = fdt_path_offset(fdt, "/test-node@1234/subnode");
+	ut_assert(node >= 0);
+	ut_assert(subnode >= 0);
+	ut_asserteq_str("U-Boot FDT batch test",
+			fdt_getprop(fdt, root, "model", NULL));
+	ut_asserteq(2, fdtdec_get_int(fdt, root, "added", 0));
+	ut_assertnull(fdt_getprop(fdt, root, "missing", NULL));
+	ut_asserteq(1000, fdtdec_get_int(fdt, node, "clock-frequency", 0));
+	ut_asserteq_str("short", fdt_getprop(fdt, node, "compatible", NULL));
+	ut_asserteq_str("okay", fdt_getprop(fdt, node, "status", NULL));
+	ut_assertnull(fdt_getprop(fdt, node, "missing", NULL));
+	ut_asserteq_str("fail", fdt_getprop(fdt, subnode, "status", NULL));
+	ut_asserteq_str("u-boot,fdt-subnode-test-device",
+			fdt_getprop(fdt, subnode, "compatible", NULL));
+
+	/* Adding a node writes out the batch and finds the parent again */
+	ut_assertok(fdt_batch_start(fdt));
+	do_fixup_by_path(fdt, "/", "model", "Longer than it was before", 26, 0);
+	ut_assert(fdt_find_or_add_subnode(fdt, node, "child") >= 0);
+	do_fixup_by_path_u32(fdt, "/test-node@1234/child", "reg", 3, 1);
+	ut_assertok(fdt_batch_finish(fdt));
+	ut_asserteq_str("Longer than it was before",
+			fdt_getprop(fdt, 0, "model", NULL));
+	node = fdt_path_offset(fdt, "/test-node@1234/child");
+	ut_assert(node >= 0);
+	ut_asserteq(3, fdtdec_get_int(fdt, node, "reg", 0));
+	ut_assert_console_end();
+
+	return 0;
+}
+FDT_TEST(fdt_test_batch, UTF_CONSOLE);
+
 static int fdt_test_print_list_common(struct unit_test_state *uts,
 				      const char *opc, const char *node)
 {
@@ -102,3 +102,57 @@ static int dm_test_cmd_hash_sha256(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_cmd_hash_sha256, UTF_CONSOLE);
+
+static int dm_test_cmd_hash_multi(struct unit_test_state *uts)
+{
+	if (!CONFIG_IS_ENABLED(SHA256) || !CONFIG_IS_ENABLED(CRC32))
+		return -EAGAIN;
+
+	ut_assertok(run_command("hash sha256,crc32 $loadaddr 0 s,c; echo $s $c",
+				0));
+	console_record_readline(uts->actual_str, sizeof(uts->actual_str));
+	ut_asserteq_ptr(uts->actual_str,
+			strstr(uts->actual_str, "sha256 for "));
+	console_record_readline(uts->actual_str, sizeof(uts->actual_str));
+	ut_asserteq_ptr(uts->actual_str,
+			strstr(uts->actual_str, "crc32 for "));
+	ut_assert(strstr(uts->actual_str, "00000000"));
+	ut_assertok(ut_check_console_line(
+			uts, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855 00000000"));
+	ut_assert_console_end();
+
+	/* The number of values must match the number of algorithms */
+	ut_assert(run_command("hash sha256,crc32 $loadaddr 0 s", 0));
+	ut_assertok(ut_check_console_line(uts,
+					  "Expected 2 comma-separated values"));
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_hash_multi, UTF_CONSOLE);
+
+static int dm_test_cmd_hash_fast(struct unit_test_state *uts)
+{
+	if (CONFIG_IS_ENABLED(XXHASH)) {
+		ut_assertok(run_command("hash xxh64 $loadaddr 0", 0));
+		console_record_readline(uts->actual_str,
+					sizeof(uts->actual_str));
+		ut_asserteq_ptr(uts->actual_str,
+				strstr(uts->actual_str, "xxh64 for "));
+		ut_assert(strstr(uts->actual_str, "ef46db3751d8e999"));
+		ut_assert_console_end();
+	}
+
+	if (CONFIG_IS_ENABLED(BLAKE2)) {
+		ut_assertok(run_command("hash blake2b-256 $loadaddr 0", 0));
+		console_record_readline(uts->actual_str,
+					sizeof(uts->actual_str));
+		ut_asserteq_ptr(uts->actual_str,
+				strstr(uts->actual_str, "blake2b-256 for "));
+		ut_assert(strstr(uts->actual_str,
+				 "0e5751c026e543b2e8ab2eb06099daa1d1e5df47778f7787faab45cdf12fe3a8"));
+		ut_assert_console_end();
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_cmd_hash_fast, UTF_CONSOLE);
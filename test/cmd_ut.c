@@ -116,6 +116,7 @@ SUITE_DECL(mem);
 SUITE_DECL(optee);
 SUITE_DECL(overlay);
 SUITE_DECL(pci_mps);
+SUITE_DECL(perf);
 SUITE_DECL(seama);
 SUITE_DECL(setexpr);
 SUITE_DECL(upl);
@@ -149,6 +150,7 @@ static struct suite suites[] = {
 	SUITE_CMD(overlay, do_ut_overlay, "device tree overlays"),
 #endif
 	SUITE(pci_mps, "PCI Express Maximum Payload Size"),
+	SUITE(perf, "instruction counts for hot paths"),
 	SUITE(seama, "seama command parameters loading and decoding"),
 	SUITE(setexpr, "setexpr command"),
 	SUITE(upl, "Universal payload support"),
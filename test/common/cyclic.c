@@ -8,6 +8,7 @@
 #include <test/common.h>
 #include <test/test.h>
 #include <test/ut.h>
+#include <time.h>
 #include <watchdog.h>
 #include <linux/delay.h>
 
@@ -37,3 +38,130 @@ static int dm_test_cyclic_running(struct unit_test_state *uts)
 	return 0;
 }
 COMMON_TEST(dm_test_cyclic_running, 0);
+
+/* Test that cyclic functions only run when due, and are kept in order */
+static struct cyclic_count_test {
+	struct cyclic_info cyclic;
+	int calls;
+} count_test[2];
+
+static void count_cb(struct cyclic_info *c)
+{
+	struct cyclic_count_test *t;
+
+	t = container_of(c, struct cyclic_count_test, cyclic);
+	t->calls++;
+}
+
+static int dm_test_cyclic_due(struct unit_test_state *uts)
+{
+	struct cyclic_info *cyclic, *prev = NULL;
+
+	memset(count_test, '\0', sizeof(count_test));
+	cyclic_register(&count_test[0].cyclic, count_cb, 1000 * 1000, "slow");
+	cyclic_register(&count_test[1].cyclic, count_cb, 10 * 1000, "fast");
+
+	/* Both run straight away, then not again until they are due */
+	schedule();
+	ut_asserteq(1, count_test[0].calls);
+	ut_asserteq(1, count_test[1].calls);
+	schedule();
+	ut_asserteq(1, count_test[0].calls);
+	ut_asserteq(1, count_test[1].calls);
+
+	hlist_for_each_entry(cyclic, cyclic_get_list(), list) {
+		if (prev)
+			ut_assert(cyclic->next_call >= prev->next_call);
+		prev = cyclic;
+	}
+
+	/* Only the fast one is due; it is at least 10ms late */
+	timer_test_add_offset(20);
+	schedule();
+	ut_asserteq(1, count_test[0].calls);
+	ut_asserteq(2, count_test[1].calls);
+	ut_asserteq(2, count_test[1].cyclic.run_cnt);
+	ut_assert(count_test[1].cyclic.max_latency_us >= 10 * 1000);
+
+	cyclic_unregister(&count_test[0].cyclic);
+	cyclic_unregister(&count_test[1].cyclic);
+
+	return 0;
+}
+COMMON_TEST(dm_test_cyclic_due, 0);
+
+/* Job which completes after a number of steps */
+static struct cyclic_work_test {
+	struct cyclic_work work;
+	int steps;
+	int left;
+} work_test[2];
+
+static int test_step(struct cyclic_work *work)
+{
+	struct cyclic_work_test *t;
+
+	t = container_of(work, struct cyclic_work_test, work);
+	t->steps++;
+
+	return --t->left ? -EINPROGRESS : 0;
+}
+
+static int dm_test_cyclic_work(struct unit_test_state *uts)
+{
+	/* A job which is complete straight away is not left running */
+	work_test[0].left = 1;
+	ut_assertok(cyclic_work_start(&work_test[0].work, test_step, 0, 0,
+				      "work0"));
+	ut_assert(!cyclic_work_busy(&work_test[0].work));
+
+	/* Two jobs make progress together, each time schedule() runs */
+	memset(work_test, '\0', sizeof(work_test));
+	work_test[0].left = 3;
+	work_test[1].left = 5;
+	ut_asserteq(-EINPROGRESS, cyclic_work_start(&work_test[0].work,
+						    test_step, 0, 0, "work0"));
+	ut_asserteq(-EINPROGRESS, cyclic_work_start(&work_test[1].work,
+						    test_step, 0, 0, "work1"));
+	schedule();
+	ut_asserteq(2, work_test[0].steps);
+	ut_asserteq(2, work_test[1].steps);
+
+	schedule();
+	ut_assert(!cyclic_work_busy(&work_test[0].work));
+	ut_asserteq(0, work_test[0].work.result);
+	ut_assert(cyclic_work_busy(&work_test[1].work));
+
+	/* Waiting completes the job, after which it is not called again */
+	ut_assertok(cyclic_work_wait(&work_test[1].work));
+	ut_asserteq(5, work_test[1].steps);
+	schedule();
+	ut_asserteq(3, work_test[0].steps);
+	ut_asserteq(5, work_test[1].steps);
+
+	return 0;
+}
+COMMON_TEST(dm_test_cyclic_work, 0);
+
+static int dm_test_cyclic_work_fail(struct unit_test_state *uts)
+{
+	/* A job which never completes times out */
+	memset(work_test, '\0', sizeof(work_test));
+	work_test[0].left = -1;
+	ut_asserteq(-EINPROGRESS, cyclic_work_start(&work_test[0].work,
+						    test_step, 1000, 10000,
+						    "work0"));
+	ut_asserteq(-ETIMEDOUT, cyclic_work_wait(&work_test[0].work));
+
+	/* A cancelled job stops and is not called again */
+	work_test[1].left = -1;
+	ut_asserteq(-EINPROGRESS, cyclic_work_start(&work_test[1].work,
+						    test_step, 0, 0, "work1"));
+	cyclic_work_cancel(&work_test[1].work);
+	ut_asserteq(-ECANCELED, work_test[1].work.result);
+	schedule();
+	ut_asserteq(1, work_test[1].steps);
+
+	return 0;
+}
+COMMON_TEST(dm_test_cyclic_work_fail, 0);
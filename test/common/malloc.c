@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for malloc() and its profiler
+ */
+
+#include <malloc.h>
+#include <malloc_profile.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <asm/sections.h>
+#include <linux/string.h>
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_SLAB)
+/* Test that small requests are rounded up to their class and reused */
+static int common_test_malloc_slab(struct unit_test_state *uts)
+{
+	char *ptr, *other;
+
+	ptr = malloc(20);
+	ut_assertnonnull(ptr);
+	ut_asserteq(32, malloc_usable_size(ptr));
+	free(ptr);
+
+	/* The most recently freed object is handed out first */
+	other = malloc(30);
+	ut_asserteq_ptr(ptr, other);
+
+	/* Growing within the class keeps the object where it is */
+	strcpy(other, "slab");
+	ptr = realloc(other, 32);
+	ut_asserteq_ptr(other, ptr);
+
+	/* Growing beyond the largest class moves it to the main heap */
+	ptr = realloc(other, 300);
+	ut_assertnonnull(ptr);
+	ut_assert(ptr != other);
+	ut_asserteq_str("slab", ptr);
+	ut_assert(malloc_usable_size(ptr) >= 300);
+
+	/* calloc() must clear an object which was used before */
+	other = calloc(1, 32);
+	ut_assertnonnull(other);
+	ut_asserteq(0, *other);
+	free(other);
+	free(ptr);
+
+	return 0;
+}
+COMMON_TEST(common_test_malloc_slab, 0);
+#endif
+
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE)
+/* Allocate from a single site, which is not a tail call */
+static noinline char *profile_alloc(size_t size)
+{
+	char *ptr = malloc(size);
+
+	if (ptr)
+		*ptr = 0;
+
+	return ptr;
+}
+
+/* Find the site for profile_alloc() */
+static struct malloc_profile_site *profile_find(struct malloc_profile *prof)
+{
+	ulong start = (ulong)profile_alloc - (ulong)_init;
+	int i;
+
+	for (i = 0; i < prof->num_sites; i++) {
+		struct malloc_profile_site *site = &prof->site[i];
+
+		if (site->caller >= start && site->caller < start + 0x100)
+			return site;
+	}
+
+	return NULL;
+}
+
+/* Test that allocations and frees are charged to their caller */
+static int common_test_malloc_profile(struct unit_test_state *uts)
+{
+	struct malloc_profile_site *site, old;
+	struct malloc_profile *prof;
+	char *ptr[3];
+	u32 untracked;
+
+	prof = malloc_profile_get();
+	ut_assertnonnull(prof);
+	untracked = prof->untracked;
+	ptr[0] = profile_alloc(123);
+	ut_assertnonnull(ptr[0]);
+	site = profile_find(prof);
+
+	/* Skip the test if the tables are too small for this test run */
+	if ((!site && prof->num_sites == prof->max_sites) ||
+	    prof->untracked != untracked)
+		return -EAGAIN;
+	ut_assertnonnull(site);
+	old = *site;
+
+	ptr[1] = profile_alloc(123);
+	ptr[2] = profile_alloc(123);
+	ut_assertnonnull(ptr[1]);
+	ut_assertnonnull(ptr[2]);
+	if (prof->untracked != untracked)
+		return -EAGAIN;
+	ut_asserteq(old.count + 2, site->count);
+	ut_asserteq(old.total + 246, site->total);
+	ut_asserteq(old.live + 246, site->live);
+	ut_assert(site->peak >= site->live);
+
+	free(ptr[0]);
+	free(ptr[1]);
+	ut_asserteq(old.frees + 2, site->frees);
+	ut_asserteq(old.live, site->live);
+	ut_assert(site->lifetime > old.lifetime);
+
+	free(ptr[2]);
+	ut_asserteq(old.live - 123, site->live);
+
+	return 0;
+}
+COMMON_TEST(common_test_malloc_profile, 0);
+#endif
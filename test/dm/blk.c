@@ -5,11 +5,15 @@
 
 #include <blk.h>
 #include <dm.h>
+#include <fs_dcache.h>
+#include <malloc.h>
+#include <os.h>
 #include <part.h>
 #include <sandbox_host.h>
 #include <usb.h>
 #include <asm/global_data.h>
 #include <asm/state.h>
+#include <dm/device-internal.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -334,3 +338,259 @@ static int dm_test_blk_foreach(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_blk_foreach, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(BLOCK_CACHE)
+/* Test the hashed block cache and its per-device statistics */
+static int dm_test_blk_cache(struct unit_test_state *uts)
+{
+	struct block_cache_stats stats;
+	char buf[4 * 512], out[4 * 512];
+	int i;
+
+	memset(buf, '\xa5', sizeof(buf));
+	blkcache_configure(4, 8);
+	blkcache_stats(&stats);
+	ut_asserteq(0, stats.entries);
+
+	/* blocks are only cached if small enough */
+	blkcache_fill(UCLASS_HOST, 0, 0, 5, 512, buf);
+	ut_asserteq(0, blkcache_read(UCLASS_HOST, 0, 0, 5, 512, out));
+
+	blkcache_fill(UCLASS_HOST, 0, 10, 4, 512, buf);
+	ut_asserteq(1, blkcache_read(UCLASS_HOST, 0, 10, 4, 512, out));
+	ut_assertok(memcmp(buf, out, sizeof(buf)));
+
+	/* the range must match and the device must be the same */
+	ut_asserteq(0, blkcache_read(UCLASS_HOST, 0, 11, 2, 512, out));
+	ut_asserteq(0, blkcache_read(UCLASS_HOST, 1, 10, 4, 512, out));
+
+	blkcache_stats(&stats);
+	ut_asserteq(1, stats.hits);
+	ut_asserteq(3, stats.misses);
+	ut_asserteq(1, stats.entries);
+	ut_asserteq(2, stats.sets);
+	ut_asserteq(4, stats.ways);
+	ut_asserteq(2, stats.num_devs);
+	ut_asserteq(UCLASS_HOST, stats.dev[0].iftype);
+	ut_asserteq(0, stats.dev[0].devnum);
+	ut_asserteq(1, stats.dev[0].hits);
+	ut_asserteq(2, stats.dev[0].misses);
+	ut_asserteq(1, stats.dev[1].devnum);
+	ut_asserteq(0, stats.dev[1].hits);
+	ut_asserteq(1, stats.dev[1].misses);
+
+	/* the cache never holds more than the maximum number of entries */
+	for (i = 0; i < 20; i++)
+		blkcache_fill(UCLASS_HOST, 0, i * 4, 1, 512, buf);
+	blkcache_stats(&stats);
+	ut_assert(stats.entries <= 8);
+	ut_asserteq(0, stats.num_devs);
+
+	blkcache_invalidate(UCLASS_HOST, 0);
+	blkcache_stats(&stats);
+	ut_asserteq(0, stats.entries);
+
+	/* restore the defaults */
+	blkcache_configure(8, 32);
+
+	return 0;
+}
+DM_TEST(dm_test_blk_cache, 0);
+#endif
+
+/* Test that asynchronous reads and writes fall back to synchronous ones */
+static int dm_test_blk_submit(struct unit_test_state *uts)
+{
+	struct udevice *dev, *blk;
+	struct blk_request req;
+	struct blk_desc *desc;
+	char fname[256], *ref, *buf;
+	const int count = 16;
+
+	ut_assertok(host_create_device("test", true, DEFAULT_BLKSZ, &dev));
+	ut_assertok(os_persistent_file(fname, sizeof(fname), "2MB.ext2.img"));
+	ut_assertok(host_attach_file(dev, fname));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+
+	ref = malloc(count * desc->blksz);
+	buf = malloc(count * desc->blksz);
+	ut_assertnonnull(ref);
+	ut_assertnonnull(buf);
+	ut_asserteq(count, blk_read(blk, 2, count, ref));
+
+	ut_assertok(blk_submit(blk, &req, 2, count, buf));
+	ut_asserteq(count, blk_wait(&req));
+	ut_assert(req.complete);
+	ut_assertok(blk_poll(&req));
+	ut_asserteq_mem(ref, buf, count * desc->blksz);
+
+	/* write the same data back, so the image is unchanged */
+	ut_assertok(blk_submit_write(blk, &req, 2, count, ref));
+	ut_assert(req.write);
+	ut_asserteq(count, blk_wait(&req));
+
+	free(buf);
+	free(ref);
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_blk_submit, UTF_SCAN_FDT);
+
+/* Test reading into a scatter-gather list */
+static int dm_test_blk_read_sg(struct unit_test_state *uts)
+{
+	struct udevice *dev, *blk;
+	struct blk_desc *desc;
+	struct blk_sg sg[3];
+	char fname[256], *ref, *buf;
+	const int count = 12;
+
+	ut_assertok(host_create_device("test", true, DEFAULT_BLKSZ, &dev));
+	ut_assertok(os_persistent_file(fname, sizeof(fname), "2MB.ext2.img"));
+	ut_assertok(host_attach_file(dev, fname));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+
+	ref = malloc(count * desc->blksz);
+	buf = calloc(count, desc->blksz);
+	ut_assertnonnull(ref);
+	ut_assertnonnull(buf);
+	ut_asserteq(count, blk_read(blk, 5, count, ref));
+
+	/* fill the buffer out of order, so the segments are discontiguous */
+	sg[0].buf = buf + 8 * desc->blksz;
+	sg[0].len = 4 * desc->blksz;
+	sg[1].buf = buf;
+	sg[1].len = 3 * desc->blksz;
+	sg[2].buf = buf + 3 * desc->blksz;
+	sg[2].len = 5 * desc->blksz;
+	ut_asserteq(count, blk_read_sg(blk, 5, sg, ARRAY_SIZE(sg)));
+	ut_asserteq_mem(ref, buf + 8 * desc->blksz, 4 * desc->blksz);
+	ut_asserteq_mem(ref + 4 * desc->blksz, buf, 8 * desc->blksz);
+
+	/* segments must be whole blocks */
+	sg[0].len = desc->blksz + 1;
+	ut_asserteq(-EINVAL, blk_read_sg(blk, 5, sg, ARRAY_SIZE(sg)));
+
+	free(buf);
+	free(ref);
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_blk_read_sg, UTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(BLK_READAHEAD)
+/* Test that sequential reads are served correctly through read-ahead */
+static int dm_test_blk_readahead(struct unit_test_state *uts)
+{
+	struct udevice *dev, *blk;
+	struct blk_desc *desc;
+	char fname[256], *ref, *buf;
+	const int count = 200;
+	int i;
+
+	ut_assertok(host_create_device("test", true, DEFAULT_BLKSZ, &dev));
+	ut_assertok(os_persistent_file(fname, sizeof(fname), "2MB.ext2.img"));
+	ut_assertok(host_attach_file(dev, fname));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+
+	ref = malloc(count * desc->blksz);
+	buf = malloc(count * desc->blksz);
+	ut_assertnonnull(ref);
+	ut_assertnonnull(buf);
+
+	/* a large read goes straight to the device */
+	ut_asserteq(count, blk_read(blk, 0, count, ref));
+
+	/* small sequential reads grow the window */
+	for (i = 0; i < count; i++)
+		ut_asserteq(1, blk_read(blk, i, 1, buf + i * desc->blksz));
+	ut_asserteq_mem(ref, buf, count * desc->blksz);
+	ut_assertnonnull(desc->ra);
+	ut_assert(desc->ra->window > 1);
+
+	/* a random read resets it */
+	ut_asserteq(1, blk_read(blk, 1000, 1, buf));
+	ut_asserteq(0, desc->ra->window);
+
+	/* invalidating drops the window */
+	blk_readahead_invalidate(desc);
+	ut_asserteq(0, desc->ra->count);
+
+	free(buf);
+	free(ref);
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_blk_readahead, UTF_SCAN_FDT);
+#endif
+
+#if CONFIG_IS_ENABLED(FS_DCACHE)
+/* Test that cached directory lookups are dropped when the device changes */
+static int dm_test_blk_fs_dcache(struct unit_test_state *uts)
+{
+	struct udevice *dev, *blk;
+	struct fs_dcache_ent *ent;
+	struct blk_desc *desc;
+	char fname[256], *buf;
+	u32 data = 0x1234;
+
+	ut_assertok(host_create_device("test", true, DEFAULT_BLKSZ, &dev));
+	ut_assertok(os_persistent_file(fname, sizeof(fname), "2MB.ext2.img"));
+	ut_assertok(host_attach_file(dev, fname));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+
+	fs_dcache_bind(desc, 0, 1);
+	fs_dcache_invalidate();
+	fs_dcache_add(2, "boot", 4, true, &data, sizeof(data));
+	fs_dcache_add(2, "missing", 7, false, NULL, 0);
+
+	ent = fs_dcache_find(2, "boot", 4, false);
+	ut_assertnonnull(ent);
+	ut_assert(ent->found);
+	ut_asserteq(data, *(u32 *)ent->data);
+	ut_assertnull(fs_dcache_find(2, "BOOT", 4, false));
+	ut_assertnonnull(fs_dcache_find(2, "BOOT", 4, true));
+	ut_assertnull(fs_dcache_find(3, "boot", 4, false));
+	ent = fs_dcache_find(2, "missing", 7, false);
+	ut_assertnonnull(ent);
+	ut_assert(!ent->found);
+
+	/* mounting the same filesystem again keeps the entries */
+	fs_dcache_bind(desc, 0, 1);
+	ut_assertnonnull(fs_dcache_find(2, "boot", 4, false));
+
+	/* a different filesystem signature drops them */
+	fs_dcache_bind(desc, 0, 2);
+	ut_assertnull(fs_dcache_find(2, "boot", 4, false));
+
+	/* so does writing to the device */
+	fs_dcache_add(2, "boot", 4, true, &data, sizeof(data));
+	buf = malloc(desc->blksz);
+	ut_assertnonnull(buf);
+	ut_asserteq(1, blk_read(blk, 0, 1, buf));
+	ut_asserteq(1, blk_write(blk, 0, 1, buf));
+	ut_assertnull(fs_dcache_find(2, "boot", 4, false));
+
+	fs_dcache_invalidate();
+	free(buf);
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_blk_fs_dcache, UTF_SCAN_FDT);
+#endif
@@ -110,6 +110,33 @@ static int dm_test_blkmap_write(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_blkmap_write, 0);
 
+static int dm_test_blkmap_map(struct unit_test_state *uts)
+{
+	struct udevice *dev, *blk;
+	void *ptr;
+
+	ut_assertok(blkmap_create("maptest", &dev));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+
+	ut_assertok(blkmap_map_mem(dev, 0, 4, identity));
+	ut_assertok(blkmap_map_mem(dev, 4, 4, unordered));
+
+	/* Memory slices are mapped in place */
+	ut_assertok(blk_map(blk, 1, 3, &ptr));
+	ut_asserteq_ptr(identity + BLKSZ, ptr);
+	ut_assertok(blk_map(blk, 5, 1, &ptr));
+	ut_asserteq_ptr(unordered + BLKSZ, ptr);
+
+	/* Blocks which span two slices are not contiguous */
+	ut_asserteq(-ERANGE, blk_map(blk, 3, 2, &ptr));
+	/* Nor can anything beyond the end be mapped */
+	ut_asserteq(-ERANGE, blk_map(blk, 6, 4, &ptr));
+
+	ut_assertok(blkmap_destroy(dev));
+	return 0;
+}
+DM_TEST(dm_test_blkmap_map, 0);
+
 static int dm_test_blkmap_slicing(struct unit_test_state *uts)
 {
 	struct udevice *dev;
@@ -15,6 +15,7 @@
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
 #include <linux/list.h>
+#include <linux/sizes.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -235,6 +236,42 @@ static int dm_test_bus_parent_data_uclass(struct unit_test_state *uts)
 DM_TEST(dm_test_bus_parent_data_uclass,
 	UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+#if CONFIG_IS_ENABLED(DM_PRIV_ARENA)
+/* Test that a device's data blocks are allocated together */
+static int dm_test_bus_priv_arena(struct unit_test_state *uts)
+{
+	struct udevice *bus, *dev;
+	void *priv, *parent_priv;
+
+	ut_assertok(uclass_get_device(UCLASS_TEST_BUS, 0, &bus));
+	ut_assertok(device_get_child_by_seq(bus, 0, &dev));
+
+	/* the plat blocks follow the device */
+	ut_assert(dev_get_plat(dev) > (void *)dev);
+	ut_assert(dev_get_parent_plat(dev) > dev_get_plat(dev));
+	ut_assert(dev_get_parent_plat(dev) - (void *)dev < SZ_1K);
+
+	/* the priv blocks are in a single block */
+	priv = dev_get_priv(dev);
+	parent_priv = dev_get_parent_priv(dev);
+	ut_asserteq_ptr(dev->priv_arena_, priv);
+	ut_assert(parent_priv > priv);
+	ut_assert(parent_priv - priv < SZ_1K);
+
+	/* removing the device frees the block, probing allocates it again */
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertnull(dev->priv_arena_);
+	ut_assertnull(dev_get_priv(dev));
+	ut_assertnull(dev_get_parent_priv(dev));
+	ut_assertok(device_probe(dev));
+	ut_assertnonnull(dev->priv_arena_);
+	ut_asserteq_ptr(dev->priv_arena_, dev_get_priv(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_bus_priv_arena, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+#endif
+
 /* Test that the bus ops are called when a child is probed/removed */
 static int dm_test_bus_parent_ops(struct unit_test_state *uts)
 {
@@ -5,6 +5,7 @@
  * Copyright (c) 2013 Google, Inc
  */
 
+#include <bloblist.h>
 #include <errno.h>
 #include <dm.h>
 #include <fdtdec.h>
@@ -12,6 +13,7 @@
 #include <malloc.h>
 #include <asm/global_data.h>
 #include <dm/device-internal.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/test.h>
@@ -1443,3 +1445,188 @@ static int dm_test_try_first_device(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_try_first_device, 0);
+
+static char probe_early_log[80];
+
+static int probe_early_record(struct udevice *dev, const char *what)
+{
+	strlcat(probe_early_log, dev->name, sizeof(probe_early_log));
+	strlcat(probe_early_log, what, sizeof(probe_early_log));
+
+	return 0;
+}
+
+static int probe_early_drv_probe(struct udevice *dev)
+{
+	return probe_early_record(dev, "+ ");
+}
+
+static int probe_early_drv_probe_finish(struct udevice *dev)
+{
+	return probe_early_record(dev, ". ");
+}
+
+static const struct udevice_id probe_early_ids[] = {
+	{ .compatible = "sandbox,probe-early" },
+	{ }
+};
+
+U_BOOT_DRIVER(sandbox_probe_early) = {
+	.name		= "sandbox_probe_early",
+	.id		= UCLASS_TEST_DUMMY,
+	.of_match	= probe_early_ids,
+	.bind		= dm_scan_fdt_dev,
+	.probe		= probe_early_drv_probe,
+	.probe_finish	= probe_early_drv_probe_finish,
+};
+
+/* Test that a split probe is completed straight away when probing lazily */
+static int dm_test_probe_split(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	*probe_early_log = '\0';
+	ut_assertok(device_find_global_by_ofnode(
+		ofnode_path("/probe-early-test/user"), &dev));
+	ut_assertok(device_probe(dev));
+	ut_asserteq_str("user+ user. ", probe_early_log);
+	ut_asserteq(DM_FLAG_ACTIVATED,
+		    dev_get_flags(dev) &
+		    (DM_FLAG_ACTIVATED | DM_FLAG_PROBE_PENDING));
+
+	/* A pending probe is completed by the next device_probe() */
+	*probe_early_log = '\0';
+	ut_assertok(device_find_global_by_ofnode(
+		ofnode_path("/probe-early-test/slow"), &dev));
+	ut_assertok(device_probe_begin(dev));
+	ut_asserteq_str("slow+ ", probe_early_log);
+	ut_assert(dev_get_flags(dev) & DM_FLAG_PROBE_PENDING);
+	ut_assertok(device_probe(dev));
+	ut_asserteq_str("slow+ slow. ", probe_early_log);
+	ut_assert(!(dev_get_flags(dev) & DM_FLAG_PROBE_PENDING));
+
+	return 0;
+}
+DM_TEST(dm_test_probe_split, UTF_SCAN_FDT);
+
+/* Test that the early-probe pass overlaps probes in dependency order */
+static int dm_test_probe_early(struct unit_test_state *uts)
+{
+	struct udevice *bus, *dev;
+
+	if (!CONFIG_IS_ENABLED(DM_PROBE_EARLY))
+		return -EAGAIN;
+
+	ut_assertok(device_find_global_by_ofnode(ofnode_path("/probe-early-test"),
+						 &bus));
+	*probe_early_log = '\0';
+	ut_assertok(dm_probe_early(bus));
+
+	/*
+	 * 'user' needs the clock from 'slow' and 'child' needs its parent, so
+	 * each waits until that probe is finished, while the others overlap
+	 */
+	ut_asserteq_str("slow+ other+ slow. user+ other. child+ user. child. ",
+			probe_early_log);
+
+	device_foreach_child(dev, bus) {
+		ut_asserteq(DM_FLAG_ACTIVATED,
+			    dev_get_flags(dev) &
+			    (DM_FLAG_ACTIVATED | DM_FLAG_PROBE_PENDING));
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_probe_early, UTF_SCAN_FDT);
+
+/* Test that devices set up by an earlier phase are marked when bound */
+static int dm_test_handoff(struct unit_test_state *uts)
+{
+	struct udevice *dev, *parent;
+	ofnode node;
+	u32 *count;
+	int size;
+
+	if (!CONFIG_IS_ENABLED(DM_HANDOFF) || !gd->bloblist)
+		return -EAGAIN;
+
+	ut_assertok(uclass_first_device_err(UCLASS_TEST_FDT, &dev));
+	ut_assert(dev_get_flags(dev) & DM_FLAG_PINCTRL_DONE);
+	ut_assert(!(dev_get_flags(dev) & DM_FLAG_HANDED_OFF));
+	ut_assertok(dm_handoff_write());
+
+	/* Bind the device again, as the next phase would */
+	node = dev_ofnode(dev);
+	parent = dev_get_parent(dev);
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_unbind(dev));
+	ut_assertok(lists_bind_fdt(parent, node, &dev, NULL, false));
+	ut_asserteq(DM_FLAG_PINCTRL_DONE | DM_FLAG_HANDED_OFF,
+		    dev_get_flags(dev) &
+		    (DM_FLAG_PINCTRL_DONE | DM_FLAG_HANDED_OFF));
+	ut_assertok(device_probe(dev));
+
+	/* Once removed, the device must be set up again */
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assert(!(dev_get_flags(dev) &
+		    (DM_FLAG_PINCTRL_DONE | DM_FLAG_HANDED_OFF)));
+
+	/* Drop the records so that later tests are not affected */
+	count = bloblist_get_blob(BLOBLISTT_U_BOOT_DM_HANDOFF, &size);
+	ut_assertnonnull(count);
+	*count = 0;
+
+	return 0;
+}
+DM_TEST(dm_test_handoff, UTF_SCAN_FDT);
+
+/* Test finding devices in a uclass large enough to have lookup tables */
+static int dm_test_uclass_index(struct unit_test_state *uts)
+{
+	static const char *const names[] = {
+		"idx0", "idx1", "idx2", "idx3", "idx4",
+		"idx5", "idx6", "idx7", "idx8", "idx9",
+	};
+	struct udevice *devs[ARRAY_SIZE(names)], *dev;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(names); i++)
+		ut_assertok(device_bind(uts->root, DM_DRIVER_GET(test_drv),
+					names[i], NULL, ofnode_null(),
+					&devs[i]));
+
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		ut_assertok(uclass_find_device_by_name(UCLASS_TEST, names[i],
+						       &dev));
+		ut_asserteq_ptr(devs[i], dev);
+		ut_assertok(uclass_find_device_by_seq(UCLASS_TEST,
+						      dev_seq(devs[i]), &dev));
+		ut_asserteq_ptr(devs[i], dev);
+	}
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST, "idx",
+							&dev));
+	ut_asserteq(-ENODEV, uclass_find_device_by_namelen(UCLASS_TEST,
+							   "idx10", 5, &dev));
+	ut_assertok(uclass_find_device_by_namelen(UCLASS_TEST, "idx10", 4,
+						  &dev));
+	ut_asserteq_ptr(devs[1], dev);
+
+	/* Renaming a device updates the lookup */
+	ut_assertok(device_set_name(devs[3], "renamed"));
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST, "idx3",
+							&dev));
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST, "renamed", &dev));
+	ut_asserteq_ptr(devs[3], dev);
+
+	/* So do unbinding and reparenting */
+	ut_assertok(device_unbind(devs[5]));
+	ut_asserteq(-ENODEV, uclass_find_device_by_name(UCLASS_TEST, "idx5",
+							&dev));
+	ut_assertok(device_reparent(devs[6], devs[7]));
+	ut_assertok(uclass_find_device_by_name(UCLASS_TEST, "idx6", &dev));
+	ut_asserteq_ptr(devs[6], dev);
+	ut_asserteq_ptr(devs[7], dev_get_parent(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_uclass_index, UTF_SCAN_PDATA);
@@ -48,3 +48,42 @@ static int dm_test_cpu(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_cpu, UTF_SCAN_FDT);
+
+static void cpu_test_job(void *arg)
+{
+	int *ran = arg;
+
+	(*ran)++;
+}
+
+/* Test spreading jobs over the CPU cores */
+static int dm_test_cpu_run_jobs(struct unit_test_state *uts)
+{
+	struct cpu_job jobs[5];
+	int ran[5] = {};
+	struct udevice *cur;
+	int i;
+
+	ut_assertok(cpu_probe_all());
+	cur = cpu_get_current_dev();
+
+	for (i = 0; i < ARRAY_SIZE(jobs); i++) {
+		jobs[i].func = cpu_test_job;
+		jobs[i].arg = &ran[i];
+	}
+	ut_assertok(cpu_run_jobs(jobs, ARRAY_SIZE(jobs)));
+
+	for (i = 0; i < ARRAY_SIZE(jobs); i++)
+		ut_asserteq(1, ran[i]);
+
+	/* Two jobs go to the other cores in each round */
+	ut_assertnonnull(jobs[0].dev);
+	ut_assert(jobs[0].dev != cur);
+	ut_assertnonnull(jobs[1].dev);
+	ut_assertnull(jobs[2].dev);
+	ut_assertnonnull(jobs[3].dev);
+	ut_assertnull(jobs[4].dev);
+
+	return 0;
+}
+DM_TEST(dm_test_cpu_run_jobs, UTF_SCAN_FDT);
@@ -11,6 +11,7 @@
 #include <fdtdec.h>
 #include <log.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <net.h>
 #include <net6.h>
 #include <asm/eth.h>
@@ -446,6 +447,124 @@ static int dm_test_net_retry(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_net_retry, UTF_SCAN_FDT);
 
+#if IS_ENABLED(CONFIG_IP_DEFRAG) && CONFIG_NET_DEFRAG_SLOTS >= 2
+static int defrag_rx_count;
+static int defrag_rx_len;
+static uchar defrag_rx_data[32];
+
+static void defrag_udp_handler(uchar *pkt, unsigned int dport,
+			       struct in_addr sip, unsigned int sport,
+			       unsigned int len)
+{
+	defrag_rx_count++;
+	defrag_rx_len = len;
+	memcpy(defrag_rx_data, pkt, min_t(uint, len, sizeof(defrag_rx_data)));
+}
+
+/* Receive one fragment of a UDP datagram with 24 bytes of data */
+static void defrag_rx(u16 id, int part, uchar fill)
+{
+	uchar pkt[ETHER_HDR_SIZE + IP_HDR_SIZE + 16];
+	struct ip_udp_hdr *ip = (void *)pkt + ETHER_HDR_SIZE;
+	struct ethernet_hdr *et = (void *)pkt;
+	uchar *data = (uchar *)ip + IP_HDR_SIZE;
+
+	memset(pkt, '\0', sizeof(pkt));
+	et->et_protlen = htons(PROT_IP);
+	ip->ip_hl_v = 0x45;
+	ip->ip_len = htons(IP_HDR_SIZE + 16);
+	ip->ip_id = htons(id);
+	ip->ip_off = htons(part ? 2 : IP_FLAGS_MFRAG);
+	ip->ip_ttl = 255;
+	ip->ip_p = IPPROTO_UDP;
+	ip->ip_src = string_to_ip("1.1.2.3");
+	ip->ip_dst = net_ip;
+	ip->ip_sum = compute_ip_checksum(ip, IP_HDR_SIZE);
+	memset(data, fill, 16);
+	if (!part) {
+		ip->udp_src = htons(1000);
+		ip->udp_dst = htons(2000);
+		ip->udp_len = htons(UDP_HDR_SIZE + 24);
+		ip->udp_xsum = 0;
+	}
+	net_process_received_packet(pkt, sizeof(pkt));
+}
+
+/* Test reassembling two datagrams whose fragments are interleaved */
+static int dm_test_net_defrag(struct unit_test_state *uts)
+{
+	defrag_rx_count = 0;
+	net_set_udp_handler(defrag_udp_handler);
+
+	defrag_rx(1, 0, 0xa0);
+	defrag_rx(2, 0, 0xb0);
+	ut_asserteq(0, defrag_rx_count);
+
+	defrag_rx(1, 1, 0xa1);
+	ut_asserteq(1, defrag_rx_count);
+	ut_asserteq(24, defrag_rx_len);
+	ut_asserteq(0xa0, defrag_rx_data[7]);
+	ut_asserteq(0xa1, defrag_rx_data[8]);
+
+	defrag_rx(2, 1, 0xb1);
+	ut_asserteq(2, defrag_rx_count);
+	ut_asserteq(0xb0, defrag_rx_data[7]);
+	ut_asserteq(0xb1, defrag_rx_data[23]);
+
+	/* A repeated fragment of a finished datagram does not complete it */
+	defrag_rx(2, 1, 0xb1);
+	ut_asserteq(2, defrag_rx_count);
+	net_set_udp_handler(NULL);
+
+	return 0;
+}
+DM_TEST(dm_test_net_defrag, UTF_SCAN_FDT);
+#endif
+
+#if IS_ENABLED(CONFIG_NET_RX_DIRECT)
+/* Test placing a received packet so that its payload is in place */
+static int dm_test_eth_rx_direct(struct unit_test_state *uts)
+{
+	const ulong base = 0x10000, dest = base + 0x100;
+	const int hdr_len = 46, len = 0x200;
+	uchar *buf, *mem;
+	int i;
+
+	mem = map_sysmem(base, 0x400);
+	for (i = 0; i < 0x100; i++)
+		mem[i] = i;
+
+	/* Nothing is offered without a hint */
+	net_set_rx_direct(0, 0, 0);
+	ut_assertnull(net_rx_direct_buf(hdr_len + len));
+
+	net_set_rx_direct(dest, hdr_len, len);
+	ut_assertnull(net_rx_direct_buf(PKTSIZE_ALIGN + 1));
+	buf = net_rx_direct_buf(hdr_len + len);
+	ut_asserteq_ptr(mem + 0x100 - hdr_len, buf);
+
+	/* Only one packet at a time */
+	memset(buf, 0xff, hdr_len + len);
+	ut_assertnull(net_rx_direct_buf(hdr_len + len));
+
+	/* Finishing with another packet leaves this one alone */
+	net_rx_direct_done(net_rx_packets[0]);
+	ut_asserteq(0xff, mem[0x100 - hdr_len]);
+
+	/* The headers are removed, leaving what was there and the payload */
+	net_rx_direct_done(buf);
+	for (i = 0; i < 0x100; i++)
+		ut_asserteq(i, mem[i]);
+	ut_asserteq(0xff, mem[0x100]);
+	ut_asserteq(0xff, mem[0x100 + len - 1]);
+	net_set_rx_direct(0, 0, 0);
+	unmap_sysmem(mem);
+
+	return 0;
+}
+DM_TEST(dm_test_eth_rx_direct, 0);
+#endif
+
 static int sb_check_arp_reply(struct udevice *dev, void *packet,
 			      unsigned int len)
 {
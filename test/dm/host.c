@@ -158,6 +158,15 @@ static int dm_test_cmd_host(struct unit_test_state *uts)
 	ut_assert_nextlinen("  1         2048    512 fat");
 	ut_assert_console_end();
 
+	/* check 'host perf'; the file is writable, so it is mapped */
+	ut_assertok(run_command("host perf fat", 0));
+	ut_assert_nextline("latency 0 us, rate 0 KiB/s, mapped");
+	ut_assert_console_end();
+
+	ut_assertok(run_command("host perf fat 10 100000", 0));
+	ut_assert_nextline("latency 10 us, rate 100000 KiB/s, mapped");
+	ut_assert_console_end();
+
 	/* check 'host dev' */
 	ut_asserteq(1, run_command("host dev", 0));
 	ut_assert_nextline("No current host device");
@@ -8,6 +8,7 @@
 #include <dm.h>
 #include <irq.h>
 #include <acpi/acpi_device.h>
+#include <asm/irq.h>
 #include <asm/test.h>
 #include <dm/test.h>
 #include <test/ut.h>
@@ -112,3 +113,48 @@ static int dm_test_irq_get_acpi(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_irq_get_acpi, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+/* Test of irq_set_handler() and irq_wait_completion() */
+static int dm_test_irq_handler(struct unit_test_state *uts)
+{
+	struct sandbox_irq_priv *priv;
+	struct irq_completion comp;
+	struct irq_uc_priv *uc_priv;
+	struct irq irq;
+
+	if (!CONFIG_IS_ENABLED(IRQ_DISPATCH))
+		return -EAGAIN;
+	ut_assertok(irq_first_device_type(SANDBOX_IRQT_BASE, &irq.dev));
+	priv = dev_get_priv(irq.dev);
+	uc_priv = dev_get_uclass_priv(irq.dev);
+	irq.id = 5;
+
+	irq_completion_init(&comp);
+	ut_assertok(irq_set_handler(&irq, irq_complete, &comp));
+	ut_asserteq(BIT(5), priv->enabled);
+
+	/* nothing is raised, so the wait times out */
+	ut_asserteq(-ETIMEDOUT, irq_wait_completion(&comp, 1));
+	ut_asserteq(0, irq_handle(irq.dev));
+
+	priv->raised = BIT(5);
+	ut_assertok(irq_wait_completion(&comp, 1000));
+	ut_assert(comp.done);
+	ut_asserteq(0, priv->raised);
+	ut_asserteq(1, priv->eoi_count);
+	ut_asserteq(1, uc_priv->count);
+
+	/* an interrupt with no handler is disabled */
+	priv->enabled |= BIT(7);
+	priv->raised = BIT(7);
+	ut_asserteq(1, irq_handle_all());
+	ut_asserteq(BIT(5), priv->enabled);
+	ut_asserteq(1, uc_priv->unhandled);
+
+	ut_assertok(irq_clear_handler(&irq));
+	ut_asserteq(0, priv->enabled);
+	ut_asserteq(-ENOENT, irq_clear_handler(&irq));
+
+	return 0;
+}
+DM_TEST(dm_test_irq_handler, UTF_SCAN_PDATA | UTF_SCAN_FDT);
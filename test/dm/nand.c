@@ -119,3 +119,57 @@ static int dm_test_nand1_end(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_nand1_end, UTF_SCAN_FDT);
+
+static int dm_test_nand_cache_read(struct unit_test_state *uts)
+{
+	nand_erase_options_t opts = { };
+	struct nand_chip *chip;
+	struct mtd_info *mtd;
+	size_t length, retlen;
+	loff_t off;
+	int *gold;
+	char *buf;
+	int i, ret;
+
+	mtd = get_nand_dev_by_index(0);
+	ut_assertnonnull(mtd);
+	chip = mtd_to_nand(mtd);
+	ut_assert(chip->options & NAND_CACHE_READ);
+
+	off = mtd->erasesize * 4;
+	length = mtd->erasesize * 2;
+	buf = malloc(length);
+	ut_assertnonnull(buf);
+	gold = malloc(length);
+	ut_assertnonnull(gold);
+
+	opts.offset = off;
+	opts.length = length;
+	opts.lim = U32_MAX;
+	ut_assertok(nand_erase_opts(mtd, &opts));
+
+	for (i = 0; i < length / sizeof(int); i++)
+		gold[i] = rand();
+	ut_assertok(nand_write_skip_bad(mtd, off, &length, NULL, U64_MAX,
+					(void *)gold, 0));
+
+	/* Unaligned start and end, crossing an erase block */
+	for (i = 0; i < 2; i++) {
+		memset(buf, 0, length);
+		ret = mtd_read(mtd, off + 3, length - 10, &retlen,
+			       (u_char *)buf);
+		ut_assert(!ret || ret == -EUCLEAN);
+		ut_asserteq(length - 10, retlen);
+		ut_asserteq_mem((char *)gold + 3, buf, length - 10);
+
+		/* Compare with page-by-page reads */
+		chip->options &= ~NAND_CACHE_READ;
+	}
+	chip->options |= NAND_CACHE_READ;
+
+	free(gold);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_nand_cache_read, UTF_SCAN_FDT);
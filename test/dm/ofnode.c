@@ -136,6 +136,27 @@ static int dm_test_ofnode_get_by_phandle(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_ofnode_get_by_phandle, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* test that repeated phandle lookups give the node holding the phandle */
+static int dm_test_ofnode_get_by_phandle_repeat(struct unit_test_state *uts)
+{
+	ofnode node, target;
+	u32 phandle;
+	int i;
+
+	node = ofnode_path("/phandle-node-1");
+	ut_assert(ofnode_valid(node));
+	ut_assertok(ofnode_read_u32(node, "phandle", &phandle));
+
+	for (i = 0; i < 3; i++) {
+		target = ofnode_get_by_phandle(phandle);
+		ut_assert(ofnode_equal(node, target));
+		ut_assert(!ofnode_valid(ofnode_get_by_phandle(0x1000000)));
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_get_by_phandle_repeat, UTF_SCAN_FDT);
+
 /* test oftree_get_by_phandle() with a the 'other' oftree */
 static int dm_test_ofnode_get_by_phandle_ot(struct unit_test_state *uts)
 {
@@ -1476,6 +1497,93 @@ static int dm_test_livetree_align(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_livetree_align, UTF_SCAN_FDT | UTF_LIVE_TREE);
 
+/* check that each property in the livetree holds the hash of its name */
+static int dm_test_livetree_prop_hash(struct unit_test_state *uts)
+{
+	struct device_node *np;
+	struct property *pp;
+	ofnode node;
+	int count = 0;
+
+	for (np = of_find_all_nodes(NULL); np; np = of_find_all_nodes(np)) {
+		for (pp = np->properties; pp; pp = pp->next) {
+			ut_asserteq(of_prop_hash(pp->name), pp->hash);
+			count++;
+		}
+	}
+	ut_assert(count > 0);
+
+	/* a new property must be found too */
+	node = ofnode_path("/a-test");
+	ut_assert(ofnode_valid(node));
+	ut_assertok(ofnode_write_string(node, "prop-hash-test", "fred"));
+	ut_asserteq_str("fred", ofnode_read_string(node, "prop-hash-test"));
+	pp = of_find_property(ofnode_to_np(node), "prop-hash-test", NULL);
+	ut_assertnonnull(pp);
+	ut_asserteq(of_prop_hash("prop-hash-test"), pp->hash);
+
+	return 0;
+}
+DM_TEST(dm_test_livetree_prop_hash, UTF_SCAN_FDT | UTF_LIVE_TREE);
+
+/* check that a saved livetree can be restored for a flat tree which moved */
+static int dm_test_livetree_save_restore(struct unit_test_state *uts)
+{
+	struct device_node *root, *ref, *np, *rp;
+	const void *blob = gd->fdt_blob;
+	int size, fdt_size;
+	void *buf, *copy;
+
+	ut_assertok(of_live_save(blob, NULL, 0, &size));
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	ut_asserteq(-ENOSPC, of_live_save(blob, buf, size - 1, &size));
+	ut_assertok(of_live_save(blob, buf, size, &size));
+
+	/* move the flat tree, as relocation does */
+	fdt_size = fdt_totalsize(blob);
+	copy = malloc(fdt_size);
+	ut_assertnonnull(copy);
+	memcpy(copy, blob, fdt_size);
+	ut_assertok(of_live_restore(buf, size, copy, &root));
+
+	/* nothing may still point into the saved tree */
+	memset(buf, '\xff', size);
+
+	ut_assertok(unflatten_device_tree(copy, &ref));
+	for (np = root, rp = ref; np && rp;
+	     np = of_find_all_nodes(np), rp = of_find_all_nodes(rp)) {
+		struct property *pp, *rpp;
+
+		ut_asserteq_str(rp->full_name, np->full_name);
+		ut_asserteq_str(rp->name, np->name);
+		ut_asserteq_str(rp->type, np->type);
+		ut_asserteq(rp->phandle, np->phandle);
+		for (pp = np->properties, rpp = rp->properties; pp && rpp;
+		     pp = pp->next, rpp = rpp->next) {
+			ut_asserteq_str(rpp->name, pp->name);
+			ut_asserteq(rpp->hash, pp->hash);
+			ut_asserteq(rpp->length, pp->length);
+			ut_asserteq_mem(rpp->value, pp->value, pp->length);
+		}
+		ut_assert(!pp && !rpp);
+	}
+	ut_assert(!np && !rp);
+	of_live_free(root);
+
+	/* a changed flat tree must not be used */
+	ut_assertok(of_live_save(copy, buf, size, &size));
+	((char *)copy)[fdt_size - 1] ^= 1;
+	ut_asserteq(-ESTALE, of_live_restore(buf, size, copy, &root));
+
+	of_live_free(ref);
+	free(copy);
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_livetree_save_restore, UTF_SCAN_FDT);
+
 /* check that it is possible to load an arbitrary livetree */
 static int dm_test_livetree_ensure(struct unit_test_state *uts)
 {
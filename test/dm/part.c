@@ -194,3 +194,58 @@ static int dm_test_part_get_info_by_type(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_part_get_info_by_type, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+static int dm_test_part_get_info_by_name(struct unit_test_state *uts)
+{
+	char str_disk_guid[UUID_STR_LEN + 1];
+	struct blk_desc *mmc_dev_desc;
+	struct disk_partition info;
+	struct disk_partition parts[] = {
+		{
+			.start = 48, /* GPT data takes up the first 34 blocks or so */
+			.size = 1,
+			.name = "zeta",
+		},
+		{
+			.start = 49,
+			.size = 1,
+			.name = "alpha",
+		},
+		{
+			.start = 50,
+			.size = 2,
+			.name = "zeta",
+		},
+	};
+
+	ut_asserteq(2, blk_get_device_by_str("mmc", "2", &mmc_dev_desc));
+	if (CONFIG_IS_ENABLED(RANDOM_UUID)) {
+		gen_rand_uuid_str(parts[0].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(parts[1].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(parts[2].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(str_disk_guid, UUID_STR_FORMAT_STD);
+	}
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+
+	ut_asserteq(2, part_get_info_by_name(mmc_dev_desc, "alpha", &info));
+	ut_asserteq(49, info.start);
+
+	/* The first of two partitions with the same name is found */
+	ut_asserteq(1, part_get_info_by_name(mmc_dev_desc, "zeta", &info));
+	ut_asserteq(48, info.start);
+	ut_asserteq(-ENOENT, part_get_info_by_name(mmc_dev_desc, "beta",
+						   &info));
+	ut_asserteq(-ENOENT, part_get_info_by_name(mmc_dev_desc, "zz", &info));
+
+	/* Rewriting the table must not leave a stale copy behind */
+	strcpy((char *)parts[1].name, "beta");
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+	ut_asserteq(-ENOENT, part_get_info_by_name(mmc_dev_desc, "alpha",
+						   &info));
+	ut_asserteq(2, part_get_info_by_name(mmc_dev_desc, "beta", &info));
+
+	return 0;
+}
+DM_TEST(dm_test_part_get_info_by_name, UTF_SCAN_PDATA | UTF_SCAN_FDT);
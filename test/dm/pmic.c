@@ -10,6 +10,7 @@
 #include <dm.h>
 #include <fdtdec.h>
 #include <fsl_pmic.h>
+#include <i2c.h>
 #include <malloc.h>
 #include <dm/device-internal.h>
 #include <dm/root.h>
@@ -83,6 +84,42 @@ static int dm_test_power_pmic_io(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_power_pmic_io, UTF_SCAN_FDT);
 
+/* Test the PMIC register cache */
+static int dm_test_power_pmic_cache(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	u8 val;
+
+	if (!IS_ENABLED(CONFIG_PMIC_REG_CACHE))
+		return -EAGAIN;
+
+	ut_assertok(pmic_get("sandbox_pmic", &dev));
+
+	ut_assertok(pmic_reg_write(dev, 0, 0x12));
+	ut_asserteq(0x12, pmic_reg_read(dev, 0));
+
+	/* change the register behind the cache's back */
+	val = 0x34;
+	ut_assertok(dm_i2c_write(dev, 0, &val, 1));
+	ut_asserteq(0x12, pmic_reg_read(dev, 0));
+	ut_assertok(pmic_clrsetbits(dev, 0, 0, 0x02));
+	ut_assertok(dm_i2c_read(dev, 0, &val, 1));
+	ut_asserteq(0x34, val);
+
+	/* a real change is written through */
+	ut_assertok(pmic_clrsetbits(dev, 0, 0x10, 0x01));
+	ut_assertok(dm_i2c_read(dev, 0, &val, 1));
+	ut_asserteq(0x03, val);
+
+	/* raw writes drop the cached value */
+	val = 0x56;
+	ut_assertok(pmic_write(dev, 0, &val, 1));
+	ut_asserteq(0x56, pmic_reg_read(dev, 0));
+
+	return 0;
+}
+DM_TEST(dm_test_power_pmic_cache, UTF_SCAN_FDT);
+
 #define MC34708_PMIC_REG_COUNT 64
 #define MC34708_PMIC_TEST_VAL 0x125534
 static int dm_test_power_pmic_mc34708_regs_check(struct unit_test_state *uts)
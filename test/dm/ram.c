@@ -4,7 +4,11 @@
  */
 
 #include <dm.h>
+#include <errno.h>
+#include <mapmem.h>
+#include <os.h>
 #include <ram.h>
+#include <ram_train.h>
 #include <asm/global_data.h>
 #include <dm/test.h>
 #include <test/test.h>
@@ -26,3 +30,40 @@ static int dm_test_ram_base(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_ram_base, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(RAM_TRAIN_CACHE)
+/* Test saving and restoring DRAM-training results */
+static int dm_test_ram_train(struct unit_test_state *uts)
+{
+	u8 trn[0x100], out[sizeof(trn)];
+	int full_size = 0x200000;
+	int i;
+
+	ut_assertok(os_write_file("spi.bin", map_sysmem(0x20000, full_size),
+				  full_size));
+	ut_assertok(ram_train_store_erase());
+	ut_asserteq(-ENOENT, ram_train_restore(0x1234, out, sizeof(out)));
+
+	for (i = 0; i < sizeof(trn); i++)
+		trn[i] = i;
+	ut_assertok(ram_train_save(0x1234, trn, sizeof(trn)));
+	ut_assertok(ram_train_restore(0x1234, out, sizeof(out)));
+	ut_asserteq_mem(trn, out, sizeof(trn));
+
+	/* Results for another setup must not be used */
+	ut_asserteq(-ESTALE, ram_train_restore(0x4321, out, sizeof(out)));
+	ut_asserteq(-ESTALE, ram_train_restore(0x1234, out, sizeof(out) - 1));
+
+	/* Corrupt data is detected: clear a bit of trn[1], after the header */
+	ut_assertok(ram_train_store_write(16 + 1, &trn[0], 1));
+	ut_asserteq(-EBADMSG, ram_train_restore(0x1234, out, sizeof(out)));
+
+	ut_asserteq(-E2BIG, ram_train_save(0x1234, trn,
+					   CONFIG_RAM_TRAIN_CACHE_SIZE));
+
+	ut_assertok(ram_train_verify(0x100000, 0x100000));
+
+	return 0;
+}
+DM_TEST(dm_test_ram_train, UTF_SCAN_FDT);
+#endif
@@ -74,6 +74,42 @@ static int dm_test_spi_flash(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_spi_flash, UTF_SCAN_PDATA | UTF_SCAN_FDT);
 
+/* Test erasing a range that only partly covers whole blocks */
+static int dm_test_spi_flash_erase(struct unit_test_state *uts)
+{
+	int full_size = 0x200000;
+	int start = 0xf000, size = 0x12000;
+	struct udevice *dev;
+	u8 *src, *dst;
+	int i;
+
+	src = map_sysmem(0x20000, full_size);
+	memset(src, 0x5a, full_size);
+	ut_assertok(os_write_file("spi.bin", src, full_size));
+	ut_assertok(uclass_first_device_err(UCLASS_SPI_FLASH, &dev));
+
+	/* 4KiB sectors at each end, a 64KiB block in the middle */
+	ut_assertok(spi_flash_erase_dm(dev, start, size));
+
+	dst = map_sysmem(0x20000 + full_size, full_size);
+	ut_assertok(spi_flash_read_dm(dev, 0, 0x40000, dst));
+	for (i = 0; i < 0x40000; i++) {
+		if (i >= start && i < start + size)
+			ut_asserteq(0xff, dst[i]);
+		else
+			ut_asserteq(0x5a, dst[i]);
+	}
+
+	/*
+	 * Since we are about to destroy all devices, we must tell sandbox
+	 * to forget the emulation device
+	 */
+	sandbox_sf_unbind_emul(state_get_current(), 0, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_spi_flash_erase, UTF_SCAN_PDATA | UTF_SCAN_FDT);
+
 /* Functional test that sandbox SPI flash works correctly */
 static int dm_test_spi_flash_func(struct unit_test_state *uts)
 {
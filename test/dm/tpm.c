@@ -6,9 +6,11 @@
 
 #include <dm.h>
 #include <tpm_api.h>
+#include <tpm-v2.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
+#include <u-boot/sha256.h>
 
 /*
  * get_tpm_version() - Get a TPM of the given version
@@ -124,3 +126,44 @@ static int dm_test_tpm_autostart_reinit(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_tpm_autostart_reinit, UTF_SCAN_FDT);
+
+/* Test extending a PCR with a list of digests */
+static int dm_test_tpm_pcr_extend_digests(struct unit_test_state *uts)
+{
+	u8 before[TPM2_DIGEST_LEN], after[TPM2_DIGEST_LEN];
+	u8 expect[TPM2_DIGEST_LEN];
+	struct tpml_digest_values digest_list;
+	struct tpm_chip_priv *priv;
+	struct udevice *dev;
+	sha256_context ctx;
+	const int pcr = 10;
+
+	ut_assertok(get_tpm_version(TPM_V2, &dev));
+	ut_assertok(tpm_auto_start(dev));
+	priv = dev_get_uclass_priv(dev);
+
+	ut_assertok(tpm2_pcr_read(dev, pcr, priv->pcr_select_min,
+				  TPM2_ALG_SHA256, before, sizeof(before),
+				  NULL));
+
+	digest_list.count = 1;
+	digest_list.digests[0].hash_alg = TPM2_ALG_SHA256;
+	memset(&digest_list.digests[0].digest, 0xa5, TPM2_DIGEST_LEN);
+	ut_assertok(tpm2_pcr_extend_digests(dev, pcr, &digest_list));
+
+	ut_assertok(tpm2_pcr_read(dev, pcr, priv->pcr_select_min,
+				  TPM2_ALG_SHA256, after, sizeof(after), NULL));
+	sha256_starts(&ctx);
+	sha256_update(&ctx, before, sizeof(before));
+	sha256_update(&ctx, (u8 *)&digest_list.digests[0].digest,
+		      TPM2_DIGEST_LEN);
+	sha256_finish(&ctx, expect);
+	ut_asserteq_mem(expect, after, sizeof(after));
+
+	/* There must be at least one digest */
+	digest_list.count = 0;
+	ut_asserteq(-EINVAL, tpm2_pcr_extend_digests(dev, pcr, &digest_list));
+
+	return 0;
+}
+DM_TEST(dm_test_tpm_pcr_extend_digests, UTF_SCAN_FDT);
@@ -6,6 +6,7 @@
 
 #include <alist.h>
 #include <string.h>
+#include <linux/kernel.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -409,6 +410,51 @@ static int lib_test_alist_empty(struct unit_test_state *uts)
 }
 LIB_TEST(lib_test_alist_empty, 0);
 
+/* Test growing a list which has been emptied, and up to the size limit */
+static int lib_test_alist_expand(struct unit_test_state *uts)
+{
+	struct my_struct data, *ptr;
+	struct alist lst;
+	ulong start;
+	int i;
+
+	start = ut_check_free();
+
+	ut_assert(alist_init_struct(&lst, struct my_struct));
+	data.other_val = 0;
+	for (i = 0; i < 4; i++) {
+		data.val = i + 1;
+		alist_add(&lst, data);
+	}
+	ut_asserteq(4, lst.alloc);
+
+	/* only the element in use is kept when the list grows */
+	alist_empty(&lst);
+	data.val = 10;
+	alist_add(&lst, data);
+	ptr = alist_ensure(&lst, 4, struct my_struct);
+	ut_assertnonnull(ptr);
+	ut_asserteq(8, lst.alloc);
+	ut_asserteq(10, alist_get(&lst, 0, struct my_struct)->val);
+	ut_asserteq(0, alist_get(&lst, 1, struct my_struct)->val);
+	ut_asserteq(0, alist_get(&lst, 3, struct my_struct)->val);
+
+	/* the allocated size stops at the largest which can be recorded */
+	ut_assertnonnull(alist_ensure(&lst, U16_MAX - 1, struct my_struct));
+	ut_asserteq(U16_MAX, lst.alloc);
+	ut_asserteq(U16_MAX, lst.count);
+	ut_assertnull(alist_ensure(&lst, U16_MAX, struct my_struct));
+	ut_asserteq(U16_MAX, lst.alloc);
+
+	alist_uninit(&lst);
+
+	/* Check for memory leaks */
+	ut_assertok(ut_check_delta(start));
+
+	return 0;
+}
+LIB_TEST(lib_test_alist_expand, 0);
+
 static int lib_test_alist_filter(struct unit_test_state *uts)
 {
 	struct my_struct *from, *to, *ptr;
@@ -11,7 +11,10 @@
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <time.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
+#include <linux/sizes.h>
 
 #include <u-boot/lz4.h>
 #include <u-boot/zlib.h>
@@ -606,3 +609,229 @@ static int compression_test_bootm_none(struct unit_test_state *uts)
 	return run_bootm_test(uts, IH_COMP_NONE, compress_using_none);
 }
 LIB_TEST(compression_test_bootm_none, 0);
+
+/* Number of full 64KB blocks in the frames built by lz4_build_frame() */
+#define LZ4_TEST_BLOCKS		8
+#define LZ4_TEST_TAIL		100
+
+/*
+ * Build an lz4 frame of full 64KB blocks, each holding a single repeated byte,
+ * followed by a short stored block. If @short_mid, the second block is also a
+ * short stored block, so the blocks cannot be placed in advance.
+ *
+ * Return: size of the frame
+ */
+static size_t lz4_build_frame(u8 *frame, u8 *expect, bool short_mid,
+			      size_t *expect_len)
+{
+	u8 *ptr = frame, *out = expect;
+	int i, j;
+
+	put_unaligned_le32(LZ4F_MAGIC, ptr);
+	ptr += 4;
+	*ptr++ = 0x60;		/* version 1, independent blocks */
+	*ptr++ = 0x40;		/* 64KB blocks */
+	*ptr++ = 0;		/* header checksum, not checked */
+
+	for (i = 0; i < LZ4_TEST_BLOCKS; i++) {
+		u8 *hdr = ptr;
+		u8 val = 'a' + i;
+
+		if (short_mid && i == 1) {
+			put_unaligned_le32(LZ4_TEST_TAIL | 0x80000000, ptr);
+			ptr += 4;
+			memset(ptr, val, LZ4_TEST_TAIL);
+			ptr += LZ4_TEST_TAIL;
+			memset(out, val, LZ4_TEST_TAIL);
+			out += LZ4_TEST_TAIL;
+			continue;
+		}
+
+		/* One literal, a match of 65530 bytes, then five literals */
+		ptr += 4;
+		*ptr++ = 0x1f;
+		*ptr++ = val;
+		put_unaligned_le16(1, ptr);
+		ptr += 2;
+		for (j = 65530 - 4 - 15; j >= 255; j -= 255)
+			*ptr++ = 255;
+		*ptr++ = j;
+		*ptr++ = 0x50;
+		memset(ptr, val, 5);
+		ptr += 5;
+		put_unaligned_le32(ptr - hdr - 4, hdr);
+		memset(out, val, SZ_64K);
+		out += SZ_64K;
+	}
+
+	put_unaligned_le32(LZ4_TEST_TAIL | 0x80000000, ptr);
+	ptr += 4;
+	memset(ptr, 'z', LZ4_TEST_TAIL);
+	ptr += LZ4_TEST_TAIL;
+	memset(out, 'z', LZ4_TEST_TAIL);
+	out += LZ4_TEST_TAIL;
+	put_unaligned_le32(0, ptr);
+	ptr += 4;
+
+	*expect_len = out - expect;
+
+	return ptr - frame;
+}
+
+/* Test decompressing lz4 blocks as separate jobs, comparing the time taken */
+static int compression_test_lz4_parallel(struct unit_test_state *uts)
+{
+	size_t size = LZ4_TEST_BLOCKS * SZ_64K + LZ4_TEST_TAIL;
+	size_t frame_len, expect_len, len;
+	u8 *frame, *expect, *out;
+	ulong serial_us, parallel_us;
+	int short_mid;
+
+	frame = malloc(SZ_4K);
+	expect = malloc(size);
+	out = malloc(size);
+	ut_assertnonnull(frame);
+	ut_assertnonnull(expect);
+	ut_assertnonnull(out);
+
+	for (short_mid = 0; short_mid < 2; short_mid++) {
+		frame_len = lz4_build_frame(frame, expect, short_mid,
+					    &expect_len);
+
+		memset(out, '\0', size);
+		len = size;
+		serial_us = timer_get_us();
+		ut_assertok(ulz4fn(frame, frame_len, out, &len));
+		serial_us = timer_get_us() - serial_us;
+		ut_asserteq(expect_len, len);
+		ut_asserteq_mem(expect, out, len);
+
+		memset(out, '\0', size);
+		len = size;
+		parallel_us = timer_get_us();
+		ut_assertok(ulz4fn_parallel(frame, frame_len, out, &len));
+		parallel_us = timer_get_us() - parallel_us;
+		ut_asserteq(expect_len, len);
+		ut_asserteq_mem(expect, out, len);
+
+		printf("%s blocks: serial %lu us, parallel %lu us\n",
+		       short_mid ? "short" : "full", serial_us, parallel_us);
+	}
+
+	/* A buffer which is too small is reported as such */
+	len = SZ_64K;
+	frame_len = lz4_build_frame(frame, expect, false, &expect_len);
+	ut_asserteq(-EPROTO, ulz4fn_parallel(frame, frame_len, out, &len));
+
+	free(out);
+	free(expect);
+	free(frame);
+
+	return 0;
+}
+LIB_TEST(compression_test_lz4_parallel, 0);
+
+/*
+ * zstd -19 --no-check -D /tmp/plain.txt -c /tmp/plain.txt, i.e. the plain
+ * text compressed using itself as a raw-content dictionary
+ */
+static const char zstd_dict_compressed[] =
+	"\x28\xb5\x2f\xfd\x60\x5e\x00\x4d\x00\x00\x08\x49\x01\x00\x5a\x61"
+	"\xea\x12\x02";
+static const unsigned long zstd_dict_compressed_size =
+	sizeof(zstd_dict_compressed) - 1;
+
+/* Test decompressing zstd data which needs a dictionary */
+static int compression_test_zstd_dict(struct unit_test_state *uts)
+{
+	int plain_size = strlen(plain);
+	struct abuf in, out, dict;
+	char buf[sizeof(plain)];
+
+	abuf_init_const(&dict, plain, plain_size);
+	abuf_init_set(&in, (void *)zstd_dict_compressed,
+		      zstd_dict_compressed_size);
+	abuf_init_set(&out, buf, sizeof(buf));
+
+	memset(buf, '\0', sizeof(buf));
+	ut_asserteq(plain_size, zstd_decompress_dict(&in, &out, &dict));
+	ut_asserteq_mem(plain, buf, plain_size);
+
+	/* without the dictionary the data cannot be decompressed */
+	ut_assert(zstd_decompress(&in, &out) < 0);
+
+	/* check the workspace is still usable for normal data */
+	abuf_init_set(&in, (void *)zstd_compressed, zstd_compressed_size);
+	memset(buf, '\0', sizeof(buf));
+	ut_asserteq(plain_size, zstd_decompress(&in, &out));
+	ut_asserteq_mem(plain, buf, plain_size);
+
+	return 0;
+}
+LIB_TEST(compression_test_zstd_dict, 0);
+
+/* Test decompressing zstd data as it arrives, in pieces */
+static int compression_test_zstd_stream(struct unit_test_state *uts)
+{
+	int plain_size = strlen(plain);
+	struct zstd_stream *zs;
+	char buf[sizeof(plain)];
+	ulong len, split;
+
+	for (split = 16; split < zstd_compressed_size; split += 40) {
+		memset(buf, '\0', sizeof(buf));
+		zs = zstd_stream_start(buf, sizeof(buf));
+		ut_assertnonnull(zs);
+		ut_assertok(zstd_stream_feed(zs, zstd_compressed, split));
+		ut_asserteq(1, zstd_stream_feed(zs, zstd_compressed + split,
+						zstd_compressed_size - split));
+		ut_assertok(zstd_stream_finish(zs, &len));
+		ut_asserteq(plain_size, len);
+		ut_asserteq_mem(plain, buf, plain_size);
+	}
+
+	/* a truncated frame is reported */
+	zs = zstd_stream_start(buf, sizeof(buf));
+	ut_assertnonnull(zs);
+	ut_assertok(zstd_stream_feed(zs, zstd_compressed,
+				     zstd_compressed_size / 2));
+	ut_asserteq(-EIO, zstd_stream_finish(zs, &len));
+
+	/* so is a destination buffer which is too small */
+	zs = zstd_stream_start(buf, plain_size / 2);
+	ut_assertnonnull(zs);
+	ut_asserteq(-ENOSPC, zstd_stream_feed(zs, zstd_compressed,
+					      zstd_compressed_size));
+	zstd_stream_finish(zs, &len);
+
+	return 0;
+}
+LIB_TEST(compression_test_zstd_stream, 0);
+
+#define LZMA_BENCH_LOOPS	1000
+
+/* Time decompressing lzma data repeatedly, to track decoder performance */
+static int compression_test_lzma_bench(struct unit_test_state *uts)
+{
+	unsigned char out[sizeof(plain)];
+	ulong start, us;
+	SizeT len = 0;
+	int i;
+
+	start = timer_get_us();
+	for (i = 0; i < LZMA_BENCH_LOOPS; i++) {
+		len = sizeof(out);
+		ut_assertok(lzmaBuffToBuffDecompress(out, &len,
+						     (void *)lzma_compressed,
+						     lzma_compressed_size));
+	}
+	us = timer_get_us() - start;
+	ut_asserteq(strlen(plain), len);
+	ut_asserteq_mem(plain, out, len);
+
+	printf("lzma: %d x %zu bytes in %lu us\n", LZMA_BENCH_LOOPS,
+	       (size_t)len, us);
+
+	return 0;
+}
+LIB_TEST(compression_test_lzma_bench, 0);
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for writing Android sparse images as they arrive
+ */
+
+#include <image-sparse.h>
+#include <malloc.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define TEST_BLKSZ	512
+#define TEST_BLKS	16
+#define TEST_RESPONSE_LEN	65
+
+static u8 test_disk[TEST_BLKS * TEST_BLKSZ];
+
+static lbaint_t test_write(struct sparse_storage *info, lbaint_t blk,
+			   lbaint_t blkcnt, const void *buffer)
+{
+	memcpy(test_disk + blk * TEST_BLKSZ, buffer, blkcnt * TEST_BLKSZ);
+
+	return blkcnt;
+}
+
+static lbaint_t test_reserve(struct sparse_storage *info, lbaint_t blk,
+			     lbaint_t blkcnt)
+{
+	return blkcnt;
+}
+
+static lbaint_t test_erased;
+
+static lbaint_t test_erase(struct sparse_storage *info, lbaint_t blk,
+			   lbaint_t blkcnt)
+{
+	memset(test_disk + blk * TEST_BLKSZ, '\0', blkcnt * TEST_BLKSZ);
+	test_erased += blkcnt;
+
+	return blkcnt;
+}
+
+static void test_storage(struct sparse_storage *info)
+{
+	memset(info, '\0', sizeof(*info));
+	info->blksz = TEST_BLKSZ;
+	info->start = 2;
+	info->size = TEST_BLKS - 2;
+	info->write = test_write;
+	info->reserve = test_reserve;
+	memset(test_disk, 0x55, sizeof(test_disk));
+}
+
+static void *add_chunk(void *p, u16 type, u32 blks, u32 data_sz)
+{
+	chunk_header_t *chunk = p;
+
+	chunk->chunk_type = type;
+	chunk->reserved1 = 0;
+	chunk->chunk_sz = blks;
+	chunk->total_sz = sizeof(*chunk) + data_sz;
+
+	return p + sizeof(*chunk);
+}
+
+/* Feed an image to a stream in pieces of @piece bytes */
+static int stream_image(struct unit_test_state *uts, const u8 *image,
+			uint size, uint piece)
+{
+	char response[TEST_RESPONSE_LEN] = "";
+	struct sparse_storage info;
+	struct sparse_stream stream;
+	uint pos, n;
+
+	test_storage(&info);
+	ut_assertok(sparse_stream_init(&stream, &info, "test", response));
+	for (pos = 0; pos < size; pos += n) {
+		n = min(piece, size - pos);
+		ut_assertok(sparse_stream_write(&stream, image + pos, n,
+						response));
+	}
+	ut_assertok(sparse_stream_finish(&stream, response));
+
+	return 0;
+}
+
+/* Test writing a sparse image in pieces of various sizes */
+static int lib_test_sparse_stream(struct unit_test_state *uts)
+{
+	static const uint pieces[] = { 1, 7, 512, 4096 };
+	u8 image[2048 + 5 * TEST_BLKSZ];
+	sparse_header_t *header = (void *)image;
+	u32 fill = 0x12345678;
+	void *p;
+	int i;
+
+	memset(header, '\0', sizeof(*header));
+	header->magic = SPARSE_HEADER_MAGIC;
+	header->major_version = 1;
+	header->file_hdr_sz = sizeof(*header);
+	header->chunk_hdr_sz = sizeof(chunk_header_t);
+	header->blk_sz = TEST_BLKSZ;
+	header->total_blks = 8;
+	header->total_chunks = 4;
+	p = image + sizeof(*header);
+
+	/* Blocks 0-1 raw, 2-4 filled, 5 skipped, 6-7 raw */
+	p = add_chunk(p, CHUNK_TYPE_RAW, 2, 2 * TEST_BLKSZ);
+	for (i = 0; i < 2 * TEST_BLKSZ; i++)
+		*(u8 *)p++ = i;
+	p = add_chunk(p, CHUNK_TYPE_FILL, 3, sizeof(fill));
+	memcpy(p, &fill, sizeof(fill));
+	p += sizeof(fill);
+	p = add_chunk(p, CHUNK_TYPE_DONT_CARE, 1, 0);
+	p = add_chunk(p, CHUNK_TYPE_RAW, 2, 2 * TEST_BLKSZ);
+	memset(p, 0xaa, 2 * TEST_BLKSZ);
+	p += 2 * TEST_BLKSZ;
+
+	for (i = 0; i < ARRAY_SIZE(pieces); i++) {
+		u8 *disk = test_disk + 2 * TEST_BLKSZ;
+
+		ut_assertok(stream_image(uts, image, p - (void *)image,
+					 pieces[i]));
+		ut_asserteq_mem(image + sizeof(*header) +
+				sizeof(chunk_header_t), disk, 2 * TEST_BLKSZ);
+		ut_asserteq(fill, *(u32 *)(disk + 2 * TEST_BLKSZ));
+		ut_asserteq(fill, *(u32 *)(disk + 5 * TEST_BLKSZ - 4));
+		ut_asserteq(0x55, disk[5 * TEST_BLKSZ]);
+		ut_asserteq(0xaa, disk[6 * TEST_BLKSZ]);
+		ut_asserteq(0xaa, disk[8 * TEST_BLKSZ - 1]);
+		ut_asserteq(0x55, disk[8 * TEST_BLKSZ]);
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream, 0);
+
+/* Test writing an image which is not sparse */
+static int lib_test_sparse_stream_raw(struct unit_test_state *uts)
+{
+	char response[TEST_RESPONSE_LEN] = "";
+	struct sparse_storage info;
+	struct sparse_stream stream;
+	u8 image[700];
+
+	memset(image, 0xaa, sizeof(image));
+	ut_assertok(stream_image(uts, image, sizeof(image), 100));
+	ut_asserteq_mem(image, test_disk + 2 * TEST_BLKSZ, sizeof(image));
+	ut_asserteq(0, test_disk[2 * TEST_BLKSZ + sizeof(image)]);
+	ut_asserteq(0x55, test_disk[4 * TEST_BLKSZ]);
+
+	/* A sparse image which is cut short is rejected */
+	test_storage(&info);
+	ut_assertok(sparse_stream_init(&stream, &info, "test", response));
+	memset(image, '\0', sizeof(sparse_header_t));
+	((sparse_header_t *)image)->magic = SPARSE_HEADER_MAGIC;
+	((sparse_header_t *)image)->major_version = 1;
+	((sparse_header_t *)image)->file_hdr_sz = sizeof(sparse_header_t);
+	((sparse_header_t *)image)->chunk_hdr_sz = sizeof(chunk_header_t);
+	((sparse_header_t *)image)->blk_sz = TEST_BLKSZ;
+	((sparse_header_t *)image)->total_chunks = 1;
+	ut_assertok(sparse_stream_write(&stream, image,
+					sizeof(sparse_header_t), response));
+	ut_asserteq(-1, sparse_stream_finish(&stream, response));
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_stream_raw, 0);
+
+/* Test that zero-filled chunks are erased when the storage can do that */
+static int lib_test_sparse_erase(struct unit_test_state *uts)
+{
+	char response[TEST_RESPONSE_LEN] = "";
+	u8 image[sizeof(sparse_header_t) + 2 * (sizeof(chunk_header_t) + 4)];
+	sparse_header_t *header = (void *)image;
+	struct sparse_storage info;
+	u32 fill;
+	void *p;
+
+	memset(header, '\0', sizeof(*header));
+	header->magic = SPARSE_HEADER_MAGIC;
+	header->major_version = 1;
+	header->file_hdr_sz = sizeof(*header);
+	header->chunk_hdr_sz = sizeof(chunk_header_t);
+	header->blk_sz = TEST_BLKSZ;
+	header->total_blks = 6;
+	header->total_chunks = 2;
+	p = image + sizeof(*header);
+
+	p = add_chunk(p, CHUNK_TYPE_FILL, 4, sizeof(fill));
+	fill = 0;
+	memcpy(p, &fill, sizeof(fill));
+	p += sizeof(fill);
+	p = add_chunk(p, CHUNK_TYPE_FILL, 2, sizeof(fill));
+	fill = 0xffffffff;
+	memcpy(p, &fill, sizeof(fill));
+
+	test_storage(&info);
+	info.erase = test_erase;
+	test_erased = 0;
+	ut_assertok(write_sparse_image(&info, "test", image, response));
+	ut_asserteq(4, test_erased);
+	ut_asserteq(0, test_disk[2 * TEST_BLKSZ]);
+	ut_asserteq(0, test_disk[6 * TEST_BLKSZ - 1]);
+	ut_asserteq(0xff, test_disk[6 * TEST_BLKSZ]);
+	ut_asserteq(0x55, test_disk[8 * TEST_BLKSZ]);
+
+	return 0;
+}
+LIB_TEST(lib_test_sparse_erase, 0);
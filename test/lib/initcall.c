@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for deferred initcall phases
+ */
+
+#include <initcall.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+static char order[10];
+static int order_len;
+
+static void record(char ch)
+{
+	if (order_len < sizeof(order) - 1)
+		order[order_len++] = ch;
+	order[order_len] = '\0';
+}
+
+static int finish_a(void)
+{
+	record('a');
+
+	return 0;
+}
+
+static int start_a(void)
+{
+	record('A');
+
+	return initcall_defer("finish_a", finish_a);
+}
+
+static int finish_b(void)
+{
+	record('b');
+
+	return 0;
+}
+
+static int start_b(void)
+{
+	record('B');
+
+	return initcall_defer("finish_b", finish_b);
+}
+
+static int plain_c(void)
+{
+	record('C');
+
+	return 0;
+}
+
+static int needs_a(void)
+{
+	int ret;
+
+	/* declare that this depends on finish_a() */
+	ret = initcall_sync();
+	if (ret)
+		return ret;
+	record('D');
+
+	return 0;
+}
+
+static int finish_fail(void)
+{
+	record('f');
+
+	return -EIO;
+}
+
+static int start_fail(void)
+{
+	record('F');
+
+	return initcall_defer("finish_fail", finish_fail);
+}
+
+/* Test that deferred phases run at INITCALL_SYNC and at the end */
+static int lib_test_initcall_defer(struct unit_test_state *uts)
+{
+	static const init_fnc_t seq[] = {
+		start_a,
+		start_b,
+		plain_c,
+		INITCALL_SYNC,
+		start_a,
+		plain_c,
+		NULL,
+	};
+
+	order_len = 0;
+	ut_assertok(initcall_run_list(seq));
+	ut_asserteq_str("ABCabACa", order);
+
+	return 0;
+}
+LIB_TEST(lib_test_initcall_defer, 0);
+
+/* Test that initcall_sync() lets an initcall wait for a deferred phase */
+static int lib_test_initcall_sync(struct unit_test_state *uts)
+{
+	static const init_fnc_t seq[] = {
+		start_a,
+		plain_c,
+		needs_a,
+		start_b,
+		NULL,
+	};
+
+	order_len = 0;
+	ut_assertok(initcall_run_list(seq));
+	ut_asserteq_str("ACaDBb", order);
+
+	return 0;
+}
+LIB_TEST(lib_test_initcall_sync, 0);
+
+/* Test that a failing deferred phase stops the sequence */
+static int lib_test_initcall_defer_fail(struct unit_test_state *uts)
+{
+	static const init_fnc_t seq[] = {
+		start_fail,
+		start_b,
+		INITCALL_SYNC,
+		plain_c,
+		NULL,
+	};
+
+	order_len = 0;
+	ut_asserteq(-EIO, initcall_run_list(seq));
+	ut_asserteq_str("FBf", order);
+
+	/* nothing is left over for the next sequence */
+	ut_assertok(initcall_sync());
+	ut_asserteq_str("FBf", order);
+
+	return 0;
+}
+LIB_TEST(lib_test_initcall_defer_fail, 0);
@@ -822,3 +822,61 @@ static int lib_test_lmb_flags(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_test_lmb_flags, 0);
+
+/* Test with many regions, added out of order, then merging them */
+static int lib_test_lmb_many(struct unit_test_state *uts)
+{
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t ram_size = 0x10000000;
+	const int count = 256;
+	struct alist *mem_lst, *used_lst;
+	struct lmb_region *used;
+	struct lmb store;
+	phys_addr_t addr;
+	int i;
+
+	ut_assertok(setup_lmb_test(uts, &store, &mem_lst, &used_lst));
+	ut_assertok(lmb_add(ram, ram_size));
+
+	/* Reserve every other 4KB page, the odd ones first */
+	for (i = 1; i < count; i += 2)
+		ut_assertok(lmb_reserve(ram + i * 0x2000, 0x1000, LMB_NONE));
+	for (i = 0; i < count; i += 2)
+		ut_assertok(lmb_reserve(ram + i * 0x2000, 0x1000, LMB_NONE));
+	ut_asserteq(count, used_lst->count);
+	used = used_lst->data;
+	for (i = 0; i < count; i++) {
+		ut_asserteq(ram + i * 0x2000, used[i].base);
+		ut_asserteq(0x1000, used[i].size);
+	}
+	ut_asserteq(1, lmb_is_reserved_flags(ram + 0x2000 * 100 + 0x800,
+					     LMB_NONE));
+	ut_asserteq(0, lmb_is_reserved_flags(ram + 0x2000 * 100 + 0x1800,
+					     LMB_NONE));
+	ut_asserteq(0x800, lmb_get_free_size(ram + 0x2000 * 100 + 0x1800));
+
+	/* An allocation which fits only between two reservations */
+	addr = lmb_alloc_base(0x1000, 0x1000, ram + 0x2000 * 10, LMB_NONE);
+	ut_asserteq(ram + 0x2000 * 9 + 0x1000, addr);
+	ut_assertok(lmb_free(addr, 0x1000));
+	ut_asserteq(count, used_lst->count);
+
+	/* Fill the gaps, which should merge everything into one region */
+	for (i = 0; i < count; i++)
+		ut_assertok(lmb_reserve(ram + i * 0x2000 + 0x1000, 0x1000,
+					LMB_NONE));
+	ut_asserteq(1, used_lst->count);
+	used = used_lst->data;
+	ut_asserteq(ram, used[0].base);
+	ut_asserteq(count * 0x2000, used[0].size);
+
+	/* Punch a hole and check the region is split */
+	ut_assertok(lmb_free(ram + 0x10000, 0x1000));
+	ASSERT_LMB(mem_lst, used_lst, ram, ram_size, 2, ram, 0x10000,
+		   ram + 0x11000, count * 0x2000 - 0x11000, 0, 0);
+
+	lmb_pop(&store);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_many, 0);
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Instruction counts for code on hot paths
+ *
+ * Each test reports the number of instructions taken by an operation, on a
+ * line like 'perf <name>: <count> instructions'. Counts do not depend on the
+ * load on the host, so test_perf.py compares them against limits for the
+ * board, to catch performance regressions.
+ *
+ * The tests are skipped if the host does not allow access to its performance
+ * counters.
+ */
+
+#include <env.h>
+#include <os.h>
+#include <search.h>
+#include <u-boot/crc.h>
+#include <u-boot/sha256.h>
+#include <asm/global_data.h>
+#include <linux/libfdt.h>
+#include <linux/sizes.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Declare a new perf test */
+#define PERF_TEST(_name, _flags)	UNIT_TEST(_name, _flags, perf)
+
+/* Number of times to repeat each operation, to smooth out start-up costs */
+#define PERF_REPEAT	100
+
+static int perf_start(struct unit_test_state *uts, int *handlep)
+{
+	int handle;
+
+	handle = os_insn_count_start();
+	if (handle < 0)
+		return -EAGAIN;
+	*handlep = handle;
+
+	return 0;
+}
+
+static int perf_end(struct unit_test_state *uts, int handle, const char *name)
+{
+	unsigned long long count;
+
+	ut_assertok(os_insn_count_end(handle, &count));
+	printf("perf %s: %llu instructions\n", name, count / PERF_REPEAT);
+
+	return 0;
+}
+
+/* Look up a node near the end of the devicetree by path */
+static int perf_fdt_path(struct unit_test_state *uts)
+{
+	int handle, i, ret;
+
+	ret = perf_start(uts, &handle);
+	if (ret)
+		return ret;
+	for (i = 0; i < PERF_REPEAT; i++)
+		ut_assert(fdt_path_offset(gd->fdt_blob,
+					  "/buttons2/button-enter") >= 0);
+
+	return perf_end(uts, handle, "fdt_path");
+}
+PERF_TEST(perf_fdt_path, 0);
+
+/* Import a text environment into a new hash table */
+static int perf_env_import(struct unit_test_state *uts)
+{
+	struct hsearch_data htab = {};
+	char env[2048];
+	int handle, i, len, ret;
+
+	for (i = 0, len = 0; i < 64; i++)
+		len += snprintf(env + len, sizeof(env) - len,
+				"var%d=value of variable %d\n", i, i);
+
+	ret = perf_start(uts, &handle);
+	if (ret)
+		return ret;
+	for (i = 0; i < PERF_REPEAT; i++)
+		ut_assert(himport_r(&htab, env, len, '\n', 0, 0, 0, NULL));
+	ret = perf_end(uts, handle, "env_import");
+	hdestroy_r(&htab);
+
+	return ret;
+}
+PERF_TEST(perf_env_import, 0);
+
+/* Hash 4KiB with SHA256 */
+static int perf_sha256(struct unit_test_state *uts)
+{
+	u8 buf[SZ_4K], out[SHA256_SUM_LEN];
+	int handle, i, ret;
+
+	memset(buf, 0xa5, sizeof(buf));
+	ret = perf_start(uts, &handle);
+	if (ret)
+		return ret;
+	for (i = 0; i < PERF_REPEAT; i++)
+		sha256_csum_wd(buf, sizeof(buf), out, CHUNKSZ_SHA256);
+
+	return perf_end(uts, handle, "sha256_4k");
+}
+PERF_TEST(perf_sha256, 0);
+
+/* Check 4KiB with CRC32 */
+static int perf_crc32(struct unit_test_state *uts)
+{
+	u8 buf[SZ_4K];
+	int handle, i, ret;
+	u32 crc = 0;
+
+	memset(buf, 0xa5, sizeof(buf));
+	ret = perf_start(uts, &handle);
+	if (ret)
+		return ret;
+	for (i = 0; i < PERF_REPEAT; i++)
+		crc = crc32(crc, buf, sizeof(buf));
+
+	return perf_end(uts, handle, "crc32_4k");
+}
+PERF_TEST(perf_crc32, 0);
@@ -1,6 +1,7 @@
 # SPDX-License-Identifier: GPL-2.0
 # (C) Copyright 2023, Advanced Micro Devices, Inc.
 
+import json
 import pytest
 
 """
@@ -60,3 +61,17 @@ def test_bootstage_stash_and_unstash(u_boot_console):
     u_boot_console.run_command('bootstage unstash %x %x' % (addr, size))
     output = u_boot_console.run_command('echo $?')
     assert output.endswith('0')
+
+@pytest.mark.buildconfigspec('bootstage')
+@pytest.mark.buildconfigspec('cmd_bootstage')
+@pytest.mark.buildconfigspec('bootstage_profile')
+def test_bootstage_profile(u_boot_console):
+    output = u_boot_console.run_command('bootstage report')
+    assert 'Profile (microseconds' in output
+
+    output = u_boot_console.run_command('bootstage report -j')
+    report = json.loads(output)
+    assert 'dm_r' in [rec['name'] for rec in report['records']]
+    kinds = set(prof['kind'] for prof in report['profile'])
+    assert 'probe' in kinds
+    assert 'initcall' in kinds
@@ -209,6 +209,10 @@ def fs_obj_basic(request, u_boot_config):
         check_call('dd if=/dev/urandom of=%s bs=1M count=1'
 	    % small_file, shell=True)
 
+        # Create a gzipped copy of it, larger than one read chunk
+        check_call('gzip -c %s > %s.gz' % (small_file, small_file),
+            shell=True)
+
         # Delete the small file copies which possibly are written as part of a
         # previous test.
         # check_call('rm -f "%s.w"' % MB1, shell=True)
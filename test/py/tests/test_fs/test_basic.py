@@ -287,3 +287,51 @@ class TestFsBasic(object):
                 'setenv filesize'])
             assert(md5val[0] in ''.join(output))
             assert_fs_integrity(fs_type, fs_img)
+
+    def test_fs14(self, u_boot_console, fs_obj_basic):
+        """
+        Test Case 14 - load a file to a misaligned address
+        """
+        fs_type,fs_img,md5val = fs_obj_basic
+        with u_boot_console.log.section('Test Case 14 - load (misaligned)'):
+            # Test Case 14a - Read full 1MB of small file at ADDR + 3
+            output = u_boot_console.run_command_list([
+                'host bind 0 %s' % fs_img,
+                'mw.b %x 5a 10' % ADDR,
+                '%sload host 0:0 %x /%s' % (fs_type, ADDR + 3, SMALL_FILE),
+                'printenv filesize'])
+            assert('filesize=100000' in ''.join(output))
+
+            # Test Case 14b - Check the data and the bytes before it
+            output = u_boot_console.run_command_list([
+                'md5sum %x $filesize' % (ADDR + 3),
+                'md.b %x 3' % ADDR,
+                'setenv filesize'])
+            assert(md5val[0] in ''.join(output))
+            assert('5a 5a 5a' in ''.join(output))
+
+    @pytest.mark.buildconfigspec('fs_load_gunzip')
+    def test_fs15(self, u_boot_console, fs_obj_basic):
+        """
+        Test Case 15 - load a gzipped file, decompressing it while reading
+        """
+        fs_type,fs_img,md5val = fs_obj_basic
+        with u_boot_console.log.section('Test Case 15 - load -z'):
+            # Test Case 15a - Decompress the gzipped small file
+            output = u_boot_console.run_command_list([
+                'host bind 0 %s' % fs_img,
+                '%sload -z host 0:0 %x /%s.gz' % (fs_type, ADDR, SMALL_FILE),
+                'printenv filesize'])
+            assert('filesize=100000' in ''.join(output))
+
+            # Test Case 15b - Check the data
+            output = u_boot_console.run_command_list([
+                'md5sum %x $filesize' % ADDR,
+                'setenv filesize'])
+            assert(md5val[0] in ''.join(output))
+
+            # Test Case 15c - A too small limit is an error
+            output = u_boot_console.run_command(
+                '%sload -z host 0:0 %x /%s.gz 1000' %
+                (fs_type, ADDR, SMALL_FILE))
+            assert('Failed to load' in output)
@@ -0,0 +1,41 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+"""Check instruction counts for hot paths against limits
+
+The 'perf' unit tests report the number of instructions taken by various
+operations. Unlike timings, these counts are stable from run to run, so they
+can be checked against limits to catch performance regressions.
+
+Counts depend on the compiler and its options, so the limits are set in the
+boardenv_* file. Without them, the counts are only reported. For example:
+
+env__perf_limits = {
+    'fdt_path': 2000,
+    'env_import': 60000,
+    'sha256_4k': 90000,
+    'crc32_4k': 20000,
+}
+"""
+
+import re
+import pytest
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('unit_test')
+def test_perf(u_boot_console):
+    """Run the perf tests and compare the counts against the limits"""
+    cons = u_boot_console
+    output = cons.run_command('ut perf')
+    counts = {name: int(count) for name, count in
+              re.findall(r'perf (\w+): (\d+) instructions', output)}
+    if not counts:
+        pytest.skip('Instruction counters are not available')
+
+    limits = cons.config.env.get('env__perf_limits', {})
+    over = []
+    for name, count in sorted(counts.items()):
+        limit = limits.get(name)
+        cons.log.info(f'{name}: {count} instructions (limit {limit})')
+        if limit is not None and count > limit:
+            over.append(f'{name}: {count} > {limit}')
+    assert not over, 'Over limit: ' + ', '.join(over)
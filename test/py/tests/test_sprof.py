@@ -0,0 +1,27 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+"""Test the sampling profiler"""
+
+import re
+import pytest
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_sprof')
+def test_sprof(u_boot_console):
+    """Take samples while doing some work and write them out"""
+    cons = u_boot_console
+    cons.run_command('sprof start 100')
+
+    # Use some CPU time, since SIGPROF only counts that
+    for _ in range(5):
+        cons.run_command('crc32 0 4000000')
+
+    output = cons.run_command('sprof stats')
+    m = re.match(r'Running, (\d+) samples taken, (\d+) held', output)
+    assert m
+    assert int(m.group(1)) > 0
+
+    output = cons.run_command('sprof samples 1000000 100000')
+    assert 'Samples dumped to 01000000' in output
+    output = cons.run_command('sprof stats')
+    assert output.startswith('Stopped')
@@ -300,6 +300,30 @@ def check_flamegraph(cons, fname, proftool, map_fname, trace_fg):
     return total
 
 check_flamegraph
+
+def check_limit(cons):
+    """Check that 'trace limit' stops calls being traced
+
+    Args:
+        cons (ConsoleBase): U-Boot console
+
+    Returns:
+        dict: values from 'trace stats', keyed by name
+    """
+    cons.run_command('trace wipe')
+
+    # Only trace the first function site, which is never called
+    cons.run_command('trace limit 100 0 1')
+    cons.run_command('trace resume')
+    cons.run_command('echo hello')
+    cons.run_command('trace pause')
+    out = cons.run_command('trace stats')
+    lines = [line.split(maxsplit=1) for line in out.splitlines() if line]
+    vals = {key: val.replace(',', '') for val, key in lines}
+    cons.run_command('trace wipe')
+
+    return vals
+
 @pytest.mark.slow
 @pytest.mark.boardspec('sandbox')
 @pytest.mark.buildconfigspec('trace')
@@ -334,3 +358,9 @@ def test_trace(u_boot_console):
     # Check that the trace buffer can be wiped
     numcalls = wipe_and_collect_trace(cons)
     assert numcalls == 0
+
+    # Check that calls outside the filter are not traced
+    vals = check_limit(cons)
+    assert int(vals['traced function calls']) == 0
+    assert int(vals['calls not traced due to filter']) > 1000
+    assert vals['call depth limit'] == '100'
@@ -116,6 +116,9 @@ controlled by a description in the board device tree.'''
             help='Set argument value arg=value')
     build_parser.add_argument('-b', '--board', type=str,
             help='Board name to build')
+    build_parser.add_argument('-c', '--cache-dir', type=str,
+            default=os.environ.get('BINMAN_CACHE_DIR'),
+            help='Directory to cache compressed entry data between builds')
     build_parser.add_argument('-d', '--dt', type=str,
             help='Configuration file (.dtb) to use')
     build_parser.add_argument('--fake-dtb', action='store_true',
@@ -847,6 +847,7 @@ def Binman(args):
             tools.prepare_output_dir(args.outdir, args.preserve)
             state.SetEntryArgs(args.entry_arg)
             state.SetThreads(args.threads)
+            state.SetCacheDir(args.cache_dir)
 
             images = PrepareImagesAndDtbs(dtb_fname, args.image,
                                           args.update_fdt, use_expanded, args.indir)
@@ -1219,7 +1219,11 @@ features to produce new behaviours.
         if self.compress != 'none':
             self.uncomp_size = len(indata)
             if self.comp_bintool.is_present():
-                data = self.comp_bintool.compress(indata)
+                key = state.GetCacheKey('compress', self.compress, indata)
+                data = state.ReadCache(key)
+                if data is None:
+                    data = self.comp_bintool.compress(indata)
+                    state.WriteCache(key, data)
                 uniq = self.GetUniqueName()
                 fname = tools.get_output_filename(f'comp.{uniq}')
                 tools.write_file(fname, data)
@@ -374,7 +374,8 @@ class TestFunctional(unittest.TestCase):
                     use_expanded=False, verbosity=None, allow_missing=False,
                     allow_fake_blobs=False, extra_indirs=None, threads=None,
                     test_section_timeout=False, update_fdt_in_elf=None,
-                    force_missing_bintools='', ignore_missing=False, output_dir=None):
+                    force_missing_bintools='', ignore_missing=False, output_dir=None,
+                    cache_dir=None):
         """Run binman with a given test file
 
         Args:
@@ -408,6 +409,7 @@ class TestFunctional(unittest.TestCase):
             ignore_missing (bool): True to return success even if there are
                 missing blobs or bintools
             output_dir: Specific output directory to use for image using -O
+            cache_dir: Directory to use for caching entry data, using -c
 
         Returns:
             int return code, 0 on success
@@ -456,6 +458,8 @@ class TestFunctional(unittest.TestCase):
                 args += ['-I', indir]
         if output_dir:
             args += ['-O', output_dir]
+        if cache_dir:
+            args += ['-c', cache_dir]
         return self._DoBinman(*args)
 
     def _SetupDtb(self, fname, outfile='u-boot.dtb'):
@@ -5039,6 +5043,28 @@ class TestFunctional(unittest.TestCase):
                              test_section_timeout=True)
         self.assertIn("Timed out obtaining contents", str(e.exception))
 
+    def testCompressCache(self):
+        """Test that compressed data is reused from the cache"""
+        self._CheckLz4()
+        cache_dir = tempfile.mkdtemp(prefix='binmant.')
+        try:
+            self._DoTestFile('083_compress.dts', cache_dir=cache_dir)
+            data = tools.read_file(tools.get_output_filename('image.bin'))
+            self.assertEqual(COMPRESS_DATA, self._decompress(data))
+            fnames = glob.glob(os.path.join(cache_dir, '*', '*'))
+            self.assertEqual(1, len(fnames))
+
+            # A second build must not run the compression tool at all
+            with unittest.mock.patch.object(
+                    bintool.Bintool, 'run_cmd_result',
+                    side_effect=ValueError('tool was run')):
+                self._DoTestFile('083_compress.dts', cache_dir=cache_dir)
+            self.assertEqual(
+                data, tools.read_file(tools.get_output_filename('image.bin')))
+        finally:
+            state.SetCacheDir(None)
+            shutil.rmtree(cache_dir)
+
     def testTiming(self):
         """Test output of timing information"""
         data = self._DoReadFile('055_sections.dts')
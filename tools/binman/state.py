@@ -64,6 +64,9 @@ allow_entry_contraction = False
 # Number of threads to use for binman (None means machine-dependent)
 num_threads = None
 
+# Directory holding cached entry data from earlier builds (None to disable)
+cache_dir = None
+
 
 class Timing:
     """Holds information about an operation that is being timed
@@ -470,6 +473,74 @@ def GetThreads():
     """
     return num_threads
 
+def SetCacheDir(path):
+    """Set the directory to use for caching entry data between builds
+
+    Args:
+        path: Directory to use (None to disable the cache)
+    """
+    global cache_dir
+
+    cache_dir = path
+    if path:
+        os.makedirs(path, exist_ok=True)
+
+def GetCacheKey(*parts):
+    """Get the key used to cache data produced from some inputs
+
+    Args:
+        parts: Everything the data depends on, each a str or bytes
+
+    Returns:
+        str: Hex key for the data
+    """
+    sha = hashlib.sha256()
+    for part in parts:
+        if isinstance(part, str):
+            part = part.encode('utf-8')
+        sha.update(len(part).to_bytes(8, 'little'))
+        sha.update(part)
+    return sha.hexdigest()
+
+def _CacheFilename(key):
+    return os.path.join(cache_dir, key[:2], key)
+
+def ReadCache(key):
+    """Read data from the cache
+
+    Args:
+        key: Key returned by GetCacheKey()
+
+    Returns:
+        bytes: Cached data, or None if the cache is disabled or does not have
+            data for this key
+    """
+    if not cache_dir:
+        return None
+    fname = _CacheFilename(key)
+    if not os.path.exists(fname):
+        return None
+    tout.debug(f"Using cached data '{key}'")
+    return tools.read_file(fname)
+
+def WriteCache(key, data):
+    """Write data to the cache, if enabled
+
+    The data is written to a temporary file which is then renamed, so that
+    other builds sharing the cache never see a partial file.
+
+    Args:
+        key: Key returned by GetCacheKey()
+        data: Data to write
+    """
+    if not cache_dir:
+        return
+    fname = _CacheFilename(key)
+    os.makedirs(os.path.dirname(fname), exist_ok=True)
+    tmp = f'{fname}.{os.getpid()}.{threading.get_ident()}'
+    tools.write_file(tmp, data)
+    os.replace(tmp, fname)
+
 def GetTiming(name):
     """Get the timing info for a particular operation
 
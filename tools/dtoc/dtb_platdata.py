@@ -16,6 +16,7 @@ See doc/driver-model/of-plat.rst for more informaiton
 import collections
 import copy
 from enum import IntEnum
+import io
 import os
 import re
 import sys
@@ -156,7 +157,9 @@ class DtbPlatdata():
         _valid_nodes: A list of Node object with compatible strings, ordered by
             conv_name_to_c(node.name)
         _include_disabled: true to include nodes marked status = "disabled"
-        _outfile: The current output file (sys.stdout or a real file)
+        _outfile: The current output file (sys.stdout or a StringIO holding
+            the contents of a real file)
+        _outfname: Filename to write _outfile to when it is finished
         _lines: Stashed list of output lines for outputting in the future
         _dirname: Directory to hold output files, or None for none (all files
             go to stdout)
@@ -179,6 +182,7 @@ class DtbPlatdata():
         self._valid_nodes_unsorted = None
         self._include_disabled = include_disabled
         self._outfile = None
+        self._outfname = None
         self._lines = []
         self._dirnames = [None] * len(Ftype)
         self._struct_data = collections.OrderedDict()
@@ -230,24 +234,49 @@ class DtbPlatdata():
         """
         dirname = self._dirnames[ftype]
         if dirname:
-            pathname = os.path.join(dirname, fname)
-            if self._outfile:
-                self._outfile.close()
-            self._outfile = open(pathname, 'w')
+            self._close_output()
+            self._open_output(os.path.join(dirname, fname))
         elif fname:
             if not self._outfile:
-                self._outfile = open(fname, 'w')
+                self._open_output(fname)
         else:
             self._outfile = sys.stdout
 
+    def _open_output(self, fname):
+        """Start collecting the contents of an output file
+
+        Args:
+            fname (str): Filename to write when the file is closed
+        """
+        self._outfile = io.StringIO()
+        self._outfname = fname
+
+    def _close_output(self):
+        """Write out the current output file, if its contents have changed
+
+        Leaving an unchanged file alone keeps its timestamp, so that make does
+        not rebuild everything which uses it just because the devicetree was
+        regenerated.
+        """
+        if not self._outfile or self._outfile == sys.stdout:
+            return
+        data = self._outfile.getvalue()
+        old = None
+        if os.path.exists(self._outfname):
+            with open(self._outfname, encoding='utf-8') as inf:
+                old = inf.read()
+        if data != old:
+            with open(self._outfname, 'w', encoding='utf-8') as outf:
+                outf.write(data)
+        self._outfile = None
+        self._outfname = None
+
     def finish_output(self):
         """Finish outputing to a file
 
-        This closes the output file, if one is in use
+        This writes out the output file, if one is in use
         """
-        if self._outfile != sys.stdout:
-            self._outfile.close()
-            self._outfile = None
+        self._close_output()
 
     def out(self, line):
         """Output a string to the output file
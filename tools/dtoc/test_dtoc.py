@@ -1600,6 +1600,20 @@ U_BOOT_DRVINFO(spl_test2) = {
              'dt-uclass.c', 'dt-decl.h', 'dt-device.c'},
             leafs)
 
+    def test_output_unchanged(self):
+        """Test that files are not rewritten if their contents are the same"""
+        fnames = self.check_output_dirs(False)
+        fnames = [fname for fname in fnames if fname.endswith(('.c', '.h'))]
+        for fname in fnames:
+            os.utime(fname, (0, 0))
+
+        dtb_file = get_dtb_file('dtoc_test_simple.dts')
+        dtb_platdata.run_steps(
+            ['all'], dtb_file, False, None, [tools.get_output_dir()], None,
+            False, warning_disabled=True, scan=copy_scan())
+        for fname in fnames:
+            self.assertEqual(0, os.stat(fname).st_mtime, fname)
+
     def setup_process_test(self):
         """Set up a test of process_nodes()
 
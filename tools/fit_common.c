@@ -23,8 +23,6 @@
 #include <image.h>
 #include <u-boot/crc.h>
 
-#define COPYFILE_BUFSIZE (64 * 1024)
-
 void fit_print_header(const void *fit, struct image_tool_params *params)
 {
 	fit_print_contents(fit);
@@ -130,7 +128,9 @@ err:
 int copyfile(const char *src, const char *dst)
 {
 	int fd_src = -1, fd_dst = -1;
-	void *buf = NULL;
+	void *buf = MAP_FAILED;
+	struct stat sbuf;
+	const char *ptr;
 	ssize_t size;
 	size_t count;
 	int ret = -1;
@@ -141,29 +141,28 @@ int copyfile(const char *src, const char *dst)
 		goto out;
 	}
 
-	fd_dst = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0666);
-	if (fd_dst < 0) {
-		printf("Can't open file %s (%s)\n", dst, strerror(errno));
+	if (fstat(fd_src, &sbuf) < 0) {
+		printf("Can't stat file %s (%s)\n", src, strerror(errno));
 		goto out;
 	}
 
-	buf = calloc(1, COPYFILE_BUFSIZE);
-	if (!buf) {
-		printf("Can't allocate buffer to copy file\n");
+	fd_dst = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd_dst < 0) {
+		printf("Can't open file %s (%s)\n", dst, strerror(errno));
 		goto out;
 	}
 
-	while (1) {
-		size = read(fd_src, buf, COPYFILE_BUFSIZE);
-		if (size < 0) {
-			printf("Can't read file %s\n", src);
+	/* a FIT may hold large images, so map it rather than reading it */
+	if (sbuf.st_size) {
+		buf = mmap(NULL, sbuf.st_size, PROT_READ, MAP_SHARED, fd_src, 0);
+		if (buf == MAP_FAILED) {
+			printf("Can't map file %s (%s)\n", src, strerror(errno));
 			goto out;
 		}
-		if (!size)
-			break;
+	}
 
-		count = size;
-		size = write(fd_dst, buf, count);
+	for (ptr = buf, count = sbuf.st_size; count; ptr += size, count -= size) {
+		size = write(fd_dst, ptr, count);
 		if (size < 0) {
 			printf("Can't write file %s\n", dst);
 			goto out;
@@ -173,12 +172,12 @@ int copyfile(const char *src, const char *dst)
 	ret = 0;
 
  out:
+	if (buf != MAP_FAILED)
+		munmap(buf, sbuf.st_size);
 	if (fd_src >= 0)
 		close(fd_src);
 	if (fd_dst >= 0)
 		close(fd_dst);
-	if (buf)
-		free(buf);
 
 	return ret;
 }
@@ -25,7 +25,7 @@
 static struct legacy_img_hdr header;
 
 static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
-			     const char *tmpfile)
+			     size_t keydest_inc, const char *tmpfile)
 {
 	int tfd, destfd = 0;
 	void *dest_blob = NULL;
@@ -44,7 +44,7 @@ static int fit_add_file_data(struct image_tool_params *params, size_t size_inc,
 	if (params->keydest) {
 		struct stat dest_sbuf;
 
-		destfd = mmap_fdt(params->cmdname, params->keydest, size_inc,
+		destfd = mmap_fdt(params->cmdname, params->keydest, keydest_inc,
 				  &dest_blob, &dest_sbuf, false,
 				  false);
 		if (destfd < 0) {
@@ -94,6 +94,50 @@ err_keydest:
 	return ret;
 }
 
+/* Space to allow for each hash and signature node's properties */
+#define FIT_HASH_NODE_SPACE	(FIT_MAX_HASH_LEN + 32)
+#define FIT_SIG_NODE_SPACE	1024
+
+/**
+ * fit_calc_verify_size() - Estimate the space needed for hashes and signatures
+ *
+ * This allows the first pass of fit_add_file_data() to succeed in most cases,
+ * so that images are not signed again and the FIT is not copied again
+ *
+ * @params: Parameters, giving the signing keys, if any
+ * @fname: FIT file to check
+ * Return: number of bytes to add to the FIT, rounded up to 1KiB
+ */
+static size_t fit_calc_verify_size(struct image_tool_params *params,
+				   const char *fname)
+{
+	bool sign = params->keydir || params->keyfile;
+	int fd, noffset, depth = 0;
+	struct stat sbuf;
+	size_t size = 0;
+	void *fdt;
+
+	fd = mmap_fdt(params->cmdname, fname, 0, &fdt, &sbuf, false, true);
+	if (fd < 0)
+		return 0;
+
+	for (noffset = fdt_next_node(fdt, 0, &depth); noffset >= 0;
+	     noffset = fdt_next_node(fdt, noffset, &depth)) {
+		const char *name = fdt_get_name(fdt, noffset, NULL);
+
+		if (!strncmp(name, FIT_HASH_NODENAME,
+			     strlen(FIT_HASH_NODENAME)))
+			size += FIT_HASH_NODE_SPACE;
+		else if (sign && !strncmp(name, FIT_SIG_NODENAME,
+					  strlen(FIT_SIG_NODENAME)))
+			size += FIT_SIG_NODE_SPACE;
+	}
+	munmap(fdt, sbuf.st_size);
+	close(fd);
+
+	return (size + 1023) & ~1023;
+}
+
 /**
  * fit_calc_size() - Calculate the approximate size of the FIT we will generate
  */
@@ -591,6 +635,10 @@ static int fit_extract_data(struct image_tool_params *params, const char *fname)
 			ret = -EINVAL;
 			goto err;
 		}
+		if (params->external_offset % align_size)
+			fprintf(stderr,
+				"Warning: External offset %x is not aligned to %x\n",
+				params->external_offset, align_size);
 		new_size = params->external_offset;
 	}
 	if (lseek(fd, new_size, SEEK_SET) < 0) {
@@ -749,7 +797,7 @@ static int fit_handle_file(struct image_tool_params *params)
 	char tmpfile[MKIMAGE_MAX_TMPFILE_LEN];
 	char bakfile[MKIMAGE_MAX_TMPFILE_LEN + 4] = {0};
 	char cmd[MKIMAGE_MAX_DTC_CMDLINE_LEN];
-	size_t size_inc;
+	size_t size_inc, verify_inc;
 	int ret;
 
 	/* Flattened Image Tree (FIT) format  handling */
@@ -809,19 +857,20 @@ static int fit_handle_file(struct image_tool_params *params)
 	 * Set hashes for images in the blob. Unfortunately we may need more
 	 * space in either FDT, so keep trying until we succeed.
 	 *
-	 * Note: this is pretty inefficient for signing, since we must
-	 * calculate the signature every time. It would be better to calculate
-	 * all the data and then store it in a separate step. However, this
-	 * would be considerably more complex to implement. Generally a few
-	 * steps of this loop is enough to sign with several keys.
+	 * The FIT starts with enough space for the hash and signature nodes
+	 * it holds, so one pass is normally enough. Image hashes are only
+	 * calculated on the first pass, but signatures are calculated again
+	 * on each one.
 	 */
+	verify_inc = fit_calc_verify_size(params, bakfile);
 	for (size_inc = 0; size_inc < 64 * 1024; size_inc += 1024) {
 		if (copyfile(bakfile, tmpfile) < 0) {
 			printf("Can't copy %s to %s\n", bakfile, tmpfile);
 			ret = -EIO;
 			break;
 		}
-		ret = fit_add_file_data(params, size_inc, tmpfile);
+		ret = fit_add_file_data(params, verify_inc + size_inc,
+					size_inc, tmpfile);
 		if (!ret || ret != -ENOSPC)
 			break;
 	}
@@ -12,6 +12,7 @@
 #include <bootm.h>
 #include <fdt_region.h>
 #include <image.h>
+#include <pthread.h>
 #include <version.h>
 
 #if CONFIG_IS_ENABLED(FIT_SIGNATURE)
@@ -49,6 +50,171 @@ static int fit_set_hash_value(void *fit, int noffset, uint8_t *value,
 	return 0;
 }
 
+/* Most threads to use when calculating hashes */
+#define FIT_HASH_MAX_THREADS	64
+
+/**
+ * struct fit_hash_job - A hash value to calculate for an image
+ *
+ * @path: Path of the hash node, used to find the value on later passes
+ * @algo: Name of the hash algorithm
+ * @data: Data to hash; only valid on the first pass
+ * @size: Size of data in bytes
+ * @value: Hash value
+ * @value_len: Length of @value in bytes
+ * @ret: 0 if @value is valid, else -ve error from calculate_hash()
+ */
+struct fit_hash_job {
+	char *path;
+	char *algo;
+	const void *data;
+	size_t size;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+	int ret;
+};
+
+/*
+ * Hashes of the images, calculated in parallel on the first pass. mkimage may
+ * need several passes to find enough space in the FIT for its hashes and
+ * signatures, but the image data does not change between passes, so the
+ * hashes are kept and reused.
+ */
+static struct fit_hash_job *hash_jobs;
+static int hash_job_count;
+static int hash_job_next;
+static bool hash_jobs_done;
+static pthread_mutex_t hash_job_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int fit_hash_job_add(void *fit, int noffset, const char *algo,
+			    const void *data, size_t size)
+{
+	struct fit_hash_job *job;
+	char path[256];
+
+	if (fdt_get_path(fit, noffset, path, sizeof(path)))
+		return 0;
+	job = realloc(hash_jobs, (hash_job_count + 1) * sizeof(*job));
+	if (!job)
+		return -ENOMEM;
+	hash_jobs = job;
+	job += hash_job_count;
+	memset(job, '\0', sizeof(*job));
+	job->path = strdup(path);
+	job->algo = strdup(algo);
+	if (!job->path || !job->algo)
+		return -ENOMEM;
+	job->data = data;
+	job->size = size;
+	hash_job_count++;
+
+	return 0;
+}
+
+/* Sort the largest images first, so that threads finish at similar times */
+static int fit_hash_job_cmp(const void *a, const void *b)
+{
+	const struct fit_hash_job *ja = a, *jb = b;
+
+	return ja->size < jb->size ? 1 : ja->size > jb->size ? -1 : 0;
+}
+
+static void *fit_hash_worker(void *arg)
+{
+	struct fit_hash_job *job;
+	int i;
+
+	while (1) {
+		pthread_mutex_lock(&hash_job_lock);
+		i = hash_job_next++;
+		pthread_mutex_unlock(&hash_job_lock);
+		if (i >= hash_job_count)
+			return NULL;
+		job = &hash_jobs[i];
+		job->ret = calculate_hash(job->data, job->size, job->algo,
+					  job->value, &job->value_len);
+	}
+}
+
+/**
+ * fit_calc_hashes() - Calculate the hash of every image, using all CPUs
+ *
+ * Images with a cipher node are skipped, since they are encrypted with a new
+ * IV on each pass. Their hashes are calculated as each node is processed.
+ *
+ * @fit:	FIT to process
+ * @images_noffset: Offset of the /images node
+ * Return: 0 if OK, -ENOMEM if out of memory
+ */
+static int fit_calc_hashes(void *fit, int images_noffset)
+{
+	pthread_t threads[FIT_HASH_MAX_THREADS];
+	int image_noffset, noffset;
+	int nthreads, i, ret;
+	const char *algo;
+	const void *data;
+	size_t size;
+
+	fdt_for_each_subnode(image_noffset, fit, images_noffset) {
+		if (fdt_subnode_offset(fit, image_noffset,
+				       FIT_CIPHER_NODENAME) >= 0)
+			continue;
+		if (fit_image_get_emb_data(fit, image_noffset, &data, &size))
+			continue;
+		fdt_for_each_subnode(noffset, fit, image_noffset) {
+			if (strncmp(fit_get_name(fit, noffset, NULL),
+				    FIT_HASH_NODENAME,
+				    strlen(FIT_HASH_NODENAME)) ||
+			    fit_image_hash_get_algo(fit, noffset, &algo))
+				continue;
+			ret = fit_hash_job_add(fit, noffset, algo, data, size);
+			if (ret)
+				return ret;
+		}
+	}
+	qsort(hash_jobs, hash_job_count, sizeof(*hash_jobs),
+	      fit_hash_job_cmp);
+
+	/* this thread does its share too */
+	nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads > hash_job_count)
+		nthreads = hash_job_count;
+	if (nthreads > FIT_HASH_MAX_THREADS)
+		nthreads = FIT_HASH_MAX_THREADS;
+	for (i = 0; i < nthreads - 1; i++) {
+		if (pthread_create(&threads[i], NULL, fit_hash_worker, NULL))
+			break;
+	}
+	fit_hash_worker(NULL);
+	while (i--)
+		pthread_join(threads[i], NULL);
+
+	/* the FIT is unmapped after this pass */
+	for (i = 0; i < hash_job_count; i++)
+		hash_jobs[i].data = NULL;
+	hash_jobs_done = true;
+
+	return 0;
+}
+
+/* Find the hash calculated by fit_calc_hashes() for a node, if any */
+static struct fit_hash_job *fit_hash_job_find(void *fit, int noffset,
+					      const char *algo, size_t size)
+{
+	struct fit_hash_job *job;
+	char path[256];
+
+	if (fdt_get_path(fit, noffset, path, sizeof(path)))
+		return NULL;
+	for (job = hash_jobs; job < hash_jobs + hash_job_count; job++) {
+		if (!job->ret && job->size == size &&
+		    !strcmp(job->path, path) && !strcmp(job->algo, algo))
+			return job;
+	}
+
+	return NULL;
+}
+
 /**
  * fit_image_process_hash - Process a single subnode of the images/ node
  *
@@ -66,6 +232,7 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		int noffset, const void *data, size_t size)
 {
 	uint8_t value[FIT_MAX_HASH_LEN];
+	struct fit_hash_job *job;
 	const char *node_name;
 	int value_len;
 	const char *algo;
@@ -80,7 +247,11 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		return -ENOENT;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	job = fit_hash_job_find(fit, noffset, algo, size);
+	if (job) {
+		memcpy(value, job->value, job->value_len);
+		value_len = job->value_len;
+	} else if (calculate_hash(data, size, algo, value, &value_len)) {
 		fprintf(stderr,
 			"Unsupported hash algorithm (%s) for '%s' hash node in '%s' image node\n",
 			algo, node_name, image_name);
@@ -1295,6 +1466,12 @@ int fit_cipher_data(const char *keydir, void *keydest, void *fit,
 		return images_noffset;
 	}
 
+	if (!hash_jobs_done) {
+		ret = fit_calc_hashes(fit, images_noffset);
+		if (ret)
+			return ret;
+	}
+
 	/* Process its subnodes, print out component images details */
 	for (noffset = fdt_first_subnode(fit, images_noffset);
 	     noffset >= 0;
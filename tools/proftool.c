@@ -254,6 +254,8 @@ struct func_info *func_list;
 int func_count;			/* number of functions */
 struct trace_call *call_list;	/* list of all calls in the input trace file */
 int call_count;			/* number of calls */
+char **sample_list;		/* folded stack of each profiler sample */
+int sample_count;		/* number of samples */
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 ulong text_offset;		/* text address of first function */
 ulong text_base;		/* CONFIG_TEXT_BASE from trace file */
@@ -292,7 +294,8 @@ static void usage(void)
 		"   -f <subtype>\tSpecify output subtype\n"
 		"   -m <map>\tSpecify System.map file\n"
 		"   -o <fname>\tSpecify output file\n"
-		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls')\n"
+		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls' or\n"
+		"\t\t'sprof samples')\n"
 		"   -v <0-4>\tSpecify verbosity\n"
 		"\n"
 		"Subtypes for dump-ftrace:\n"
@@ -483,6 +486,67 @@ static int read_calls(FILE *fin, size_t count)
 	return 0;
 }
 
+/**
+ * read_samples() - Read the samples from the sampling profiler
+ *
+ * Each sample is turned into a folded stack, i.e. the function names from
+ * the outermost caller to the interrupted function, separated by ';'. The
+ * System.map file must have been read already.
+ *
+ * @fin: File to read from
+ * @count: Number of samples to read
+ * Returns: 0 if OK, -1 on error
+ */
+static int read_samples(FILE *fin, size_t count)
+{
+	struct trace_output_sample sample;
+	uint32_t offset[MAX_STACK_DEPTH];
+	char str[MAX_STACK_DEPTH * 64];
+	int i, j;
+
+	notice("sample count: %zu\n", count);
+	sample_list = calloc(count, sizeof(*sample_list));
+	if (!sample_list) {
+		error("Cannot allocate sample_list\n");
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		char *ptr = str, *end = str + sizeof(str);
+
+		if (read_data(fin, &sample, sizeof(sample)))
+			return -1;
+		if (!sample.depth || sample.depth > MAX_STACK_DEPTH) {
+			error("Invalid sample depth %u\n", sample.depth);
+			return -1;
+		}
+		if (read_data(fin, offset, sample.depth * sizeof(offset[0])))
+			return -1;
+
+		*str = '\0';
+		for (j = sample.depth - 1; j >= 0; j--) {
+			struct func_info *func;
+
+			/* A return address may be just past its function */
+			func = find_caller_by_offset(j ? offset[j] - 1 :
+						     offset[j]);
+			ptr += snprintf(ptr, end - ptr, "%s%s",
+					ptr == str ? "" : ";",
+					func ? func->name : "?");
+			if (ptr >= end)
+				break;
+		}
+		sample_list[i] = strdup(str);
+		if (!sample_list[i]) {
+			error("Cannot allocate sample\n");
+			return -1;
+		}
+	}
+	sample_count = count;
+
+	return 0;
+}
+
 /**
  * read_trace() - Read the U-Boot trace file
  *
@@ -515,6 +579,11 @@ static int read_trace(FILE *fin)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -1861,6 +1930,35 @@ static int output_tree(FILE *fout, enum out_format_t out_format,
 	return 0;
 }
 
+static int h_cmp_str(const void *v1, const void *v2)
+{
+	return strcmp(*(const char **)v1, *(const char **)v2);
+}
+
+/**
+ * make_sample_flamegraph() - Write out a flame graph from profiler samples
+ *
+ * Each distinct stack is written once with the number of samples taken in it
+ *
+ * @fout: Output file
+ * Returns 0 if OK, -1 on error
+ */
+static int make_sample_flamegraph(FILE *fout)
+{
+	int i, count;
+
+	qsort(sample_list, sample_count, sizeof(*sample_list), h_cmp_str);
+	for (i = 0; i < sample_count; i += count) {
+		for (count = 1; i + count < sample_count; count++) {
+			if (strcmp(sample_list[i], sample_list[i + count]))
+				break;
+		}
+		fprintf(fout, "%s %d\n", sample_list[i], count);
+	}
+
+	return 0;
+}
+
 /**
  * make_flamegraph() - Write out a flame graph
  *
@@ -1875,6 +1973,10 @@ static int make_flamegraph(FILE *fout, enum out_format_t out_format)
 	char *str;
 	int ret = 0;
 
+	/* Without a call trace, use the samples from the sampling profiler */
+	if (sample_count && !call_count)
+		return make_sample_flamegraph(fout);
+
 	if (make_flame_tree(out_format, &tree))
 		return -1;
 